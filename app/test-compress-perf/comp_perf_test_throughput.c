@@ -393,19 +393,29 @@ cperf_throughput_test_runner(void *test_ctx)
 	ctx->decomp_gbps = rte_get_tsc_hz() / ctx->decomp_tsc_byte * 8 /
 			1000000000;
 
+	/* Operation rate, telling the per op cost of small messages */
+	ctx->comp_mops = (double)ctx->ver.mem.total_bufs * rte_get_tsc_hz() /
+			ctx->comp_tsc_duration[test_data->level] / 1000000;
+
+	ctx->decomp_mops = (double)ctx->ver.mem.total_bufs * rte_get_tsc_hz() /
+			ctx->decomp_tsc_duration[test_data->level] / 1000000;
+
 	exp = 0;
 	if (__atomic_compare_exchange_n(&display_once, &exp, 1, 0,
 			__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
-		printf("\n%12s%6s%12s%17s%15s%16s\n",
+		printf("\n%12s%6s%12s%17s%15s%16s%15s%16s\n",
 			"lcore id", "Level", "Comp size", "Comp ratio [%]",
-			"Comp [Gbps]", "Decomp [Gbps]");
+			"Comp [Gbps]", "Decomp [Gbps]",
+			"Comp [Mops]", "Decomp [Mops]");
 	}
 
-	printf("%12u%6u%12zu%17.2f%15.2f%16.2f\n",
+	printf("%12u%6u%12zu%17.2f%15.2f%16.2f%15.3f%16.3f\n",
 		ctx->ver.mem.lcore_id,
 		test_data->level, ctx->ver.comp_data_sz, ctx->ver.ratio,
 		ctx->comp_gbps,
-		ctx->decomp_gbps);
+		ctx->decomp_gbps,
+		ctx->comp_mops,
+		ctx->decomp_mops);
 
 end:
 	return ret;
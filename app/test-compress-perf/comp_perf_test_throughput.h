@@ -19,6 +19,8 @@ struct cperf_benchmark_ctx {
 	uint64_t decomp_tsc_duration[RTE_COMP_LEVEL_MAX + 1];
 	double comp_gbps;
 	double decomp_gbps;
+	double comp_mops;
+	double decomp_mops;
 	double comp_tsc_byte;
 	double decomp_tsc_byte;
 };
@@ -114,11 +114,12 @@ comp_perf_check_capabilities(struct comp_test_data *test_data, uint8_t cdev_id)
 	return 0;
 }
 
+/* Set up one queue pair per lcore of nb_lcores, over the devices */
 static int
 comp_perf_initialize_compressdev(struct comp_test_data *test_data,
-				 uint8_t *enabled_cdevs)
+				 uint8_t *enabled_cdevs, uint8_t nb_lcores)
 {
-	uint8_t enabled_cdev_count, nb_lcores, cdev_id;
+	uint8_t enabled_cdev_count, cdev_id;
 	unsigned int i, j;
 	int ret;
 
@@ -131,7 +132,6 @@ comp_perf_initialize_compressdev(struct comp_test_data *test_data,
 		return -EINVAL;
 	}
 
-	nb_lcores = rte_lcore_count() - 1;
 	/*
 	 * Use fewer devices,
 	 * if there are more available than cores.
@@ -322,6 +322,8 @@ main(int argc, char **argv)
 	uint16_t total_nb_qps = 0;
 	uint8_t cdev_id;
 	uint32_t lcore_id;
+	uint32_t test_lcores[RTE_MAX_LCORE];
+	uint16_t nb_test_lcores = 0;
 
 	/* Initialise DPDK EAL */
 	ret = rte_eal_init(argc, argv);
@@ -355,14 +357,36 @@ main(int argc, char **argv)
 		goto end;
 	}
 
-	nb_compressdevs =
-		comp_perf_initialize_compressdev(test_data, enabled_cdevs);
+	nb_compressdevs = comp_perf_initialize_compressdev(test_data,
+			enabled_cdevs, rte_lcore_count() - 1);
 
 	if (nb_compressdevs < 1) {
 		ret = EXIT_FAILURE;
 		goto end;
 	}
 
+	/*
+	 * Run the tests on the worker lcores left idle by the started devices,
+	 * the worker lcores of the scheduler PMD being busy.
+	 */
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_eal_get_lcore_state(lcore_id) == WAIT)
+			test_lcores[nb_test_lcores++] = lcore_id;
+	}
+
+	/* Set the devices up again with a queue pair per idle lcore only */
+	if (nb_test_lcores < rte_lcore_count() - 1) {
+		for (i = 0; i < nb_compressdevs; i++)
+			rte_compressdev_stop(enabled_cdevs[i]);
+
+		nb_compressdevs = comp_perf_initialize_compressdev(test_data,
+				enabled_cdevs, nb_test_lcores);
+		if (nb_compressdevs < 1) {
+			ret = EXIT_FAILURE;
+			goto end;
+		}
+	}
+
 	test_data->cleanup = ST_COMPDEV;
 	if (comp_perf_dump_input_data(test_data) < 0) {
 		ret = EXIT_FAILURE;
@@ -386,10 +410,9 @@ main(int argc, char **argv)
 	test_data->cleanup = ST_DURING_TEST;
 	total_nb_qps = nb_compressdevs * test_data->nb_qps;
 
-	i = 0;
 	uint8_t qp_id = 0, cdev_index = 0;
 
-	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+	for (i = 0; i < nb_test_lcores; i++) {
 
 		if (i == total_nb_qps)
 			break;
@@ -405,31 +428,26 @@ main(int argc, char **argv)
 		qp_id = (qp_id + 1) % test_data->nb_qps;
 		if (qp_id == 0)
 			cdev_index++;
-		i++;
 	}
 
 	print_test_dynamics(test_data);
 
 	while (test_data->level <= test_data->level_lst.max) {
 
-		i = 0;
-		RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		for (i = 0; i < nb_test_lcores; i++) {
 
 			if (i == total_nb_qps)
 				break;
 
 			rte_eal_remote_launch(
 					cperf_testmap[test_data->test].runner,
-					ctx[i], lcore_id);
-			i++;
+					ctx[i], test_lcores[i]);
 		}
-		i = 0;
-		RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		for (i = 0; i < nb_test_lcores; i++) {
 
 			if (i == total_nb_qps)
 				break;
-			ret |= rte_eal_wait_lcore(lcore_id);
-			i++;
+			ret |= rte_eal_wait_lcore(test_lcores[i]);
 		}
 
 		if (ret != EXIT_SUCCESS)
@@ -448,15 +466,13 @@ end:
 	switch (test_data->cleanup) {
 
 	case ST_DURING_TEST:
-		i = 0;
-		RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		for (i = 0; i < nb_test_lcores; i++) {
 			if (i == total_nb_qps)
 				break;
 
 			if (ctx[i] && cperf_testmap[test_data->test].destructor)
 				cperf_testmap[test_data->test].destructor(
 									ctx[i]);
-			i++;
 		}
 		/* fallthrough */
 	case ST_INPUT_DATA:
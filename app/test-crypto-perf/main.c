@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include <rte_cycles.h>
 #include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_eal.h>
@@ -573,6 +574,49 @@ cperf_check_test_vector(struct cperf_options *opts,
 	return 0;
 }
 
+#ifdef RTE_CRYPTO_SCHEDULER
+/* Worker core utilization and reordering delay of multi-core schedulers */
+static void
+cperf_scheduler_stats_print(const struct cperf_options *opts,
+		const uint8_t *enabled_cdevs, uint8_t nb_cryptodevs)
+{
+	struct rte_cryptodev_scheduler_reorder_stats reorder;
+	struct rte_cryptodev_scheduler_mc_stats stats;
+	double delay, util;
+	uint8_t cdev_id;
+	uint16_t wc;
+	uint8_t i;
+
+	if (strcmp((const char *)opts->device_type, "crypto_scheduler"))
+		return;
+
+	for (i = 0; i < nb_cryptodevs && i < RTE_CRYPTO_MAX_DEVS; i++) {
+		cdev_id = enabled_cdevs[i];
+		if (rte_cryptodev_scheduler_mode_get(cdev_id) !=
+				CDEV_SCHED_MODE_MULTICORE)
+			continue;
+
+		printf("\n# Scheduler %u worker cores\n", cdev_id);
+		printf("%12s%16s%16s%12s\n", "Worker core", "Enqueued ops",
+			"Stolen ops", "Util (%)");
+		for (wc = 0; rte_cryptodev_scheduler_mc_stats_get(cdev_id, wc,
+				&stats) == 0; wc++) {
+			util = stats.total_cycles == 0 ? 0 :
+				100.0 * stats.busy_cycles / stats.total_cycles;
+			printf("%12u%16"PRIu64"%16"PRIu64"%12.2f\n", wc,
+				stats.enqueued_ops, stats.stolen_ops, util);
+		}
+
+		if (rte_cryptodev_scheduler_reorder_stats_get(cdev_id,
+				&reorder) != 0 || reorder.dequeued_ops == 0)
+			continue;
+		delay = (double)reorder.delay_cycles / reorder.dequeued_ops;
+		printf("# Reordering delay: %.2f cycles/op (%.3f us)\n", delay,
+			delay * 1000000 / rte_get_tsc_hz());
+	}
+}
+#endif
+
 int
 main(int argc, char **argv)
 {
@@ -798,6 +842,10 @@ main(int argc, char **argv)
 		}
 	}
 
+#ifdef RTE_CRYPTO_SCHEDULER
+	cperf_scheduler_stats_print(&opts, enabled_cdevs, nb_cryptodevs);
+#endif
+
 	i = 0;
 	RTE_LCORE_FOREACH_WORKER(lcore_id) {
 
@@ -0,0 +1,530 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_dmadev.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_random.h>
+
+#include "main.h"
+
+#define BUF_ALIGN RTE_CACHE_LINE_SIZE
+
+struct vchan_ctx {
+	uint16_t vchan;
+	uint16_t inflight;
+	/* Start time of the burst each in-flight operation belongs to,
+	 * indexed by ring_idx.
+	 */
+	uint64_t *start_tsc;
+};
+
+struct worker_ctx {
+	const struct test_cfg *cfg;
+	const struct test_case *tc;
+	int16_t dev_id;
+	uint16_t mask;
+
+	uint8_t *src;
+	uint8_t *dst;
+	rte_iova_t src_iova;
+	rte_iova_t dst_iova;
+	uint32_t stride;
+	uint32_t nb_bufs;
+	uint32_t next_buf;
+	uint16_t nb_segs;
+	struct rte_dma_sge *src_sges;
+	struct rte_dma_sge *dst_sges;
+
+	uint16_t nb_vchans;
+	struct vchan_ctx vchans[MAX_TEST_VCHANS];
+
+	/* results */
+	uint64_t ops;
+	uint64_t errors;
+	uint64_t elapsed;
+	uint64_t busy; /* cycles spent in enqueue and completion calls */
+	uint64_t *lat; /* one sample per completed operation */
+	uint64_t nb_lat;
+	int ret;
+};
+
+const char *
+op_name(enum dma_perf_op op)
+{
+	switch (op) {
+	case OP_COPY:
+		return "copy";
+	case OP_COPY_SG:
+		return "copy_sg";
+	case OP_FILL:
+		return "fill";
+	case OP_CPU_COPY:
+		return "cpu_copy";
+	default:
+		return "unknown";
+	}
+}
+
+static inline uint32_t
+next_buf(struct worker_ctx *ctx)
+{
+	uint32_t b = ctx->next_buf;
+
+	if (++ctx->next_buf == ctx->nb_bufs)
+		ctx->next_buf = 0;
+	return b;
+}
+
+static inline int
+enqueue_one(struct worker_ctx *ctx, uint16_t vchan, uint64_t flags)
+{
+	uint32_t off = next_buf(ctx) * ctx->stride;
+	uint32_t size = ctx->tc->size;
+	uint32_t seg_len;
+	uint16_t i;
+
+	switch (ctx->tc->op) {
+	case OP_COPY:
+		return rte_dma_copy(ctx->dev_id, vchan, ctx->src_iova + off,
+				ctx->dst_iova + off, size, flags);
+	case OP_FILL:
+		return rte_dma_fill(ctx->dev_id, vchan, FILL_PATTERN,
+				ctx->dst_iova + off, size, flags);
+	case OP_COPY_SG:
+		/* split the buffer evenly, the last segment takes the rest */
+		seg_len = size / ctx->nb_segs;
+		for (i = 0; i < ctx->nb_segs; i++) {
+			uint32_t seg_off = off + i * seg_len;
+
+			ctx->src_sges[i].addr = ctx->src_iova + seg_off;
+			ctx->src_sges[i].length = seg_len;
+			ctx->dst_sges[i].addr = ctx->dst_iova + seg_off;
+			ctx->dst_sges[i].length = seg_len;
+		}
+		ctx->src_sges[i - 1].length += size % ctx->nb_segs;
+		ctx->dst_sges[i - 1].length += size % ctx->nb_segs;
+		return rte_dma_copy_sg(ctx->dev_id, vchan, ctx->src_sges,
+				ctx->dst_sges, ctx->nb_segs, ctx->nb_segs,
+				flags);
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Enqueue and submit one burst. Returns the number of operations
+ * enqueued, or a negative errno value.
+ */
+static int
+dma_enqueue_burst(struct worker_ctx *ctx, struct vchan_ctx *vc, uint16_t n)
+{
+	uint64_t start = rte_rdtsc();
+	uint16_t i;
+	int ret = 0;
+
+	for (i = 0; i < n; i++) {
+		ret = enqueue_one(ctx, vc->vchan,
+				i == n - 1 ? RTE_DMA_OP_FLAG_SUBMIT : 0);
+		if (ret < 0)
+			break;
+		vc->start_tsc[ret & ctx->mask] = start;
+	}
+	if (i < n && i > 0)
+		rte_dma_submit(ctx->dev_id, vc->vchan);
+
+	ctx->busy += rte_rdtsc() - start;
+	if (i == 0 && ret != -ENOSPC)
+		return ret;
+	vc->inflight += i;
+	return i;
+}
+
+static uint16_t
+dma_complete(struct worker_ctx *ctx, struct vchan_ctx *vc, uint16_t max)
+{
+	enum rte_dma_status_code status;
+	uint64_t start = rte_rdtsc();
+	uint64_t now;
+	uint16_t last_idx, idx;
+	bool has_error = false;
+	uint16_t nb, i;
+
+	nb = rte_dma_completed(ctx->dev_id, vc->vchan, max, &last_idx,
+			&has_error);
+	if (has_error) {
+		/* skip past the failed operation */
+		nb += rte_dma_completed_status(ctx->dev_id, vc->vchan, 1,
+				&last_idx, &status);
+		ctx->errors++;
+	}
+	if (nb == 0)
+		return 0;
+
+	now = rte_rdtsc();
+	ctx->busy += now - start;
+	idx = last_idx - nb + 1;
+	for (i = 0; i < nb; i++, idx++)
+		ctx->lat[ctx->nb_lat++] = now - vc->start_tsc[idx & ctx->mask];
+	vc->inflight -= nb;
+	return nb;
+}
+
+static int
+dma_worker(void *arg)
+{
+	struct worker_ctx *ctx = arg;
+	uint64_t nb_ops = ctx->cfg->nb_ops;
+	uint16_t burst = ctx->tc->burst;
+	uint16_t ring_size = ctx->mask + 1;
+	uint64_t enqueued = 0, completed = 0;
+	uint64_t start;
+	uint16_t i, n;
+	int ret;
+
+	start = rte_rdtsc();
+	while (completed < nb_ops && !force_quit) {
+		for (i = 0; i < ctx->nb_vchans; i++) {
+			struct vchan_ctx *vc = &ctx->vchans[i];
+
+			n = RTE_MIN(burst, nb_ops - enqueued);
+			if (n > 0 && vc->inflight + n <= ring_size) {
+				ret = dma_enqueue_burst(ctx, vc, n);
+				if (ret < 0) {
+					ctx->ret = ret;
+					goto out;
+				}
+				enqueued += ret;
+			}
+			completed += dma_complete(ctx, vc, burst);
+		}
+	}
+out:
+	ctx->elapsed = rte_rdtsc() - start;
+	ctx->ops = completed;
+
+	/* drain what is left, so the device can be stopped cleanly */
+	for (i = 0; i < ctx->nb_vchans; i++) {
+		uint64_t timeout = rte_get_tsc_cycles() + rte_get_tsc_hz();
+
+		while (ctx->vchans[i].inflight > 0 &&
+				rte_get_tsc_cycles() < timeout)
+			dma_complete(ctx, &ctx->vchans[i], burst);
+	}
+	return 0;
+}
+
+static int
+cpu_worker(void *arg)
+{
+	struct worker_ctx *ctx = arg;
+	uint64_t nb_ops = ctx->cfg->nb_ops;
+	uint32_t size = ctx->tc->size;
+	uint64_t start, burst_start;
+	uint64_t done = 0;
+	uint16_t i, n;
+
+	start = rte_rdtsc();
+	while (done < nb_ops && !force_quit) {
+		n = RTE_MIN(ctx->tc->burst, nb_ops - done);
+		burst_start = rte_rdtsc();
+		for (i = 0; i < n; i++) {
+			uint32_t off = next_buf(ctx) * ctx->stride;
+
+			rte_memcpy(ctx->dst + off, ctx->src + off, size);
+			ctx->lat[ctx->nb_lat++] = rte_rdtsc() - burst_start;
+		}
+		done += n;
+	}
+	ctx->elapsed = rte_rdtsc() - start;
+	ctx->busy = ctx->elapsed;
+	ctx->ops = done;
+	return 0;
+}
+
+static int
+dma_dev_setup(int16_t dev_id, uint16_t nb_vchans, uint16_t ring_size)
+{
+	struct rte_dma_conf dev_conf = { .nb_vchans = nb_vchans };
+	struct rte_dma_vchan_conf qconf = {
+		.direction = RTE_DMA_DIR_MEM_TO_MEM,
+		.nb_desc = ring_size,
+	};
+	uint16_t i;
+	int ret;
+
+	ret = rte_dma_configure(dev_id, &dev_conf);
+	if (ret < 0) {
+		printf("Error configuring dmadev %d: %d\n", dev_id, ret);
+		return ret;
+	}
+	for (i = 0; i < nb_vchans; i++) {
+		ret = rte_dma_vchan_setup(dev_id, i, &qconf);
+		if (ret < 0) {
+			printf("Error setting up vchan %u: %d\n", i, ret);
+			return ret;
+		}
+	}
+	ret = rte_dma_start(dev_id);
+	if (ret < 0)
+		printf("Error starting dmadev %d: %d\n", dev_id, ret);
+	return ret;
+}
+
+/* Use the worker lcores that are idle once the device is started, so
+ * lcores taken by a software DMA device are skipped.
+ */
+static int
+select_lcores(unsigned int *lcores, uint16_t nb_lcores)
+{
+	unsigned int lcore_id;
+	uint16_t n = 0;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (n == nb_lcores)
+			break;
+		if (rte_eal_get_lcore_state(lcore_id) == WAIT)
+			lcores[n++] = lcore_id;
+	}
+	return n == nb_lcores ? 0 : -ENOSPC;
+}
+
+static void
+worker_free(struct worker_ctx *ctx)
+{
+	uint16_t i;
+
+	for (i = 0; i < ctx->nb_vchans; i++)
+		rte_free(ctx->vchans[i].start_tsc);
+	rte_free(ctx->src);
+	rte_free(ctx->dst);
+	rte_free(ctx->src_sges);
+	free(ctx->lat);
+}
+
+static int
+worker_init(struct worker_ctx *ctx, const struct test_cfg *cfg,
+		const struct test_case *tc, unsigned int lcore_id,
+		uint16_t worker_idx, uint16_t ring_size, uint16_t nb_segs)
+{
+	int socket = rte_lcore_to_socket_id(lcore_id);
+	size_t buf_len;
+	uint32_t i;
+	uint16_t v;
+
+	ctx->cfg = cfg;
+	ctx->tc = tc;
+	ctx->dev_id = cfg->dev_id;
+	ctx->mask = ring_size - 1;
+	ctx->nb_bufs = cfg->nb_bufs;
+	ctx->nb_segs = nb_segs;
+	ctx->stride = RTE_ALIGN_CEIL(tc->size, BUF_ALIGN);
+	buf_len = (size_t)ctx->stride * ctx->nb_bufs;
+
+	ctx->src = rte_malloc_socket(NULL, buf_len, BUF_ALIGN, socket);
+	ctx->dst = rte_malloc_socket(NULL, buf_len, BUF_ALIGN, socket);
+	ctx->src_sges = rte_calloc_socket(NULL, 2 * RTE_MAX(nb_segs, 1),
+			sizeof(*ctx->src_sges), 0, socket);
+	ctx->lat = malloc(sizeof(*ctx->lat) * cfg->nb_ops);
+	if (ctx->src == NULL || ctx->dst == NULL ||
+			ctx->src_sges == NULL || ctx->lat == NULL)
+		return -ENOMEM;
+	ctx->dst_sges = ctx->src_sges + RTE_MAX(nb_segs, 1);
+	ctx->src_iova = rte_malloc_virt2iova(ctx->src);
+	ctx->dst_iova = rte_malloc_virt2iova(ctx->dst);
+
+	for (i = 0; i < buf_len / sizeof(uint64_t); i++)
+		((uint64_t *)ctx->src)[i] = rte_rand();
+	memset(ctx->dst, 0, buf_len);
+
+	if (tc->op == OP_CPU_COPY)
+		return 0;
+
+	/* worker n drives vchans n, n + nb_lcores, ... */
+	for (v = worker_idx; v < tc->nb_vchans; v += tc->nb_lcores) {
+		struct vchan_ctx *vc = &ctx->vchans[ctx->nb_vchans++];
+
+		vc->vchan = v;
+		vc->start_tsc = rte_calloc_socket(NULL, ring_size,
+				sizeof(*vc->start_tsc), 0, socket);
+		if (vc->start_tsc == NULL)
+			return -ENOMEM;
+	}
+	return 0;
+}
+
+static int
+worker_verify(const struct worker_ctx *ctx)
+{
+	uint32_t nb_bufs = RTE_MIN((uint64_t)ctx->nb_bufs, ctx->ops);
+	uint32_t b, i;
+
+	for (b = 0; b < nb_bufs; b++) {
+		const uint8_t *src = ctx->src + b * ctx->stride;
+		const uint8_t *dst = ctx->dst + b * ctx->stride;
+
+		if (ctx->tc->op != OP_FILL) {
+			if (memcmp(src, dst, ctx->tc->size) != 0)
+				return -1;
+			continue;
+		}
+		for (i = 0; i < ctx->tc->size; i++)
+			if (dst[i] != (uint8_t)FILL_PATTERN)
+				return -1;
+	}
+	return 0;
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void
+compute_latency(struct worker_ctx *ctxs, uint16_t nb_ctxs,
+		struct test_result *res)
+{
+	double ns_per_cycle = 1E9 / rte_get_tsc_hz();
+	uint64_t total = 0, n = 0;
+	uint64_t *lat;
+	uint16_t i;
+
+	for (i = 0; i < nb_ctxs; i++)
+		total += ctxs[i].nb_lat;
+	if (total == 0)
+		return;
+	lat = malloc(sizeof(*lat) * total);
+	if (lat == NULL)
+		return;
+	for (i = 0; i < nb_ctxs; i++) {
+		memcpy(lat + n, ctxs[i].lat, sizeof(*lat) * ctxs[i].nb_lat);
+		n += ctxs[i].nb_lat;
+	}
+	qsort(lat, total, sizeof(*lat), cmp_u64);
+
+	res->lat_p50 = lat[(total - 1) * 50 / 100] * ns_per_cycle;
+	res->lat_p99 = lat[(total - 1) * 99 / 100] * ns_per_cycle;
+	res->lat_p999 = lat[(total - 1) * 999 / 1000] * ns_per_cycle;
+	res->lat_max = lat[total - 1] * ns_per_cycle;
+	free(lat);
+}
+
+int
+run_test_case(const struct test_cfg *cfg, const struct test_case *tc,
+		struct test_result *res)
+{
+	struct worker_ctx *ctxs;
+	unsigned int lcores[MAX_TEST_LCORES];
+	struct rte_dma_info info;
+	uint16_t ring_size = cfg->ring_size;
+	uint16_t nb_segs = 0;
+	bool dma = tc->op != OP_CPU_COPY;
+	uint64_t max_elapsed = 0, busy = 0;
+	uint16_t i;
+	int ret;
+
+	memset(res, 0, sizeof(*res));
+	if (tc->nb_lcores > MAX_TEST_LCORES)
+		return -ENOTSUP;
+
+	if (dma) {
+		if (rte_dma_info_get(cfg->dev_id, &info) < 0)
+			return -ENODEV;
+		if (tc->op == OP_FILL &&
+				!(info.dev_capa & RTE_DMA_CAPA_OPS_FILL))
+			return -ENOTSUP;
+		if (tc->op == OP_COPY_SG) {
+			if (!(info.dev_capa & RTE_DMA_CAPA_OPS_COPY_SG))
+				return -ENOTSUP;
+			nb_segs = RTE_MIN(cfg->nb_sges, info.max_sges);
+			nb_segs = RTE_MIN((uint32_t)nb_segs, tc->size);
+			if (nb_segs == 0)
+				return -ENOTSUP;
+		}
+		/* each lcore needs at least one vchan of its own */
+		if (tc->nb_vchans > RTE_MIN(info.max_vchans, MAX_TEST_VCHANS) ||
+				tc->nb_vchans < tc->nb_lcores)
+			return -ENOTSUP;
+		ring_size = RTE_MAX(ring_size, info.min_desc);
+		ring_size = RTE_MIN(ring_size, info.max_desc);
+		if (!rte_is_power_of_2(ring_size) || tc->burst > ring_size)
+			return -ENOTSUP;
+
+		ret = dma_dev_setup(cfg->dev_id, tc->nb_vchans, ring_size);
+		if (ret < 0)
+			goto stop;
+	}
+
+	ret = select_lcores(lcores, tc->nb_lcores);
+	if (ret < 0) {
+		ret = -ENOTSUP;
+		goto stop;
+	}
+
+	ctxs = calloc(tc->nb_lcores, sizeof(*ctxs));
+	if (ctxs == NULL) {
+		ret = -ENOMEM;
+		goto stop;
+	}
+	for (i = 0; i < tc->nb_lcores; i++) {
+		ret = worker_init(&ctxs[i], cfg, tc, lcores[i], i, ring_size,
+				nb_segs);
+		if (ret < 0)
+			goto free;
+	}
+
+	for (i = 0; i < tc->nb_lcores; i++)
+		rte_eal_remote_launch(dma ? dma_worker : cpu_worker,
+				&ctxs[i], lcores[i]);
+	/* not rte_eal_mp_wait_lcore(), the device may own other lcores */
+	for (i = 0; i < tc->nb_lcores; i++)
+		rte_eal_wait_lcore(lcores[i]);
+
+	for (i = 0; i < tc->nb_lcores; i++) {
+		if (ctxs[i].ret < 0) {
+			ret = ctxs[i].ret;
+			printf("Error on lcore %u: %d\n", lcores[i], ret);
+			goto free;
+		}
+		if (cfg->verify && worker_verify(&ctxs[i]) < 0) {
+			printf("Data mismatch on lcore %u\n", lcores[i]);
+			ret = -EIO;
+			goto free;
+		}
+		res->ops += ctxs[i].ops;
+		res->errors += ctxs[i].errors;
+		busy += ctxs[i].busy;
+		max_elapsed = RTE_MAX(max_elapsed, ctxs[i].elapsed);
+	}
+
+	if (res->ops > 0 && max_elapsed > 0) {
+		double secs = (double)max_elapsed / rte_get_tsc_hz();
+
+		res->mops = res->ops / secs / 1E6;
+		res->gbps = res->mops * tc->size * 8 / 1E3;
+		res->cycles_per_op = (double)busy / res->ops;
+	}
+	compute_latency(ctxs, tc->nb_lcores, res);
+
+free:
+	for (i = 0; i < tc->nb_lcores; i++)
+		worker_free(&ctxs[i]);
+	free(ctxs);
+stop:
+	if (dma)
+		rte_dma_stop(cfg->dev_id);
+	return ret;
+}
@@ -0,0 +1,364 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_dmadev.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_string_fns.h>
+
+#include "main.h"
+
+enum app_args {
+	ARG_HELP = 256,
+	ARG_DMA,
+	ARG_OPS,
+	ARG_SIZES,
+	ARG_BURSTS,
+	ARG_VCHANS,
+	ARG_LCORES,
+	ARG_NB_OPS,
+	ARG_NB_BUFS,
+	ARG_RING_SIZE,
+	ARG_SGES,
+	ARG_VERIFY,
+	ARG_CSV,
+};
+
+volatile bool force_quit;
+
+static void
+signal_handler(int signum)
+{
+	if (signum == SIGINT || signum == SIGTERM) {
+		printf("\nSignal %d received, preparing to exit...\n", signum);
+		force_quit = true;
+	}
+}
+
+static void
+usage(const char *prog_name)
+{
+	printf("%s [EAL options] --\n"
+		" --dma NAME: dmadev to test (default: the first one)\n"
+		" --ops LIST: operations among copy, copy_sg, fill and\n"
+		"             cpu_copy (default: copy,cpu_copy)\n"
+		" --sizes LIST: operation sizes in bytes"
+		" (default: 64,256,1024,4096,65536)\n"
+		" --bursts LIST: burst sizes (default: 32)\n"
+		" --vchans LIST: numbers of vchans (default: 1)\n"
+		" --lcores LIST: numbers of test lcores (default: 1)\n"
+		" --nb-ops N: operations per lcore (default: %u)\n"
+		" --nb-bufs N: buffers per lcore (default: %u)\n"
+		" --ring-size N: descriptors per vchan (default: %u)\n"
+		" --sges N: segments per scatter-gather copy (default: %u)\n"
+		" --verify: check the destination buffers after each test\n"
+		" --csv: print the results as CSV\n"
+		"LIST is a comma separated list of values, each test is run\n"
+		"for every combination of them.\n",
+		prog_name, DEFAULT_NB_OPS, DEFAULT_NB_BUFS, DEFAULT_RING_SIZE,
+		DEFAULT_NB_SGES);
+}
+
+static int
+parse_uint(const char *str, uint32_t min, uint32_t max, uint32_t *val)
+{
+	unsigned long v;
+	char *end;
+
+	errno = 0;
+	v = strtoul(str, &end, 0);
+	if (errno != 0 || end == str || *end != '\0' || v < min || v > max)
+		return -1;
+	*val = v;
+	return 0;
+}
+
+static int
+parse_sweep(const char *str, uint32_t min, uint32_t max, struct sweep *s)
+{
+	char buf[256];
+	char *tok, *save;
+
+	if (strlcpy(buf, str, sizeof(buf)) >= sizeof(buf))
+		return -1;
+	s->nb = 0;
+	for (tok = strtok_r(buf, ",", &save); tok != NULL;
+			tok = strtok_r(NULL, ",", &save)) {
+		if (s->nb == MAX_SWEEP_VALUES ||
+				parse_uint(tok, min, max, &s->val[s->nb]) < 0)
+			return -1;
+		s->nb++;
+	}
+	return s->nb > 0 ? 0 : -1;
+}
+
+static int
+parse_ops(const char *str, bool *ops)
+{
+	char buf[256];
+	char *tok, *save;
+	int op;
+
+	if (strlcpy(buf, str, sizeof(buf)) >= sizeof(buf))
+		return -1;
+	memset(ops, 0, sizeof(bool) * OP_MAX);
+	for (tok = strtok_r(buf, ",", &save); tok != NULL;
+			tok = strtok_r(NULL, ",", &save)) {
+		for (op = 0; op < OP_MAX; op++)
+			if (strcmp(tok, op_name(op)) == 0)
+				break;
+		if (op == OP_MAX)
+			return -1;
+		ops[op] = true;
+	}
+	return 0;
+}
+
+static void
+set_defaults(struct test_cfg *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->dev_id = -1;
+	cfg->ops[OP_COPY] = true;
+	cfg->ops[OP_CPU_COPY] = true;
+	parse_sweep("64,256,1024,4096,65536", 1, UINT32_MAX, &cfg->sizes);
+	parse_sweep("32", 1, UINT16_MAX, &cfg->bursts);
+	parse_sweep("1", 1, UINT16_MAX, &cfg->vchans);
+	parse_sweep("1", 1, MAX_TEST_LCORES, &cfg->lcores);
+	cfg->nb_ops = DEFAULT_NB_OPS;
+	cfg->nb_bufs = DEFAULT_NB_BUFS;
+	cfg->ring_size = DEFAULT_RING_SIZE;
+	cfg->nb_sges = DEFAULT_NB_SGES;
+}
+
+static void
+args_parse(int argc, char **argv, struct test_cfg *cfg, const char **dma)
+{
+	static struct option lgopts[] = {
+		{ "help", 0, 0, ARG_HELP },
+		{ "dma", 1, 0, ARG_DMA },
+		{ "ops", 1, 0, ARG_OPS },
+		{ "sizes", 1, 0, ARG_SIZES },
+		{ "bursts", 1, 0, ARG_BURSTS },
+		{ "vchans", 1, 0, ARG_VCHANS },
+		{ "lcores", 1, 0, ARG_LCORES },
+		{ "nb-ops", 1, 0, ARG_NB_OPS },
+		{ "nb-bufs", 1, 0, ARG_NB_BUFS },
+		{ "ring-size", 1, 0, ARG_RING_SIZE },
+		{ "sges", 1, 0, ARG_SGES },
+		{ "verify", 0, 0, ARG_VERIFY },
+		{ "csv", 0, 0, ARG_CSV },
+		{ 0, 0, 0, 0 }
+	};
+	uint32_t val;
+	int opt, opt_idx;
+	int ret = 0;
+
+	while ((opt = getopt_long(argc, argv, "", lgopts, &opt_idx)) != EOF) {
+		switch (opt) {
+		case ARG_DMA:
+			*dma = optarg;
+			break;
+		case ARG_OPS:
+			ret = parse_ops(optarg, cfg->ops);
+			break;
+		case ARG_SIZES:
+			ret = parse_sweep(optarg, 1, UINT32_MAX, &cfg->sizes);
+			break;
+		case ARG_BURSTS:
+			ret = parse_sweep(optarg, 1, UINT16_MAX, &cfg->bursts);
+			break;
+		case ARG_VCHANS:
+			ret = parse_sweep(optarg, 1, UINT16_MAX, &cfg->vchans);
+			break;
+		case ARG_LCORES:
+			ret = parse_sweep(optarg, 1, MAX_TEST_LCORES,
+					&cfg->lcores);
+			break;
+		case ARG_NB_OPS:
+			ret = parse_uint(optarg, 1, UINT32_MAX, &cfg->nb_ops);
+			break;
+		case ARG_NB_BUFS:
+			ret = parse_uint(optarg, 1, UINT32_MAX, &cfg->nb_bufs);
+			break;
+		case ARG_RING_SIZE:
+			ret = parse_uint(optarg, 1, UINT16_MAX, &val);
+			cfg->ring_size = val;
+			break;
+		case ARG_SGES:
+			ret = parse_uint(optarg, 1, UINT16_MAX, &val);
+			cfg->nb_sges = val;
+			break;
+		case ARG_VERIFY:
+			cfg->verify = true;
+			break;
+		case ARG_CSV:
+			cfg->csv = true;
+			break;
+		case ARG_HELP:
+			usage(argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(argv[0]);
+			rte_exit(EXIT_FAILURE, "Invalid option: %s\n",
+					argv[optind - 1]);
+		}
+		if (ret < 0) {
+			usage(argv[0]);
+			rte_exit(EXIT_FAILURE, "Invalid value for --%s: %s\n",
+					lgopts[opt_idx].name, optarg);
+		}
+	}
+}
+
+static void
+print_header(const struct test_cfg *cfg)
+{
+	if (cfg->csv) {
+		printf("op,size,burst,vchans,lcores,ops,errors,mops,gbps,"
+			"cycles_per_op,lat_p50_ns,lat_p99_ns,lat_p999_ns,"
+			"lat_max_ns\n");
+		return;
+	}
+	printf("%9s %8s %5s %6s %6s %10s %9s %10s %10s %10s %10s %10s\n",
+		"op", "size", "burst", "vchans", "lcores", "Mops", "Gbps",
+		"cycles/op", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+}
+
+static void
+print_result(const struct test_cfg *cfg, const struct test_case *tc,
+		const struct test_result *res)
+{
+	if (cfg->csv) {
+		printf("%s,%u,%u,%u,%u,%" PRIu64 ",%" PRIu64
+			",%.3f,%.3f,%.1f,%.0f,%.0f,%.0f,%.0f\n",
+			op_name(tc->op), tc->size, tc->burst, tc->nb_vchans,
+			tc->nb_lcores, res->ops, res->errors, res->mops,
+			res->gbps, res->cycles_per_op, res->lat_p50,
+			res->lat_p99, res->lat_p999, res->lat_max);
+		return;
+	}
+	printf("%9s %8u %5u %6u %6u %10.3f %9.3f %10.1f %10.0f %10.0f"
+		" %10.0f %10.0f\n",
+		op_name(tc->op), tc->size, tc->burst, tc->nb_vchans,
+		tc->nb_lcores, res->mops, res->gbps, res->cycles_per_op,
+		res->lat_p50, res->lat_p99, res->lat_p999, res->lat_max);
+	if (res->errors > 0)
+		printf("%9s %" PRIu64 " operations failed\n", "", res->errors);
+}
+
+static int
+run_sweep(const struct test_cfg *cfg)
+{
+	uint32_t nb_cases = cfg->sizes.nb * cfg->bursts.nb *
+			cfg->vchans.nb * cfg->lcores.nb;
+	struct test_result res;
+	struct test_case tc;
+	uint32_t i, idx;
+	uint16_t v;
+	int op, ret;
+
+	print_header(cfg);
+	for (op = 0; op < OP_MAX; op++) {
+		if (!cfg->ops[op])
+			continue;
+		if (op != OP_CPU_COPY && cfg->dev_id < 0) {
+			printf("No dmadev, skipping %s tests\n", op_name(op));
+			continue;
+		}
+		tc.op = op;
+		/* every combination, with the lcore count varying fastest */
+		for (i = 0; i < nb_cases && !force_quit; i++) {
+			idx = i;
+			tc.nb_lcores = cfg->lcores.val[idx % cfg->lcores.nb];
+			idx /= cfg->lcores.nb;
+			v = idx % cfg->vchans.nb;
+			idx /= cfg->vchans.nb;
+			tc.burst = cfg->bursts.val[idx % cfg->bursts.nb];
+			idx /= cfg->bursts.nb;
+			tc.size = cfg->sizes.val[idx];
+
+			/* the CPU baseline does not use vchans */
+			if (op == OP_CPU_COPY && v > 0)
+				continue;
+			tc.nb_vchans = op == OP_CPU_COPY ?
+					0 : cfg->vchans.val[v];
+
+			ret = run_test_case(cfg, &tc, &res);
+			if (ret == -ENOTSUP) {
+				if (!cfg->csv)
+					printf("%9s %8u %5u %6u %6u  skipped,"
+						" not supported\n",
+						op_name(op), tc.size, tc.burst,
+						tc.nb_vchans, tc.nb_lcores);
+				continue;
+			}
+			if (ret < 0) {
+				printf("Test %s size %u burst %u vchans %u"
+					" lcores %u failed: %s\n",
+					op_name(op), tc.size, tc.burst,
+					tc.nb_vchans, tc.nb_lcores,
+					strerror(-ret));
+				return ret;
+			}
+			print_result(cfg, &tc, &res);
+		}
+	}
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *dma = NULL;
+	struct test_cfg cfg;
+	int ret;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Invalid EAL arguments\n");
+	argc -= ret;
+	argv += ret;
+
+	force_quit = false;
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+
+	set_defaults(&cfg);
+	args_parse(argc, argv, &cfg, &dma);
+
+	if (dma != NULL) {
+		cfg.dev_id = rte_dma_get_dev_id_by_name(dma);
+		if (cfg.dev_id < 0)
+			rte_exit(EXIT_FAILURE, "Unknown dmadev %s\n", dma);
+	} else if (rte_dma_count_avail() > 0) {
+		cfg.dev_id = rte_dma_next_dev(0);
+	}
+	if (rte_lcore_count() < 2)
+		rte_exit(EXIT_FAILURE, "At least one worker lcore is needed\n");
+
+	if (cfg.dev_id >= 0) {
+		struct rte_dma_info info;
+
+		rte_dma_info_get(cfg.dev_id, &info);
+		printf("Testing dmadev %d (%s)\n", cfg.dev_id, info.dev_name);
+	}
+
+	ret = run_sweep(&cfg);
+
+	if (cfg.dev_id >= 0)
+		rte_dma_close(cfg.dev_id);
+	rte_eal_cleanup();
+
+	return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
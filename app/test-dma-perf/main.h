@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef _MAIN_H_
+#define _MAIN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#define MAX_SWEEP_VALUES 16
+#define MAX_TEST_LCORES 64
+#define MAX_TEST_VCHANS 64
+
+#define DEFAULT_NB_OPS 100000
+#define DEFAULT_NB_BUFS 256
+#define DEFAULT_RING_SIZE 1024
+#define DEFAULT_NB_SGES 4
+
+/* Each byte of the fill pattern is the same, so the result can be
+ * checked byte by byte whatever the length.
+ */
+#define FILL_PATTERN 0xa5a5a5a5a5a5a5a5ULL
+
+enum dma_perf_op {
+	OP_COPY,
+	OP_COPY_SG,
+	OP_FILL,
+	OP_CPU_COPY,
+	OP_MAX
+};
+
+struct sweep {
+	uint32_t val[MAX_SWEEP_VALUES];
+	uint16_t nb;
+};
+
+struct test_cfg {
+	int16_t dev_id; /* -1 if no dmadev is used */
+	bool ops[OP_MAX];
+	struct sweep sizes;
+	struct sweep bursts;
+	struct sweep vchans;
+	struct sweep lcores;
+	uint32_t nb_ops; /* per lcore */
+	uint32_t nb_bufs; /* per lcore */
+	uint16_t ring_size;
+	uint16_t nb_sges;
+	bool verify;
+	bool csv;
+};
+
+struct test_case {
+	enum dma_perf_op op;
+	uint32_t size;
+	uint16_t burst;
+	uint16_t nb_vchans;
+	uint16_t nb_lcores;
+};
+
+struct test_result {
+	uint64_t ops;
+	uint64_t errors;
+	double mops;
+	double gbps;
+	double cycles_per_op;
+	double lat_p50; /* nanoseconds */
+	double lat_p99;
+	double lat_p999;
+	double lat_max;
+};
+
+extern volatile bool force_quit;
+
+const char *op_name(enum dma_perf_op op);
+
+/* Run one test case on idle worker lcores. Returns 0 on success,
+ * -ENOTSUP if the case does not apply to the device or there are not
+ * enough lcores, or a negative errno value on failure.
+ */
+int run_test_case(const struct test_cfg *cfg, const struct test_case *tc,
+		struct test_result *res);
+
+#endif /* _MAIN_H_ */
@@ -154,6 +154,34 @@ evt_service_setup(uint32_t service_id)
 	return 0;
 }
 
+/*
+ * Map the scheduler service of an event device. A multi-thread safe service
+ * (e.g. event/sw with several scheduler instances) is mapped to all service
+ * lcores so that scheduling scales with them.
+ */
+static inline int
+evt_sched_service_setup(uint32_t service_id)
+{
+	uint32_t core_array[RTE_MAX_LCORE];
+	int32_t core_cnt;
+
+	if (rte_service_probe_capability(service_id,
+			RTE_SERVICE_CAP_MT_SAFE) != 1)
+		return evt_service_setup(service_id);
+
+	core_cnt = rte_service_lcore_list(core_array, RTE_MAX_LCORE);
+	if (core_cnt <= 0)
+		return -ENOENT;
+
+	while (core_cnt--) {
+		if (rte_service_map_lcore_set(service_id,
+				core_array[core_cnt], 1))
+			return -ENOENT;
+	}
+
+	return 0;
+}
+
 static inline int
 evt_configure_eventdev(struct evt_options *opt, uint8_t nb_queues,
 		uint8_t nb_ports)
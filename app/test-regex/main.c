@@ -72,6 +72,10 @@ struct regex_conf {
 	long data_len;
 	long job_len;
 	uint32_t nb_segs;
+	/* Filled by the lcore for the aggregate report */
+	uint64_t nb_bytes;
+	uint64_t nb_matches;
+	uint64_t cycles;
 };
 
 static void
@@ -293,6 +297,11 @@ init_port(uint16_t *nb_max_payload, char *rules_file, uint8_t *nb_max_matches,
 				goto error;
 			}
 		}
+		res = rte_regexdev_start(id);
+		if (res < 0) {
+			printf("Error, can't start device %d.\n", id);
+			goto error;
+		}
 		printf(":: initializing device: %d done\n", id);
 	}
 	rte_free(rules);
@@ -400,6 +409,7 @@ run_regex(void *args)
 	struct qp_params *qps = NULL;
 	bool update;
 	uint16_t qps_used = 0;
+	uint64_t start;
 	char mbuf_pool[16];
 
 	shinfo.free_cb = extbuf_free_cb;
@@ -501,6 +511,7 @@ run_regex(void *args)
 		qp->cycles = 0;
 	}
 
+	start = rte_rdtsc_precise();
 	for (i = 0; i < nb_iterations; i++) {
 		for (qp_id = 0; qp_id < nb_qps; qp_id++) {
 			qp = &qps[qp_id];
@@ -548,6 +559,14 @@ run_regex(void *args)
 			}
 		} while (update);
 	}
+	rgxc->cycles = rte_rdtsc_precise() - start;
+	rgxc->nb_bytes = (uint64_t)data_len * nb_qps * nb_iterations;
+	for (qp_id = 0; qp_id < nb_qps; qp_id++) {
+		qp = &qps[qp_id];
+		for (i = 0; i < actual_jobs; i++)
+			rgxc->nb_matches += qp->ops[i]->nb_matches;
+	}
+	rgxc->nb_matches *= nb_iterations;
 	for (qp_id = 0; qp_id < nb_qps; qp_id++) {
 		qp = &qps[qp_id];
 		time = (long double)qp->cycles / rte_get_timer_hz();
@@ -643,6 +662,9 @@ distribute_qps_to_lcores(uint32_t nb_cores, uint32_t nb_qps,
 	RTE_LCORE_FOREACH_WORKER(lcore_id) {
 		if (detected_lcores >= nb_cores)
 			break;
+		/* Skip the lcores a started device scans on. */
+		if (rte_eal_get_lcore_state(lcore_id) != WAIT)
+			continue;
 		qps_per_lcore[detected_lcores].lcore_id = lcore_id;
 		socket = rte_lcore_to_socket_id(lcore_id);
 		if (socket == SOCKET_ID_ANY)
@@ -694,6 +716,10 @@ main(int argc, char **argv)
 	struct regex_conf *rgxc;
 	uint32_t i;
 	struct qps_per_lcore *qps_per_lcore;
+	uint64_t nb_bytes = 0;
+	uint64_t nb_matches = 0;
+	uint64_t cycles = 0;
+	long double time;
 
 	/* Init EAL. */
 	ret = rte_eal_init(argc, argv);
@@ -710,12 +736,15 @@ main(int argc, char **argv)
 		rte_exit(EXIT_FAILURE, "Number of QPs must be greater than 0\n");
 	if (nb_lcores == 0)
 		rte_exit(EXIT_FAILURE, "Number of lcores must be greater than 0\n");
-	if (distribute_qps_to_lcores(nb_lcores, nb_qps, &qps_per_lcore) < 0)
-		rte_exit(EXIT_FAILURE, "Failed to distribute queues to lcores!\n");
+	/* Started devices may run on worker lcores, init them first so
+	 * the queues go to the lcores left.
+	 */
 	ret = init_port(&nb_max_payload, rules_file,
 			&nb_max_matches, nb_qps);
 	if (ret < 0)
 		rte_exit(EXIT_FAILURE, "init port failed\n");
+	if (distribute_qps_to_lcores(nb_lcores, nb_qps, &qps_per_lcore) < 0)
+		rte_exit(EXIT_FAILURE, "Failed to distribute queues to lcores!\n");
 
 	data_len = read_file(data_file, &data_buf);
 	if (data_len <= 0)
@@ -747,7 +776,23 @@ main(int argc, char **argv)
 		rte_eal_remote_launch(run_regex, &rgxc[i],
 				      qps_per_lcore[i].lcore_id);
 	}
-	rte_eal_mp_wait_lcore();
+	/* Not all workers, those of the devices run until they stop. */
+	for (i = 0; i < nb_lcores; i++)
+		rte_eal_wait_lcore(qps_per_lcore[i].lcore_id);
+	for (i = 0; i < nb_lcores; i++) {
+		nb_bytes += rgxc[i].nb_bytes;
+		nb_matches += rgxc[i].nb_matches;
+		cycles = RTE_MAX(cycles, rgxc[i].cycles);
+	}
+	if (cycles != 0) {
+		time = (long double)cycles / rte_get_timer_hz();
+		printf("Total: Lcores=%u QPs=%u Bytes=%"PRIu64" Time=%Lf sec "
+		       "Perf=%Lf Gbps Matches=%"PRIu64"\n", nb_lcores, nb_qps,
+		       nb_bytes, time, (nb_bytes * 8 / time) / 1000000000.0,
+		       nb_matches);
+	}
+	for (i = 0; i < rte_regexdev_count(); i++)
+		rte_regexdev_stop(i);
 	rte_free(data_buf);
 	rte_free(rgxc);
 	rte_free(qps_per_lcore);
@@ -64,6 +64,7 @@ do_recursive_call(void)
 	} actions[] =  {
 #ifndef RTE_EXEC_ENV_WINDOWS
 			{ "run_secondary_instances", test_mp_secondary },
+			{ "test_trace_stream", test_trace_stream_events },
 #endif
 #ifdef RTE_LIB_PDUMP
 #ifdef RTE_NET_RING
@@ -8,6 +8,7 @@
 #include <unistd.h>
 #include <stdio.h>
 
+#include <rte_bus_vdev.h>
 #include <rte_cycles.h>
 #include <rte_malloc.h>
 #include <rte_mempool.h>
@@ -4176,6 +4177,404 @@ end:
 	return ret;
 }
 
+#ifdef RTE_COMPRESS_SCHEDULER
+
+#define SCHED_NAME "compress_scheduler_test"
+#define SCHED_WORKER_DRIVER "compress_zlib"
+#define SCHED_MAX_WORKERS 4
+#define SCHED_NB_OPS 96
+#define SCHED_MAX_BURST 32
+#define SCHED_DEQ_RETRIES 1000
+#define SCHED_DEQ_WAIT_US 1000
+
+struct scheduler_testsuite_params {
+	uint8_t dev_id;
+	uint32_t buf_size;
+	struct rte_mempool *mbuf_pool;
+	struct rte_mempool *op_pool;
+};
+
+static struct scheduler_testsuite_params sched_params;
+
+/* The device is kept, a compress device name cannot be allocated twice */
+static void
+scheduler_testsuite_teardown(void)
+{
+	rte_mempool_free(sched_params.mbuf_pool);
+	rte_mempool_free(sched_params.op_pool);
+	sched_params.mbuf_pool = NULL;
+	sched_params.op_pool = NULL;
+}
+
+static int
+scheduler_testsuite_setup(void)
+{
+	char vdev_args[128];
+	unsigned int i, lcore_id, nb_workers = 0;
+	int len, dev_id;
+
+	len = snprintf(vdev_args, sizeof(vdev_args),
+			"worker_driver=%s,corelist=", SCHED_WORKER_DRIVER);
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (nb_workers == SCHED_MAX_WORKERS)
+			break;
+		len += snprintf(vdev_args + len, sizeof(vdev_args) - len,
+				"%s%u", nb_workers == 0 ? "" : ":", lcore_id);
+		nb_workers++;
+	}
+	if (nb_workers < 2) {
+		RTE_LOG(WARNING, USER1,
+			"Compress scheduler test needs two worker lcores\n");
+		return TEST_SKIPPED;
+	}
+
+	dev_id = rte_compressdev_get_dev_id(SCHED_NAME);
+	if (dev_id < 0) {
+		if (rte_vdev_init(SCHED_NAME, vdev_args) != 0) {
+			RTE_LOG(WARNING, USER1,
+				"Cannot create %s with %s workers\n",
+				SCHED_NAME, SCHED_WORKER_DRIVER);
+			return TEST_SKIPPED;
+		}
+		dev_id = rte_compressdev_get_dev_id(SCHED_NAME);
+		if (dev_id < 0)
+			return TEST_FAILED;
+	}
+	sched_params.dev_id = dev_id;
+
+	sched_params.buf_size = 0;
+	for (i = 0; i < RTE_DIM(compress_test_bufs); i++)
+		sched_params.buf_size = RTE_MAX(sched_params.buf_size,
+				strlen(compress_test_bufs[i]) + 1);
+	sched_params.buf_size *= COMPRESS_BUF_SIZE_RATIO;
+
+	/* source, compressed and decompressed buffer of each operation */
+	sched_params.mbuf_pool = rte_pktmbuf_pool_create("sched_mbuf_pool",
+			SCHED_NB_OPS * 3, CACHE_SIZE, 0,
+			sched_params.buf_size + RTE_PKTMBUF_HEADROOM,
+			rte_socket_id());
+	sched_params.op_pool = rte_comp_op_pool_create("sched_op_pool",
+			SCHED_NB_OPS, 0, 0, rte_socket_id());
+	if (sched_params.mbuf_pool == NULL || sched_params.op_pool == NULL) {
+		RTE_LOG(ERR, USER1,
+			"Scheduler test pools could not be created\n");
+		scheduler_testsuite_teardown();
+		return TEST_FAILED;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+scheduler_ut_setup(void)
+{
+	struct rte_compressdev_config config = {
+		.socket_id = rte_socket_id(),
+		.nb_queue_pairs = 1,
+		.max_nb_priv_xforms = NUM_MAX_XFORMS,
+		.max_nb_streams = 0
+	};
+
+	if (rte_compressdev_configure(sched_params.dev_id, &config) < 0) {
+		RTE_LOG(ERR, USER1, "Device configuration failed\n");
+		return -1;
+	}
+
+	if (rte_compressdev_queue_pair_setup(sched_params.dev_id, 0,
+			NUM_MAX_INFLIGHT_OPS, rte_socket_id()) < 0) {
+		RTE_LOG(ERR, USER1, "Queue pair setup failed\n");
+		return -1;
+	}
+
+	if (rte_compressdev_start(sched_params.dev_id) < 0) {
+		RTE_LOG(ERR, USER1, "Device could not be started\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+scheduler_ut_teardown(void)
+{
+	rte_compressdev_stop(sched_params.dev_id);
+}
+
+/*
+ * Enqueue the operations in bursts of various sizes, while dequeuing,
+ * and check they complete successfully in enqueue order.
+ */
+static int
+scheduler_run_in_order(struct rte_comp_op **ops, unsigned int nb_ops)
+{
+	static const uint16_t bursts[] = { 1, 7, 16, 3, SCHED_MAX_BURST, 5 };
+	struct rte_comp_op *deq_ops[SCHED_MAX_BURST];
+	unsigned int nb_enq = 0, nb_deq = 0, nb_bursts = 0, retries = 0;
+	uint16_t nb, i;
+
+	while (nb_deq < nb_ops) {
+		if (nb_enq < nb_ops) {
+			nb = RTE_MIN(bursts[nb_bursts++ % RTE_DIM(bursts)],
+					nb_ops - nb_enq);
+			nb_enq += rte_compressdev_enqueue_burst(
+					sched_params.dev_id, 0,
+					&ops[nb_enq], nb);
+		}
+
+		nb = rte_compressdev_dequeue_burst(sched_params.dev_id, 0,
+				deq_ops, SCHED_MAX_BURST);
+		for (i = 0; i < nb; i++, nb_deq++) {
+			TEST_ASSERT(deq_ops[i] == ops[nb_deq],
+				"Operation %u completed out of order", nb_deq);
+			TEST_ASSERT_EQUAL(deq_ops[i]->status,
+				RTE_COMP_OP_STATUS_SUCCESS,
+				"Operation %u failed", nb_deq);
+		}
+
+		if (nb != 0) {
+			retries = 0;
+		} else {
+			TEST_ASSERT(++retries < SCHED_DEQ_RETRIES,
+				"%u operations completed out of %u",
+				nb_deq, nb_ops);
+			rte_delay_us_sleep(SCHED_DEQ_WAIT_US);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+scheduler_prepare_op(struct rte_comp_op *op, struct rte_mbuf *src,
+		uint32_t src_len, void *priv_xform)
+{
+	struct rte_mbuf *dst;
+
+	dst = rte_pktmbuf_alloc(sched_params.mbuf_pool);
+	if (dst == NULL)
+		return -1;
+	if (rte_pktmbuf_append(dst, sched_params.buf_size) == NULL) {
+		rte_pktmbuf_free(dst);
+		return -1;
+	}
+
+	op->m_src = src;
+	op->m_dst = dst;
+	op->src.offset = 0;
+	op->src.length = src_len;
+	op->dst.offset = 0;
+	op->flush_flag = RTE_COMP_FLUSH_FINAL;
+	op->op_type = RTE_COMP_OP_STATELESS;
+	op->private_xform = priv_xform;
+	op->status = RTE_COMP_OP_STATUS_NOT_PROCESSED;
+	op->consumed = 0;
+	op->produced = 0;
+	return 0;
+}
+
+/*
+ * Compress, then decompress buffers of various lengths through the scheduler
+ * workers, checking the completion order and the data.
+ */
+static int
+test_compressdev_scheduler_in_order(void)
+{
+	struct rte_comp_xform comp_xform = {
+		.type = RTE_COMP_COMPRESS,
+		.compress = {
+			.algo = RTE_COMP_ALGO_DEFLATE,
+			.deflate.huffman = RTE_COMP_HUFFMAN_DEFAULT,
+			.level = RTE_COMP_LEVEL_PMD_DEFAULT,
+			.chksum = RTE_COMP_CHECKSUM_NONE,
+			.window_size = DEFAULT_WINDOW_SIZE,
+		},
+	};
+	struct rte_comp_xform decomp_xform = {
+		.type = RTE_COMP_DECOMPRESS,
+		.decompress = {
+			.algo = RTE_COMP_ALGO_DEFLATE,
+			.chksum = RTE_COMP_CHECKSUM_NONE,
+			.window_size = DEFAULT_WINDOW_SIZE,
+		},
+	};
+	struct rte_comp_op *ops[SCHED_NB_OPS];
+	uint32_t lens[SCHED_NB_OPS];
+	void *comp_priv_xform = NULL, *decomp_priv_xform = NULL;
+	struct rte_mbuf *src;
+	const char *buf;
+	unsigned int i;
+	int ret = TEST_FAILED;
+
+	if (rte_comp_op_bulk_alloc(sched_params.op_pool, ops,
+			SCHED_NB_OPS) < 0) {
+		RTE_LOG(ERR, USER1, "Operations could not be allocated\n");
+		return TEST_FAILED;
+	}
+
+	if (rte_compressdev_private_xform_create(sched_params.dev_id,
+			&comp_xform, &comp_priv_xform) < 0 ||
+			rte_compressdev_private_xform_create(
+			sched_params.dev_id, &decomp_xform,
+			&decomp_priv_xform) < 0) {
+		RTE_LOG(ERR, USER1, "Private xforms could not be created\n");
+		goto exit;
+	}
+
+	for (i = 0; i < SCHED_NB_OPS; i++) {
+		buf = compress_test_bufs[i % RTE_DIM(compress_test_bufs)];
+		lens[i] = strlen(buf) - (i * 997) % (strlen(buf) / 2);
+		src = rte_pktmbuf_alloc(sched_params.mbuf_pool);
+		if (src == NULL || rte_pktmbuf_append(src, lens[i]) == NULL ||
+				scheduler_prepare_op(ops[i], src, lens[i],
+				comp_priv_xform) < 0) {
+			RTE_LOG(ERR, USER1, "Buffer could not be allocated\n");
+			rte_pktmbuf_free(src);
+			goto exit;
+		}
+		memcpy(rte_pktmbuf_mtod(src, char *), buf, lens[i]);
+	}
+
+	if (scheduler_run_in_order(ops, SCHED_NB_OPS) != TEST_SUCCESS)
+		goto exit;
+
+	/* Decompress the compressed buffers */
+	for (i = 0; i < SCHED_NB_OPS; i++) {
+		src = ops[i]->m_dst;
+		rte_pktmbuf_free(ops[i]->m_src);
+		ops[i]->m_src = NULL;
+		ops[i]->m_dst = NULL;
+		if (scheduler_prepare_op(ops[i], src, ops[i]->produced,
+				decomp_priv_xform) < 0) {
+			RTE_LOG(ERR, USER1, "Buffer could not be allocated\n");
+			rte_pktmbuf_free(src);
+			goto exit;
+		}
+	}
+
+	if (scheduler_run_in_order(ops, SCHED_NB_OPS) != TEST_SUCCESS)
+		goto exit;
+
+	for (i = 0; i < SCHED_NB_OPS; i++) {
+		buf = compress_test_bufs[i % RTE_DIM(compress_test_bufs)];
+		if (ops[i]->produced != lens[i] ||
+				memcmp(rte_pktmbuf_mtod(ops[i]->m_dst, char *),
+				buf, lens[i]) != 0) {
+			RTE_LOG(ERR, USER1,
+				"Operation %u decompressed wrong data\n", i);
+			goto exit;
+		}
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	for (i = 0; i < SCHED_NB_OPS; i++) {
+		rte_pktmbuf_free(ops[i]->m_src);
+		rte_pktmbuf_free(ops[i]->m_dst);
+		rte_comp_op_free(ops[i]);
+	}
+	rte_compressdev_private_xform_free(sched_params.dev_id,
+			comp_priv_xform);
+	rte_compressdev_private_xform_free(sched_params.dev_id,
+			decomp_priv_xform);
+	return ret;
+}
+
+/*
+ * Enqueue a stateless operation followed by a stateful one, which the
+ * scheduler does not support: the burst stops at the stateful operation.
+ */
+static int
+test_compressdev_scheduler_stateful_rejected(void)
+{
+	struct rte_comp_xform comp_xform = {
+		.type = RTE_COMP_COMPRESS,
+		.compress = {
+			.algo = RTE_COMP_ALGO_DEFLATE,
+			.deflate.huffman = RTE_COMP_HUFFMAN_DEFAULT,
+			.level = RTE_COMP_LEVEL_PMD_DEFAULT,
+			.chksum = RTE_COMP_CHECKSUM_NONE,
+			.window_size = DEFAULT_WINDOW_SIZE,
+		},
+	};
+	struct rte_comp_op *ops[2], *deq_op = NULL;
+	void *priv_xform = NULL;
+	const char *buf = compress_test_bufs[0];
+	uint32_t len = strlen(buf);
+	struct rte_mbuf *src;
+	unsigned int i, retries;
+	int ret = TEST_FAILED;
+
+	if (rte_comp_op_bulk_alloc(sched_params.op_pool, ops, 2) < 0) {
+		RTE_LOG(ERR, USER1, "Operations could not be allocated\n");
+		return TEST_FAILED;
+	}
+
+	if (rte_compressdev_private_xform_create(sched_params.dev_id,
+			&comp_xform, &priv_xform) < 0) {
+		RTE_LOG(ERR, USER1, "Private xform could not be created\n");
+		goto exit;
+	}
+
+	for (i = 0; i < 2; i++) {
+		src = rte_pktmbuf_alloc(sched_params.mbuf_pool);
+		if (src == NULL || rte_pktmbuf_append(src, len) == NULL ||
+				scheduler_prepare_op(ops[i], src, len,
+				priv_xform) < 0) {
+			RTE_LOG(ERR, USER1, "Buffer could not be allocated\n");
+			rte_pktmbuf_free(src);
+			goto exit;
+		}
+		memcpy(rte_pktmbuf_mtod(src, char *), buf, len);
+	}
+	ops[1]->op_type = RTE_COMP_OP_STATEFUL;
+	ops[1]->private_xform = NULL;
+
+	if (rte_compressdev_enqueue_burst(sched_params.dev_id, 0, ops, 2) != 1 ||
+			ops[1]->status != RTE_COMP_OP_STATUS_INVALID_ARGS) {
+		RTE_LOG(ERR, USER1, "Stateful operation was not rejected\n");
+		goto exit;
+	}
+
+	for (retries = 0; retries < SCHED_DEQ_RETRIES; retries++) {
+		if (rte_compressdev_dequeue_burst(sched_params.dev_id, 0,
+				&deq_op, 1) != 0)
+			break;
+		rte_delay_us_sleep(SCHED_DEQ_WAIT_US);
+	}
+	if (deq_op != ops[0] ||
+			deq_op->status != RTE_COMP_OP_STATUS_SUCCESS) {
+		RTE_LOG(ERR, USER1, "Stateless operation did not complete\n");
+		goto exit;
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	for (i = 0; i < 2; i++) {
+		rte_pktmbuf_free(ops[i]->m_src);
+		rte_pktmbuf_free(ops[i]->m_dst);
+		rte_comp_op_free(ops[i]);
+	}
+	rte_compressdev_private_xform_free(sched_params.dev_id, priv_xform);
+	return ret;
+}
+
+static struct unit_test_suite compressdev_scheduler_testsuite  = {
+	.suite_name = "compressdev scheduler unit test suite",
+	.setup = scheduler_testsuite_setup,
+	.teardown = scheduler_testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(scheduler_ut_setup, scheduler_ut_teardown,
+			test_compressdev_scheduler_in_order),
+		TEST_CASE_ST(scheduler_ut_setup, scheduler_ut_teardown,
+			test_compressdev_scheduler_stateful_rejected),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+#endif /* RTE_COMPRESS_SCHEDULER */
+
 static struct unit_test_suite compressdev_testsuite  = {
 	.suite_name = "compressdev unit test suite",
 	.setup = testsuite_setup,
@@ -4268,3 +4667,14 @@ test_compressdev(void)
 }
 
 REGISTER_TEST_COMMAND(compressdev_autotest, test_compressdev);
+
+#ifdef RTE_COMPRESS_SCHEDULER
+static int
+test_compressdev_scheduler(void)
+{
+	return unit_test_suite_runner(&compressdev_scheduler_testsuite);
+}
+
+REGISTER_TEST_COMMAND(compressdev_scheduler_autotest,
+		test_compressdev_scheduler);
+#endif
@@ -10193,6 +10193,137 @@ test_AES_GCM_authenticated_encryption_test_case_2(void)
 	return test_authenticated_encryption(&gcm_test_case_2);
 }
 
+#define CPU_MULTI_SESS_PKTS	4
+#define CPU_MULTI_SESS_BUF_LEN	64
+#define CPU_MULTI_SESS_TAG_LEN	16
+
+/*
+ * CPU crypto of packets of alternating sessions, with different keys and
+ * lengths, in one rte_cryptodev_sym_cpu_crypto_process_multi() call.
+ */
+static int
+test_AES_GCM_auth_encryption_cpu_multi_session(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	static const struct aead_test_data *tdata[] = {
+		&gcm_test_case_2,
+		&gcm_test_case_3,
+	};
+	const uint8_t dev_id = ts_params->valid_devs[0];
+	struct rte_cryptodev_sym_session *sess[RTE_DIM(tdata)] = { NULL };
+	struct rte_cryptodev_sym_session *pkt_sess[CPU_MULTI_SESS_PKTS];
+	union rte_crypto_sym_ofs ofs[CPU_MULTI_SESS_PKTS];
+	uint8_t buf[CPU_MULTI_SESS_PKTS][CPU_MULTI_SESS_BUF_LEN];
+	uint8_t tag[CPU_MULTI_SESS_PKTS][CPU_MULTI_SESS_TAG_LEN];
+	struct rte_crypto_vec vec[CPU_MULTI_SESS_PKTS];
+	struct rte_crypto_sgl sgl[CPU_MULTI_SESS_PKTS];
+	struct rte_crypto_va_iova_ptr iv[CPU_MULTI_SESS_PKTS];
+	struct rte_crypto_va_iova_ptr aad[CPU_MULTI_SESS_PKTS];
+	struct rte_crypto_va_iova_ptr digest[CPU_MULTI_SESS_PKTS];
+	int32_t st[CPU_MULTI_SESS_PKTS];
+	struct rte_crypto_sym_vec symvec;
+	struct rte_crypto_sym_xform xform;
+	struct rte_cryptodev_sym_capability_idx cap_idx;
+	const struct rte_cryptodev_symmetric_capability *capability;
+	const struct aead_test_data *td;
+	uint32_t i, n;
+	int ret = TEST_FAILED;
+
+	if (gbl_action_type != RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO)
+		return TEST_SKIPPED;
+
+	cap_idx.type = RTE_CRYPTO_SYM_XFORM_AEAD;
+	cap_idx.algo.aead = RTE_CRYPTO_AEAD_AES_GCM;
+	capability = rte_cryptodev_sym_capability_get(dev_id, &cap_idx);
+	if (capability == NULL)
+		return TEST_SKIPPED;
+	for (i = 0; i < RTE_DIM(tdata); i++) {
+		td = tdata[i];
+		if (rte_cryptodev_sym_capability_check_aead(capability,
+				td->key.len, td->auth_tag.len, td->aad.len,
+				td->iv.len))
+			return TEST_SKIPPED;
+	}
+
+	for (i = 0; i < RTE_DIM(tdata); i++) {
+		td = tdata[i];
+		memset(&xform, 0, sizeof(xform));
+		xform.type = RTE_CRYPTO_SYM_XFORM_AEAD;
+		xform.aead.algo = td->algo;
+		xform.aead.op = RTE_CRYPTO_AEAD_OP_ENCRYPT;
+		xform.aead.key.data = td->key.data;
+		xform.aead.key.length = td->key.len;
+		xform.aead.iv.offset = IV_OFFSET;
+		xform.aead.iv.length = td->iv.len;
+		xform.aead.digest_length = td->auth_tag.len;
+		xform.aead.aad_length = td->aad.len;
+
+		sess[i] = rte_cryptodev_sym_session_create(
+				ts_params->session_mpool);
+		if (sess[i] == NULL ||
+				rte_cryptodev_sym_session_init(dev_id, sess[i],
+					&xform,
+					ts_params->session_priv_mpool) != 0) {
+			printf("Session creation failed\n");
+			goto out;
+		}
+	}
+
+	for (i = 0; i < CPU_MULTI_SESS_PKTS; i++) {
+		td = tdata[i % RTE_DIM(tdata)];
+		pkt_sess[i] = sess[i % RTE_DIM(tdata)];
+		ofs[i].raw = 0;
+
+		memcpy(buf[i], td->plaintext.data, td->plaintext.len);
+		vec[i].base = buf[i];
+		vec[i].len = td->plaintext.len;
+		sgl[i].vec = &vec[i];
+		sgl[i].num = 1;
+
+		/* for CPU crypto the IOVA address is not required */
+		iv[i].va = (void *)(uintptr_t)td->iv.data;
+		aad[i].va = td->aad.data;
+		digest[i].va = tag[i];
+	}
+
+	symvec.num = CPU_MULTI_SESS_PKTS;
+	symvec.src_sgl = sgl;
+	symvec.dest_sgl = NULL;
+	symvec.iv = iv;
+	symvec.digest = digest;
+	symvec.aad = aad;
+	symvec.status = st;
+
+	n = rte_cryptodev_sym_cpu_crypto_process_multi(dev_id, pkt_sess, ofs,
+			&symvec);
+	if (n != CPU_MULTI_SESS_PKTS) {
+		printf("%u packets out of %u processed\n", n,
+			CPU_MULTI_SESS_PKTS);
+		goto out;
+	}
+
+	for (i = 0; i < CPU_MULTI_SESS_PKTS; i++) {
+		td = tdata[i % RTE_DIM(tdata)];
+		if (memcmp(buf[i], td->ciphertext.data,
+				td->ciphertext.len) != 0 ||
+				memcmp(tag[i], td->auth_tag.data,
+					td->auth_tag.len) != 0) {
+			printf("Packet %u not as expected\n", i);
+			goto out;
+		}
+	}
+	ret = TEST_SUCCESS;
+
+out:
+	for (i = 0; i < RTE_DIM(tdata); i++) {
+		if (sess[i] == NULL)
+			continue;
+		rte_cryptodev_sym_session_clear(dev_id, sess[i]);
+		rte_cryptodev_sym_session_free(sess[i]);
+	}
+	return ret;
+}
+
 static int
 test_AES_GCM_authenticated_encryption_test_case_3(void)
 {
@@ -15023,6 +15154,8 @@ static struct unit_test_suite cryptodev_aes_gcm_auth_testsuite  = {
 			test_AES_GCM_authenticated_encryption_test_case_1),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_AES_GCM_authenticated_encryption_test_case_2),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_AES_GCM_auth_encryption_cpu_multi_session),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_AES_GCM_authenticated_encryption_test_case_3),
 		TEST_CASE_ST(ut_setup, ut_teardown,
@@ -15853,6 +15986,294 @@ test_cryptodev_mrvl(void)
 
 #ifdef RTE_CRYPTO_SCHEDULER
 
+#define WS_SCHED_NAME		"crypto_scheduler_ws_test"
+#define WS_NB_WORKERS		2
+#define WS_NB_OPS		256
+#define WS_NB_DESC		512
+#define WS_MAX_ROUNDS		64
+#define WS_DEQ_RETRIES		1000
+#define WS_DEQ_WAIT_US		1000
+
+static struct {
+	uint8_t dev_id;
+	uint8_t worker_ids[WS_NB_WORKERS];
+	uint16_t nb_workers;
+	struct rte_mempool *mbuf_pool;
+	struct rte_mempool *op_pool;
+	struct rte_mempool *sess_pool;
+	struct rte_mempool *sess_priv_pool;
+} ws_params;
+
+static void
+scheduler_work_stealing_teardown(void)
+{
+	char name[RTE_CRYPTODEV_NAME_MAX_LEN];
+	int dev_id;
+	uint16_t i;
+
+	dev_id = rte_cryptodev_get_dev_id(WS_SCHED_NAME);
+	if (dev_id >= 0)
+		rte_cryptodev_stop(dev_id);
+	rte_vdev_uninit(WS_SCHED_NAME);
+	for (i = 0; i < ws_params.nb_workers; i++) {
+		snprintf(name, sizeof(name), "%s_ws_%u",
+				RTE_STR(CRYPTODEV_NAME_NULL_PMD), i);
+		rte_vdev_uninit(name);
+	}
+	ws_params.nb_workers = 0;
+
+	rte_mempool_free(ws_params.mbuf_pool);
+	rte_mempool_free(ws_params.op_pool);
+	rte_mempool_free(ws_params.sess_pool);
+	rte_mempool_free(ws_params.sess_priv_pool);
+	ws_params.mbuf_pool = NULL;
+	ws_params.op_pool = NULL;
+	ws_params.sess_pool = NULL;
+	ws_params.sess_priv_pool = NULL;
+}
+
+/*
+ * Create a multi-core scheduler with work stealing enabled, over null
+ * crypto workers, each worker core keeping one op in flight only.
+ */
+static int
+scheduler_work_stealing_setup(void)
+{
+	struct rte_cryptodev_scheduler_work_stealing_option ws_option = {
+		.enable = 1,
+		.max_inflight = 1,
+	};
+	struct rte_cryptodev_config conf = {
+		.socket_id = rte_socket_id(),
+		.nb_queue_pairs = 1,
+	};
+	struct rte_cryptodev_qp_conf qp_conf = {
+		.nb_descriptors = WS_NB_DESC,
+	};
+	char vdev_args[VDEV_ARGS_SIZE] = "mode=multi-core,ordering=enable,"
+		"corelist=";
+	char name[RTE_CRYPTODEV_NAME_MAX_LEN];
+	unsigned int lcore_id, nb_wc = 0;
+	int ret, dev_id;
+	uint16_t i;
+
+	if (rte_cryptodev_driver_id_get(
+			RTE_STR(CRYPTODEV_NAME_NULL_PMD)) == -1) {
+		RTE_LOG(WARNING, USER1, "NULL PMD must be loaded.\n");
+		return TEST_SKIPPED;
+	}
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (nb_wc == WS_NB_WORKERS)
+			break;
+		snprintf(name, sizeof(name), "%s%u", nb_wc == 0 ? "" : ";",
+				lcore_id);
+		strlcat(vdev_args, name, sizeof(vdev_args));
+		nb_wc++;
+	}
+	if (nb_wc < WS_NB_WORKERS) {
+		RTE_LOG(WARNING, USER1,
+			"Work stealing test needs two worker lcores\n");
+		return TEST_SKIPPED;
+	}
+
+	ret = rte_vdev_init(WS_SCHED_NAME, vdev_args);
+	TEST_ASSERT_SUCCESS(ret, "Failed to create %s", WS_SCHED_NAME);
+	dev_id = rte_cryptodev_get_dev_id(WS_SCHED_NAME);
+	TEST_ASSERT(dev_id >= 0, "Cannot find %s", WS_SCHED_NAME);
+	ws_params.dev_id = dev_id;
+
+	for (i = 0; i < WS_NB_WORKERS; i++) {
+		snprintf(name, sizeof(name), "%s_ws_%u",
+				RTE_STR(CRYPTODEV_NAME_NULL_PMD), i);
+		ret = rte_vdev_init(name, NULL);
+		TEST_ASSERT_SUCCESS(ret, "Failed to create %s", name);
+		ws_params.nb_workers++;
+		dev_id = rte_cryptodev_get_dev_id(name);
+		TEST_ASSERT(dev_id >= 0, "Cannot find %s", name);
+		ws_params.worker_ids[i] = dev_id;
+		ret = rte_cryptodev_scheduler_worker_attach(ws_params.dev_id,
+				dev_id);
+		TEST_ASSERT_SUCCESS(ret, "Failed to attach %s", name);
+	}
+
+	ret = rte_cryptodev_scheduler_option_set(ws_params.dev_id,
+			CDEV_SCHED_OPTION_WORK_STEALING, &ws_option);
+	TEST_ASSERT_SUCCESS(ret, "Failed to enable work stealing");
+
+	ws_params.mbuf_pool = rte_pktmbuf_pool_create("ws_mbuf_pool",
+			WS_NB_OPS, 0, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+	ws_params.op_pool = rte_crypto_op_pool_create("ws_op_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, WS_NB_OPS, 0, 0,
+			rte_socket_id());
+	ws_params.sess_pool = rte_cryptodev_sym_session_pool_create(
+			"ws_sess_pool", MAX_NB_SESSIONS, 0, 0, 0,
+			rte_socket_id());
+	ws_params.sess_priv_pool = rte_mempool_create("ws_sess_priv_pool",
+			MAX_NB_SESSIONS,
+			rte_cryptodev_sym_get_private_session_size(
+				ws_params.dev_id),
+			0, 0, NULL, NULL, NULL, NULL, rte_socket_id(), 0);
+	TEST_ASSERT(ws_params.mbuf_pool != NULL &&
+			ws_params.op_pool != NULL &&
+			ws_params.sess_pool != NULL &&
+			ws_params.sess_priv_pool != NULL,
+			"Failed to create the pools");
+
+	qp_conf.mp_session = ws_params.sess_pool;
+	qp_conf.mp_session_private = ws_params.sess_priv_pool;
+	TEST_ASSERT_SUCCESS(rte_cryptodev_configure(ws_params.dev_id, &conf),
+			"Failed to configure %s", WS_SCHED_NAME);
+	TEST_ASSERT_SUCCESS(rte_cryptodev_queue_pair_setup(ws_params.dev_id,
+			0, &qp_conf, rte_socket_id()),
+			"Failed to set up the queue pair of %s", WS_SCHED_NAME);
+	TEST_ASSERT_SUCCESS(rte_cryptodev_start(ws_params.dev_id),
+			"Failed to start %s", WS_SCHED_NAME);
+
+	return TEST_SUCCESS;
+}
+
+static uint64_t
+scheduler_stolen_ops(void)
+{
+	struct rte_cryptodev_scheduler_mc_stats stats;
+	uint64_t stolen = 0;
+	uint16_t i;
+
+	for (i = 0; i < WS_NB_WORKERS; i++)
+		if (rte_cryptodev_scheduler_mc_stats_get(ws_params.dev_id, i,
+				&stats) == 0)
+			stolen += stats.stolen_ops;
+	return stolen;
+}
+
+/*
+ * Enqueue bursts to the scheduler until worker cores have stolen ops,
+ * every op being dequeued in the order it was enqueued.
+ */
+static int
+test_scheduler_work_stealing(void)
+{
+	struct rte_crypto_sym_xform xform = {
+		.type = RTE_CRYPTO_SYM_XFORM_CIPHER,
+		.cipher = {
+			.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT,
+			.algo = RTE_CRYPTO_CIPHER_NULL,
+		},
+	};
+	struct rte_crypto_op *ops[WS_NB_OPS] = { NULL };
+	struct rte_crypto_op *deq_ops[WS_NB_OPS];
+	struct rte_cryptodev_sym_session *sess;
+	unsigned int round, i, retries;
+	uint16_t nb_enq, nb_deq, n;
+	int ret = TEST_FAILED;
+
+	sess = rte_cryptodev_sym_session_create(ws_params.sess_pool);
+	TEST_ASSERT_NOT_NULL(sess, "Session creation failed");
+	if (rte_cryptodev_sym_session_init(ws_params.dev_id, sess, &xform,
+			ws_params.sess_priv_pool) != 0) {
+		RTE_LOG(ERR, USER1, "Session init failed\n");
+		goto exit;
+	}
+
+	if (rte_crypto_op_bulk_alloc(ws_params.op_pool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, ops, WS_NB_OPS) !=
+			WS_NB_OPS) {
+		RTE_LOG(ERR, USER1, "Operations could not be allocated\n");
+		goto exit;
+	}
+	for (i = 0; i < WS_NB_OPS; i++) {
+		struct rte_mbuf *m = rte_pktmbuf_alloc(ws_params.mbuf_pool);
+
+		if (m == NULL || rte_pktmbuf_append(m, 64) == NULL) {
+			RTE_LOG(ERR, USER1, "Mbuf could not be allocated\n");
+			rte_pktmbuf_free(m);
+			goto exit;
+		}
+		rte_crypto_op_attach_sym_session(ops[i], sess);
+		ops[i]->sym->m_src = m;
+		ops[i]->sym->cipher.data.offset = 0;
+		ops[i]->sym->cipher.data.length = 64;
+	}
+
+	for (round = 0; round < WS_MAX_ROUNDS; round++) {
+		for (i = 0; i < WS_NB_OPS; i++)
+			ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
+
+		nb_enq = rte_cryptodev_enqueue_burst(ws_params.dev_id, 0,
+				ops, WS_NB_OPS);
+		for (nb_deq = 0, retries = 0; nb_deq < nb_enq;) {
+			n = rte_cryptodev_dequeue_burst(ws_params.dev_id, 0,
+					&deq_ops[nb_deq], nb_enq - nb_deq);
+			for (i = 0; i < n; i++, nb_deq++) {
+				if (deq_ops[nb_deq] != ops[nb_deq]) {
+					RTE_LOG(ERR, USER1,
+						"Op %u dequeued out of order\n",
+						nb_deq);
+					goto exit;
+				}
+				if (ops[nb_deq]->status !=
+						RTE_CRYPTO_OP_STATUS_SUCCESS) {
+					RTE_LOG(ERR, USER1, "Op %u failed\n",
+						nb_deq);
+					goto exit;
+				}
+			}
+			if (n != 0) {
+				retries = 0;
+			} else if (++retries == WS_DEQ_RETRIES) {
+				RTE_LOG(ERR, USER1,
+					"%u ops completed out of %u\n",
+					nb_deq, nb_enq);
+				goto exit;
+			} else {
+				rte_delay_us_sleep(WS_DEQ_WAIT_US);
+			}
+		}
+
+		if (scheduler_stolen_ops() != 0)
+			break;
+	}
+
+	if (round == WS_MAX_ROUNDS) {
+		RTE_LOG(ERR, USER1, "No op was stolen in %u rounds\n", round);
+		goto exit;
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	for (i = 0; i < WS_NB_OPS; i++) {
+		if (ops[i] == NULL)
+			continue;
+		rte_pktmbuf_free(ops[i]->sym->m_src);
+		rte_crypto_op_free(ops[i]);
+	}
+	rte_cryptodev_sym_session_clear(ws_params.dev_id, sess);
+	rte_cryptodev_sym_session_free(sess);
+	return ret;
+}
+
+static int
+test_cryptodev_scheduler_work_stealing(void)
+{
+	static struct unit_test_suite ts = {
+		.suite_name = "Scheduler Work Stealing Unit Test Suite",
+		.setup = scheduler_work_stealing_setup,
+		.teardown = scheduler_work_stealing_teardown,
+		.unit_test_cases = {
+			TEST_CASE(test_scheduler_work_stealing),
+			TEST_CASES_END() /**< NULL terminate array */
+		}
+	};
+
+	return unit_test_suite_runner(&ts);
+}
+
+REGISTER_TEST_COMMAND(cryptodev_scheduler_work_stealing_autotest,
+		test_cryptodev_scheduler_work_stealing);
+
 static int
 test_cryptodev_scheduler(void)
 {
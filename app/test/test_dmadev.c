@@ -670,6 +670,92 @@ test_enqueue_fill(int16_t dev_id, uint16_t vchan)
 	return 0;
 }
 
+static int
+test_enqueue_sg_copies(int16_t dev_id, uint16_t vchan)
+{
+#define SG_TEST_MAX_SGES 4
+	struct rte_dma_sge src_sges[SG_TEST_MAX_SGES], dst_sges[SG_TEST_MAX_SGES];
+	struct rte_dma_info info;
+	struct rte_mbuf *src, *dst;
+	char *src_data, *dst_data;
+	uint16_t nb_src, nb_dst, max_sges;
+	unsigned int i;
+	bool dma_err = false;
+	uint16_t idx;
+	int ret = -1;
+
+	if (rte_dma_info_get(dev_id, &info) != 0)
+		ERR_RETURN("Error with rte_dma_info_get()\n");
+	max_sges = RTE_MIN(info.max_sges, SG_TEST_MAX_SGES);
+
+	src = rte_pktmbuf_alloc(pool);
+	dst = rte_pktmbuf_alloc(pool);
+	if (src == NULL || dst == NULL) {
+		print_err(__func__, __LINE__, "Error allocating buffers\n");
+		goto out;
+	}
+	src_data = rte_pktmbuf_mtod(src, char *);
+	dst_data = rte_pktmbuf_mtod(dst, char *);
+
+	/* copy the same data, split differently on both sides */
+	for (nb_src = 1; nb_src <= max_sges; nb_src++) {
+		for (nb_dst = 1; nb_dst <= max_sges; nb_dst++) {
+			int id;
+
+			for (i = 0; i < COPY_LEN; i++)
+				src_data[i] = rte_rand() & 0xFF;
+			memset(dst_data, 0, COPY_LEN);
+
+			for (i = 0; i < nb_src; i++) {
+				src_sges[i].addr = rte_pktmbuf_iova(src) + i * (COPY_LEN / nb_src);
+				src_sges[i].length = COPY_LEN / nb_src;
+			}
+			src_sges[nb_src - 1].length += COPY_LEN % nb_src;
+			for (i = 0; i < nb_dst; i++) {
+				dst_sges[i].addr = rte_pktmbuf_iova(dst) + i * (COPY_LEN / nb_dst);
+				dst_sges[i].length = COPY_LEN / nb_dst;
+			}
+			dst_sges[nb_dst - 1].length += COPY_LEN % nb_dst;
+
+			id = rte_dma_copy_sg(dev_id, vchan, src_sges, dst_sges, nb_src, nb_dst,
+					RTE_DMA_OP_FLAG_SUBMIT);
+			if (id < 0) {
+				print_err(__func__, __LINE__,
+						"Error with rte_dma_copy_sg, %u src %u dst segments\n",
+						nb_src, nb_dst);
+				goto out;
+			}
+			await_hw(dev_id, vchan);
+
+			if (rte_dma_completed(dev_id, vchan, 1, &idx, &dma_err) != 1 || dma_err) {
+				print_err(__func__, __LINE__,
+						"Error with rte_dma_completed, %u src %u dst segments\n",
+						nb_src, nb_dst);
+				goto out;
+			}
+			if (idx != id) {
+				print_err(__func__, __LINE__,
+						"Error, incorrect job id returned: got %u not %d\n",
+						idx, id);
+				goto out;
+			}
+
+			if (memcmp(src_data, dst_data, COPY_LEN) != 0) {
+				print_err(__func__, __LINE__,
+						"Data mismatch, %u src %u dst segments\n",
+						nb_src, nb_dst);
+				goto out;
+			}
+		}
+	}
+
+	ret = 0;
+out:
+	rte_pktmbuf_free(src);
+	rte_pktmbuf_free(dst);
+	return ret;
+}
+
 static int
 test_burst_capacity(int16_t dev_id, uint16_t vchan)
 {
@@ -817,6 +903,12 @@ test_dmadev_instance(int16_t dev_id)
 	else if (runtest("fill", test_enqueue_fill, 1, dev_id, vchan, CHECK_ERRS) < 0)
 		goto err;
 
+	if ((info.dev_capa & RTE_DMA_CAPA_OPS_COPY_SG) == 0)
+		printf("DMA Dev %u: No device scatter-gather support, skipping sg copy tests\n",
+				dev_id);
+	else if (runtest("sg copy", test_enqueue_sg_copies, 1, dev_id, vchan, CHECK_ERRS) < 0)
+		goto err;
+
 	rte_mempool_free(pool);
 	rte_dma_stop(dev_id);
 	rte_dma_stats_reset(dev_id, vchan);
@@ -846,23 +938,47 @@ test_apis(void)
 	return ret;
 }
 
+static void
+test_sw_create(void)
+{
+	unsigned int lcore_id = rte_get_next_lcore(-1, 1, 0);
+	char args[32];
+
+	/* the software dmadev needs a worker lcore to do the copies */
+	if (lcore_id >= RTE_MAX_LCORE) {
+		printf("No worker lcore, skipping software dmadev tests\n");
+		return;
+	}
+	snprintf(args, sizeof(args), "lcore=%u", lcore_id);
+	rte_vdev_init("dma_sw", args);
+}
+
 static int
 test_dma(void)
 {
 	int i;
+	int ret = 0;
 
 	/* basic sanity on dmadev infrastructure */
 	if (test_apis() < 0)
 		ERR_RETURN("Error performing API tests\n");
 
+	test_sw_create();
+
 	if (rte_dma_count_avail() == 0)
 		return TEST_SKIPPED;
 
 	RTE_DMA_FOREACH_DEV(i)
-		if (test_dmadev_instance(i) < 0)
-			ERR_RETURN("Error, test failure for device %d\n", i);
+		if (test_dmadev_instance(i) < 0) {
+			print_err(__func__, __LINE__,
+					"Error, test failure for device %d\n", i);
+			ret = -1;
+			break;
+		}
 
-	return 0;
+	rte_vdev_uninit("dma_sw");
+
+	return ret;
 }
 
 REGISTER_TEST_COMMAND(dmadev_autotest, test_dma);
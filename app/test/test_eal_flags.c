@@ -1031,6 +1031,14 @@ test_misc_flags(void)
 	const char * const argv20[] = {prgname, "--file-prefix=uiodev",
 			"--create-uio-dev"};
 
+	/* With parallel hugepage allocation */
+	const char * const argv21[] = {prgname, "-m", DEFAULT_MEM_SIZE,
+			"--file-prefix=hugethreads", "--huge-alloc-threads=4"};
+
+	/* With invalid number of hugepage allocation threads */
+	const char * const argv22[] = {prgname, "-m", DEFAULT_MEM_SIZE,
+			"--file-prefix=hugethreads", "--huge-alloc-threads=0"};
+
 	/* run all tests also applicable to FreeBSD first */
 
 	if (launch_proc(argv0) == 0) {
@@ -1130,6 +1138,16 @@ test_misc_flags(void)
 				"--create-uio-dev parameter\n");
 		goto fail;
 	}
+	if (launch_proc(argv21) != 0) {
+		printf("Error - process did not run ok with "
+				"--huge-alloc-threads parameter\n");
+		goto fail;
+	}
+	if (launch_proc(argv22) == 0) {
+		printf("Error - process run ok with "
+				"invalid --huge-alloc-threads parameter\n");
+		goto fail;
+	}
 
 	rmdir(hugepath_dir3);
 	rmdir(hugepath_dir2);
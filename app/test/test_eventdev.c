@@ -1023,6 +1023,12 @@ test_eventdev_selftest_sw(void)
 	return test_eventdev_selftest_impl("event_sw", "");
 }
 
+static int
+test_eventdev_selftest_dsw(void)
+{
+	return test_eventdev_selftest_impl("event_dsw", "");
+}
+
 static int
 test_eventdev_selftest_octeontx(void)
 {
@@ -1059,6 +1065,7 @@ REGISTER_TEST_COMMAND(eventdev_common_autotest, test_eventdev_common);
 
 #ifndef RTE_EXEC_ENV_WINDOWS
 REGISTER_TEST_COMMAND(eventdev_selftest_sw, test_eventdev_selftest_sw);
+REGISTER_TEST_COMMAND(eventdev_selftest_dsw, test_eventdev_selftest_dsw);
 REGISTER_TEST_COMMAND(eventdev_selftest_octeontx,
 		test_eventdev_selftest_octeontx);
 REGISTER_TEST_COMMAND(eventdev_selftest_dpaa2, test_eventdev_selftest_dpaa2);
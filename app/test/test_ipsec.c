@@ -37,7 +37,7 @@ test_ipsec(void)
 
 #define VDEV_ARGS_SIZE	100
 #define MAX_NB_SESSIONS	200
-#define MAX_NB_SAS		2
+#define MAX_NB_SAS		4
 #define REPLAY_WIN_0	0
 #define REPLAY_WIN_32	32
 #define REPLAY_WIN_64	64
@@ -669,6 +669,7 @@ create_crypto_session(struct ipsec_unitest_params *ut,
 			ut->crypto_xforms, qp->mp_session_private);
 	if (rc == 0) {
 		ut->ss[j].crypto.ses = s;
+		ut->ss[j].crypto.dev_id = dev_id;
 		return 0;
 	} else {
 		/* failure, do cleanup */
@@ -682,7 +683,8 @@ static int
 create_session(struct ipsec_unitest_params *ut,
 	struct rte_cryptodev_qp_conf *qp, uint8_t crypto_dev, uint32_t j)
 {
-	if (ut->ss[j].type == RTE_SECURITY_ACTION_TYPE_NONE)
+	if (ut->ss[j].type == RTE_SECURITY_ACTION_TYPE_NONE ||
+			ut->ss[j].type == RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO)
 		return create_crypto_session(ut, qp, crypto_dev, j);
 	else
 		return create_dummy_sec_session(ut, qp, j);
@@ -1104,6 +1106,143 @@ crypto_ipsec_2sa_4grp(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * Same as crypto_ipsec_2sa_4grp(), with the packets of both SAs processed
+ * in one call.
+ */
+static int
+crypto_ipsec_2sa_4grp_multi(void)
+{
+	struct ipsec_testsuite_params *ts_params = &testsuite_params;
+	struct ipsec_unitest_params *ut_params = &unittest_params;
+	const struct rte_ipsec_session *ss[BURST_SIZE];
+	uint32_t k, i, j;
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		j = crypto_ipsec_4grp(i);
+
+		/* call crypto prepare */
+		k = rte_ipsec_pkt_crypto_prepare(&ut_params->ss[j],
+				ut_params->ibuf + i, ut_params->cop + i, 1);
+		if (k != 1) {
+			RTE_LOG(ERR, USER1,
+				"rte_ipsec_pkt_crypto_prepare fail\n");
+			return TEST_FAILED;
+		}
+		k = rte_cryptodev_enqueue_burst(ts_params->valid_dev, 0,
+				ut_params->cop + i, 1);
+		if (k != 1) {
+			RTE_LOG(ERR, USER1,
+				"rte_cryptodev_enqueue_burst fail\n");
+			return TEST_FAILED;
+		}
+	}
+
+	if (crypto_dequeue_burst(BURST_SIZE) == TEST_FAILED)
+		return TEST_FAILED;
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		ss[i] = rte_ipsec_ses_from_crypto(ut_params->cop[i]);
+		ut_params->obuf[i] = ut_params->cop[i]->sym->m_src;
+	}
+
+	/* call crypto process */
+	k = rte_ipsec_pkt_process_multi(ss, ut_params->obuf, BURST_SIZE);
+	if (k != BURST_SIZE) {
+		RTE_LOG(ERR, USER1, "rte_ipsec_pkt_process_multi fail k=%d\n",
+			k);
+		return TEST_FAILED;
+	}
+
+	/* packets keep their order */
+	for (i = 0; i < BURST_SIZE; i++) {
+		if (ut_params->obuf[i] != ut_params->ibuf[i] ||
+				ss[i] != &ut_params->ss[crypto_ipsec_4grp(i)]) {
+			RTE_LOG(ERR, USER1,
+				"rte_ipsec_pkt_process_multi order fail\n");
+			return TEST_FAILED;
+		}
+	}
+	return TEST_SUCCESS;
+}
+
+/*
+ * Same as crypto_ipsec_2sa_4grp_multi(), with CPU crypto sessions: the
+ * burst of both SAs 0 and 1 goes through one
+ * rte_ipsec_pkt_cpu_prepare_multi() call, and the result is compared with
+ * the one of the same packets processed per SA, with SAs 2 and 3.
+ */
+static int
+crypto_ipsec_2sa_4grp_cpu_multi(void)
+{
+	struct ipsec_unitest_params *ut_params = &unittest_params;
+	const struct rte_ipsec_session *ss[BURST_SIZE];
+	struct rte_ipsec_session *rs;
+	uint32_t k, i, j, n;
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		ss[i] = &ut_params->ss[crypto_ipsec_4grp(i)];
+		ut_params->obuf[i] = ut_params->ibuf[i];
+	}
+
+	/* call cpu crypto prepare and crypto process for all the SAs */
+	k = rte_ipsec_pkt_cpu_prepare_multi(ss, ut_params->obuf, BURST_SIZE);
+	if (k != BURST_SIZE) {
+		RTE_LOG(ERR, USER1,
+			"rte_ipsec_pkt_cpu_prepare_multi fail k=%d\n", k);
+		return TEST_FAILED;
+	}
+	k = rte_ipsec_pkt_process_multi(ss, ut_params->obuf, BURST_SIZE);
+	if (k != BURST_SIZE) {
+		RTE_LOG(ERR, USER1, "rte_ipsec_pkt_process_multi fail k=%d\n",
+			k);
+		return TEST_FAILED;
+	}
+
+	/* same packets, each group prepared and processed on its own SA */
+	for (i = 0; i < BURST_SIZE; i = j) {
+		for (j = i + 1; j < BURST_SIZE &&
+				crypto_ipsec_4grp(j) == crypto_ipsec_4grp(i);
+				j++)
+			;
+		n = j - i;
+		rs = &ut_params->ss[crypto_ipsec_4grp(i) + 2];
+
+		k = rte_ipsec_pkt_cpu_prepare(rs, ut_params->testbuf + i, n);
+		if (k != n) {
+			RTE_LOG(ERR, USER1,
+				"rte_ipsec_pkt_cpu_prepare fail k=%d\n", k);
+			return TEST_FAILED;
+		}
+		k = rte_ipsec_pkt_process(rs, ut_params->testbuf + i, n);
+		if (k != n) {
+			RTE_LOG(ERR, USER1,
+				"rte_ipsec_pkt_process fail k=%d\n", k);
+			return TEST_FAILED;
+		}
+	}
+
+	/* packets keep their order and match the per SA results */
+	for (i = 0; i < BURST_SIZE; i++) {
+		ut_params->pkt_index = i;
+		if (ut_params->obuf[i] != ut_params->ibuf[i] ||
+				ss[i] != &ut_params->ss[crypto_ipsec_4grp(i)]) {
+			RTE_LOG(ERR, USER1,
+				"rte_ipsec_pkt_process_multi order fail\n");
+			return TEST_FAILED;
+		}
+		TEST_ASSERT_EQUAL(ut_params->obuf[i]->pkt_len,
+			ut_params->testbuf[i]->pkt_len,
+			"pkt_len differs from per SA processing\n");
+		TEST_ASSERT_BUFFERS_ARE_EQUAL(
+			rte_pktmbuf_mtod(ut_params->testbuf[i], void *),
+			rte_pktmbuf_mtod(ut_params->obuf[i], void *),
+			ut_params->obuf[i]->data_len,
+			"data differs from per SA processing\n");
+	}
+	return TEST_SUCCESS;
+}
+
 static void
 test_ipsec_reorder_inb_pkt_burst(uint16_t num_pkts)
 {
@@ -1200,7 +1339,8 @@ static void
 destroy_session(struct ipsec_unitest_params *ut,
 	uint8_t crypto_dev, uint32_t j)
 {
-	if (ut->ss[j].type == RTE_SECURITY_ACTION_TYPE_NONE)
+	if (ut->ss[j].type == RTE_SECURITY_ACTION_TYPE_NONE ||
+			ut->ss[j].type == RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO)
 		return destroy_crypto_session(ut, crypto_dev, j);
 	else
 		return destroy_dummy_sec_session(ut, j);
@@ -2418,7 +2558,7 @@ test_ipsec_crypto_inb_burst_2sa_null_null_wrapper(void)
 }
 
 static int
-test_ipsec_crypto_inb_burst_2sa_4grp_null_null(int i)
+test_ipsec_crypto_inb_burst_2sa_4grp_null_null(int i, int multi)
 {
 	struct ipsec_testsuite_params *ts_params = &testsuite_params;
 	struct ipsec_unitest_params *ut_params = &unittest_params;
@@ -2464,7 +2604,10 @@ test_ipsec_crypto_inb_burst_2sa_4grp_null_null(int i)
 
 	if (rc == 0) {
 		/* call ipsec library api */
-		rc = crypto_ipsec_2sa_4grp();
+		if (multi)
+			rc = crypto_ipsec_2sa_4grp_multi();
+		else
+			rc = crypto_ipsec_2sa_4grp();
 		if (rc == 0)
 			rc = crypto_inb_burst_2sa_null_null_check(
 					ut_params, i);
@@ -2483,6 +2626,70 @@ test_ipsec_crypto_inb_burst_2sa_4grp_null_null(int i)
 	return rc;
 }
 
+static int
+test_ipsec_crypto_inb_burst_2sa_cpu_multi_null_null(int i)
+{
+	struct ipsec_testsuite_params *ts_params = &testsuite_params;
+	struct ipsec_unitest_params *ut_params = &unittest_params;
+	uint16_t num_pkts = test_cfg[i].num_pkts;
+	uint16_t j, k;
+	int rc = 0;
+
+	if (num_pkts != BURST_SIZE)
+		return rc;
+
+	/* SAs 0 and 1 for the burst, SAs 2 and 3 for the per SA reference */
+	for (j = 0; j < MAX_NB_SAS; j++) {
+		ut_params->ipsec_xform.spi = INBOUND_SPI + j % 2;
+		rc = create_sa(RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO,
+				test_cfg[i].replay_win_sz, test_cfg[i].flags,
+				j);
+		if (rc != 0) {
+			RTE_LOG(ERR, USER1, "create_sa %u failed, cfg %d\n",
+				j, i);
+			while (j-- != 0)
+				destroy_sa(j);
+			return rc;
+		}
+	}
+
+	/* Generate test mbuf data, twice */
+	for (j = 0; j < num_pkts && rc == 0; j++) {
+		k = crypto_ipsec_4grp(j);
+
+		/* packet with sequence number 0 is invalid */
+		ut_params->ibuf[j] = setup_test_string_tunneled(
+			ts_params->mbuf_pool, null_encrypted_data,
+			test_cfg[i].pkt_sz, INBOUND_SPI + k, j + 1);
+		ut_params->testbuf[j] = setup_test_string_tunneled(
+			ts_params->mbuf_pool, null_encrypted_data,
+			test_cfg[i].pkt_sz, INBOUND_SPI + k, j + 1);
+		if (ut_params->ibuf[j] == NULL ||
+				ut_params->testbuf[j] == NULL)
+			rc = TEST_FAILED;
+	}
+
+	if (rc == 0) {
+		/* call ipsec library api */
+		rc = crypto_ipsec_2sa_4grp_cpu_multi();
+		if (rc == 0)
+			rc = crypto_inb_burst_2sa_null_null_check(
+					ut_params, i);
+		else {
+			RTE_LOG(ERR, USER1, "crypto_ipsec failed, cfg %d\n",
+				i);
+			rc = TEST_FAILED;
+		}
+	}
+
+	if (rc == TEST_FAILED)
+		test_ipsec_dump_buffers(ut_params, i);
+
+	for (j = 0; j < MAX_NB_SAS; j++)
+		destroy_sa(j);
+	return rc;
+}
+
 static int
 test_ipsec_crypto_inb_burst_2sa_4grp_null_null_wrapper(void)
 {
@@ -2498,7 +2705,56 @@ test_ipsec_crypto_inb_burst_2sa_4grp_null_null_wrapper(void)
 
 	for (i = 0; i < num_cfg && rc == 0; i++) {
 		ut_params->ipsec_xform.options.esn = test_cfg[i].esn;
-		rc = test_ipsec_crypto_inb_burst_2sa_4grp_null_null(i);
+		rc = test_ipsec_crypto_inb_burst_2sa_4grp_null_null(i, 0);
+	}
+
+	return rc;
+}
+
+static int
+test_ipsec_crypto_inb_burst_2sa_multi_null_null_wrapper(void)
+{
+	int i;
+	int rc = 0;
+	struct ipsec_unitest_params *ut_params = &unittest_params;
+
+	ut_params->ipsec_xform.spi = INBOUND_SPI;
+	ut_params->ipsec_xform.direction = RTE_SECURITY_IPSEC_SA_DIR_INGRESS;
+	ut_params->ipsec_xform.proto = RTE_SECURITY_IPSEC_SA_PROTO_ESP;
+	ut_params->ipsec_xform.mode = RTE_SECURITY_IPSEC_SA_MODE_TUNNEL;
+	ut_params->ipsec_xform.tunnel.type = RTE_SECURITY_IPSEC_TUNNEL_IPV4;
+
+	for (i = 0; i < num_cfg && rc == 0; i++) {
+		ut_params->ipsec_xform.options.esn = test_cfg[i].esn;
+		rc = test_ipsec_crypto_inb_burst_2sa_4grp_null_null(i, 1);
+	}
+
+	return rc;
+}
+
+static int
+test_ipsec_crypto_inb_burst_2sa_cpu_multi_null_null_wrapper(void)
+{
+	int i;
+	int rc = 0;
+	struct rte_cryptodev_info info;
+	struct ipsec_unitest_params *ut_params = &unittest_params;
+
+	rte_cryptodev_info_get(testsuite_params.valid_dev, &info);
+	if ((info.feature_flags & RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO) == 0) {
+		RTE_LOG(INFO, USER1, "Device doesn't support CPU crypto\n");
+		return TEST_SKIPPED;
+	}
+
+	ut_params->ipsec_xform.spi = INBOUND_SPI;
+	ut_params->ipsec_xform.direction = RTE_SECURITY_IPSEC_SA_DIR_INGRESS;
+	ut_params->ipsec_xform.proto = RTE_SECURITY_IPSEC_SA_PROTO_ESP;
+	ut_params->ipsec_xform.mode = RTE_SECURITY_IPSEC_SA_MODE_TUNNEL;
+	ut_params->ipsec_xform.tunnel.type = RTE_SECURITY_IPSEC_TUNNEL_IPV4;
+
+	for (i = 0; i < num_cfg && rc == 0; i++) {
+		ut_params->ipsec_xform.options.esn = test_cfg[i].esn;
+		rc = test_ipsec_crypto_inb_burst_2sa_cpu_multi_null_null(i);
 	}
 
 	return rc;
@@ -2537,6 +2793,10 @@ static struct unit_test_suite ipsec_testsuite  = {
 			test_ipsec_crypto_inb_burst_2sa_null_null_wrapper),
 		TEST_CASE_ST(ut_setup_ipsec, ut_teardown_ipsec,
 			test_ipsec_crypto_inb_burst_2sa_4grp_null_null_wrapper),
+		TEST_CASE_ST(ut_setup_ipsec, ut_teardown_ipsec,
+			test_ipsec_crypto_inb_burst_2sa_multi_null_null_wrapper),
+		TEST_CASE_ST(ut_setup_ipsec, ut_teardown_ipsec,
+			test_ipsec_crypto_inb_burst_2sa_cpu_multi_null_null_wrapper),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
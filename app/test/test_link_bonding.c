@@ -3134,6 +3134,136 @@ test_balance_tx_burst_slave_tx_fail(void)
 	return remove_slaves_and_stop_bonded_device();
 }
 
+#define TEST_BAL_ADAPTIVE_FLOWS		(16)
+#define TEST_BAL_ADAPTIVE_PERIOD_MS	(1)
+#define TEST_BAL_ADAPTIVE_BURSTS	(30)
+
+static uint64_t
+bonded_xstat_get(const char *name)
+{
+	uint64_t id, value;
+
+	if (rte_eth_xstats_get_id_by_name(test_params->bonded_port_id, name,
+			&id) != 0)
+		return UINT64_MAX;
+	if (rte_eth_xstats_get_by_id(test_params->bonded_port_id, &id, &value,
+			1) != 1)
+		return UINT64_MAX;
+	return value;
+}
+
+/* Send a packet of each flow, the flows differing by UDP source port. */
+static int
+balance_adaptive_send_flows(void)
+{
+	struct rte_mbuf *pkts_burst[TEST_BAL_ADAPTIVE_FLOWS];
+	struct rte_udp_hdr *udp_hdr;
+	int i, nb_tx;
+
+	TEST_ASSERT_EQUAL(generate_test_burst(pkts_burst,
+			TEST_BAL_ADAPTIVE_FLOWS, 0, 1, 0, 0, 0),
+			TEST_BAL_ADAPTIVE_FLOWS, "failed to generate burst");
+
+	for (i = 0; i < TEST_BAL_ADAPTIVE_FLOWS; i++) {
+		udp_hdr = rte_pktmbuf_mtod_offset(pkts_burst[i],
+				struct rte_udp_hdr *,
+				sizeof(struct rte_ether_hdr) +
+				sizeof(struct rte_ipv4_hdr));
+		udp_hdr->src_port = rte_cpu_to_be_16(i);
+	}
+
+	nb_tx = rte_eth_tx_burst(test_params->bonded_port_id, 0, pkts_burst,
+			TEST_BAL_ADAPTIVE_FLOWS);
+	free_mbufs(&pkts_burst[nb_tx], TEST_BAL_ADAPTIVE_FLOWS - nb_tx);
+	free_virtualpmd_tx_queue();
+
+	return 0;
+}
+
+static int
+test_balance_adaptive_tx_burst(void)
+{
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	int i, on_slave_1 = 0;
+	uint64_t slave_port;
+	uint16_t slave_1;
+
+	TEST_ASSERT_SUCCESS(initialize_bonded_device_with_slaves(
+			BONDING_MODE_BALANCE, 0, 2, 1),
+			"Failed to initialize_bonded_device_with_slaves.");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_policy_set(
+			test_params->bonded_port_id, BALANCE_XMIT_POLICY_LAYER34),
+			"Failed to set balance xmit policy.");
+
+	/* Adaptive transmit is set on a stopped device */
+	TEST_ASSERT_FAIL(rte_eth_bond_xmit_adaptive_set(
+			test_params->bonded_port_id, TEST_BAL_ADAPTIVE_PERIOD_MS),
+			"Expected call to fail as bonded device is started.");
+	TEST_ASSERT_SUCCESS(rte_eth_dev_stop(test_params->bonded_port_id),
+			"Failed to stop bonded port");
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_adaptive_set(
+			test_params->bonded_port_id, TEST_BAL_ADAPTIVE_PERIOD_MS),
+			"Failed to set adaptive transmit.");
+	TEST_ASSERT_EQUAL(rte_eth_bond_xmit_adaptive_get(
+			test_params->bonded_port_id), TEST_BAL_ADAPTIVE_PERIOD_MS,
+			"Adaptive transmit period not as expected.");
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(test_params->bonded_port_id),
+			"Failed to start bonded port");
+	for (i = 0; i < test_params->bonded_slave_count; i++)
+		virtual_ethdev_simulate_link_status_interrupt(
+				test_params->slave_port_ids[i], 1);
+
+	/* The first slave refuses a packet of every burst: it is congested */
+	virtual_ethdev_tx_burst_fn_set_success(
+			test_params->slave_port_ids[0], 0);
+	virtual_ethdev_tx_burst_fn_set_tx_pkt_fail_count(
+			test_params->slave_port_ids[0], 1);
+
+	for (i = 0; i < TEST_BAL_ADAPTIVE_BURSTS; i++) {
+		TEST_ASSERT_SUCCESS(balance_adaptive_send_flows(),
+				"Failed to send flows");
+		rte_delay_us(100);
+	}
+	TEST_ASSERT(bonded_xstat_get("tx_q0_adaptive_rebalances") >= 1,
+			"Expected a bucket move to start");
+
+	/*
+	 * Slaves not reporting their Tx descriptor status move the bucket once
+	 * it did not send packets for a period.
+	 */
+	rte_delay_ms(2 * TEST_BAL_ADAPTIVE_PERIOD_MS);
+	TEST_ASSERT_SUCCESS(balance_adaptive_send_flows(),
+			"Failed to send flows");
+	TEST_ASSERT(bonded_xstat_get("tx_q0_adaptive_bucket_moves") >= 1,
+			"Expected a bucket move to complete");
+	TEST_ASSERT_EQUAL(bonded_xstat_get("tx_q0_adaptive_held_packets"), 0,
+			"Expected no packet held");
+
+	/* Buckets are moved to the second slave */
+	slave_1 = test_params->slave_port_ids[1];
+	for (i = 0; ; i++) {
+		snprintf(name, sizeof(name), "tx_q0_bucket%d_slave_port", i);
+		slave_port = bonded_xstat_get(name);
+		if (slave_port == UINT64_MAX)
+			break;
+		if (slave_port == slave_1)
+			on_slave_1++;
+	}
+	TEST_ASSERT(i > 0 && on_slave_1 > i / 2,
+			"Expected more than half of %d buckets on slave %u, got %d",
+			i, slave_1, on_slave_1);
+
+	TEST_ASSERT_SUCCESS(rte_eth_dev_stop(test_params->bonded_port_id),
+			"Failed to stop bonded port");
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_adaptive_set(
+			test_params->bonded_port_id, 0),
+			"Failed to disable adaptive transmit.");
+
+	/* Clean up and remove slaves from bonded device */
+	return remove_slaves_and_stop_bonded_device();
+}
+
 #define TEST_BALANCE_RX_BURST_SLAVE_COUNT (3)
 
 static int
@@ -5135,6 +5265,7 @@ static struct unit_test_suite link_bonding_test_suite  = {
 		TEST_CASE(test_balance_l34_tx_burst_vlan_ipv6_toggle_ip_addr),
 		TEST_CASE(test_balance_l34_tx_burst_ipv6_toggle_udp_port),
 		TEST_CASE(test_balance_tx_burst_slave_tx_fail),
+		TEST_CASE(test_balance_adaptive_tx_burst),
 		TEST_CASE(test_balance_rx_burst),
 		TEST_CASE(test_balance_verify_promiscuous_enable_disable),
 		TEST_CASE(test_balance_verify_mac_assignment),
@@ -0,0 +1,304 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_eth_bond.h>
+#include <rte_eth_bond_8023ad.h>
+
+#include "test.h"
+
+/*
+ * Tx burst cost of the balance and 802.3ad modes of a bonded device, over
+ * null slaves. The cost of sending the same bursts directly on a null port
+ * is measured first and subtracted, to report the bonding overhead only.
+ * The packets are not freed by the null Tx burst, their reference count
+ * being raised before each burst.
+ */
+
+#define BOND_NAME "net_bonding_perf"
+#define NULL_NAME "net_null_bond_perf"
+#define MAX_SLAVES 4
+#define NB_MBUF 1024
+#define NB_DESC 512
+#define NB_PKTS 256
+#define BURST 32
+#define ITERATIONS (1 << 16)
+#define ACTIVE_WAIT_MS 5000
+
+static const struct {
+	uint8_t policy;
+	const char *name;
+} policies[] = {
+	{ BALANCE_XMIT_POLICY_LAYER2, "l2" },
+	{ BALANCE_XMIT_POLICY_LAYER23, "l23" },
+	{ BALANCE_XMIT_POLICY_LAYER34, "l34" },
+};
+
+static struct rte_mempool *mp;
+static struct rte_mbuf *pkts[NB_PKTS];
+static uint16_t null_ports[MAX_SLAVES + 1];
+
+/* UDP packets of distinct flows, in MAC, IP addresses and ports */
+static int
+pkts_create(void)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_udp_hdr *udp;
+	unsigned int i;
+
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, NB_PKTS) != 0)
+		return -1;
+
+	for (i = 0; i < NB_PKTS; i++) {
+		eth = (struct rte_ether_hdr *)rte_pktmbuf_append(pkts[i],
+				sizeof(*eth) + sizeof(*ip) + sizeof(*udp));
+		memset(eth, 0, sizeof(*eth) + sizeof(*ip) + sizeof(*udp));
+		eth->src_addr.addr_bytes[5] = i;
+		eth->dst_addr.addr_bytes[4] = i >> 2;
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+
+		ip = (struct rte_ipv4_hdr *)(eth + 1);
+		ip->version_ihl = RTE_IPV4_VHL_DEF;
+		ip->next_proto_id = IPPROTO_UDP;
+		ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, i));
+		ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 1, i >> 3));
+
+		udp = (struct rte_udp_hdr *)(ip + 1);
+		udp->src_port = rte_cpu_to_be_16(1024 + i);
+		udp->dst_port = rte_cpu_to_be_16(4789);
+	}
+	return 0;
+}
+
+static int
+null_ports_create(void)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(null_ports); i++) {
+		snprintf(name, sizeof(name), NULL_NAME "%u", i);
+		if (rte_vdev_init(name, NULL) != 0 ||
+				rte_eth_dev_get_port_by_name(name,
+					&null_ports[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+static void
+null_ports_destroy(void)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	unsigned int i;
+	uint16_t port;
+
+	for (i = 0; i < RTE_DIM(null_ports); i++) {
+		snprintf(name, sizeof(name), NULL_NAME "%u", i);
+		if (rte_eth_dev_get_port_by_name(name, &port) != 0)
+			continue;
+		rte_eth_dev_stop(port);
+		rte_eth_dev_close(port);
+		rte_vdev_uninit(name);
+	}
+}
+
+static int
+port_setup(uint16_t port)
+{
+	struct rte_eth_conf conf;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(port, 1, 1, &conf) < 0)
+		return -1;
+	if (rte_eth_rx_queue_setup(port, 0, NB_DESC, SOCKET_ID_ANY, NULL,
+			mp) < 0)
+		return -1;
+	if (rte_eth_tx_queue_setup(port, 0, NB_DESC, SOCKET_ID_ANY, NULL) < 0)
+		return -1;
+	return rte_eth_dev_start(port);
+}
+
+/* Average cycles to send a packet on a port, with bursts of BURST packets */
+static double
+tx_cycles(uint16_t port)
+{
+	uint64_t start, end, nb_tx = 0;
+	unsigned int i, j, off;
+	uint16_t n;
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < ITERATIONS; i++) {
+		off = (i * BURST) % NB_PKTS;
+		for (j = 0; j < BURST; j++)
+			rte_mbuf_refcnt_update(pkts[off + j], 1);
+		n = rte_eth_tx_burst(port, 0, &pkts[off], BURST);
+		for (j = n; j < BURST; j++)
+			rte_mbuf_refcnt_update(pkts[off + j], -1);
+		nb_tx += n;
+	}
+	end = rte_rdtsc_precise();
+
+	if (nb_tx == 0)
+		return -1;
+	return (double)(end - start) / nb_tx;
+}
+
+/* Closing the bonded port removes its slaves, so that it can be freed */
+static void
+bond_destroy(uint16_t port)
+{
+	rte_eth_dev_stop(port);
+	rte_eth_dev_close(port);
+	rte_eth_bond_free(BOND_NAME);
+}
+
+static void
+slow_rx_cb(uint16_t slave_id __rte_unused, struct rte_mbuf *lacp_pkt)
+{
+	rte_pktmbuf_free(lacp_pkt);
+}
+
+static int
+bond_create(uint8_t mode, unsigned int nb_slaves)
+{
+	struct rte_eth_bond_8023ad_conf conf;
+	uint16_t active[RTE_MAX_ETHPORTS];
+	unsigned int i;
+	int port;
+
+	port = rte_eth_bond_create(BOND_NAME, mode, rte_socket_id());
+	if (port < 0)
+		return -1;
+
+	for (i = 0; i < nb_slaves; i++)
+		if (rte_eth_bond_slave_add(port, null_ports[i + 1]) != 0)
+			goto fail;
+
+	/* 802.3ad distributing is driven by the test, no LACP partner */
+	if (mode == BONDING_MODE_8023AD) {
+		if (rte_eth_bond_8023ad_conf_get(port, &conf) != 0)
+			goto fail;
+		conf.slowrx_cb = slow_rx_cb;
+		if (rte_eth_bond_8023ad_setup(port, &conf) != 0)
+			goto fail;
+	}
+
+	if (port_setup(port) != 0)
+		goto fail;
+
+	/* slaves are activated when the link polling sees them up */
+	for (i = 0; i < ACTIVE_WAIT_MS; i++) {
+		if (rte_eth_bond_active_slaves_get(port, active,
+				RTE_DIM(active)) == (int)nb_slaves)
+			break;
+		rte_delay_ms(1);
+	}
+	if (i == ACTIVE_WAIT_MS) {
+		printf("Bonded port slaves are not active\n");
+		goto fail;
+	}
+
+	if (mode == BONDING_MODE_8023AD) {
+		for (i = 0; i < nb_slaves; i++)
+			if (rte_eth_bond_8023ad_ext_distrib(port,
+					active[i], 1) != 0)
+				goto fail;
+	}
+
+	return port;
+
+fail:
+	bond_destroy(port);
+	return -1;
+}
+
+static int
+test_bond_tx(uint8_t mode, const char *mode_name, unsigned int nb_slaves,
+		double base)
+{
+	unsigned int i;
+	double cycles;
+	int port;
+
+	port = bond_create(mode, nb_slaves);
+	if (port < 0) {
+		printf("Cannot create bonded port\n");
+		return -1;
+	}
+
+	for (i = 0; i < RTE_DIM(policies); i++) {
+		if (rte_eth_bond_xmit_policy_set(port,
+				policies[i].policy) != 0)
+			break;
+		cycles = tx_cycles(port);
+		if (cycles < 0) {
+			printf("No packet sent on bonded port\n");
+			break;
+		}
+		printf("%s, %u slaves, %s: %.1F cycles/pkt, overhead %.1F\n",
+			mode_name, nb_slaves, policies[i].name, cycles,
+			cycles - base);
+	}
+
+	bond_destroy(port);
+	return i == RTE_DIM(policies) ? 0 : -1;
+}
+
+static int
+test_link_bonding_perf(void)
+{
+	unsigned int nb_slaves;
+	double base;
+	int ret = -1;
+
+	mp = rte_pktmbuf_pool_create("bond_perf_pool", NB_MBUF, 0, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (mp == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+	if (pkts_create() != 0) {
+		printf("Cannot create packets\n");
+		goto out;
+	}
+	if (null_ports_create() != 0) {
+		printf("Cannot create null ports\n");
+		goto out;
+	}
+
+	if (port_setup(null_ports[0]) != 0)
+		goto out;
+	base = tx_cycles(null_ports[0]);
+	printf("null port: %.1F cycles/pkt\n", base);
+
+	for (nb_slaves = MAX_SLAVES - 1; nb_slaves <= MAX_SLAVES; nb_slaves++) {
+		if (test_bond_tx(BONDING_MODE_BALANCE, "balance", nb_slaves,
+				base) != 0 ||
+				test_bond_tx(BONDING_MODE_8023AD, "802.3ad",
+					nb_slaves, base) != 0)
+			goto out;
+	}
+	ret = 0;
+
+out:
+	null_ports_destroy();
+	rte_pktmbuf_free_bulk(pkts, NB_PKTS);
+	memset(pkts, 0, sizeof(pkts));
+	rte_mempool_free(mp);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(link_bonding_perf_autotest, test_link_bonding_perf);
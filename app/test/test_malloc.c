@@ -374,6 +374,86 @@ test_multi_alloc_statistics(void)
 	return 0;
 }
 
+static int
+test_malloc_cache(void)
+{
+	struct rte_malloc_cache_stats pre_stats, post_stats;
+	int socket = rte_socket_id();
+	void *ptrs[2 * 32];
+	unsigned int i;
+	char *p1, *p2;
+	int ret;
+
+	ret = rte_malloc_cache_enable(true);
+	if (ret == -ENOTSUP) {
+		printf("Malloc caches not supported, skipping\n");
+		return 0;
+	}
+	if (ret < 0)
+		return -1;
+
+	if (rte_malloc_get_cache_stats(socket, &pre_stats) < 0)
+		goto err;
+
+	/* the first allocation refills the cache, the second hits it */
+	p1 = rte_malloc(NULL, 100, 0);
+	if (p1 == NULL)
+		goto err;
+	memset(p1, 0xa5, 100);
+	rte_free(p1);
+	p2 = rte_zmalloc(NULL, 100, 0);
+	if (p2 == NULL)
+		goto err;
+	for (i = 0; i < 100; i++) {
+		if (p2[i] != 0) {
+			printf("Cached element was not cleared by rte_zmalloc\n");
+			rte_free(p2);
+			goto err;
+		}
+	}
+	rte_free(p2);
+
+	rte_malloc_get_cache_stats(socket, &post_stats);
+	if (post_stats.alloc_misses == pre_stats.alloc_misses ||
+			post_stats.alloc_hits == pre_stats.alloc_hits ||
+			post_stats.free_hits < pre_stats.free_hits + 2 ||
+			post_stats.cached_count == 0) {
+		printf("Incorrect cache statistics\n");
+		goto err;
+	}
+
+	/* overflow the cache of one size class */
+	for (i = 0; i < RTE_DIM(ptrs); i++) {
+		ptrs[i] = rte_malloc(NULL, 64, 0);
+		if (ptrs[i] == NULL) {
+			while (i-- > 0)
+				rte_free(ptrs[i]);
+			goto err;
+		}
+	}
+	for (i = 0; i < RTE_DIM(ptrs); i++)
+		rte_free(ptrs[i]);
+
+	rte_malloc_get_cache_stats(socket, &post_stats);
+	if (post_stats.flushes == pre_stats.flushes) {
+		printf("Cache was not flushed to the heap\n");
+		goto err;
+	}
+
+	/* disabling caches gives back all elements of this lcore */
+	rte_malloc_cache_enable(false);
+	rte_malloc_get_cache_stats(socket, &post_stats);
+	if (post_stats.cached_count != 0 || post_stats.cached_bytes != 0) {
+		printf("Elements still cached after disabling caches\n");
+		return -1;
+	}
+	return 0;
+
+err:
+	rte_malloc_cache_enable(false);
+	return -1;
+}
+
 #ifdef RTE_EXEC_ENV_WINDOWS
 static int
 test_realloc(void)
@@ -1087,6 +1167,14 @@ test_malloc(void)
 	else
 		printf("test_multi_alloc_statistics() passed\n");
 
+	ret = test_malloc_cache();
+	if (ret < 0) {
+		printf("test_malloc_cache() failed\n");
+		return ret;
+	}
+	else
+		printf("test_malloc_cache() passed\n");
+
 	return 0;
 }
 
@@ -6,6 +6,8 @@
 #include <string.h>
 #include <rte_cycles.h>
 #include <rte_errno.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_malloc.h>
 #include <rte_memzone.h>
 
@@ -147,6 +149,89 @@ memzone_free(void *addr)
 	rte_memzone_free((struct rte_memzone *)addr);
 }
 
+#define SCALING_OBJS 64
+#define SCALING_ROUNDS 2000
+
+static uint32_t scaling_start;
+
+/* Mimic per-session objects: bursts of small allocations, then frees. */
+static int
+alloc_free_lcore(void *arg)
+{
+	static const size_t SIZES[] = { 64, 128, 200, 512 };
+	static const unsigned int NB_SIZES = RTE_DIM(SIZES);
+	uint64_t *cycles = arg;
+	void *ptrs[SCALING_OBJS];
+	uint64_t tsc;
+	unsigned int i, r;
+
+	rte_wait_until_equal_32(&scaling_start, 1, __ATOMIC_ACQUIRE);
+
+	tsc = rte_rdtsc_precise();
+	for (r = 0; r < SCALING_ROUNDS; r++) {
+		for (i = 0; i < SCALING_OBJS; i++) {
+			ptrs[i] = rte_malloc(NULL, SIZES[i % NB_SIZES], 0);
+			if (ptrs[i] == NULL) {
+				TEST_LOG(ERR, "rte_malloc() failed\n");
+				return -1;
+			}
+		}
+		for (i = 0; i < SCALING_OBJS; i++)
+			rte_free(ptrs[i]);
+	}
+	*cycles = rte_rdtsc_precise() - tsc;
+
+	/* do not keep memory cached once done */
+	rte_malloc_cache_flush();
+	return 0;
+}
+
+static int
+test_alloc_scaling(const char *name)
+{
+	static const uint64_t OPS = SCALING_ROUNDS * SCALING_OBJS;
+
+	uint64_t cycles[RTE_MAX_LCORE];
+	unsigned int nb_lcores, n, lcore_id;
+	uint64_t max_cycles;
+	int ret = 0;
+
+	TEST_LOG(INFO, "Scaling: %s\n", name);
+	TEST_LOG(INFO, "%8s%16s%20s\n", "Lcores", "Mops/s total",
+			"Alloc+free (ns)");
+	for (nb_lcores = 1; nb_lcores <= rte_lcore_count(); nb_lcores *= 2) {
+		memset(cycles, 0, sizeof(cycles));
+		__atomic_store_n(&scaling_start, 0, __ATOMIC_RELAXED);
+
+		n = 1;
+		RTE_LCORE_FOREACH_WORKER(lcore_id) {
+			if (n++ == nb_lcores)
+				break;
+			rte_eal_remote_launch(alloc_free_lcore,
+					&cycles[lcore_id], lcore_id);
+		}
+		__atomic_store_n(&scaling_start, 1, __ATOMIC_RELEASE);
+		if (alloc_free_lcore(&cycles[rte_lcore_id()]) < 0)
+			ret = -1;
+		RTE_LCORE_FOREACH_WORKER(lcore_id)
+			if (rte_eal_wait_lcore(lcore_id) < 0)
+				ret = -1;
+		if (ret < 0)
+			return ret;
+
+		max_cycles = 0;
+		for (n = 0; n < RTE_MAX_LCORE; n++)
+			max_cycles = RTE_MAX(max_cycles, cycles[n]);
+		TEST_LOG(INFO, "%8u%16.2f%20.1f\n", nb_lcores,
+				(double)OPS * nb_lcores / max_cycles *
+					rte_get_tsc_hz() / 1E6,
+				(double)max_cycles / OPS * 1E9 /
+					rte_get_tsc_hz());
+	}
+	TEST_LOG(INFO, "\n");
+	return 0;
+}
+
 static int
 test_malloc_perf(void)
 {
@@ -168,6 +253,16 @@ test_malloc_perf(void)
 			NULL, memset_us_gb, RTE_MAX_MEMZONE - 1) < 0)
 		return -1;
 
+	if (test_alloc_scaling("rte_malloc, heap only") < 0)
+		return -1;
+	if (rte_malloc_cache_enable(true) == 0) {
+		int ret = test_alloc_scaling("rte_malloc, lcore caches");
+
+		rte_malloc_cache_enable(false);
+		if (ret < 0)
+			return -1;
+	}
+
 	return 0;
 }
 
@@ -37,39 +37,74 @@ static size_t buf_sizes[TEST_VALUE_RANGE];
 #define ALIGNMENT_UNIT          32
 
 
+/* Sizes around the threshold of rte_memcpy_nt_auto() */
+static const size_t nt_auto_sizes[] = {
+	RTE_MEMCPY_NT_THRESHOLD - 1, RTE_MEMCPY_NT_THRESHOLD,
+	RTE_MEMCPY_NT_THRESHOLD + 1, RTE_MEMCPY_NT_THRESHOLD + 63,
+	RTE_MEMCPY_NT_THRESHOLD + 64, RTE_MEMCPY_NT_THRESHOLD + 65
+};
+/* MUST be as large as largest size above */
+#define LARGE_BUFFER_SIZE       (RTE_MEMCPY_NT_THRESHOLD + 65)
+/* Offsets step for these sizes, to keep the test short */
+#define NT_AUTO_OFFSET_STEP     3
+
+/* Copy functions under test */
+enum memcpy_func {
+	MEMCPY,
+	MEMCPY_NT,
+	MEMCPY_NT_AUTO,
+};
+
+static const char * const memcpy_func_names[] = {
+	[MEMCPY] = "rte_memcpy",
+	[MEMCPY_NT] = "rte_memcpy_nt",
+	[MEMCPY_NT_AUTO] = "rte_memcpy_nt_auto",
+};
+
 /*
- * Create two buffers, and initialise one with random values. These are copied
- * to the second buffer and then compared to see if the copy was successful.
- * The bytes outside the copied area are also checked to make sure they were not
- * changed.
+ * Initialise two buffers of buf_size + ALIGNMENT_UNIT bytes, one with random
+ * values. These are copied to the second buffer and then compared to see if
+ * the copy was successful. The bytes outside the copied area are also checked
+ * to make sure they were not changed.
  */
 static int
-test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size)
+test_single_memcpy(uint8_t *dest, uint8_t *src, size_t buf_size,
+		unsigned int off_src, unsigned int off_dst, size_t size,
+		enum memcpy_func func)
 {
+	const char *name = memcpy_func_names[func];
 	unsigned int i;
-	uint8_t dest[SMALL_BUFFER_SIZE + ALIGNMENT_UNIT];
-	uint8_t src[SMALL_BUFFER_SIZE + ALIGNMENT_UNIT];
 	void * ret;
 
 	/* Setup buffers */
-	for (i = 0; i < SMALL_BUFFER_SIZE + ALIGNMENT_UNIT; i++) {
+	for (i = 0; i < buf_size + ALIGNMENT_UNIT; i++) {
 		dest[i] = 0;
 		src[i] = (uint8_t) rte_rand();
 	}
 
 	/* Do the copy */
-	ret = rte_memcpy(dest + off_dst, src + off_src, size);
+	switch (func) {
+	case MEMCPY_NT:
+		ret = rte_memcpy_nt(dest + off_dst, src + off_src, size);
+		break;
+	case MEMCPY_NT_AUTO:
+		ret = rte_memcpy_nt_auto(dest + off_dst, src + off_src, size);
+		break;
+	default:
+		ret = rte_memcpy(dest + off_dst, src + off_src, size);
+		break;
+	}
 	if (ret != (dest + off_dst)) {
-		printf("rte_memcpy() returned %p, not %p\n",
-		       ret, dest + off_dst);
+		printf("%s() returned %p, not %p\n",
+		       name, ret, dest + off_dst);
 	}
 
 	/* Check nothing before offset is affected */
 	for (i = 0; i < off_dst; i++) {
 		if (dest[i] != 0) {
-			printf("rte_memcpy() failed for %u bytes (offsets=%u,%u): "
+			printf("%s() failed for %u bytes (offsets=%u,%u): "
 			       "[modified before start of dst].\n",
-			       (unsigned)size, off_src, off_dst);
+			       name, (unsigned)size, off_src, off_dst);
 			return -1;
 		}
 	}
@@ -77,19 +112,19 @@ test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size)
 	/* Check everything was copied */
 	for (i = 0; i < size; i++) {
 		if (dest[i + off_dst] != src[i + off_src]) {
-			printf("rte_memcpy() failed for %u bytes (offsets=%u,%u): "
+			printf("%s() failed for %u bytes (offsets=%u,%u): "
 			       "[didn't copy byte %u].\n",
-			       (unsigned)size, off_src, off_dst, i);
+			       name, (unsigned)size, off_src, off_dst, i);
 			return -1;
 		}
 	}
 
 	/* Check nothing after copy was affected */
-	for (i = size; i < SMALL_BUFFER_SIZE; i++) {
+	for (i = size; i < buf_size; i++) {
 		if (dest[i + off_dst] != 0) {
-			printf("rte_memcpy() failed for %u bytes (offsets=%u,%u): "
+			printf("%s() failed for %u bytes (offsets=%u,%u): "
 			       "[copied too many].\n",
-			       (unsigned)size, off_src, off_dst);
+			       name, (unsigned)size, off_src, off_dst);
 			return -1;
 		}
 	}
@@ -100,16 +135,19 @@ test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size)
  * Check functionality for various buffer sizes and data offsets/alignments.
  */
 static int
-func_test(void)
+func_test(enum memcpy_func func)
 {
+	uint8_t dest[SMALL_BUFFER_SIZE + ALIGNMENT_UNIT];
+	uint8_t src[SMALL_BUFFER_SIZE + ALIGNMENT_UNIT];
 	unsigned int off_src, off_dst, i;
 	int ret;
 
 	for (off_src = 0; off_src < ALIGNMENT_UNIT; off_src++) {
 		for (off_dst = 0; off_dst < ALIGNMENT_UNIT; off_dst++) {
 			for (i = 0; i < RTE_DIM(buf_sizes); i++) {
-				ret = test_single_memcpy(off_src, off_dst,
-				                         buf_sizes[i]);
+				ret = test_single_memcpy(dest, src,
+						SMALL_BUFFER_SIZE, off_src,
+						off_dst, buf_sizes[i], func);
 				if (ret != 0)
 					return -1;
 			}
@@ -118,12 +156,58 @@ func_test(void)
 	return 0;
 }
 
+/*
+ * Check rte_memcpy_nt_auto() on both sides of its threshold, for various
+ * data offsets/alignments.
+ */
+static int
+func_test_nt_auto_threshold(void)
+{
+	unsigned int off_src, off_dst, i;
+	uint8_t *dest, *src;
+	int ret = 0;
+
+	dest = malloc(LARGE_BUFFER_SIZE + ALIGNMENT_UNIT);
+	src = malloc(LARGE_BUFFER_SIZE + ALIGNMENT_UNIT);
+	if (dest == NULL || src == NULL) {
+		printf("Cannot allocate the test buffers\n");
+		ret = -1;
+		goto out;
+	}
+
+	for (off_src = 0; off_src < ALIGNMENT_UNIT;
+			off_src += NT_AUTO_OFFSET_STEP) {
+		for (off_dst = 0; off_dst < ALIGNMENT_UNIT;
+				off_dst += NT_AUTO_OFFSET_STEP) {
+			for (i = 0; i < RTE_DIM(nt_auto_sizes); i++) {
+				ret = test_single_memcpy(dest, src,
+						LARGE_BUFFER_SIZE, off_src,
+						off_dst, nt_auto_sizes[i],
+						MEMCPY_NT_AUTO);
+				if (ret != 0)
+					goto out;
+			}
+		}
+	}
+
+out:
+	free(dest);
+	free(src);
+	return ret;
+}
+
 static int
 test_memcpy(void)
 {
 	int ret;
 
-	ret = func_test();
+	ret = func_test(MEMCPY);
+	if (ret != 0)
+		return -1;
+	ret = func_test(MEMCPY_NT);
+	if (ret != 0)
+		return -1;
+	ret = func_test_nt_auto_threshold();
 	if (ret != 0)
 		return -1;
 	return 0;
@@ -2,6 +2,7 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -267,6 +268,96 @@ perf_test_variable_unaligned(void)
 	}
 }
 
+/*
+ * Cache pollution tests: a table small enough to stay in the CPU caches is
+ * read after each large copy. Copies with regular stores evict part of it,
+ * so reading it again is slower than after a non-temporal copy.
+ */
+#define HOT_TABLE_SIZE          (256 * 1024)
+#define POLLUTION_ITERATIONS    200
+
+static size_t pollution_sizes[] = {
+	16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024
+};
+
+static inline uint64_t
+read_hot_table(const uint8_t *table)
+{
+	uint64_t sum = 0;
+	size_t i;
+
+	for (i = 0; i < HOT_TABLE_SIZE; i += RTE_CACHE_LINE_SIZE)
+		sum += *(const volatile uint64_t *)(table + i);
+	return sum;
+}
+
+static void
+pollution_test(const uint8_t *table, size_t size, bool nt,
+		double *copy_ticks, double *read_ticks)
+{
+	uint64_t copy_time = 0, read_time = 0;
+	uint64_t start_time, mid_time;
+	size_t dst_off, src_off;
+	unsigned int i;
+
+	for (i = 0; i < POLLUTION_ITERATIONS; i++) {
+		dst_off = (rte_rand() % (LARGE_BUFFER_SIZE - size)) &
+				~(ALIGNMENT_UNIT - 1);
+		src_off = (rte_rand() % (LARGE_BUFFER_SIZE - size)) &
+				~(ALIGNMENT_UNIT - 1);
+		read_hot_table(table);
+
+		start_time = rte_rdtsc_precise();
+		if (nt)
+			rte_memcpy_nt(large_buf_write + dst_off,
+					large_buf_read + src_off, size);
+		else
+			rte_memcpy(large_buf_write + dst_off,
+					large_buf_read + src_off, size);
+		mid_time = rte_rdtsc_precise();
+		read_hot_table(table);
+		read_time += rte_rdtsc_precise() - mid_time;
+		copy_time += mid_time - start_time;
+	}
+	*copy_ticks = (double)copy_time / POLLUTION_ITERATIONS;
+	*read_ticks = (double)read_time / POLLUTION_ITERATIONS;
+}
+
+static int
+perf_test_pollution(void)
+{
+	double copy_t, read_t, copy_nt, read_nt;
+	uint8_t *table;
+	unsigned int i;
+
+	table = rte_malloc("memcpy", HOT_TABLE_SIZE, RTE_CACHE_LINE_SIZE);
+	if (table == NULL) {
+		printf("ERROR: not enough memory\n");
+		return -1;
+	}
+	memset(table, 1, HOT_TABLE_SIZE);
+
+	printf("** rte_memcpy() - rte_memcpy_nt() cache pollution tests **\n"
+		"(%u kB table read after each copy, threshold for auto mode %u kB)\n"
+		"========= =============================== ===============================\n"
+		"     Size                    rte_memcpy                 rte_memcpy_nt\n"
+		"  (bytes)   copy (ticks)    table (ticks)  copy (ticks)    table (ticks)\n"
+		"--------- --------------- --------------- --------------- ---------------\n",
+		HOT_TABLE_SIZE / 1024, RTE_MEMCPY_NT_THRESHOLD / 1024);
+	for (i = 0; i < RTE_DIM(pollution_sizes); i++) {
+		pollution_test(table, pollution_sizes[i], false,
+				&copy_t, &read_t);
+		pollution_test(table, pollution_sizes[i], true,
+				&copy_nt, &read_nt);
+		printf("%9zu %15.0f %15.0f %15.0f %15.0f\n", pollution_sizes[i],
+			copy_t, read_t, copy_nt, read_nt);
+	}
+	printf("========= =============================== ===============================\n\n");
+
+	rte_free(table);
+	return 0;
+}
+
 /* Run all memcpy tests */
 static int
 perf_test(void)
@@ -332,7 +423,11 @@ perf_test(void)
 	printf("Aligned constant copy size   = %8.3f\n", time_aligned_const);
 	printf("Unaligned variable copy size = %8.3f\n", time_unaligned);
 	printf("Unaligned constant copy size = %8.3f\n", time_unaligned_const);
+
+	ret = perf_test_pollution();
 	free_buffers();
+	if (ret != 0)
+		return ret;
 
 	return 0;
 }
@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
@@ -835,6 +836,231 @@ exit:
 	return ret;
 }
 
+/* Get and put back nb_bursts bursts of burst objects, nb_loops times. */
+static int
+test_mempool_cache_adaptive_run(struct rte_mempool *mp, void **objs,
+				unsigned int burst, unsigned int nb_bursts,
+				unsigned int nb_loops)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < nb_loops; i++) {
+		for (j = 0; j < nb_bursts; j++)
+			if (rte_mempool_get_bulk(mp, &objs[j * burst],
+						 burst) < 0)
+				return -1;
+		for (j = 0; j < nb_bursts; j++)
+			rte_mempool_put_bulk(mp, &objs[j * burst], burst);
+	}
+	return 0;
+}
+
+static int
+test_mempool_cache_adaptive(void)
+{
+	const unsigned int cache_size = 256;
+	const unsigned int size = 4096;
+	struct rte_mempool_cache_adaptive_conf conf = {
+		.window = 64,
+	};
+	struct rte_mempool_cache_stats stats;
+	unsigned int lcore_id = rte_lcore_id();
+	struct rte_mempool *mp = NULL;
+	void *objs[384];
+	int ret;
+
+	mp = rte_mempool_create("test_cache_adaptive", size, 64, cache_size,
+				0, NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+
+	conf.min_size = cache_size + 1;
+	RTE_TEST_ASSERT(rte_mempool_cache_adaptive_enable(mp, &conf) ==
+			-EINVAL, "Invalid minimum size accepted");
+	conf.min_size = 0;
+	RTE_TEST_ASSERT(rte_mempool_cache_adaptive_enable(mp, &conf) == 0,
+			"Cannot enable adaptive caches");
+
+	/* three bursts of 128 in flight miss in a 256 objects cache */
+	ret = test_mempool_cache_adaptive_run(mp, objs, 128, 3, 256);
+	RTE_TEST_ASSERT(ret == 0, "Cannot get objects");
+	rte_mempool_cache_stats_get(mp, lcore_id, &stats);
+	RTE_TEST_ASSERT(stats.grows != 0 && stats.size > cache_size,
+			"Cache did not grow (size %u)", stats.size);
+	RTE_TEST_ASSERT(stats.ring_ops != 0 && stats.ops >= stats.ring_ops,
+			"Unexpected statistics");
+	rte_mempool_dump(stdout, mp);
+
+	/* single objects are served from a quarter of the cache */
+	ret = test_mempool_cache_adaptive_run(mp, objs, 1, 1, 4096);
+	RTE_TEST_ASSERT(ret == 0, "Cannot get objects");
+	rte_mempool_cache_stats_get(mp, lcore_id, &stats);
+	RTE_TEST_ASSERT(stats.shrinks != 0 && stats.size == cache_size / 4,
+			"Cache did not shrink (size %u)", stats.size);
+	RTE_TEST_ASSERT(stats.len <= stats.size + stats.size / 2,
+			"Excess objects kept in the cache");
+
+	/* no budget left to grow */
+	rte_mempool_cache_adaptive_disable(mp);
+	conf.budget = cache_size;
+	RTE_TEST_ASSERT(rte_mempool_cache_adaptive_enable(mp, &conf) == 0,
+			"Cannot enable adaptive caches");
+	ret = test_mempool_cache_adaptive_run(mp, objs, 128, 3, 256);
+	RTE_TEST_ASSERT(ret == 0, "Cannot get objects");
+	rte_mempool_cache_stats_get(mp, lcore_id, &stats);
+	RTE_TEST_ASSERT(stats.size <= cache_size,
+			"Cache grew beyond the budget (size %u)", stats.size);
+
+	rte_mempool_cache_adaptive_disable(mp);
+	rte_mempool_cache_stats_get(mp, lcore_id, &stats);
+	RTE_TEST_ASSERT(stats.size == cache_size, "Cache size not restored");
+	RTE_TEST_ASSERT(rte_mempool_avail_count(mp) == size,
+			"Objects lost while resizing the cache");
+	ret = TEST_SUCCESS;
+
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+struct test_mempool_thread_arg {
+	struct rte_mempool *mp;
+	bool do_register;
+	int ret;
+};
+
+/* Get and put objects, and exit without giving back the cache content. */
+static void *
+test_mempool_thread_main(void *arg)
+{
+	struct test_mempool_thread_arg *t = arg;
+	struct rte_mempool_cache *cache;
+	void *objs[32];
+
+	t->ret = -1;
+	if (t->do_register && rte_thread_register() < 0) {
+		t->ret = TEST_SKIPPED;
+		return NULL;
+	}
+	cache = rte_mempool_default_cache(t->mp, rte_lcore_id());
+	if (cache == NULL)
+		return NULL;
+	if (!t->do_register && cache != rte_mempool_thread_cache(t->mp))
+		return NULL;
+	if (rte_mempool_get_bulk(t->mp, objs, RTE_DIM(objs)) < 0)
+		return NULL;
+	rte_mempool_put_bulk(t->mp, objs, RTE_DIM(objs));
+	if (cache->len == 0 ||
+			rte_mempool_avail_count(t->mp) != t->mp->size)
+		return NULL;
+	t->ret = 0;
+	return NULL;
+}
+
+static int
+test_mempool_thread_cache(bool do_register)
+{
+	struct test_mempool_thread_arg t = { .do_register = do_register };
+	pthread_t id;
+	int ret;
+
+	t.mp = rte_mempool_create("test_thread_cache", 1024, 64, 32, 0,
+				  NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+	RTE_TEST_ASSERT_NOT_NULL(t.mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+
+	if (pthread_create(&id, NULL, test_mempool_thread_main, &t) != 0) {
+		ret = TEST_FAILED;
+		goto exit;
+	}
+	pthread_join(id, NULL);
+	ret = t.ret;
+	if (ret == TEST_SKIPPED) {
+		printf("Cannot register thread, skipping\n");
+		ret = TEST_SUCCESS;
+		goto exit;
+	}
+	RTE_TEST_ASSERT(ret == 0, "Thread did not use a cache");
+	RTE_TEST_ASSERT(rte_mempool_ops_get_count(t.mp) == t.mp->size,
+			"Cache not flushed on thread exit");
+	ret = TEST_SUCCESS;
+
+exit:
+	rte_mempool_free(t.mp);
+	return ret;
+}
+
+/* Put objects from an lcore of another socket than the mempool's. */
+static int
+test_mempool_remote_put(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	struct rte_mempool_remote_queue *q;
+	struct rte_mempool_cache *cache;
+	void *objs[32];
+	unsigned int i;
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL)
+		return -1;
+	q = rte_mempool_cache_get_ext(mp, cache)->remote;
+	if (q == NULL)
+		return -1;
+	for (i = 0; i < 64; i++) {
+		if (rte_mempool_get_bulk(mp, objs, RTE_DIM(objs)) < 0)
+			return -1;
+		rte_mempool_put_bulk(mp, objs, RTE_DIM(objs));
+	}
+	/* the cache only holds what was got, puts are queued */
+	if (q->put_objs != 64 * RTE_DIM(objs) || q->flushes == 0 ||
+			rte_mempool_avail_count(mp) != mp->size)
+		return -1;
+	rte_mempool_cache_flush(NULL, mp);
+	if (q->len != 0)
+		return -1;
+	return 0;
+}
+
+static int
+test_mempool_remote_free(void)
+{
+	unsigned int socket_id = rte_socket_id();
+	struct rte_mempool *mp;
+	unsigned int lcore_id;
+	int ret;
+
+	mp = rte_mempool_create("test_remote_free", 4096, 64, 256, 0,
+				NULL, NULL, NULL, NULL, socket_id, 0);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Cannot create mempool: %s",
+				 rte_strerror(rte_errno));
+	RTE_TEST_ASSERT(rte_mempool_remote_free_enable(mp) == 0,
+			"Cannot enable remote free");
+	RTE_TEST_ASSERT(rte_mempool_get_ext(mp)->cache[rte_lcore_id()].remote ==
+			NULL,
+			"Return queue for a local lcore");
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_lcore_to_socket_id(lcore_id) != socket_id)
+			break;
+	}
+	if (lcore_id >= RTE_MAX_LCORE) {
+		printf("No lcore on another socket, skipping remote puts\n");
+		ret = TEST_SUCCESS;
+		goto exit;
+	}
+	rte_eal_remote_launch(test_mempool_remote_put, mp, lcore_id);
+	RTE_TEST_ASSERT(rte_eal_wait_lcore(lcore_id) == 0,
+			"Remote puts failed on lcore %u", lcore_id);
+	RTE_TEST_ASSERT(rte_mempool_ops_get_count(mp) +
+			mp->local_cache[lcore_id].len == mp->size,
+			"Objects lost in return queue");
+	ret = TEST_SUCCESS;
+
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 #pragma pop_macro("RTE_TEST_TRACE_FAILURE")
 
 static int
@@ -1028,6 +1254,20 @@ test_mempool(void)
 	if (test_mempool_flag_non_io_unset_when_populated_with_valid_iova() < 0)
 		GOTO_ERR(ret, err);
 
+	/* test adaptive sizing of the default caches */
+	if (test_mempool_cache_adaptive() < 0)
+		GOTO_ERR(ret, err);
+
+	/* test caches of unregistered and registered non-EAL threads */
+	if (test_mempool_thread_cache(false) < 0)
+		GOTO_ERR(ret, err);
+	if (test_mempool_thread_cache(true) < 0)
+		GOTO_ERR(ret, err);
+
+	/* test return queues of remote socket lcores */
+	if (test_mempool_remote_free() < 0)
+		GOTO_ERR(ret, err);
+
 	rte_mempool_list_dump(stdout);
 
 	ret = 0;
@@ -26,6 +26,7 @@
 #include <rte_spinlock.h>
 #include <rte_malloc.h>
 #include <rte_mbuf_pool_ops.h>
+#include <rte_ring.h>
 
 #include "test.h"
 
@@ -63,6 +64,10 @@
  *      - 32
  *      - 128
  *      - 512
+ *
+ *    mempool_perf_remote_autotest measures the rate of objects freed by an
+ *    lcore of another socket than the mempool's, with and without return
+ *    queues.
  */
 
 #define N 65536
@@ -437,4 +442,133 @@ err:
 	return ret;
 }
 
+/*
+ * Cross-socket frees: an lcore of the mempool socket gets objects and
+ * passes them through a ring to an lcore of another socket, which puts
+ * them back, as when forwarding mbufs between sockets.
+ */
+#define REMOTE_BURST 32
+
+static struct rte_ring *remote_ring;
+
+static int
+remote_free_producer(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	void *objs[REMOTE_BURST];
+	uint64_t end;
+
+	end = rte_get_timer_cycles() + TIME_S * rte_get_timer_hz();
+	while (rte_get_timer_cycles() < end) {
+		if (rte_mempool_get_bulk(mp, objs, REMOTE_BURST) < 0)
+			continue;
+		while (rte_ring_enqueue_bulk(remote_ring, objs, REMOTE_BURST,
+				NULL) == 0)
+			rte_pause();
+	}
+	/* stop marker */
+	while (rte_ring_enqueue(remote_ring, NULL) < 0)
+		rte_pause();
+	return 0;
+}
+
+static int
+remote_free_consumer(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	unsigned int lcore_id = rte_lcore_id();
+	void *objs[REMOTE_BURST];
+	unsigned int n;
+
+	stats[lcore_id].enq_count = 0;
+	for (;;) {
+		n = rte_ring_dequeue_burst(remote_ring, objs, REMOTE_BURST,
+				NULL);
+		if (n == 0)
+			continue;
+		if (objs[n - 1] == NULL) {
+			if (n > 1)
+				rte_mempool_put_bulk(mp, objs, n - 1);
+			break;
+		}
+		rte_mempool_put_bulk(mp, objs, n);
+		stats[lcore_id].enq_count += n;
+	}
+	rte_mempool_cache_flush(NULL, mp);
+	return 0;
+}
+
+static int
+remote_free_run(const char *name, bool remote_free, unsigned int prod,
+		unsigned int cons)
+{
+	unsigned int socket_id = rte_lcore_to_socket_id(prod);
+	struct rte_mempool *mp;
+	int ret = -1;
+
+	mp = rte_mempool_create(name, 16 * 1024 - 1, MEMPOOL_ELT_SIZE,
+				RTE_MEMPOOL_CACHE_MAX_SIZE / 2, 0, NULL, NULL,
+				my_obj_init, NULL, socket_id, 0);
+	if (mp == NULL)
+		return -1;
+	if (remote_free && rte_mempool_remote_free_enable(mp) < 0)
+		goto out;
+
+	rte_eal_remote_launch(remote_free_consumer, mp, cons);
+	rte_eal_remote_launch(remote_free_producer, mp, prod);
+	if (rte_eal_wait_lcore(prod) < 0 || rte_eal_wait_lcore(cons) < 0)
+		goto out;
+
+	printf("%-24s producer=%u (socket %u) consumer=%u (socket %u) rate_persec=%"
+	       PRIu64 "\n", name, prod, socket_id, cons,
+	       rte_lcore_to_socket_id(cons), stats[cons].enq_count / TIME_S);
+	if (rte_mempool_avail_count(mp) != mp->size) {
+		printf("objects lost\n");
+		goto out;
+	}
+	ret = 0;
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+static int
+test_mempool_perf_remote(void)
+{
+	unsigned int prod = RTE_MAX_LCORE, cons = RTE_MAX_LCORE;
+	unsigned int lcore_id;
+	int ret = -1;
+
+	/* two workers on different sockets */
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (prod == RTE_MAX_LCORE)
+			prod = lcore_id;
+		else if (rte_lcore_to_socket_id(lcore_id) !=
+				rte_lcore_to_socket_id(prod)) {
+			cons = lcore_id;
+			break;
+		}
+	}
+	if (cons == RTE_MAX_LCORE) {
+		printf("Needs two worker lcores on different sockets, skipping\n");
+		return TEST_SKIPPED;
+	}
+
+	remote_ring = rte_ring_create("perf_remote_free", 1024,
+				      rte_lcore_to_socket_id(cons),
+				      RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (remote_ring == NULL)
+		return -1;
+
+	if (remote_free_run("remote_free_cache", false, prod, cons) < 0)
+		goto err;
+	if (remote_free_run("remote_free_queue", true, prod, cons) < 0)
+		goto err;
+	ret = 0;
+err:
+	rte_ring_free(remote_ring);
+	return ret;
+}
+
 REGISTER_TEST_COMMAND(mempool_perf_autotest, test_mempool_perf);
+REGISTER_TEST_COMMAND(mempool_perf_remote_autotest, test_mempool_perf_remote);
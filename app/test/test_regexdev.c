@@ -0,0 +1,500 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_regexdev.h>
+
+#include "test.h"
+
+#define REGEX_SW_PMD		"regex_sw"
+#define REGEX_SW_WORKER_PMD	"regex_sw_worker"
+#define NB_DESC			64
+#define NB_MAX_MATCHES		16
+#define NB_BURST_OPS		200
+#define NB_POOL_MBUFS		64
+#define TIMEOUT_MS		5000
+
+static const char rule_db[] =
+	"# software regex PMD test rules\n"
+	"1:/hello/\n"
+	"2,0:/wo+rld/\n"
+	"3:/[0-9]{3}-[0-9]{4}/\n"
+	"4:/GET/A\n"
+	"5,1:/secret/i\n"
+	"6:/end$/\n"
+	"7:/x.end/s\n"
+	"\n"
+	"8:/^index/\n"
+	"9:/x.end/\n";
+
+static const char payload[] =
+	"GET /index.html hello world wooorld 555-1234 SeCrEt x\nend";
+
+struct expected_match {
+	uint32_t rule_id;
+	const char *str;
+	uint16_t len;
+	uint16_t group_id;
+};
+
+static const struct expected_match all_matches[] = {
+	{ 1, "hello", 5, 0 },
+	{ 2, "world", 5, 0 },
+	{ 2, "wooorld", 7, 0 },
+	{ 3, "555-1234", 8, 0 },
+	{ 4, "GET", 3, 0 },
+	{ 5, "SeCrEt", 6, 1 },
+	{ 6, "end", 3, 0 },
+	{ 7, "x\nend", 5, 0 },
+};
+
+static struct {
+	struct rte_mempool *pool;
+	struct rte_mbuf *mbuf;
+	struct rte_mbuf *chain;
+	struct rte_regex_ops *ops[NB_BURST_OPS];
+	int dev_id;
+	int worker_dev_id;
+} ts = {
+	.dev_id = -1,
+	.worker_dev_id = -1,
+};
+
+static int
+regexdev_dev_setup(int dev_id, uint16_t nb_max_matches)
+{
+	struct rte_regexdev_config cfg = {
+		.nb_max_matches = nb_max_matches,
+		.nb_queue_pairs = 1,
+		.nb_rules_per_group = 64,
+		.nb_groups = 2,
+		.rule_db = rule_db,
+		.rule_db_len = sizeof(rule_db) - 1,
+	};
+	struct rte_regexdev_qp_conf qp_conf = {
+		.nb_desc = NB_DESC,
+	};
+
+	TEST_ASSERT_SUCCESS(rte_regexdev_configure(dev_id, &cfg),
+			"Failed to configure device %d", dev_id);
+	TEST_ASSERT_SUCCESS(rte_regexdev_queue_pair_setup(dev_id, 0, &qp_conf),
+			"Failed to setup qp of device %d", dev_id);
+	TEST_ASSERT_SUCCESS(rte_regexdev_start(dev_id),
+			"Failed to start device %d", dev_id);
+
+	return TEST_SUCCESS;
+}
+
+static int
+testsuite_setup(void)
+{
+	unsigned int lcore_id = rte_get_next_lcore(-1, 1, 0);
+	const uint16_t half = sizeof(payload) / 2;
+	struct rte_mbuf *seg;
+	char args[32];
+	unsigned int i;
+
+	if (rte_vdev_init(REGEX_SW_PMD, NULL) != 0)
+		return TEST_SKIPPED;
+	ts.dev_id = rte_regexdev_get_dev_id(REGEX_SW_PMD);
+	TEST_ASSERT(ts.dev_id >= 0, "No %s device", REGEX_SW_PMD);
+
+	/* a second device scanning on a worker lcore */
+	if (lcore_id < RTE_MAX_LCORE) {
+		snprintf(args, sizeof(args), "lcore=%u", lcore_id);
+		if (rte_vdev_init(REGEX_SW_WORKER_PMD, args) == 0)
+			ts.worker_dev_id =
+				rte_regexdev_get_dev_id(REGEX_SW_WORKER_PMD);
+	}
+
+	ts.pool = rte_pktmbuf_pool_create("regexdev_test_pool",
+			NB_POOL_MBUFS, 0, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			SOCKET_ID_ANY);
+	TEST_ASSERT_NOT_NULL(ts.pool, "Failed to create mbuf pool");
+
+	ts.mbuf = rte_pktmbuf_alloc(ts.pool);
+	TEST_ASSERT_NOT_NULL(ts.mbuf, "Failed to allocate mbuf");
+	memcpy(rte_pktmbuf_append(ts.mbuf, sizeof(payload) - 1), payload,
+			sizeof(payload) - 1);
+
+	/* the same payload in two segments */
+	ts.chain = rte_pktmbuf_alloc(ts.pool);
+	seg = rte_pktmbuf_alloc(ts.pool);
+	TEST_ASSERT(ts.chain != NULL && seg != NULL,
+			"Failed to allocate mbufs");
+	memcpy(rte_pktmbuf_append(ts.chain, half), payload, half);
+	memcpy(rte_pktmbuf_append(seg, sizeof(payload) - 1 - half),
+			payload + half, sizeof(payload) - 1 - half);
+	TEST_ASSERT_SUCCESS(rte_pktmbuf_chain(ts.chain, seg),
+			"Failed to chain mbufs");
+
+	for (i = 0; i < NB_BURST_OPS; i++) {
+		ts.ops[i] = rte_zmalloc(NULL, sizeof(*ts.ops[i]) +
+				NB_MAX_MATCHES *
+				sizeof(struct rte_regexdev_match), 0);
+		TEST_ASSERT_NOT_NULL(ts.ops[i], "Failed to allocate op");
+	}
+
+	TEST_ASSERT_SUCCESS(regexdev_dev_setup(ts.dev_id, NB_MAX_MATCHES),
+			"Failed to setup device");
+	if (ts.worker_dev_id >= 0)
+		TEST_ASSERT_SUCCESS(regexdev_dev_setup(ts.worker_dev_id,
+					NB_MAX_MATCHES),
+				"Failed to setup worker device");
+
+	return TEST_SUCCESS;
+}
+
+static void
+testsuite_teardown(void)
+{
+	unsigned int i;
+
+	/* removing the devices stops and closes them */
+	if (ts.worker_dev_id >= 0)
+		rte_vdev_uninit(REGEX_SW_WORKER_PMD);
+	if (ts.dev_id >= 0)
+		rte_vdev_uninit(REGEX_SW_PMD);
+	ts.dev_id = -1;
+	ts.worker_dev_id = -1;
+
+	for (i = 0; i < NB_BURST_OPS; i++) {
+		rte_free(ts.ops[i]);
+		ts.ops[i] = NULL;
+	}
+	rte_pktmbuf_free(ts.mbuf);
+	rte_pktmbuf_free(ts.chain);
+	rte_mempool_free(ts.pool);
+	ts.mbuf = NULL;
+	ts.chain = NULL;
+	ts.pool = NULL;
+}
+
+static void
+op_init(struct rte_regex_ops *op, struct rte_mbuf *mbuf, uint16_t req_flags,
+		uint16_t group_id)
+{
+	memset(op, 0, sizeof(*op));
+	op->mbuf = mbuf;
+	op->req_flags = req_flags;
+	op->group_id0 = group_id;
+}
+
+/* Enqueue ops and wait for them all */
+static int
+run_ops(int dev_id, struct rte_regex_ops **ops, uint16_t nb_ops)
+{
+	struct rte_regex_ops *done[NB_BURST_OPS];
+	uint64_t deadline = rte_get_timer_cycles() +
+		rte_get_timer_hz() * TIMEOUT_MS / 1000;
+	uint16_t nb_enq = 0, nb_deq = 0, n, i;
+
+	while (nb_deq < nb_ops) {
+		TEST_ASSERT(rte_get_timer_cycles() < deadline,
+				"Timeout, %u ops of %u done", nb_deq, nb_ops);
+		nb_enq += rte_regexdev_enqueue_burst(dev_id, 0, ops + nb_enq,
+				nb_ops - nb_enq);
+		TEST_ASSERT(nb_enq - nb_deq <= NB_DESC,
+				"More ops in flight than descriptors");
+		n = rte_regexdev_dequeue_burst(dev_id, 0, done + nb_deq,
+				nb_ops - nb_deq);
+		for (i = 0; i < n; i++)
+			TEST_ASSERT(done[nb_deq + i] == ops[nb_deq + i],
+					"Op %u completed out of order",
+					nb_deq + i);
+		nb_deq += n;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static bool
+op_has_match(const struct rte_regex_ops *op, const struct expected_match *e)
+{
+	uint16_t start = strstr(payload, e->str) - payload;
+	uint16_t i;
+
+	for (i = 0; i < op->nb_matches; i++)
+		if (op->matches[i].rule_id == e->rule_id &&
+				op->matches[i].group_id == e->group_id &&
+				op->matches[i].start_offset == start &&
+				op->matches[i].len == e->len)
+			return true;
+	return false;
+}
+
+/* Check the matches of an op, of the rules of a group, or of all if < 0 */
+static int
+check_matches(const struct rte_regex_ops *op, int group_id)
+{
+	uint16_t i, nb = 0;
+
+	TEST_ASSERT_EQUAL(op->rsp_flags, 0, "Unexpected response flags %#x",
+			op->rsp_flags);
+	for (i = 0; i < RTE_DIM(all_matches); i++) {
+		if (group_id >= 0 && all_matches[i].group_id != group_id)
+			continue;
+		TEST_ASSERT(op_has_match(op, &all_matches[i]),
+				"Missing match of rule %u",
+				all_matches[i].rule_id);
+		nb++;
+	}
+	TEST_ASSERT_EQUAL(op->nb_matches, nb, "Got %u matches, expected %u",
+			op->nb_matches, nb);
+	TEST_ASSERT_EQUAL(op->nb_actual_matches, nb,
+			"Got %u actual matches, expected %u",
+			op->nb_actual_matches, nb);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_regexdev_info(void)
+{
+	struct rte_regexdev_info info;
+
+	TEST_ASSERT_SUCCESS(rte_regexdev_info_get(ts.dev_id, &info),
+			"Failed to get device info");
+	TEST_ASSERT(info.regexdev_capa &
+			RTE_REGEXDEV_CAPA_RUNTIME_COMPILATION_F,
+			"Runtime compilation not supported");
+	TEST_ASSERT(info.max_payload_size >= sizeof(payload),
+			"Unexpected max payload size %u",
+			info.max_payload_size);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_regexdev_scan(void)
+{
+	op_init(ts.ops[0], ts.mbuf, 0, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 1), "Scan failed");
+
+	return check_matches(ts.ops[0], -1);
+}
+
+static int
+test_regexdev_scan_chained(void)
+{
+	op_init(ts.ops[0], ts.chain, 0, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 1), "Scan failed");
+
+	return check_matches(ts.ops[0], -1);
+}
+
+static int
+test_regexdev_scan_groups(void)
+{
+	op_init(ts.ops[0], ts.mbuf, RTE_REGEX_OPS_REQ_GROUP_ID0_VALID_F, 1);
+	op_init(ts.ops[1], ts.mbuf, RTE_REGEX_OPS_REQ_GROUP_ID0_VALID_F, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 2), "Scan failed");
+
+	TEST_ASSERT_SUCCESS(check_matches(ts.ops[0], 1),
+			"Wrong matches of group 1");
+	return check_matches(ts.ops[1], 0);
+}
+
+static int
+test_regexdev_scan_flags(void)
+{
+	struct rte_regex_ops *op = ts.ops[0];
+
+	op_init(op, ts.mbuf, RTE_REGEX_OPS_REQ_STOP_ON_MATCH_F, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 1), "Scan failed");
+	TEST_ASSERT(op->nb_matches == 1 && op->nb_actual_matches == 1,
+			"Scan did not stop on the first match");
+
+	/* the lowest rule is the high priority match */
+	op_init(op, ts.mbuf, RTE_REGEX_OPS_REQ_MATCH_HIGH_PRIORITY_F, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 1), "Scan failed");
+	TEST_ASSERT_EQUAL(op->nb_matches, 1, "Got %u matches, expected 1",
+			op->nb_matches);
+	TEST_ASSERT_EQUAL(op->nb_actual_matches, RTE_DIM(all_matches),
+			"Got %u actual matches", op->nb_actual_matches);
+	TEST_ASSERT(op_has_match(op, &all_matches[0]),
+			"Unexpected high priority match of rule %u",
+			op->matches[0].rule_id);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_regexdev_max_matches(void)
+{
+	struct rte_regex_ops *op = ts.ops[0];
+	const uint16_t max_matches = 4;
+
+	TEST_ASSERT_SUCCESS(rte_regexdev_stop(ts.dev_id),
+			"Failed to stop device");
+	TEST_ASSERT_SUCCESS(regexdev_dev_setup(ts.dev_id, max_matches),
+			"Failed to setup device");
+
+	op_init(op, ts.mbuf, 0, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 1), "Scan failed");
+	TEST_ASSERT(op->rsp_flags & RTE_REGEX_OPS_RSP_MAX_MATCH_F,
+			"Max match flag not set");
+	TEST_ASSERT_EQUAL(op->nb_matches, max_matches,
+			"Got %u matches, expected %u", op->nb_matches,
+			max_matches);
+	TEST_ASSERT_EQUAL(op->nb_actual_matches, RTE_DIM(all_matches),
+			"Got %u actual matches", op->nb_actual_matches);
+
+	TEST_ASSERT_SUCCESS(rte_regexdev_stop(ts.dev_id),
+			"Failed to stop device");
+	return regexdev_dev_setup(ts.dev_id, NB_MAX_MATCHES);
+}
+
+static int
+test_regexdev_rule_update(void)
+{
+	struct rte_regexdev_rule rules[] = {
+		{
+			.op = RTE_REGEX_RULE_OP_ADD,
+			.rule_id = 10,
+			.pcre_rule = "wooo",
+			.pcre_rule_len = 4,
+		},
+		{
+			.op = RTE_REGEX_RULE_OP_REMOVE,
+			.rule_id = 1,
+		},
+		{
+			.op = RTE_REGEX_RULE_OP_ADD,
+			.rule_id = 11,
+			.pcre_rule = "a(b",
+			.pcre_rule_len = 3,
+		},
+	};
+	const struct expected_match added = { 10, "wooo", 4, 0 };
+	struct rte_regex_ops *op = ts.ops[0];
+	char *db;
+	int len;
+
+	TEST_ASSERT_EQUAL(rte_regexdev_rule_db_update(ts.dev_id, rules,
+				RTE_DIM(rules)), 2,
+			"Invalid rule not rejected");
+	TEST_ASSERT_EQUAL(rte_errno, EINVAL, "Unexpected error %d",
+			rte_errno);
+	TEST_ASSERT_EQUAL(rte_regexdev_rule_db_compile_activate(ts.dev_id),
+			-EBUSY, "Rules activated on a started device");
+
+	TEST_ASSERT_SUCCESS(rte_regexdev_stop(ts.dev_id),
+			"Failed to stop device");
+	TEST_ASSERT_SUCCESS(rte_regexdev_rule_db_compile_activate(ts.dev_id),
+			"Failed to activate rules");
+	TEST_ASSERT_SUCCESS(rte_regexdev_start(ts.dev_id),
+			"Failed to start device");
+
+	op_init(op, ts.mbuf, 0, 0);
+	TEST_ASSERT_SUCCESS(run_ops(ts.dev_id, ts.ops, 1), "Scan failed");
+	TEST_ASSERT(op_has_match(op, &added), "Missing match of added rule");
+	TEST_ASSERT(!op_has_match(op, &all_matches[0]),
+			"Match of removed rule");
+	TEST_ASSERT_EQUAL(op->nb_matches, RTE_DIM(all_matches),
+			"Got %u matches", op->nb_matches);
+
+	/* the rule set in the text format */
+	len = rte_regexdev_rule_db_export(ts.dev_id, NULL);
+	TEST_ASSERT(len > 0, "Failed to get rule database size");
+	db = malloc(len);
+	TEST_ASSERT_NOT_NULL(db, "Failed to allocate rule database");
+	TEST_ASSERT_SUCCESS(rte_regexdev_rule_db_export(ts.dev_id, db),
+			"Failed to export rule database");
+	TEST_ASSERT((int)strlen(db) == len - 1 &&
+			strstr(db, "10,0:/wooo/\n") != NULL &&
+			strstr(db, "5,1:/secret/i\n") != NULL &&
+			strstr(db, "/hello/") == NULL,
+			"Unexpected rule database:\n%s", db);
+	free(db);
+
+	/* back to the initial rules */
+	TEST_ASSERT_SUCCESS(rte_regexdev_stop(ts.dev_id),
+			"Failed to stop device");
+	return regexdev_dev_setup(ts.dev_id, NB_MAX_MATCHES);
+}
+
+static int
+test_regexdev_invalid_rules(void)
+{
+	static const char *const invalid[] = {
+		"1:/a(b/\n",
+		"1:/a)/\n",
+		"1:/[a/\n",
+		"1:/a*/\n",
+		"1:/\\1/\n",
+		"1:/a{2,1}/\n",
+		"1:/a/x\n",
+		"1:a\n",
+	};
+	unsigned int i;
+
+	TEST_ASSERT_SUCCESS(rte_regexdev_stop(ts.dev_id),
+			"Failed to stop device");
+	for (i = 0; i < RTE_DIM(invalid); i++)
+		TEST_ASSERT(rte_regexdev_rule_db_import(ts.dev_id, invalid[i],
+					strlen(invalid[i])) < 0,
+				"Invalid rule %s imported", invalid[i]);
+
+	/* the rules in use are unchanged */
+	TEST_ASSERT_SUCCESS(rte_regexdev_start(ts.dev_id),
+			"Failed to start device");
+	return test_regexdev_scan();
+}
+
+static int
+test_regexdev_worker(void)
+{
+	unsigned int i;
+
+	if (ts.worker_dev_id < 0)
+		return TEST_SKIPPED;
+
+	/* more ops than descriptors */
+	for (i = 0; i < NB_BURST_OPS; i++) {
+		op_init(ts.ops[i], i % 2 ? ts.chain : ts.mbuf, 0, 0);
+		ts.ops[i]->user_id = i;
+	}
+	TEST_ASSERT_SUCCESS(run_ops(ts.worker_dev_id, ts.ops, NB_BURST_OPS),
+			"Scan failed");
+	for (i = 0; i < NB_BURST_OPS; i++)
+		TEST_ASSERT_SUCCESS(check_matches(ts.ops[i], -1),
+				"Wrong matches of op %u", i);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite regexdev_testsuite = {
+	.suite_name = "regexdev software PMD unit test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_regexdev_info),
+		TEST_CASE(test_regexdev_scan),
+		TEST_CASE(test_regexdev_scan_chained),
+		TEST_CASE(test_regexdev_scan_groups),
+		TEST_CASE(test_regexdev_scan_flags),
+		TEST_CASE(test_regexdev_max_matches),
+		TEST_CASE(test_regexdev_rule_update),
+		TEST_CASE(test_regexdev_invalid_rules),
+		TEST_CASE(test_regexdev_worker),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_regexdev(void)
+{
+	return unit_test_suite_runner(&regexdev_testsuite);
+}
+
+REGISTER_TEST_COMMAND(regexdev_autotest, test_regexdev);
@@ -11,6 +11,9 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <sys/queue.h>
+#ifdef RTE_EXEC_ENV_LINUX
+#include <poll.h>
+#endif
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -1190,6 +1193,106 @@ test_fail:
 	return -1;
 }
 
+#ifdef RTE_EXEC_ENV_LINUX
+static int
+test_ring_notify_worker(void *arg)
+{
+	struct rte_ring *r = arg;
+
+	rte_delay_ms(10);
+	return rte_ring_enqueue(r, r);
+}
+
+/*
+ * Consumer notification: arming, signalling of the eventfd by the first
+ * enqueue and blocking wait, with a producer on another lcore.
+ */
+static int
+test_ring_notify(unsigned int flags)
+{
+	struct rte_ring *r;
+	struct pollfd pfd;
+	unsigned int lcore;
+	void *obj;
+
+	printf("Test ring notification, flags %#x\n", flags);
+
+	/* a ring without notification has no eventfd */
+	r = rte_ring_create("notify", RING_SIZE, SOCKET_ID_ANY, flags);
+	if (r == NULL) {
+		printf("%s: error, can't create ring\n", __func__);
+		return -1;
+	}
+	TEST_RING_VERIFY(rte_ring_notify_fd(r) == -ENOTSUP, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_notify_arm(r) == -ENOTSUP, r, goto test_fail);
+	rte_ring_free(r);
+
+	/* only rte_ring_free() closes the eventfd */
+	r = rte_zmalloc(NULL, rte_ring_get_memsize(RING_SIZE), 0);
+	if (r == NULL) {
+		printf("%s: error, can't allocate ring\n", __func__);
+		return -1;
+	}
+	TEST_RING_VERIFY(rte_ring_init(r, "notify", RING_SIZE,
+		flags | RING_F_NOTIFY) == -EINVAL, r, goto test_fail_init);
+	rte_free(r);
+
+	r = rte_ring_create("notify", RING_SIZE, SOCKET_ID_ANY,
+		flags | RING_F_NOTIFY);
+	if (r == NULL) {
+		printf("%s: error, can't create ring\n", __func__);
+		return -1;
+	}
+
+	pfd.fd = rte_ring_notify_fd(r);
+	pfd.events = POLLIN;
+	TEST_RING_VERIFY(pfd.fd >= 0, r, goto test_fail);
+
+	/* nothing signalled before the consumer arms */
+	TEST_RING_VERIFY(rte_ring_enqueue(r, r) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(poll(&pfd, 1, 0) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_notify_arm(r) == -EAGAIN, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_notify_wait(r, 0) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_dequeue(r, &obj) == 0, r, goto test_fail);
+
+	/* only the first enqueue after the arm signals the eventfd */
+	TEST_RING_VERIFY(rte_ring_notify_arm(r) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(poll(&pfd, 1, 0) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_enqueue(r, r) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(poll(&pfd, 1, 0) == 1, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_enqueue(r, r) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_dequeue(r, &obj) == 0, r, goto test_fail);
+	TEST_RING_VERIFY(rte_ring_dequeue(r, &obj) == 0, r, goto test_fail);
+
+	/* arming drains the signal of the previous wait */
+	TEST_RING_VERIFY(rte_ring_notify_wait(r, 10) == -ETIMEDOUT, r,
+		goto test_fail);
+
+	lcore = rte_get_next_lcore(-1, 1, 0);
+	if (lcore < RTE_MAX_LCORE) {
+		rte_eal_remote_launch(test_ring_notify_worker, r, lcore);
+		TEST_RING_VERIFY(rte_ring_notify_wait(r, 5000) == 0, r,
+			goto test_fail);
+		TEST_RING_VERIFY(rte_eal_wait_lcore(lcore) == 0, r,
+			goto test_fail);
+		TEST_RING_VERIFY(rte_ring_dequeue(r, &obj) == 0, r,
+			goto test_fail);
+	}
+
+	rte_ring_free(r);
+	return 0;
+
+test_fail:
+	rte_eal_mp_wait_lcore();
+	rte_ring_free(r);
+	return -1;
+
+test_fail_init:
+	rte_free(r);
+	return -1;
+}
+#endif
+
 static int
 test_ring(void)
 {
@@ -1207,6 +1310,13 @@ test_ring(void)
 	if (test_ring_with_exact_size() < 0)
 		goto test_fail;
 
+#ifdef RTE_EXEC_ENV_LINUX
+	if (test_ring_notify(0) < 0)
+		goto test_fail;
+	if (test_ring_notify(RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ) < 0)
+		goto test_fail;
+#endif
+
 	/* Burst and bulk operations with sp/sc, mp/mc and default.
 	 * The test cases are split into smaller test cases to
 	 * help clang compile faster.
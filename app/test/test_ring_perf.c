@@ -9,7 +9,9 @@
 #include <rte_ring.h>
 #include <rte_cycles.h>
 #include <rte_launch.h>
+#include <rte_malloc.h>
 #include <rte_pause.h>
+#include <rte_soring.h>
 #include <string.h>
 
 #include "test.h"
@@ -18,6 +20,8 @@
 /*
  * Ring performance test cases, measures performance of various operations
  * using rdtsc for legacy and 16B size ring elements.
+ * Also compares a pipeline built with a staged ordered ring to the same
+ * pipeline built with a chain of rings.
  */
 
 #define RING_NAME "RING_PERF"
@@ -566,6 +570,183 @@ test_fail:
 	return -1;
 }
 
+/*
+ * Pipeline of PIPE_STAGES processing stages between a producer and a
+ * consumer, built either with a staged ordered ring or with a chain of
+ * PIPE_STAGES + 1 rings. The stages only pass the objects along.
+ */
+#define PIPE_STAGES 2
+#define PIPE_OBJS (1 << 20)
+
+struct pipe_params {
+	struct rte_soring *sor; /* NULL for the chain of rings */
+	struct rte_ring *rings[PIPE_STAGES + 1];
+	unsigned int stage;
+	unsigned int bsize;
+};
+
+static uint32_t pipe_stop;
+
+static __rte_always_inline unsigned int
+pipe_enqueue(struct pipe_params *p, void **burst, unsigned int n)
+{
+	if (p->sor != NULL)
+		return rte_soring_enqueue_burst(p->sor, burst, n, NULL);
+	return rte_ring_enqueue_burst(p->rings[0], burst, n, NULL);
+}
+
+static __rte_always_inline unsigned int
+pipe_dequeue(struct pipe_params *p, void **burst)
+{
+	if (p->sor != NULL)
+		return rte_soring_dequeue_burst(p->sor, burst, p->bsize, NULL);
+	return rte_ring_dequeue_burst(p->rings[PIPE_STAGES], burst, p->bsize,
+			NULL);
+}
+
+/* Pass one burst of objects through a stage. */
+static __rte_always_inline unsigned int
+pipe_stage(struct pipe_params *p, unsigned int stage, void **burst)
+{
+	uint32_t ftoken, n;
+
+	if (p->sor != NULL) {
+		n = rte_soring_acquire_burst(p->sor, burst, stage, p->bsize,
+				&ftoken, NULL);
+		if (n != 0)
+			rte_soring_release(p->sor, NULL, stage, n, ftoken);
+		return n;
+	}
+
+	n = rte_ring_dequeue_burst(p->rings[stage], burst, p->bsize, NULL);
+	if (n != 0)
+		while (rte_ring_enqueue_bulk(p->rings[stage + 1], burst, n,
+				NULL) == 0)
+			rte_pause();
+	return n;
+}
+
+static int
+pipe_stage_loop(void *arg)
+{
+	struct pipe_params *p = arg;
+	void *burst[MAX_BURST];
+
+	while (__atomic_load_n(&pipe_stop, __ATOMIC_RELAXED) == 0)
+		if (pipe_stage(p, p->stage, burst) == 0)
+			rte_pause();
+	return 0;
+}
+
+/*
+ * Run PIPE_OBJS objects through the pipeline and return the cycles per
+ * object. The stages run on the main lcore between enqueue and dequeue,
+ * or each on its own lcore if *lcores* is not NULL.
+ */
+static double
+pipe_run(struct pipe_params *p, const unsigned int *lcores)
+{
+	struct pipe_params stage_params[PIPE_STAGES];
+	void *burst[MAX_BURST] = { NULL };
+	unsigned int enq = 0, deq = 0, st;
+	uint64_t start, end;
+
+	if (lcores != NULL) {
+		__atomic_store_n(&pipe_stop, 0, __ATOMIC_RELAXED);
+		for (st = 0; st < PIPE_STAGES; st++) {
+			stage_params[st] = *p;
+			stage_params[st].stage = st;
+			rte_eal_remote_launch(pipe_stage_loop,
+					&stage_params[st], lcores[st]);
+		}
+	}
+
+	start = rte_rdtsc();
+	while (deq < PIPE_OBJS) {
+		if (enq < PIPE_OBJS)
+			enq += pipe_enqueue(p, burst,
+					RTE_MIN(p->bsize, PIPE_OBJS - enq));
+		if (lcores == NULL)
+			for (st = 0; st < PIPE_STAGES; st++)
+				pipe_stage(p, st, burst);
+		deq += pipe_dequeue(p, burst);
+	}
+	end = rte_rdtsc();
+
+	if (lcores != NULL) {
+		__atomic_store_n(&pipe_stop, 1, __ATOMIC_RELAXED);
+		for (st = 0; st < PIPE_STAGES; st++)
+			rte_eal_wait_lcore(lcores[st]);
+	}
+
+	return (double)(end - start) / deq;
+}
+
+static int
+test_pipeline_perf(void)
+{
+	struct rte_soring_param prm = {
+		.name = "PIPE_SORING",
+		.elems = RING_SIZE - 1,
+		.elem_size = sizeof(void *),
+		.stages = PIPE_STAGES,
+		.prod_synt = RTE_RING_SYNC_MT,
+		.cons_synt = RTE_RING_SYNC_MT,
+	};
+	unsigned int lcores[PIPE_STAGES], nb_lcores = 0, i, c;
+	struct pipe_params sor_params = {0}, ring_params = {0};
+	char name[RTE_RING_NAMESIZE];
+	ssize_t sz;
+	int ret = -1;
+
+	sz = rte_soring_get_memsize(&prm);
+	if (sz < 0)
+		return -1;
+	sor_params.sor = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (sor_params.sor == NULL ||
+			rte_soring_init(sor_params.sor, &prm) != 0)
+		goto out;
+
+	for (i = 0; i < RTE_DIM(ring_params.rings); i++) {
+		snprintf(name, sizeof(name), "PIPE_RING_%u", i);
+		ring_params.rings[i] = rte_ring_create(name, RING_SIZE,
+				rte_socket_id(), 0);
+		if (ring_params.rings[i] == NULL)
+			goto out;
+	}
+
+	RTE_LCORE_FOREACH_WORKER(c) {
+		if (nb_lcores == PIPE_STAGES)
+			break;
+		lcores[nb_lcores++] = c;
+	}
+
+	printf("\n### Testing pipeline of %u stages, staged ordered ring vs %u rings ###\n",
+			PIPE_STAGES, PIPE_STAGES + 1);
+	for (i = 0; i < RTE_DIM(bulk_sizes); i++) {
+		sor_params.bsize = ring_params.bsize = bulk_sizes[i];
+
+		printf("single lcore (burst: %u): soring: %.2F, rings: %.2F cycles/object\n",
+				bulk_sizes[i], pipe_run(&sor_params, NULL),
+				pipe_run(&ring_params, NULL));
+		if (nb_lcores < PIPE_STAGES)
+			continue;
+		printf("lcore per stage (burst: %u): soring: %.2F, rings: %.2F cycles/object\n",
+				bulk_sizes[i], pipe_run(&sor_params, lcores),
+				pipe_run(&ring_params, lcores));
+	}
+	if (nb_lcores < PIPE_STAGES)
+		printf("lcore per stage: skipped, needs %u worker lcores\n",
+				PIPE_STAGES);
+	ret = 0;
+
+out:
+	for (i = 0; i < RTE_DIM(ring_params.rings); i++)
+		rte_ring_free(ring_params.rings[i]);
+	rte_free(sor_params.sor);
+	return ret;
+}
+
 static int
 test_ring_perf(void)
 {
@@ -576,6 +757,9 @@ test_ring_perf(void)
 	if (test_ring_perf_esize(16) == -1)
 		return -1;
 
+	if (test_pipeline_perf() == -1)
+		return -1;
+
 	return 0;
 }
 
@@ -403,7 +403,8 @@ service_lcore_attr_get(void)
 			"lcore_attr_get() failed to get loops "
 			"(expected > zero)");
 
-	lcore_attr_id++;  // invalid lcore attr id
+	/* invalid lcore attr id */
+	lcore_attr_id = RTE_SERVICE_LCORE_ATTR_WAKEUP_LATENCY_MAX + 1;
 	TEST_ASSERT_EQUAL(-EINVAL, rte_service_lcore_attr_get(slcore_id,
 			lcore_attr_id, &lcore_attr_value),
 			"Invalid lcore attr didn't return -EINVAL");
@@ -1002,6 +1003,94 @@ service_active_two_cores(void)
 	return unregister_all();
 }
 
+static int32_t idle_cb(void *args)
+{
+	uint32_t *calls = args;
+
+	__atomic_fetch_add(calls, 1, __ATOMIC_RELAXED);
+	return -EAGAIN;
+}
+
+/* verify a service core sleeps when its service reports no work */
+static int
+service_lcore_idle_policy(void)
+{
+	static uint32_t idle_calls;
+	uint64_t sleeps = 0, cycles = 0;
+	uint32_t id;
+
+	unregister_all();
+
+	struct rte_service_spec service;
+	memset(&service, 0, sizeof(struct rte_service_spec));
+	service.callback = idle_cb;
+	service.callback_userdata = &idle_calls;
+	snprintf(service.name, sizeof(service.name), DUMMY_SERVICE_NAME);
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service, &id),
+			"Register of idle service failed");
+	rte_service_component_runstate_set(id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_set(id, 1),
+			"Error: Service start returned non-zero");
+
+	/* check error return values */
+	TEST_ASSERT_EQUAL(-ENOTSUP, rte_service_lcore_idle_policy_set(
+			rte_lcore_id(), RTE_SERVICE_LCORE_IDLE_PAUSE, 100),
+			"Non-service core didn't return -ENOTSUP");
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Service core add did not return zero");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_lcore_idle_policy_set(slcore_id,
+			UINT32_MAX, 100),
+			"Invalid idle policy didn't return -EINVAL");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_lcore_idle_policy_set(slcore_id,
+			RTE_SERVICE_LCORE_IDLE_PAUSE, 0),
+			"Zero sleep time didn't return -EINVAL");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_idle_policy_set(slcore_id,
+			RTE_SERVICE_LCORE_IDLE_PAUSE, 100),
+			"Setting pause idle policy failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(id, slcore_id, 1),
+			"Enabling valid service and core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Starting service core failed");
+	TEST_ASSERT_EQUAL(-EBUSY, rte_service_lcore_idle_policy_set(slcore_id,
+			RTE_SERVICE_LCORE_IDLE_POLL, 100),
+			"Running service core didn't return -EBUSY");
+
+	/* wait for the service lcore to run and go idle */
+	rte_delay_ms(200);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_get(slcore_id,
+			RTE_SERVICE_LCORE_ATTR_IDLE_SLEEPS, &sleeps),
+			"Valid lcore_attr_get() call didn't return success");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_get(slcore_id,
+			RTE_SERVICE_LCORE_ATTR_IDLE_CYCLES, &cycles),
+			"Valid lcore_attr_get() call didn't return success");
+	TEST_ASSERT(sleeps > 0 && cycles > 0,
+			"Idle service core did not sleep");
+	TEST_ASSERT(__atomic_load_n(&idle_calls, __ATOMIC_RELAXED) > 0,
+			"Idle service was not run");
+	rte_service_dump(stdout, UINT32_MAX);
+
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(id, slcore_id, 0),
+			"Disabling valid service and core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(slcore_id),
+			"Failed to stop service lcore");
+
+	wait_slcore_inactive(slcore_id);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_may_be_active(slcore_id),
+			  "Service lcore not stopped after waiting.");
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_reset_all(slcore_id),
+			  "Valid lcore_attr_reset_all() didn't return success");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_get(slcore_id,
+			RTE_SERVICE_LCORE_ATTR_IDLE_SLEEPS, &sleeps),
+			"Valid lcore_attr_get() call didn't return success");
+	TEST_ASSERT_EQUAL(0, sleeps, "Idle sleeps not reset");
+
+	return unregister_all();
+}
+
 static struct unit_test_suite service_tests  = {
 	.suite_name = "service core test suite",
 	.setup = testsuite_setup,
@@ -1024,6 +1113,7 @@ static struct unit_test_suite service_tests  = {
 		TEST_CASE_ST(dummy_register, NULL, service_app_lcore_mt_unsafe),
 		TEST_CASE_ST(dummy_register, NULL, service_may_be_active),
 		TEST_CASE_ST(dummy_register, NULL, service_active_two_cores),
+		TEST_CASE_ST(dummy_register, NULL, service_lcore_idle_policy),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
@@ -0,0 +1,289 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_pause.h>
+#include <rte_random.h>
+#include <rte_soring.h>
+
+#include "test.h"
+
+/*
+ * Staged ordered ring
+ * ===================
+ *
+ * #. Parameter checks and basic enqueue/acquire/release/dequeue on a single
+ *    lcore, including out of order release within a stage.
+ *
+ * #. Multi-thread test: all lcores acquire and release objects on all the
+ *    stages in random bursts, while the main lcore also enqueues sequence
+ *    numbers and checks that they are dequeued in order, having been seen
+ *    by every stage.
+ *
+ * #. Performance comparison with a pipeline of rings is in test_ring_perf.c
+ */
+
+#define SORING_SIZE	1024
+#define SORING_STAGES	3
+#define MAX_BURST	32
+#define MT_OBJS		(1 << 16)
+
+/* the high byte of an object counts the stages it went through */
+#define OBJ_STAGE_SHIFT	56
+#define OBJ_SEQ_MASK	((UINT64_C(1) << OBJ_STAGE_SHIFT) - 1)
+
+static struct rte_soring *
+soring_create(const char *name, uint32_t elems, uint32_t stages,
+	enum rte_ring_sync_type synt)
+{
+	struct rte_soring_param prm = {
+		.name = name,
+		.elems = elems,
+		.elem_size = sizeof(uint64_t),
+		.stages = stages,
+		.prod_synt = synt,
+		.cons_synt = synt,
+	};
+	struct rte_soring *r;
+	ssize_t sz;
+
+	sz = rte_soring_get_memsize(&prm);
+	if (sz < 0)
+		return NULL;
+	r = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (r == NULL)
+		return NULL;
+	if (rte_soring_init(r, &prm) != 0) {
+		rte_free(r);
+		return NULL;
+	}
+	return r;
+}
+
+static int
+test_soring_param(void)
+{
+	struct rte_soring_param prm = {
+		.name = "param",
+		.elems = SORING_SIZE,
+		.elem_size = sizeof(uint64_t),
+		.stages = SORING_STAGES,
+	};
+
+	TEST_ASSERT(rte_soring_get_memsize(&prm) > 0,
+		"valid parameters rejected");
+
+	prm.elem_size = 6;
+	TEST_ASSERT_EQUAL(rte_soring_get_memsize(&prm), -EINVAL,
+		"element size not multiple of 4 accepted");
+	prm.elem_size = sizeof(uint64_t);
+
+	prm.stages = 0;
+	TEST_ASSERT_EQUAL(rte_soring_get_memsize(&prm), -EINVAL,
+		"ring without stage accepted");
+	prm.stages = SORING_STAGES;
+
+	prm.elems = 0;
+	TEST_ASSERT_EQUAL(rte_soring_get_memsize(&prm), -EINVAL,
+		"empty ring accepted");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_soring_basic(void)
+{
+	uint64_t objs[MAX_BURST * 2], out[MAX_BURST * 2];
+	uint32_t ftoken[2], i, n, st;
+	struct rte_soring *r;
+
+	r = soring_create("basic", SORING_SIZE, SORING_STAGES,
+		RTE_RING_SYNC_ST);
+	TEST_ASSERT_NOT_NULL(r, "cannot create soring");
+
+	for (i = 0; i != RTE_DIM(objs); i++)
+		objs[i] = i;
+
+	/* nothing to acquire nor to dequeue on an empty ring */
+	TEST_ASSERT_EQUAL(rte_soring_acquire_burst(r, out, 0, MAX_BURST,
+		&ftoken[0], NULL), 0, "acquire from an empty ring");
+	TEST_ASSERT_EQUAL(rte_soring_dequeue_burst(r, out, MAX_BURST, NULL),
+		0, "dequeue from an empty ring");
+
+	n = rte_soring_enqueue_bulk(r, objs, RTE_DIM(objs), NULL);
+	TEST_ASSERT_EQUAL(n, RTE_DIM(objs), "enqueue failed");
+	TEST_ASSERT_EQUAL(rte_soring_count(r), RTE_DIM(objs), "bad count");
+
+	/* objects are not available to the consumer before the last stage */
+	TEST_ASSERT_EQUAL(rte_soring_dequeue_burst(r, out, MAX_BURST, NULL),
+		0, "dequeue of objects not released by stages");
+
+	/* release two acquires of stage 0 in reverse order */
+	n = rte_soring_acquire_bulk(r, out, 0, MAX_BURST, &ftoken[0], NULL);
+	TEST_ASSERT_EQUAL(n, MAX_BURST, "acquire failed");
+	n = rte_soring_acquire_bulk(r, out + MAX_BURST, 0, MAX_BURST,
+		&ftoken[1], NULL);
+	TEST_ASSERT_EQUAL(n, MAX_BURST, "acquire failed");
+	for (i = 0; i != RTE_DIM(out); i++)
+		TEST_ASSERT_EQUAL(out[i], objs[i], "bad acquired object");
+	TEST_ASSERT_EQUAL(rte_soring_acquire_burst(r, out, 0, MAX_BURST,
+		&ftoken[0], NULL), 0, "acquire of already acquired objects");
+
+	rte_soring_release(r, NULL, 0, MAX_BURST, ftoken[1]);
+	TEST_ASSERT_EQUAL(rte_soring_acquire_burst(r, out, 1, MAX_BURST,
+		&ftoken[1], NULL), 0, "stage tail went over an unreleased range");
+
+	rte_soring_release(r, NULL, 0, MAX_BURST, ftoken[0]);
+
+	/* the next stages replace the objects */
+	for (st = 1; st != SORING_STAGES; st++) {
+		n = rte_soring_acquire_burst(r, out, st, RTE_DIM(out),
+			&ftoken[0], NULL);
+		TEST_ASSERT_EQUAL(n, RTE_DIM(out), "stage %u acquire failed",
+			st);
+		for (i = 0; i != n; i++) {
+			TEST_ASSERT_EQUAL(out[i], objs[i] + st - 1,
+				"stage %u got a bad object", st);
+			out[i]++;
+		}
+		rte_soring_release(r, out, st, n, ftoken[0]);
+	}
+
+	n = rte_soring_dequeue_bulk(r, out, RTE_DIM(out), NULL);
+	TEST_ASSERT_EQUAL(n, RTE_DIM(out), "dequeue failed");
+	for (i = 0; i != n; i++)
+		TEST_ASSERT_EQUAL(out[i], objs[i] + SORING_STAGES - 1,
+			"bad dequeued object");
+	TEST_ASSERT_EQUAL(rte_soring_count(r), 0, "ring not empty");
+
+	/* the ring holds exactly the requested number of objects */
+	for (i = 0; i != SORING_SIZE / MAX_BURST; i++)
+		TEST_ASSERT_EQUAL(rte_soring_enqueue_bulk(r, objs, MAX_BURST,
+			NULL), MAX_BURST, "cannot fill the ring");
+	TEST_ASSERT_EQUAL(rte_soring_free_count(r), 0, "ring not full");
+	TEST_ASSERT_EQUAL(rte_soring_enqueue_burst(r, objs, 1, NULL), 0,
+		"enqueue on a full ring");
+
+	rte_soring_dump(stdout, r);
+	rte_free(r);
+	return TEST_SUCCESS;
+}
+
+static struct rte_soring *mt_ring;
+static uint32_t mt_stop;
+static uint32_t mt_errors;
+
+/* acquire and release a random burst on every stage */
+static uint32_t
+mt_run_stages(struct rte_soring *r)
+{
+	uint64_t objs[2][MAX_BURST];
+	uint32_t ftoken[2], i, k, n[2], st, total = 0;
+
+	for (st = 0; st != SORING_STAGES; st++) {
+		/* two acquires, released in reverse order */
+		for (k = 0; k != 2; k++) {
+			n[k] = rte_soring_acquire_burst(r, objs[k], st,
+				rte_rand_max(MAX_BURST) + 1, &ftoken[k], NULL);
+			for (i = 0; i != n[k]; i++) {
+				if (objs[k][i] >> OBJ_STAGE_SHIFT != st)
+					__atomic_fetch_add(&mt_errors, 1,
+						__ATOMIC_RELAXED);
+				objs[k][i] += UINT64_C(1) << OBJ_STAGE_SHIFT;
+			}
+		}
+		for (k = 2; k-- != 0; ) {
+			if (n[k] != 0)
+				rte_soring_release(r, objs[k], st, n[k],
+					ftoken[k]);
+			total += n[k];
+		}
+	}
+	return total;
+}
+
+static int
+mt_worker(void *arg __rte_unused)
+{
+	while (__atomic_load_n(&mt_stop, __ATOMIC_RELAXED) == 0)
+		if (mt_run_stages(mt_ring) == 0)
+			rte_pause();
+	return 0;
+}
+
+static int
+test_soring_mt(enum rte_ring_sync_type synt)
+{
+	uint64_t objs[MAX_BURST], next_enq = 0, next_deq = 0;
+	uint64_t deadline;
+	uint32_t i, n;
+
+	mt_ring = soring_create("mt", SORING_SIZE, SORING_STAGES, synt);
+	TEST_ASSERT_NOT_NULL(mt_ring, "cannot create soring");
+	mt_stop = 0;
+	mt_errors = 0;
+
+	rte_eal_mp_remote_launch(mt_worker, NULL, SKIP_MAIN);
+
+	deadline = rte_get_timer_cycles() + 60 * rte_get_timer_hz();
+	while (next_deq != MT_OBJS && rte_get_timer_cycles() < deadline) {
+		n = RTE_MIN((uint64_t)MAX_BURST, MT_OBJS - next_enq);
+		for (i = 0; i != n; i++)
+			objs[i] = next_enq + i;
+		next_enq += rte_soring_enqueue_burst(mt_ring, objs, n, NULL);
+
+		mt_run_stages(mt_ring);
+
+		n = rte_soring_dequeue_burst(mt_ring, objs, MAX_BURST, NULL);
+		for (i = 0; i != n; i++, next_deq++) {
+			if (objs[i] >> OBJ_STAGE_SHIFT != SORING_STAGES ||
+					(objs[i] & OBJ_SEQ_MASK) != next_deq) {
+				printf("object %#"PRIx64" dequeued, expected %"PRIu64"\n",
+					objs[i], next_deq);
+				mt_errors++;
+				break;
+			}
+		}
+		if (mt_errors != 0)
+			break;
+	}
+
+	__atomic_store_n(&mt_stop, 1, __ATOMIC_RELAXED);
+	rte_eal_mp_wait_lcore();
+
+	if (next_deq != MT_OBJS || mt_errors != 0)
+		rte_soring_dump(stdout, mt_ring);
+	rte_free(mt_ring);
+
+	TEST_ASSERT_EQUAL(mt_errors, 0, "objects went through stages out of order");
+	TEST_ASSERT_EQUAL(next_deq, MT_OBJS, "only %"PRIu64" objects dequeued",
+		next_deq);
+	return TEST_SUCCESS;
+}
+
+static int
+test_soring(void)
+{
+	if (test_soring_param() != TEST_SUCCESS)
+		return TEST_FAILED;
+	if (test_soring_basic() != TEST_SUCCESS)
+		return TEST_FAILED;
+	if (test_soring_mt(RTE_RING_SYNC_MT) != TEST_SUCCESS)
+		return TEST_FAILED;
+	if (test_soring_mt(RTE_RING_SYNC_MT_HTS) != TEST_SUCCESS)
+		return TEST_FAILED;
+	if (test_soring_mt(RTE_RING_SYNC_MT_RTS) != TEST_SUCCESS)
+		return TEST_FAILED;
+	return TEST_SUCCESS;
+}
+
+REGISTER_TEST_COMMAND(soring_autotest, test_soring);
@@ -20,11 +20,13 @@
 
 #define TELEMETRY_VERSION "v2"
 #define REQUEST_CMD "/test"
+#define SUBSCRIBE_CMD "/test/sub"
 #define BUF_SIZE 1024
 #define TEST_OUTPUT(exp) test_output(__func__, exp)
 
 static struct rte_tel_data response_data;
 static int sock;
+static int sub_calls;
 
 /*
  * This function is the callback registered with Telemetry to be used when
@@ -331,6 +333,136 @@ test_array_with_array_u64_values(void)
 	return TEST_OUTPUT("{\"/test\":[[0,1,2,3,4],[0,1,2,3,4]]}");
 }
 
+/*
+ * Callback of the subscribed command: only the number of calls changes
+ * from one push to the next.
+ */
+static int
+test_sub_cb(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	rte_tel_data_start_dict(d);
+	/* with "odd" parameters, the params entry is only in odd calls */
+	sub_calls++;
+	if (params == NULL || strcmp(params, "odd") != 0 || sub_calls % 2 != 0)
+		rte_tel_data_add_dict_string(d, "params",
+				params ? params : "none");
+	rte_tel_data_add_dict_int(d, "calls", sub_calls);
+	return 0;
+}
+
+static int
+test_request(const char *func_name, const char *request, const char *expected)
+{
+	char buf[BUF_SIZE];
+	int bytes;
+
+	if (request != NULL && write(sock, request, strlen(request)) < 0) {
+		printf("%s: Error with socket write - %s\n", __func__,
+				strerror(errno));
+		return -1;
+	}
+	bytes = read(sock, buf, sizeof(buf) - 1);
+	if (bytes < 0) {
+		printf("%s: Error with socket read - %s\n", __func__,
+				strerror(errno));
+		return -1;
+	}
+	buf[bytes] = '\0';
+	printf("%s: buf = '%s', expected = '%s'\n", func_name, buf, expected);
+	return strncmp(expected, buf, sizeof(buf));
+}
+
+/* Unsubscribe, skipping the pushes sent before the reply. */
+static int
+test_unsubscribe(const char *expected)
+{
+	char buf[BUF_SIZE];
+	int bytes, i;
+
+	if (write(sock, "/unsubscribe", strlen("/unsubscribe")) < 0)
+		return -1;
+	for (i = 0; i < 100; i++) {
+		bytes = read(sock, buf, sizeof(buf) - 1);
+		if (bytes < 0)
+			return -1;
+		buf[bytes] = '\0';
+		if (strncmp(buf, "{\"/unsubscribe\"", 15) == 0)
+			break;
+	}
+	printf("%s: buf = '%s', expected = '%s'\n", __func__, buf, expected);
+	return strncmp(expected, buf, sizeof(buf));
+}
+
+static int
+test_subscriptions(void)
+{
+	struct timeval tv = { .tv_sec = 5 };
+
+	rte_telemetry_register_cmd(SUBSCRIBE_CMD, test_sub_cb, "Test");
+	/* do not hang if a push does not come */
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	if (test_request(__func__, "/subscribe,10,/nonexistent",
+			"{\"/subscribe\":null}") != 0)
+		return -1;
+	if (test_request(__func__, "/subscribe,0," SUBSCRIBE_CMD,
+			"{\"/subscribe\":null}") != 0)
+		return -1;
+
+	/* full pushes, under the key of the command and its parameters */
+	sub_calls = 0;
+	if (test_request(__func__, "/subscribe,10," SUBSCRIBE_CMD ",x",
+			"{\"/subscribe\":{\"id\":0,\"key\":\"/test/sub,x\"}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL,
+			"{\"/test/sub,x\":{\"params\":\"x\",\"calls\":1}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL,
+			"{\"/test/sub,x\":{\"params\":\"x\",\"calls\":2}}") != 0)
+		return -1;
+	if (test_unsubscribe("{\"/unsubscribe\":{\"removed\":1}}") != 0)
+		return -1;
+
+	/* delta pushes, with only the changed entry after the first one */
+	sub_calls = 0;
+	if (test_request(__func__, "/subscribe_delta,10," SUBSCRIBE_CMD,
+			"{\"/subscribe_delta\":{\"id\":1,\"key\":\"/test/sub\"}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL,
+			"{\"/test/sub\":{\"params\":\"none\",\"calls\":1}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL, "{\"/test/sub\":{\"calls\":2}}") != 0)
+		return -1;
+	if (test_unsubscribe("{\"/unsubscribe\":{\"removed\":1}}") != 0)
+		return -1;
+
+	/* delta pushes, with the removed entry as null */
+	sub_calls = 0;
+	if (test_request(__func__, "/subscribe_delta,10," SUBSCRIBE_CMD ",odd",
+			"{\"/subscribe_delta\":{\"id\":2,"
+			"\"key\":\"/test/sub,odd\"}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL,
+			"{\"/test/sub,odd\":"
+			"{\"params\":\"odd\",\"calls\":1}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL,
+			"{\"/test/sub,odd\":"
+			"{\"calls\":2,\"params\":null}}") != 0)
+		return -1;
+	if (test_request(__func__, NULL,
+			"{\"/test/sub,odd\":"
+			"{\"params\":\"odd\",\"calls\":3}}") != 0)
+		return -1;
+	if (test_unsubscribe("{\"/unsubscribe\":{\"removed\":1}}") != 0)
+		return -1;
+
+	/* the connection still serves requests */
+	return test_request(__func__, "/unsubscribe,2",
+			"{\"/unsubscribe\":null}");
+}
+
 static int
 connect_to_socket(void)
 {
@@ -388,7 +520,8 @@ test_telemetry_data(void)
 			test_dict_with_dict_values,
 			test_array_with_array_int_values,
 			test_array_with_array_u64_values,
-			test_array_with_array_string_values };
+			test_array_with_array_string_values,
+			test_subscriptions };
 
 	rte_telemetry_register_cmd(REQUEST_CMD, test_cb, "Test");
 	for (i = 0; i < RTE_DIM(test_cases); i++) {
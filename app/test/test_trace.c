@@ -34,6 +34,21 @@ test_trace_metadata_dump(void)
 
 #else
 
+#include <ftw.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <rte_cycles.h>
+#include <rte_debug.h>
+
+#include "process.h"
+
+#define launch_proc(ARGV) process_dup(ARGV, RTE_DIM(ARGV), __func__)
+
 static int32_t
 test_trace_point_globbing(void)
 {
@@ -145,6 +160,302 @@ failed:
 
 }
 
+static int
+test_trace_events_dropped(void)
+{
+	enum rte_trace_mode current;
+	uint64_t dropped;
+	unsigned int i;
+
+	if (!rte_trace_is_enabled())
+		return TEST_SKIPPED;
+	if (!rte_trace_point_is_enabled(&__rte_eal_trace_generic_void))
+		return TEST_SKIPPED;
+
+	current = rte_trace_mode_get();
+	dropped = rte_trace_events_dropped();
+
+	/* Emit more events than a thread buffer can hold */
+	rte_trace_mode_set(RTE_TRACE_MODE_DISCARD);
+	for (i = 0; i < 1024 * 1024; i++)
+		rte_eal_trace_generic_void();
+	rte_trace_mode_set(current);
+
+	if (rte_trace_events_dropped() <= dropped)
+		return TEST_FAILED;
+
+	return TEST_SUCCESS;
+}
+
+/* Number of events emitted by the streaming process */
+#define TRACE_STREAM_EVENTS 1000
+/* Each event is a header and the u64 argument */
+#define TRACE_STREAM_EVENTS_LEN (TRACE_STREAM_EVENTS * 2 * sizeof(uint64_t))
+/* Directory of the trace and of the socket of the streaming process */
+#define TRACE_STREAM_DIR_ENV "RTE_TEST_TRACE_STREAM_DIR"
+/* Bound on the waits between the test and the streaming process */
+#define TRACE_STREAM_TIMEOUT_MS 10000
+/* Threads of the streaming process with a trace buffer */
+#define TRACE_STREAM_CHANNELS_MAX 64
+
+/* Mirrors the records sent on the trace stream socket */
+struct trace_stream_record {
+	uint32_t type;
+	uint32_t channel;
+	uint8_t payload[64 * 1024];
+};
+
+struct trace_stream_consumer {
+	char path[PATH_MAX];
+	char ready_path[PATH_MAX];
+	size_t metadata_len;
+	/* Stream headers, indexed by channel */
+	struct __rte_trace_stream_header headers[TRACE_STREAM_CHANNELS_MAX];
+	bool announced[TRACE_STREAM_CHANNELS_MAX];
+	/* Channel of the thread which emitted the events */
+	bool channel_seen;
+	uint32_t channel;
+	uint8_t *events;
+	size_t events_len;
+	int rc;
+};
+
+static int
+trace_stream_consume(struct trace_stream_consumer *c, int s)
+{
+	struct trace_stream_record *rec;
+	size_t len;
+	ssize_t n;
+	FILE *f;
+
+	rec = malloc(sizeof(*rec));
+	if (rec == NULL)
+		return -1;
+
+	/* Records until the streaming process exits */
+	while ((n = recv(s, rec, sizeof(*rec), 0)) > 0) {
+		if ((size_t)n < offsetof(struct trace_stream_record, payload))
+			goto fail;
+		len = n - offsetof(struct trace_stream_record, payload);
+
+		switch (rec->type) {
+		case 0: /* metadata */
+			/* Let the streaming process emit its events */
+			if (c->metadata_len == 0) {
+				f = fopen(c->ready_path, "w");
+				if (f == NULL)
+					goto fail;
+				fclose(f);
+			}
+			c->metadata_len += len;
+			break;
+		case 1: /* stream header, once per channel */
+			if (rec->channel >= TRACE_STREAM_CHANNELS_MAX ||
+					c->announced[rec->channel] ||
+					len != sizeof(c->headers[0]))
+				goto fail;
+			memcpy(&c->headers[rec->channel], rec->payload, len);
+			c->announced[rec->channel] = true;
+			break;
+		case 2: /* events, after the header of their channel */
+			if (rec->channel >= TRACE_STREAM_CHANNELS_MAX ||
+					!c->announced[rec->channel] ||
+					(c->channel_seen &&
+					 rec->channel != c->channel) ||
+					c->events_len + len >
+					TRACE_STREAM_EVENTS_LEN)
+				goto fail;
+			c->channel = rec->channel;
+			c->channel_seen = true;
+			memcpy(c->events + c->events_len, rec->payload, len);
+			c->events_len += len;
+			break;
+		default:
+			goto fail;
+		}
+	}
+
+	free(rec);
+	return n == 0 ? 0 : -1;
+fail:
+	free(rec);
+	return -1;
+}
+
+static void *
+trace_stream_consumer(void *arg)
+{
+	struct trace_stream_consumer *c = arg;
+	struct sockaddr_un sun = { .sun_family = AF_UNIX };
+	struct timeval tv = { .tv_sec = TRACE_STREAM_TIMEOUT_MS / 1000 };
+	unsigned int ms;
+	int s;
+
+	c->rc = -1;
+	strlcpy(sun.sun_path, c->path, sizeof(sun.sun_path));
+
+	s = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (s < 0)
+		return NULL;
+
+	/* Wait for the streaming process to listen */
+	for (ms = 0; ms < TRACE_STREAM_TIMEOUT_MS; ms += 10) {
+		if (connect(s, (struct sockaddr *)&sun, sizeof(sun)) == 0)
+			break;
+		rte_delay_us_sleep(10 * 1000);
+	}
+
+	if (ms < TRACE_STREAM_TIMEOUT_MS &&
+			setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv,
+				sizeof(tv)) == 0)
+		c->rc = trace_stream_consume(c, s);
+
+	close(s);
+	return NULL;
+}
+
+static int
+trace_stream_file_remove(const char *path, const struct stat *sb __rte_unused,
+	int type __rte_unused, struct FTW *ftw __rte_unused)
+{
+	return remove(path);
+}
+
+/* Run in the streaming process, see test_trace_stream(). */
+int
+test_trace_stream_events(void)
+{
+	const char *dir = getenv(TRACE_STREAM_DIR_ENV);
+	char ready_path[PATH_MAX];
+	unsigned int ms;
+	uint64_t i;
+
+	if (dir == NULL)
+		return -1;
+
+	/* Events are lost if the process exits without a consumer */
+	snprintf(ready_path, sizeof(ready_path), "%s/ready", dir);
+	for (ms = 0; access(ready_path, F_OK) != 0; ms += 10) {
+		if (ms >= TRACE_STREAM_TIMEOUT_MS)
+			return -1;
+		rte_delay_us_sleep(10 * 1000);
+	}
+
+	for (i = 0; i < TRACE_STREAM_EVENTS; i++)
+		rte_eal_trace_generic_u64(i);
+
+	/* The remaining events are drained on EAL cleanup */
+	return 0;
+}
+
+static int
+test_trace_stream(void)
+{
+	char dir[] = "/tmp/dpdk_trace_stream_XXXXXX";
+	char trace_dir[PATH_MAX + 16];
+	char stream[PATH_MAX + 16];
+#ifdef RTE_EXEC_ENV_LINUX
+	char tmp[PATH_MAX] = {0};
+	char prefix[PATH_MAX + 32] = {0};
+
+	/* A primary process of its own */
+	get_current_prefix(tmp, sizeof(tmp));
+	snprintf(prefix, sizeof(prefix), "--file-prefix=%s_ts", tmp);
+#else
+	const char *prefix = "";
+#endif
+	char const *argv[] = {
+		prgname,
+		"-l", "0",
+		"--no-pci",
+		"--no-huge",
+		"--no-shconf",
+		"--trace=eal.generic.u64",
+		trace_dir,
+		stream,
+		prefix
+	};
+	struct trace_stream_consumer *c;
+	uint64_t id, prev_ts = 0;
+	pthread_t thread;
+	unsigned int i;
+	int ret = TEST_FAILED;
+
+	if (mkdtemp(dir) == NULL)
+		return TEST_SKIPPED;
+
+	c = calloc(1, sizeof(*c));
+	if (c == NULL)
+		goto rm_dir;
+	c->events = malloc(TRACE_STREAM_EVENTS_LEN);
+	if (c->events == NULL)
+		goto free_consumer;
+
+	snprintf(c->path, sizeof(c->path), "%s/sock", dir);
+	snprintf(c->ready_path, sizeof(c->ready_path), "%s/ready", dir);
+	snprintf(trace_dir, sizeof(trace_dir), "--trace-dir=%s", dir);
+	snprintf(stream, sizeof(stream), "--trace-stream=unix:%s", c->path);
+
+	if (setenv(TRACE_STREAM_DIR_ENV, dir, 1) != 0 ||
+			pthread_create(&thread, NULL, trace_stream_consumer,
+				c) != 0)
+		goto free_events;
+
+	if (launch_proc(argv) != 0)
+		printf("Error - streaming process failed\n");
+	else
+		ret = TEST_SUCCESS;
+
+	pthread_join(thread, NULL);
+	unsetenv(TRACE_STREAM_DIR_ENV);
+
+	if (ret != TEST_SUCCESS)
+		goto free_events;
+	ret = TEST_FAILED;
+
+	if (c->rc != 0 || c->metadata_len == 0 || !c->channel_seen) {
+		printf("Error - incomplete trace stream\n");
+		goto free_events;
+	}
+
+	/* CTF packet magic */
+	if (c->headers[c->channel].magic != 0xC1FC1FC1) {
+		printf("Error - bad stream header\n");
+		goto free_events;
+	}
+
+	if (c->events_len != TRACE_STREAM_EVENTS_LEN) {
+		printf("Error - %zu bytes of events received\n",
+			c->events_len);
+		goto free_events;
+	}
+
+	id = (__rte_eal_trace_generic_u64 & __RTE_TRACE_FIELD_ID_MASK) >>
+		__RTE_TRACE_FIELD_ID_SHIFT;
+	for (i = 0; i < TRACE_STREAM_EVENTS; i++) {
+		uint64_t *ev = RTE_PTR_ADD(c->events, i * 2 * sizeof(*ev));
+		uint64_t ts = ev[0] &
+			~(0xffffULL << __RTE_TRACE_EVENT_HEADER_ID_SHIFT);
+
+		if (ev[0] >> __RTE_TRACE_EVENT_HEADER_ID_SHIFT != id ||
+				ev[1] != i || ts < prev_ts) {
+			printf("Error - event %u does not match\n", i);
+			goto free_events;
+		}
+		prev_ts = ts;
+	}
+
+	ret = TEST_SUCCESS;
+free_events:
+	free(c->events);
+free_consumer:
+	free(c);
+rm_dir:
+	/* Also removes the trace session directory */
+	nftw(dir, trace_stream_file_remove, 4, FTW_DEPTH | FTW_PHYS);
+	return ret;
+}
+
 static int
 test_trace_points_lookup(void)
 {
@@ -209,6 +520,8 @@ static struct unit_test_suite trace_tests = {
 		TEST_CASE(test_trace_point_globbing),
 		TEST_CASE(test_trace_point_regex),
 		TEST_CASE(test_trace_points_lookup),
+		TEST_CASE(test_trace_events_dropped),
+		TEST_CASE(test_trace_stream),
 		TEST_CASES_END()
 	}
 };
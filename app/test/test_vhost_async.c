@@ -0,0 +1,460 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+
+#include "test.h"
+
+/*
+ * A vhost port is connected to a virtio-user port, with its queues bound to
+ * a software DMA device, so that the vhost library asynchronous enqueue and
+ * dequeue do the copies.
+ *
+ * Packets are sent both ways, with split then packed rings. Every third
+ * packet is empty: virtio-user sends it as a descriptor chain holding only
+ * the virtio-net header. All the packets must be received in order, the
+ * empty ones as empty mbufs as on the synchronous path, and more packets
+ * than the ring size are sent, so that a chain left in the ring stalls the
+ * queue.
+ *
+ * The vhost PMD async devargs are checked, and the vrings are disabled
+ * while vhost TX bursts run on a worker lcore, to check that the in-flight
+ * packets are drained without deadlock or leak.
+ */
+
+#define VHOST_NAME "net_vhost_async"
+#define VIRTIO_NAME "net_virtio_user_async"
+#define DMA_NAME "dma_sw_vhost_async"
+#define NB_MBUF 4096
+#define NB_DESC 256
+#define MAX_BURST 32
+#define NB_PKTS (4 * NB_DESC)
+#define MAX_LEN 1500
+#define LINK_WAIT_MS 5000
+/* the DMA worker may share the CPU of the main lcore */
+#define IDLE_POLLS 100000
+#define IDLE_SLEEP_US 10
+#define RECONNECTS 4
+#define RECONNECT_US 10000
+
+static const unsigned int bursts[] = { 1, 3, 4, 8, 32, 5 };
+
+static struct rte_mempool *mp;
+static char sock_path[64];
+static uint16_t vhost_port;
+static uint16_t virtio_port;
+static unsigned int dma_lcore;
+static volatile int burst_stop;
+
+static int
+port_setup(uint16_t port)
+{
+	struct rte_eth_conf conf;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(port, 1, 1, &conf) < 0)
+		return -1;
+	if (rte_eth_rx_queue_setup(port, 0, NB_DESC, SOCKET_ID_ANY, NULL,
+			mp) < 0)
+		return -1;
+	if (rte_eth_tx_queue_setup(port, 0, NB_DESC, SOCKET_ID_ANY, NULL) < 0)
+		return -1;
+	return rte_eth_dev_start(port);
+}
+
+static void
+virtio_port_destroy(void)
+{
+	uint16_t port;
+
+	if (rte_eth_dev_get_port_by_name(VIRTIO_NAME, &port) == 0) {
+		rte_eth_dev_stop(port);
+		rte_eth_dev_close(port);
+		rte_vdev_uninit(VIRTIO_NAME);
+	}
+}
+
+static void
+ports_destroy(void)
+{
+	uint16_t port;
+
+	virtio_port_destroy();
+	if (rte_eth_dev_get_port_by_name(VHOST_NAME, &port) == 0) {
+		rte_eth_dev_stop(port);
+		rte_eth_dev_close(port);
+		rte_vdev_uninit(VHOST_NAME);
+	}
+	unlink(sock_path);
+}
+
+/* Connects virtio-user to the vhost port and waits for the vhost link. */
+static int
+virtio_port_create(int packed)
+{
+	struct rte_eth_link link;
+	char args[128];
+	int i;
+
+	snprintf(args, sizeof(args), "path=%s,queues=1,packed_vq=%d",
+		sock_path, packed);
+	if (rte_vdev_init(VIRTIO_NAME, args) != 0) {
+		printf("Cannot create virtio-user port\n");
+		return -1;
+	}
+	if (rte_eth_dev_get_port_by_name(VIRTIO_NAME, &virtio_port) != 0 ||
+			port_setup(virtio_port) != 0) {
+		printf("Cannot set up virtio-user port\n");
+		virtio_port_destroy();
+		return -1;
+	}
+
+	/* vhost link is up once the virtio-user rings are ready */
+	for (i = 0; i < LINK_WAIT_MS; i++) {
+		if (rte_eth_link_get_nowait(vhost_port, &link) == 0 &&
+				link.link_status == RTE_ETH_LINK_UP)
+			return 0;
+		rte_delay_ms(1);
+	}
+	printf("vhost link is down\n");
+	virtio_port_destroy();
+	return -1;
+}
+
+static int
+ports_create(int packed)
+{
+	char args[128];
+
+	snprintf(args, sizeof(args),
+		"iface=%s,queues=1,dmas=[txq0@%s;rxq0@%s],dma-ring-size=1024",
+		sock_path, DMA_NAME, DMA_NAME);
+	if (rte_vdev_init(VHOST_NAME, args) != 0) {
+		printf("Cannot create vhost port\n");
+		return -1;
+	}
+	if (rte_eth_dev_get_port_by_name(VHOST_NAME, &vhost_port) != 0 ||
+			port_setup(vhost_port) != 0) {
+		printf("Cannot set up vhost port\n");
+		ports_destroy();
+		return -1;
+	}
+
+	if (virtio_port_create(packed) != 0) {
+		ports_destroy();
+		return -1;
+	}
+	return 0;
+}
+
+/* virtio RX drops runts, empty packets are only sent by virtio-user */
+static uint16_t
+pkt_len(unsigned int idx, int empty)
+{
+	if (empty && idx % 3 == 0)
+		return 0;
+	return RTE_ETHER_MIN_LEN + (idx * 97) % (MAX_LEN - RTE_ETHER_MIN_LEN);
+}
+
+static struct rte_mbuf *
+pkt_build(unsigned int idx, int empty)
+{
+	struct rte_mbuf *m;
+	uint16_t len = pkt_len(idx, empty);
+	uint8_t *data;
+	uint16_t i;
+
+	m = rte_pktmbuf_alloc(mp);
+	if (m == NULL)
+		return NULL;
+	data = (uint8_t *)rte_pktmbuf_append(m, len);
+	for (i = 0; i < len; i++)
+		data[i] = idx + i;
+	return m;
+}
+
+static int
+pkt_check(const struct rte_mbuf *m, unsigned int idx, int empty)
+{
+	static uint8_t buf[MAX_LEN];
+	const uint8_t *data;
+	uint16_t i;
+
+	if (m->pkt_len != pkt_len(idx, empty))
+		return -1;
+	if (m->pkt_len == 0)
+		return 0;
+	data = rte_pktmbuf_read(m, 0, m->pkt_len, buf);
+	for (i = 0; i < m->pkt_len; i++)
+		if (data[i] != (uint8_t)(idx + i))
+			return -1;
+	return 0;
+}
+
+/* Sends NB_PKTS packets from tx_port, checked in order on rx_port. */
+static int
+transfer(uint16_t tx_port, uint16_t rx_port, int empty)
+{
+	struct rte_mbuf *pkts[MAX_BURST];
+	unsigned int sent = 0, received = 0, idle = 0;
+	unsigned int burst, nb, i;
+
+	while (received < NB_PKTS && idle < IDLE_POLLS) {
+		idle++;
+		if (sent < NB_PKTS) {
+			burst = RTE_MIN(bursts[sent % RTE_DIM(bursts)],
+				NB_PKTS - sent);
+			for (i = 0; i < burst; i++) {
+				pkts[i] = pkt_build(sent + i, empty);
+				if (pkts[i] == NULL)
+					break;
+			}
+			nb = rte_eth_tx_burst(tx_port, 0, pkts, i);
+			rte_pktmbuf_free_bulk(&pkts[nb], i - nb);
+			if (nb != 0)
+				idle = 0;
+			sent += nb;
+		} else {
+			/* async vhost TX copies complete on the next burst */
+			rte_eth_tx_burst(tx_port, 0, pkts, 0);
+		}
+
+		nb = rte_eth_rx_burst(rx_port, 0, pkts, MAX_BURST);
+		for (i = 0; i < nb; i++) {
+			if (received >= NB_PKTS || pkt_check(pkts[i],
+					received, empty) != 0) {
+				printf("Unexpected packet %u, length %u\n",
+					received, pkts[i]->pkt_len);
+				rte_pktmbuf_free_bulk(pkts, nb);
+				return -1;
+			}
+			received++;
+		}
+		rte_pktmbuf_free_bulk(pkts, nb);
+		if (nb != 0)
+			idle = 0;
+		else
+			rte_delay_us_sleep(IDLE_SLEEP_US);
+	}
+
+	if (received != NB_PKTS) {
+		printf("%u packets received out of %u\n", received, NB_PKTS);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_transfer(int packed)
+{
+	int ret;
+
+	ret = ports_create(packed);
+	if (ret != 0)
+		return ret;
+
+	ret = transfer(virtio_port, vhost_port, 1);
+	if (ret != 0)
+		printf("Async dequeue failed with %s ring\n",
+			packed ? "packed" : "split");
+	if (ret == 0) {
+		ret = transfer(vhost_port, virtio_port, 0);
+		if (ret != 0)
+			printf("Async enqueue failed with %s ring\n",
+				packed ? "packed" : "split");
+	}
+
+	ports_destroy();
+	return ret;
+}
+
+static int
+test_vhost_async_split(void)
+{
+	return test_transfer(0);
+}
+
+static int
+test_vhost_async_packed(void)
+{
+	return test_transfer(1);
+}
+
+static int
+test_vhost_async_devargs(void)
+{
+	static const char * const invalid[] = {
+		"dma-ring-size=0",
+		"dma-ring-size=16",
+		"dma-ring-size=100",
+		"dma-ring-size=65536",
+		"dma-ring-size=-1024",
+		"dma-ring-size=1k",
+		"dma-ring-size=",
+		"dmas=[rxq0@dma_none]",
+		"dmas=[rxq1@" DMA_NAME "]",
+		"dmas=[foo0@" DMA_NAME "]",
+		"dmas=[rxq@" DMA_NAME "]",
+		"dmas=[rxq0@" DMA_NAME,
+		"dmas=[rxq0]",
+	};
+	char args[128];
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(invalid); i++) {
+		snprintf(args, sizeof(args), "iface=%s,queues=1,%s",
+			sock_path, invalid[i]);
+		if (rte_vdev_init(VHOST_NAME, args) == 0) {
+			printf("Invalid devargs accepted: %s\n", invalid[i]);
+			rte_vdev_uninit(VHOST_NAME);
+			unlink(sock_path);
+			return -1;
+		}
+	}
+
+	snprintf(args, sizeof(args),
+		"iface=%s,queues=1,dmas=[txq0@%s;rxq0@%s],dma-ring-size=32",
+		sock_path, DMA_NAME, DMA_NAME);
+	if (rte_vdev_init(VHOST_NAME, args) != 0) {
+		printf("Valid devargs rejected: %s\n", args);
+		return -1;
+	}
+	rte_vdev_uninit(VHOST_NAME);
+	unlink(sock_path);
+	return 0;
+}
+
+static int
+burst_loop(void *arg __rte_unused)
+{
+	struct rte_mbuf *pkts[MAX_BURST];
+	unsigned int idx = 1, nb_pkts = 0, nb;
+
+	/* retry the packets not sent, to stay in the vhost TX burst */
+	while (!burst_stop) {
+		while (nb_pkts < MAX_BURST) {
+			pkts[nb_pkts] = pkt_build(idx, 0);
+			if (pkts[nb_pkts] == NULL)
+				break;
+			nb_pkts++;
+			idx++;
+		}
+		nb = rte_eth_tx_burst(vhost_port, 0, pkts, nb_pkts);
+		nb_pkts -= nb;
+		memmove(pkts, &pkts[nb], nb_pkts * sizeof(pkts[0]));
+	}
+	rte_pktmbuf_free_bulk(pkts, nb_pkts);
+	return 0;
+}
+
+/*
+ * Reconnects virtio-user while vhost TX bursts run on a worker lcore:
+ * the vrings are disabled, and their in-flight packets drained, while a
+ * burst may be waiting for the vring lock.
+ */
+static int
+test_vhost_async_vring_state(void)
+{
+	unsigned int lcore_id = rte_get_next_lcore(dma_lcore, 1, 0);
+	unsigned int i;
+	int ret;
+
+	if (lcore_id >= RTE_MAX_LCORE) {
+		printf("No second worker lcore, skipping\n");
+		return TEST_SKIPPED;
+	}
+
+	ret = ports_create(0);
+	if (ret != 0)
+		return ret;
+
+	burst_stop = 0;
+	rte_eal_remote_launch(burst_loop, NULL, lcore_id);
+	for (i = 0; i < RECONNECTS && ret == 0; i++) {
+		rte_delay_us_sleep(RECONNECT_US);
+		virtio_port_destroy();
+		ret = virtio_port_create(i % 2);
+	}
+	burst_stop = 1;
+	rte_eal_wait_lcore(lcore_id);
+
+	ports_destroy();
+	if (ret != 0)
+		return ret;
+
+	/* the packets in flight when the vrings were disabled are freed */
+	if (rte_mempool_avail_count(mp) != NB_MBUF) {
+		printf("%u mbufs leaked\n",
+			NB_MBUF - rte_mempool_avail_count(mp));
+		return -1;
+	}
+	return 0;
+}
+
+static int
+testsuite_setup(void)
+{
+	char args[32];
+
+	/* the software dmadev needs a worker lcore to do the copies */
+	dma_lcore = rte_get_next_lcore(-1, 1, 0);
+	if (dma_lcore >= RTE_MAX_LCORE) {
+		printf("No worker lcore, skipping\n");
+		return TEST_SKIPPED;
+	}
+	snprintf(args, sizeof(args), "lcore=%u", dma_lcore);
+	if (rte_vdev_init(DMA_NAME, args) != 0) {
+		printf("Cannot create software dmadev\n");
+		return TEST_SKIPPED;
+	}
+
+	snprintf(sock_path, sizeof(sock_path), "/tmp/dpdk_vhost_async_%d",
+		getpid());
+	mp = rte_pktmbuf_pool_create("vhost_async_pool", NB_MBUF, 0, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (mp == NULL) {
+		printf("Cannot create mbuf pool\n");
+		rte_vdev_uninit(DMA_NAME);
+		return TEST_FAILED;
+	}
+	return TEST_SUCCESS;
+}
+
+static void
+testsuite_teardown(void)
+{
+	rte_mempool_free(mp);
+	mp = NULL;
+	rte_vdev_uninit(DMA_NAME);
+}
+
+static struct unit_test_suite vhost_async_testsuite = {
+	.suite_name = "vhost async data path",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_vhost_async_devargs),
+		TEST_CASE(test_vhost_async_split),
+		TEST_CASE(test_vhost_async_packed),
+		TEST_CASE(test_vhost_async_vring_state),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_vhost_async(void)
+{
+	return unit_test_suite_runner(&vhost_async_testsuite);
+}
+
+REGISTER_TEST_COMMAND(vhost_async_autotest, test_vhost_async);
@@ -0,0 +1,406 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_vect.h>
+
+#include "test.h"
+
+/*
+ * Loopback between a vhost and a virtio-user port with a packed ring,
+ * within the main lcore: packets sent by virtio-user are dequeued by vhost,
+ * then sent back to virtio-user through the vhost enqueue path.
+ * The max SIMD bitwidth is set to 512 bits, unless it is forced on the
+ * command line, and the vhost port is created with the vectorized packed
+ * ring processing disabled then allowed, so that only the vhost data path
+ * changes between the runs.
+ *
+ * The functional test checks that the same traffic, with packets of various
+ * lengths, chained or not, gives the same packets in both directions with
+ * both processings. The performance test reports the cycles per packet.
+ */
+
+#define VHOST_NAME "net_vhost_perf"
+#define VIRTIO_NAME "net_virtio_user_perf"
+#define NB_MBUF 8192
+#define NB_DESC 256
+#define MAX_BURST 32
+#define PKT_LEN 64
+#define ITERATIONS (1 << 18)
+#define LINK_WAIT_MS 5000
+
+#define FUNC_NB_PKTS 1024
+#define FUNC_MAX_LEN 3000
+#define FUNC_IDLE_POLLS 1000
+
+static const volatile unsigned int bulk_sizes[] = { 4, 8, 32 };
+static const unsigned int func_bursts[] = { 1, 3, 4, 8, 32, 5 };
+
+static struct rte_mempool *mp;
+static struct rte_mempool *tx_mp;
+static char sock_path[64];
+static uint16_t vhost_port;
+static uint16_t virtio_port;
+
+static int
+port_setup(uint16_t port)
+{
+	struct rte_eth_conf conf;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(port, 1, 1, &conf) < 0)
+		return -1;
+	if (rte_eth_rx_queue_setup(port, 0, NB_DESC, SOCKET_ID_ANY, NULL,
+			mp) < 0)
+		return -1;
+	if (rte_eth_tx_queue_setup(port, 0, NB_DESC, SOCKET_ID_ANY, NULL) < 0)
+		return -1;
+	return rte_eth_dev_start(port);
+}
+
+static void
+ports_destroy(void)
+{
+	uint16_t port;
+
+	if (rte_eth_dev_get_port_by_name(VIRTIO_NAME, &port) == 0) {
+		rte_eth_dev_stop(port);
+		rte_eth_dev_close(port);
+		rte_vdev_uninit(VIRTIO_NAME);
+	}
+	if (rte_eth_dev_get_port_by_name(VHOST_NAME, &port) == 0) {
+		rte_eth_dev_stop(port);
+		rte_eth_dev_close(port);
+		rte_vdev_uninit(VHOST_NAME);
+	}
+	unlink(sock_path);
+}
+
+/* Returns TEST_SKIPPED if the drivers are not available. */
+static int
+ports_create(int vectorized)
+{
+	struct rte_eth_link link;
+	char args[128];
+	int i;
+
+	snprintf(args, sizeof(args), "iface=%s,queues=1,vectorized=%d",
+		sock_path, vectorized);
+	if (rte_vdev_init(VHOST_NAME, args) != 0)
+		return TEST_SKIPPED;
+	if (rte_eth_dev_get_port_by_name(VHOST_NAME, &vhost_port) != 0 ||
+			port_setup(vhost_port) != 0) {
+		printf("Cannot set up vhost port\n");
+		goto fail;
+	}
+
+	snprintf(args, sizeof(args), "path=%s,queues=1,packed_vq=1",
+		sock_path);
+	if (rte_vdev_init(VIRTIO_NAME, args) != 0) {
+		ports_destroy();
+		return TEST_SKIPPED;
+	}
+	if (rte_eth_dev_get_port_by_name(VIRTIO_NAME, &virtio_port) != 0 ||
+			port_setup(virtio_port) != 0) {
+		printf("Cannot set up virtio-user port\n");
+		goto fail;
+	}
+
+	/* vhost link is up once the virtio-user rings are ready */
+	for (i = 0; i < LINK_WAIT_MS; i++) {
+		if (rte_eth_link_get_nowait(vhost_port, &link) == 0 &&
+				link.link_status == RTE_ETH_LINK_UP)
+			return 0;
+		rte_delay_ms(1);
+	}
+	printf("vhost link is down\n");
+
+fail:
+	ports_destroy();
+	return -1;
+}
+
+static int
+loopback_burst(unsigned int n)
+{
+	struct rte_mbuf *pkts[MAX_BURST];
+	unsigned int i, nb_tx, nb_rx, nb;
+
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, n) != 0)
+		return -1;
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_append(pkts[i], PKT_LEN);
+
+	nb_tx = rte_eth_tx_burst(virtio_port, 0, pkts, n);
+	rte_pktmbuf_free_bulk(&pkts[nb_tx], n - nb_tx);
+
+	/* vhost dequeue, then enqueue */
+	nb_rx = 0;
+	do {
+		nb = rte_eth_rx_burst(vhost_port, 0, pkts, n);
+		nb_tx = rte_eth_tx_burst(vhost_port, 0, pkts, nb);
+		rte_pktmbuf_free_bulk(&pkts[nb_tx], nb - nb_tx);
+		nb_rx += nb;
+	} while (nb != 0 && nb_rx < n);
+
+	do {
+		nb = rte_eth_rx_burst(virtio_port, 0, pkts, n);
+		rte_pktmbuf_free_bulk(pkts, nb);
+	} while (nb != 0);
+
+	return nb_rx;
+}
+
+static int
+test_loopback(int vectorized)
+{
+	unsigned int i, j;
+	uint64_t start, end, nb_pkts;
+	int ret;
+
+	ret = ports_create(vectorized);
+	if (ret != 0)
+		return ret;
+
+	for (i = 0; i < RTE_DIM(bulk_sizes); i++) {
+		nb_pkts = 0;
+		start = rte_rdtsc_precise();
+		for (j = 0; j < ITERATIONS / bulk_sizes[i]; j++) {
+			ret = loopback_burst(bulk_sizes[i]);
+			if (ret < 0)
+				break;
+			nb_pkts += ret;
+		}
+		end = rte_rdtsc_precise();
+
+		if (ret < 0 || nb_pkts == 0) {
+			printf("No packet looped back\n");
+			ports_destroy();
+			return -1;
+		}
+		printf("%s, burst %u: %.1F cycles/pkt\n",
+			vectorized ? "vectorized" : "scalar", bulk_sizes[i],
+			(double)(end - start) / nb_pkts);
+	}
+
+	ports_destroy();
+	return 0;
+}
+
+static uint16_t
+func_pkt_len(unsigned int idx)
+{
+	return RTE_ETHER_MIN_LEN +
+		(idx * 97) % (FUNC_MAX_LEN - RTE_ETHER_MIN_LEN);
+}
+
+/* Every fifth packet is made of two segments. */
+static struct rte_mbuf *
+func_pkt_build(unsigned int idx)
+{
+	struct rte_mbuf *m, *seg;
+	uint16_t len = func_pkt_len(idx);
+	uint16_t first = idx % 5 == 0 ? len / 2 : len;
+	uint8_t *data;
+	uint16_t i;
+
+	m = rte_pktmbuf_alloc(tx_mp);
+	if (m == NULL)
+		return NULL;
+	data = (uint8_t *)rte_pktmbuf_append(m, first);
+	for (i = 0; i < first; i++)
+		data[i] = idx + i;
+	if (first == len)
+		return m;
+
+	seg = rte_pktmbuf_alloc(tx_mp);
+	if (seg == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	data = (uint8_t *)rte_pktmbuf_append(seg, len - first);
+	for (i = first; i < len; i++)
+		data[i - first] = idx + i;
+	rte_pktmbuf_chain(m, seg);
+	return m;
+}
+
+/* Returns the length and checksum of the packet, or 0 if it is corrupted. */
+static uint32_t
+func_pkt_check(const struct rte_mbuf *m, unsigned int idx)
+{
+	static uint8_t buf[FUNC_MAX_LEN];
+	const uint8_t *data;
+	uint16_t i;
+
+	if (m->pkt_len != func_pkt_len(idx))
+		return 0;
+	data = rte_pktmbuf_read(m, 0, m->pkt_len, buf);
+	for (i = 0; i < m->pkt_len; i++)
+		if (data[i] != (uint8_t)(idx + i))
+			return 0;
+	return (uint32_t)m->pkt_len << 16 | rte_raw_cksum(data, m->pkt_len);
+}
+
+/*
+ * Sends FUNC_NB_PKTS packets from tx_port in bursts of various sizes and
+ * stores the digest of each packet received in order on rx_port.
+ */
+static int
+func_transfer(uint16_t tx_port, uint16_t rx_port, uint32_t *digests)
+{
+	struct rte_mbuf *pkts[MAX_BURST];
+	unsigned int sent = 0, received = 0, idle = 0;
+	unsigned int burst, nb, i;
+
+	while (received < FUNC_NB_PKTS && idle < FUNC_IDLE_POLLS) {
+		idle++;
+		if (sent < FUNC_NB_PKTS) {
+			burst = RTE_MIN(func_bursts[sent % RTE_DIM(func_bursts)],
+				FUNC_NB_PKTS - sent);
+			for (i = 0; i < burst; i++) {
+				pkts[i] = func_pkt_build(sent + i);
+				if (pkts[i] == NULL)
+					break;
+			}
+			nb = rte_eth_tx_burst(tx_port, 0, pkts, i);
+			rte_pktmbuf_free_bulk(&pkts[nb], i - nb);
+			if (nb != 0)
+				idle = 0;
+			sent += nb;
+		}
+
+		nb = rte_eth_rx_burst(rx_port, 0, pkts, MAX_BURST);
+		for (i = 0; i < nb; i++) {
+			if (received < FUNC_NB_PKTS)
+				digests[received] = func_pkt_check(pkts[i],
+					received);
+			if (received >= FUNC_NB_PKTS ||
+					digests[received] == 0) {
+				printf("Unexpected packet %u, length %u\n",
+					received, pkts[i]->pkt_len);
+				rte_pktmbuf_free_bulk(pkts, nb);
+				return -1;
+			}
+			received++;
+		}
+		rte_pktmbuf_free_bulk(pkts, nb);
+		if (nb != 0)
+			idle = 0;
+	}
+
+	if (received != FUNC_NB_PKTS) {
+		printf("%u packets received out of %u\n", received,
+			FUNC_NB_PKTS);
+		return -1;
+	}
+	return 0;
+}
+
+/* digests[0] from virtio-user to vhost, digests[1] from vhost to virtio-user */
+static int
+func_run(int vectorized, uint32_t digests[2][FUNC_NB_PKTS])
+{
+	int ret;
+
+	ret = ports_create(vectorized);
+	if (ret != 0)
+		return ret;
+
+	ret = func_transfer(virtio_port, vhost_port, digests[0]);
+	if (ret == 0)
+		ret = func_transfer(vhost_port, virtio_port, digests[1]);
+	if (ret != 0)
+		printf("%s processing failed\n",
+			vectorized ? "Vectorized" : "Scalar");
+
+	ports_destroy();
+	return ret;
+}
+
+static int
+test_vhost_vectorized_run(void)
+{
+	static uint32_t digests[2][2][FUNC_NB_PKTS];
+	int ret;
+
+	ret = func_run(0, digests[0]);
+	if (ret != 0)
+		return ret;
+	ret = func_run(1, digests[1]);
+	if (ret != 0)
+		return ret;
+
+	if (memcmp(digests[0], digests[1], sizeof(digests[0])) != 0) {
+		printf("Scalar and vectorized processing differ\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_vhost_setup(int (*run)(void))
+{
+	uint16_t bitwidth = rte_vect_get_max_simd_bitwidth();
+	int ret;
+
+	snprintf(sock_path, sizeof(sock_path), "/tmp/dpdk_vhost_perf_%d",
+		getpid());
+
+	mp = rte_pktmbuf_pool_create("vhost_perf_pool", NB_MBUF, 256, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	tx_mp = rte_pktmbuf_pool_create("vhost_perf_tx_pool", NB_MBUF, 256, 0,
+		RTE_PKTMBUF_HEADROOM + FUNC_MAX_LEN, SOCKET_ID_ANY);
+	if (mp == NULL || tx_mp == NULL) {
+		printf("Cannot create mbuf pool\n");
+		rte_mempool_free(mp);
+		rte_mempool_free(tx_mp);
+		return -1;
+	}
+
+	/* the packed ring processing is chosen when the device connects */
+	if (rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_512) != 0)
+		printf("Max SIMD bitwidth is forced to %u bits\n", bitwidth);
+	ret = run();
+	rte_vect_set_max_simd_bitwidth(bitwidth);
+
+	rte_mempool_free(tx_mp);
+	rte_mempool_free(mp);
+	return ret;
+}
+
+static int
+test_vhost_perf_run(void)
+{
+	int ret;
+
+	ret = test_loopback(0);
+	if (ret == 0)
+		ret = test_loopback(1);
+	return ret;
+}
+
+static int
+test_vhost_vectorized(void)
+{
+	return test_vhost_setup(test_vhost_vectorized_run);
+}
+
+static int
+test_vhost_perf(void)
+{
+	return test_vhost_setup(test_vhost_perf_run);
+}
+
+REGISTER_TEST_COMMAND(vhost_vectorized_autotest, test_vhost_vectorized);
+REGISTER_TEST_COMMAND(vhost_perf_autotest, test_vhost_perf);
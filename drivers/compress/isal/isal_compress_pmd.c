@@ -8,6 +8,7 @@
 #include <rte_cpuflags.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
+#include <rte_prefetch.h>
 #include <rte_compressdev_pmd.h>
 
 #include "isal_compress_pmd_private.h"
@@ -230,6 +231,17 @@ isal_comp_set_priv_xform_parameters(struct isal_priv_xform *priv_xform,
 	return 0;
 }
 
+/* Segment of a mbuf chain holding an offset, made relative to the segment */
+static inline struct rte_mbuf *
+mbuf_seg_at(struct rte_mbuf *m, uint32_t *offset)
+{
+	while (*offset >= m->data_len && m->next != NULL) {
+		*offset -= m->data_len;
+		m = m->next;
+	}
+	return m;
+}
+
 /* Compression using chained mbufs for input/output data */
 static int
 chained_mbuf_compression(struct rte_comp_op *op, struct isal_comp_qp *qp)
@@ -320,91 +332,65 @@ chained_mbuf_compression(struct rte_comp_op *op, struct isal_comp_qp *qp)
 	return 0;
 }
 
-/* Decompression using chained mbufs for input/output data */
+/*
+ * Decompression using chained mbufs for input/output data, the segments
+ * being read and written in place. The state may continue a stream
+ * decompressed by previous ops, consumed and produced are those of this op.
+ */
 static int
-chained_mbuf_decompression(struct rte_comp_op *op, struct isal_comp_qp *qp)
+chained_mbuf_decompression(struct rte_comp_op *op, struct inflate_state *state)
 {
 	int ret;
-	uint32_t consumed_data, src_remaining_offset, dst_remaining_offset;
+	uint32_t src_offset = op->src.offset;
+	uint32_t dst_offset = op->dst.offset;
 	uint32_t remaining_data = op->src.length;
-	struct rte_mbuf *src = op->m_src;
-	struct rte_mbuf *dst = op->m_dst;
-
-	/* check for offset passing multiple segments
-	 * and point decompression state to input/output buffer
-	 */
-	src_remaining_offset = op->src.offset;
-	while (src_remaining_offset >= src->data_len) {
-		src_remaining_offset -= src->data_len;
-		src = src->next;
-	}
-	qp->state->avail_in = RTE_MIN(src->data_len - src_remaining_offset,
-			op->src.length);
-	qp->state->next_in = rte_pktmbuf_mtod_offset(src, uint8_t *,
-			src_remaining_offset);
-
-	dst_remaining_offset = op->dst.offset;
-	while (dst_remaining_offset >= dst->data_len) {
-		dst_remaining_offset -= dst->data_len;
-		dst = dst->next;
-	}
-	qp->state->avail_out = dst->data_len - dst_remaining_offset;
-	qp->state->next_out = rte_pktmbuf_mtod_offset(dst, uint8_t *,
-			dst_remaining_offset);
-
-	while (qp->state->block_state != ISAL_BLOCK_FINISH) {
-
-		ret = isal_inflate(qp->state);
-
-		/* Check for first segment, offset needs to be accounted for */
-		if (remaining_data == op->src.length) {
-			consumed_data = src->data_len - src_remaining_offset;
-		} else
-			consumed_data = src->data_len;
-
-		if (qp->state->avail_in == 0
-				&& op->consumed != op->src.length) {
-			op->consumed += consumed_data;
-			remaining_data -= consumed_data;
-
-			if (src->next != NULL) {
-				src = src->next;
-				qp->state->next_in =
-						rte_pktmbuf_mtod(src, uint8_t *);
-				qp->state->avail_in =
-					RTE_MIN(remaining_data, src->data_len);
-			}
-		}
-
-		if (ret == ISAL_OUT_OVERFLOW) {
-			ISAL_PMD_LOG(ERR, "Decompression operation ran "
-				"out of space, but can be recovered.\n%d bytes "
-				"consumed\t%d bytes produced\n",
-				consumed_data, qp->state->total_out);
-				op->status =
-				RTE_COMP_OP_STATUS_OUT_OF_SPACE_RECOVERABLE;
-			return ret;
-		} else if (ret < 0) {
-			ISAL_PMD_LOG(ERR, "Decompression operation failed\n");
-			op->status = RTE_COMP_OP_STATUS_ERROR;
-			return ret;
-		}
+	uint32_t total_in = state->total_in;
+	uint32_t total_out = state->total_out;
+	struct rte_mbuf *src = mbuf_seg_at(op->m_src, &src_offset);
+	struct rte_mbuf *dst = mbuf_seg_at(op->m_dst, &dst_offset);
+
+	/* point decompression state to input/output buffer */
+	state->avail_in = RTE_MIN(src->data_len - src_offset, remaining_data);
+	state->next_in = rte_pktmbuf_mtod_offset(src, uint8_t *, src_offset);
+	remaining_data -= state->avail_in;
+
+	state->avail_out = dst->data_len - dst_offset;
+	state->next_out = rte_pktmbuf_mtod_offset(dst, uint8_t *, dst_offset);
+
+	for (;;) {
+		ret = isal_inflate(state);
+		if (ret < 0 || state->block_state == ISAL_BLOCK_FINISH)
+			break;
 
-		if (qp->state->avail_out == 0 &&
-				qp->state->block_state != ISAL_BLOCK_FINISH) {
-			if (dst->next != NULL) {
-				dst = dst->next;
-				qp->state->next_out =
-						rte_pktmbuf_mtod(dst, uint8_t *);
-				qp->state->avail_out = dst->data_len;
-			} else {
+		/* Move to the next input segment, then to the next output one,
+		 * the output pending in the state being flushed on the way.
+		 */
+		if (state->avail_in == 0 && remaining_data != 0) {
+			if (src->next == NULL) {
 				ISAL_PMD_LOG(ERR,
-				"Not enough output buffer segments\n");
-				op->status =
-				RTE_COMP_OP_STATUS_OUT_OF_SPACE_TERMINATED;
+				"Not enough input buffer segments\n");
+				op->status = RTE_COMP_OP_STATUS_INVALID_ARGS;
 				return -1;
 			}
-		}
+			src = src->next;
+			state->next_in = rte_pktmbuf_mtod(src, uint8_t *);
+			state->avail_in = RTE_MIN(remaining_data, src->data_len);
+			remaining_data -= state->avail_in;
+		} else if (state->avail_out == 0 && dst->next != NULL) {
+			dst = dst->next;
+			state->next_out = rte_pktmbuf_mtod(dst, uint8_t *);
+			state->avail_out = dst->data_len;
+		} else
+			break;
+	}
+
+	op->consumed = state->total_in - total_in;
+	op->produced = state->total_out - total_out;
+
+	if (ret < 0) {
+		ISAL_PMD_LOG(ERR, "Decompression operation failed\n");
+		op->status = RTE_COMP_OP_STATUS_ERROR;
+		return ret;
 	}
 
 	return 0;
@@ -416,6 +402,9 @@ process_isal_deflate(struct rte_comp_op *op, struct isal_comp_qp *qp,
 		struct isal_priv_xform *priv_xform)
 {
 	int ret = 0;
+	uint32_t src_offset, dst_offset;
+	struct rte_mbuf *src, *dst;
+
 	op->status = RTE_COMP_OP_STATUS_SUCCESS;
 
 	/* Required due to init clearing level_buf */
@@ -463,8 +452,13 @@ process_isal_deflate(struct rte_comp_op *op, struct isal_comp_qp *qp,
 		return -1;
 	}
 
-	/* Chained mbufs */
-	if (op->m_src->nb_segs > 1 || op->m_dst->nb_segs > 1) {
+	src_offset = op->src.offset;
+	dst_offset = op->dst.offset;
+	src = mbuf_seg_at(op->m_src, &src_offset);
+	dst = mbuf_seg_at(op->m_dst, &dst_offset);
+
+	/* Chained mbufs, unless the data is within the segments at offset */
+	if (src_offset + op->src.length > src->data_len || dst->next != NULL) {
 		ret = chained_mbuf_compression(op, qp);
 		if (ret < 0)
 			return ret;
@@ -473,13 +467,13 @@ process_isal_deflate(struct rte_comp_op *op, struct isal_comp_qp *qp,
 		qp->stream->end_of_stream = 1; /* All input consumed in one */
 		/* Point compression stream to input buffer */
 		qp->stream->avail_in = op->src.length;
-		qp->stream->next_in = rte_pktmbuf_mtod_offset(op->m_src,
-				uint8_t *, op->src.offset);
+		qp->stream->next_in = rte_pktmbuf_mtod_offset(src,
+				uint8_t *, src_offset);
 
 		/*  Point compression stream to output buffer */
-		qp->stream->avail_out = op->m_dst->data_len - op->dst.offset;
-		qp->stream->next_out  = rte_pktmbuf_mtod_offset(op->m_dst,
-				uint8_t *, op->dst.offset);
+		qp->stream->avail_out = dst->data_len - dst_offset;
+		qp->stream->next_out  = rte_pktmbuf_mtod_offset(dst,
+				uint8_t *, dst_offset);
 
 		if (unlikely(!qp->stream->next_in || !qp->stream->next_out)) {
 			ISAL_PMD_LOG(ERR, "Invalid source or destination"
@@ -533,6 +527,8 @@ process_isal_inflate(struct rte_comp_op *op, struct isal_comp_qp *qp,
 		struct isal_priv_xform *priv_xform)
 {
 	int ret = 0;
+	uint32_t src_offset, dst_offset;
+	struct rte_mbuf *src, *dst;
 
 	op->status = RTE_COMP_OP_STATUS_SUCCESS;
 
@@ -555,22 +551,41 @@ process_isal_inflate(struct rte_comp_op *op, struct isal_comp_qp *qp,
 		return -1;
 	}
 
-	/* Chained mbufs */
-	if (op->m_src->nb_segs > 1 || op->m_dst->nb_segs > 1) {
-		ret = chained_mbuf_decompression(op, qp);
+	src_offset = op->src.offset;
+	dst_offset = op->dst.offset;
+	src = mbuf_seg_at(op->m_src, &src_offset);
+	dst = mbuf_seg_at(op->m_dst, &dst_offset);
+
+	/* Chained mbufs, unless the data is within the segments at offset */
+	if (src_offset + op->src.length > src->data_len || dst->next != NULL) {
+		ret = chained_mbuf_decompression(op, qp->state);
 		if (ret !=  0)
 			return ret;
+
+		if (qp->state->block_state != ISAL_BLOCK_FINISH) {
+			if (qp->state->avail_out == 0) {
+				ISAL_PMD_LOG(ERR, "Output buffer not big"
+						" enough\n");
+				op->status =
+				RTE_COMP_OP_STATUS_OUT_OF_SPACE_TERMINATED;
+			} else {
+				ISAL_PMD_LOG(ERR, "Input buffer does not hold"
+						" the whole stream\n");
+				op->status = RTE_COMP_OP_STATUS_ERROR;
+			}
+			return -1;
+		}
 	} else {
 		/* Linear buffer */
 		/* Point decompression state to input buffer */
 		qp->state->avail_in = op->src.length;
-		qp->state->next_in = rte_pktmbuf_mtod_offset(op->m_src,
-				uint8_t *, op->src.offset);
+		qp->state->next_in = rte_pktmbuf_mtod_offset(src,
+				uint8_t *, src_offset);
 
 		/* Point decompression state to output buffer */
-		qp->state->avail_out = op->m_dst->data_len - op->dst.offset;
-		qp->state->next_out  = rte_pktmbuf_mtod_offset(op->m_dst,
-				uint8_t *, op->dst.offset);
+		qp->state->avail_out = dst->data_len - dst_offset;
+		qp->state->next_out  = rte_pktmbuf_mtod_offset(dst,
+				uint8_t *, dst_offset);
 
 		if (unlikely(!qp->state->next_in || !qp->state->next_out)) {
 			ISAL_PMD_LOG(ERR, "Invalid source or destination"
@@ -602,13 +617,65 @@ process_isal_inflate(struct rte_comp_op *op, struct isal_comp_qp *qp,
 			return ret;
 		}
 		op->consumed = op->src.length - qp->state->avail_in;
+		op->produced = qp->state->total_out;
 	}
-	op->produced = qp->state->total_out;
 	op->output_chksum = qp->state->crc;
 
 	return ret;
 }
 
+/* Stateful Decompression Function */
+static int
+process_isal_inflate_stateful(struct rte_comp_op *op,
+		struct isal_comp_stream *stream)
+{
+	struct inflate_state *state = &stream->state;
+	int ret;
+
+	op->status = RTE_COMP_OP_STATUS_SUCCESS;
+
+	/* The stream restarts once its previous data is decompressed */
+	if (state->block_state == ISAL_BLOCK_FINISH) {
+		isal_inflate_init(state);
+		state->crc_flag = stream->xform.decompress.chksum;
+	}
+
+	if (op->m_src->pkt_len < (op->src.length + op->src.offset)) {
+		ISAL_PMD_LOG(ERR, "Input mbuf(s) not big enough.\n");
+		op->status = RTE_COMP_OP_STATUS_INVALID_ARGS;
+		return -1;
+	}
+
+	if (op->dst.offset >= op->m_dst->pkt_len) {
+		ISAL_PMD_LOG(ERR, "Output mbuf not big enough for "
+				"offset provided.\n");
+		op->status = RTE_COMP_OP_STATUS_INVALID_ARGS;
+		return -1;
+	}
+
+	ret = chained_mbuf_decompression(op, state);
+	if (ret != 0)
+		return ret;
+
+	if (state->block_state == ISAL_BLOCK_FINISH) {
+		op->output_chksum = state->crc;
+	} else if (state->avail_out == 0 && (op->consumed < op->src.length ||
+			op->flush_flag == RTE_COMP_FLUSH_FINAL)) {
+		/* Resumed with the remaining input and more output */
+		ISAL_PMD_LOG(DEBUG, "Decompression operation ran out of space,"
+				" %u bytes consumed\t%u bytes produced\n",
+				op->consumed, op->produced);
+		op->status = RTE_COMP_OP_STATUS_OUT_OF_SPACE_RECOVERABLE;
+	} else if (op->flush_flag == RTE_COMP_FLUSH_FINAL) {
+		ISAL_PMD_LOG(ERR, "Input of final op does not end the"
+				" stream\n");
+		op->status = RTE_COMP_OP_STATUS_ERROR;
+		return -1;
+	}
+
+	return 0;
+}
+
 /* Process compression/decompression operation */
 static int
 process_op(struct isal_comp_qp *qp, struct rte_comp_op *op,
@@ -628,7 +695,25 @@ process_op(struct isal_comp_qp *qp, struct rte_comp_op *op,
 	return 0;
 }
 
-/* Enqueue burst */
+/* Prefetch the start of the input and output data of an op */
+static inline void
+op_data_prefetch(struct rte_comp_op *op)
+{
+	if (op->src.offset < op->m_src->data_len)
+		rte_prefetch0(rte_pktmbuf_mtod_offset(op->m_src, void *,
+				op->src.offset));
+	if (op->dst.offset < op->m_dst->data_len)
+		rte_prefetch0(rte_pktmbuf_mtod_offset(op->m_dst, void *,
+				op->dst.offset));
+}
+
+/*
+ * Enqueue burst
+ *
+ * The ops of a burst are processed back to back on the queue pair stream and
+ * state, the mbufs of the following ops being prefetched meanwhile, which
+ * keeps small messages from stalling on their data.
+ */
 static uint16_t
 isal_comp_pmd_enqueue_burst(void *queue_pair, struct rte_comp_op **ops,
 			uint16_t nb_ops)
@@ -638,11 +723,26 @@ isal_comp_pmd_enqueue_burst(void *queue_pair, struct rte_comp_op **ops,
 	int retval;
 	int16_t num_enq = RTE_MIN(qp->num_free_elements, nb_ops);
 
+	for (i = 0; i < num_enq && i < 2; i++) {
+		rte_prefetch0(ops[i]->m_src);
+		rte_prefetch0(ops[i]->m_dst);
+	}
+	if (num_enq > 0)
+		op_data_prefetch(ops[0]);
+
 	for (i = 0; i < num_enq; i++) {
-		if (unlikely(ops[i]->op_type != RTE_COMP_OP_STATELESS)) {
-			ops[i]->status = RTE_COMP_OP_STATUS_INVALID_ARGS;
-			ISAL_PMD_LOG(ERR, "Stateful operation not Supported\n");
-			qp->qp_stats.enqueue_err_count++;
+		if (i + 2 < num_enq) {
+			rte_prefetch0(ops[i + 2]->m_src);
+			rte_prefetch0(ops[i + 2]->m_dst);
+		}
+		if (i + 1 < num_enq)
+			op_data_prefetch(ops[i + 1]);
+
+		if (ops[i]->op_type == RTE_COMP_OP_STATEFUL) {
+			retval = process_isal_inflate_stateful(ops[i],
+					ops[i]->stream);
+			if (unlikely(retval < 0))
+				qp->qp_stats.enqueue_err_count++;
 			continue;
 		}
 		retval = process_op(qp, ops[i], ops[i]->private_xform);
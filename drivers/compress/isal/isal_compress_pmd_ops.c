@@ -17,6 +17,7 @@ static const struct rte_compressdev_capabilities isal_pmd_capabilities[] = {
 					RTE_COMP_FF_OOP_SGL_IN_LB_OUT |
 					RTE_COMP_FF_OOP_LB_IN_SGL_OUT |
 					RTE_COMP_FF_SHAREABLE_PRIV_XFORM |
+					RTE_COMP_FF_STATEFUL_DECOMPRESSION |
 					RTE_COMP_FF_HUFFMAN_FIXED |
 					RTE_COMP_FF_HUFFMAN_DYNAMIC |
 					RTE_COMP_FF_CRC32_CHECKSUM |
@@ -354,6 +355,57 @@ isal_comp_pmd_priv_xform_free(struct rte_compressdev *dev, void *priv_xform)
 	return 0;
 }
 
+/** Create stream, only decompression is stateful */
+static int
+isal_comp_pmd_stream_create(struct rte_compressdev *dev,
+			const struct rte_comp_xform *xform, void **stream)
+{
+	struct isal_comp_stream *s;
+	int ret;
+
+	if (xform == NULL) {
+		ISAL_PMD_LOG(ERR, "Invalid Xform struct");
+		return -EINVAL;
+	}
+
+	if (xform->type != RTE_COMP_DECOMPRESS) {
+		ISAL_PMD_LOG(ERR, "Stateful compression not supported");
+		return -ENOTSUP;
+	}
+
+	s = rte_zmalloc_socket("Isa-l decompression stream", sizeof(*s),
+			RTE_CACHE_LINE_SIZE, dev->data->socket_id);
+	if (s == NULL) {
+		ISAL_PMD_LOG(ERR, "Failed to allocate stream memory");
+		return -ENOMEM;
+	}
+
+	ret = isal_comp_set_priv_xform_parameters(&s->xform, xform);
+	if (ret != 0) {
+		ISAL_PMD_LOG(ERR, "Failed to configure stream parameters");
+		rte_free(s);
+		return ret;
+	}
+
+	isal_inflate_init(&s->state);
+	s->state.crc_flag = s->xform.decompress.chksum;
+
+	*stream = s;
+	return 0;
+}
+
+/** Free stream */
+static int
+isal_comp_pmd_stream_free(__rte_unused struct rte_compressdev *dev,
+			void *stream)
+{
+	if (stream == NULL)
+		return -EINVAL;
+
+	rte_free(stream);
+	return 0;
+}
+
 struct rte_compressdev_ops isal_pmd_ops = {
 		.dev_configure		= isal_comp_pmd_config,
 		.dev_start		= isal_comp_pmd_start,
@@ -368,6 +420,9 @@ struct rte_compressdev_ops isal_pmd_ops = {
 		.queue_pair_setup	= isal_comp_pmd_qp_setup,
 		.queue_pair_release	= isal_comp_pmd_qp_release,
 
+		.stream_create		= isal_comp_pmd_stream_create,
+		.stream_free		= isal_comp_pmd_stream_free,
+
 		.private_xform_create	= isal_comp_pmd_priv_xform_create,
 		.private_xform_free	= isal_comp_pmd_priv_xform_free,
 };
@@ -46,6 +46,14 @@ struct isal_priv_xform {
 	uint32_t level_buffer_size;
 } __rte_cache_aligned;
 
+/** ISA-L stream structure, for stateful decompression */
+struct isal_comp_stream {
+	/* Decompression state, kept across the ops of the stream */
+	struct inflate_state state;
+	/* Stream parameters */
+	struct isal_priv_xform xform;
+} __rte_cache_aligned;
+
 /** Set and validate NULL comp private xform parameters */
 extern int
 isal_comp_set_priv_xform_parameters(struct isal_priv_xform *priv_xform,
@@ -0,0 +1,517 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_common.h>
+#include <rte_kvargs.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_pause.h>
+#include <rte_string_fns.h>
+
+#include "scheduler_pmd_private.h"
+
+#define SCHEDULER_VDEV_WORKER_DRIVER	("worker_driver")
+#define SCHEDULER_VDEV_CORELIST		("corelist")
+#define SCHEDULER_VDEV_SOCKET_ID	("socket_id")
+
+static const char * const scheduler_valid_params[] = {
+	SCHEDULER_VDEV_WORKER_DRIVER,
+	SCHEDULER_VDEV_CORELIST,
+	SCHEDULER_VDEV_SOCKET_ID,
+	NULL
+};
+
+struct scheduler_init_params {
+	struct rte_compressdev_pmd_init_params def_p;
+	char worker_driver[RTE_COMPRESSDEV_NAME_MAX_LEN];
+	unsigned int lcores[SCHEDULER_MAX_NB_WORKERS];
+	uint16_t nb_lcores;
+};
+
+/*
+ * Split the burst in one chunk per worker, from the worker following the
+ * last one used, so that small bursts are spread over the workers as well.
+ */
+static uint16_t
+scheduler_enqueue_burst(void *queue_pair, struct rte_comp_op **ops,
+		uint16_t nb_ops)
+{
+	struct scheduler_qp *qp = queue_pair;
+	struct scheduler_priv_xform *priv_xform;
+	struct scheduler_op_entry *entry;
+	uint32_t head = qp->head;
+	uint32_t tail = __atomic_load_n(&qp->tail, __ATOMIC_ACQUIRE);
+	uint16_t nb_enq = 0, chunk, n, i, j, w;
+
+	nb_ops = RTE_MIN(nb_ops, qp->mask + 1 - (head - tail));
+
+	/* Stop the burst at the first op without a private xform, streams
+	 * are not supported
+	 */
+	for (i = 0; i < nb_ops; i++)
+		if (unlikely(ops[i]->op_type != RTE_COMP_OP_STATELESS ||
+				ops[i]->private_xform == NULL)) {
+			ops[i]->status = RTE_COMP_OP_STATUS_INVALID_ARGS;
+			nb_ops = i;
+			break;
+		}
+	if (nb_ops == 0)
+		return 0;
+
+	chunk = (nb_ops + qp->nb_workers - 1) / qp->nb_workers;
+
+	while (nb_enq < nb_ops) {
+		w = qp->next_worker;
+		n = RTE_MIN(chunk, nb_ops - nb_enq);
+
+		for (j = nb_enq; j < nb_enq + n; j++) {
+			entry = &qp->entries[(head + j) & qp->mask];
+			priv_xform = ops[j]->private_xform;
+			entry->priv_xform = priv_xform;
+			entry->worker = w;
+			ops[j]->private_xform = priv_xform->worker_xforms[w];
+		}
+
+		i = rte_ring_enqueue_burst(qp->workers[w].req_ring,
+				(void **)&ops[nb_enq], n, NULL);
+
+		/* Restore the private xform of the ops refused */
+		for (j = nb_enq + i; j < nb_enq + n; j++)
+			ops[j]->private_xform =
+				qp->entries[(head + j) & qp->mask].priv_xform;
+
+		nb_enq += i;
+		if (i < n)
+			break;
+
+		qp->next_worker = w + 1 == qp->nb_workers ? 0 : w + 1;
+	}
+
+	__atomic_store_n(&qp->head, head + nb_enq, __ATOMIC_RELEASE);
+	qp->qp_stats.enqueued_count += nb_enq;
+
+	return nb_enq;
+}
+
+/*
+ * Take the ops in the order they were enqueued, by runs of ops of the same
+ * worker, until the worker of the oldest op has not completed it.
+ */
+static uint16_t
+scheduler_dequeue_burst(void *queue_pair, struct rte_comp_op **ops,
+		uint16_t nb_ops)
+{
+	struct scheduler_qp *qp = queue_pair;
+	uint32_t head = __atomic_load_n(&qp->head, __ATOMIC_ACQUIRE);
+	uint32_t tail = qp->tail;
+	uint16_t nb_deq = 0, n, i, j, w;
+
+	while (nb_deq < nb_ops && tail != head) {
+		w = qp->entries[tail & qp->mask].worker;
+		for (n = 1; nb_deq + n < nb_ops && tail + n != head; n++)
+			if (qp->entries[(tail + n) & qp->mask].worker != w)
+				break;
+
+		i = rte_ring_dequeue_burst(qp->workers[w].cpl_ring,
+				(void **)&ops[nb_deq], n, NULL);
+
+		for (j = 0; j < i; j++)
+			ops[nb_deq + j]->private_xform =
+				qp->entries[(tail + j) & qp->mask].priv_xform;
+
+		nb_deq += i;
+		tail += i;
+		if (i < n)
+			break;
+	}
+
+	__atomic_store_n(&qp->tail, tail, __ATOMIC_RELEASE);
+	qp->qp_stats.dequeued_count += nb_deq;
+
+	return nb_deq;
+}
+
+/*
+ * Move the ops of a queue pair between its rings and the worker device,
+ * return the number of ops moved.
+ */
+static uint16_t
+scheduler_worker_poll(struct scheduler_worker_qp *wqp, uint8_t dev_id,
+		uint16_t qp_id)
+{
+	uint16_t n, nb_moved = 0;
+
+	if (wqp->nb_enq_pending == 0) {
+		wqp->enq_idx = 0;
+		wqp->nb_enq_pending = rte_ring_dequeue_burst(wqp->req_ring,
+				(void **)wqp->enq_ops, SCHEDULER_BURST_SIZE,
+				NULL);
+	}
+	if (wqp->nb_enq_pending != 0) {
+		n = rte_compressdev_enqueue_burst(dev_id, qp_id,
+				&wqp->enq_ops[wqp->enq_idx],
+				wqp->nb_enq_pending);
+		wqp->enq_idx += n;
+		wqp->nb_enq_pending -= n;
+		nb_moved += n;
+	}
+
+	if (wqp->nb_deq_pending == 0) {
+		wqp->deq_idx = 0;
+		wqp->nb_deq_pending = rte_compressdev_dequeue_burst(dev_id,
+				qp_id, wqp->deq_ops, SCHEDULER_BURST_SIZE);
+	}
+	if (wqp->nb_deq_pending != 0) {
+		n = rte_ring_enqueue_burst(wqp->cpl_ring,
+				(void **)&wqp->deq_ops[wqp->deq_idx],
+				wqp->nb_deq_pending, NULL);
+		wqp->deq_idx += n;
+		wqp->nb_deq_pending -= n;
+		nb_moved += n;
+	}
+
+	return nb_moved;
+}
+
+int
+comp_scheduler_worker_run(void *arg)
+{
+	struct scheduler_worker *worker = arg;
+	struct rte_compressdev *dev = worker->dev;
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	struct scheduler_qp *qp;
+	uint16_t qp_id;
+	uint32_t nb_moved;
+
+	while (!ctx->stop) {
+		nb_moved = 0;
+		for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+			qp = dev->data->queue_pairs[qp_id];
+			if (qp == NULL)
+				continue;
+			nb_moved += scheduler_worker_poll(
+					&qp->workers[worker->idx],
+					worker->dev_id, qp_id);
+		}
+		if (nb_moved == 0)
+			rte_pause();
+	}
+
+	return 0;
+}
+
+/*
+ * Common capabilities of the worker devices, which are instances of the same
+ * driver, stateful operations aside: a stream would be bound to a worker.
+ */
+static int
+scheduler_capabilities_init(struct scheduler_ctx *ctx)
+{
+	const struct rte_compressdev_capabilities *capa;
+	struct rte_compressdev_info info;
+	uint16_t i, n;
+
+	rte_compressdev_info_get(ctx->workers[0].dev_id, &info);
+
+	for (n = 0; info.capabilities[n].algo != RTE_COMP_ALGO_UNSPECIFIED;
+			n++)
+		;
+
+	ctx->capabilities = rte_zmalloc(NULL,
+			sizeof(*ctx->capabilities) * (n + 1), 0);
+	if (ctx->capabilities == NULL)
+		return -ENOMEM;
+
+	for (i = 0, capa = info.capabilities; i < n; i++, capa++) {
+		ctx->capabilities[i] = *capa;
+		ctx->capabilities[i].comp_feature_flags &=
+			~(RTE_COMP_FF_STATEFUL_COMPRESSION |
+			RTE_COMP_FF_STATEFUL_DECOMPRESSION);
+	}
+
+	ctx->feature_flags = info.feature_flags;
+	ctx->max_nb_queue_pairs = info.max_nb_queue_pairs;
+
+	return 0;
+}
+
+static void
+scheduler_workers_destroy(const uint8_t *dev_ids, uint16_t nb_workers)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_workers; i++)
+		rte_vdev_uninit(rte_compressdev_name_get(dev_ids[i]));
+}
+
+/* Create a worker device of the worker driver per worker lcore */
+static int
+scheduler_workers_create(struct rte_compressdev *dev,
+		struct scheduler_init_params *params)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	char name[RTE_COMPRESSDEV_NAME_MAX_LEN];
+	uint8_t dev_ids[SCHEDULER_MAX_NB_WORKERS];
+	char args[32];
+	uint16_t i;
+	int dev_id;
+
+	snprintf(args, sizeof(args), "socket_id=%d", params->def_p.socket_id);
+
+	for (i = 0; i < params->nb_lcores; i++) {
+		if (snprintf(name, sizeof(name), "%s_%s_%u",
+				params->worker_driver, dev->data->name, i) >=
+				(int)sizeof(name)) {
+			COMP_SCHED_LOG(ERR, "Worker device name too long");
+			goto error;
+		}
+
+		if (rte_vdev_init(name, args) != 0) {
+			COMP_SCHED_LOG(ERR, "Cannot create worker device %s",
+				name);
+			goto error;
+		}
+
+		dev_id = rte_compressdev_get_dev_id(name);
+		if (dev_id < 0) {
+			rte_vdev_uninit(name);
+			goto error;
+		}
+
+		ctx->workers[i].dev_id = dev_id;
+		ctx->workers[i].idx = i;
+		ctx->workers[i].lcore_id = params->lcores[i];
+		ctx->workers[i].dev = dev;
+		ctx->nb_workers++;
+
+		COMP_SCHED_LOG(INFO, "Worker device %s on lcore %u", name,
+			params->lcores[i]);
+	}
+
+	if (scheduler_capabilities_init(ctx) != 0)
+		goto error;
+
+	return 0;
+
+error:
+	for (i = 0; i < ctx->nb_workers; i++)
+		dev_ids[i] = ctx->workers[i].dev_id;
+	scheduler_workers_destroy(dev_ids, ctx->nb_workers);
+	ctx->nb_workers = 0;
+	return -EINVAL;
+}
+
+static int
+scheduler_create(const char *name, struct rte_vdev_device *vdev,
+		struct scheduler_init_params *params)
+{
+	struct rte_compressdev *dev;
+	int ret;
+
+	dev = rte_compressdev_pmd_create(name, &vdev->device,
+			sizeof(struct scheduler_ctx), &params->def_p);
+	if (dev == NULL) {
+		COMP_SCHED_LOG(ERR, "driver %s: create failed", name);
+		return -ENODEV;
+	}
+
+	dev->dev_ops = comp_scheduler_pmd_ops;
+
+	/* register rx/tx burst functions for data path */
+	dev->dequeue_burst = scheduler_dequeue_burst;
+	dev->enqueue_burst = scheduler_enqueue_burst;
+
+	ret = scheduler_workers_create(dev, params);
+	if (ret != 0) {
+		rte_compressdev_pmd_destroy(dev);
+		return ret;
+	}
+
+	return 0;
+}
+
+/** Parse the lcores of the workers, separated with ':' */
+static int
+parse_corelist_arg(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	struct scheduler_init_params *params = extra_args;
+	const char *token = value;
+	unsigned long core;
+	char *end;
+
+	params->nb_lcores = 0;
+
+	while (isdigit(token[0])) {
+		core = strtoul(token, &end, 10);
+		if (core >= RTE_MAX_LCORE || !rte_lcore_is_enabled(core) ||
+				core == rte_get_main_lcore()) {
+			COMP_SCHED_LOG(ERR, "Invalid worker lcore %lu", core);
+			return -EINVAL;
+		}
+		if (params->nb_lcores == SCHEDULER_MAX_NB_WORKERS) {
+			COMP_SCHED_LOG(ERR, "Too many worker lcores");
+			return -EINVAL;
+		}
+		params->lcores[params->nb_lcores++] = core;
+
+		token = end;
+		if (token[0] == '\0')
+			break;
+		token++;
+	}
+
+	return 0;
+}
+
+static int
+parse_worker_driver_arg(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	struct scheduler_init_params *params = extra_args;
+
+	if (strlcpy(params->worker_driver, value,
+			sizeof(params->worker_driver)) >=
+			sizeof(params->worker_driver)) {
+		COMP_SCHED_LOG(ERR, "Invalid worker driver %s", value);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+parse_socket_id_arg(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	int *socket_id = extra_args;
+	char *end;
+	long v;
+
+	errno = 0;
+	v = strtol(value, &end, 10);
+	if (errno != 0 || end == value || end[0] != '\0' || v < 0 ||
+			v >= RTE_MAX_NUMA_NODES) {
+		COMP_SCHED_LOG(ERR, "Invalid socket id %s", value);
+		return -EINVAL;
+	}
+	*socket_id = v;
+
+	return 0;
+}
+
+static int
+scheduler_parse_init_params(struct scheduler_init_params *params,
+		const char *input_args)
+{
+	struct rte_kvargs *kvlist;
+	int ret;
+
+	if (input_args == NULL)
+		return -EINVAL;
+
+	kvlist = rte_kvargs_parse(input_args, scheduler_valid_params);
+	if (kvlist == NULL)
+		return -EINVAL;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_VDEV_WORKER_DRIVER,
+			&parse_worker_driver_arg, params);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_VDEV_CORELIST,
+			&parse_corelist_arg, params);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_VDEV_SOCKET_ID,
+			&parse_socket_id_arg, &params->def_p.socket_id);
+
+free_kvlist:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int
+scheduler_probe(struct rte_vdev_device *vdev)
+{
+	struct scheduler_init_params params = {
+		.def_p = {
+			"",
+			rte_socket_id()
+		},
+	};
+	const char *name, *input_args;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -EINVAL;
+
+	input_args = rte_vdev_device_args(vdev);
+
+	if (scheduler_parse_init_params(&params, input_args) < 0) {
+		COMP_SCHED_LOG(ERR,
+			"Failed to parse initialisation arguments[%s]",
+			input_args);
+		return -EINVAL;
+	}
+
+	if (params.worker_driver[0] == '\0' || params.nb_lcores == 0) {
+		COMP_SCHED_LOG(ERR, "A worker driver and lcores are needed");
+		return -EINVAL;
+	}
+
+	return scheduler_create(name, vdev, &params);
+}
+
+static int
+scheduler_remove(struct rte_vdev_device *vdev)
+{
+	uint8_t dev_ids[SCHEDULER_MAX_NB_WORKERS];
+	struct rte_compressdev *dev;
+	struct scheduler_ctx *ctx;
+	uint16_t i, nb_workers;
+	const char *name;
+	int ret;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -EINVAL;
+
+	dev = rte_compressdev_pmd_get_named_dev(name);
+	if (dev == NULL)
+		return -ENODEV;
+
+	ctx = dev->data->dev_private;
+	nb_workers = ctx->nb_workers;
+	for (i = 0; i < nb_workers; i++)
+		dev_ids[i] = ctx->workers[i].dev_id;
+	rte_free(ctx->capabilities);
+	ctx->capabilities = NULL;
+
+	/* Closing the scheduler device closes the worker devices */
+	ret = rte_compressdev_pmd_destroy(dev);
+	if (ret != 0)
+		return ret;
+
+	scheduler_workers_destroy(dev_ids, nb_workers);
+	return 0;
+}
+
+static struct rte_vdev_driver scheduler_pmd_drv = {
+	.probe = scheduler_probe,
+	.remove = scheduler_remove
+};
+
+RTE_PMD_REGISTER_VDEV(COMPRESSDEV_NAME_SCHEDULER_PMD, scheduler_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(COMPRESSDEV_NAME_SCHEDULER_PMD,
+	"worker_driver=<name> "
+	"corelist=<lcore>[:<lcore>...] "
+	"socket_id=<int>");
+RTE_LOG_REGISTER_DEFAULT(comp_scheduler_logtype_driver, INFO);
@@ -0,0 +1,353 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_malloc.h>
+
+#include "scheduler_pmd_private.h"
+
+/** Configure device, and the worker devices alike */
+static int
+scheduler_pmd_config(struct rte_compressdev *dev,
+		struct rte_compressdev_config *config)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		ret = rte_compressdev_configure(ctx->workers[i].dev_id, config);
+		if (ret < 0) {
+			COMP_SCHED_LOG(ERR, "Failed to configure worker %u",
+				ctx->workers[i].dev_id);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/** Stop the worker lcores, then the worker devices */
+static void
+scheduler_pmd_stop(struct rte_compressdev *dev)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	uint16_t i;
+
+	ctx->stop = 1;
+	for (i = 0; i < ctx->nb_workers; i++)
+		rte_eal_wait_lcore(ctx->workers[i].lcore_id);
+
+	for (i = 0; i < ctx->nb_workers; i++)
+		rte_compressdev_stop(ctx->workers[i].dev_id);
+}
+
+/** Start the worker devices, then the worker lcores */
+static int
+scheduler_pmd_start(struct rte_compressdev *dev)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		ret = rte_compressdev_start(ctx->workers[i].dev_id);
+		if (ret < 0) {
+			COMP_SCHED_LOG(ERR, "Failed to start worker %u",
+				ctx->workers[i].dev_id);
+			goto error;
+		}
+	}
+
+	ctx->stop = 0;
+	for (i = 0; i < ctx->nb_workers; i++) {
+		ret = rte_eal_remote_launch(comp_scheduler_worker_run,
+				&ctx->workers[i], ctx->workers[i].lcore_id);
+		if (ret < 0) {
+			COMP_SCHED_LOG(ERR, "Failed to launch worker lcore %u",
+				ctx->workers[i].lcore_id);
+			goto error;
+		}
+	}
+
+	return 0;
+
+error:
+	scheduler_pmd_stop(dev);
+	return ret;
+}
+
+/** Close device, and the worker devices */
+static int
+scheduler_pmd_close(struct rte_compressdev *dev)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		ret = rte_compressdev_close(ctx->workers[i].dev_id);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/** Get device statistics, with the errors of the worker devices */
+static void
+scheduler_pmd_stats_get(struct rte_compressdev *dev,
+		struct rte_compressdev_stats *stats)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	struct rte_compressdev_stats worker_stats;
+	uint16_t qp_id, i;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct scheduler_qp *qp = dev->data->queue_pairs[qp_id];
+
+		stats->enqueued_count += qp->qp_stats.enqueued_count;
+		stats->dequeued_count += qp->qp_stats.dequeued_count;
+	}
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		if (rte_compressdev_stats_get(ctx->workers[i].dev_id,
+				&worker_stats) != 0)
+			continue;
+		stats->enqueue_err_count += worker_stats.enqueue_err_count;
+		stats->dequeue_err_count += worker_stats.dequeue_err_count;
+	}
+}
+
+/** Reset device statistics */
+static void
+scheduler_pmd_stats_reset(struct rte_compressdev *dev)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	uint16_t qp_id, i;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct scheduler_qp *qp = dev->data->queue_pairs[qp_id];
+
+		memset(&qp->qp_stats, 0, sizeof(qp->qp_stats));
+	}
+
+	for (i = 0; i < ctx->nb_workers; i++)
+		rte_compressdev_stats_reset(ctx->workers[i].dev_id);
+}
+
+/** Get device info */
+static void
+scheduler_pmd_info_get(struct rte_compressdev *dev,
+		struct rte_compressdev_info *dev_info)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+
+	if (dev_info != NULL) {
+		dev_info->capabilities = ctx->capabilities;
+		dev_info->feature_flags = ctx->feature_flags;
+		dev_info->max_nb_queue_pairs = ctx->max_nb_queue_pairs;
+	}
+}
+
+/** Release queue pair */
+static int
+scheduler_pmd_qp_release(struct rte_compressdev *dev, uint16_t qp_id)
+{
+	struct scheduler_qp *qp = dev->data->queue_pairs[qp_id];
+	uint16_t i;
+
+	if (qp == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < qp->nb_workers; i++) {
+		rte_ring_free(qp->workers[i].req_ring);
+		rte_ring_free(qp->workers[i].cpl_ring);
+	}
+	rte_free(qp->entries);
+	rte_free(qp);
+	dev->data->queue_pairs[qp_id] = NULL;
+
+	return 0;
+}
+
+/* Create the request or completion ring of a worker lcore */
+static struct rte_ring *
+scheduler_pmd_qp_create_ring(struct rte_compressdev *dev, uint16_t qp_id,
+		uint16_t worker, const char *type, uint32_t size,
+		int socket_id)
+{
+	char name[RTE_RING_NAMESIZE];
+
+	if (snprintf(name, sizeof(name), "comp_sched_%u_%u_%u_%s",
+			dev->data->dev_id, qp_id, worker, type) >=
+			(int)sizeof(name))
+		return NULL;
+
+	return rte_ring_create(name, size, socket_id,
+			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+}
+
+/*
+ * Setup a queue pair, and the queue pairs of the same id of the worker
+ * devices. Since the queue pair holds at most the FIFO size of ops in flight,
+ * the rings of the worker lcores and the worker queue pairs cannot overflow.
+ */
+static int
+scheduler_pmd_qp_setup(struct rte_compressdev *dev, uint16_t qp_id,
+		uint32_t max_inflight_ops, int socket_id)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	struct scheduler_worker_qp *wqp;
+	struct scheduler_qp *qp;
+	uint32_t nb_entries;
+	uint16_t i;
+	int ret;
+
+	/* Free memory prior to re-allocation if needed. */
+	if (dev->data->queue_pairs[qp_id] != NULL)
+		scheduler_pmd_qp_release(dev, qp_id);
+
+	nb_entries = rte_align32pow2(max_inflight_ops);
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		ret = rte_compressdev_queue_pair_setup(ctx->workers[i].dev_id,
+				qp_id, nb_entries, socket_id);
+		if (ret < 0) {
+			COMP_SCHED_LOG(ERR, "Failed to setup worker %u qp %u",
+				ctx->workers[i].dev_id, qp_id);
+			return ret;
+		}
+	}
+
+	qp = rte_zmalloc_socket("Scheduler compression PMD Queue Pair",
+			sizeof(*qp), RTE_CACHE_LINE_SIZE, socket_id);
+	if (qp == NULL) {
+		COMP_SCHED_LOG(ERR, "Failed to allocate queue pair memory");
+		return -ENOMEM;
+	}
+
+	qp->entries = rte_zmalloc_socket("Scheduler compression PMD FIFO",
+			sizeof(*qp->entries) * nb_entries, RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (qp->entries == NULL) {
+		COMP_SCHED_LOG(ERR, "Failed to allocate queue pair FIFO");
+		goto qp_setup_cleanup;
+	}
+	qp->mask = nb_entries - 1;
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		wqp = &qp->workers[i];
+		wqp->req_ring = scheduler_pmd_qp_create_ring(dev, qp_id, i,
+				"req", nb_entries, socket_id);
+		wqp->cpl_ring = scheduler_pmd_qp_create_ring(dev, qp_id, i,
+				"cpl", nb_entries, socket_id);
+		qp->nb_workers++;
+		if (wqp->req_ring == NULL || wqp->cpl_ring == NULL) {
+			COMP_SCHED_LOG(ERR, "Failed to create worker rings");
+			goto qp_setup_cleanup;
+		}
+	}
+
+	dev->data->queue_pairs[qp_id] = qp;
+	return 0;
+
+qp_setup_cleanup:
+	for (i = 0; i < qp->nb_workers; i++) {
+		rte_ring_free(qp->workers[i].req_ring);
+		rte_ring_free(qp->workers[i].cpl_ring);
+	}
+	rte_free(qp->entries);
+	rte_free(qp);
+
+	return -ENOMEM;
+}
+
+/** Free private xform, and the private xforms of the worker devices */
+static int
+scheduler_pmd_priv_xform_free(struct rte_compressdev *dev, void *priv_xform)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	struct scheduler_priv_xform *xform = priv_xform;
+	uint16_t i;
+
+	if (xform == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < ctx->nb_workers; i++)
+		if (xform->worker_xforms[i] != NULL)
+			rte_compressdev_private_xform_free(
+					ctx->workers[i].dev_id,
+					xform->worker_xforms[i]);
+
+	rte_free(xform);
+	return 0;
+}
+
+/** Create private xform, as a private xform per worker device */
+static int
+scheduler_pmd_priv_xform_create(struct rte_compressdev *dev,
+		const struct rte_comp_xform *xform, void **priv_xform)
+{
+	struct scheduler_ctx *ctx = dev->data->dev_private;
+	struct scheduler_priv_xform *sched_xform;
+	uint16_t i;
+	int ret;
+
+	if (xform == NULL) {
+		COMP_SCHED_LOG(ERR, "Invalid Xform struct");
+		return -EINVAL;
+	}
+
+	sched_xform = rte_zmalloc_socket("Scheduler compression PMD xform",
+			sizeof(*sched_xform), 0, dev->data->socket_id);
+	if (sched_xform == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < ctx->nb_workers; i++) {
+		ret = rte_compressdev_private_xform_create(
+				ctx->workers[i].dev_id, xform,
+				&sched_xform->worker_xforms[i]);
+		if (ret < 0) {
+			scheduler_pmd_priv_xform_free(dev, sched_xform);
+			return ret;
+		}
+	}
+
+	*priv_xform = sched_xform;
+	return 0;
+}
+
+/** Streams would be bound to a worker device, they are not supported */
+static int
+scheduler_pmd_stream_create(struct rte_compressdev *dev __rte_unused,
+		const struct rte_comp_xform *xform __rte_unused,
+		void **stream __rte_unused)
+{
+	return -ENOTSUP;
+}
+
+static struct rte_compressdev_ops scheduler_pmd_ops = {
+		.dev_configure		= scheduler_pmd_config,
+		.dev_start		= scheduler_pmd_start,
+		.dev_stop		= scheduler_pmd_stop,
+		.dev_close		= scheduler_pmd_close,
+
+		.stats_get		= scheduler_pmd_stats_get,
+		.stats_reset		= scheduler_pmd_stats_reset,
+
+		.dev_infos_get		= scheduler_pmd_info_get,
+
+		.queue_pair_setup	= scheduler_pmd_qp_setup,
+		.queue_pair_release	= scheduler_pmd_qp_release,
+
+		.stream_create		= scheduler_pmd_stream_create,
+
+		.private_xform_create	= scheduler_pmd_priv_xform_create,
+		.private_xform_free	= scheduler_pmd_priv_xform_free,
+};
+
+struct rte_compressdev_ops *comp_scheduler_pmd_ops = &scheduler_pmd_ops;
@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef _SCHEDULER_PMD_PRIVATE_H_
+#define _SCHEDULER_PMD_PRIVATE_H_
+
+#include <rte_compressdev.h>
+#include <rte_compressdev_pmd.h>
+#include <rte_ring.h>
+
+#define COMPRESSDEV_NAME_SCHEDULER_PMD	compress_scheduler
+/**< Scheduler compress PMD device name */
+
+#define SCHEDULER_MAX_NB_WORKERS	16
+/**< Maximum number of worker devices, one per worker lcore */
+#define SCHEDULER_BURST_SIZE		32
+/**< Operations moved at once by a worker lcore */
+
+extern int comp_scheduler_logtype_driver;
+#define COMP_SCHED_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, comp_scheduler_logtype_driver, "%s(): "fmt "\n", \
+			__func__, ##args)
+
+/*
+ * The scheduler distributes the operations of its queue pairs to worker
+ * devices, each polled by a worker lcore with the queue pairs of the same id.
+ * An operation is passed through a request ring to the worker lcore, which
+ * enqueues it to the worker device, then returns it through a completion ring
+ * once dequeued from the device.
+ *
+ * The worker and the private xform of the operations enqueued are kept in a
+ * FIFO, in order: the dequeue takes the operations from the completion ring of
+ * the worker of the oldest one, which keeps them in order since the worker
+ * devices complete operations in order.
+ */
+
+/** Worker device and lcore */
+struct scheduler_worker {
+	uint8_t dev_id;
+	/**< Worker device id */
+	uint16_t idx;
+	/**< Index of the worker */
+	unsigned int lcore_id;
+	/**< Lcore polling the worker device */
+	struct rte_compressdev *dev;
+	/**< Scheduler device */
+};
+
+/** Private data of a scheduler device */
+struct scheduler_ctx {
+	struct scheduler_worker workers[SCHEDULER_MAX_NB_WORKERS];
+	/**< Worker devices and lcores */
+	uint16_t nb_workers;
+	/**< Number of workers */
+	uint64_t feature_flags;
+	/**< Feature flags common to the worker devices */
+	uint16_t max_nb_queue_pairs;
+	/**< Maximum queue pairs of the worker devices, 0 if unlimited */
+	struct rte_compressdev_capabilities *capabilities;
+	/**< Capabilities of the worker devices, without stateful operations */
+	volatile uint32_t stop;
+	/**< Stops the worker lcores */
+};
+
+/** Queue pair of a worker lcore */
+struct scheduler_worker_qp {
+	struct rte_ring *req_ring;
+	/**< Operations to enqueue to the worker device */
+	struct rte_ring *cpl_ring;
+	/**< Operations dequeued from the worker device */
+	struct rte_comp_op *enq_ops[SCHEDULER_BURST_SIZE];
+	/**< Operations not yet accepted by the worker device */
+	struct rte_comp_op *deq_ops[SCHEDULER_BURST_SIZE];
+	/**< Operations not yet pushed to the completion ring */
+	uint16_t nb_enq_pending;
+	uint16_t enq_idx;
+	uint16_t nb_deq_pending;
+	uint16_t deq_idx;
+} __rte_cache_aligned;
+
+/** Worker and private xform of an operation in flight */
+struct scheduler_op_entry {
+	void *priv_xform;
+	/**< Scheduler private xform */
+	uint16_t worker;
+	/**< Worker processing the operation */
+};
+
+/** Scheduler queue pair */
+struct scheduler_qp {
+	struct scheduler_op_entry *entries;
+	/**< FIFO of the operations in flight */
+	uint32_t mask;
+	/**< Number of FIFO entries - 1 */
+	uint32_t head;
+	/**< Sequence number of the next operation enqueued */
+	uint32_t tail;
+	/**< Sequence number of the next operation dequeued */
+	uint16_t nb_workers;
+	/**< Number of workers */
+	uint16_t next_worker;
+	/**< Worker of the next operations enqueued */
+	struct rte_compressdev_stats qp_stats;
+	/**< Queue pair statistics */
+	struct scheduler_worker_qp workers[SCHEDULER_MAX_NB_WORKERS];
+	/**< Rings and pending operations of the worker lcores */
+} __rte_cache_aligned;
+
+/** Scheduler private xform, one private xform per worker device */
+struct scheduler_priv_xform {
+	void *worker_xforms[SCHEDULER_MAX_NB_WORKERS];
+};
+
+/** Poll the worker device of a worker lcore until the device is stopped */
+int
+comp_scheduler_worker_run(void *arg);
+
+/** device specific operations function pointer structure */
+extern struct rte_compressdev_ops *comp_scheduler_pmd_ops;
+
+#endif /* _SCHEDULER_PMD_PRIVATE_H_ */
@@ -1867,6 +1867,112 @@ aesni_mb_process_bulk(struct rte_cryptodev *dev,
 	return k;
 }
 
+/* Check or update the digests, each with the parameters of its session */
+static inline uint32_t
+finish_sync_dgst_multi(struct rte_crypto_sym_vec *vec,
+	struct aesni_mb_session *s[], const uint8_t dgst[][DIGEST_LENGTH_MAX])
+{
+	uint32_t i, k;
+
+	for (i = 0, k = 0; i != vec->num; i++) {
+		if (vec->status[i] != 0)
+			continue;
+		if (s[i]->auth.operation == RTE_CRYPTO_AUTH_OP_VERIFY) {
+			if (memcmp(vec->digest[i].va, dgst[i],
+					s[i]->auth.req_digest_len) != 0) {
+				vec->status[i] = EBADMSG;
+				continue;
+			}
+		} else {
+			memcpy(vec->digest[i].va, dgst[i],
+				s[i]->auth.req_digest_len);
+		}
+		k++;
+	}
+
+	return k;
+}
+
+/*
+ * Same as aesni_mb_process_bulk(), with the jobs of all the sessions
+ * submitted to the same multi-buffer manager, which fills its lanes with
+ * the jobs of different sessions.
+ */
+static uint32_t
+aesni_mb_process_bulk_multi(struct rte_cryptodev *dev,
+	struct rte_cryptodev_sym_session *sess[],
+	const union rte_crypto_sym_ofs ofs[], struct rte_crypto_sym_vec *vec)
+{
+	int32_t ret;
+	uint32_t i, j, k, len;
+	void *buf;
+	IMB_JOB *job;
+	IMB_MGR *mb_mgr;
+	struct rte_cryptodev_sym_session *last;
+	struct aesni_mb_session *ls;
+	struct aesni_mb_session *s[vec->num];
+	uint8_t tmp_dgst[vec->num][DIGEST_LENGTH_MAX];
+
+	/* get per-thread MB MGR, create one if needed */
+	mb_mgr = get_per_thread_mb_mgr();
+	if (unlikely(mb_mgr == NULL)) {
+		ipsec_mb_fill_error_code(vec, ENOMEM);
+		return 0;
+	}
+
+	last = NULL;
+	ls = NULL;
+	for (i = 0, j = 0, k = 0; i != vec->num; i++) {
+		/* operations of a session are usually contiguous */
+		if (sess[i] != last) {
+			last = sess[i];
+			ls = get_sym_session_private_data(last,
+				dev->driver_id);
+		}
+		s[i] = ls;
+		if (ls == NULL) {
+			vec->status[i] = EINVAL;
+			continue;
+		}
+
+		ret = check_crypto_sgl(ofs[i], vec->src_sgl + i);
+		if (ret != 0) {
+			vec->status[i] = ret;
+			continue;
+		}
+
+		buf = vec->src_sgl[i].vec[0].base;
+		len = vec->src_sgl[i].vec[0].len;
+
+		job = IMB_GET_NEXT_JOB(mb_mgr);
+		if (job == NULL) {
+			k += flush_mb_sync_mgr(mb_mgr);
+			job = IMB_GET_NEXT_JOB(mb_mgr);
+			RTE_ASSERT(job != NULL);
+		}
+
+		/* Submit job for processing */
+		set_cpu_mb_job_params(job, ls, ofs[i], buf, len, &vec->iv[i],
+			&vec->aad[i], tmp_dgst[i], &vec->status[i]);
+		job = submit_sync_job(mb_mgr);
+		j++;
+
+		/* handle completed jobs */
+		k += handle_completed_sync_jobs(job, mb_mgr);
+	}
+
+	/* flush remaining jobs */
+	while (k != j)
+		k += flush_mb_sync_mgr(mb_mgr);
+
+	/* finish processing for successful jobs: check/update digest */
+	if (k != 0)
+		k = finish_sync_dgst_multi(vec, s,
+			(const uint8_t (*)[DIGEST_LENGTH_MAX])tmp_dgst);
+
+	return k;
+}
+
 struct rte_cryptodev_ops aesni_mb_pmd_ops = {
 	.dev_configure = ipsec_mb_config,
 	.dev_start = ipsec_mb_start,
@@ -1882,6 +1988,7 @@ struct rte_cryptodev_ops aesni_mb_pmd_ops = {
 	.queue_pair_release = ipsec_mb_qp_release,
 
 	.sym_cpu_process = aesni_mb_process_bulk,
+	.sym_cpu_process_multi = aesni_mb_process_bulk_multi,
 
 	.sym_session_get_size = ipsec_mb_sym_session_get_size,
 	.sym_session_configure = ipsec_mb_sym_session_configure,
@@ -576,5 +576,59 @@ rte_cryptodev_scheduler_option_get(uint8_t scheduler_id,
 	return (*sched_ctx->ops.option_get)(dev, option_type, option);
 }
 
+static struct rte_cryptodev *
+scheduler_mc_dev_get(uint8_t scheduler_id)
+{
+	struct rte_cryptodev *dev = rte_cryptodev_pmd_get_dev(scheduler_id);
+	struct scheduler_ctx *sched_ctx;
+
+	if (!dev || dev->driver_id != cryptodev_scheduler_driver_id)
+		return NULL;
+
+	sched_ctx = dev->data->dev_private;
+	if (sched_ctx->mode != CDEV_SCHED_MODE_MULTICORE)
+		return NULL;
+
+	return dev;
+}
+
+int
+rte_cryptodev_scheduler_mc_stats_get(uint8_t scheduler_id, uint16_t wc_idx,
+		struct rte_cryptodev_scheduler_mc_stats *stats)
+{
+	struct rte_cryptodev *dev = scheduler_mc_dev_get(scheduler_id);
+
+	if (!dev) {
+		CR_SCHED_LOG(ERR, "Operation not supported");
+		return -ENOTSUP;
+	}
+
+	if (!stats) {
+		CR_SCHED_LOG(ERR, "Invalid stats parameter");
+		return -EINVAL;
+	}
+
+	return scheduler_mc_stats_get(dev, wc_idx, stats);
+}
+
+int
+rte_cryptodev_scheduler_reorder_stats_get(uint8_t scheduler_id,
+		struct rte_cryptodev_scheduler_reorder_stats *stats)
+{
+	struct rte_cryptodev *dev = scheduler_mc_dev_get(scheduler_id);
+
+	if (!dev) {
+		CR_SCHED_LOG(ERR, "Operation not supported");
+		return -ENOTSUP;
+	}
+
+	if (!stats) {
+		CR_SCHED_LOG(ERR, "Invalid stats parameter");
+		return -EINVAL;
+	}
+
+	scheduler_mc_reorder_stats_get(dev, stats);
+	return 0;
+}
 
 RTE_LOG_REGISTER_DEFAULT(scheduler_logtype_driver, INFO);
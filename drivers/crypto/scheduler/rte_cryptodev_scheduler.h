@@ -18,6 +18,7 @@
  */
 
 #include <stdint.h>
+#include <rte_compat.h>
 #include "rte_cryptodev_scheduler_operations.h"
 
 #ifdef __cplusplus
@@ -69,6 +70,7 @@ enum rte_cryptodev_scheduler_mode {
 enum rte_cryptodev_schedule_option_type {
 	CDEV_SCHED_OPTION_NOT_SET = 0,
 	CDEV_SCHED_OPTION_THRESHOLD,
+	CDEV_SCHED_OPTION_WORK_STEALING,
 
 	CDEV_SCHED_OPTION_COUNT
 };
@@ -81,6 +83,37 @@ struct rte_cryptodev_scheduler_threshold_option {
 	uint32_t threshold;	/**< Threshold for packet-size mode */
 };
 
+/**
+ * Work stealing option structure of the multi-core mode.
+ * The devarg value is the max in-flight ops, work stealing being enabled.
+ */
+#define RTE_CRYPTODEV_SCHEDULER_PARAM_WORK_STEALING	"work_stealing"
+struct rte_cryptodev_scheduler_work_stealing_option {
+	uint32_t enable;
+	/**< Idle worker cores take ops from the rings of the others */
+	uint32_t max_inflight;
+	/**< Max ops in flight per worker core, 0 if unlimited */
+};
+
+/**
+ * Statistics of a worker core of the multi-core mode
+ */
+struct rte_cryptodev_scheduler_mc_stats {
+	uint64_t enqueued_ops;	/**< Ops enqueued to the worker device */
+	uint64_t stolen_ops;	/**< Ops taken from other worker cores */
+	uint64_t busy_cycles;	/**< Cycles of the polls moving ops */
+	uint64_t total_cycles;	/**< Cycles since the scheduler start */
+};
+
+/**
+ * Reordering statistics of the multi-core mode
+ */
+struct rte_cryptodev_scheduler_reorder_stats {
+	uint64_t dequeued_ops;	/**< Ops dequeued in order */
+	uint64_t delay_cycles;
+	/**< Cycles completed ops waited for earlier ops, summed over ops */
+};
+
 struct rte_cryptodev_scheduler;
 
 /**
@@ -252,6 +285,50 @@ rte_cryptodev_scheduler_option_get(uint8_t scheduler_id,
 		enum rte_cryptodev_schedule_option_type option_type,
 		void *option);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of a worker core of the multi-core mode, reset when
+ * the scheduler starts.
+ * @param scheduler_id
+ *   The target scheduler device ID
+ * @param wc_idx
+ *   Index of the worker core in the core list of the scheduler
+ * @param stats
+ *   If successful, the statistics of the worker core.
+ * @return
+ *   - 0 if successful
+ *   - -ENOTSUP if the scheduler is not in multi-core mode.
+ *   - -EINVAL if input values are invalid.
+ */
+__rte_experimental
+int
+rte_cryptodev_scheduler_mc_stats_get(uint8_t scheduler_id, uint16_t wc_idx,
+		struct rte_cryptodev_scheduler_mc_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the reordering statistics of the multi-core mode, summed over the
+ * queue pairs and reset when the scheduler starts. The average reordering
+ * delay of an op is delay_cycles / dequeued_ops, it is zero if reordering
+ * is disabled.
+ * @param scheduler_id
+ *   The target scheduler device ID
+ * @param stats
+ *   If successful, the reordering statistics.
+ * @return
+ *   - 0 if successful
+ *   - -ENOTSUP if the scheduler is not in multi-core mode.
+ *   - -EINVAL if input values are invalid.
+ */
+__rte_experimental
+int
+rte_cryptodev_scheduler_reorder_stats_get(uint8_t scheduler_id,
+		struct rte_cryptodev_scheduler_reorder_stats *stats);
+
 typedef uint16_t (*rte_cryptodev_scheduler_burst_enqueue_t)(void *qp_ctx,
 		struct rte_crypto_op **ops, uint16_t nb_ops);
 
@@ -4,6 +4,7 @@
 #include <unistd.h>
 
 #include <cryptodev_pmd.h>
+#include <rte_cycles.h>
 #include <rte_malloc.h>
 
 #include "rte_cryptodev_scheduler_operations.h"
@@ -16,13 +17,28 @@
 
 #define CRYPTO_OP_STATUS_BIT_COMPLETE	0x80
 
+/** per worker core statistics, written by the worker core only */
+struct mc_scheduler_wc_stats {
+	uint64_t enqueued_ops;
+	uint64_t stolen_ops;
+	uint64_t busy_cycles;
+	uint64_t total_cycles;
+} __rte_cache_aligned;
+
 /** multi-core scheduler context */
 struct mc_scheduler_ctx {
 	uint32_t num_workers;             /**< Number of workers polling */
 	uint32_t stop_signal;
 
+	uint32_t work_stealing;
+	/**< Idle worker cores steal ops from the enqueue rings of others */
+	uint32_t max_inflight;
+	/**< Max ops held by a worker core, 0 if unlimited */
+
 	struct rte_ring *sched_enq_ring[RTE_MAX_LCORE];
 	struct rte_ring *sched_deq_ring[RTE_MAX_LCORE];
+
+	struct mc_scheduler_wc_stats wc_stats[RTE_MAX_LCORE];
 };
 
 struct mc_scheduler_qp_ctx {
@@ -32,6 +48,15 @@ struct mc_scheduler_qp_ctx {
 	uint32_t last_enq_worker_idx;
 	uint32_t last_deq_worker_idx;
 
+	/*
+	 * Reordering delay, as the number of completed ops waiting for an
+	 * earlier op in the order ring integrated over time.
+	 */
+	uint64_t reorder_last_tsc;
+	uint64_t reorder_delay_cycles;
+	uint64_t reorder_dequeued_ops;
+	uint32_t reorder_held_ops;
+
 	struct mc_scheduler_ctx *mc_private_ctx;
 };
 
@@ -106,19 +131,35 @@ schedule_dequeue(void *qp, struct rte_crypto_op **ops, uint16_t nb_ops)
 
 }
 
+/*
+ * The position of an op in the order ring is its sequence number: ops are
+ * returned in sequence, the completed ones after an op still processed by a
+ * worker core being held.
+ */
 static uint16_t
 schedule_dequeue_ordering(void *qp, struct rte_crypto_op **ops,
 		uint16_t nb_ops)
 {
+	struct mc_scheduler_qp_ctx *mc_qp_ctx =
+			((struct scheduler_qp_ctx *)qp)->private_qp_ctx;
 	struct rte_ring *order_ring =
 		((struct scheduler_qp_ctx *)qp)->order_ring;
 	struct rte_crypto_op *op;
-	uint32_t nb_objs, nb_ops_to_deq;
+	uint32_t nb_objs, nb_ops_to_deq, i, held = 0;
+	uint64_t now;
 
 	nb_objs = rte_ring_dequeue_burst_start(order_ring, (void **)ops,
 		nb_ops, NULL);
-	if (nb_objs == 0)
+
+	now = rte_rdtsc();
+	mc_qp_ctx->reorder_delay_cycles += mc_qp_ctx->reorder_held_ops *
+			(now - mc_qp_ctx->reorder_last_tsc);
+	mc_qp_ctx->reorder_last_tsc = now;
+
+	if (nb_objs == 0) {
+		mc_qp_ctx->reorder_held_ops = 0;
 		return 0;
+	}
 
 	for (nb_ops_to_deq = 0; nb_ops_to_deq != nb_objs; nb_ops_to_deq++) {
 		op = ops[nb_ops_to_deq];
@@ -127,6 +168,12 @@ schedule_dequeue_ordering(void *qp, struct rte_crypto_op **ops,
 		op->status &= ~CRYPTO_OP_STATUS_BIT_COMPLETE;
 	}
 
+	for (i = nb_ops_to_deq + 1; i < nb_objs; i++)
+		if (ops[i]->status & CRYPTO_OP_STATUS_BIT_COMPLETE)
+			held++;
+	mc_qp_ctx->reorder_held_ops = held;
+	mc_qp_ctx->reorder_dequeued_ops += nb_ops_to_deq;
+
 	rte_ring_dequeue_finish(order_ring, nb_ops_to_deq);
 	return nb_ops_to_deq;
 }
@@ -145,6 +192,34 @@ worker_detach(__rte_unused struct rte_cryptodev *dev,
 	return 0;
 }
 
+/*
+ * Take ops from the enqueue ring with the most ops among the other worker
+ * cores: half of its ops, within the budget of the thief.
+ */
+static uint16_t
+mc_scheduler_steal(struct mc_scheduler_ctx *mc_ctx, int worker_idx,
+		struct rte_crypto_op **ops, uint16_t budget)
+{
+	uint32_t i, count, max_count = 0;
+	int victim = -1;
+
+	for (i = 0; i < mc_ctx->num_workers; i++) {
+		if ((int)i == worker_idx)
+			continue;
+		count = rte_ring_count(mc_ctx->sched_enq_ring[i]);
+		if (count > max_count) {
+			max_count = count;
+			victim = i;
+		}
+	}
+	if (victim < 0)
+		return 0;
+
+	return rte_ring_mc_dequeue_burst(mc_ctx->sched_enq_ring[victim],
+			(void **)ops, RTE_MIN(budget, (max_count + 1) / 2),
+			NULL);
+}
+
 static int
 mc_scheduler_worker(struct rte_cryptodev *dev)
 {
@@ -164,6 +239,11 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 	uint16_t pending_deq_ops_idx = 0;
 	uint16_t inflight_ops = 0;
 	const uint8_t reordering_enabled = sched_ctx->reordering_enabled;
+	const uint32_t work_stealing = mc_ctx->work_stealing;
+	struct mc_scheduler_wc_stats *stats;
+	uint64_t start_tsc, last_tsc, now;
+	uint16_t budget;
+	int busy;
 
 	for (i = 0; i < (int)sched_ctx->nb_wc; i++) {
 		if (sched_ctx->wc_pool[i] == core_id) {
@@ -180,8 +260,12 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 	worker = &sched_ctx->workers[worker_idx];
 	enq_ring = mc_ctx->sched_enq_ring[worker_idx];
 	deq_ring = mc_ctx->sched_deq_ring[worker_idx];
+	stats = &mc_ctx->wc_stats[worker_idx];
+
+	start_tsc = last_tsc = rte_rdtsc();
 
 	while (!mc_ctx->stop_signal) {
+		busy = 0;
 		if (pending_enq_ops) {
 			processed_ops =
 				rte_cryptodev_enqueue_burst(worker->dev_id,
@@ -191,15 +275,44 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 			pending_enq_ops -= processed_ops;
 			pending_enq_ops_idx += processed_ops;
 			inflight_ops += processed_ops;
+			stats->enqueued_ops += processed_ops;
+			busy = processed_ops != 0;
 		} else {
-			processed_ops = rte_ring_dequeue_burst(enq_ring, (void *)enq_ops,
-							MC_SCHED_BUFFER_SIZE, NULL);
+			/*
+			 * Ops left in the enqueue ring over the in-flight
+			 * limit may be stolen by less loaded worker cores.
+			 */
+			budget = MC_SCHED_BUFFER_SIZE;
+			if (mc_ctx->max_inflight != 0)
+				budget = RTE_MIN(budget,
+					mc_ctx->max_inflight > inflight_ops ?
+					mc_ctx->max_inflight - inflight_ops :
+					0);
+
+			processed_ops = 0;
+			if (budget != 0 && work_stealing) {
+				processed_ops = rte_ring_mc_dequeue_burst(
+						enq_ring, (void *)enq_ops,
+						budget, NULL);
+				if (processed_ops == 0) {
+					processed_ops = mc_scheduler_steal(
+						mc_ctx, worker_idx, enq_ops,
+						budget);
+					stats->stolen_ops += processed_ops;
+				}
+			} else if (budget != 0) {
+				processed_ops = rte_ring_dequeue_burst(
+						enq_ring, (void *)enq_ops,
+						budget, NULL);
+			}
 			if (processed_ops) {
 				pending_enq_ops_idx = rte_cryptodev_enqueue_burst(
 						worker->dev_id, worker->qp_id,
 						enq_ops, processed_ops);
 				pending_enq_ops = processed_ops - pending_enq_ops_idx;
 				inflight_ops += pending_enq_ops_idx;
+				stats->enqueued_ops += pending_enq_ops_idx;
+				busy = 1;
 			}
 		}
 
@@ -215,6 +328,7 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 					MC_SCHED_BUFFER_SIZE);
 			if (processed_ops) {
 				inflight_ops -= processed_ops;
+				busy = 1;
 				if (reordering_enabled) {
 					uint16_t j;
 
@@ -232,6 +346,12 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 			}
 		}
 
+		now = rte_rdtsc();
+		if (busy)
+			stats->busy_cycles += now - last_tsc;
+		stats->total_cycles = now - start_tsc;
+		last_tsc = now;
+
 		rte_pause();
 	}
 
@@ -246,6 +366,7 @@ scheduler_start(struct rte_cryptodev *dev)
 	uint16_t i;
 
 	mc_ctx->stop_signal = 0;
+	memset(mc_ctx->wc_stats, 0, sizeof(mc_ctx->wc_stats));
 
 	for (i = 0; i < sched_ctx->nb_wc; i++)
 		rte_eal_remote_launch(
@@ -279,6 +400,11 @@ scheduler_start(struct rte_cryptodev *dev)
 
 		mc_qp_ctx->last_enq_worker_idx = 0;
 		mc_qp_ctx->last_deq_worker_idx = 0;
+
+		mc_qp_ctx->reorder_last_tsc = rte_rdtsc();
+		mc_qp_ctx->reorder_delay_cycles = 0;
+		mc_qp_ctx->reorder_dequeued_ops = 0;
+		mc_qp_ctx->reorder_held_ops = 0;
 	}
 
 	return 0;
@@ -388,6 +514,87 @@ exit:
 	return -1;
 }
 
+static int
+scheduler_option_set(struct rte_cryptodev *dev, uint32_t option_type,
+		void *option)
+{
+	struct mc_scheduler_ctx *mc_ctx = ((struct scheduler_ctx *)
+			dev->data->dev_private)->private_ctx;
+	struct rte_cryptodev_scheduler_work_stealing_option *ws_option;
+
+	if ((enum rte_cryptodev_schedule_option_type)option_type !=
+			CDEV_SCHED_OPTION_WORK_STEALING) {
+		CR_SCHED_LOG(ERR, "Option not supported");
+		return -EINVAL;
+	}
+
+	ws_option = option;
+	mc_ctx->work_stealing = ws_option->enable != 0;
+	mc_ctx->max_inflight = ws_option->max_inflight;
+
+	return 0;
+}
+
+static int
+scheduler_option_get(struct rte_cryptodev *dev, uint32_t option_type,
+		void *option)
+{
+	struct mc_scheduler_ctx *mc_ctx = ((struct scheduler_ctx *)
+			dev->data->dev_private)->private_ctx;
+	struct rte_cryptodev_scheduler_work_stealing_option *ws_option;
+
+	if ((enum rte_cryptodev_schedule_option_type)option_type !=
+			CDEV_SCHED_OPTION_WORK_STEALING) {
+		CR_SCHED_LOG(ERR, "Option not supported");
+		return -EINVAL;
+	}
+
+	ws_option = option;
+	ws_option->enable = mc_ctx->work_stealing;
+	ws_option->max_inflight = mc_ctx->max_inflight;
+
+	return 0;
+}
+
+int
+scheduler_mc_stats_get(struct rte_cryptodev *dev, uint16_t wc_idx,
+		struct rte_cryptodev_scheduler_mc_stats *stats)
+{
+	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
+	struct mc_scheduler_ctx *mc_ctx = sched_ctx->private_ctx;
+	struct mc_scheduler_wc_stats *wc_stats;
+
+	if (wc_idx >= sched_ctx->nb_wc)
+		return -EINVAL;
+
+	wc_stats = &mc_ctx->wc_stats[wc_idx];
+	stats->enqueued_ops = wc_stats->enqueued_ops;
+	stats->stolen_ops = wc_stats->stolen_ops;
+	stats->busy_cycles = wc_stats->busy_cycles;
+	stats->total_cycles = wc_stats->total_cycles;
+
+	return 0;
+}
+
+void
+scheduler_mc_reorder_stats_get(struct rte_cryptodev *dev,
+		struct rte_cryptodev_scheduler_reorder_stats *stats)
+{
+	struct mc_scheduler_qp_ctx *mc_qp_ctx;
+	struct scheduler_qp_ctx *qp_ctx;
+	uint16_t i;
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < dev->data->nb_queue_pairs; i++) {
+		qp_ctx = dev->data->queue_pairs[i];
+		if (qp_ctx == NULL || qp_ctx->private_qp_ctx == NULL)
+			continue;
+		mc_qp_ctx = qp_ctx->private_qp_ctx;
+		stats->dequeued_ops += mc_qp_ctx->reorder_dequeued_ops;
+		stats->delay_cycles += mc_qp_ctx->reorder_delay_cycles;
+	}
+}
+
 static struct rte_cryptodev_scheduler_ops scheduler_mc_ops = {
 	worker_attach,
 	worker_detach,
@@ -395,8 +602,8 @@ static struct rte_cryptodev_scheduler_ops scheduler_mc_ops = {
 	scheduler_stop,
 	scheduler_config_qp,
 	scheduler_create_private_ctx,
-	NULL,	/* option_set */
-	NULL	/* option_get */
+	scheduler_option_set,
+	scheduler_option_get
 };
 
 static struct rte_cryptodev_scheduler mc_scheduler = {
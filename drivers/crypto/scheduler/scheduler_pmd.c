@@ -115,6 +115,8 @@ cryptodev_scheduler_create(const char *name,
 		union {
 			struct rte_cryptodev_scheduler_threshold_option
 					threshold_option;
+			struct rte_cryptodev_scheduler_work_stealing_option
+					work_stealing_option;
 		} option;
 		enum rte_cryptodev_schedule_option_type option_type;
 		char param_name[RTE_CRYPTODEV_SCHEDULER_NAME_MAX_LEN] = {0};
@@ -164,6 +166,19 @@ cryptodev_scheduler_create(const char *name,
 				option.threshold_option.threshold =
 						strtoul(param_val, &end, 0);
 				break;
+			case CDEV_SCHED_MODE_MULTICORE:
+				if (strcmp(param_name,
+					RTE_CRYPTODEV_SCHEDULER_PARAM_WORK_STEALING)
+						!= 0) {
+					CR_SCHED_LOG(ERR, "Invalid mode param");
+					return -EINVAL;
+				}
+				option_type = CDEV_SCHED_OPTION_WORK_STEALING;
+
+				option.work_stealing_option.enable = 1;
+				option.work_stealing_option.max_inflight =
+						strtoul(param_val, &end, 0);
+				break;
 			default:
 				CR_SCHED_LOG(ERR, "Invalid mode param");
 				return -EINVAL;
@@ -101,6 +101,14 @@ scheduler_order_drain(struct rte_ring *order_ring,
 	return nb_ops_to_deq;
 }
 
+int
+scheduler_mc_stats_get(struct rte_cryptodev *dev, uint16_t wc_idx,
+		struct rte_cryptodev_scheduler_mc_stats *stats);
+
+void
+scheduler_mc_reorder_stats_get(struct rte_cryptodev *dev,
+		struct rte_cryptodev_scheduler_reorder_stats *stats);
+
 /** device specific operations function pointer structure */
 extern struct rte_cryptodev_ops *rte_crypto_scheduler_pmd_ops;
 
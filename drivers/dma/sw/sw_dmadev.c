@@ -0,0 +1,916 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_eal.h>
+#include <rte_kvargs.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_pause.h>
+#include <rte_service_component.h>
+
+#include <rte_dmadev_pmd.h>
+
+#include "sw_dmadev.h"
+
+RTE_LOG_REGISTER_DEFAULT(swdma_logtype, INFO);
+#define SWDMA_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, swdma_logtype, "%s(): " fmt "\n", \
+		__func__, ##args)
+
+static inline void
+swdma_memcpy(const struct swdma_hw *hw, const struct swdma_desc *desc,
+	     void *dst, const void *src, uint32_t len)
+{
+	/* Non-temporal stores, so that a large copy does not evict the
+	 * working set of the application from the cache, as a DMA engine
+	 * writing to memory would not.
+	 */
+	if (hw->nt_threshold != 0 && len >= hw->nt_threshold && !desc->llc)
+		rte_memcpy_nt(dst, src, len);
+	else
+		rte_memcpy(dst, src, len);
+}
+
+static uint16_t
+swdma_exec_copy_sg(const struct swdma_hw *hw, const struct swdma_desc *desc,
+		   const struct rte_dma_sge *src, const struct rte_dma_sge *dst)
+{
+	uint64_t src_len = 0, dst_len = 0;
+	uint32_t soff = 0, doff = 0;
+	uint16_t si, di;
+
+	/* Check the whole job first, so that a failed job leaves the
+	 * destination untouched.
+	 */
+	for (si = 0; si < desc->nb_src; si++) {
+		if (src[si].addr == 0)
+			return RTE_DMA_STATUS_INVALID_ADDR;
+		src_len += src[si].length;
+	}
+	for (di = 0; di < desc->nb_dst; di++) {
+		if (dst[di].addr == 0)
+			return RTE_DMA_STATUS_INVALID_ADDR;
+		dst_len += dst[di].length;
+	}
+	if (src_len != dst_len)
+		return RTE_DMA_STATUS_INVALID_LENGTH;
+
+	si = 0;
+	di = 0;
+	while (si < desc->nb_src && di < desc->nb_dst) {
+		uint32_t len = RTE_MIN(src[si].length - soff,
+				       dst[di].length - doff);
+
+		swdma_memcpy(hw, desc, (void *)(uintptr_t)(dst[di].addr + doff),
+			     (const void *)(uintptr_t)(src[si].addr + soff),
+			     len);
+
+		soff += len;
+		doff += len;
+		if (soff == src[si].length) {
+			si++;
+			soff = 0;
+		}
+		if (doff == dst[di].length) {
+			di++;
+			doff = 0;
+		}
+	}
+
+	return RTE_DMA_STATUS_SUCCESSFUL;
+}
+
+static void
+swdma_exec_fill(uint8_t *dst, uint64_t pattern, uint32_t len)
+{
+	for (; len >= sizeof(pattern); len -= sizeof(pattern),
+			dst += sizeof(pattern))
+		memcpy(dst, &pattern, sizeof(pattern));
+
+	memcpy(dst, &pattern, len);
+}
+
+static uint16_t
+swdma_exec(const struct swdma_hw *hw, const struct swdma_vchan *vchan,
+	   const struct swdma_desc *desc, uint16_t slot)
+{
+	const struct rte_dma_sge *sges;
+
+	switch (desc->op) {
+	case SWDMA_OP_COPY:
+		if (desc->src == 0 || desc->dst == 0)
+			return RTE_DMA_STATUS_INVALID_ADDR;
+		swdma_memcpy(hw, desc, (void *)(uintptr_t)desc->dst,
+			     (const void *)(uintptr_t)desc->src, desc->len);
+		return RTE_DMA_STATUS_SUCCESSFUL;
+	case SWDMA_OP_COPY_SG:
+		sges = &vchan->sges[slot * 2 * SWDMA_MAX_SGES];
+		return swdma_exec_copy_sg(hw, desc, sges,
+					  sges + SWDMA_MAX_SGES);
+	case SWDMA_OP_FILL:
+		if (desc->dst == 0)
+			return RTE_DMA_STATUS_INVALID_ADDR;
+		swdma_exec_fill((uint8_t *)(uintptr_t)desc->dst,
+				desc->pattern, desc->len);
+		return RTE_DMA_STATUS_SUCCESSFUL;
+	default:
+		return RTE_DMA_STATUS_INVALID_OPCODE;
+	}
+}
+
+static uint16_t
+swdma_vchan_process(const struct swdma_hw *hw, struct swdma_vchan *vchan)
+{
+	uint16_t done = vchan->done_idx;
+	uint16_t submitted = __atomic_load_n(&vchan->submit_idx,
+					     __ATOMIC_ACQUIRE);
+	uint16_t n = RTE_MIN((uint16_t)(submitted - done),
+			     SWDMA_WORKER_BURST);
+	uint16_t i;
+
+	if (n == 0)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		uint16_t slot = (done + i) & vchan->mask;
+		struct swdma_desc *desc = &vchan->desc[slot];
+
+		desc->status = swdma_exec(hw, vchan, desc, slot);
+	}
+
+	/* Order the data stores, including the non-temporal ones,
+	 * before the completions.
+	 */
+	rte_wmb();
+	__atomic_store_n(&vchan->done_idx, (uint16_t)(done + n),
+			 __ATOMIC_RELEASE);
+
+	return n;
+}
+
+/* Any number of workers may run this concurrently. Each vchan is
+ * processed by one worker at a time, and the starting vchan depends on
+ * the calling lcore to spread the workers over the vchans.
+ */
+static int32_t
+swdma_worker_run(struct swdma_hw *hw)
+{
+	uint16_t nb_vchans = hw->nb_vchans;
+	unsigned int start = rte_lcore_id();
+	uint32_t processed = 0;
+	uint16_t i;
+
+	if (!__atomic_load_n(&hw->started, __ATOMIC_ACQUIRE))
+		return -EAGAIN;
+
+	for (i = 0; i < nb_vchans; i++) {
+		struct swdma_vchan *vchan =
+			&hw->vchans[(start + i) % nb_vchans];
+
+		if (!rte_spinlock_trylock(&vchan->lock))
+			continue;
+		processed += swdma_vchan_process(hw, vchan);
+		rte_spinlock_unlock(&vchan->lock);
+	}
+
+	return processed > 0 ? 0 : -EAGAIN;
+}
+
+static int32_t
+swdma_service_func(void *args)
+{
+	return swdma_worker_run(args);
+}
+
+static int
+swdma_monitor_clb(const uint64_t val,
+		  const uint64_t opaque[RTE_POWER_MONITOR_OPAQUE_SZ])
+{
+	/* Don't sleep if descriptors were submitted meanwhile. */
+	return (uint16_t)val != (uint16_t)opaque[0] ? -1 : 0;
+}
+
+static int32_t
+swdma_service_monitor(void *args, struct rte_power_monitor_cond *pmc)
+{
+	struct swdma_hw *hw = args;
+	struct swdma_vchan *vchan = &hw->vchans[0];
+
+	/* Only a single doorbell can be monitored. */
+	if (hw->nb_vchans != 1)
+		return -ENOTSUP;
+
+	pmc->addr = &vchan->submit_idx;
+	pmc->size = sizeof(vchan->submit_idx);
+	pmc->fn = swdma_monitor_clb;
+	pmc->opaque[0] = vchan->done_idx;
+
+	return 0;
+}
+
+static int
+swdma_lcore_main(void *args)
+{
+	struct swdma_hw *hw = args;
+
+	while (!__atomic_load_n(&hw->lcore_exit, __ATOMIC_RELAXED))
+		if (swdma_worker_run(hw) != 0)
+			rte_pause();
+
+	return 0;
+}
+
+static int
+swdma_info_get(const struct rte_dma_dev *dev, struct rte_dma_info *dev_info,
+	       uint32_t info_sz)
+{
+	RTE_SET_USED(dev);
+	RTE_SET_USED(info_sz);
+
+	dev_info->dev_capa = RTE_DMA_CAPA_MEM_TO_MEM |
+			     RTE_DMA_CAPA_SVA |
+			     RTE_DMA_CAPA_HANDLES_ERRORS |
+			     RTE_DMA_CAPA_OPS_COPY |
+			     RTE_DMA_CAPA_OPS_COPY_SG |
+			     RTE_DMA_CAPA_OPS_FILL;
+	dev_info->max_vchans = SWDMA_MAX_VCHANS;
+	dev_info->max_desc = SWDMA_MAX_DESC;
+	dev_info->min_desc = SWDMA_MIN_DESC;
+	dev_info->max_sges = SWDMA_MAX_SGES;
+
+	return 0;
+}
+
+static void
+swdma_vchan_release(struct swdma_vchan *vchan)
+{
+	rte_free(vchan->desc);
+	vchan->desc = NULL;
+	rte_free(vchan->sges);
+	vchan->sges = NULL;
+}
+
+static int
+swdma_configure(struct rte_dma_dev *dev, const struct rte_dma_conf *conf,
+		uint32_t conf_sz)
+{
+	struct swdma_hw *hw = dev->data->dev_private;
+	uint16_t i;
+
+	RTE_SET_USED(conf_sz);
+
+	for (i = conf->nb_vchans; i < hw->nb_vchans; i++)
+		swdma_vchan_release(&hw->vchans[i]);
+
+	hw->nb_vchans = conf->nb_vchans;
+
+	return 0;
+}
+
+static int
+swdma_vchan_setup(struct rte_dma_dev *dev, uint16_t vchan_id,
+		  const struct rte_dma_vchan_conf *conf, uint32_t conf_sz)
+{
+	struct swdma_hw *hw = dev->data->dev_private;
+	struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+	struct swdma_desc *desc;
+	struct rte_dma_sge *sges;
+
+	RTE_SET_USED(conf_sz);
+
+	if (!rte_is_power_of_2(conf->nb_desc)) {
+		SWDMA_LOG(ERR, "Number of desc must be power of 2!");
+		return -EINVAL;
+	}
+
+	desc = rte_zmalloc_socket("dma_sw_desc",
+				  conf->nb_desc * sizeof(*desc),
+				  RTE_CACHE_LINE_SIZE, hw->socket_id);
+	sges = rte_zmalloc_socket("dma_sw_sges",
+				  conf->nb_desc * 2 * SWDMA_MAX_SGES *
+				  sizeof(*sges),
+				  RTE_CACHE_LINE_SIZE, hw->socket_id);
+	if (desc == NULL || sges == NULL) {
+		SWDMA_LOG(ERR, "Malloc dma sw desc fail!");
+		rte_free(desc);
+		rte_free(sges);
+		return -ENOMEM;
+	}
+
+	swdma_vchan_release(vchan);
+	vchan->desc = desc;
+	vchan->sges = sges;
+	vchan->nb_desc = conf->nb_desc;
+	vchan->mask = conf->nb_desc - 1;
+	rte_spinlock_init(&vchan->lock);
+
+	return 0;
+}
+
+static void
+swdma_vchan_reset(struct swdma_vchan *vchan)
+{
+	vchan->write_idx = 0;
+	vchan->read_idx = 0;
+	vchan->submit_idx = 0;
+	vchan->done_idx = 0;
+	vchan->submitted = 0;
+	vchan->completed = 0;
+	vchan->errors = 0;
+}
+
+static void
+swdma_lcores_stop(struct swdma_hw *hw, uint16_t nb_lcores)
+{
+	uint16_t i;
+
+	__atomic_store_n(&hw->lcore_exit, true, __ATOMIC_RELAXED);
+	for (i = 0; i < nb_lcores; i++)
+		rte_eal_wait_lcore(hw->lcores[i]);
+}
+
+static int
+swdma_start(struct rte_dma_dev *dev)
+{
+	struct swdma_hw *hw = dev->data->dev_private;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < hw->nb_vchans; i++) {
+		if (hw->vchans[i].desc == NULL) {
+			SWDMA_LOG(ERR, "Vchan %u was not setup, start fail!",
+				  i);
+			return -EINVAL;
+		}
+		swdma_vchan_reset(&hw->vchans[i]);
+	}
+
+	__atomic_store_n(&hw->started, true, __ATOMIC_RELEASE);
+
+	if (hw->service_registered)
+		return rte_service_component_runstate_set(hw->service_id, 1);
+
+	hw->lcore_exit = false;
+	for (i = 0; i < hw->nb_lcores; i++) {
+		ret = rte_eal_remote_launch(swdma_lcore_main, hw,
+					    hw->lcores[i]);
+		if (ret != 0) {
+			SWDMA_LOG(ERR, "Launch worker on lcore %u fail!",
+				  hw->lcores[i]);
+			__atomic_store_n(&hw->started, false,
+					 __ATOMIC_RELEASE);
+			swdma_lcores_stop(hw, i);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int
+swdma_stop(struct rte_dma_dev *dev)
+{
+	struct swdma_hw *hw = dev->data->dev_private;
+	uint16_t i;
+
+	__atomic_store_n(&hw->started, false, __ATOMIC_RELEASE);
+
+	if (hw->service_registered)
+		rte_service_component_runstate_set(hw->service_id, 0);
+	else
+		swdma_lcores_stop(hw, hw->nb_lcores);
+
+	/* Wait for workers still processing a vchan. */
+	for (i = 0; i < hw->nb_vchans; i++) {
+		rte_spinlock_lock(&hw->vchans[i].lock);
+		rte_spinlock_unlock(&hw->vchans[i].lock);
+	}
+
+	return 0;
+}
+
+static int
+swdma_close(struct rte_dma_dev *dev)
+{
+	struct swdma_hw *hw = dev->data->dev_private;
+	uint16_t i;
+
+	/* The device already stopped */
+	for (i = 0; i < SWDMA_MAX_VCHANS; i++)
+		swdma_vchan_release(&hw->vchans[i]);
+	hw->nb_vchans = 0;
+
+	if (hw->service_registered) {
+		rte_service_component_unregister(hw->service_id);
+		hw->service_registered = false;
+	}
+
+	return 0;
+}
+
+static int
+swdma_vchan_status(const struct rte_dma_dev *dev, uint16_t vchan_id,
+		   enum rte_dma_vchan_status *status)
+{
+	const struct swdma_hw *hw = dev->data->dev_private;
+	const struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+
+	if (__atomic_load_n(&vchan->done_idx, __ATOMIC_ACQUIRE) !=
+			vchan->submit_idx)
+		*status = RTE_DMA_VCHAN_ACTIVE;
+	else
+		*status = RTE_DMA_VCHAN_IDLE;
+
+	return 0;
+}
+
+static int
+swdma_stats_get(const struct rte_dma_dev *dev, uint16_t vchan_id,
+		struct rte_dma_stats *stats, uint32_t stats_sz)
+{
+	const struct swdma_hw *hw = dev->data->dev_private;
+	const struct swdma_vchan *vchan;
+	uint16_t i;
+
+	RTE_SET_USED(stats_sz);
+
+	*stats = (struct rte_dma_stats){ 0 };
+
+	for (i = 0; i < hw->nb_vchans; i++) {
+		if (vchan_id != RTE_DMA_ALL_VCHAN && vchan_id != i)
+			continue;
+		vchan = &hw->vchans[i];
+		stats->submitted += vchan->submitted;
+		stats->completed += vchan->completed;
+		stats->errors += vchan->errors;
+	}
+
+	return 0;
+}
+
+static int
+swdma_stats_reset(struct rte_dma_dev *dev, uint16_t vchan_id)
+{
+	struct swdma_hw *hw = dev->data->dev_private;
+	uint16_t i;
+
+	for (i = 0; i < hw->nb_vchans; i++) {
+		if (vchan_id != RTE_DMA_ALL_VCHAN && vchan_id != i)
+			continue;
+		hw->vchans[i].submitted = 0;
+		hw->vchans[i].completed = 0;
+		hw->vchans[i].errors = 0;
+	}
+
+	return 0;
+}
+
+static int
+swdma_dump(const struct rte_dma_dev *dev, FILE *f)
+{
+	const struct swdma_hw *hw = dev->data->dev_private;
+	uint16_t i;
+
+	(void)fprintf(f,
+		"    socket_id: %d\n"
+		"    nt_threshold: %u\n",
+		hw->socket_id, hw->nt_threshold);
+	if (hw->service_registered)
+		(void)fprintf(f, "    service_id: %u\n", hw->service_id);
+	for (i = 0; i < hw->nb_lcores; i++)
+		(void)fprintf(f, "    worker_lcore: %u\n", hw->lcores[i]);
+
+	for (i = 0; i < hw->nb_vchans; i++) {
+		const struct swdma_vchan *vchan = &hw->vchans[i];
+
+		(void)fprintf(f,
+			"    vchan %u:\n"
+			"      nb_desc: %u\n"
+			"      write_idx: %u\n"
+			"      submit_idx: %u\n"
+			"      done_idx: %u\n"
+			"      read_idx: %u\n"
+			"      submitted_count: %" PRIu64 "\n"
+			"      completed_count: %" PRIu64 "\n"
+			"      errors_count: %" PRIu64 "\n",
+			i, vchan->nb_desc, vchan->write_idx,
+			vchan->submit_idx, vchan->done_idx, vchan->read_idx,
+			vchan->submitted, vchan->completed, vchan->errors);
+	}
+
+	return 0;
+}
+
+static inline void
+swdma_doorbell(struct swdma_vchan *vchan)
+{
+	uint16_t write_idx = vchan->write_idx;
+
+	vchan->submitted += (uint16_t)(write_idx - vchan->submit_idx);
+	__atomic_store_n(&vchan->submit_idx, write_idx, __ATOMIC_RELEASE);
+}
+
+static __rte_always_inline struct swdma_desc *
+swdma_desc_get(struct swdma_vchan *vchan)
+{
+	uint16_t write_idx = vchan->write_idx;
+
+	if (unlikely((uint16_t)(write_idx - vchan->read_idx) ==
+		     vchan->nb_desc))
+		return NULL;
+
+	return &vchan->desc[write_idx & vchan->mask];
+}
+
+static __rte_always_inline int
+swdma_desc_put(struct swdma_vchan *vchan, struct swdma_desc *desc,
+	       enum swdma_op op, uint64_t flags)
+{
+	uint16_t idx = vchan->write_idx;
+
+	desc->op = op;
+	desc->llc = !!(flags & RTE_DMA_OP_FLAG_LLC);
+	vchan->write_idx = idx + 1;
+
+	/* Descriptors are processed in order, so a fence is implied. */
+	if (flags & RTE_DMA_OP_FLAG_SUBMIT)
+		swdma_doorbell(vchan);
+
+	return idx;
+}
+
+static int
+swdma_copy(void *dev_private, uint16_t vchan_id, rte_iova_t src,
+	   rte_iova_t dst, uint32_t length, uint64_t flags)
+{
+	struct swdma_hw *hw = dev_private;
+	struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+	struct swdma_desc *desc = swdma_desc_get(vchan);
+
+	if (desc == NULL)
+		return -ENOSPC;
+
+	desc->src = src;
+	desc->dst = dst;
+	desc->len = length;
+
+	return swdma_desc_put(vchan, desc, SWDMA_OP_COPY, flags);
+}
+
+static int
+swdma_copy_sg(void *dev_private, uint16_t vchan_id,
+	      const struct rte_dma_sge *src, const struct rte_dma_sge *dst,
+	      uint16_t nb_src, uint16_t nb_dst, uint64_t flags)
+{
+	struct swdma_hw *hw = dev_private;
+	struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+	struct swdma_desc *desc;
+	struct rte_dma_sge *sges;
+
+	if (nb_src > SWDMA_MAX_SGES || nb_dst > SWDMA_MAX_SGES)
+		return -EINVAL;
+
+	desc = swdma_desc_get(vchan);
+	if (desc == NULL)
+		return -ENOSPC;
+
+	sges = &vchan->sges[(vchan->write_idx & vchan->mask) * 2 *
+			    SWDMA_MAX_SGES];
+	memcpy(sges, src, nb_src * sizeof(*src));
+	memcpy(sges + SWDMA_MAX_SGES, dst, nb_dst * sizeof(*dst));
+	desc->nb_src = nb_src;
+	desc->nb_dst = nb_dst;
+
+	return swdma_desc_put(vchan, desc, SWDMA_OP_COPY_SG, flags);
+}
+
+static int
+swdma_fill(void *dev_private, uint16_t vchan_id, uint64_t pattern,
+	   rte_iova_t dst, uint32_t length, uint64_t flags)
+{
+	struct swdma_hw *hw = dev_private;
+	struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+	struct swdma_desc *desc = swdma_desc_get(vchan);
+
+	if (desc == NULL)
+		return -ENOSPC;
+
+	desc->pattern = pattern;
+	desc->dst = dst;
+	desc->len = length;
+
+	return swdma_desc_put(vchan, desc, SWDMA_OP_FILL, flags);
+}
+
+static int
+swdma_submit(void *dev_private, uint16_t vchan_id)
+{
+	struct swdma_hw *hw = dev_private;
+
+	swdma_doorbell(&hw->vchans[vchan_id]);
+
+	return 0;
+}
+
+static uint16_t
+swdma_completed(void *dev_private, uint16_t vchan_id, const uint16_t nb_cpls,
+		uint16_t *last_idx, bool *has_error)
+{
+	struct swdma_hw *hw = dev_private;
+	struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+	uint16_t read_idx = vchan->read_idx;
+	uint16_t avail = __atomic_load_n(&vchan->done_idx, __ATOMIC_ACQUIRE) -
+			read_idx;
+	uint16_t count = RTE_MIN(nb_cpls, avail);
+	uint16_t i;
+
+	/* Stop at the first failed operation; its status is to be
+	 * collected with rte_dma_completed_status().
+	 */
+	for (i = 0; i < count; i++) {
+		const struct swdma_desc *desc =
+			&vchan->desc[(read_idx + i) & vchan->mask];
+
+		if (unlikely(desc->status != RTE_DMA_STATUS_SUCCESSFUL)) {
+			*has_error = true;
+			break;
+		}
+	}
+
+	vchan->read_idx = read_idx + i;
+	vchan->completed += i;
+	*last_idx = vchan->read_idx - 1;
+
+	return i;
+}
+
+static uint16_t
+swdma_completed_status(void *dev_private, uint16_t vchan_id,
+		       const uint16_t nb_cpls, uint16_t *last_idx,
+		       enum rte_dma_status_code *status)
+{
+	struct swdma_hw *hw = dev_private;
+	struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+	uint16_t read_idx = vchan->read_idx;
+	uint16_t avail = __atomic_load_n(&vchan->done_idx, __ATOMIC_ACQUIRE) -
+			read_idx;
+	uint16_t count = RTE_MIN(nb_cpls, avail);
+	uint16_t i;
+
+	for (i = 0; i < count; i++) {
+		const struct swdma_desc *desc =
+			&vchan->desc[(read_idx + i) & vchan->mask];
+
+		status[i] = desc->status;
+		vchan->errors += (desc->status != RTE_DMA_STATUS_SUCCESSFUL);
+	}
+
+	vchan->read_idx = read_idx + count;
+	vchan->completed += count;
+	*last_idx = vchan->read_idx - 1;
+
+	return count;
+}
+
+static uint16_t
+swdma_burst_capacity(const void *dev_private, uint16_t vchan_id)
+{
+	const struct swdma_hw *hw = dev_private;
+	const struct swdma_vchan *vchan = &hw->vchans[vchan_id];
+
+	return vchan->nb_desc - (uint16_t)(vchan->write_idx -
+					   vchan->read_idx);
+}
+
+static const struct rte_dma_dev_ops swdma_ops = {
+	.dev_info_get     = swdma_info_get,
+	.dev_configure    = swdma_configure,
+	.dev_start        = swdma_start,
+	.dev_stop         = swdma_stop,
+	.dev_close        = swdma_close,
+
+	.vchan_setup      = swdma_vchan_setup,
+	.vchan_status     = swdma_vchan_status,
+
+	.stats_get        = swdma_stats_get,
+	.stats_reset      = swdma_stats_reset,
+
+	.dev_dump         = swdma_dump,
+};
+
+static int
+swdma_service_register(const char *name, struct swdma_hw *hw)
+{
+	struct rte_service_spec spec = {
+		.callback = swdma_service_func,
+		.callback_userdata = hw,
+		.capabilities = RTE_SERVICE_CAP_MT_SAFE,
+		.socket_id = hw->socket_id,
+	};
+	int ret;
+
+	snprintf(spec.name, sizeof(spec.name), "%s_service", name);
+
+	ret = rte_service_component_register(&spec, &hw->service_id);
+	if (ret != 0) {
+		SWDMA_LOG(ERR, "Register service for %s fail!", name);
+		return ret;
+	}
+	rte_service_component_monitor_set(hw->service_id,
+					  swdma_service_monitor);
+	hw->service_registered = true;
+
+	return 0;
+}
+
+static int
+swdma_create(const char *name, struct rte_vdev_device *vdev,
+	     const struct swdma_hw *args)
+{
+	struct rte_dma_dev *dev;
+	struct swdma_hw *hw;
+	int socket_id;
+	int ret;
+
+	socket_id = (args->nb_lcores == 0) ? rte_socket_id() :
+		rte_lcore_to_socket_id(args->lcores[0]);
+	dev = rte_dma_pmd_allocate(name, socket_id, sizeof(struct swdma_hw));
+	if (dev == NULL) {
+		SWDMA_LOG(ERR, "Unable to allocate dmadev: %s", name);
+		return -EINVAL;
+	}
+
+	dev->device = &vdev->device;
+	dev->dev_ops = &swdma_ops;
+	dev->fp_obj->dev_private = dev->data->dev_private;
+	dev->fp_obj->copy = swdma_copy;
+	dev->fp_obj->copy_sg = swdma_copy_sg;
+	dev->fp_obj->fill = swdma_fill;
+	dev->fp_obj->submit = swdma_submit;
+	dev->fp_obj->completed = swdma_completed;
+	dev->fp_obj->completed_status = swdma_completed_status;
+	dev->fp_obj->burst_capacity = swdma_burst_capacity;
+
+	hw = dev->data->dev_private;
+	hw->socket_id = socket_id;
+	hw->nt_threshold = args->nt_threshold;
+	hw->nb_lcores = args->nb_lcores;
+	memcpy(hw->lcores, args->lcores, sizeof(hw->lcores));
+
+	if (hw->nb_lcores == 0) {
+		ret = swdma_service_register(name, hw);
+		if (ret != 0) {
+			rte_dma_pmd_release(name);
+			return ret;
+		}
+	}
+
+	dev->state = RTE_DMA_DEV_READY;
+
+	return dev->data->dev_id;
+}
+
+static int
+swdma_parse_lcore(const char *key __rte_unused, const char *value,
+		  void *opaque)
+{
+	struct swdma_hw *args = opaque;
+	int lcore_id = atoi(value);
+	uint16_t i;
+
+	if (lcore_id < 0 || lcore_id >= RTE_MAX_LCORE ||
+	    !rte_lcore_is_enabled(lcore_id) ||
+	    (unsigned int)lcore_id == rte_get_main_lcore() ||
+	    args->nb_lcores == SWDMA_MAX_LCORES)
+		return -EINVAL;
+
+	for (i = 0; i < args->nb_lcores; i++)
+		if (args->lcores[i] == (unsigned int)lcore_id)
+			return -EINVAL;
+
+	args->lcores[args->nb_lcores++] = lcore_id;
+
+	return 0;
+}
+
+static int
+swdma_parse_nt_threshold(const char *key __rte_unused, const char *value,
+			 void *opaque)
+{
+	char *end;
+	unsigned long threshold = strtoul(value, &end, 0);
+
+	if (*value == '\0' || *end != '\0' || threshold > UINT32_MAX)
+		return -EINVAL;
+
+	*(uint32_t *)opaque = threshold;
+
+	return 0;
+}
+
+static int
+swdma_parse_vdev_args(struct rte_vdev_device *vdev, struct swdma_hw *args)
+{
+	static const char *const valid_args[] = {
+		SWDMA_ARG_LCORE,
+		SWDMA_ARG_NT_THRESHOLD,
+		NULL
+	};
+
+	struct rte_kvargs *kvlist;
+	const char *params;
+	int ret;
+
+	params = rte_vdev_device_args(vdev);
+	if (params == NULL || params[0] == '\0')
+		return 0;
+
+	kvlist = rte_kvargs_parse(params, valid_args);
+	if (!kvlist)
+		return -EINVAL;
+
+	ret = rte_kvargs_process(kvlist, SWDMA_ARG_LCORE,
+				 swdma_parse_lcore, args);
+	if (ret != 0) {
+		SWDMA_LOG(ERR, "Invalid %s", SWDMA_ARG_LCORE);
+		goto out;
+	}
+
+	ret = rte_kvargs_process(kvlist, SWDMA_ARG_NT_THRESHOLD,
+				 swdma_parse_nt_threshold,
+				 &args->nt_threshold);
+	if (ret != 0)
+		SWDMA_LOG(ERR, "Invalid %s", SWDMA_ARG_NT_THRESHOLD);
+
+out:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int
+swdma_probe(struct rte_vdev_device *vdev)
+{
+	struct swdma_hw args = {
+		.nt_threshold = SWDMA_DEFAULT_NT_THRESHOLD,
+	};
+	const char *name;
+	int ret;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -EINVAL;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		SWDMA_LOG(ERR, "Multiple process not supported for %s", name);
+		return -EINVAL;
+	}
+
+	ret = swdma_parse_vdev_args(vdev, &args);
+	if (ret != 0)
+		return ret;
+
+	ret = swdma_create(name, vdev, &args);
+	if (ret >= 0)
+		SWDMA_LOG(INFO, "Create %s dmadev with %u worker lcore(s)",
+			  name, args.nb_lcores);
+
+	return ret < 0 ? ret : 0;
+}
+
+static int
+swdma_remove(struct rte_vdev_device *vdev)
+{
+	const char *name;
+	int ret;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -1;
+
+	/* Closes the device, which also unregisters the service. */
+	ret = rte_dma_pmd_release(name);
+	if (!ret)
+		SWDMA_LOG(INFO, "Remove %s dmadev", name);
+
+	return ret;
+}
+
+static struct rte_vdev_driver swdma_pmd_drv = {
+	.probe = swdma_probe,
+	.remove = swdma_remove,
+	.drv_flags = RTE_VDEV_DRV_NEED_IOVA_AS_VA,
+};
+
+RTE_PMD_REGISTER_VDEV(dma_sw, swdma_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(dma_sw,
+		SWDMA_ARG_LCORE "=<uint16> "
+		SWDMA_ARG_NT_THRESHOLD "=<uint32> ");
@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef SW_DMADEV_H
+#define SW_DMADEV_H
+
+#include <stdbool.h>
+
+#include <rte_common.h>
+#include <rte_dmadev.h>
+#include <rte_spinlock.h>
+
+#define SWDMA_ARG_LCORE		"lcore"
+#define SWDMA_ARG_NT_THRESHOLD	"nt_threshold"
+
+#define SWDMA_MAX_VCHANS	8
+#define SWDMA_MAX_LCORES	SWDMA_MAX_VCHANS
+#define SWDMA_MAX_DESC		8192
+#define SWDMA_MIN_DESC		32
+#define SWDMA_MAX_SGES		4
+
+/* Number of descriptors a worker processes on a vchan before moving
+ * on to the next one, and publishing their completion.
+ */
+#define SWDMA_WORKER_BURST	32
+
+/* Copies of at least this many bytes bypass the cache, unless the
+ * operation carries RTE_DMA_OP_FLAG_LLC.
+ */
+#define SWDMA_DEFAULT_NT_THRESHOLD	4096
+
+enum swdma_op {
+	SWDMA_OP_COPY,
+	SWDMA_OP_COPY_SG,
+	SWDMA_OP_FILL,
+};
+
+struct swdma_desc {
+	uint8_t op; /* enum swdma_op */
+	uint8_t nb_src;
+	uint8_t nb_dst;
+	uint8_t llc; /* RTE_DMA_OP_FLAG_LLC was given */
+	uint16_t status; /* enum rte_dma_status_code, set by the worker */
+	uint32_t len;
+	union {
+		rte_iova_t src;
+		uint64_t pattern;
+	};
+	rte_iova_t dst;
+};
+
+/* Each vchan is a single-producer, single-consumer descriptor ring
+ * between the application thread and whichever worker holds the
+ * vchan lock. All indexes are free running 16-bit counters, matching
+ * the dmadev ring_idx space:
+ *
+ *   read_idx <= done_idx <= submit_idx <= write_idx
+ *
+ * [read_idx, done_idx) are completed, awaiting rte_dma_completed(),
+ * [done_idx, submit_idx) are submitted, awaiting a worker, and
+ * [submit_idx, write_idx) are enqueued, awaiting rte_dma_submit().
+ */
+struct swdma_vchan {
+	struct swdma_desc *desc;
+	struct rte_dma_sge *sges; /* 2 * SWDMA_MAX_SGES per descriptor */
+	uint16_t nb_desc;
+	uint16_t mask;
+
+	/* Application side */
+	uint16_t write_idx __rte_cache_aligned;
+	uint16_t read_idx;
+	uint64_t submitted;
+	uint64_t completed;
+	uint64_t errors;
+
+	/* Doorbell, written by the application */
+	volatile uint16_t submit_idx __rte_cache_aligned;
+
+	/* Worker side */
+	volatile uint16_t done_idx __rte_cache_aligned;
+	rte_spinlock_t lock;
+};
+
+struct swdma_hw {
+	int socket_id;
+	uint32_t nt_threshold;
+	uint16_t nb_vchans;
+	volatile bool started;
+
+	/* Dedicated lcore workers, if any; otherwise the copies run in
+	 * a service.
+	 */
+	uint16_t nb_lcores;
+	unsigned int lcores[SWDMA_MAX_LCORES];
+	volatile bool lcore_exit;
+
+	uint32_t service_id;
+	bool service_registered;
+
+	struct swdma_vchan vchans[SWDMA_MAX_VCHANS];
+};
+
+#endif /* SW_DMADEV_H */
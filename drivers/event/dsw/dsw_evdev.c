@@ -2,11 +2,15 @@
  * Copyright(c) 2018 Ericsson AB
  */
 
+#include <ctype.h>
+#include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include <rte_cycles.h>
 #include <eventdev_pmd.h>
 #include <eventdev_pmd_vdev.h>
+#include <rte_kvargs.h>
 #include <rte_random.h>
 #include <rte_ring_elem.h>
 
@@ -14,6 +18,14 @@
 
 #define EVENTDEV_NAME_DSW_PMD event_dsw
 
+#define MIN_SOURCE_LOAD_ARG "min_source_load"
+#define MAX_TARGET_LOAD_ARG "max_target_load"
+#define REBALANCE_THRESHOLD_ARG "rebalance_threshold"
+#define LOAD_HYSTERESIS_ARG "load_hysteresis"
+#define MAX_FLOWS_PER_MIGRATION_ARG "max_flows_per_migration"
+#define IMMIGRATION_HOLD_ARG "immigration_hold"
+#define OUT_BUFFER_LATENCY_ARG "out_buffer_latency"
+
 static int
 dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	       const struct rte_event_port_conf *conf)
@@ -31,7 +43,8 @@ dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		.dsw = dsw,
 		.dequeue_depth = conf->dequeue_depth,
 		.enqueue_depth = conf->enqueue_depth,
-		.new_event_threshold = conf->new_event_threshold
+		.new_event_threshold = conf->new_event_threshold,
+		.out_buffer_limit = DSW_MAX_PORT_OUT_BUFFER
 	};
 
 	snprintf(ring_name, sizeof(ring_name), "dsw%d_p%u", dev->data->dev_id,
@@ -67,6 +80,12 @@ dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	port->migration_interval =
 		(DSW_MIGRATION_INTERVAL * rte_get_timer_hz()) / US_PER_S;
 
+	port->immigration_hold =
+		(dsw->immigration_hold * rte_get_timer_hz()) / US_PER_S;
+
+	port->out_buffer_latency =
+		(dsw->out_buffer_latency * rte_get_timer_hz()) / US_PER_S;
+
 	dev->data->ports[port_id] = port;
 
 	return 0;
@@ -280,6 +299,7 @@ dsw_start(struct rte_eventdev *dev)
 	for (i = 0; i < dsw->num_ports; i++) {
 		dsw->ports[i].measurement_start = now;
 		dsw->ports[i].busy_start = now;
+		dsw->ports[i].last_bg = now;
 	}
 
 	return 0;
@@ -363,6 +383,10 @@ static int
 dsw_close(struct rte_eventdev *dev)
 {
 	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	uint16_t port_id;
+
+	for (port_id = 0; port_id < dsw->num_ports; port_id++)
+		dsw_port_release(&dsw->ports[port_id]);
 
 	dsw->num_ports = 0;
 	dsw->num_queues = 0;
@@ -417,15 +441,144 @@ static struct eventdev_ops dsw_evdev_ops = {
 	.crypto_adapter_caps_get = dsw_crypto_adapter_caps_get,
 	.xstats_get = dsw_xstats_get,
 	.xstats_get_names = dsw_xstats_get_names,
-	.xstats_get_by_name = dsw_xstats_get_by_name
+	.xstats_get_by_name = dsw_xstats_get_by_name,
+	.dev_selftest = test_dsw_eventdev
 };
 
+/* Parses a decimal integer, rejecting signs, trailing characters and
+ * values out of [min, max].
+ */
+static int
+parse_uint(const char *value, unsigned long min, unsigned long max,
+	   unsigned long *v)
+{
+	char *end;
+
+	if (!isdigit((unsigned char)value[0]))
+		return -1;
+
+	errno = 0;
+	*v = strtoul(value, &end, 10);
+	if (errno != 0 || *end != '\0' || *v < min || *v > max)
+		return -1;
+
+	return 0;
+}
+
+static int
+set_load_percent(const char *key __rte_unused, const char *value,
+		 void *opaque)
+{
+	int16_t *load = opaque;
+	unsigned long percent;
+
+	if (parse_uint(value, 0, 100, &percent) < 0)
+		return -1;
+	*load = DSW_LOAD_FROM_PERCENT(percent);
+	return 0;
+}
+
+static int
+set_max_flows_per_migration(const char *key __rte_unused, const char *value,
+			    void *opaque)
+{
+	uint8_t *max_flows = opaque;
+	unsigned long flows;
+
+	if (parse_uint(value, 1, DSW_MAX_FLOWS_PER_MIGRATION, &flows) < 0)
+		return -1;
+	*max_flows = flows;
+	return 0;
+}
+
+static int
+set_us(const char *key __rte_unused, const char *value, void *opaque)
+{
+	uint32_t *us = opaque;
+	unsigned long v;
+
+	if (parse_uint(value, 0, UINT32_MAX, &v) < 0)
+		return -1;
+	*us = v;
+	return 0;
+}
+
+static int
+dsw_parse_args(const char *name, const char *params, struct dsw_evdev *dsw)
+{
+	static const char *const args[] = {
+		MIN_SOURCE_LOAD_ARG,
+		MAX_TARGET_LOAD_ARG,
+		REBALANCE_THRESHOLD_ARG,
+		LOAD_HYSTERESIS_ARG,
+		MAX_FLOWS_PER_MIGRATION_ARG,
+		IMMIGRATION_HOLD_ARG,
+		OUT_BUFFER_LATENCY_ARG,
+		NULL
+	};
+	static const struct {
+		const char *key;
+		arg_handler_t handler;
+		size_t offset;
+	} handlers[] = {
+		{ MIN_SOURCE_LOAD_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, min_source_load) },
+		{ MAX_TARGET_LOAD_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, max_target_load) },
+		{ REBALANCE_THRESHOLD_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, rebalance_threshold) },
+		{ LOAD_HYSTERESIS_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, load_hysteresis) },
+		{ MAX_FLOWS_PER_MIGRATION_ARG, set_max_flows_per_migration,
+		  offsetof(struct dsw_evdev, max_flows_per_migration) },
+		{ IMMIGRATION_HOLD_ARG, set_us,
+		  offsetof(struct dsw_evdev, immigration_hold) },
+		{ OUT_BUFFER_LATENCY_ARG, set_us,
+		  offsetof(struct dsw_evdev, out_buffer_latency) }
+	};
+	struct rte_kvargs *kvlist;
+	unsigned int i;
+
+	dsw->min_source_load = DSW_MIN_SOURCE_LOAD_FOR_MIGRATION;
+	dsw->max_target_load = DSW_MAX_TARGET_LOAD_FOR_MIGRATION;
+	dsw->rebalance_threshold = DSW_REBALANCE_THRESHOLD;
+	dsw->load_hysteresis = 0;
+	dsw->max_flows_per_migration = DSW_MAX_FLOWS_PER_MIGRATION;
+	dsw->immigration_hold = DSW_IMMIGRATION_HOLD;
+	dsw->out_buffer_latency = DSW_OUT_BUFFER_LATENCY;
+
+	if (params == NULL || params[0] == '\0')
+		return 0;
+
+	kvlist = rte_kvargs_parse(params, args);
+	if (kvlist == NULL) {
+		RTE_EDEV_LOG_ERR("%s: invalid parameters '%s'", name, params);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < RTE_DIM(handlers); i++) {
+		if (rte_kvargs_process(kvlist, handlers[i].key,
+				       handlers[i].handler,
+				       (char *)dsw + handlers[i].offset) != 0) {
+			RTE_EDEV_LOG_ERR("%s: invalid value for %s", name,
+					 handlers[i].key);
+			rte_kvargs_free(kvlist);
+			return -EINVAL;
+		}
+	}
+
+	rte_kvargs_free(kvlist);
+
+	return 0;
+}
+
 static int
 dsw_probe(struct rte_vdev_device *vdev)
 {
 	const char *name;
 	struct rte_eventdev *dev;
 	struct dsw_evdev *dsw;
+	int rc;
 
 	name = rte_vdev_device_name(vdev);
 
@@ -449,6 +602,12 @@ dsw_probe(struct rte_vdev_device *vdev)
 	dsw = dev->data->dev_private;
 	dsw->data = dev->data;
 
+	rc = dsw_parse_args(name, rte_vdev_device_args(vdev), dsw);
+	if (rc != 0) {
+		rte_event_pmd_vdev_uninit(name);
+		return rc;
+	}
+
 	event_dev_probing_finish(dev);
 	return 0;
 }
@@ -471,3 +630,8 @@ static struct rte_vdev_driver evdev_dsw_pmd_drv = {
 };
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_DSW_PMD, evdev_dsw_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(event_dsw, MIN_SOURCE_LOAD_ARG "=<int> "
+		MAX_TARGET_LOAD_ARG "=<int> " REBALANCE_THRESHOLD_ARG "=<int> "
+		LOAD_HYSTERESIS_ARG "=<int> "
+		MAX_FLOWS_PER_MIGRATION_ARG "=<int> "
+		IMMIGRATION_HOLD_ARG "=<int> " OUT_BUFFER_LATENCY_ARG "=<int>");
@@ -16,6 +16,7 @@
 #define DSW_MAX_PORT_DEQUEUE_DEPTH (128)
 #define DSW_MAX_PORT_ENQUEUE_DEPTH (128)
 #define DSW_MAX_PORT_OUT_BUFFER (32)
+#define DSW_MIN_PORT_OUT_BUFFER (4)
 
 #define DSW_MAX_QUEUES (16)
 
@@ -101,6 +102,22 @@
 
 #define DSW_MAX_FLOWS_PER_MIGRATION (8)
 
+/* A port which has recently had flows migrated to it won't consider
+ * emigration until this hold time (in us) has passed, to avoid
+ * flows bouncing back and forth between ports with bursty
+ * load. Zero disables the hold time.
+ */
+#define DSW_IMMIGRATION_HOLD (0)
+
+/* Target for the maximum time (in us) an event may spend in a port's
+ * output buffer. The port measures how long the events it flushes
+ * were buffered, and adapts the output buffer flush threshold, within
+ * [DSW_MIN_PORT_OUT_BUFFER, DSW_MAX_PORT_OUT_BUFFER], to meet it.
+ * Zero disables adaptation, and the output buffers are only flushed
+ * when full, or by the background task.
+ */
+#define DSW_OUT_BUFFER_LATENCY (0)
+
 /* Only one outstanding migration per port is allowed */
 #define DSW_MAX_PAUSED_FLOWS (DSW_MAX_PORTS*DSW_MAX_FLOWS_PER_MIGRATION)
 
@@ -174,6 +191,21 @@ struct dsw_port {
 	uint64_t emigration_start;
 	uint64_t emigrations;
 	uint64_t emigration_latency;
+	uint64_t emigration_latency_max;
+
+	/* Events held back in the paused buffer, and events moved
+	 * to another port's in_ring, as a result of flow migration.
+	 */
+	uint64_t migration_held_events;
+	uint64_t migration_forwarded_events;
+	/* Sum of the times the held events spent in the paused buffer. */
+	uint64_t migration_hold_cycles;
+
+	/* Above the source load watermark, with hysteresis applied. */
+	bool overloaded;
+
+	uint64_t immigration_hold;
+	uint64_t immigration_hold_end;
 
 	uint8_t emigration_target_port_ids[DSW_MAX_FLOWS_PER_MIGRATION];
 	struct dsw_queue_flow
@@ -185,6 +217,7 @@ struct dsw_port {
 
 	uint16_t paused_flows_len;
 	struct dsw_queue_flow paused_flows[DSW_MAX_PAUSED_FLOWS];
+	uint64_t paused_flows_start[DSW_MAX_PAUSED_FLOWS];
 
 	/* In a very contrived worst case all inflight events can be
 	 * laying around paused here.
@@ -206,6 +239,14 @@ struct dsw_port {
 	uint64_t dequeued;
 	uint64_t queue_dequeued[DSW_MAX_QUEUES];
 
+	/* Adaptive output buffer flush threshold, and the longest time
+	 * events spent in the output buffers since the last adaptation.
+	 */
+	uint16_t out_buffer_limit;
+	uint64_t out_buffer_latency;
+	uint64_t out_buffer_delay_max;
+
+	uint64_t out_buffer_start[DSW_MAX_PORTS];
 	uint16_t out_buffer_len[DSW_MAX_PORTS];
 	struct rte_event out_buffer[DSW_MAX_PORTS][DSW_MAX_PORT_OUT_BUFFER];
 
@@ -243,6 +284,15 @@ struct dsw_evdev {
 	uint8_t num_queues;
 	int32_t max_inflight;
 
+	/* Migration and output buffering parameters, set by devargs. */
+	int16_t min_source_load;
+	int16_t max_target_load;
+	int16_t rebalance_threshold;
+	int16_t load_hysteresis;
+	uint8_t max_flows_per_migration;
+	uint32_t immigration_hold;
+	uint32_t out_buffer_latency;
+
 	int32_t credits_on_loan __rte_cache_aligned;
 };
 
@@ -284,6 +334,8 @@ int dsw_xstats_get(const struct rte_eventdev *dev,
 uint64_t dsw_xstats_get_by_name(const struct rte_eventdev *dev,
 				const char *name, unsigned int *id);
 
+int test_dsw_eventdev(void);
+
 static inline struct dsw_evdev *
 dsw_pmd_priv(const struct rte_eventdev *eventdev)
 {
@@ -0,0 +1,409 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_eventdev.h>
+#include <eventdev_pmd.h>
+
+#include "dsw_evdev.h"
+
+#define TEST_DEV_NAME "event_dsw_selftest"
+#define TEST_QUEUE_ID (0)
+#define TEST_MAINTAIN_ITERATIONS (1000)
+
+static int
+test_devargs_rejected(const char *args)
+{
+	if (rte_vdev_init(TEST_DEV_NAME, args) == 0) {
+		printf("%d: devargs '%s' accepted\n", __LINE__, args);
+		rte_vdev_uninit(TEST_DEV_NAME);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_devargs(void)
+{
+	struct dsw_evdev *dsw;
+	int dev_id;
+	int ret = 0;
+
+	if (rte_vdev_init(TEST_DEV_NAME, "min_source_load=50,"
+			  "max_target_load=80,rebalance_threshold=5,"
+			  "load_hysteresis=10,max_flows_per_migration=2,"
+			  "immigration_hold=5000,out_buffer_latency=20") < 0) {
+		printf("%d: error creating eventdev\n", __LINE__);
+		return -1;
+	}
+
+	dev_id = rte_event_dev_get_dev_id(TEST_DEV_NAME);
+	dsw = dsw_pmd_priv(&rte_eventdevs[dev_id]);
+
+	if (dsw->min_source_load != DSW_LOAD_FROM_PERCENT(50) ||
+	    dsw->max_target_load != DSW_LOAD_FROM_PERCENT(80) ||
+	    dsw->rebalance_threshold != DSW_LOAD_FROM_PERCENT(5) ||
+	    dsw->load_hysteresis != DSW_LOAD_FROM_PERCENT(10) ||
+	    dsw->max_flows_per_migration != 2 ||
+	    dsw->immigration_hold != 5000 ||
+	    dsw->out_buffer_latency != 20) {
+		printf("%d: devargs not applied\n", __LINE__);
+		ret = -1;
+	}
+
+	rte_vdev_uninit(TEST_DEV_NAME);
+
+	if (ret != 0)
+		return ret;
+
+	if (test_devargs_rejected("min_source_load=150") < 0 ||
+	    test_devargs_rejected("load_hysteresis=-1") < 0 ||
+	    test_devargs_rejected("max_flows_per_migration=0") < 0 ||
+	    test_devargs_rejected("max_flows_per_migration=9") < 0 ||
+	    test_devargs_rejected("immigration_hold=-5") < 0 ||
+	    test_devargs_rejected("immigration_hold=") < 0 ||
+	    test_devargs_rejected("out_buffer_latency=abc") < 0 ||
+	    test_devargs_rejected("out_buffer_latency=10us") < 0 ||
+	    test_devargs_rejected("out_buffer_latency=99999999999") < 0 ||
+	    test_devargs_rejected("rebalance_threshold=+5") < 0 ||
+	    test_devargs_rejected("no_such_arg=1") < 0)
+		return -1;
+
+	return 0;
+}
+
+/* Sets up a started device with two ports, both linked to a single
+ * atomic queue.
+ */
+static int
+init(const char *args)
+{
+	struct rte_event_dev_config config = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 2,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 32,
+		.nb_event_port_enqueue_depth = 32,
+	};
+	struct rte_event_queue_conf queue_conf = {
+		.schedule_type = RTE_SCHED_TYPE_ATOMIC,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	int dev_id;
+	uint8_t port_id;
+
+	if (rte_vdev_init(TEST_DEV_NAME, args) < 0) {
+		printf("%d: error creating eventdev\n", __LINE__);
+		return -1;
+	}
+
+	dev_id = rte_event_dev_get_dev_id(TEST_DEV_NAME);
+
+	if (rte_event_dev_configure(dev_id, &config) < 0 ||
+	    rte_event_queue_setup(dev_id, TEST_QUEUE_ID, &queue_conf) < 0) {
+		printf("%d: error configuring eventdev\n", __LINE__);
+		goto err;
+	}
+
+	for (port_id = 0; port_id < 2; port_id++)
+		if (rte_event_port_setup(dev_id, port_id, NULL) < 0 ||
+		    rte_event_port_link(dev_id, port_id, NULL, NULL, 0) != 1) {
+			printf("%d: error setting up port %d\n", __LINE__,
+			       port_id);
+			goto err;
+		}
+
+	if (rte_event_dev_start(dev_id) < 0) {
+		printf("%d: error starting eventdev\n", __LINE__);
+		goto err;
+	}
+
+	return dev_id;
+
+err:
+	rte_vdev_uninit(TEST_DEV_NAME);
+	return -1;
+}
+
+static void
+cleanup(int dev_id)
+{
+	rte_event_dev_stop(dev_id);
+	rte_event_dev_close(dev_id);
+	rte_vdev_uninit(TEST_DEV_NAME);
+}
+
+/* Have the next maintain call on the port run the background task. */
+static void
+force_bg_task(struct dsw_port *port)
+{
+	port->ops_since_bg_task = DSW_MAX_PORT_OPS_PER_BG_TASK;
+}
+
+static uint64_t
+port_xstat(int dev_id, uint8_t port_id, const char *fmt)
+{
+	char name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+
+	snprintf(name, sizeof(name), fmt, port_id);
+
+	return rte_event_dev_xstats_by_name_get(dev_id, name, NULL);
+}
+
+static int
+drain_port(int dev_id, uint8_t port_id, uint16_t expected)
+{
+	struct rte_event ev;
+	uint16_t received = 0;
+	int i;
+
+	for (i = 0; i < TEST_MAINTAIN_ITERATIONS && received < expected; i++)
+		received += rte_event_dequeue_burst(dev_id, port_id, &ev, 1, 0);
+
+	/* Release the last dequeued event, if any. */
+	rte_event_dequeue_burst(dev_id, port_id, &ev, 1, 0);
+
+	if (received != expected) {
+		printf("%d: port %d received %d events, expected %d\n",
+		       __LINE__, port_id, received, expected);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Drive the emigration of one of two flows from a port that claims
+ * to be overloaded to an idle port, and check that the load
+ * hysteresis and the immigration hold time defer emigration, that
+ * an event on the migrating flow is held back and accounted for,
+ * and that the receiving port starts its own hold time.
+ */
+static int
+test_migration(void)
+{
+	struct dsw_evdev *dsw;
+	struct dsw_port *source;
+	struct dsw_port *target;
+	struct dsw_queue_flow *qf;
+	struct rte_event ev = {
+		.op = RTE_EVENT_OP_NEW,
+		.queue_id = TEST_QUEUE_ID,
+		.sched_type = RTE_SCHED_TYPE_ATOMIC,
+	};
+	uint16_t i;
+	uint64_t now;
+	int dev_id;
+	int ret = -1;
+
+	dev_id = init("load_hysteresis=10,immigration_hold=5000");
+	if (dev_id < 0)
+		return -1;
+
+	dsw = dsw_pmd_priv(&rte_eventdevs[dev_id]);
+	source = &dsw->ports[0];
+	target = &dsw->ports[1];
+
+	/* Two equally-sized flows, both served by the source port. */
+	for (i = 0; i < DSW_MAX_EVENTS_RECORDED; i++) {
+		source->seen_events[i] = (struct dsw_queue_flow) {
+			.queue_id = TEST_QUEUE_ID,
+			.flow_hash = 1 + (i % 2)
+		};
+	}
+	dsw->queues[TEST_QUEUE_ID].flow_to_port_map[1] = source->id;
+	dsw->queues[TEST_QUEUE_ID].flow_to_port_map[2] = source->id;
+
+	/* Freeze the load estimates. */
+	source->next_load_update = UINT64_MAX;
+	target->next_load_update = UINT64_MAX;
+	target->load = 0;
+
+	/* Above the watermark, but not above the hysteresis. */
+	source->load = DSW_LOAD_FROM_PERCENT(75);
+	source->seen_events_len = DSW_MAX_EVENTS_RECORDED;
+	source->next_emigration = 0;
+	force_bg_task(source);
+	rte_event_maintain(dev_id, source->id, 0);
+
+	if (source->migration_state != DSW_MIGRATION_STATE_IDLE) {
+		printf("%d: emigration started within load hysteresis\n",
+		       __LINE__);
+		goto out;
+	}
+
+	/* Overloaded, but holding off after an immigration. */
+	source->load = DSW_LOAD_FROM_PERCENT(100);
+	source->immigration_hold_end = UINT64_MAX;
+	source->seen_events_len = DSW_MAX_EVENTS_RECORDED;
+	source->next_emigration = 0;
+	force_bg_task(source);
+	rte_event_maintain(dev_id, source->id, 0);
+
+	if (source->migration_state != DSW_MIGRATION_STATE_IDLE) {
+		printf("%d: emigration started during immigration hold\n",
+		       __LINE__);
+		goto out;
+	}
+
+	source->immigration_hold_end = 0;
+	source->seen_events_len = DSW_MAX_EVENTS_RECORDED;
+	source->next_emigration = 0;
+	force_bg_task(source);
+	rte_event_maintain(dev_id, source->id, 0);
+
+	if (source->migration_state != DSW_MIGRATION_STATE_PAUSING ||
+	    source->emigration_targets_len != 1) {
+		printf("%d: emigration of a single flow not started\n",
+		       __LINE__);
+		goto out;
+	}
+
+	/* An event on the paused flow is held back in the source port,
+	 * and sent to the target port once the migration completes.
+	 */
+	qf = &source->emigration_target_qfs[0];
+	ev.flow_id = qf->flow_hash;
+	if (rte_event_enqueue_burst(dev_id, source->id, &ev, 1) != 1 ||
+	    port_xstat(dev_id, source->id,
+		       "port_%u_migration_held_events") != 1) {
+		printf("%d: event on migrating flow not held\n", __LINE__);
+		goto out;
+	}
+
+	for (i = 0; i < TEST_MAINTAIN_ITERATIONS &&
+		     source->migration_state != DSW_MIGRATION_STATE_IDLE; i++) {
+		rte_event_maintain(dev_id, target->id, 0);
+		rte_event_maintain(dev_id, source->id, 0);
+	}
+
+	now = rte_get_timer_cycles();
+
+	if (source->migration_state != DSW_MIGRATION_STATE_IDLE ||
+	    port_xstat(dev_id, source->id, "port_%u_emigrations") != 1) {
+		printf("%d: emigration did not complete\n", __LINE__);
+		goto out;
+	}
+
+	if (port_xstat(dev_id, target->id, "port_%u_immigrations") != 1 ||
+	    target->immigration_hold_end <= now) {
+		printf("%d: immigration hold not started\n", __LINE__);
+		goto out;
+	}
+
+	if (port_xstat(dev_id, source->id,
+		       "port_%u_migration_reorder_cost") == 0) {
+		printf("%d: reordering cost not accounted\n", __LINE__);
+		goto out;
+	}
+
+	rte_event_maintain(dev_id, source->id, RTE_EVENT_DEV_MAINT_OP_FLUSH);
+
+	if (drain_port(dev_id, target->id, 1) < 0)
+		goto out;
+
+	ret = 0;
+out:
+	cleanup(dev_id);
+	return ret;
+}
+
+/* Check that the output buffer flush threshold shrinks when events
+ * stay in the output buffer beyond the latency target, and grows
+ * back when they do not.
+ */
+static int
+test_out_buffer_limit(void)
+{
+	struct dsw_evdev *dsw;
+	struct dsw_port *port;
+	struct rte_event ev = {
+		.op = RTE_EVENT_OP_NEW,
+		.queue_id = TEST_QUEUE_ID,
+		.sched_type = RTE_SCHED_TYPE_ATOMIC,
+		.flow_id = 1,
+	};
+	uint64_t limit;
+	int dev_id;
+	int ret = -1;
+
+	dev_id = init("out_buffer_latency=10");
+	if (dev_id < 0)
+		return -1;
+
+	dsw = dsw_pmd_priv(&rte_eventdevs[dev_id]);
+	port = &dsw->ports[0];
+	dsw->queues[TEST_QUEUE_ID].flow_to_port_map[1] = 1;
+
+	if (port_xstat(dev_id, port->id, "port_%u_out_buffer_limit") !=
+	    DSW_MAX_PORT_OUT_BUFFER) {
+		printf("%d: unexpected initial limit\n", __LINE__);
+		goto out;
+	}
+
+	if (rte_event_enqueue_burst(dev_id, port->id, &ev, 1) != 1) {
+		printf("%d: error enqueuing event\n", __LINE__);
+		goto out;
+	}
+
+	rte_delay_us_block(100);
+
+	force_bg_task(port);
+	rte_event_maintain(dev_id, port->id, 0);
+
+	limit = port_xstat(dev_id, port->id, "port_%u_out_buffer_limit");
+	if (limit != DSW_MAX_PORT_OUT_BUFFER / 2) {
+		printf("%d: limit %"PRIu64" not reduced\n", __LINE__, limit);
+		goto out;
+	}
+
+	/* No event has lingered since the last adaptation. */
+	force_bg_task(port);
+	rte_event_maintain(dev_id, port->id, 0);
+
+	if (port_xstat(dev_id, port->id, "port_%u_out_buffer_limit") !=
+	    limit + 1) {
+		printf("%d: limit not increased\n", __LINE__);
+		goto out;
+	}
+
+	if (drain_port(dev_id, 1, 1) < 0)
+		goto out;
+
+	ret = 0;
+out:
+	cleanup(dev_id);
+	return ret;
+}
+
+int
+test_dsw_eventdev(void)
+{
+	printf("*** Running devargs test...\n");
+	if (test_devargs() != 0) {
+		printf("ERROR - devargs test FAILED.\n");
+		return -1;
+	}
+
+	printf("*** Running migration test...\n");
+	if (test_migration() != 0) {
+		printf("ERROR - migration test FAILED.\n");
+		return -1;
+	}
+
+	printf("*** Running output buffer limit test...\n");
+	if (test_out_buffer_limit() != 0) {
+		printf("ERROR - output buffer limit test FAILED.\n");
+		return -1;
+	}
+
+	return 0;
+}
@@ -241,6 +241,7 @@ static void
 dsw_port_add_paused_flows(struct dsw_port *port, struct dsw_queue_flow *qfs,
 			  uint8_t qfs_len)
 {
+	uint64_t now = rte_get_timer_cycles();
 	uint8_t i;
 
 	for (i = 0; i < qfs_len; i++) {
@@ -251,14 +252,17 @@ dsw_port_add_paused_flows(struct dsw_port *port, struct dsw_queue_flow *qfs,
 				qf->queue_id, qf->flow_hash);
 
 		port->paused_flows[port->paused_flows_len] = *qf;
+		port->paused_flows_start[port->paused_flows_len] = now;
 		port->paused_flows_len++;
 	};
 }
 
-static void
+/* Returns the time at which the flow was paused. */
+static uint64_t
 dsw_port_remove_paused_flow(struct dsw_port *port,
 			    struct dsw_queue_flow *target_qf)
 {
+	uint64_t start = 0;
 	uint16_t i;
 
 	for (i = 0; i < port->paused_flows_len; i++) {
@@ -267,23 +271,31 @@ dsw_port_remove_paused_flow(struct dsw_port *port,
 		if (qf->queue_id == target_qf->queue_id &&
 		    qf->flow_hash == target_qf->flow_hash) {
 			uint16_t last_idx = port->paused_flows_len-1;
-			if (i != last_idx)
+
+			start = port->paused_flows_start[i];
+			if (i != last_idx) {
 				port->paused_flows[i] =
 					port->paused_flows[last_idx];
+				port->paused_flows_start[i] =
+					port->paused_flows_start[last_idx];
+			}
 			port->paused_flows_len--;
 			break;
 		}
 	}
+
+	return start;
 }
 
 static void
 dsw_port_remove_paused_flows(struct dsw_port *port,
-			     struct dsw_queue_flow *qfs, uint8_t qfs_len)
+			     struct dsw_queue_flow *qfs, uint8_t qfs_len,
+			     uint64_t *starts)
 {
 	uint8_t i;
 
 	for (i = 0; i < qfs_len; i++)
-		dsw_port_remove_paused_flow(port, &qfs[i]);
+		starts[i] = dsw_port_remove_paused_flow(port, &qfs[i]);
 
 }
 
@@ -394,18 +406,18 @@ dsw_flow_load(uint16_t num_events, int16_t port_load)
 }
 
 static int16_t
-dsw_evaluate_migration(int16_t source_load, int16_t target_load,
-		       int16_t flow_load)
+dsw_evaluate_migration(struct dsw_evdev *dsw, int16_t source_load,
+		       int16_t target_load, int16_t flow_load)
 {
 	int32_t res_target_load;
 	int32_t imbalance;
 
-	if (target_load > DSW_MAX_TARGET_LOAD_FOR_MIGRATION)
+	if (target_load > dsw->max_target_load)
 		return -1;
 
 	imbalance = source_load - target_load;
 
-	if (imbalance < DSW_REBALANCE_THRESHOLD)
+	if (imbalance < dsw->rebalance_threshold)
 		return -1;
 
 	res_target_load = target_load + flow_load;
@@ -453,7 +465,7 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 	int16_t candidate_flow_load = -1;
 	uint16_t i;
 
-	if (source_port_load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION)
+	if (source_port_load < dsw->min_source_load)
 		return false;
 
 	for (i = 0; i < num_bursts; i++) {
@@ -477,7 +489,7 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 			if (!dsw_is_serving_port(dsw, port_id, qf->queue_id))
 				continue;
 
-			weight = dsw_evaluate_migration(source_port_load,
+			weight = dsw_evaluate_migration(dsw, source_port_load,
 							port_loads[port_id],
 							flow_load);
 
@@ -524,7 +536,7 @@ dsw_select_emigration_targets(struct dsw_evdev *dsw,
 	uint8_t *targets_len = &source_port->emigration_targets_len;
 	uint16_t i;
 
-	for (i = 0; i < DSW_MAX_FLOWS_PER_MIGRATION; i++) {
+	for (i = 0; i < dsw->max_flows_per_migration; i++) {
 		bool found;
 
 		found = dsw_select_emigration_target(dsw, bursts, num_bursts,
@@ -575,6 +587,14 @@ dsw_port_transmit_buffered(struct dsw_evdev *dsw, struct dsw_port *source_port,
 	if (*buffer_len == 0)
 		return;
 
+	if (source_port->out_buffer_latency != 0) {
+		uint64_t delay = rte_get_timer_cycles() -
+			source_port->out_buffer_start[dest_port_id];
+
+		source_port->out_buffer_delay_max =
+			RTE_MAX(source_port->out_buffer_delay_max, delay);
+	}
+
 	/* The rings are dimensioned to fit all in-flight events (even
 	 * on a single ring), so looping will work.
 	 */
@@ -615,9 +635,13 @@ dsw_port_buffer_non_paused(struct dsw_evdev *dsw, struct dsw_port *source_port,
 	struct rte_event *buffer = source_port->out_buffer[dest_port_id];
 	uint16_t *buffer_len = &source_port->out_buffer_len[dest_port_id];
 
-	if (*buffer_len == DSW_MAX_PORT_OUT_BUFFER)
+	if (*buffer_len >= source_port->out_buffer_limit)
 		dsw_port_transmit_buffered(dsw, source_port, dest_port_id);
 
+	if (*buffer_len == 0 && source_port->out_buffer_latency != 0)
+		source_port->out_buffer_start[dest_port_id] =
+			rte_get_timer_cycles();
+
 	buffer[*buffer_len] = *event;
 
 	(*buffer_len)++;
@@ -669,6 +693,7 @@ dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *source_port,
 
 	if (unlikely(dsw_port_is_flow_paused(source_port, event->queue_id,
 					     flow_hash))) {
+		source_port->migration_held_events++;
 		dsw_port_buffer_paused(source_port, event);
 		return;
 	}
@@ -681,10 +706,12 @@ dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *source_port,
 static void
 dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 			     struct dsw_port *source_port,
-			     const struct dsw_queue_flow *qf)
+			     const struct dsw_queue_flow *qf,
+			     uint64_t paused_start)
 {
 	uint16_t paused_events_len = source_port->paused_events_len;
 	struct rte_event paused_events[paused_events_len];
+	uint16_t num_held = 0;
 	uint8_t dest_port_id;
 	uint16_t i;
 
@@ -708,12 +735,19 @@ dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 		flow_hash = dsw_flow_id_hash(event->flow_id);
 
 		if (event->queue_id == qf->queue_id &&
-		    flow_hash == qf->flow_hash)
+		    flow_hash == qf->flow_hash) {
 			dsw_port_buffer_non_paused(dsw, source_port,
 						   dest_port_id, event);
-		else
+			num_held++;
+		} else
 			dsw_port_buffer_paused(source_port, event);
 	}
+
+	/* The events of the flow were held back at most since the
+	 * flow was paused.
+	 */
+	source_port->migration_hold_cycles += num_held *
+		(rte_get_timer_cycles() - paused_start);
 }
 
 static void
@@ -725,6 +759,9 @@ dsw_port_emigration_stats(struct dsw_port *port, uint8_t finished)
 		(rte_get_timer_cycles() - port->emigration_start);
 	port->emigration_latency += (flow_migration_latency * finished);
 	port->emigrations += finished;
+
+	if (flow_migration_latency > port->emigration_latency_max)
+		port->emigration_latency_max = flow_migration_latency;
 }
 
 static void
@@ -757,8 +794,11 @@ dsw_port_end_emigration(struct dsw_evdev *dsw, struct dsw_port *port,
 				flow_hash);
 
 		if (queue_schedule_type == RTE_SCHED_TYPE_ATOMIC) {
-			dsw_port_remove_paused_flow(port, qf);
-			dsw_port_flush_paused_events(dsw, port, qf);
+			uint64_t paused_start;
+
+			paused_start = dsw_port_remove_paused_flow(port, qf);
+			dsw_port_flush_paused_events(dsw, port, qf,
+						     paused_start);
 		}
 	}
 
@@ -807,6 +847,24 @@ dsw_port_move_parallel_flows(struct dsw_evdev *dsw,
 	dsw_port_end_emigration(dsw, source_port, RTE_SCHED_TYPE_PARALLEL);
 }
 
+/* Apply hysteresis to the source port load watermark: a port must
+ * rise load_hysteresis above it to start emigrating flows, and then
+ * keeps doing so until its load falls below the watermark.
+ */
+static bool
+dsw_port_is_overloaded(struct dsw_evdev *dsw, struct dsw_port *port,
+		       int16_t load)
+{
+	int32_t threshold = dsw->min_source_load;
+
+	if (!port->overloaded)
+		threshold += dsw->load_hysteresis;
+
+	port->overloaded = load >= threshold;
+
+	return port->overloaded;
+}
+
 static void
 dsw_port_consider_emigration(struct dsw_evdev *dsw,
 			     struct dsw_port *source_port,
@@ -845,6 +903,12 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 		return;
 	}
 
+	if (now < source_port->immigration_hold_end) {
+		DSW_LOG_DP_PORT(DEBUG, source_port->id, "Flows recently "
+				"immigrated; holding off emigration.\n");
+		return;
+	}
+
 	/* For simplicity, avoid migration in the unlikely case there
 	 * is still events to consume in the in_buffer (from the last
 	 * emigration).
@@ -857,11 +921,11 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 
 	source_port_load =
 		__atomic_load_n(&source_port->load, __ATOMIC_RELAXED);
-	if (source_port_load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION) {
+	if (!dsw_port_is_overloaded(dsw, source_port, source_port_load)) {
 		DSW_LOG_DP_PORT(DEBUG, source_port->id,
 		      "Load %d is below threshold level %d.\n",
 		      DSW_LOAD_TO_PERCENT(source_port_load),
-		      DSW_LOAD_TO_PERCENT(DSW_MIN_SOURCE_LOAD_FOR_MIGRATION));
+		      DSW_LOAD_TO_PERCENT(dsw->min_source_load));
 		return;
 	}
 
@@ -870,7 +934,7 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 	 */
 	any_port_below_limit =
 		dsw_retrieve_port_loads(dsw, port_loads,
-					DSW_MAX_TARGET_LOAD_FOR_MIGRATION);
+					dsw->max_target_load);
 	if (!any_port_below_limit) {
 		DSW_LOG_DP_PORT(DEBUG, source_port->id,
 				"Candidate target ports are all too highly "
@@ -929,7 +993,8 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 static void
 dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 			     struct dsw_port *source_port,
-			     const struct dsw_queue_flow *qf);
+			     const struct dsw_queue_flow *qf,
+			     uint64_t paused_start);
 
 static void
 dsw_port_handle_unpause_flows(struct dsw_evdev *dsw, struct dsw_port *port,
@@ -942,8 +1007,10 @@ dsw_port_handle_unpause_flows(struct dsw_evdev *dsw, struct dsw_port *port,
 		.type = DSW_CTL_CFM,
 		.originating_port_id = port->id
 	};
+	uint64_t paused_starts[qfs_len];
 
-	dsw_port_remove_paused_flows(port, paused_qfs, qfs_len);
+	dsw_port_remove_paused_flows(port, paused_qfs, qfs_len,
+				     paused_starts);
 
 	rte_smp_rmb();
 
@@ -951,11 +1018,17 @@ dsw_port_handle_unpause_flows(struct dsw_evdev *dsw, struct dsw_port *port,
 
 	for (i = 0; i < qfs_len; i++) {
 		struct dsw_queue_flow *qf = &paused_qfs[i];
+		uint8_t dest_port_id =
+			dsw_schedule(dsw, qf->queue_id, qf->flow_hash);
 
-		if (dsw_schedule(dsw, qf->queue_id, qf->flow_hash) == port->id)
+		if (dest_port_id == port->id) {
 			port->immigrations++;
+			port->immigration_hold_end = rte_get_timer_cycles() +
+				port->immigration_hold;
+		}
 
-		dsw_port_flush_paused_events(dsw, port, qf);
+		dsw_port_flush_paused_events(dsw, port, qf,
+					     paused_starts[i]);
 	}
 }
 
@@ -999,6 +1072,7 @@ dsw_port_forward_emigrated_flow(struct dsw_port *source_port,
 								    e, 1,
 								    NULL) != 1)
 					rte_pause();
+				source_port->migration_forwarded_events++;
 			} else {
 				uint16_t last_idx = source_port->in_buffer_len;
 				source_port->in_buffer[last_idx] = *e;
@@ -1102,6 +1176,30 @@ dsw_port_note_op(struct dsw_port *port, uint16_t num_events)
 	port->ops_since_bg_task += (num_events+1);
 }
 
+/* A lower flush threshold has the output buffers flushed sooner, so
+ * the longest time the events flushed since the last adaptation spent
+ * in the buffers follows the threshold. Shrink the threshold quickly
+ * when that time exceeds the latency target, and grow it back slowly
+ * otherwise, to regain the batching efficiency.
+ */
+static void
+dsw_port_adapt_out_buffer(struct dsw_port *port)
+{
+	uint64_t delay = port->out_buffer_delay_max;
+
+	if (port->out_buffer_latency == 0)
+		return;
+
+	if (delay > port->out_buffer_latency)
+		port->out_buffer_limit = RTE_MAX(port->out_buffer_limit / 2,
+						 DSW_MIN_PORT_OUT_BUFFER);
+	else if (delay < port->out_buffer_latency / 2 &&
+		 port->out_buffer_limit < DSW_MAX_PORT_OUT_BUFFER)
+		port->out_buffer_limit++;
+
+	port->out_buffer_delay_max = 0;
+}
+
 static void
 dsw_port_bg_process(struct dsw_evdev *dsw, struct dsw_port *port)
 {
@@ -1132,6 +1230,8 @@ dsw_port_bg_process(struct dsw_evdev *dsw, struct dsw_port *port)
 		 */
 		dsw_port_flush_out_buffers(dsw, port);
 
+		dsw_port_adapt_out_buffer(port);
+
 		dsw_port_consider_load_update(port, now);
 
 		dsw_port_consider_emigration(dsw, port, now);
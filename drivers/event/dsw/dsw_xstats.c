@@ -97,6 +97,23 @@ dsw_xstats_port_get_migration_latency(struct dsw_evdev *dsw, uint8_t port_id,
 	return num_emigrations > 0 ? total_latency / num_emigrations : 0;
 }
 
+DSW_GEN_PORT_ACCESS_FN(emigration_latency_max)
+DSW_GEN_PORT_ACCESS_FN(migration_held_events)
+DSW_GEN_PORT_ACCESS_FN(migration_forwarded_events)
+
+static uint64_t
+dsw_xstats_port_get_migration_reorder_cost(struct dsw_evdev *dsw,
+					   uint8_t port_id,
+					   uint8_t queue_id __rte_unused)
+{
+	uint64_t hold_cycles =
+		dsw->ports[port_id].migration_hold_cycles;
+	uint64_t held_events =
+		dsw->ports[port_id].migration_held_events;
+
+	return held_events > 0 ? hold_cycles / held_events : 0;
+}
+
 static uint64_t
 dsw_xstats_port_get_event_proc_latency(struct dsw_evdev *dsw, uint8_t port_id,
 				       uint8_t queue_id __rte_unused)
@@ -133,6 +150,8 @@ dsw_xstats_port_get_load(struct dsw_evdev *dsw, uint8_t port_id,
 
 DSW_GEN_PORT_ACCESS_FN(last_bg)
 
+DSW_GEN_PORT_ACCESS_FN(out_buffer_limit)
+
 static struct dsw_xstats_port dsw_port_xstats[] = {
 	{ "port_%u_new_enqueued", dsw_xstats_port_get_new_enqueued,
 	  false },
@@ -150,6 +169,14 @@ static struct dsw_xstats_port dsw_port_xstats[] = {
 	  false },
 	{ "port_%u_migration_latency", dsw_xstats_port_get_migration_latency,
 	  false },
+	{ "port_%u_migration_latency_max",
+	  dsw_xstats_port_get_emigration_latency_max, false },
+	{ "port_%u_migration_held_events",
+	  dsw_xstats_port_get_migration_held_events, false },
+	{ "port_%u_migration_forwarded_events",
+	  dsw_xstats_port_get_migration_forwarded_events, false },
+	{ "port_%u_migration_reorder_cost",
+	  dsw_xstats_port_get_migration_reorder_cost, false },
 	{ "port_%u_immigrations", dsw_xstats_port_get_immigrations,
 	  false },
 	{ "port_%u_event_proc_latency", dsw_xstats_port_get_event_proc_latency,
@@ -163,6 +190,8 @@ static struct dsw_xstats_port dsw_port_xstats[] = {
 	{ "port_%u_load", dsw_xstats_port_get_load,
 	  false },
 	{ "port_%u_last_bg", dsw_xstats_port_get_last_bg,
+	  false },
+	{ "port_%u_out_buffer_limit", dsw_xstats_port_get_out_buffer_limit,
 	  false }
 };
 
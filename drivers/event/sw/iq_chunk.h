@@ -29,36 +29,36 @@ iq_count(const struct sw_iq *iq)
 }
 
 static __rte_always_inline struct sw_queue_chunk *
-iq_alloc_chunk(struct sw_evdev *sw)
+iq_alloc_chunk(struct sw_sched *sched)
 {
-	struct sw_queue_chunk *chunk = sw->chunk_list_head;
-	sw->chunk_list_head = chunk->next;
+	struct sw_queue_chunk *chunk = sched->chunk_list_head;
+	sched->chunk_list_head = chunk->next;
 	chunk->next = NULL;
 	return chunk;
 }
 
 static __rte_always_inline void
-iq_free_chunk(struct sw_evdev *sw, struct sw_queue_chunk *chunk)
+iq_free_chunk(struct sw_sched *sched, struct sw_queue_chunk *chunk)
 {
-	chunk->next = sw->chunk_list_head;
-	sw->chunk_list_head = chunk;
+	chunk->next = sched->chunk_list_head;
+	sched->chunk_list_head = chunk;
 }
 
 static __rte_always_inline void
-iq_free_chunk_list(struct sw_evdev *sw, struct sw_queue_chunk *head)
+iq_free_chunk_list(struct sw_sched *sched, struct sw_queue_chunk *head)
 {
 	while (head) {
 		struct sw_queue_chunk *next;
 		next = head->next;
-		iq_free_chunk(sw, head);
+		iq_free_chunk(sched, head);
 		head = next;
 	}
 }
 
 static __rte_always_inline void
-iq_init(struct sw_evdev *sw, struct sw_iq *iq)
+iq_init(struct sw_sched *sched, struct sw_iq *iq)
 {
-	iq->head = iq_alloc_chunk(sw);
+	iq->head = iq_alloc_chunk(sched);
 	iq->tail = iq->head;
 	iq->head_idx = 0;
 	iq->tail_idx = 0;
@@ -66,7 +66,8 @@ iq_init(struct sw_evdev *sw, struct sw_iq *iq)
 }
 
 static __rte_always_inline void
-iq_enqueue(struct sw_evdev *sw, struct sw_iq *iq, const struct rte_event *ev)
+iq_enqueue(struct sw_sched *sched, struct sw_iq *iq,
+	   const struct rte_event *ev)
 {
 	iq->tail->events[iq->tail_idx++] = *ev;
 	iq->count++;
@@ -76,7 +77,7 @@ iq_enqueue(struct sw_evdev *sw, struct sw_iq *iq, const struct rte_event *ev)
 		 * number of inflight events and number of IQS such that
 		 * allocation will always succeed.
 		 */
-		struct sw_queue_chunk *chunk = iq_alloc_chunk(sw);
+		struct sw_queue_chunk *chunk = iq_alloc_chunk(sched);
 		iq->tail->next = chunk;
 		iq->tail = chunk;
 		iq->tail_idx = 0;
@@ -84,14 +85,14 @@ iq_enqueue(struct sw_evdev *sw, struct sw_iq *iq, const struct rte_event *ev)
 }
 
 static __rte_always_inline void
-iq_pop(struct sw_evdev *sw, struct sw_iq *iq)
+iq_pop(struct sw_sched *sched, struct sw_iq *iq)
 {
 	iq->head_idx++;
 	iq->count--;
 
 	if (unlikely(iq->head_idx == SW_EVS_PER_Q_CHUNK)) {
 		struct sw_queue_chunk *next = iq->head->next;
-		iq_free_chunk(sw, iq->head);
+		iq_free_chunk(sched, iq->head);
 		iq->head = next;
 		iq->head_idx = 0;
 	}
@@ -105,7 +106,7 @@ iq_peek(struct sw_iq *iq)
 
 /* Note: the caller must ensure that count <= iq_count() */
 static __rte_always_inline uint16_t
-iq_dequeue_burst(struct sw_evdev *sw,
+iq_dequeue_burst(struct sw_sched *sched,
 		 struct sw_iq *iq,
 		 struct rte_event *ev,
 		 uint16_t count)
@@ -131,7 +132,7 @@ iq_dequeue_burst(struct sw_evdev *sw,
 
 		/* Move to the next chunk */
 		next = current->next;
-		iq_free_chunk(sw, current);
+		iq_free_chunk(sched, current);
 		current = next;
 		index = 0;
 	}
@@ -139,7 +140,7 @@ iq_dequeue_burst(struct sw_evdev *sw,
 done:
 	if (unlikely(index == SW_EVS_PER_Q_CHUNK)) {
 		struct sw_queue_chunk *next = current->next;
-		iq_free_chunk(sw, current);
+		iq_free_chunk(sched, current);
 		iq->head = next;
 		iq->head_idx = 0;
 	} else {
@@ -153,7 +154,7 @@ done:
 }
 
 static __rte_always_inline void
-iq_put_back(struct sw_evdev *sw,
+iq_put_back(struct sw_sched *sched,
 	    struct sw_iq *iq,
 	    struct rte_event *ev,
 	    unsigned int count)
@@ -181,7 +182,7 @@ iq_put_back(struct sw_evdev *sw,
 		for (i = 0; i < avail_space; i++)
 			iq->head->events[i] = ev[remaining + i];
 
-		new_head = iq_alloc_chunk(sw);
+		new_head = iq_alloc_chunk(sched);
 		new_head->next = iq->head;
 		iq->head = new_head;
 		iq->head_idx = SW_EVS_PER_Q_CHUNK - remaining;
@@ -23,10 +23,14 @@
 #define MIN_BURST_SIZE_ARG "min_burst"
 #define DEQ_BURST_SIZE_ARG "deq_burst"
 #define REFIL_ONCE_ARG "refill_once"
+#define SCHED_INSTANCES_ARG "sched_instances"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
 
+static void
+sw_port_release(void *port);
+
 static int
 sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
 		const uint8_t priorities[], uint16_t num)
@@ -118,7 +122,9 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 		}
 	}
 
-	p->unlinks_in_progress += unlinked;
+	/* every scheduler instance has to ack the unlinks */
+	for (i = 0; i < sw->nb_scheds; i++)
+		sw_sched_port(sw, i, p->id)->unlinks_in_progress += unlinked;
 	rte_smp_mb();
 
 	return unlinked;
@@ -127,9 +133,71 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 static int
 sw_port_unlinks_in_progress(struct rte_eventdev *dev, void *port)
 {
-	RTE_SET_USED(dev);
+	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_port *p = port;
-	return p->unlinks_in_progress;
+	int unlinks = 0;
+	uint32_t i;
+
+	for (i = 0; i < sw->nb_scheds; i++)
+		unlinks += sw_sched_port(sw, i, p->id)->unlinks_in_progress;
+	return unlinks;
+}
+
+/* Set up the rings and history of a port, as seen by one scheduler instance
+ * other than the first, which uses the port of the device itself.
+ */
+static int
+sw_sched_port_setup(struct rte_eventdev *dev, struct sw_sched *sched,
+		uint8_t port_id, const struct rte_event_port_conf *conf)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_port *p = &sched->ports[port_id];
+	struct rte_event_ring *existing_ring;
+	char buf[RTE_RING_NAMESIZE];
+	unsigned int i;
+
+	*p = (struct sw_port){0}; /* zero entire structure */
+	p->id = port_id;
+	p->sw = sw;
+
+	snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_rx", dev->data->dev_id,
+			port_id, sched->idx);
+	existing_ring = rte_event_ring_lookup(buf);
+	if (existing_ring)
+		rte_event_ring_free(existing_ring);
+
+	p->rx_worker_ring = rte_event_ring_create(buf, MAX_SW_PROD_Q_DEPTH,
+			dev->data->socket_id,
+			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+	if (p->rx_worker_ring == NULL) {
+		SW_LOG_ERR("Error creating RX ring for port %d instance %u\n",
+				port_id, sched->idx);
+		return -1;
+	}
+
+	snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_cq", dev->data->dev_id,
+			port_id, sched->idx);
+	existing_ring = rte_event_ring_lookup(buf);
+	if (existing_ring)
+		rte_event_ring_free(existing_ring);
+
+	p->cq_worker_ring = rte_event_ring_create(buf, conf->dequeue_depth,
+			dev->data->socket_id,
+			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+	if (p->cq_worker_ring == NULL) {
+		rte_event_ring_free(p->rx_worker_ring);
+		p->rx_worker_ring = NULL;
+		SW_LOG_ERR("Error creating CQ ring for port %d instance %u\n",
+				port_id, sched->idx);
+		return -1;
+	}
+
+	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
+		p->hist_list[i].fid = -1;
+		p->hist_list[i].qid = -1;
+	}
+	p->initialized = 1;
+	return 0;
 }
 
 static int
@@ -152,6 +220,10 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		 * the sum to no leak credits
 		 */
 		int possible_inflights = p->inflight_credits + p->inflights;
+
+		for (i = 1; i < sw->nb_scheds; i++)
+			possible_inflights +=
+				sw_sched_port(sw, i, port_id)->inflights;
 		rte_atomic32_sub(&sw->inflights, possible_inflights);
 	}
 
@@ -198,13 +270,26 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 				port_id);
 		return -1;
 	}
-	sw->cq_ring_space[port_id] = conf->dequeue_depth;
+	sw->scheds[0].cq_ring_space[port_id] = conf->dequeue_depth;
 
 	/* set hist list contents to empty */
 	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
 		p->hist_list[i].fid = -1;
 		p->hist_list[i].qid = -1;
 	}
+
+	/* the other scheduler instances get their own rings and history */
+	for (i = 1; i < sw->nb_scheds; i++) {
+		if (sw_sched_port_setup(dev, &sw->scheds[i], port_id,
+				conf) < 0) {
+			sw_port_release(p);
+			return -1;
+		}
+		sw->scheds[i].cq_ring_space[port_id] = conf->dequeue_depth;
+	}
+	if (sw->nb_scheds > 1)
+		p->sched_tags = &sw->sched_tags[port_id * SW_PORT_SCHED_TAGS];
+
 	dev->data->ports[port_id] = p;
 
 	rte_smp_wmb();
@@ -216,9 +301,21 @@ static void
 sw_port_release(void *port)
 {
 	struct sw_port *p = (void *)port;
+	uint32_t i;
+
 	if (p == NULL)
 		return;
 
+	if (p->sw != NULL) {
+		for (i = 1; i < p->sw->nb_scheds; i++) {
+			struct sw_port *sp = sw_sched_port(p->sw, i, p->id);
+
+			rte_event_ring_free(sp->rx_worker_ring);
+			rte_event_ring_free(sp->cq_worker_ring);
+			memset(sp, 0, sizeof(*sp));
+		}
+	}
+
 	rte_event_ring_free(p->rx_worker_ring);
 	rte_event_ring_free(p->cq_worker_ring);
 	memset(p, 0, sizeof(*p));
@@ -242,6 +339,7 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 	qid->id = idx;
 	qid->type = type;
 	qid->priority = queue_conf->priority;
+	qid->sched = idx % sw->nb_scheds;
 
 	if (qid->type == RTE_SCHED_TYPE_ORDERED) {
 		uint32_t window_size;
@@ -363,7 +461,7 @@ sw_init_qid_iqs(struct sw_evdev *sw)
 			continue;
 
 		for (j = 0; j < SW_IQS_MAX; j++)
-			iq_init(sw, &qid->iq[j]);
+			iq_init(&sw->scheds[qid->sched], &qid->iq[j]);
 	}
 }
 
@@ -385,12 +483,21 @@ sw_qids_empty(struct sw_evdev *sw)
 static int
 sw_ports_empty(struct sw_evdev *sw)
 {
-	unsigned int i;
+	unsigned int i, j;
 
-	for (i = 0; i < sw->port_count; i++) {
-		if ((rte_event_ring_count(sw->ports[i].rx_worker_ring)) ||
-		     rte_event_ring_count(sw->ports[i].cq_worker_ring))
+	for (j = 0; j < sw->nb_scheds; j++) {
+		const struct sw_sched *sched = &sw->scheds[j];
+
+		if (sched->xfer_ring && rte_event_ring_count(sched->xfer_ring))
 			return 0;
+
+		for (i = 0; i < sw->port_count; i++) {
+			const struct sw_port *p = &sched->ports[i];
+
+			if ((rte_event_ring_count(p->rx_worker_ring)) ||
+			     rte_event_ring_count(p->cq_worker_ring))
+				return 0;
+		}
 	}
 
 	return 1;
@@ -423,9 +530,9 @@ sw_drain_ports(struct rte_eventdev *dev)
 }
 
 static void
-sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
+sw_drain_queue(struct rte_eventdev *dev, struct sw_sched *sched,
+		struct sw_iq *iq)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	eventdev_stop_flush_t flush;
 	uint8_t dev_id;
 	void *arg;
@@ -437,7 +544,7 @@ sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
 	while (iq_count(iq) > 0) {
 		struct rte_event ev;
 
-		iq_dequeue_burst(sw, iq, &ev, 1);
+		iq_dequeue_burst(sched, iq, &ev, 1);
 
 		if (flush)
 			flush(dev_id, ev, arg);
@@ -451,8 +558,11 @@ sw_drain_queues(struct rte_eventdev *dev)
 	unsigned int i, j;
 
 	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+
 		for (j = 0; j < SW_IQS_MAX; j++)
-			sw_drain_queue(dev, &sw->qids[i].iq[j]);
+			sw_drain_queue(dev, &sw->scheds[qid->sched],
+					&qid->iq[j]);
 	}
 }
 
@@ -469,7 +579,8 @@ sw_clean_qid_iqs(struct rte_eventdev *dev)
 		for (j = 0; j < SW_IQS_MAX; j++) {
 			if (!qid->iq[j].head)
 				continue;
-			iq_free_chunk_list(sw, qid->iq[j].head);
+			iq_free_chunk_list(&sw->scheds[qid->sched],
+					qid->iq[j].head);
 			qid->iq[j].head = NULL;
 		}
 	}
@@ -511,6 +622,7 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
+	uint32_t s, nb_qids;
 	int num_chunks, i;
 
 	sw->qid_count = conf->nb_event_queues;
@@ -518,27 +630,37 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	sw->nb_events_limit = conf->nb_events_limit;
 	rte_atomic32_set(&sw->inflights, 0);
 
-	/* Number of chunks sized for worst-case spread of events across IQs */
-	num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
-			sw->qid_count*SW_IQS_MAX*2;
+	for (s = 0; s < sw->nb_scheds; s++) {
+		struct sw_sched *sched = &sw->scheds[s];
 
-	/* If this is a reconfiguration, free the previous IQ allocation. All
-	 * IQ chunk references were cleaned out of the QIDs in sw_stop(), and
-	 * will be reinitialized in sw_start().
-	 */
-	rte_free(sw->chunks);
-
-	sw->chunks = rte_malloc_socket(NULL,
-				       sizeof(struct sw_queue_chunk) *
-				       num_chunks,
-				       0,
-				       sw->data->socket_id);
-	if (!sw->chunks)
-		return -ENOMEM;
+		/* QIDs are spread round-robin across the instances */
+		nb_qids = (sw->qid_count + sw->nb_scheds - 1 - s) /
+				sw->nb_scheds;
 
-	sw->chunk_list_head = NULL;
-	for (i = 0; i < num_chunks; i++)
-		iq_free_chunk(sw, &sw->chunks[i]);
+		/* Number of chunks sized for worst-case spread of events
+		 * across IQs, any instance may end up holding all events.
+		 */
+		num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
+				nb_qids*SW_IQS_MAX*2;
+
+		/* If this is a reconfiguration, free the previous IQ
+		 * allocation. All IQ chunk references were cleaned out of the
+		 * QIDs in sw_stop(), and will be reinitialized in sw_start().
+		 */
+		rte_free(sched->chunks);
+
+		sched->chunks = rte_malloc_socket(NULL,
+					       sizeof(struct sw_queue_chunk) *
+					       num_chunks,
+					       0,
+					       sw->data->socket_id);
+		if (!sched->chunks)
+			return -ENOMEM;
+
+		sched->chunk_list_head = NULL;
+		for (i = 0; i < num_chunks; i++)
+			iq_free_chunk(sched, &sched->chunks[i]);
+	}
 
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
@@ -623,16 +745,29 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	static const char * const q_type_strings[] = {
 			"Ordered", "Atomic", "Parallel", "Directed"
 	};
-	uint32_t i;
+	uint32_t i, s;
 	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
 			sw->port_count, sw->qid_count);
 
-	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+	for (s = 0; s < sw->nb_scheds; s++) {
+		const struct sw_sched *sched = &sw->scheds[s];
+
+		if (sw->nb_scheds > 1)
+			fprintf(f, "  Scheduler %u\n", s);
+		fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64
+			"\n\ttx   %"PRIu64"\n", sched->stats.rx_pkts,
+			sched->stats.rx_dropped, sched->stats.tx_pkts);
+		fprintf(f, "\tsched calls: %"PRIu64"\n", sched->sched_called);
+		fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+			sched->sched_cq_qid_called);
+		fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+			sched->sched_no_iq_enqueues);
+		fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+			sched->sched_no_cq_enqueues);
+		if (sw->nb_scheds > 1)
+			fprintf(f, "\tsched xfer: %"PRIu64"\tqids: %u\n",
+				sched->sched_xfer_pkts, sched->qid_count);
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -648,15 +783,26 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 				COL_RED, i, COL_RESET);
 			continue;
 		}
+		uint64_t rx_pkts = 0, tx_pkts = 0;
+		uint32_t inflights = 0;
+
+		for (s = 0; s < sw->nb_scheds; s++) {
+			const struct sw_port *sp = sw_sched_port(sw, s, i);
+
+			rx_pkts += sp->stats.rx_pkts;
+			tx_pkts += sp->stats.tx_pkts;
+			inflights += sp->inflights;
+		}
+
 		fprintf(f, "  Port %d %s\n", i,
 			p->is_directed ? " (SingleCons)" : "");
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64
-			"\t%sinflight %d%s\n", sw->ports[i].stats.rx_pkts,
+			"\t%sinflight %d%s\n", rx_pkts,
 			sw->ports[i].stats.rx_dropped,
-			sw->ports[i].stats.tx_pkts,
-			(p->inflights == p->inflight_max) ?
+			tx_pkts,
+			(inflights == p->inflight_max) ?
 				COL_RED : COL_RESET,
-			sw->ports[i].inflights, COL_RESET);
+			inflights, COL_RESET);
 
 		fprintf(f, "\tMax New: %u"
 			"\tAvg cycles PP: %"PRIu64"\tCredits: %u\n",
@@ -713,6 +859,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		int affinities_per_port[SW_PORTS_MAX] = {0};
 
 		fprintf(f, "  Queue %d (%s)\n", i, q_type_strings[qid->type]);
+		if (sw->nb_scheds > 1)
+			fprintf(f, "\tScheduler %u\n", qid->sched);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64"\n",
 			qid->stats.rx_pkts, qid->stats.rx_dropped,
 			qid->stats.tx_pkts);
@@ -798,12 +946,17 @@ sw_start(struct rte_eventdev *dev)
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
+	/* Each scheduler instance only schedules the QIDs it owns */
+	for (i = 0; i < sw->nb_scheds; i++)
+		sw->scheds[i].qid_count = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
 			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
+				struct sw_sched *sched =
+					&sw->scheds[sw->qids[i].sched];
+
+				sched->qids_prioritized[sched->qid_count++] =
+					&sw->qids[i];
 			}
 		}
 	}
@@ -863,11 +1016,16 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->nb_scheds; i++) {
+		struct sw_sched *sched = &sw->scheds[i];
+
+		memset(&sched->stats, 0, sizeof(sched->stats));
+		sched->sched_called = 0;
+		sched->sched_no_iq_enqueues = 0;
+		sched->sched_no_cq_enqueues = 0;
+		sched->sched_cq_qid_called = 0;
+		sched->sched_xfer_pkts = 0;
+	}
 
 	return 0;
 }
@@ -932,6 +1090,92 @@ set_refill_once(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_sched_instances(const char *key __rte_unused, const char *value,
+		void *opaque)
+{
+	int *nb_scheds = opaque;
+	*nb_scheds = atoi(value);
+	if (*nb_scheds < 1 || *nb_scheds > SW_SCHED_MAX)
+		return -1;
+	return 0;
+}
+
+static void
+sw_sched_free(struct sw_evdev *sw)
+{
+	uint32_t i;
+
+	for (i = 0; i < SW_SCHED_MAX; i++) {
+		struct sw_sched *sched = &sw->scheds[i];
+
+		rte_event_ring_free(sched->xfer_ring);
+		sched->xfer_ring = NULL;
+		rte_free(sched->chunks);
+		sched->chunks = NULL;
+		if (i > 0) {
+			rte_free(sched->ports);
+			sched->ports = NULL;
+		}
+	}
+	rte_free(sw->sched_tags);
+	sw->sched_tags = NULL;
+}
+
+static int
+sw_sched_init(struct sw_evdev *sw, int socket_id)
+{
+	char buf[RTE_RING_NAMESIZE];
+	uint32_t i;
+
+	for (i = 0; i < sw->nb_scheds; i++) {
+		struct sw_sched *sched = &sw->scheds[i];
+
+		sched->sw = sw;
+		sched->idx = i;
+		rte_spinlock_init(&sched->lock);
+
+		if (i == 0) {
+			sched->ports = sw->ports;
+			continue;
+		}
+
+		sched->ports = rte_zmalloc_socket(NULL,
+				sizeof(struct sw_port) * SW_PORTS_MAX,
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (sched->ports == NULL)
+			goto fail;
+	}
+
+	if (sw->nb_scheds == 1)
+		return 0;
+
+	/* Each instance receives the events other instances forward to its
+	 * QIDs on a ring big enough to hold all the events of the device.
+	 */
+	for (i = 0; i < sw->nb_scheds; i++) {
+		snprintf(buf, sizeof(buf), "sw%d_s%u_xfer", sw->data->dev_id,
+				i);
+		sw->scheds[i].xfer_ring = rte_event_ring_create(buf,
+				SW_INFLIGHT_EVENTS_TOTAL, socket_id,
+				RING_F_SC_DEQ | RING_F_EXACT_SZ);
+		if (sw->scheds[i].xfer_ring == NULL)
+			goto fail;
+	}
+
+	sw->sched_tags = rte_zmalloc_socket(NULL,
+			SW_PORTS_MAX * SW_PORT_SCHED_TAGS, 0, socket_id);
+	if (sw->sched_tags == NULL)
+		goto fail;
+
+	return 0;
+
+fail:
+	SW_LOG_ERR("Error allocating scheduler instances\n");
+	sw_sched_free(sw);
+	return -ENOMEM;
+}
+
 static int32_t sw_sched_service_func(void *args)
 {
 	struct rte_eventdev *dev = args;
@@ -981,6 +1225,7 @@ sw_probe(struct rte_vdev_device *vdev)
 		MIN_BURST_SIZE_ARG,
 		DEQ_BURST_SIZE_ARG,
 		REFIL_ONCE_ARG,
+		SCHED_INSTANCES_ARG,
 		NULL
 	};
 	const char *name;
@@ -993,6 +1238,7 @@ sw_probe(struct rte_vdev_device *vdev)
 	int min_burst_size = 1;
 	int deq_burst_size = SCHED_DEQUEUE_DEFAULT_BURST_SIZE;
 	int refill_once = 0;
+	int nb_scheds = 1;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -1064,6 +1310,16 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_INSTANCES_ARG,
+					set_sched_instances, &nb_scheds);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched instances parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
@@ -1071,9 +1327,10 @@ sw_probe(struct rte_vdev_device *vdev)
 	SW_LOG_INFO(
 			"Creating eventdev sw device %s, numa_node=%d, "
 			"sched_quanta=%d, credit_quanta=%d "
-			"min_burst=%d, deq_burst=%d, refill_once=%d\n",
+			"min_burst=%d, deq_burst=%d, refill_once=%d, "
+			"sched_instances=%d\n",
 			name, socket_id, sched_quanta, credit_quanta,
-			min_burst_size, deq_burst_size, refill_once);
+			min_burst_size, deq_burst_size, refill_once, nb_scheds);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -1101,6 +1358,10 @@ sw_probe(struct rte_vdev_device *vdev)
 	sw->sched_min_burst_size = min_burst_size;
 	sw->sched_deq_burst_size = deq_burst_size;
 	sw->refill_once_per_iter = refill_once;
+	sw->nb_scheds = nb_scheds;
+
+	if (sw_sched_init(sw, socket_id) < 0)
+		return -ENOMEM;
 
 	/* register service with EAL */
 	struct rte_service_spec service;
@@ -1111,10 +1372,14 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	/* with several instances, more service cores schedule in parallel */
+	if (sw->nb_scheds > 1)
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
 		SW_LOG_ERR("service register() failed");
+		sw_sched_free(sw);
 		return -ENOEXEC;
 	}
 
@@ -1129,6 +1394,7 @@ sw_probe(struct rte_vdev_device *vdev)
 static int
 sw_remove(struct rte_vdev_device *vdev)
 {
+	struct rte_eventdev *dev;
 	const char *name;
 
 	name = rte_vdev_device_name(vdev);
@@ -1137,6 +1403,10 @@ sw_remove(struct rte_vdev_device *vdev)
 
 	SW_LOG_INFO("Closing eventdev sw device %s\n", name);
 
+	dev = rte_event_pmd_get_named_dev(name);
+	if (dev != NULL && rte_eal_process_type() == RTE_PROC_PRIMARY)
+		sw_sched_free(sw_pmd_priv(dev));
+
 	return rte_event_pmd_vdev_uninit(name);
 }
 
@@ -1149,5 +1419,5 @@ RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
 		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>"
 		MIN_BURST_SIZE_ARG "=<int>" DEQ_BURST_SIZE_ARG "=<int>"
-		REFIL_ONCE_ARG "=<int>");
+		REFIL_ONCE_ARG "=<int>" SCHED_INSTANCES_ARG "=<int>");
 RTE_LOG_REGISTER_DEFAULT(eventdev_sw_log_level, NOTICE);
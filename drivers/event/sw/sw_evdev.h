@@ -9,6 +9,7 @@
 #include <rte_eventdev.h>
 #include <eventdev_pmd_vdev.h>
 #include <rte_atomic.h>
+#include <rte_spinlock.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
@@ -21,6 +22,8 @@
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+/* max number of scheduler instances a device can be split into */
+#define SW_SCHED_MAX 4
 
 /* Should be power-of-two minus one, to leave room for the next pointer */
 #define SW_EVS_PER_Q_CHUNK 255
@@ -33,11 +36,16 @@
 /* max buffer size */
 #define SCHED_DEQUEUE_MAX_BURST_SIZE 256
 
+/* how many events are buffered for another scheduler instance before a push */
+#define SCHED_XFER_BURST_SIZE 32
+
 /* Flush the pipeline after this many no enq to cq */
 #define SCHED_NO_ENQ_CYCLE_FLUSH 256
 
 
 #define SW_PORT_HIST_LIST (MAX_SW_PROD_Q_DEPTH) /* size of our history list */
+/* size of the per port list of scheduler instances events came from */
+#define SW_PORT_SCHED_TAGS (SW_SCHED_MAX * SW_PORT_HIST_LIST)
 #define NUM_SAMPLES 64 /* how many data points use for average stats */
 
 #define EVENTDEV_NAME_SW_PMD event_sw
@@ -133,6 +141,9 @@ struct sw_qid {
 	uint32_t window_size;          /* Used to wrap reorder_buffer_index */
 
 	uint8_t priority;
+
+	/* scheduler instance owning this QID */
+	uint8_t sched;
 };
 
 struct sw_hist_list_entry {
@@ -190,6 +201,15 @@ struct sw_port {
 	uint32_t poll_buckets[SW_NUM_POLL_BUCKETS];
 		/* bucket values in 4s for shorter reporting */
 
+	/* With several scheduler instances, remember which instance each
+	 * outstanding event was dequeued from, so that its release goes back
+	 * to the instance holding its history list entry.
+	 */
+	uint8_t *sched_tags;
+	uint32_t sched_tag_head;
+	uint32_t sched_tag_tail;
+	uint8_t deq_sched; /* instance to dequeue from first */
+
 	/* History list structs, containing info on pkts egressed to worker */
 	uint16_t hist_head __rte_cache_aligned;
 	uint16_t hist_tail;
@@ -209,6 +229,51 @@ struct sw_port {
 	uint8_t num_qids_mapped;
 };
 
+/*
+ * A scheduler instance. Each instance owns a disjoint subset of the QIDs and
+ * schedules them independently of the other instances, with its own IQ
+ * memory, its own pair of rings on every port and its own CQ credits.
+ */
+struct sw_sched {
+	struct sw_evdev *sw;
+	/* Scheduler side state of every port as seen by this instance. For
+	 * instance 0 these are the ports of the device itself.
+	 */
+	struct sw_port *ports;
+	/* Events for QIDs owned by this instance, from other instances */
+	struct rte_event_ring *xfer_ring;
+	/* Events for QIDs owned by other instances, not yet pushed to them */
+	uint16_t xfer_count[SW_SCHED_MAX];
+	struct rte_event xfer_buf[SW_SCHED_MAX][SCHED_XFER_BURST_SIZE];
+	/* Serializes concurrent service cores running the instance */
+	rte_spinlock_t lock;
+	uint8_t idx;
+
+	/* Current values */
+	uint32_t sched_flush_count;
+	uint32_t sched_min_burst;
+
+	struct sw_queue_chunk *chunk_list_head;
+	struct sw_queue_chunk *chunks;
+
+	/* Cache how many packets are in each cq */
+	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+
+	/* Array of pointers to owned QIDs sorted by priority level */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* Stats */
+	struct sw_point_stats stats __rte_cache_aligned;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+	uint64_t sched_last_iter_bitmask;
+	uint64_t sched_xfer_pkts;
+	uint8_t sched_progress_last_iter;
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -226,9 +291,6 @@ struct sw_evdev {
 	uint32_t sched_deq_burst_size;
 	/* Refill pp buffers only once per scheduler call*/
 	uint32_t refill_once_per_iter;
-	/* Current values */
-	uint32_t sched_flush_count;
-	uint32_t sched_min_burst;
 
 	/* Contains all ports - load balanced and directed */
 	struct sw_port ports[SW_PORTS_MAX] __rte_cache_aligned;
@@ -243,25 +305,14 @@ struct sw_evdev {
 
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
-	struct sw_queue_chunk *chunk_list_head;
-	struct sw_queue_chunk *chunks;
-
-	/* Cache how many packets are in each cq */
-	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	/* Scheduler instances, QIDs are spread across them */
+	uint32_t nb_scheds;
+	struct sw_sched scheds[SW_SCHED_MAX];
+	/* Backing memory of the per port scheduler instance tags */
+	uint8_t *sched_tags;
 
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
-	uint64_t sched_last_iter_bitmask;
-	uint8_t sched_progress_last_iter;
-
 	uint8_t started;
 	uint32_t credit_update_quanta;
 
@@ -288,6 +339,13 @@ sw_pmd_priv_const(const struct rte_eventdev *eventdev)
 	return eventdev->data->dev_private;
 }
 
+/* Scheduler side view of a port, as seen by the given instance */
+static inline struct sw_port *
+sw_sched_port(const struct sw_evdev *sw, uint32_t sched, uint32_t port_id)
+{
+	return &sw->scheds[sched].ports[port_id];
+}
+
 uint16_t sw_event_enqueue(void *port, const struct rte_event *ev);
 uint16_t sw_event_enqueue_burst(void *port, const struct rte_event ev[],
 		uint16_t num);
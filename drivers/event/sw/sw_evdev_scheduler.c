@@ -29,7 +29,7 @@
 
 
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_atomic_to_cq(struct sw_sched *sched, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
@@ -45,7 +45,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	 */
 	uint32_t qid_id = qid->id;
 
-	iq_dequeue_burst(sw, &qid->iq[iq_num], qes, count);
+	iq_dequeue_burst(sched, &qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
 		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
@@ -61,11 +61,12 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			cq = qid->cq_map[cq_idx];
 
 			/* find least used */
-			int cq_free_cnt = sw->cq_ring_space[cq];
+			int cq_free_cnt = sched->cq_ring_space[cq];
 			for (cq_idx = 0; cq_idx < qid->cq_num_mapped_cqs;
 					cq_idx++) {
 				int test_cq = qid->cq_map[cq_idx];
-				int test_cq_free = sw->cq_ring_space[test_cq];
+				int test_cq_free =
+					sched->cq_ring_space[test_cq];
 				if (test_cq_free > cq_free_cnt) {
 					cq = test_cq;
 					cq_free_cnt = test_cq_free;
@@ -75,19 +76,20 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			fid->cq = cq; /* this pins early */
 		}
 
-		if (sw->cq_ring_space[cq] == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST) {
+		if (sched->cq_ring_space[cq] == 0 ||
+				sched->ports[cq].inflights ==
+					SW_PORT_HIST_LIST) {
 			blocked_qes[nb_blocked++] = *qe;
 			continue;
 		}
 
-		struct sw_port *p = &sw->ports[cq];
+		struct sw_port *p = &sched->ports[cq];
 
 		/* at this point we can queue up the packet on the cq_buf */
 		fid->pcount++;
 		p->cq_buf[p->cq_buf_count++] = *qe;
 		p->inflights++;
-		sw->cq_ring_space[cq]--;
+		sched->cq_ring_space[cq]--;
 
 		int head = (p->hist_head++ & (SW_PORT_HIST_LIST-1));
 		p->hist_list[head].fid = flow_id;
@@ -98,21 +100,21 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 		qid->to_port[cq]++;
 
 		/* if we just filled in the last slot, flush the buffer */
-		if (sw->cq_ring_space[cq] == 0) {
+		if (sched->cq_ring_space[cq] == 0) {
 			struct rte_event_ring *worker = p->cq_worker_ring;
 			rte_event_ring_enqueue_burst(worker, p->cq_buf,
 					p->cq_buf_count,
-					&sw->cq_ring_space[cq]);
+					&sched->cq_ring_space[cq]);
 			p->cq_buf_count = 0;
 		}
 	}
-	iq_put_back(sw, &qid->iq[iq_num], blocked_qes, nb_blocked);
+	iq_put_back(sched, &qid->iq[iq_num], blocked_qes, nb_blocked);
 
 	return count - nb_blocked;
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_parallel_to_cq(struct sw_sched *sched, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count, int keep_order)
 {
 	uint32_t i;
@@ -148,16 +150,16 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 				cq_idx = 0;
 			cq = qid->cq_map[cq_idx++];
 
-		} while (sw->ports[cq].inflights == SW_PORT_HIST_LIST ||
+		} while (sched->ports[cq].inflights == SW_PORT_HIST_LIST ||
 				rte_event_ring_free_count(
-					sw->ports[cq].cq_worker_ring) == 0);
+					sched->ports[cq].cq_worker_ring) == 0);
 
-		struct sw_port *p = &sw->ports[cq];
-		if (sw->cq_ring_space[cq] == 0 ||
+		struct sw_port *p = &sched->ports[cq];
+		if (sched->cq_ring_space[cq] == 0 ||
 				p->inflights == SW_PORT_HIST_LIST)
 			break;
 
-		sw->cq_ring_space[cq]--;
+		sched->cq_ring_space[cq]--;
 
 		qid->stats.tx_pkts++;
 
@@ -169,8 +171,8 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			rob_ring_dequeue(qid->reorder_buffer_freelist,
 					(void *)&p->hist_list[head].rob_entry);
 
-		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
-		iq_pop(sw, &qid->iq[iq_num]);
+		sched->ports[cq].cq_buf[sched->ports[cq].cq_buf_count++] = *qe;
+		iq_pop(sched, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
 		p->inflights++;
@@ -183,20 +185,20 @@ exit:
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_dir_to_cq(struct sw_sched *sched, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
-	struct sw_port *port = &sw->ports[cq_id];
+	struct sw_port *port = &sched->ports[cq_id];
 
 	/* get max burst enq size for cq_ring */
-	uint32_t count_free = sw->cq_ring_space[cq_id];
+	uint32_t count_free = sched->cq_ring_space[cq_id];
 	if (count_free == 0)
 		return 0;
 
 	/* burst dequeue from the QID IQ ring */
 	struct sw_iq *iq = &qid->iq[iq_num];
-	uint32_t ret = iq_dequeue_burst(sw, iq,
+	uint32_t ret = iq_dequeue_burst(sched, iq,
 			&port->cq_buf[port->cq_buf_count], count_free);
 	port->cq_buf_count += ret;
 
@@ -205,21 +207,21 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	port->stats.tx_pkts += ret;
 
 	/* Subtract credits from cached value */
-	sw->cq_ring_space[cq_id] -= ret;
+	sched->cq_ring_space[cq_id] -= ret;
 
 	return ret;
 }
 
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_sched *sched)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
 
-	sw->sched_cq_qid_called++;
+	sched->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	for (qid_idx = 0; qid_idx < sched->qid_count; qid_idx++) {
+		struct sw_qid *qid = sched->qids_prioritized[qid_idx];
 
 		int type = qid->type;
 		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
@@ -231,16 +233,16 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 		uint32_t pkts_done = 0;
 		uint32_t count = iq_count(&qid->iq[iq_num]);
 
-		if (count >= sw->sched_min_burst) {
+		if (count >= sched->sched_min_burst) {
 			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
+				pkts_done += sw_schedule_dir_to_cq(sched, qid,
 						iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
-						iq_num, count);
+				pkts_done += sw_schedule_atomic_to_cq(sched,
+						qid, iq_num, count);
 			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
-						iq_num, count,
+				pkts_done += sw_schedule_parallel_to_cq(sched,
+						qid, iq_num, count,
 						type == RTE_SCHED_TYPE_ORDERED);
 		}
 
@@ -256,14 +258,89 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 	return pkts;
 }
 
+/* Push the events buffered for another scheduler instance to its ring */
+static void
+sw_schedule_xfer_flush(struct sw_sched *sched, uint32_t dest)
+{
+	struct rte_event_ring *ring = sched->sw->scheds[dest].xfer_ring;
+	uint32_t n = sched->xfer_count[dest];
+	uint32_t enq;
+
+	/* The transfer ring can hold all events of the device, a short
+	 * enqueue can only happen on a misbehaving application.
+	 */
+	enq = rte_event_ring_enqueue_burst(ring, sched->xfer_buf[dest], n,
+			NULL);
+	sched->stats.rx_dropped += n - enq;
+	sched->sched_xfer_pkts += enq;
+	sched->xfer_count[dest] = 0;
+}
+
+static void
+sw_schedule_xfer_flush_all(struct sw_sched *sched)
+{
+	uint32_t i;
+
+	for (i = 0; i < sched->sw->nb_scheds; i++)
+		if (sched->xfer_count[i])
+			sw_schedule_xfer_flush(sched, i);
+}
+
+/* Enqueue an event into the given IQ of a QID. Events for a QID owned by
+ * another scheduler instance are buffered and handed over to that instance.
+ * Returns the number of events enqueued to a local IQ.
+ */
+static __rte_always_inline uint32_t
+sw_qid_enqueue(struct sw_sched *sched, struct sw_qid *qid, uint32_t iq_num,
+		const struct rte_event *qe)
+{
+	if (unlikely(qid->sched != sched->idx)) {
+		uint32_t dest = qid->sched;
+
+		sched->xfer_buf[dest][sched->xfer_count[dest]++] = *qe;
+		if (sched->xfer_count[dest] == SCHED_XFER_BURST_SIZE)
+			sw_schedule_xfer_flush(sched, dest);
+		return 0;
+	}
+
+	qid->iq_pkt_mask |= (1 << (iq_num));
+	iq_enqueue(sched, &qid->iq[iq_num], qe);
+	qid->iq_pkt_count[iq_num]++;
+	qid->stats.rx_pkts++;
+	return 1;
+}
+
+/* Pull the events other scheduler instances sent to our QIDs */
+static uint32_t
+sw_schedule_pull_xfer(struct sw_sched *sched)
+{
+	struct sw_evdev *sw = sched->sw;
+	struct rte_event evs[SCHED_DEQUEUE_MAX_BURST_SIZE];
+	uint32_t pkts_iter = 0;
+	uint32_t i, n;
+
+	n = rte_event_ring_dequeue_burst(sched->xfer_ring, evs,
+			sw->sched_deq_burst_size, NULL);
+	for (i = 0; i < n; i++) {
+		const struct rte_event *qe = &evs[i];
+		struct sw_qid *qid = &sw->qids[qe->queue_id];
+
+		pkts_iter += sw_qid_enqueue(sched, qid,
+				PRIO_TO_IQ(qe->priority), qe);
+	}
+
+	return pkts_iter;
+}
+
 /* This function will perform re-ordering of packets, and injecting into
  * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
  * contiguous in that array, this function accepts a "range" of QIDs to scan.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_sched *sched, int qid_start, int qid_end)
 {
 	/* Perform egress reordering */
+	struct sw_evdev *sw = sched->sw;
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
 
@@ -271,13 +348,14 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 		struct sw_qid *qid = &sw->qids[qid_start];
 		unsigned int i, num_entries_in_use;
 
-		if (qid->type != RTE_SCHED_TYPE_ORDERED)
+		if (qid->type != RTE_SCHED_TYPE_ORDERED ||
+				qid->sched != sched->idx)
 			continue;
 
 		num_entries_in_use = rob_ring_free_count(
 					qid->reorder_buffer_freelist);
 
-		if (num_entries_in_use < sw->sched_min_burst)
+		if (num_entries_in_use < sched->sched_min_burst)
 			num_entries_in_use = 0;
 
 		for (i = 0; i < num_entries_in_use; i++) {
@@ -300,22 +378,16 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				dest_iq  = PRIO_TO_IQ(qe->priority);
 
 				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+					sched->stats.rx_dropped++;
 					continue;
 				}
 
-				pkts_iter++;
-
-				struct sw_qid *q = &sw->qids[dest_qid];
-				struct sw_iq *iq = &q->iq[dest_iq];
-
 				/* we checked for space above, so enqueue must
 				 * succeed
 				 */
-				iq_enqueue(sw, iq, qe);
-				q->iq_pkt_mask |= (1 << (dest_iq));
-				q->iq_pkt_count[dest_iq]++;
-				q->stats.rx_pkts++;
+				pkts_iter += sw_qid_enqueue(sched,
+						&sw->qids[dest_qid], dest_iq,
+						qe);
 			}
 
 			entry->ready = (j != entry->num_fragments);
@@ -338,25 +410,25 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 }
 
 static __rte_always_inline void
-sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
+sw_refill_pp_buf(struct sw_sched *sched, struct sw_port *port)
 {
-	RTE_SET_USED(sw);
 	struct rte_event_ring *worker = port->rx_worker_ring;
 	port->pp_buf_start = 0;
 	port->pp_buf_count = rte_event_ring_dequeue_burst(worker, port->pp_buf,
-			sw->sched_deq_burst_size, NULL);
+			sched->sw->sched_deq_burst_size, NULL);
 }
 
 static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_sched *sched, uint32_t port_id, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
+	struct sw_evdev *sw = sched->sw;
 	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_port *port = &sched->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (!sw->refill_once_per_iter && port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(sched, port);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -427,7 +499,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				 */
 				int num_frag = rob_entry->num_fragments;
 				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
+					sched->stats.rx_dropped++;
 				else {
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
@@ -438,12 +510,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 			/* Use the iq_num from above to push the QE
 			 * into the qid at the right priority
 			 */
-
-			qid->iq_pkt_mask |= (1 << (iq_num));
-			iq_enqueue(sw, &qid->iq[iq_num], qe);
-			qid->iq_pkt_count[iq_num]++;
-			qid->stats.rx_pkts++;
-			pkts_iter++;
+			pkts_iter += sw_qid_enqueue(sched, qid, iq_num, qe);
 		}
 
 end_qe:
@@ -455,26 +522,27 @@ end_qe:
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_sched *sched, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(sched, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_sched *sched, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(sched, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_sched *sched, uint32_t port_id)
 {
+	struct sw_evdev *sw = sched->sw;
 	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_port *port = &sched->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (!sw->refill_once_per_iter && port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(sched, port);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -485,18 +553,13 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 
 		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
-		struct sw_iq *iq = &qid->iq[iq_num];
 
 		port->stats.rx_pkts++;
 
 		/* Use the iq_num from above to push the QE
 		 * into the qid at the right priority
 		 */
-		qid->iq_pkt_mask |= (1 << (iq_num));
-		iq_enqueue(sw, iq, qe);
-		qid->iq_pkt_count[iq_num]++;
-		qid->stats.rx_pkts++;
-		pkts_iter++;
+		pkts_iter += sw_qid_enqueue(sched, qid, iq_num, qe);
 
 end_qe:
 		port->pp_buf_start++;
@@ -506,16 +569,16 @@ end_qe:
 	return pkts_iter;
 }
 
-void
-sw_event_schedule(struct rte_eventdev *dev)
+static void
+sw_schedule_instance(struct sw_sched *sched)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_evdev *sw = sched->sw;
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	sched->sched_called++;
 	if (unlikely(!sw->started))
 		return;
 
@@ -526,26 +589,38 @@ sw_event_schedule(struct rte_eventdev *dev)
 		do {
 			in_pkts = 0;
 			for (i = 0; i < sw->port_count; i++) {
-				/* ack the unlinks in progress as done */
-				if (sw->ports[i].unlinks_in_progress)
-					sw->ports[i].unlinks_in_progress = 0;
+				/* port config is only kept in the device */
+				const struct sw_port *cfg = &sw->ports[i];
 
-				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
-				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+				/* ack the unlinks in progress as done */
+				if (sched->ports[i].unlinks_in_progress)
+					sched->ports[i].unlinks_in_progress = 0;
+
+				if (cfg->is_directed)
+					in_pkts += sw_schedule_pull_port_dir(
+							sched, i);
+				else if (cfg->num_ordered_qids > 0)
+					in_pkts += sw_schedule_pull_port_lb(
+							sched, i);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(
+							sched, i);
 			}
 
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
+			in_pkts += sw_schedule_reorder(sched, 0,
 					sw->qid_count);
+
+			/* Events handed over by the other instances */
+			if (sw->nb_scheds > 1) {
+				sw_schedule_xfer_flush_all(sched);
+				in_pkts += sw_schedule_pull_xfer(sched);
+			}
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
-		out_pkts = sw_schedule_qid_to_cq(sw);
+		out_pkts = sw_schedule_qid_to_cq(sched);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -553,14 +628,14 @@ sw_event_schedule(struct rte_eventdev *dev)
 			break;
 	} while ((int)out_pkts_total < sched_quanta);
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	sched->stats.tx_pkts += out_pkts_total;
+	sched->stats.rx_pkts += in_pkts_total;
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	sched->sched_no_iq_enqueues += (in_pkts_total == 0);
+	sched->sched_no_cq_enqueues += (out_pkts_total == 0);
 
 	uint64_t work_done = (in_pkts_total + out_pkts_total) != 0;
-	sw->sched_progress_last_iter = work_done;
+	sched->sched_progress_last_iter = work_done;
 
 	uint64_t cqs_scheds_last_iter = 0;
 
@@ -569,45 +644,73 @@ sw_event_schedule(struct rte_eventdev *dev)
 	 */
 	int no_enq = 1;
 	for (i = 0; i < sw->port_count; i++) {
-		struct sw_port *port = &sw->ports[i];
+		struct sw_port *port = &sched->ports[i];
 		struct rte_event_ring *worker = port->cq_worker_ring;
 
 		/* If shadow ring has 0 pkts, pull from worker ring */
 		if (sw->refill_once_per_iter && port->pp_buf_count == 0)
-			sw_refill_pp_buf(sw, port);
+			sw_refill_pp_buf(sched, port);
 
-		if (port->cq_buf_count >= sw->sched_min_burst) {
+		if (port->cq_buf_count >= sched->sched_min_burst) {
 			rte_event_ring_enqueue_burst(worker,
 					port->cq_buf,
 					port->cq_buf_count,
-					&sw->cq_ring_space[i]);
+					&sched->cq_ring_space[i]);
 			port->cq_buf_count = 0;
 			no_enq = 0;
 			cqs_scheds_last_iter |= (1ULL << i);
 		} else {
-			sw->cq_ring_space[i] =
+			sched->cq_ring_space[i] =
 					rte_event_ring_free_count(worker) -
 					port->cq_buf_count;
 		}
 	}
 
 	if (no_enq) {
-		if (unlikely(sw->sched_flush_count > SCHED_NO_ENQ_CYCLE_FLUSH))
-			sw->sched_min_burst = 1;
+		if (unlikely(sched->sched_flush_count >
+				SCHED_NO_ENQ_CYCLE_FLUSH))
+			sched->sched_min_burst = 1;
 		else
-			sw->sched_flush_count++;
+			sched->sched_flush_count++;
 	} else {
-		if (sw->sched_flush_count)
-			sw->sched_flush_count--;
+		if (sched->sched_flush_count)
+			sched->sched_flush_count--;
 		else
-			sw->sched_min_burst = sw->sched_min_burst_size;
+			sched->sched_min_burst = sw->sched_min_burst_size;
 	}
 
 	/* Provide stats on what eventdev ports were scheduled to this
 	 * iteration. If more than 64 ports are active, always report that
 	 * all Eventdev ports have been scheduled events.
 	 */
-	sw->sched_last_iter_bitmask = cqs_scheds_last_iter;
+	sched->sched_last_iter_bitmask = cqs_scheds_last_iter;
 	if (unlikely(sw->port_count >= 64))
-		sw->sched_last_iter_bitmask = UINT64_MAX;
+		sched->sched_last_iter_bitmask = UINT64_MAX;
+}
+
+void
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i, start;
+
+	if (sw->nb_scheds == 1) {
+		sw_schedule_instance(&sw->scheds[0]);
+		return;
+	}
+
+	/* The service may run on several cores at once. Each core runs every
+	 * instance not already being run by another core, starting from an
+	 * lcore dependent offset so that the cores spread across instances.
+	 */
+	start = rte_lcore_id() % sw->nb_scheds;
+	for (i = 0; i < sw->nb_scheds; i++) {
+		struct sw_sched *sched =
+				&sw->scheds[(start + i) % sw->nb_scheds];
+
+		if (!rte_spinlock_trylock(&sched->lock))
+			continue;
+		sw_schedule_instance(sched);
+		rte_spinlock_unlock(&sched->lock);
+	}
 }
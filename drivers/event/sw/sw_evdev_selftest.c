@@ -2962,6 +2962,180 @@ err:
 	return -1;
 }
 
+#define MULTI_SCHED_EVENTS 32
+
+static void
+multi_sched_run(uint32_t service_id)
+{
+	int i;
+
+	/* a few iterations to let events cross the scheduler instances */
+	for (i = 0; i < 4; i++)
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+}
+
+static int
+multi_sched_forward(struct test *t, const uint8_t ports[], int nb_ports,
+		uint8_t queue_id, uint32_t service_id)
+{
+	struct rte_event ev[MAX_PORTS][MULTI_SCHED_EVENTS];
+	uint16_t nb_deq[MAX_PORTS];
+	uint32_t total = 0;
+	int i, j;
+
+	for (i = 0; i < nb_ports; i++) {
+		nb_deq[i] = rte_event_dequeue_burst(evdev, t->port[ports[i]],
+				ev[i], MULTI_SCHED_EVENTS, 0);
+		total += nb_deq[i];
+	}
+	if (total != MULTI_SCHED_EVENTS) {
+		printf("%d: expected %d events for qid %u got %u\n", __LINE__,
+				MULTI_SCHED_EVENTS, queue_id, total);
+		rte_event_dev_dump(evdev, stdout);
+		return -1;
+	}
+
+	/* forward in reverse port order, so ordered events need reordering */
+	for (i = nb_ports - 1; i >= 0; i--) {
+		for (j = 0; j < nb_deq[i]; j++) {
+			ev[i][j].op = RTE_EVENT_OP_FORWARD;
+			ev[i][j].queue_id = t->qid[queue_id];
+		}
+		if (rte_event_enqueue_burst(evdev, t->port[ports[i]], ev[i],
+				nb_deq[i]) != nb_deq[i]) {
+			printf("%d: Failed to forward events\n", __LINE__);
+			return -1;
+		}
+	}
+	multi_sched_run(service_id);
+
+	return 0;
+}
+
+static int
+multi_sched(struct test *t)
+{
+	/* Device with two scheduler instances: qid0 (ordered) and qid2
+	 * (directed) are owned by instance 0, qid1 (atomic) by instance 1,
+	 * so events cross instances at every stage of the pipeline:
+	 *
+	 * rx_port - qid0 - w1_port/w2_port - qid1 - w1_port/w2_port - qid2
+	 *                                                               |
+	 *                                                            tx_port
+	 */
+	const char *eventdev_name = "event_sw_multi_sched";
+	const uint8_t rx_port = 0;
+	const uint8_t workers[] = { 1, 2 };
+	const uint8_t tx_port = 3;
+	struct rte_event ev[MULTI_SCHED_EVENTS];
+	int main_evdev = evdev;
+	uint32_t service_id;
+	int ret = -1;
+	int i;
+
+	if (rte_vdev_init(eventdev_name, "sched_instances=2") < 0) {
+		printf("%d: Error creating eventdev\n", __LINE__);
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		printf("%d: Error finding newly created eventdev\n", __LINE__);
+		goto out;
+	}
+
+	if (init(t, 3, tx_port + 1) < 0 ||
+			create_ports(t, tx_port + 1) < 0 ||
+			create_ordered_qids(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			create_directed_qids(t, 1, &tx_port) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		goto out;
+	}
+
+	for (i = 0; i < (int)RTE_DIM(workers); i++) {
+		if (rte_event_port_link(evdev, t->port[workers[i]], &t->qid[0],
+				NULL, 2) != 2) {
+			printf("%d: error mapping lb qids\n", __LINE__);
+			goto out_cleanup;
+		}
+	}
+
+	if (rte_event_dev_service_id_get(evdev, &service_id) < 0 ||
+			rte_service_probe_capability(service_id,
+				RTE_SERVICE_CAP_MT_SAFE) != 1) {
+		printf("%d: Expected an MT safe scheduler service\n", __LINE__);
+		goto out_cleanup;
+	}
+	rte_service_runstate_set(service_id, 1);
+	rte_service_set_runstate_mapped_check(service_id, 0);
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		goto out_cleanup;
+	}
+
+	for (i = 0; i < MULTI_SCHED_EVENTS; i++) {
+		ev[i] = (struct rte_event){
+			.op = RTE_EVENT_OP_NEW,
+			.queue_id = t->qid[0],
+			.flow_id = 0,
+			.u64 = i,
+		};
+	}
+	if (rte_event_enqueue_burst(evdev, t->port[rx_port], ev,
+			MULTI_SCHED_EVENTS) != MULTI_SCHED_EVENTS) {
+		printf("%d: Failed to enqueue events\n", __LINE__);
+		goto out_cleanup;
+	}
+	multi_sched_run(service_id);
+
+	if (multi_sched_forward(t, workers, RTE_DIM(workers), 1,
+				service_id) < 0 ||
+			multi_sched_forward(t, workers, RTE_DIM(workers), 2,
+				service_id) < 0)
+		goto out_cleanup;
+
+	if (rte_event_dequeue_burst(evdev, t->port[tx_port], ev,
+			MULTI_SCHED_EVENTS, 0) != MULTI_SCHED_EVENTS) {
+		printf("%d: Failed to dequeue events at tx port\n", __LINE__);
+		rte_event_dev_dump(evdev, stdout);
+		goto out_cleanup;
+	}
+	for (i = 0; i < MULTI_SCHED_EVENTS; i++) {
+		if (ev[i].u64 != (uint64_t)i) {
+			printf("%d: Incorrect order, event %d is %"PRIu64"\n",
+					__LINE__, i, ev[i].u64);
+			goto out_cleanup;
+		}
+	}
+
+	/* release the events, all instances must end up with no inflights */
+	rte_event_dequeue_burst(evdev, t->port[tx_port], ev, 1, 0);
+	multi_sched_run(service_id);
+	for (i = 0; i <= tx_port; i++) {
+		char name[32];
+
+		snprintf(name, sizeof(name), "port_%u_inflight", i);
+		if (rte_event_dev_xstats_by_name_get(evdev, name, NULL) != 0) {
+			printf("%d: Port %d has inflight events\n", __LINE__,
+					i);
+			goto out_cleanup;
+		}
+	}
+	if (rte_event_dev_xstats_by_name_get(evdev, "dev_drop", NULL) != 0) {
+		printf("%d: Unexpected dropped events\n", __LINE__);
+		goto out_cleanup;
+	}
+
+	ret = 0;
+out_cleanup:
+	cleanup(t);
+out:
+	evdev = main_evdev;
+	rte_vdev_uninit(eventdev_name);
+	return ret;
+}
+
 static int
 worker_loopback_worker_fn(void *arg)
 {
@@ -3391,6 +3565,12 @@ test_sw_eventdev(void)
 		printf("ERROR - Stop Flush test FAILED.\n");
 		goto test_fail;
 	}
+	printf("*** Running Multiple Scheduler Instances test...\n");
+	ret = multi_sched(t);
+	if (ret != 0) {
+		printf("ERROR - Multiple Scheduler Instances test FAILED.\n");
+		goto test_fail;
+	}
 	if (rte_lcore_count() >= 3) {
 		printf("*** Running Worker loopback test...\n");
 		ret = worker_loopback(t, 0);
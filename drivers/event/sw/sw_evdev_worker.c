@@ -9,6 +9,28 @@
 #include "sw_evdev.h"
 
 #define PORT_ENQUEUE_MAX_BURST_SIZE 64
+#define PORT_SCHED_TAGS_MASK (SW_PORT_SCHED_TAGS - 1)
+
+/* Scheduler instance the given outstanding event of the port came from */
+static inline uint8_t
+sw_port_sched_tag(struct sw_port *p, uint32_t tag)
+{
+	return p->sched_tags[tag & PORT_SCHED_TAGS_MASK];
+}
+
+/* Scheduler instance the oldest outstanding event of the port came from */
+static inline uint8_t
+sw_port_sched_tag_pop(struct sw_port *p)
+{
+	return sw_port_sched_tag(p, p->sched_tag_tail++);
+}
+
+/* Ring to send events to the given scheduler instance */
+static inline struct rte_event_ring *
+sw_port_rx_ring(struct sw_port *p, uint8_t sched)
+{
+	return sw_sched_port(p->sw, sched, p->id)->rx_worker_ring;
+}
 
 static inline void
 sw_event_release(struct sw_port *p, uint8_t index)
@@ -23,8 +45,12 @@ sw_event_release(struct sw_port *p, uint8_t index)
 	struct rte_event ev;
 	ev.op = sw_qe_flag_map[RTE_EVENT_OP_RELEASE];
 
+	struct rte_event_ring *ring = p->rx_worker_ring;
+	if (p->sw->nb_scheds > 1)
+		ring = sw_port_rx_ring(p, sw_port_sched_tag_pop(p));
+
 	uint16_t free_count;
-	rte_event_ring_enqueue_burst(p->rx_worker_ring, &ev, 1, &free_count);
+	rte_event_ring_enqueue_burst(ring, &ev, 1, &free_count);
 
 	/* each release returns one credit */
 	p->outstanding_releases--;
@@ -49,11 +75,41 @@ enqueue_burst_with_ops(struct rte_event_ring *r, const struct rte_event *events,
 	return rte_event_ring_enqueue_burst(r, tmp_evs, n, NULL);
 }
 
+/*
+ * Split a burst across the scheduler instances: each run of consecutive
+ * events for the same instance goes to the port's ring for that instance.
+ */
+static inline unsigned int
+enqueue_burst_multi_sched(struct sw_port *p, const struct rte_event *events,
+		unsigned int n, uint8_t *ops, const uint8_t *scheds)
+{
+	unsigned int start = 0;
+
+	while (start < n) {
+		unsigned int end = start + 1;
+		unsigned int enq;
+
+		while (end < n && scheds[end] == scheds[start])
+			end++;
+
+		enq = enqueue_burst_with_ops(sw_port_rx_ring(p, scheds[start]),
+				&events[start], end - start, &ops[start]);
+		start += enq;
+		if (start != end)
+			break;
+	}
+
+	return start;
+}
+
 uint16_t
 sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 {
 	int32_t i;
 	uint8_t new_ops[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t scheds[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t tagged[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint32_t tag;
 	struct sw_port *p = port;
 	struct sw_evdev *sw = (void *)p->sw;
 	uint32_t sw_inflights = rte_atomic32_read(&sw->inflights);
@@ -83,6 +139,7 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 		num = (p->inflight_credits < new) ? p->inflight_credits : new;
 	}
 
+	tag = p->sched_tag_tail;
 	for (i = 0; i < num; i++) {
 		int op = ev[i].op;
 		int outstanding = p->outstanding_releases > 0;
@@ -102,6 +159,21 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 		if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding)
 			p->outstanding_releases--;
 
+		/* with several instances, completions go back to where the
+		 * event came from, and new events to the owner of the QID.
+		 * The tags are only consumed once the events are enqueued.
+		 */
+		if (sw->nb_scheds > 1) {
+			tagged[i] = (new_ops[i] & QE_FLAG_COMPLETE) &&
+					outstanding;
+			if (tagged[i])
+				scheds[i] = sw_port_sched_tag(p, tag++);
+			else if (new_ops[i] & QE_FLAG_VALID)
+				scheds[i] = sw->qids[ev[i].queue_id].sched;
+			else
+				scheds[i] = 0;
+		}
+
 		/* error case: branch to avoid touching p->stats */
 		if (unlikely(invalid_qid && op != RTE_EVENT_OP_RELEASE)) {
 			p->stats.rx_dropped++;
@@ -110,7 +182,21 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 	}
 
 	/* returns number of events actually enqueued */
-	uint32_t enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
+	uint32_t enq;
+	if (sw->nb_scheds > 1) {
+		enq = enqueue_burst_multi_sched(p, ev, i, new_ops, scheds);
+		for (i = 0; i < (int32_t)enq; i++)
+			p->sched_tag_tail += tagged[i];
+		/* the completions not enqueued stay outstanding for a retry */
+		for (; i < num; i++) {
+			if (!tagged[i])
+				continue;
+			p->outstanding_releases++;
+			p->inflight_credits -=
+				(ev[i].op == RTE_EVENT_OP_RELEASE);
+		}
+	} else
+		enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
 					     new_ops);
 	if (p->outstanding_releases == 0 && p->last_dequeue_burst_sz != 0) {
 		uint64_t burst_ticks = rte_get_timer_cycles() -
@@ -137,6 +223,43 @@ sw_event_enqueue(void *port, const struct rte_event *ev)
 	return sw_event_enqueue_burst(port, ev, 1);
 }
 
+/*
+ * Dequeue from the CQ rings of all scheduler instances, recording which
+ * instance each event came from. The first instance polled rotates across
+ * calls so that no instance is starved.
+ */
+static inline uint16_t
+dequeue_burst_multi_sched(struct sw_port *p, struct rte_event *ev,
+		uint16_t num)
+{
+	const struct sw_evdev *sw = p->sw;
+	uint32_t nb_scheds = sw->nb_scheds;
+	uint32_t sched = p->deq_sched;
+	uint16_t ndeq = 0;
+	uint32_t i;
+
+	for (i = 0; i < nb_scheds && ndeq < num; i++) {
+		struct rte_event_ring *ring =
+			sw_sched_port(sw, sched, p->id)->cq_worker_ring;
+		uint16_t n, j;
+
+		n = rte_event_ring_dequeue_burst(ring, &ev[ndeq], num - ndeq,
+				NULL);
+		for (j = 0; j < n; j++)
+			p->sched_tags[p->sched_tag_head++ &
+					PORT_SCHED_TAGS_MASK] = sched;
+		ndeq += n;
+
+		if (++sched == nb_scheds)
+			sched = 0;
+	}
+
+	if (++p->deq_sched == nb_scheds)
+		p->deq_sched = 0;
+
+	return ndeq;
+}
+
 uint16_t
 sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 		uint64_t wait)
@@ -144,6 +267,7 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 	RTE_SET_USED(wait);
 	struct sw_port *p = (void *)port;
 	struct rte_event_ring *ring = p->cq_worker_ring;
+	uint16_t ndeq;
 
 	/* check that all previous dequeues have been released */
 	if (p->implicit_release) {
@@ -162,7 +286,10 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 	}
 
 	/* returns number of events actually dequeued */
-	uint16_t ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
+	if (p->sw->nb_scheds > 1)
+		ndeq = dequeue_burst_multi_sched(p, ev, num);
+	else
+		ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
 	if (unlikely(ndeq == 0)) {
 		p->zero_polls++;
 		p->total_polls++;
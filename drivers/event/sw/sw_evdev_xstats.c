@@ -48,20 +48,55 @@ struct sw_xstats_entry {
 	uint64_t reset_value; /* an offset to be taken away to emulate resets */
 };
 
+static uint64_t
+get_sched_stat(const struct sw_sched *sched, enum xstats_type type)
+{
+	switch (type) {
+	case rx: return sched->stats.rx_pkts;
+	case tx: return sched->stats.tx_pkts;
+	case dropped: return sched->stats.rx_dropped;
+	case calls: return sched->sched_called;
+	case no_iq_enq: return sched->sched_no_iq_enqueues;
+	case no_cq_enq: return sched->sched_no_cq_enqueues;
+	case sched_last_iter_bitmask: return sched->sched_last_iter_bitmask;
+	case sched_progress_last_iter: return sched->sched_progress_last_iter;
+
+	default: return -1;
+	}
+}
+
 static uint64_t
 get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
-	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
-	case sched_last_iter_bitmask: return sw->sched_last_iter_bitmask;
-	case sched_progress_last_iter: return sw->sched_progress_last_iter;
+	uint64_t val = 0;
+	uint32_t i;
+
+	/* device stats are the combination of all scheduler instances */
+	for (i = 0; i < sw->nb_scheds; i++) {
+		uint64_t sched_val = get_sched_stat(&sw->scheds[i], type);
+
+		if (type == sched_last_iter_bitmask ||
+				type == sched_progress_last_iter)
+			val |= sched_val;
+		else
+			val += sched_val;
+	}
 
+	return val;
+}
+
+static uint64_t
+get_port_sched_stat(const struct sw_port *p, enum xstats_type type)
+{
+	switch (type) {
+	case rx: return p->stats.rx_pkts;
+	case tx: return p->stats.tx_pkts;
+	case inflight: return p->inflights;
+	case rx_used: return rte_event_ring_count(p->rx_worker_ring);
+	case rx_free: return rte_event_ring_free_count(p->rx_worker_ring);
+	case tx_used: return rte_event_ring_count(p->cq_worker_ring);
+	case tx_free: return rte_event_ring_free_count(p->cq_worker_ring);
 	default: return -1;
 	}
 }
@@ -71,20 +106,27 @@ get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
 	const struct sw_port *p = &sw->ports[obj_idx];
+	uint64_t val = 0;
+	uint32_t i;
 
 	switch (type) {
-	case rx: return p->stats.rx_pkts;
-	case tx: return p->stats.tx_pkts;
 	case dropped: return p->stats.rx_dropped;
-	case inflight: return p->inflights;
 	case pkt_cycles: return p->avg_pkt_ticks;
 	case calls: return p->total_polls;
 	case credits: return p->inflight_credits;
 	case poll_return: return p->zero_polls;
-	case rx_used: return rte_event_ring_count(p->rx_worker_ring);
-	case rx_free: return rte_event_ring_free_count(p->rx_worker_ring);
-	case tx_used: return rte_event_ring_count(p->cq_worker_ring);
-	case tx_free: return rte_event_ring_free_count(p->cq_worker_ring);
+	case rx:
+	case tx:
+	case inflight:
+	case rx_used:
+	case rx_free:
+	case tx_used:
+	case tx_free:
+		/* summed over the rings of all scheduler instances */
+		for (i = 0; i < sw->nb_scheds; i++)
+			val += get_port_sched_stat(
+					sw_sched_port(sw, i, obj_idx), type);
+		return val;
 	default: return -1;
 	}
 }
@@ -17,6 +17,7 @@
 #include "rte_eth_bond.h"
 #include "eth_bond_8023ad_private.h"
 #include "rte_eth_bond_alb.h"
+#include "rte_eth_bond_adaptive.h"
 
 #define PMD_BOND_SLAVE_PORT_KVARG			("slave")
 #define PMD_BOND_PRIMARY_SLAVE_KVARG		("primary")
@@ -28,6 +29,7 @@
 #define PMD_BOND_LSC_POLL_PERIOD_KVARG		("lsc_poll_period_ms")
 #define PMD_BOND_LINK_UP_PROP_DELAY_KVARG	("up_delay")
 #define PMD_BOND_LINK_DOWN_PROP_DELAY_KVARG	("down_delay")
+#define PMD_BOND_XMIT_ADAPTIVE_KVARG		("xmit_adaptive")
 
 #define PMD_BOND_XMIT_POLICY_LAYER2_KVARG	("l2")
 #define PMD_BOND_XMIT_POLICY_LAYER23_KVARG	("l23")
@@ -72,6 +74,8 @@ struct bond_tx_queue {
 	/**< Number of TX descriptors available for the queue */
 	struct rte_eth_txconf tx_conf;
 	/**< Copy of TX configuration structure for queue */
+	struct bond_tx_adaptive *adaptive;
+	/**< Adaptive transmit state, NULL if not enabled */
 };
 
 /** Bonded slave devices structure */
@@ -121,6 +125,8 @@ struct bond_dev_private {
 	/**< Transmit policy - l2 / l23 / l34 for operation in balance mode */
 	burst_xmit_hash_t burst_xmit_hash;
 	/**< Transmit policy hash function */
+	uint32_t xmit_adaptive_period_ms;
+	/**< Adaptive transmit rebalancing period, 0 if disabled */
 
 	uint8_t user_defined_mac;
 	/**< Flag for whether MAC address is user defined or not */
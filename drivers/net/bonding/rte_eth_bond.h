@@ -21,6 +21,7 @@
 extern "C" {
 #endif
 
+#include <rte_compat.h>
 #include <rte_ether.h>
 
 /* Supported modes of operation of link bonding library  */
@@ -264,6 +265,45 @@ rte_eth_bond_xmit_policy_set(uint16_t bonded_port_id, uint8_t policy);
 int
 rte_eth_bond_xmit_policy_get(uint16_t bonded_port_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable the adaptive transmit policy of the balance and 802.3ad modes, on a
+ * stopped bonded device.
+ *
+ * Packets are hashed to buckets according to the transmit policy, and every
+ * period the busiest bucket of a slave refusing packets or having a deep Tx
+ * queue is moved to the least loaded slave. The packets of a flow are not
+ * reordered by a move. Bucket mappings and moves are reported in the
+ * extended statistics.
+ *
+ * @param bonded_port_id	Port ID of bonded device.
+ * @param period_ms		Rebalancing period in milliseconds, 0 to disable.
+ *
+ * @return
+ *	0 on success, negative value otherwise.
+ */
+__rte_experimental
+int
+rte_eth_bond_xmit_adaptive_set(uint16_t bonded_port_id, uint32_t period_ms);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the rebalancing period of the adaptive transmit policy.
+ *
+ * @param bonded_port_id	Port ID of bonded device.
+ *
+ * @return
+ *	Rebalancing period in milliseconds, 0 if disabled, negative value on
+ *	error.
+ */
+__rte_experimental
+int
+rte_eth_bond_xmit_adaptive_get(uint16_t bonded_port_id);
+
 /**
  * Set the link monitoring frequency (in ms) for monitoring the link status of
  * slave devices
@@ -859,6 +859,29 @@ bond_mode_8023ad_dedicated_rxq_process(struct bond_dev_private *internals,
 	}
 }
 
+/* Send the control frames queued in tx_ring on the dedicated Tx queue. */
+static void
+bond_mode_8023ad_dedicated_txq_process(struct bond_dev_private *internals,
+			uint16_t slave_id)
+{
+	struct port *port = &bond_mode_8023ad_ports[slave_id];
+	struct rte_mbuf *pkts[DEDICATED_QUEUE_BURST_SIZE];
+	uint16_t nb_pkts, tx_count;
+
+	nb_pkts = rte_ring_dequeue_burst(port->tx_ring, (void **)pkts,
+			DEDICATED_QUEUE_BURST_SIZE, NULL);
+	if (nb_pkts == 0)
+		return;
+
+	tx_count = rte_eth_tx_burst(slave_id,
+			internals->mode4.dedicated_queues.tx_qid, pkts, nb_pkts);
+	if (tx_count < nb_pkts) {
+		/* Retransmission will happen in next function call. */
+		rte_pktmbuf_free_bulk(&pkts[tx_count], nb_pkts - tx_count);
+		set_warning_flags(port, WRN_TX_QUEUE_FULL);
+	}
+}
+
 static void
 bond_mode_8023ad_periodic_cb(void *arg)
 {
@@ -1697,6 +1720,10 @@ bond_mode_8023ad_ext_periodic_cb(void *arg)
 			 */
 			mode4->slowrx_cb(slave_id, lacp_pkt);
 		}
+
+		if (mode4->dedicated_queues.enabled == 1)
+			bond_mode_8023ad_dedicated_txq_process(internals,
+					slave_id);
 	}
 
 	rte_eal_alarm_set(internals->mode4.update_timeout_us,
@@ -0,0 +1,264 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+
+#include "eth_bond_private.h"
+
+/* Number of per queue xstats, besides the bucket mappings */
+#define BOND_ADAPTIVE_QUEUE_XSTATS 3
+
+void
+bond_adaptive_reset(struct bond_tx_adaptive *ad, uint32_t period_ms)
+{
+	uint32_t i;
+
+	memset(ad, 0, sizeof(*ad));
+	for (i = 0; i < BOND_ADAPTIVE_BUCKETS; i++)
+		ad->bucket_port[i] = BOND_ADAPTIVE_NO_PORT;
+	ad->move_bucket = -1;
+	ad->period = rte_get_tsc_hz() * period_ms / 1000;
+	ad->next_rebalance = rte_get_tsc_cycles() + ad->period;
+}
+
+/*
+ * The most recent descriptor of a Tx queue is the one before its tail, it
+ * is done once the queue is drained.
+ */
+static int
+slave_txq_drained(uint16_t port, uint16_t queue_id, uint16_t nb_desc)
+{
+	return rte_eth_tx_descriptor_status(port, queue_id, nb_desc - 1) !=
+		RTE_ETH_TX_DESC_FULL;
+}
+
+/* Whether the Tx queue of a slave is at least three quarters full. */
+static int
+slave_txq_deep(uint16_t port, uint16_t queue_id, uint16_t nb_desc)
+{
+	return rte_eth_tx_descriptor_status(port, queue_id, nb_desc / 4) ==
+		RTE_ETH_TX_DESC_FULL;
+}
+
+void
+bond_adaptive_move_update(struct bond_tx_adaptive *ad, const uint16_t *slaves,
+		uint16_t slave_count, uint16_t queue_id, uint16_t nb_desc,
+		uint64_t now)
+{
+	uint16_t idx = ad->slave_idx[ad->move_src];
+	int done;
+
+	if (idx >= slave_count || slaves[idx] != ad->move_src)
+		/* the old slave is down, nothing to wait for */
+		done = 1;
+	else if (!ad->move_hold)
+		done = now - ad->bucket_last[ad->move_bucket] >= ad->period;
+	else if (now - ad->move_start >= ad->period)
+		/* the old slave does not transmit, stop holding packets */
+		done = 1;
+	else
+		done = slave_txq_drained(ad->move_src, queue_id, nb_desc);
+
+	if (!done)
+		return;
+
+	ad->bucket_port[ad->move_bucket] = ad->move_dst;
+	ad->move_bucket = -1;
+	ad->moves++;
+}
+
+void
+bond_adaptive_rebalance(struct bond_tx_adaptive *ad, const uint16_t *slaves,
+		uint16_t slave_count, uint16_t queue_id, uint16_t nb_desc,
+		uint64_t now)
+{
+	int src = -1, dst = -1;
+	uint32_t b, best_pkts;
+	int best = -1;
+	uint16_t i, port;
+	int congested;
+
+	ad->next_rebalance = now + ad->period;
+
+	if (ad->move_bucket >= 0 || slave_count < 2)
+		goto new_period;
+
+	/*
+	 * Move from the congested slave refusing the most packets, to the
+	 * slave with the least packets among the others.
+	 */
+	for (i = 0; i < slave_count; i++) {
+		port = slaves[i];
+		congested = ad->slave_fails[port] != 0 ||
+			slave_txq_deep(port, queue_id, nb_desc);
+		if (congested) {
+			if (src < 0 || ad->slave_fails[port] >
+					ad->slave_fails[slaves[src]])
+				src = i;
+		} else if (dst < 0 || ad->slave_pkts[port] <
+				ad->slave_pkts[slaves[dst]]) {
+			dst = i;
+		}
+	}
+	if (src < 0 || dst < 0)
+		goto new_period;
+
+	/*
+	 * Move the busiest bucket of the congested slave, unless it is all its
+	 * traffic: the other slave would then get congested in turn.
+	 */
+	best_pkts = 0;
+	for (b = 0; b < BOND_ADAPTIVE_BUCKETS; b++) {
+		if (ad->bucket_pkts[b] <= best_pkts ||
+				bond_adaptive_slave_idx(ad, b, slaves,
+					slave_count) != src)
+			continue;
+		if (ad->bucket_pkts[b] >= ad->slave_pkts[slaves[src]] +
+				ad->slave_fails[slaves[src]])
+			continue;
+		best = b;
+		best_pkts = ad->bucket_pkts[b];
+	}
+	if (best < 0)
+		goto new_period;
+
+	ad->move_bucket = best;
+	ad->move_src = slaves[src];
+	ad->move_dst = slaves[dst];
+	ad->move_start = now;
+	ad->move_hold = rte_eth_tx_descriptor_status(ad->move_src, queue_id,
+			nb_desc - 1) >= 0;
+	ad->rebalances++;
+
+new_period:
+	memset(ad->bucket_pkts, 0, sizeof(ad->bucket_pkts));
+	memset(ad->slave_pkts, 0, sizeof(ad->slave_pkts));
+	memset(ad->slave_fails, 0, sizeof(ad->slave_fails));
+}
+
+/* Slaves the buckets are distributed on, as by the Tx burst. */
+static uint16_t
+adaptive_slaves_get(struct bond_dev_private *internals, uint16_t *slaves)
+{
+	uint16_t i, count = 0;
+
+	for (i = 0; i < internals->active_slave_count; i++) {
+		if (internals->mode == BONDING_MODE_8023AD &&
+				!ACTOR_STATE(&bond_mode_8023ad_ports[
+					internals->active_slaves[i]],
+					DISTRIBUTING))
+			continue;
+		slaves[count++] = internals->active_slaves[i];
+	}
+	return count;
+}
+
+static unsigned int
+adaptive_xstats_count(struct rte_eth_dev *dev)
+{
+	struct bond_tx_queue *txq;
+	unsigned int count = 0;
+	uint16_t q;
+
+	for (q = 0; q < dev->data->nb_tx_queues; q++) {
+		txq = dev->data->tx_queues[q];
+		if (txq != NULL && txq->adaptive != NULL)
+			count += BOND_ADAPTIVE_QUEUE_XSTATS +
+				BOND_ADAPTIVE_BUCKETS;
+	}
+	return count;
+}
+
+int
+bond_adaptive_xstats_get_names(struct rte_eth_dev *dev,
+		struct rte_eth_xstat_name *names, unsigned int size)
+{
+	unsigned int count = adaptive_xstats_count(dev);
+	struct bond_tx_queue *txq;
+	unsigned int n = 0;
+	uint16_t q, b;
+
+	if (names == NULL || size < count)
+		return count;
+
+	for (q = 0; q < dev->data->nb_tx_queues; q++) {
+		txq = dev->data->tx_queues[q];
+		if (txq == NULL || txq->adaptive == NULL)
+			continue;
+		snprintf(names[n++].name, RTE_ETH_XSTATS_NAME_SIZE,
+			"tx_q%u_adaptive_rebalances", q);
+		snprintf(names[n++].name, RTE_ETH_XSTATS_NAME_SIZE,
+			"tx_q%u_adaptive_bucket_moves", q);
+		snprintf(names[n++].name, RTE_ETH_XSTATS_NAME_SIZE,
+			"tx_q%u_adaptive_held_packets", q);
+		for (b = 0; b < BOND_ADAPTIVE_BUCKETS; b++)
+			snprintf(names[n++].name, RTE_ETH_XSTATS_NAME_SIZE,
+				"tx_q%u_bucket%u_slave_port", q, b);
+	}
+	return count;
+}
+
+int
+bond_adaptive_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
+		unsigned int n)
+{
+	struct bond_dev_private *internals = dev->data->dev_private;
+	unsigned int count = adaptive_xstats_count(dev);
+	uint16_t slaves[RTE_MAX_ETHPORTS];
+	struct bond_tx_adaptive *ad;
+	struct bond_tx_queue *txq;
+	uint16_t q, b, port, slave_count;
+	unsigned int i = 0;
+
+	if (xstats == NULL || n < count)
+		return count;
+
+	slave_count = adaptive_slaves_get(internals, slaves);
+
+	for (q = 0; q < dev->data->nb_tx_queues; q++) {
+		txq = dev->data->tx_queues[q];
+		if (txq == NULL || txq->adaptive == NULL)
+			continue;
+		ad = txq->adaptive;
+		xstats[i++].value = ad->rebalances;
+		xstats[i++].value = ad->moves;
+		xstats[i++].value = ad->held_pkts;
+		for (b = 0; b < BOND_ADAPTIVE_BUCKETS; b++) {
+			/* RTE_MAX_ETHPORTS when there is no slave */
+			port = ad->bucket_port[b];
+			if (slave_count == 0)
+				port = RTE_MAX_ETHPORTS;
+			else if (port == BOND_ADAPTIVE_NO_PORT ||
+					find_slave_by_id(slaves, slave_count,
+						port) == slave_count)
+				port = slaves[b % slave_count];
+			xstats[i++].value = port;
+		}
+	}
+
+	for (i = 0; i < count; i++)
+		xstats[i].id = i;
+
+	return count;
+}
+
+void
+bond_adaptive_xstats_reset(struct rte_eth_dev *dev)
+{
+	struct bond_tx_queue *txq;
+	uint16_t q;
+
+	for (q = 0; q < dev->data->nb_tx_queues; q++) {
+		txq = dev->data->tx_queues[q];
+		if (txq == NULL || txq->adaptive == NULL)
+			continue;
+		txq->adaptive->rebalances = 0;
+		txq->adaptive->moves = 0;
+		txq->adaptive->held_pkts = 0;
+	}
+}
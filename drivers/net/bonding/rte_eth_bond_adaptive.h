@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef RTE_ETH_BOND_ADAPTIVE_H_
+#define RTE_ETH_BOND_ADAPTIVE_H_
+
+#include <stdint.h>
+
+#include <ethdev_driver.h>
+
+/*
+ * Adaptive transmit hashing of the balance and 802.3ad modes.
+ *
+ * Packets are hashed to buckets, each bucket being sent on one slave. A
+ * bucket is mapped to a slave by the static modulo of the transmit policy,
+ * unless the rebalancing moved it to another slave. Once per period, a
+ * bucket of a congested slave, one which refused packets or has a deep Tx
+ * queue, is moved to the least loaded slave which is not congested.
+ *
+ * Not to reorder the packets of a flow, the move of a bucket completes
+ * once the packets it sent on the old slave are transmitted: its packets
+ * are held, i.e. not accepted by the Tx burst, until the Tx queue of the old
+ * slave is drained. For slaves not reporting the Tx descriptor status, the
+ * bucket moves once it has not sent packets for a period instead.
+ */
+
+#define BOND_ADAPTIVE_BUCKETS		64
+/**< Number of hash buckets per Tx queue, must be a power of 2 */
+#define BOND_ADAPTIVE_NO_PORT		RTE_MAX_ETHPORTS
+/**< Bucket mapped with the static modulo */
+
+/** Adaptive transmit state of a bonded Tx queue */
+struct bond_tx_adaptive {
+	uint64_t period;
+	/**< Rebalancing period in TSC cycles */
+	uint64_t next_rebalance;
+	/**< TSC of the next rebalancing */
+
+	uint16_t bucket_port[BOND_ADAPTIVE_BUCKETS];
+	/**< Slave port of the moved buckets, BOND_ADAPTIVE_NO_PORT otherwise */
+	uint32_t bucket_pkts[BOND_ADAPTIVE_BUCKETS];
+	/**< Packets of the buckets in the current period */
+	uint64_t bucket_last[BOND_ADAPTIVE_BUCKETS];
+	/**< TSC of the last packet of the buckets */
+
+	uint16_t slave_idx[RTE_MAX_ETHPORTS];
+	/**< Index of the slave ports in the slaves of the last Tx burst */
+	uint32_t slave_pkts[RTE_MAX_ETHPORTS];
+	/**< Packets sent to the slaves in the current period */
+	uint32_t slave_fails[RTE_MAX_ETHPORTS];
+	/**< Packets refused by the slaves in the current period */
+
+	int move_bucket;
+	/**< Bucket being moved, -1 if none */
+	uint16_t move_src;
+	/**< Slave port the bucket is moved from */
+	uint16_t move_dst;
+	/**< Slave port the bucket is moved to */
+	uint8_t move_hold;
+	/**< Hold the bucket packets until the Tx queue of move_src drains */
+	uint64_t move_start;
+	/**< TSC of the beginning of the move */
+
+	uint64_t rebalances;
+	/**< Rebalancing events, i.e. bucket moves started */
+	uint64_t moves;
+	/**< Bucket moves completed */
+	uint64_t held_pkts;
+	/**< Packets held while moving a bucket */
+};
+
+/* Index, in the slaves of the Tx burst, of the slave of a bucket. */
+static inline uint16_t
+bond_adaptive_slave_idx(const struct bond_tx_adaptive *ad, uint32_t bucket,
+		const uint16_t *slaves, uint16_t slave_count)
+{
+	uint16_t port = ad->bucket_port[bucket];
+	uint16_t idx;
+
+	if (port != BOND_ADAPTIVE_NO_PORT) {
+		idx = ad->slave_idx[port];
+		if (idx < slave_count && slaves[idx] == port)
+			return idx;
+	}
+	return bucket % slave_count;
+}
+
+/* Reset the state of a Tx queue, with the rebalancing period in ms. */
+void
+bond_adaptive_reset(struct bond_tx_adaptive *ad, uint32_t period_ms);
+
+/* Complete the pending bucket move if its old slave drained. */
+void
+bond_adaptive_move_update(struct bond_tx_adaptive *ad, const uint16_t *slaves,
+		uint16_t slave_count, uint16_t queue_id, uint16_t nb_desc,
+		uint64_t now);
+
+/* Start moving a bucket of a congested slave and start a new period. */
+void
+bond_adaptive_rebalance(struct bond_tx_adaptive *ad, const uint16_t *slaves,
+		uint16_t slave_count, uint16_t queue_id, uint16_t nb_desc,
+		uint64_t now);
+
+int
+bond_adaptive_xstats_get_names(struct rte_eth_dev *dev,
+		struct rte_eth_xstat_name *names, unsigned int size);
+
+int
+bond_adaptive_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
+		unsigned int n);
+
+void
+bond_adaptive_xstats_reset(struct rte_eth_dev *dev);
+
+#endif /* RTE_ETH_BOND_ADAPTIVE_H_ */
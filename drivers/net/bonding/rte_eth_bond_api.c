@@ -981,6 +981,40 @@ rte_eth_bond_xmit_policy_get(uint16_t bonded_port_id)
 	return internals->balance_xmit_policy;
 }
 
+int
+rte_eth_bond_xmit_adaptive_set(uint16_t bonded_port_id, uint32_t period_ms)
+{
+	struct rte_eth_dev *bonded_eth_dev;
+	struct bond_dev_private *internals;
+
+	if (valid_bonded_port_id(bonded_port_id) != 0)
+		return -1;
+
+	bonded_eth_dev = &rte_eth_devices[bonded_port_id];
+	internals = bonded_eth_dev->data->dev_private;
+
+	/* The Tx queues state is set up when starting the device */
+	if (bonded_eth_dev->data->dev_started)
+		return -1;
+
+	internals->xmit_adaptive_period_ms = period_ms;
+
+	return 0;
+}
+
+int
+rte_eth_bond_xmit_adaptive_get(uint16_t bonded_port_id)
+{
+	struct bond_dev_private *internals;
+
+	if (valid_bonded_port_id(bonded_port_id) != 0)
+		return -1;
+
+	internals = rte_eth_devices[bonded_port_id].data->dev_private;
+
+	return internals->xmit_adaptive_period_ms;
+}
+
 int
 rte_eth_bond_link_monitoring_set(uint16_t bonded_port_id, uint32_t internal_ms)
 {
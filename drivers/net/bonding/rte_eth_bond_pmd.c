@@ -18,6 +18,7 @@
 #include <rte_bus_vdev.h>
 #include <rte_alarm.h>
 #include <rte_cycles.h>
+#include <rte_reciprocal.h>
 #include <rte_string_fns.h>
 
 #include "rte_eth_bond.h"
@@ -672,12 +673,36 @@ ipv6_hash(struct rte_ipv6_hdr *ipv6_hdr)
 			(word_src_addr[3] ^ word_dst_addr[3]);
 }
 
+/*
+ * Reduce the hashes of a burst to slave indexes. The modulo is computed with
+ * a reciprocal multiply rather than a division per packet, in a separate
+ * loop which the compiler can vectorize.
+ */
+static inline void
+hash_to_slaves(const uint32_t *hashes, uint16_t nb_pkts,
+		uint16_t slave_count, uint16_t *slaves)
+{
+	struct rte_reciprocal r;
+	uint16_t i;
+
+	if (rte_is_power_of_2(slave_count)) {
+		for (i = 0; i < nb_pkts; i++)
+			slaves[i] = hashes[i] & (slave_count - 1);
+		return;
+	}
+
+	r = rte_reciprocal_value(slave_count);
+	for (i = 0; i < nb_pkts; i++)
+		slaves[i] = hashes[i] -
+			rte_reciprocal_divide(hashes[i], r) * slave_count;
+}
 
 void
 burst_xmit_l2_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
 		uint16_t slave_count, uint16_t *slaves)
 {
 	struct rte_ether_hdr *eth_hdr;
+	uint32_t hashes[nb_pkts];
 	uint32_t hash;
 	int i;
 
@@ -686,8 +711,10 @@ burst_xmit_l2_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
 
 		hash = ether_hash(eth_hdr);
 
-		slaves[i] = (hash ^= hash >> 8) % slave_count;
+		hashes[i] = hash ^ (hash >> 8);
 	}
+
+	hash_to_slaves(hashes, nb_pkts, slave_count, slaves);
 }
 
 void
@@ -698,6 +725,7 @@ burst_xmit_l23_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
 	struct rte_ether_hdr *eth_hdr;
 	uint16_t proto;
 	size_t vlan_offset;
+	uint32_t hashes[nb_pkts];
 	uint32_t hash, l3hash;
 
 	for (i = 0; i < nb_pkts; i++) {
@@ -724,8 +752,10 @@ burst_xmit_l23_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
 		hash ^= hash >> 16;
 		hash ^= hash >> 8;
 
-		slaves[i] = hash % slave_count;
+		hashes[i] = hash;
 	}
+
+	hash_to_slaves(hashes, nb_pkts, slave_count, slaves);
 }
 
 void
@@ -739,6 +769,7 @@ burst_xmit_l34_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
 
 	struct rte_udp_hdr *udp_hdr;
 	struct rte_tcp_hdr *tcp_hdr;
+	uint32_t hashes[nb_pkts];
 	uint32_t hash, l3hash, l4hash;
 
 	for (i = 0; i < nb_pkts; i++) {
@@ -798,8 +829,10 @@ burst_xmit_l34_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
 		hash ^= hash >> 16;
 		hash ^= hash >> 8;
 
-		slaves[i] = hash % slave_count;
+		hashes[i] = hash;
 	}
+
+	hash_to_slaves(hashes, nb_pkts, slave_count, slaves);
 }
 
 struct bwg_slave {
@@ -1120,19 +1153,71 @@ bond_ethdev_tx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_tx_total;
 }
 
+/* Index of the packets held while their bucket moves to another slave */
+#define ADAPTIVE_HELD_IDX UINT16_MAX
+
+/*
+ * Map packets to slaves through the adaptive buckets, the packets of a
+ * bucket being moved may be held.
+ */
+static inline void
+burst_xmit_adaptive(struct bond_dev_private *internals,
+		struct bond_tx_queue *bd_tx_q, struct rte_mbuf **bufs,
+		uint16_t nb_bufs, uint16_t *slave_port_ids, uint16_t slave_count,
+		uint16_t *bufs_slave_port_idxs, uint64_t now)
+{
+	struct bond_tx_adaptive *ad = bd_tx_q->adaptive;
+	uint16_t buckets[nb_bufs];
+	int held_bucket;
+	uint16_t i, b;
+
+	internals->burst_xmit_hash(bufs, nb_bufs, BOND_ADAPTIVE_BUCKETS,
+			buckets);
+
+	for (i = 0; i < slave_count; i++)
+		ad->slave_idx[slave_port_ids[i]] = i;
+
+	held_bucket = -1;
+	if (ad->move_bucket >= 0) {
+		bond_adaptive_move_update(ad, slave_port_ids, slave_count,
+				bd_tx_q->queue_id, bd_tx_q->nb_tx_desc, now);
+		if (ad->move_bucket >= 0 && ad->move_hold)
+			held_bucket = ad->move_bucket;
+	}
+
+	for (i = 0; i < nb_bufs; i++) {
+		b = buckets[i];
+		ad->bucket_pkts[b]++;
+		ad->bucket_last[b] = now;
+		if (unlikely(b == held_bucket))
+			bufs_slave_port_idxs[i] = ADAPTIVE_HELD_IDX;
+		else
+			bufs_slave_port_idxs[i] = bond_adaptive_slave_idx(ad,
+					b, slave_port_ids, slave_count);
+	}
+}
+
 static inline uint16_t
 tx_burst_balance(void *queue, struct rte_mbuf **bufs, uint16_t nb_bufs,
 		 uint16_t *slave_port_ids, uint16_t slave_count)
 {
 	struct bond_tx_queue *bd_tx_q = (struct bond_tx_queue *)queue;
 	struct bond_dev_private *internals = bd_tx_q->dev_private;
+	struct bond_tx_adaptive *ad = bd_tx_q->adaptive;
 
-	/* Array to sort mbufs for transmission on each slave into */
-	struct rte_mbuf *slave_bufs[RTE_MAX_ETHPORTS][nb_bufs];
+	/* Mbufs sorted into a contiguous burst for each slave */
+	struct rte_mbuf *slave_bufs[nb_bufs];
 	/* Number of mbufs for transmission on each slave */
-	uint16_t slave_nb_bufs[RTE_MAX_ETHPORTS] = { 0 };
+	uint16_t slave_nb_bufs[RTE_MAX_ETHPORTS];
+	/* Offset of the burst of each slave in slave_bufs */
+	uint16_t slave_offset[RTE_MAX_ETHPORTS];
+	uint16_t offset;
 	/* Mapping array generated by hash function to map mbufs to slaves */
 	uint16_t bufs_slave_port_idxs[nb_bufs];
+	/* Mbufs held by the adaptive transmit policy */
+	struct rte_mbuf *held_bufs[nb_bufs];
+	uint16_t nb_held = 0;
+	uint64_t now = 0;
 
 	uint16_t slave_tx_count;
 	uint16_t total_tx_count = 0, total_tx_fail_count = 0;
@@ -1143,38 +1228,91 @@ tx_burst_balance(void *queue, struct rte_mbuf **bufs, uint16_t nb_bufs,
 	 * Populate slaves mbuf with the packets which are to be sent on it
 	 * selecting output slave using hash based on xmit policy
 	 */
-	internals->burst_xmit_hash(bufs, nb_bufs, slave_count,
-			bufs_slave_port_idxs);
+	if (ad == NULL) {
+		internals->burst_xmit_hash(bufs, nb_bufs, slave_count,
+				bufs_slave_port_idxs);
+	} else {
+		now = rte_get_tsc_cycles();
+		burst_xmit_adaptive(internals, bd_tx_q, bufs, nb_bufs,
+				slave_port_ids, slave_count,
+				bufs_slave_port_idxs, now);
+	}
+
+	/*
+	 * Counting sort of the mbufs by slave, keeping their order: the bursts
+	 * of the slaves follow each other in slave_bufs.
+	 */
+	memset(slave_nb_bufs, 0, sizeof(slave_nb_bufs[0]) * slave_count);
+	for (i = 0; i < nb_bufs; i++) {
+		uint16_t slave_idx = bufs_slave_port_idxs[i];
+
+		if (unlikely(slave_idx == ADAPTIVE_HELD_IDX)) {
+			held_bufs[nb_held++] = bufs[i];
+			continue;
+		}
+		slave_nb_bufs[slave_idx]++;
+	}
+
+	offset = 0;
+	for (i = 0; i < slave_count; i++) {
+		slave_offset[i] = offset;
+		offset += slave_nb_bufs[i];
+	}
 
 	for (i = 0; i < nb_bufs; i++) {
-		/* Populate slave mbuf arrays with mbufs for that slave. */
 		uint16_t slave_idx = bufs_slave_port_idxs[i];
 
-		slave_bufs[slave_idx][slave_nb_bufs[slave_idx]++] = bufs[i];
+		if (unlikely(slave_idx == ADAPTIVE_HELD_IDX))
+			continue;
+		slave_bufs[slave_offset[slave_idx]++] = bufs[i];
 	}
 
 	/* Send packet burst on each slave device */
+	offset = 0;
 	for (i = 0; i < slave_count; i++) {
+		struct rte_mbuf **burst = &slave_bufs[offset];
+
 		if (slave_nb_bufs[i] == 0)
 			continue;
+		offset += slave_nb_bufs[i];
 
 		slave_tx_count = rte_eth_tx_burst(slave_port_ids[i],
-				bd_tx_q->queue_id, slave_bufs[i],
-				slave_nb_bufs[i]);
+				bd_tx_q->queue_id, burst, slave_nb_bufs[i]);
 
 		total_tx_count += slave_tx_count;
 
+		if (ad != NULL) {
+			ad->slave_pkts[slave_port_ids[i]] += slave_tx_count;
+			ad->slave_fails[slave_port_ids[i]] +=
+					slave_nb_bufs[i] - slave_tx_count;
+		}
+
 		/* If tx burst fails move packets to end of bufs */
 		if (unlikely(slave_tx_count < slave_nb_bufs[i])) {
 			int slave_tx_fail_count = slave_nb_bufs[i] -
 					slave_tx_count;
 			total_tx_fail_count += slave_tx_fail_count;
 			memcpy(&bufs[nb_bufs - total_tx_fail_count],
-			       &slave_bufs[i][slave_tx_count],
+			       &burst[slave_tx_count],
 			       slave_tx_fail_count * sizeof(bufs[0]));
 		}
 	}
 
+	if (ad == NULL)
+		return total_tx_count;
+
+	/* Held packets are returned as not sent */
+	if (unlikely(nb_held > 0)) {
+		total_tx_fail_count += nb_held;
+		memcpy(&bufs[nb_bufs - total_tx_fail_count], held_bufs,
+		       nb_held * sizeof(bufs[0]));
+		ad->held_pkts += nb_held;
+	}
+
+	if (unlikely(now >= ad->next_rebalance))
+		bond_adaptive_rebalance(ad, slave_port_ids, slave_count,
+				bd_tx_q->queue_id, bd_tx_q->nb_tx_desc, now);
+
 	return total_tx_count;
 }
 
@@ -1940,6 +2078,45 @@ bond_ethdev_primary_set(struct bond_dev_private *internals,
 static int
 bond_ethdev_promiscuous_enable(struct rte_eth_dev *eth_dev);
 
+/* Allocate or free the adaptive transmit state of the Tx queues. */
+static int
+bond_ethdev_adaptive_setup(struct rte_eth_dev *eth_dev)
+{
+	struct bond_dev_private *internals = eth_dev->data->dev_private;
+	struct bond_tx_queue *bd_tx_q;
+	int enabled;
+	uint16_t i;
+
+	enabled = internals->xmit_adaptive_period_ms != 0 &&
+		(internals->mode == BONDING_MODE_BALANCE ||
+		 internals->mode == BONDING_MODE_8023AD);
+
+	for (i = 0; i < eth_dev->data->nb_tx_queues; i++) {
+		bd_tx_q = eth_dev->data->tx_queues[i];
+		if (bd_tx_q == NULL)
+			continue;
+		if (!enabled) {
+			rte_free(bd_tx_q->adaptive);
+			bd_tx_q->adaptive = NULL;
+			continue;
+		}
+		if (bd_tx_q->adaptive == NULL) {
+			bd_tx_q->adaptive = rte_zmalloc_socket(NULL,
+					sizeof(struct bond_tx_adaptive), 0,
+					eth_dev->data->numa_node);
+			if (bd_tx_q->adaptive == NULL) {
+				RTE_BOND_LOG(ERR,
+					"Failed to allocate adaptive transmit state");
+				return -ENOMEM;
+			}
+		}
+		bond_adaptive_reset(bd_tx_q->adaptive,
+				internals->xmit_adaptive_period_ms);
+	}
+
+	return 0;
+}
+
 static int
 bond_ethdev_start(struct rte_eth_dev *eth_dev)
 {
@@ -2030,6 +2207,9 @@ bond_ethdev_start(struct rte_eth_dev *eth_dev)
 			internals->mode == BONDING_MODE_ALB)
 		bond_tlb_enable(internals);
 
+	if (bond_ethdev_adaptive_setup(eth_dev) != 0)
+		goto out_err;
+
 	return 0;
 
 out_err:
@@ -2037,6 +2217,16 @@ out_err:
 	return -1;
 }
 
+static void
+bond_ethdev_tx_queue_free(struct bond_tx_queue *bd_tx_q)
+{
+	if (bd_tx_q == NULL)
+		return;
+
+	rte_free(bd_tx_q->adaptive);
+	rte_free(bd_tx_q);
+}
+
 static void
 bond_ethdev_free_queues(struct rte_eth_dev *dev)
 {
@@ -2052,7 +2242,7 @@ bond_ethdev_free_queues(struct rte_eth_dev *dev)
 
 	if (dev->data->tx_queues != NULL) {
 		for (i = 0; i < dev->data->nb_tx_queues; i++) {
-			rte_free(dev->data->tx_queues[i]);
+			bond_ethdev_tx_queue_free(dev->data->tx_queues[i]);
 			dev->data->tx_queues[i] = NULL;
 		}
 		dev->data->nb_tx_queues = 0;
@@ -2341,12 +2531,7 @@ bond_ethdev_rx_queue_release(struct rte_eth_dev *dev, uint16_t queue_id)
 static void
 bond_ethdev_tx_queue_release(struct rte_eth_dev *dev, uint16_t queue_id)
 {
-	void *queue = dev->data->tx_queues[queue_id];
-
-	if (queue == NULL)
-		return;
-
-	rte_free(queue);
+	bond_ethdev_tx_queue_free(dev->data->tx_queues[queue_id]);
 }
 
 static void
@@ -2576,6 +2761,28 @@ bond_ethdev_stats_reset(struct rte_eth_dev *dev)
 	return err;
 }
 
+static int
+bond_ethdev_xstats_get_names(struct rte_eth_dev *dev,
+		struct rte_eth_xstat_name *xstats_names, unsigned int size)
+{
+	return bond_adaptive_xstats_get_names(dev, xstats_names, size);
+}
+
+static int
+bond_ethdev_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
+		unsigned int n)
+{
+	return bond_adaptive_xstats_get(dev, xstats, n);
+}
+
+static int
+bond_ethdev_xstats_reset(struct rte_eth_dev *dev)
+{
+	bond_adaptive_xstats_reset(dev);
+
+	return bond_ethdev_stats_reset(dev);
+}
+
 static int
 bond_ethdev_promiscuous_enable(struct rte_eth_dev *eth_dev)
 {
@@ -3270,6 +3477,9 @@ const struct eth_dev_ops default_dev_ops = {
 	.link_update          = bond_ethdev_link_update,
 	.stats_get            = bond_ethdev_stats_get,
 	.stats_reset          = bond_ethdev_stats_reset,
+	.xstats_get           = bond_ethdev_xstats_get,
+	.xstats_get_names     = bond_ethdev_xstats_get_names,
+	.xstats_reset         = bond_ethdev_xstats_reset,
 	.promiscuous_enable   = bond_ethdev_promiscuous_enable,
 	.promiscuous_disable  = bond_ethdev_promiscuous_disable,
 	.allmulticast_enable  = bond_ethdev_allmulticast_enable,
@@ -3331,6 +3541,7 @@ bond_alloc(struct rte_vdev_device *dev, uint8_t mode)
 	internals->current_primary_port = RTE_MAX_ETHPORTS + 1;
 	internals->balance_xmit_policy = BALANCE_XMIT_POLICY_LAYER2;
 	internals->burst_xmit_hash = burst_xmit_l2_hash;
+	internals->xmit_adaptive_period_ms = 0;
 	internals->user_defined_mac = 0;
 
 	internals->link_status_polling_enabled = 0;
@@ -3678,6 +3889,33 @@ bond_ethdev_configure(struct rte_eth_dev *dev)
 		return -1;
 	}
 
+	/* Parse/set adaptive transmit rebalancing period */
+	arg_count = rte_kvargs_count(kvlist, PMD_BOND_XMIT_ADAPTIVE_KVARG);
+	if (arg_count == 1) {
+		uint32_t period_ms;
+
+		if (rte_kvargs_process(kvlist, PMD_BOND_XMIT_ADAPTIVE_KVARG,
+				       &bond_ethdev_parse_time_ms_kvarg,
+				       &period_ms) < 0) {
+			RTE_BOND_LOG(INFO,
+				     "Invalid adaptive transmit period specified for bonded device %s",
+				     name);
+			return -1;
+		}
+
+		if (rte_eth_bond_xmit_adaptive_set(port_id, period_ms) != 0) {
+			RTE_BOND_LOG(ERR,
+				     "Failed to set adaptive transmit on bonded device %s",
+				     name);
+			return -1;
+		}
+	} else if (arg_count > 1) {
+		RTE_BOND_LOG(ERR,
+			     "Adaptive transmit can be specified only once for bonded device %s",
+			     name);
+		return -1;
+	}
+
 	if (rte_kvargs_count(kvlist, PMD_BOND_AGG_MODE_KVARG) == 1) {
 		if (rte_kvargs_process(kvlist,
 				       PMD_BOND_AGG_MODE_KVARG,
@@ -3862,6 +4100,7 @@ RTE_PMD_REGISTER_PARAM_STRING(net_bonding,
 	"primary=<ifc> "
 	"mode=[0-6] "
 	"xmit_policy=[l2 | l23 | l34] "
+	"xmit_adaptive=<int> "
 	"agg_mode=[count | stable | bandwidth] "
 	"socket_id=<int> "
 	"mac=<mac addr> "
@@ -15,6 +15,8 @@
 #include <rte_bus_vdev.h>
 #include <rte_kvargs.h>
 #include <rte_vhost.h>
+#include <rte_vhost_async.h>
+#include <rte_dmadev.h>
 #include <rte_spinlock.h>
 
 #include "rte_eth_vhost.h"
@@ -34,7 +36,14 @@ enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
 #define ETH_VHOST_VIRTIO_NET_F_HOST_TSO "tso"
 #define ETH_VHOST_LINEAR_BUF  "linear-buffer"
 #define ETH_VHOST_EXT_BUF  "ext-buffer"
+#define ETH_VHOST_DMAS		"dmas"
+#define ETH_VHOST_DMA_RING_SIZE	"dma-ring-size"
+#define ETH_VHOST_VECTORIZED	"vectorized"
 #define VHOST_MAX_PKT_BURST 32
+#define VHOST_DMA_RING_SIZE 4096
+#define VHOST_DMA_RING_SIZE_MIN VHOST_MAX_PKT_BURST
+#define VHOST_DMA_RING_SIZE_MAX 32768
+#define INVALID_DMA_ID -1
 
 static const char *valid_arguments[] = {
 	ETH_VHOST_IFACE_ARG,
@@ -45,6 +54,9 @@ static const char *valid_arguments[] = {
 	ETH_VHOST_VIRTIO_NET_F_HOST_TSO,
 	ETH_VHOST_LINEAR_BUF,
 	ETH_VHOST_EXT_BUF,
+	ETH_VHOST_DMAS,
+	ETH_VHOST_DMA_RING_SIZE,
+	ETH_VHOST_VECTORIZED,
 	NULL
 };
 
@@ -78,6 +90,8 @@ enum vhost_xstats_pkts {
 	VHOST_ERRORS_FRAGMENTED,
 	VHOST_ERRORS_JABBER,
 	VHOST_UNKNOWN_PROTOCOL,
+	VHOST_ASYNC_INFLIGHT,
+	VHOST_DMA_ERRORS,
 	VHOST_XSTATS_MAX,
 };
 
@@ -99,6 +113,12 @@ struct vhost_queue {
 	struct vhost_stats stats;
 	int intr_enable;
 	rte_spinlock_t intr_lock;
+	/* DMA device doing the copies on its vChannel 0, if async */
+	int16_t dma_id;
+	uint32_t async_inflight;
+	uint64_t dma_errors_base;
+	/* async TX queue of the same id, completed on RX bursts too */
+	struct vhost_queue *async_txq;
 };
 
 struct pmd_internal {
@@ -110,6 +130,8 @@ struct pmd_internal {
 	int vid;
 	rte_atomic32_t started;
 	uint8_t vlan_strip;
+	/* DMA device per vring, INVALID_DMA_ID for the sync data path */
+	int16_t dma_id[RTE_MAX_QUEUES_PER_PORT * VIRTIO_QNUM];
 };
 
 struct internal_list {
@@ -140,6 +162,10 @@ struct rte_vhost_vring_state {
 
 static struct rte_vhost_vring_state *vring_states[RTE_MAX_ETHPORTS];
 
+/* Ports using each DMA device configured by this driver */
+static uint16_t dma_refcnt[RTE_DMADEV_DEFAULT_MAX];
+static bool dma_owned[RTE_DMADEV_DEFAULT_MAX];
+
 #define VHOST_XSTATS_NAME_SIZE 64
 
 struct vhost_xstats_name_off {
@@ -185,6 +211,10 @@ static const struct vhost_xstats_name_off vhost_rxport_stat_strings[] = {
 	 offsetof(struct vhost_queue, stats.xstats[VHOST_ERRORS_JABBER])},
 	{"unknown_protos_packets",
 	 offsetof(struct vhost_queue, stats.xstats[VHOST_UNKNOWN_PROTOCOL])},
+	{"async_inflight_packets",
+	 offsetof(struct vhost_queue, stats.xstats[VHOST_ASYNC_INFLIGHT])},
+	{"dma_errors",
+	 offsetof(struct vhost_queue, stats.xstats[VHOST_DMA_ERRORS])},
 };
 
 /* [tx]_ is prepended to the name string here */
@@ -219,6 +249,10 @@ static const struct vhost_xstats_name_off vhost_txport_stat_strings[] = {
 	 offsetof(struct vhost_queue, stats.xstats[VHOST_1523_TO_MAX_PKT])},
 	{"errors_with_bad_CRC",
 	 offsetof(struct vhost_queue, stats.xstats[VHOST_ERRORS_PKT])},
+	{"async_inflight_packets",
+	 offsetof(struct vhost_queue, stats.xstats[VHOST_ASYNC_INFLIGHT])},
+	{"dma_errors",
+	 offsetof(struct vhost_queue, stats.xstats[VHOST_DMA_ERRORS])},
 };
 
 #define VHOST_NB_XSTATS_RXPORT (sizeof(vhost_rxport_stat_strings) / \
@@ -227,6 +261,46 @@ static const struct vhost_xstats_name_off vhost_txport_stat_strings[] = {
 #define VHOST_NB_XSTATS_TXPORT (sizeof(vhost_txport_stat_strings) / \
 				sizeof(vhost_txport_stat_strings[0]))
 
+static uint64_t
+vhost_dma_errors(int16_t dma_id)
+{
+	struct rte_dma_stats stats;
+
+	if (rte_dma_stats_get(dma_id, 0, &stats) != 0)
+		return 0;
+
+	return stats.errors;
+}
+
+/*
+ * Refresh the async counters of the queues. The DMA errors are those of
+ * the vChannel, counted on the first queue using it only.
+ */
+static void
+vhost_async_xstats_update(void **queues, uint16_t nb_queues)
+{
+	struct vhost_queue *vq, *prev;
+	unsigned int i, j;
+
+	for (i = 0; i < nb_queues; i++) {
+		vq = queues[i];
+		if (!vq || vq->dma_id == INVALID_DMA_ID)
+			continue;
+		vq->stats.xstats[VHOST_ASYNC_INFLIGHT] =
+			__atomic_load_n(&vq->async_inflight, __ATOMIC_RELAXED);
+
+		for (j = 0; j < i; j++) {
+			prev = queues[j];
+			if (prev && prev->dma_id == vq->dma_id)
+				break;
+		}
+		if (j < i)
+			continue;
+		vq->stats.xstats[VHOST_DMA_ERRORS] =
+			vhost_dma_errors(vq->dma_id) - vq->dma_errors_base;
+	}
+}
+
 static int
 vhost_dev_xstats_reset(struct rte_eth_dev *dev)
 {
@@ -238,12 +312,16 @@ vhost_dev_xstats_reset(struct rte_eth_dev *dev)
 		if (!vq)
 			continue;
 		memset(&vq->stats, 0, sizeof(vq->stats));
+		if (vq->dma_id != INVALID_DMA_ID)
+			vq->dma_errors_base = vhost_dma_errors(vq->dma_id);
 	}
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
 		vq = dev->data->tx_queues[i];
 		if (!vq)
 			continue;
 		memset(&vq->stats, 0, sizeof(vq->stats));
+		if (vq->dma_id != INVALID_DMA_ID)
+			vq->dma_errors_base = vhost_dma_errors(vq->dma_id);
 	}
 
 	return 0;
@@ -288,6 +366,9 @@ vhost_dev_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
 	if (n < nxstats)
 		return nxstats;
 
+	vhost_async_xstats_update(dev->data->rx_queues, dev->data->nb_rx_queues);
+	vhost_async_xstats_update(dev->data->tx_queues, dev->data->nb_tx_queues);
+
 	for (t = 0; t < VHOST_NB_XSTATS_RXPORT; t++) {
 		xstats[count].value = 0;
 		for (i = 0; i < dev->data->nb_rx_queues; i++) {
@@ -361,12 +442,41 @@ vhost_update_single_packet_xstats(struct vhost_queue *vq, struct rte_mbuf *buf)
 	vhost_count_xcast_packets(vq, buf);
 }
 
+/*
+ * Free up to max packets whose copies to the guest are completed.
+ * Returns the number of packets freed.
+ */
+static uint32_t
+eth_vhost_async_tx_complete(struct vhost_queue *r, uint32_t max)
+{
+	struct rte_mbuf *pkts[VHOST_MAX_PKT_BURST];
+	uint32_t nb_free = 0;
+	uint16_t nb_pkts, num;
+
+	while (nb_free < max &&
+	       __atomic_load_n(&r->async_inflight, __ATOMIC_RELAXED) > 0) {
+		num = (uint16_t)RTE_MIN(max - nb_free,
+					(uint32_t)VHOST_MAX_PKT_BURST);
+		nb_pkts = rte_vhost_poll_enqueue_completed(r->vid,
+				r->virtqueue_id, pkts, num, r->dma_id, 0);
+		rte_pktmbuf_free_bulk(pkts, nb_pkts);
+		__atomic_sub_fetch(&r->async_inflight, nb_pkts,
+				__ATOMIC_RELAXED);
+		nb_free += nb_pkts;
+		if (nb_pkts < num)
+			break;
+	}
+
+	return nb_free;
+}
+
 static uint16_t
 eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	struct vhost_queue *r = q;
 	uint16_t i, nb_rx = 0;
 	uint16_t nb_receive = nb_bufs;
+	int nr_inflight;
 
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		return 0;
@@ -376,15 +486,29 @@ eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		goto out;
 
+	/* The TX queue may be idle, with packets waiting to be released */
+	if (r->async_txq != NULL)
+		eth_vhost_async_tx_complete(r->async_txq, UINT32_MAX);
+
 	/* Dequeue packets from guest TX queue */
 	while (nb_receive) {
 		uint16_t nb_pkts;
 		uint16_t num = (uint16_t)RTE_MIN(nb_receive,
 						 VHOST_MAX_PKT_BURST);
 
-		nb_pkts = rte_vhost_dequeue_burst(r->vid, r->virtqueue_id,
-						  r->mb_pool, &bufs[nb_rx],
-						  num);
+		if (r->dma_id == INVALID_DMA_ID) {
+			nb_pkts = rte_vhost_dequeue_burst(r->vid,
+					r->virtqueue_id, r->mb_pool,
+					&bufs[nb_rx], num);
+		} else {
+			nb_pkts = rte_vhost_async_try_dequeue_burst(r->vid,
+					r->virtqueue_id, r->mb_pool,
+					&bufs[nb_rx], num, &nr_inflight,
+					r->dma_id, 0);
+			if (nr_inflight >= 0)
+				__atomic_store_n(&r->async_inflight,
+						nr_inflight, __ATOMIC_RELAXED);
+		}
 
 		nb_rx += nb_pkts;
 		nb_receive -= nb_pkts;
@@ -430,6 +554,10 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		goto out;
 
+	/* Release the packets copied since the previous burst */
+	if (r->dma_id != INVALID_DMA_ID)
+		eth_vhost_async_tx_complete(r, UINT32_MAX);
+
 	for (i = 0; i < nb_bufs; i++) {
 		struct rte_mbuf *m = bufs[i];
 
@@ -452,8 +580,22 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 		uint16_t num = (uint16_t)RTE_MIN(nb_send,
 						 VHOST_MAX_PKT_BURST);
 
-		nb_pkts = rte_vhost_enqueue_burst(r->vid, r->virtqueue_id,
-						  &bufs[nb_tx], num);
+		if (r->dma_id == INVALID_DMA_ID) {
+			nb_pkts = rte_vhost_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
+		} else {
+			/*
+			 * Counted before being submitted, so that a vring
+			 * drain never frees more packets than counted.
+			 */
+			__atomic_add_fetch(&r->async_inflight, num,
+					__ATOMIC_RELAXED);
+			nb_pkts = rte_vhost_submit_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num,
+					r->dma_id, 0);
+			__atomic_sub_fetch(&r->async_inflight, num - nb_pkts,
+					__ATOMIC_RELAXED);
+		}
 
 		nb_tx += nb_pkts;
 		nb_send -= nb_pkts;
@@ -483,8 +625,11 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	for (i = nb_tx; i < nb_bufs; i++)
 		vhost_count_xcast_packets(r, bufs[i]);
 
-	for (i = 0; likely(i < nb_tx); i++)
-		rte_pktmbuf_free(bufs[i]);
+	/* Packets in flight are freed once copied, on a later burst */
+	if (r->dma_id == INVALID_DMA_ID) {
+		for (i = 0; likely(i < nb_tx); i++)
+			rte_pktmbuf_free(bufs[i]);
+	}
 out:
 	rte_atomic32_set(&r->while_queuing, 0);
 
@@ -763,6 +908,12 @@ queue_setup(struct rte_eth_dev *eth_dev, struct pmd_internal *internal)
 		vq->vid = internal->vid;
 		vq->internal = internal;
 		vq->port = eth_dev->data->port_id;
+		vq->async_txq = NULL;
+		if (i < eth_dev->data->nb_tx_queues &&
+		    eth_dev->data->tx_queues[i] != NULL &&
+		    internal->dma_id[i * VIRTIO_QNUM + VIRTIO_RXQ] !=
+		    INVALID_DMA_ID)
+			vq->async_txq = eth_dev->data->tx_queues[i];
 	}
 	for (i = 0; i < eth_dev->data->nb_tx_queues; i++) {
 		vq = eth_dev->data->tx_queues[i];
@@ -774,6 +925,99 @@ queue_setup(struct rte_eth_dev *eth_dev, struct pmd_internal *internal)
 	}
 }
 
+static struct vhost_queue *
+vring_to_queue(struct rte_eth_dev *eth_dev, uint16_t vring)
+{
+	struct rte_eth_dev_data *data = eth_dev->data;
+	uint16_t qid = vring / VIRTIO_QNUM;
+
+	if (vring % VIRTIO_QNUM == VIRTIO_RXQ) {
+		if (data->tx_queues == NULL || qid >= data->nb_tx_queues)
+			return NULL;
+		return data->tx_queues[qid];
+	}
+	if (data->rx_queues == NULL || qid >= data->nb_rx_queues)
+		return NULL;
+	return data->rx_queues[qid];
+}
+
+/*
+ * Wait for the DMA copies in flight on a vring and free their packets.
+ * Only called when the vhost library holds the vring lock, or with the
+ * data path stopped. The lock already excludes the data path: a burst
+ * may be waiting for it, so do not wait for the burst here.
+ */
+static void
+async_clear_vring(struct rte_eth_dev *eth_dev, int vid, uint16_t vring)
+{
+	struct rte_mbuf *pkts[VHOST_MAX_PKT_BURST];
+	struct vhost_queue *vq;
+	uint16_t nb_pkts, num;
+	int inflight;
+
+	vq = vring_to_queue(eth_dev, vring);
+	if (vq == NULL || vq->dma_id == INVALID_DMA_ID)
+		return;
+
+	while ((inflight = rte_vhost_async_get_inflight_thread_unsafe(vid,
+			vring)) > 0) {
+		num = (uint16_t)RTE_MIN(inflight, VHOST_MAX_PKT_BURST);
+		nb_pkts = rte_vhost_clear_queue_thread_unsafe(vid, vring,
+				pkts, num, vq->dma_id, 0);
+		rte_pktmbuf_free_bulk(pkts, nb_pkts);
+		/* TX queues count their packets before submitting them */
+		if (vring % VIRTIO_QNUM == VIRTIO_RXQ)
+			__atomic_sub_fetch(&vq->async_inflight, nb_pkts,
+					__ATOMIC_RELAXED);
+	}
+
+	/* RX queues report the count of the library */
+	if (vring % VIRTIO_QNUM == VIRTIO_TXQ)
+		__atomic_store_n(&vq->async_inflight, 0, __ATOMIC_RELAXED);
+}
+
+static void
+async_channel_unregister(struct rte_eth_dev *eth_dev, int vid)
+{
+	struct pmd_internal *internal = eth_dev->data->dev_private;
+	uint16_t i, nr_vring;
+
+	nr_vring = RTE_MIN(rte_vhost_get_vring_num(vid),
+			   RTE_DIM(internal->dma_id));
+	for (i = 0; i < nr_vring; i++) {
+		if (internal->dma_id[i] == INVALID_DMA_ID)
+			continue;
+		async_clear_vring(eth_dev, vid, i);
+		rte_vhost_async_channel_unregister(vid, i);
+	}
+}
+
+static int
+async_channel_register(struct rte_eth_dev *eth_dev, int vid)
+{
+	struct pmd_internal *internal = eth_dev->data->dev_private;
+	uint16_t i, nr_vring;
+
+	nr_vring = RTE_MIN(rte_vhost_get_vring_num(vid),
+			   RTE_DIM(internal->dma_id));
+	for (i = 0; i < nr_vring; i++) {
+		if (internal->dma_id[i] == INVALID_DMA_ID)
+			continue;
+		if (rte_vhost_async_channel_register(vid, i) < 0) {
+			VHOST_LOG(ERR,
+				"Failed to register async channel for vring%u\n",
+				i);
+			while (i-- > 0)
+				if (internal->dma_id[i] != INVALID_DMA_ID)
+					rte_vhost_async_channel_unregister(vid,
+									   i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 static int
 new_device(int vid)
 {
@@ -804,6 +1048,9 @@ new_device(int vid)
 		eth_dev->data->numa_node = newnode;
 #endif
 
+	if (async_channel_register(eth_dev, vid) < 0)
+		return -1;
+
 	internal->vid = vid;
 	if (rte_atomic32_read(&internal->started) == 1) {
 		queue_setup(eth_dev, internal);
@@ -861,6 +1108,8 @@ destroy_device(int vid)
 
 	eth_dev->data->dev_link.link_status = RTE_ETH_LINK_DOWN;
 
+	async_channel_unregister(eth_dev, vid);
+
 	if (eth_dev->data->rx_queues && eth_dev->data->tx_queues) {
 		for (i = 0; i < eth_dev->data->nb_rx_queues; i++) {
 			vq = eth_dev->data->rx_queues[i];
@@ -954,6 +1203,10 @@ vring_state_changed(int vid, uint16_t vring, int enable)
 	/* won't be NULL */
 	state = vring_states[eth_dev->data->port_id];
 
+	/* The vring is not to be accessed anymore, including by the DMA */
+	if (!enable)
+		async_clear_vring(eth_dev, vid, vring);
+
 	if (enable && vring_conf_update(vid, eth_dev, vring))
 		VHOST_LOG(INFO, "Failed to update vring-%d configuration.\n",
 			  (int)vring);
@@ -1115,6 +1368,92 @@ rte_eth_vhost_get_vid_from_port_id(uint16_t port_id)
 	return vid;
 }
 
+/*
+ * Set up vChannel 0 of a DMA device for vhost. A device already configured
+ * by the application is used as is, one configured here is started as long
+ * as a port uses it.
+ */
+static int
+vhost_dma_get(int16_t dma_id, uint16_t ring_size)
+{
+	struct rte_dma_conf dev_conf = { .nb_vchans = 1 };
+	struct rte_dma_vchan_conf qconf = {
+		.direction = RTE_DMA_DIR_MEM_TO_MEM,
+	};
+	struct rte_dma_info info;
+
+	if (rte_dma_info_get(dma_id, &info) != 0)
+		return -1;
+
+	if (info.nb_vchans == 0) {
+		qconf.nb_desc = RTE_MIN(RTE_MAX(ring_size, info.min_desc),
+					info.max_desc);
+		if (rte_dma_configure(dma_id, &dev_conf) != 0 ||
+		    rte_dma_vchan_setup(dma_id, 0, &qconf) != 0) {
+			VHOST_LOG(ERR, "Failed to set up DMA device %d\n",
+				  dma_id);
+			return -1;
+		}
+		dma_owned[dma_id] = true;
+	}
+
+	if (dma_owned[dma_id] && dma_refcnt[dma_id]++ == 0 &&
+	    rte_dma_start(dma_id) != 0) {
+		VHOST_LOG(ERR, "Failed to start DMA device %d\n", dma_id);
+		dma_refcnt[dma_id]--;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+vhost_dma_put(int16_t dma_id)
+{
+	if (dma_owned[dma_id] && --dma_refcnt[dma_id] == 0)
+		rte_dma_stop(dma_id);
+}
+
+/* Releases the DMA devices bound to the first n vrings of a port */
+static void
+vhost_dma_release(const int16_t *dma_ids, unsigned int n)
+{
+	bool seen[RTE_DMADEV_DEFAULT_MAX] = { false };
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (dma_ids[i] == INVALID_DMA_ID || seen[dma_ids[i]])
+			continue;
+		seen[dma_ids[i]] = true;
+		vhost_dma_put(dma_ids[i]);
+	}
+}
+
+static int
+vhost_dma_setup(const int16_t *dma_ids, uint16_t ring_size)
+{
+	bool seen[RTE_DMADEV_DEFAULT_MAX] = { false };
+	unsigned int i;
+
+	for (i = 0; i < RTE_MAX_QUEUES_PER_PORT * VIRTIO_QNUM; i++) {
+		if (dma_ids[i] == INVALID_DMA_ID || seen[dma_ids[i]])
+			continue;
+		seen[dma_ids[i]] = true;
+		if (vhost_dma_get(dma_ids[i], ring_size) < 0)
+			goto release;
+		if (rte_vhost_async_dma_configure(dma_ids[i], 0) < 0) {
+			vhost_dma_put(dma_ids[i]);
+			goto release;
+		}
+	}
+
+	return 0;
+
+release:
+	vhost_dma_release(dma_ids, i);
+	return -1;
+}
+
 static int
 eth_dev_configure(struct rte_eth_dev *dev)
 {
@@ -1194,6 +1533,8 @@ eth_dev_close(struct rte_eth_dev *dev)
 		rte_free(list);
 	}
 
+	vhost_dma_release(internal->dma_id, RTE_DIM(internal->dma_id));
+
 	if (dev->data->rx_queues)
 		for (i = 0; i < dev->data->nb_rx_queues; i++)
 			rte_free(dev->data->rx_queues[i]);
@@ -1220,6 +1561,7 @@ eth_rx_queue_setup(struct rte_eth_dev *dev, uint16_t rx_queue_id,
 		   const struct rte_eth_rxconf *rx_conf __rte_unused,
 		   struct rte_mempool *mb_pool)
 {
+	struct pmd_internal *internal = dev->data->dev_private;
 	struct vhost_queue *vq;
 
 	vq = rte_zmalloc_socket(NULL, sizeof(struct vhost_queue),
@@ -1231,6 +1573,7 @@ eth_rx_queue_setup(struct rte_eth_dev *dev, uint16_t rx_queue_id,
 
 	vq->mb_pool = mb_pool;
 	vq->virtqueue_id = rx_queue_id * VIRTIO_QNUM + VIRTIO_TXQ;
+	vq->dma_id = internal->dma_id[vq->virtqueue_id];
 	rte_spinlock_init(&vq->intr_lock);
 	dev->data->rx_queues[rx_queue_id] = vq;
 
@@ -1243,6 +1586,7 @@ eth_tx_queue_setup(struct rte_eth_dev *dev, uint16_t tx_queue_id,
 		   unsigned int socket_id,
 		   const struct rte_eth_txconf *tx_conf __rte_unused)
 {
+	struct pmd_internal *internal = dev->data->dev_private;
 	struct vhost_queue *vq;
 
 	vq = rte_zmalloc_socket(NULL, sizeof(struct vhost_queue),
@@ -1253,6 +1597,7 @@ eth_tx_queue_setup(struct rte_eth_dev *dev, uint16_t tx_queue_id,
 	}
 
 	vq->virtqueue_id = tx_queue_id * VIRTIO_QNUM + VIRTIO_RXQ;
+	vq->dma_id = internal->dma_id[vq->virtqueue_id];
 	rte_spinlock_init(&vq->intr_lock);
 	dev->data->tx_queues[tx_queue_id] = vq;
 
@@ -1362,13 +1707,31 @@ eth_tx_queue_release(struct rte_eth_dev *dev, uint16_t qid)
 }
 
 static int
-eth_tx_done_cleanup(void *txq __rte_unused, uint32_t free_cnt __rte_unused)
+eth_tx_done_cleanup(void *txq, uint32_t free_cnt)
 {
+	struct vhost_queue *r = txq;
+	int nb_free = 0;
+
 	/*
 	 * vHost does not hang onto mbuf. eth_vhost_tx() copies packet data
-	 * and releases mbuf, so nothing to cleanup.
+	 * and releases mbuf, so nothing to cleanup, unless the copies are
+	 * done by a DMA device.
 	 */
-	return 0;
+	if (r->dma_id == INVALID_DMA_ID)
+		return 0;
+
+	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
+		return 0;
+
+	rte_atomic32_set(&r->while_queuing, 1);
+
+	if (likely(rte_atomic32_read(&r->allow_queuing) != 0))
+		nb_free = eth_vhost_async_tx_complete(r,
+				free_cnt == 0 ? UINT32_MAX : free_cnt);
+
+	rte_atomic32_set(&r->while_queuing, 0);
+
+	return nb_free;
 }
 
 static int
@@ -1454,7 +1817,7 @@ static const struct eth_dev_ops ops = {
 static int
 eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	int16_t queues, const unsigned int numa_node, uint64_t flags,
-	uint64_t disable_flags)
+	uint64_t disable_flags, const int16_t *dma_ids)
 {
 	const char *name = rte_vdev_device_name(dev);
 	struct rte_eth_dev_data *data;
@@ -1496,6 +1859,7 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	internal->vid = -1;
 	internal->flags = flags;
 	internal->disable_flags = disable_flags;
+	memcpy(internal->dma_id, dma_ids, sizeof(internal->dma_id));
 	data->dev_link = pmd_link;
 	data->dev_flags = RTE_ETH_DEV_INTR_LSC |
 				RTE_ETH_DEV_AUTOFILL_QUEUE_XSTATS;
@@ -1548,6 +1912,101 @@ open_int(const char *key __rte_unused, const char *value, void *extra_args)
 	return 0;
 }
 
+static int
+open_dma_ring_size(const char *key __rte_unused, const char *value,
+		   void *extra_args)
+{
+	uint16_t *ring_size = extra_args;
+	unsigned long n;
+	char *end;
+
+	if (value == NULL || extra_args == NULL)
+		return -EINVAL;
+
+	errno = 0;
+	n = strtoul(value, &end, 0);
+	if (end == value || *end != '\0' || errno != 0 ||
+	    n < VHOST_DMA_RING_SIZE_MIN || n > VHOST_DMA_RING_SIZE_MAX ||
+	    !rte_is_power_of_2(n)) {
+		VHOST_LOG(ERR,
+			  "Invalid %s %s, not a power of 2 in [%u, %u]\n",
+			  ETH_VHOST_DMA_RING_SIZE, value,
+			  VHOST_DMA_RING_SIZE_MIN, VHOST_DMA_RING_SIZE_MAX);
+		return -EINVAL;
+	}
+	*ring_size = n;
+
+	return 0;
+}
+
+/* Parses "[txq0@dma0;rxq0@dma1]", binding ethdev queues to DMA devices */
+static int
+open_dmas(const char *key __rte_unused, const char *value, void *extra_args)
+{
+	int16_t *dma_ids = extra_args;
+	char *entries[RTE_MAX_QUEUES_PER_PORT * VIRTIO_QNUM];
+	char *input, *list, *end, *tokens[2];
+	unsigned long qid;
+	uint16_t vring;
+	int dma_id;
+	int i, n;
+	int ret = -1;
+
+	if (value == NULL || extra_args == NULL)
+		return -EINVAL;
+
+	input = strdup(value);
+	if (input == NULL)
+		return -ENOMEM;
+
+	list = input;
+	if (*list == '[') {
+		end = strchr(++list, ']');
+		if (end == NULL || end[1] != '\0')
+			goto out;
+		*end = '\0';
+	}
+
+	n = rte_strsplit(list, strlen(list), entries, RTE_DIM(entries), ';');
+	if (n <= 0)
+		goto out;
+
+	for (i = 0; i < n; i++) {
+		if (rte_strsplit(entries[i], strlen(entries[i]), tokens,
+				 RTE_DIM(tokens), '@') != 2)
+			goto out;
+
+		/* tx queues enqueue to the guest RX vring and vice versa */
+		if (strncmp(tokens[0], "txq", 3) == 0)
+			vring = VIRTIO_RXQ;
+		else if (strncmp(tokens[0], "rxq", 3) == 0)
+			vring = VIRTIO_TXQ;
+		else
+			goto out;
+
+		errno = 0;
+		qid = strtoul(tokens[0] + 3, &end, 10);
+		if (end == tokens[0] + 3 || *end != '\0' || errno != 0 ||
+		    qid >= RTE_MAX_QUEUES_PER_PORT)
+			goto out;
+
+		dma_id = rte_dma_get_dev_id_by_name(tokens[1]);
+		if (dma_id < 0 || dma_id >= RTE_DMADEV_DEFAULT_MAX) {
+			VHOST_LOG(ERR, "Unknown DMA device %s\n", tokens[1]);
+			goto out;
+		}
+		dma_ids[qid * VIRTIO_QNUM + vring] = dma_id;
+	}
+	ret = 0;
+
+out:
+	if (ret < 0)
+		VHOST_LOG(ERR, "Invalid %s argument %s\n", ETH_VHOST_DMAS,
+			  value);
+	free(input);
+	return ret;
+}
+
 static int
 rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 {
@@ -1563,6 +2022,10 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 	int tso = 0;
 	int linear_buf = 0;
 	int ext_buf = 0;
+	int vectorized = 1;
+	uint16_t dma_ring_size = VHOST_DMA_RING_SIZE;
+	int16_t dma_ids[RTE_MAX_QUEUES_PER_PORT * VIRTIO_QNUM];
+	unsigned int i;
 	struct rte_eth_dev *eth_dev;
 	const char *name = rte_vdev_device_name(dev);
 
@@ -1672,13 +2135,60 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 			flags |= RTE_VHOST_USER_EXTBUF_SUPPORT;
 	}
 
+	if (rte_kvargs_count(kvlist, ETH_VHOST_VECTORIZED) == 1) {
+		ret = rte_kvargs_process(kvlist,
+				ETH_VHOST_VECTORIZED,
+				&open_int, &vectorized);
+		if (ret < 0)
+			goto out_free;
+
+		if (vectorized == 0)
+			flags |= RTE_VHOST_USER_NO_VECTORIZED;
+	}
+
+	if (rte_kvargs_count(kvlist, ETH_VHOST_DMA_RING_SIZE) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_VHOST_DMA_RING_SIZE,
+					 &open_dma_ring_size, &dma_ring_size);
+		if (ret < 0)
+			goto out_free;
+	}
+
+	for (i = 0; i < RTE_DIM(dma_ids); i++)
+		dma_ids[i] = INVALID_DMA_ID;
+
+	if (rte_kvargs_count(kvlist, ETH_VHOST_DMAS) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_VHOST_DMAS,
+					 &open_dmas, dma_ids);
+		if (ret < 0)
+			goto out_free;
+	}
+
+	for (i = 0; i < RTE_DIM(dma_ids); i++) {
+		if (dma_ids[i] == INVALID_DMA_ID)
+			continue;
+		if (i >= (unsigned int)queues * VIRTIO_QNUM) {
+			VHOST_LOG(ERR, "DMA device bound to queue %u, out of %u queues\n",
+				  i / VIRTIO_QNUM, queues);
+			ret = -1;
+			goto out_free;
+		}
+		flags |= RTE_VHOST_USER_ASYNC_COPY;
+	}
+
+	ret = vhost_dma_setup(dma_ids, dma_ring_size);
+	if (ret < 0)
+		goto out_free;
+
 	if (dev->device.numa_node == SOCKET_ID_ANY)
 		dev->device.numa_node = rte_socket_id();
 
 	ret = eth_dev_vhost_create(dev, iface_name, queues,
-				   dev->device.numa_node, flags, disable_flags);
-	if (ret == -1)
+				   dev->device.numa_node, flags, disable_flags,
+				   dma_ids);
+	if (ret == -1) {
 		VHOST_LOG(ERR, "Failed to create %s\n", name);
+		vhost_dma_release(dma_ids, RTE_DIM(dma_ids));
+	}
 
 out_free:
 	rte_kvargs_free(kvlist);
@@ -1720,4 +2230,7 @@ RTE_PMD_REGISTER_PARAM_STRING(net_vhost,
 	"postcopy-support=<0|1> "
 	"tso=<0|1> "
 	"linear-buffer=<0|1> "
-	"ext-buffer=<0|1>");
+	"ext-buffer=<0|1> "
+	"dmas=[txq0@dma0;rxq0@dma1] "
+	"dma-ring-size=<int> "
+	"vectorized=<0|1>");
@@ -0,0 +1,1268 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+
+#include "sw_regexdev.h"
+
+/*
+ * A rule is parsed into a syntax tree, from which are built a Thompson NFA
+ * and the literal every match of the rule contains, if any. The NFA is then
+ * turned into a DFA by subset construction, within a state budget.
+ *
+ * Supported syntax: literals, escapes (\d \w \s and their negations, \t \n
+ * \r \f \v \a \e \0 \xHH), classes, '.', groups, non-capturing groups,
+ * alternation, the greedy and lazy quantifiers * + ? {m} {m,} {m,n}, '^'
+ * at the start and '$' at the end of the rule. Matches are leftmost longest,
+ * so lazy quantifiers behave as greedy ones.
+ */
+
+#define SWREGEX_MAX_DEPTH	32
+#define SWREGEX_REPEAT_INF	UINT16_MAX
+
+enum swregex_node_type {
+	SWREGEX_NODE_EMPTY,
+	SWREGEX_NODE_BYTE,
+	SWREGEX_NODE_CONCAT,
+	SWREGEX_NODE_ALT,
+	SWREGEX_NODE_REPEAT,
+};
+
+/* Children of CONCAT and ALT nodes are listed from the last one. */
+struct swregex_node {
+	uint8_t type;
+	uint16_t set;
+	uint16_t min;
+	uint16_t max;
+	int32_t child;
+	int32_t next;
+};
+
+struct swregex_parser {
+	const char *begin;
+	const char *pos;
+	const char *end;
+	bool caseless;
+	bool dotall;
+	bool anchored;
+	bool end_anchored;
+	bool top_alt;
+	unsigned int depth;
+	int err;
+	struct swregex_node *nodes;
+	uint32_t nb_nodes;
+	struct swregex_byte_set *sets;
+	uint32_t nb_sets;
+};
+
+static inline void
+set_add(struct swregex_byte_set *s, uint8_t c)
+{
+	s->bits[c >> 6] |= UINT64_C(1) << (c & 63);
+}
+
+static inline bool
+set_has(const struct swregex_byte_set *s, uint8_t c)
+{
+	return (s->bits[c >> 6] >> (c & 63)) & 1;
+}
+
+static void
+set_add_range(struct swregex_byte_set *s, unsigned int lo, unsigned int hi)
+{
+	unsigned int c;
+
+	for (c = lo; c <= hi; c++)
+		set_add(s, c);
+}
+
+static void
+set_union(struct swregex_byte_set *s, const struct swregex_byte_set *o)
+{
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(s->bits); i++)
+		s->bits[i] |= o->bits[i];
+}
+
+static void
+set_invert(struct swregex_byte_set *s)
+{
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(s->bits); i++)
+		s->bits[i] = ~s->bits[i];
+}
+
+static void
+set_fold_case(struct swregex_byte_set *s)
+{
+	unsigned int c;
+
+	for (c = 'a'; c <= 'z'; c++) {
+		if (set_has(s, c) || set_has(s, c - 'a' + 'A')) {
+			set_add(s, c);
+			set_add(s, c - 'a' + 'A');
+		}
+	}
+}
+
+static unsigned int
+set_count(const struct swregex_byte_set *s)
+{
+	unsigned int i, n = 0;
+
+	for (i = 0; i < RTE_DIM(s->bits); i++)
+		n += __builtin_popcountll(s->bits[i]);
+	return n;
+}
+
+static int32_t
+node_new(struct swregex_parser *p, uint8_t type)
+{
+	struct swregex_node *n = &p->nodes[p->nb_nodes];
+
+	memset(n, 0, sizeof(*n));
+	n->type = type;
+	n->child = -1;
+	n->next = -1;
+	return p->nb_nodes++;
+}
+
+static int32_t
+node_byte(struct swregex_parser *p, const struct swregex_byte_set *set)
+{
+	int32_t node = node_new(p, SWREGEX_NODE_BYTE);
+
+	p->sets[p->nb_sets] = *set;
+	if (p->caseless)
+		set_fold_case(&p->sets[p->nb_sets]);
+	p->nodes[node].set = p->nb_sets++;
+	return node;
+}
+
+static void
+node_prepend(struct swregex_parser *p, int32_t parent, int32_t child)
+{
+	p->nodes[child].next = p->nodes[parent].child;
+	p->nodes[parent].child = child;
+}
+
+static int32_t
+parse_error(struct swregex_parser *p, int err)
+{
+	if (p->err == 0)
+		p->err = err;
+	return -1;
+}
+
+static int
+hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/*
+ * Parse the escape after a backslash. Return the escaped byte, or -1 if
+ * the escape is a class, added to set, or -2 on error.
+ */
+static int
+parse_escape(struct swregex_parser *p, struct swregex_byte_set *set,
+		bool in_class)
+{
+	struct swregex_byte_set tmp;
+	int c, d, v, i;
+	bool invert;
+
+	if (p->pos == p->end)
+		return parse_error(p, -EINVAL) - 1;
+	c = (unsigned char)*p->pos++;
+
+	memset(&tmp, 0, sizeof(tmp));
+	invert = isupper(c);
+	switch (tolower(c)) {
+	case 'd':
+		set_add_range(&tmp, '0', '9');
+		break;
+	case 'w':
+		set_add_range(&tmp, '0', '9');
+		set_add_range(&tmp, 'a', 'z');
+		set_add_range(&tmp, 'A', 'Z');
+		set_add(&tmp, '_');
+		break;
+	case 's':
+		set_add_range(&tmp, '\t', '\r');
+		set_add(&tmp, ' ');
+		break;
+	default:
+		invert = false;
+		switch (c) {
+		case 't':
+			return '\t';
+		case 'n':
+			return '\n';
+		case 'r':
+			return '\r';
+		case 'f':
+			return '\f';
+		case 'v':
+			return '\v';
+		case 'a':
+			return '\a';
+		case 'e':
+			return 0x1b;
+		case 'b':
+			if (in_class)
+				return '\b';
+			/* word boundary */
+			return parse_error(p, -ENOTSUP) - 1;
+		case '0':
+			/* up to two more octal digits */
+			for (v = 0, i = 0; i < 2 && p->pos < p->end &&
+					*p->pos >= '0' && *p->pos <= '7'; i++)
+				v = v * 8 + *p->pos++ - '0';
+			return v;
+		case 'x':
+			v = 0;
+			if (p->pos < p->end && *p->pos == '{') {
+				for (p->pos++, i = 0; p->pos < p->end &&
+						(d = hex_value(*p->pos)) >= 0;
+						p->pos++, i++)
+					v = v * 16 + d;
+				if (p->pos == p->end || *p->pos != '}' ||
+						i == 0 || i > 2)
+					return parse_error(p, -EINVAL) - 1;
+				p->pos++;
+				return v;
+			}
+			for (i = 0; i < 2 && p->pos < p->end &&
+					(d = hex_value(*p->pos)) >= 0; i++) {
+				v = v * 16 + d;
+				p->pos++;
+			}
+			return v;
+		default:
+			/* back references, assertions, properties... */
+			if (isalnum(c))
+				return parse_error(p, -ENOTSUP) - 1;
+			return c;
+		}
+	}
+
+	if (invert)
+		set_invert(&tmp);
+	set_union(set, &tmp);
+	return -1;
+}
+
+/* A byte of a class, or -1 if a class escape was added to set */
+static int
+parse_class_byte(struct swregex_parser *p, struct swregex_byte_set *set)
+{
+	if (*p->pos != '\\')
+		return (unsigned char)*p->pos++;
+	p->pos++;
+	return parse_escape(p, set, true);
+}
+
+static int32_t
+parse_class(struct swregex_parser *p)
+{
+	struct swregex_byte_set set;
+	bool negate = false, first = true;
+	int lo, hi;
+
+	memset(&set, 0, sizeof(set));
+	if (p->pos < p->end && *p->pos == '^') {
+		negate = true;
+		p->pos++;
+	}
+
+	for (;;) {
+		if (p->pos == p->end)
+			return parse_error(p, -EINVAL);
+		if (*p->pos == ']' && !first) {
+			p->pos++;
+			break;
+		}
+		first = false;
+		/* POSIX classes and collating elements */
+		if (*p->pos == '[' && p->pos + 1 < p->end &&
+				(p->pos[1] == ':' || p->pos[1] == '=' ||
+				 p->pos[1] == '.'))
+			return parse_error(p, -ENOTSUP);
+
+		lo = parse_class_byte(p, &set);
+		if (lo < -1)
+			return -1;
+		if (lo < 0)
+			continue;
+		if (p->pos + 1 < p->end && *p->pos == '-' &&
+				p->pos[1] != ']') {
+			p->pos++;
+			hi = parse_class_byte(p, &set);
+			if (hi < -1)
+				return -1;
+			if (hi < lo)
+				return parse_error(p, -EINVAL);
+			set_add_range(&set, lo, hi);
+		} else {
+			set_add(&set, lo);
+		}
+	}
+
+	/* fold before negating, as [^a] must not match 'A' either */
+	if (p->caseless)
+		set_fold_case(&set);
+	if (negate)
+		set_invert(&set);
+	return node_byte(p, &set);
+}
+
+static int32_t parse_alt(struct swregex_parser *p);
+
+static int32_t
+parse_atom(struct swregex_parser *p)
+{
+	struct swregex_byte_set set;
+	int32_t node;
+	int c;
+
+	memset(&set, 0, sizeof(set));
+	c = (unsigned char)*p->pos++;
+	switch (c) {
+	case '(':
+		if (p->pos < p->end && *p->pos == '?') {
+			if (p->pos + 1 == p->end || p->pos[1] != ':')
+				return parse_error(p, -ENOTSUP);
+			p->pos += 2;
+		}
+		if (++p->depth > SWREGEX_MAX_DEPTH)
+			return parse_error(p, -EINVAL);
+		node = parse_alt(p);
+		p->depth--;
+		if (node < 0)
+			return -1;
+		if (p->pos == p->end || *p->pos != ')')
+			return parse_error(p, -EINVAL);
+		p->pos++;
+		return node;
+	case '*':
+	case '+':
+	case '?':
+		/* nothing to repeat */
+		return parse_error(p, -EINVAL);
+	case '[':
+		return parse_class(p);
+	case '.':
+		set_invert(&set);
+		if (!p->dotall)
+			set.bits['\n' >> 6] &= ~(UINT64_C(1) << ('\n' & 63));
+		return node_byte(p, &set);
+	case '\\':
+		c = parse_escape(p, &set, false);
+		if (c < -1)
+			return -1;
+		if (c >= 0)
+			set_add(&set, c);
+		return node_byte(p, &set);
+	default:
+		set_add(&set, c);
+		return node_byte(p, &set);
+	}
+}
+
+static unsigned int
+parse_number(struct swregex_parser *p, unsigned int *n)
+{
+	unsigned int digits = 0;
+
+	*n = 0;
+	while (p->pos < p->end && isdigit(*p->pos) && digits < 6) {
+		*n = *n * 10 + *p->pos++ - '0';
+		digits++;
+	}
+	return digits;
+}
+
+/*
+ * Parse a {m}, {m,} or {m,n} quantifier. Braces which are not a quantifier
+ * are a literal, as in PCRE.
+ */
+static bool
+parse_bound(struct swregex_parser *p, unsigned int *min, unsigned int *max)
+{
+	const char *start = p->pos;
+
+	p->pos++;
+	if (parse_number(p, min) == 0)
+		goto literal;
+	*max = *min;
+	if (p->pos < p->end && *p->pos == ',') {
+		p->pos++;
+		if (parse_number(p, max) == 0)
+			*max = SWREGEX_REPEAT_INF;
+	}
+	if (p->pos == p->end || *p->pos != '}')
+		goto literal;
+	p->pos++;
+	return true;
+
+literal:
+	p->pos = start;
+	return false;
+}
+
+static int32_t
+parse_repeat(struct swregex_parser *p)
+{
+	unsigned int min, max;
+	int32_t node, rep;
+
+	if (*p->pos == '{') {
+		/* literal brace */
+		struct swregex_byte_set set;
+
+		memset(&set, 0, sizeof(set));
+		set_add(&set, *p->pos++);
+		node = node_byte(p, &set);
+	} else {
+		node = parse_atom(p);
+	}
+	if (node < 0 || p->pos == p->end)
+		return node;
+
+	switch (*p->pos) {
+	case '*':
+		min = 0;
+		max = SWREGEX_REPEAT_INF;
+		p->pos++;
+		break;
+	case '+':
+		min = 1;
+		max = SWREGEX_REPEAT_INF;
+		p->pos++;
+		break;
+	case '?':
+		min = 0;
+		max = 1;
+		p->pos++;
+		break;
+	case '{':
+		if (parse_bound(p, &min, &max))
+			break;
+		/* fall through */
+	default:
+		return node;
+	}
+
+	if (min > SWREGEX_MAX_REPEAT || (max != SWREGEX_REPEAT_INF &&
+			(max > SWREGEX_MAX_REPEAT || max < min)))
+		return parse_error(p, -EINVAL);
+
+	if (p->pos < p->end) {
+		if (*p->pos == '?')
+			p->pos++; /* lazy */
+		else if (*p->pos == '+')
+			return parse_error(p, -ENOTSUP); /* possessive */
+	}
+	if (p->pos < p->end && (*p->pos == '*' || *p->pos == '+' ||
+			*p->pos == '?'))
+		return parse_error(p, -EINVAL);
+
+	rep = node_new(p, SWREGEX_NODE_REPEAT);
+	p->nodes[rep].child = node;
+	p->nodes[rep].min = min;
+	p->nodes[rep].max = max;
+	return rep;
+}
+
+static int32_t
+parse_concat(struct swregex_parser *p)
+{
+	int32_t concat, node, last;
+	struct swregex_node *n;
+
+	concat = node_new(p, SWREGEX_NODE_CONCAT);
+	while (p->pos < p->end && *p->pos != '|' && *p->pos != ')') {
+		if (*p->pos == '^') {
+			if (p->pos != p->begin || p->depth != 0)
+				return parse_error(p, -ENOTSUP);
+			p->anchored = true;
+			p->pos++;
+			continue;
+		}
+		if (*p->pos == '$') {
+			if (p->pos + 1 != p->end || p->depth != 0)
+				return parse_error(p, -ENOTSUP);
+			p->end_anchored = true;
+			p->pos++;
+			continue;
+		}
+
+		node = parse_repeat(p);
+		if (node < 0)
+			return -1;
+		n = &p->nodes[node];
+		if (n->type == SWREGEX_NODE_EMPTY)
+			continue;
+		if (n->type != SWREGEX_NODE_CONCAT) {
+			node_prepend(p, concat, node);
+			continue;
+		}
+		/* splice the children of a group */
+		for (last = n->child; p->nodes[last].next >= 0;
+				last = p->nodes[last].next)
+			;
+		p->nodes[last].next = p->nodes[concat].child;
+		p->nodes[concat].child = n->child;
+	}
+
+	n = &p->nodes[concat];
+	if (n->child < 0)
+		n->type = SWREGEX_NODE_EMPTY;
+	else if (p->nodes[n->child].next < 0)
+		return n->child;
+	return concat;
+}
+
+static int32_t
+parse_alt(struct swregex_parser *p)
+{
+	int32_t alt, node;
+
+	node = parse_concat(p);
+	if (node < 0 || p->pos == p->end || *p->pos != '|')
+		return node;
+
+	alt = node_new(p, SWREGEX_NODE_ALT);
+	node_prepend(p, alt, node);
+	while (p->pos < p->end && *p->pos == '|') {
+		p->pos++;
+		if (p->depth == 0)
+			p->top_alt = true;
+		node = parse_concat(p);
+		if (node < 0)
+			return -1;
+		node_prepend(p, alt, node);
+	}
+	return alt;
+}
+
+struct swregex_emitter {
+	const struct swregex_node *nodes;
+	struct swregex_nfa_state *states;
+	uint32_t nb_states;
+	bool full;
+};
+
+static int32_t
+state_new(struct swregex_emitter *e, uint16_t op, uint16_t set,
+		int32_t out, int32_t out1)
+{
+	struct swregex_nfa_state *s;
+
+	if (e->nb_states == SWREGEX_MAX_NFA_STATES) {
+		e->full = true;
+		return -1;
+	}
+	s = &e->states[e->nb_states];
+	s->op = op;
+	s->set = set;
+	s->out = out;
+	s->out1 = out1;
+	return e->nb_states++;
+}
+
+/* Emit the states of a node, followed by next, and return its first one */
+static int32_t
+emit(struct swregex_emitter *e, int32_t node, int32_t next)
+{
+	const struct swregex_node *n = &e->nodes[node];
+	int32_t cur, s, split;
+	int32_t c;
+	unsigned int i;
+
+	switch (n->type) {
+	case SWREGEX_NODE_EMPTY:
+		return next;
+	case SWREGEX_NODE_BYTE:
+		return state_new(e, SWREGEX_NFA_BYTE, n->set, next, 0);
+	case SWREGEX_NODE_CONCAT:
+		cur = next;
+		for (c = n->child; c >= 0 && cur >= 0; c = e->nodes[c].next)
+			cur = emit(e, c, cur);
+		return cur;
+	case SWREGEX_NODE_ALT:
+		cur = -1;
+		for (c = n->child; c >= 0; c = e->nodes[c].next) {
+			s = emit(e, c, next);
+			if (s < 0)
+				return -1;
+			cur = cur < 0 ? s :
+				state_new(e, SWREGEX_NFA_SPLIT, 0, s, cur);
+		}
+		return cur;
+	case SWREGEX_NODE_REPEAT:
+		cur = next;
+		if (n->max == SWREGEX_REPEAT_INF) {
+			split = state_new(e, SWREGEX_NFA_SPLIT, 0, 0, next);
+			s = split < 0 ? -1 : emit(e, n->child, split);
+			if (s < 0)
+				return -1;
+			e->states[split].out = s;
+			cur = split;
+		} else {
+			/* (x(x)?)? for the optional occurrences */
+			for (i = n->min; i < n->max; i++) {
+				split = state_new(e, SWREGEX_NFA_SPLIT, 0, 0,
+						next);
+				s = split < 0 ? -1 : emit(e, n->child, cur);
+				if (s < 0)
+					return -1;
+				e->states[split].out = s;
+				cur = split;
+			}
+		}
+		for (i = 0; i < n->min && cur >= 0; i++)
+			cur = emit(e, n->child, cur);
+		return cur;
+	}
+	return -1;
+}
+
+/* Literal byte of a set, lower case for a caseless letter, or -1 */
+static int
+literal_byte(const struct swregex_byte_set *s, bool caseless)
+{
+	unsigned int c, n = set_count(s);
+
+	if (n == 1) {
+		for (c = 0; !set_has(s, c); c++)
+			;
+		return c;
+	}
+	if (n == 2 && caseless) {
+		for (c = 'a'; c <= 'z'; c++)
+			if (set_has(s, c) && set_has(s, c - 'a' + 'A'))
+				return c;
+	}
+	return -1;
+}
+
+/*
+ * Find the longest run of literal bytes in the top level sequence of the
+ * rule, which every match contains. A repetition of at least once of a
+ * literal byte extends a run, and ends it unless its count is fixed.
+ */
+static int
+literal_extract(const struct swregex_parser *p, int32_t root,
+		struct swregex_prog *prog, struct swregex_literal *lit,
+		int socket_id)
+{
+	const struct swregex_node *n, *child;
+	uint8_t *run, *best = NULL;
+	uint32_t nb, i, j, len = 0, best_len = 0;
+	int32_t *seq, c;
+	bool plain = true;
+	int b;
+
+	n = &p->nodes[root];
+	nb = 0;
+	if (n->type == SWREGEX_NODE_CONCAT)
+		for (c = n->child; c >= 0; c = p->nodes[c].next)
+			nb++;
+	else
+		nb = 1;
+
+	seq = malloc(sizeof(*seq) * nb);
+	run = malloc(SWREGEX_MAX_PAYLOAD);
+	if (seq == NULL || run == NULL) {
+		free(seq);
+		free(run);
+		return -ENOMEM;
+	}
+	if (n->type == SWREGEX_NODE_CONCAT)
+		for (c = n->child, i = nb; c >= 0; c = p->nodes[c].next)
+			seq[--i] = c;
+	else
+		seq[0] = root;
+
+	for (i = 0; i <= nb; i++) {
+		n = i < nb ? &p->nodes[seq[i]] : NULL;
+		b = -1;
+		if (n != NULL && n->type == SWREGEX_NODE_BYTE) {
+			b = literal_byte(&p->sets[n->set], p->caseless);
+			if (b >= 0 && len < SWREGEX_MAX_PAYLOAD) {
+				run[len++] = b;
+				continue;
+			}
+		} else if (n != NULL && n->type == SWREGEX_NODE_REPEAT &&
+				n->min > 0) {
+			child = &p->nodes[n->child];
+			if (child->type == SWREGEX_NODE_BYTE)
+				b = literal_byte(&p->sets[child->set],
+						p->caseless);
+			for (j = 0; b >= 0 && j < n->min &&
+					len < SWREGEX_MAX_PAYLOAD; j++)
+				run[len++] = b;
+			if (b >= 0 && n->min == n->max)
+				continue;
+		}
+		if (n != NULL)
+			plain = false;
+		/* end of a run */
+		if (len > best_len) {
+			best_len = len;
+			free(best);
+			best = malloc(len);
+			if (best == NULL)
+				break;
+			memcpy(best, run, len);
+		}
+		len = 0;
+	}
+	free(seq);
+	free(run);
+
+	prog->literal = -1;
+	lit->len = 0;
+	if (best_len == 0) {
+		free(best);
+		return 0;
+	}
+	if (best == NULL)
+		return -ENOMEM;
+
+	lit->str = rte_malloc_socket("swregex literal", best_len, 0,
+			socket_id);
+	if (lit->str == NULL) {
+		free(best);
+		return -ENOMEM;
+	}
+	memcpy(lit->str, best, best_len);
+	free(best);
+	lit->len = best_len;
+	lit->caseless = p->caseless;
+	/* the whole rule: a run of plain literal bytes ending at nb */
+	prog->literal_only = plain && best_len == nb && !p->anchored &&
+		!p->end_anchored;
+	return 0;
+}
+
+/* Add the closure of state to a set of the important states of an NFA. */
+static void
+closure_add(const struct swregex_prog *prog, uint16_t state, uint16_t *set,
+		uint32_t *nb, uint32_t *marks, uint32_t gen, uint16_t *stack)
+{
+	const struct swregex_nfa_state *s;
+	uint32_t top = 0;
+
+	stack[top++] = state;
+	while (top > 0) {
+		state = stack[--top];
+		if (marks[state] == gen)
+			continue;
+		marks[state] = gen;
+		s = &prog->states[state];
+		switch (s->op) {
+		case SWREGEX_NFA_SPLIT:
+			stack[top++] = s->out1;
+			/* fall through */
+		case SWREGEX_NFA_JMP:
+			stack[top++] = s->out;
+			break;
+		default:
+			set[(*nb)++] = state;
+			break;
+		}
+	}
+}
+
+static int
+state_cmp(const void *a, const void *b)
+{
+	return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+static uint32_t
+state_set_hash(const uint16_t *set, uint32_t nb)
+{
+	uint32_t h = 2166136261u, i;
+
+	for (i = 0; i < nb; i++)
+		h = (h ^ set[i]) * 16777619u;
+	return h;
+}
+
+/* Partition the bytes in classes, the bytes of a class being in the same
+ * sets of the NFA.
+ */
+static void
+byte_classes_build(struct swregex_prog *prog, uint8_t *reps)
+{
+	uint16_t remap[256][2];
+	unsigned int c, i, nb;
+	bool in;
+
+	memset(prog->class_map, 0, sizeof(prog->class_map));
+	prog->nb_classes = 1;
+	for (i = 0; i < prog->nb_states; i++) {
+		if (prog->states[i].op != SWREGEX_NFA_BYTE)
+			continue;
+		memset(remap, 0xff, sizeof(remap));
+		nb = 0;
+		for (c = 0; c < 256; c++) {
+			in = set_has(&prog->sets[prog->states[i].set], c);
+			if (remap[prog->class_map[c]][in] == UINT16_MAX)
+				remap[prog->class_map[c]][in] = nb++;
+			prog->class_map[c] = remap[prog->class_map[c]][in];
+		}
+		prog->nb_classes = nb;
+	}
+	for (c = 256; c-- > 0; )
+		reps[prog->class_map[c]] = c;
+}
+
+/*
+ * Subset construction of the DFA, states being the sets of important NFA
+ * states. An unanchored DFA restarts the NFA at every position.
+ */
+static int
+dfa_build(struct swregex_prog *prog, int socket_id)
+{
+	const uint32_t ht_size = SWREGEX_MAX_DFA_STATES * 2;
+	uint32_t pool_size, pool_len = 0, nb_start = 0, nb, i, h, d, cls;
+	uint32_t *set_off = NULL, *set_len = NULL, *marks = NULL, gen = 0;
+	uint16_t *pool = NULL, *set = NULL, *stack = NULL, *ht = NULL;
+	uint16_t *trans = NULL, *start = NULL;
+	uint8_t *accept = NULL, reps[256];
+	const struct swregex_nfa_state *s;
+	uint32_t nb_dfa = 2;
+	int ret = -ENOMEM;
+
+	byte_classes_build(prog, reps);
+
+	pool_size = prog->nb_states * 16;
+	pool = malloc(sizeof(*pool) * pool_size);
+	set_off = calloc(SWREGEX_MAX_DFA_STATES, sizeof(*set_off));
+	set_len = calloc(SWREGEX_MAX_DFA_STATES, sizeof(*set_len));
+	marks = calloc(prog->nb_states, sizeof(*marks));
+	set = malloc(sizeof(*set) * prog->nb_states * 2);
+	start = malloc(sizeof(*start) * prog->nb_states);
+	stack = malloc(sizeof(*stack) * (prog->nb_states * 2 + 1));
+	ht = calloc(ht_size, sizeof(*ht));
+	trans = calloc((size_t)SWREGEX_MAX_DFA_STATES * prog->nb_classes,
+			sizeof(*trans));
+	accept = calloc(SWREGEX_MAX_DFA_STATES, sizeof(*accept));
+	if (pool == NULL || set_off == NULL || set_len == NULL ||
+			marks == NULL || set == NULL || start == NULL ||
+			stack == NULL || ht == NULL || trans == NULL ||
+			accept == NULL)
+		goto out;
+
+	/* state 0 is the empty set, state 1 the start closure */
+	closure_add(prog, prog->start, start, &nb_start, marks, ++gen, stack);
+	qsort(start, nb_start, sizeof(*start), state_cmp);
+	memcpy(pool, start, sizeof(*start) * nb_start);
+	set_off[1] = 0;
+	set_len[1] = nb_start;
+	pool_len = nb_start;
+	ht[state_set_hash(start, nb_start) & (ht_size - 1)] = 1;
+
+	for (d = 1; d < nb_dfa; d++) {
+		for (i = 0; i < set_len[d]; i++)
+			if (prog->states[pool[set_off[d] + i]].op ==
+					SWREGEX_NFA_MATCH)
+				accept[d] = 1;
+
+		for (cls = 0; cls < prog->nb_classes; cls++) {
+			nb = 0;
+			gen++;
+			for (i = 0; i < set_len[d]; i++) {
+				s = &prog->states[pool[set_off[d] + i]];
+				if (s->op == SWREGEX_NFA_BYTE &&
+						set_has(&prog->sets[s->set],
+							reps[cls]))
+					closure_add(prog, s->out, set, &nb,
+							marks, gen, stack);
+			}
+			if (nb == 0 && prog->anchored) {
+				trans[d * prog->nb_classes + cls] = 0;
+				continue;
+			}
+			if (!prog->anchored)
+				for (i = 0; i < nb_start; i++)
+					if (marks[start[i]] != gen) {
+						marks[start[i]] = gen;
+						set[nb++] = start[i];
+					}
+			qsort(set, nb, sizeof(*set), state_cmp);
+
+			/* look the set up, or add a state */
+			for (h = state_set_hash(set, nb); ;
+					h++) {
+				i = ht[h & (ht_size - 1)];
+				if (i == 0 || (set_len[i] == nb &&
+						memcmp(&pool[set_off[i]], set,
+							sizeof(*set) * nb) == 0))
+					break;
+			}
+			if (i == 0) {
+				if (nb_dfa == SWREGEX_MAX_DFA_STATES) {
+					ret = -ENOSPC;
+					goto out;
+				}
+				if (pool_len + nb > pool_size) {
+					uint16_t *tmp;
+
+					pool_size = (pool_len + nb) * 2;
+					tmp = realloc(pool,
+						sizeof(*pool) * pool_size);
+					if (tmp == NULL)
+						goto out;
+					pool = tmp;
+				}
+				i = nb_dfa++;
+				memcpy(&pool[pool_len], set, sizeof(*set) * nb);
+				set_off[i] = pool_len;
+				set_len[i] = nb;
+				pool_len += nb;
+				ht[h & (ht_size - 1)] = i;
+			}
+			trans[d * prog->nb_classes + cls] = i;
+		}
+	}
+
+	prog->dfa = rte_malloc_socket("swregex dfa",
+			sizeof(*trans) * nb_dfa * prog->nb_classes, 0,
+			socket_id);
+	prog->dfa_accept = rte_malloc_socket("swregex dfa", nb_dfa, 0,
+			socket_id);
+	if (prog->dfa == NULL || prog->dfa_accept == NULL) {
+		rte_free(prog->dfa);
+		rte_free(prog->dfa_accept);
+		prog->dfa = NULL;
+		prog->dfa_accept = NULL;
+		goto out;
+	}
+	memcpy(prog->dfa, trans, sizeof(*trans) * nb_dfa * prog->nb_classes);
+	memcpy(prog->dfa_accept, accept, nb_dfa);
+	prog->nb_dfa_states = nb_dfa;
+	ret = 0;
+
+out:
+	free(pool);
+	free(set_off);
+	free(set_len);
+	free(marks);
+	free(set);
+	free(start);
+	free(stack);
+	free(ht);
+	free(trans);
+	free(accept);
+	return ret;
+}
+
+void
+swregex_prog_free(struct swregex_prog *prog)
+{
+	rte_free(prog->states);
+	rte_free(prog->sets);
+	rte_free(prog->dfa);
+	rte_free(prog->dfa_accept);
+	memset(prog, 0, sizeof(*prog));
+}
+
+int
+swregex_prog_compile(const struct swregex_rule *rule,
+		struct swregex_prog *prog, struct swregex_literal *lit,
+		int socket_id)
+{
+	struct swregex_parser p;
+	struct swregex_emitter e;
+	uint32_t nb, *marks = NULL;
+	uint16_t *set = NULL, *stack = NULL;
+	int32_t root, match, start;
+	uint32_t i;
+	int ret;
+
+	memset(prog, 0, sizeof(*prog));
+	memset(lit, 0, sizeof(*lit));
+	memset(&p, 0, sizeof(p));
+	memset(&e, 0, sizeof(e));
+	prog->literal = -1;
+
+	if (rule->flags & ~SWREGEX_RULE_FLAGS)
+		return -ENOTSUP;
+
+	p.begin = rule->pcre;
+	p.pos = rule->pcre;
+	p.end = rule->pcre + rule->pcre_len;
+	p.caseless = !!(rule->flags & RTE_REGEX_PCRE_RULE_CASELESS_F);
+	p.dotall = !!(rule->flags & RTE_REGEX_PCRE_RULE_DOTALL_F);
+	p.nodes = malloc(sizeof(*p.nodes) * (rule->pcre_len * 4 + 4));
+	p.sets = malloc(sizeof(*p.sets) * (rule->pcre_len + 1));
+	e.states = rte_malloc_socket("swregex nfa",
+			sizeof(*e.states) * SWREGEX_MAX_NFA_STATES, 0,
+			socket_id);
+	if (p.nodes == NULL || p.sets == NULL || e.states == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	root = parse_alt(&p);
+	if (root >= 0 && p.pos != p.end)
+		root = parse_error(&p, -EINVAL); /* unbalanced ')' */
+	if (root >= 0 && p.top_alt && (p.anchored || p.end_anchored))
+		root = parse_error(&p, -ENOTSUP);
+	if (root < 0) {
+		ret = p.err;
+		goto out;
+	}
+	if (rule->flags & RTE_REGEX_PCRE_RULE_ANCHORED_F)
+		p.anchored = true;
+
+	e.nodes = p.nodes;
+	match = state_new(&e, SWREGEX_NFA_MATCH, 0, 0, 0);
+	start = emit(&e, root, match);
+	if (start < 0 || e.full) {
+		ret = e.full ? -ENOSPC : -EINVAL;
+		goto out;
+	}
+
+	prog->rule_id = rule->rule_id;
+	prog->group_id = rule->group_id;
+	prog->anchored = p.anchored;
+	prog->end_anchored = p.end_anchored;
+	prog->nb_states = e.nb_states;
+	prog->start = start;
+	prog->states = e.states;
+	e.states = NULL;
+	prog->sets = rte_malloc_socket("swregex sets",
+			sizeof(*prog->sets) * RTE_MAX(p.nb_sets, 1u), 0,
+			socket_id);
+	if (prog->sets == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	memcpy(prog->sets, p.sets, sizeof(*prog->sets) * p.nb_sets);
+
+	/* empty matches are not supported, and the bytes of the start
+	 * closure are the ones a match can start with.
+	 */
+	marks = calloc(prog->nb_states, sizeof(*marks));
+	set = malloc(sizeof(*set) * prog->nb_states);
+	stack = malloc(sizeof(*stack) * (prog->nb_states * 2 + 1));
+	if (marks == NULL || set == NULL || stack == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	nb = 0;
+	closure_add(prog, prog->start, set, &nb, marks, 1, stack);
+	for (i = 0; i < nb; i++) {
+		if (prog->states[set[i]].op == SWREGEX_NFA_MATCH) {
+			ret = -EINVAL;
+			goto out;
+		}
+		set_union(&prog->first,
+				&prog->sets[prog->states[set[i]].set]);
+	}
+
+	ret = literal_extract(&p, root, prog, lit, socket_id);
+	if (ret < 0)
+		goto out;
+
+	if (!prog->literal_only) {
+		ret = dfa_build(prog, socket_id);
+		/* over budget, the NFA is run alone */
+		if (ret == -ENOSPC)
+			ret = 0;
+	}
+
+out:
+	if (ret < 0) {
+		swregex_prog_free(prog);
+		rte_free(lit->str);
+		memset(lit, 0, sizeof(*lit));
+	}
+	free(marks);
+	free(set);
+	free(stack);
+	free(p.nodes);
+	free(p.sets);
+	rte_free(e.states);
+	return ret;
+}
+
+static int
+literal_cmp(const void *a, const void *b)
+{
+	const struct swregex_literal *la = *(struct swregex_literal * const *)a;
+	const struct swregex_literal *lb = *(struct swregex_literal * const *)b;
+	int ret;
+
+	ret = memcmp(la->str, lb->str, RTE_MIN(la->len, lb->len));
+	return ret != 0 ? ret : (int)la->len - (int)lb->len;
+}
+
+static void
+prefilter_mask_add(struct swregex_prefilter *pf, unsigned int k, uint8_t c,
+		unsigned int bucket)
+{
+	pf->lo[k][c & 0xf] |= 1 << bucket;
+	pf->hi[k][c >> 4] |= 1 << bucket;
+}
+
+/*
+ * Spread the literals over the buckets in sorted order, so that the
+ * literals of a bucket share their first bytes, and fewer positions are
+ * candidates for a bucket.
+ */
+static int
+prefilter_build(struct swregex_prefilter *pf, int socket_id)
+{
+	struct swregex_literal **sorted;
+	struct swregex_literal *lit;
+	uint32_t i, b, count[SWREGEX_PF_BUCKETS] = { 0 };
+	unsigned int k;
+	uint8_t c;
+
+	memset(pf->lo, 0, sizeof(pf->lo));
+	memset(pf->hi, 0, sizeof(pf->hi));
+	if (pf->nb_lits == 0)
+		return 0;
+
+	pf->min_len = UINT16_MAX;
+	for (i = 0; i < pf->nb_lits; i++)
+		pf->min_len = RTE_MIN(pf->min_len, pf->lits[i].len);
+	pf->nb_masks = RTE_MIN(pf->min_len, SWREGEX_PF_MASKS);
+
+	sorted = malloc(sizeof(*sorted) * pf->nb_lits);
+	pf->bucket_lits = rte_malloc_socket("swregex prefilter",
+			sizeof(*pf->bucket_lits) * pf->nb_lits, 0, socket_id);
+	if (sorted == NULL || pf->bucket_lits == NULL) {
+		free(sorted);
+		return -ENOMEM;
+	}
+	for (i = 0; i < pf->nb_lits; i++)
+		sorted[i] = &pf->lits[i];
+	qsort(sorted, pf->nb_lits, sizeof(*sorted), literal_cmp);
+
+	for (i = 0; i < pf->nb_lits; i++)
+		count[(uint64_t)i * SWREGEX_PF_BUCKETS / pf->nb_lits]++;
+	pf->bucket_start[0] = 0;
+	for (b = 0; b < SWREGEX_PF_BUCKETS; b++)
+		pf->bucket_start[b + 1] = pf->bucket_start[b] + count[b];
+
+	for (i = 0; i < pf->nb_lits; i++) {
+		b = (uint64_t)i * SWREGEX_PF_BUCKETS / pf->nb_lits;
+		lit = sorted[i];
+		pf->bucket_lits[i] = lit - pf->lits;
+		for (k = 0; k < pf->nb_masks; k++) {
+			c = lit->str[k];
+			prefilter_mask_add(pf, k, c, b);
+			if (lit->caseless && islower(c))
+				prefilter_mask_add(pf, k, toupper(c), b);
+		}
+	}
+	free(sorted);
+	return 0;
+}
+
+void
+swregex_db_free(struct swregex_db *db)
+{
+	uint32_t i;
+
+	if (db == NULL)
+		return;
+	for (i = 0; i < db->nb_progs; i++)
+		swregex_prog_free(&db->progs[i]);
+	for (i = 0; i < db->pf.nb_lits; i++)
+		rte_free(db->pf.lits[i].str);
+	rte_free(db->progs);
+	rte_free(db->nolit);
+	rte_free(db->pf.lits);
+	rte_free(db->pf.bucket_lits);
+	rte_free(db);
+}
+
+int
+swregex_db_compile(const struct swregex_rule_set *set,
+		struct swregex_db **dbp, int socket_id)
+{
+	struct swregex_literal lit;
+	struct swregex_prog *prog;
+	struct swregex_db *db;
+	uint32_t i;
+	int ret;
+
+	db = rte_zmalloc_socket("swregex db", sizeof(*db), RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (db == NULL)
+		return -ENOMEM;
+	db->progs = rte_zmalloc_socket("swregex db",
+			sizeof(*db->progs) * RTE_MAX(set->nb_rules, 1u),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	db->nolit = rte_zmalloc_socket("swregex db",
+			sizeof(*db->nolit) * RTE_MAX(set->nb_rules, 1u), 0,
+			socket_id);
+	db->pf.lits = rte_zmalloc_socket("swregex db",
+			sizeof(*db->pf.lits) * RTE_MAX(set->nb_rules, 1u), 0,
+			socket_id);
+	if (db->progs == NULL || db->nolit == NULL || db->pf.lits == NULL) {
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	for (i = 0; i < set->nb_rules; i++) {
+		prog = &db->progs[i];
+		ret = swregex_prog_compile(&set->rules[i], prog, &lit,
+				socket_id);
+		if (ret < 0) {
+			SWREGEX_LOG(ERR, "Cannot compile rule %u: %s",
+				set->rules[i].rule_id, strerror(-ret));
+			goto error;
+		}
+		db->nb_progs++;
+		db->max_nfa_states = RTE_MAX(db->max_nfa_states,
+				prog->nb_states);
+		if (prog->dfa != NULL)
+			db->nb_dfa++;
+		if (prog->literal_only)
+			db->nb_literal_only++;
+		if (lit.len == 0) {
+			db->nolit[db->nb_nolit++] = i;
+			continue;
+		}
+		lit.prog = i;
+		prog->literal = db->pf.nb_lits;
+		db->pf.lits[db->pf.nb_lits++] = lit;
+	}
+
+	ret = prefilter_build(&db->pf, socket_id);
+	if (ret < 0)
+		goto error;
+
+	*dbp = db;
+	return 0;
+
+error:
+	swregex_db_free(db);
+	return ret;
+}
@@ -0,0 +1,569 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_vect.h>
+
+#include "sw_regexdev.h"
+
+/*
+ * A scan runs the prefilter over the payload first. The hits of the
+ * literals of literal only rules are matches; the other rules hit are
+ * candidates, run with the rules without literal. A rule is run with its
+ * DFA to find whether it matches, then with its NFA to find the bounds of
+ * the leftmost longest match, and again from the end of that match.
+ */
+
+struct swregex_match_ctx {
+	struct rte_regex_ops *op;
+	uint16_t max_matches;
+	bool match_as_end;
+	bool stop_on_match;
+	bool high_priority;
+	bool stop;
+	/* groups of the op, all if none */
+	uint8_t nb_groups;
+	uint16_t groups[4];
+	/* reported match, when high priority */
+	uint32_t best_rule;
+	uint16_t best_start;
+	uint16_t best_len;
+};
+
+static inline bool
+group_match(const struct swregex_match_ctx *ctx, uint16_t group_id)
+{
+	unsigned int i;
+
+	if (ctx->nb_groups == 0)
+		return true;
+	for (i = 0; i < ctx->nb_groups; i++)
+		if (ctx->groups[i] == group_id)
+			return true;
+	return false;
+}
+
+static void
+match_set(const struct swregex_match_ctx *ctx, struct rte_regexdev_match *m,
+		const struct swregex_prog *prog, uint16_t start, uint16_t len)
+{
+	m->rule_id = prog->rule_id;
+	m->group_id = prog->group_id;
+	m->start_offset = start;
+	if (ctx->match_as_end)
+		m->end_offset = start + len;
+	else
+		m->len = len;
+}
+
+static void
+match_add(struct swregex_match_ctx *ctx, const struct swregex_prog *prog,
+		uint32_t start, uint32_t end)
+{
+	struct rte_regex_ops *op = ctx->op;
+	uint16_t len = end - start;
+
+	if (op->nb_actual_matches < UINT16_MAX)
+		op->nb_actual_matches++;
+	if (ctx->stop_on_match)
+		ctx->stop = true;
+
+	if (ctx->high_priority) {
+		/* keep the match of the lowest rule, then the first one */
+		if (ctx->max_matches == 0)
+			return;
+		if (op->nb_matches != 0 &&
+				(prog->rule_id > ctx->best_rule ||
+				 (prog->rule_id == ctx->best_rule &&
+				  (start > ctx->best_start ||
+				   (start == ctx->best_start &&
+				    len <= ctx->best_len)))))
+			return;
+		op->nb_matches = 1;
+		ctx->best_rule = prog->rule_id;
+		ctx->best_start = start;
+		ctx->best_len = len;
+		match_set(ctx, &op->matches[0], prog, start, len);
+		return;
+	}
+
+	if (op->nb_matches < ctx->max_matches)
+		match_set(ctx, &op->matches[op->nb_matches++], prog, start,
+				len);
+	else
+		op->rsp_flags |= RTE_REGEX_OPS_RSP_MAX_MATCH_F;
+}
+
+static inline uint32_t
+mark_gen_next(struct swregex_scratch *s)
+{
+	if (++s->mark_gen == 0) {
+		memset(s->marks, 0, sizeof(*s->marks) * s->nb_states);
+		s->mark_gen = 1;
+	}
+	return s->mark_gen;
+}
+
+static inline bool
+byte_set_has(const struct swregex_byte_set *set, uint8_t c)
+{
+	return (set->bits[c >> 6] >> (c & 63)) & 1;
+}
+
+/* Skip the bytes no match of a rule can start with */
+static inline uint32_t
+first_skip(const struct swregex_prog *prog, const uint8_t *data,
+		uint32_t pos, uint32_t len)
+{
+	while (pos < len && !byte_set_has(&prog->first, data[pos]))
+		pos++;
+	return pos;
+}
+
+/* Whether the DFA of a rule matches in data */
+static bool
+dfa_match(const struct swregex_prog *prog, const uint8_t *data, uint32_t len)
+{
+	const uint16_t *dfa = prog->dfa;
+	const uint8_t *accept = prog->dfa_accept;
+	const uint8_t *class_map = prog->class_map;
+	const uint16_t nb_classes = prog->nb_classes;
+	uint32_t state = 1, i;
+
+	if (prog->end_anchored) {
+		for (i = 0; i < len && state != 0; i++)
+			state = dfa[state * nb_classes + class_map[data[i]]];
+		return accept[state];
+	}
+
+	for (i = 0; i < len; i++) {
+		/* the unanchored DFA loops on the start state until a
+		 * match may start
+		 */
+		if (state == 1 && !prog->anchored) {
+			i = first_skip(prog, data, i, len);
+			if (i == len)
+				break;
+		}
+		state = dfa[state * nb_classes + class_map[data[i]]];
+		if (accept[state])
+			return true;
+		if (state == 0)
+			return false;
+	}
+	return false;
+}
+
+/* Add the threads of the closure of state to list */
+static void
+nfa_add(const struct swregex_prog *prog, struct swregex_scratch *s,
+		struct swregex_thread *list, uint32_t *nb, uint16_t state,
+		uint32_t start)
+{
+	const struct swregex_nfa_state *st;
+	uint16_t *stack = s->stack;
+	uint32_t top = 0;
+
+	stack[top++] = state;
+	while (top > 0) {
+		state = stack[--top];
+		if (s->marks[state] == s->mark_gen)
+			continue;
+		s->marks[state] = s->mark_gen;
+		st = &prog->states[state];
+		switch (st->op) {
+		case SWREGEX_NFA_SPLIT:
+			stack[top++] = st->out1;
+			/* fall through */
+		case SWREGEX_NFA_JMP:
+			stack[top++] = st->out;
+			break;
+		default:
+			list[*nb].state = state;
+			list[*nb].start = start;
+			(*nb)++;
+			break;
+		}
+	}
+}
+
+/*
+ * Find the leftmost longest match of a rule from pos, with a Pike VM. The
+ * threads of a list are in increasing start order, so the thread of the
+ * earliest start reaching a state wins it.
+ */
+static bool
+nfa_search(const struct swregex_prog *prog, struct swregex_scratch *s,
+		const uint8_t *data, uint32_t len, uint32_t pos,
+		uint32_t *match_start, uint32_t *match_end)
+{
+	struct swregex_thread *clist = s->threads;
+	struct swregex_thread *nlist = s->threads + s->nb_states;
+	struct swregex_thread *tmp;
+	const struct swregex_nfa_state *st;
+	uint32_t nc = 0, nn, p, i;
+	bool found = false;
+
+	if (!prog->anchored)
+		pos = first_skip(prog, data, pos, len);
+	mark_gen_next(s);
+	nfa_add(prog, s, clist, &nc, prog->start, pos);
+
+	for (p = pos; nc > 0; p++) {
+		nn = 0;
+		mark_gen_next(s);
+		for (i = 0; i < nc; i++) {
+			if (found && clist[i].start > *match_start)
+				break;
+			st = &prog->states[clist[i].state];
+			if (st->op == SWREGEX_NFA_MATCH) {
+				if (prog->end_anchored && p != len)
+					continue;
+				if (!found || clist[i].start < *match_start ||
+						p > *match_end) {
+					*match_start = clist[i].start;
+					*match_end = p;
+					found = true;
+				}
+				continue;
+			}
+			if (p < len && byte_set_has(&prog->sets[st->set],
+					data[p]))
+				nfa_add(prog, s, nlist, &nn, st->out,
+						clist[i].start);
+		}
+		if (p == len)
+			break;
+		if (!found && !prog->anchored) {
+			/* no thread left, restart where a match may */
+			if (nn == 0) {
+				p = first_skip(prog, data, p + 1, len) - 1;
+				if (p + 1 == len)
+					break;
+			}
+			nfa_add(prog, s, nlist, &nn, prog->start, p + 1);
+		}
+		tmp = clist;
+		clist = nlist;
+		nlist = tmp;
+		nc = nn;
+	}
+
+	return found;
+}
+
+static void
+prog_scan(const struct swregex_prog *prog, struct swregex_scratch *s,
+		struct swregex_match_ctx *ctx, const uint8_t *data,
+		uint32_t len)
+{
+	uint32_t pos = 0, start = 0, end = 0;
+
+	while (!ctx->stop && pos < len) {
+		if (prog->dfa != NULL && !dfa_match(prog, data + pos, len - pos))
+			break;
+		if (!nfa_search(prog, s, data, len, pos, &start, &end))
+			break;
+		match_add(ctx, prog, start, end);
+		if (prog->anchored)
+			break;
+		pos = end;
+	}
+}
+
+static inline bool
+literal_verify(const struct swregex_literal *lit, const uint8_t *data,
+		uint32_t avail)
+{
+	uint16_t i;
+
+	if (lit->len > avail)
+		return false;
+	if (!lit->caseless)
+		return memcmp(lit->str, data, lit->len) == 0;
+	for (i = 0; i < lit->len; i++)
+		if (lit->str[i] != tolower(data[i]))
+			return false;
+	return true;
+}
+
+/*
+ * Verify the literals of the buckets hit at pos. Return the number of
+ * candidate rules.
+ */
+static uint32_t
+prefilter_verify(const struct swregex_db *db, struct swregex_scratch *s,
+		struct swregex_match_ctx *ctx, const uint8_t *data,
+		uint32_t len, uint32_t pos, uint8_t buckets, uint32_t nb_cand)
+{
+	const struct swregex_prefilter *pf = &db->pf;
+	const struct swregex_literal *lit;
+	const struct swregex_prog *prog;
+	struct swregex_rule_state *rs;
+	unsigned int b;
+	uint32_t i;
+
+	while (buckets != 0 && !ctx->stop) {
+		b = __builtin_ctz(buckets);
+		buckets &= buckets - 1;
+		for (i = pf->bucket_start[b]; i < pf->bucket_start[b + 1]; i++) {
+			lit = &pf->lits[pf->bucket_lits[i]];
+			prog = &db->progs[lit->prog];
+			rs = &s->rules[lit->prog];
+			if (!prog->literal_only && rs->gen == s->gen)
+				continue; /* already a candidate */
+			if (!group_match(ctx, prog->group_id) ||
+					!literal_verify(lit, data + pos,
+						len - pos))
+				continue;
+			if (rs->gen != s->gen) {
+				rs->gen = s->gen;
+				rs->last_end = 0;
+				if (!prog->literal_only) {
+					s->cand[nb_cand++] = lit->prog;
+					continue;
+				}
+			}
+			if (pos < rs->last_end)
+				continue; /* overlaps the previous match */
+			rs->last_end = pos + lit->len;
+			match_add(ctx, prog, pos, pos + lit->len);
+			if (ctx->stop)
+				break;
+		}
+	}
+	return nb_cand;
+}
+
+static inline uint8_t
+prefilter_buckets(const struct swregex_prefilter *pf, const uint8_t *data)
+{
+	uint8_t buckets = 0xff;
+	unsigned int k;
+
+	for (k = 0; k < pf->nb_masks; k++)
+		buckets &= pf->lo[k][data[k] & 0xf] & pf->hi[k][data[k] >> 4];
+	return buckets;
+}
+
+/*
+ * Find the positions where the first bytes of a literal may start, 16 at
+ * a time with the masks as byte shuffle tables, as in the Teddy algorithm.
+ */
+static uint32_t
+prefilter_scan(const struct swregex_db *db, struct swregex_scratch *s,
+		struct swregex_match_ctx *ctx, const uint8_t *data,
+		uint32_t len)
+{
+	const struct swregex_prefilter *pf = &db->pf;
+	uint32_t pos = 0, nb_cand = 0;
+	uint8_t buckets;
+
+	if (pf->nb_lits == 0 || len < pf->min_len)
+		return 0;
+
+#if defined(RTE_ARCH_X86) && defined(__SSSE3__)
+	{
+		const __m128i nibble = _mm_set1_epi8(0xf);
+		const __m128i zero = _mm_setzero_si128();
+		__m128i v, lo, hi, res;
+		uint8_t res_bytes[16];
+		uint32_t mask;
+		unsigned int k;
+
+		for (; pos + 16 + pf->nb_masks - 1 <= len && !ctx->stop;
+				pos += 16) {
+			res = _mm_set1_epi8(-1);
+			for (k = 0; k < pf->nb_masks; k++) {
+				v = _mm_loadu_si128((const __m128i *)
+						(data + pos + k));
+				lo = _mm_and_si128(v, nibble);
+				hi = _mm_and_si128(_mm_srli_epi16(v, 4),
+						nibble);
+				res = _mm_and_si128(res, _mm_and_si128(
+					_mm_shuffle_epi8(_mm_load_si128(
+						(const __m128i *)pf->lo[k]),
+						lo),
+					_mm_shuffle_epi8(_mm_load_si128(
+						(const __m128i *)pf->hi[k]),
+						hi)));
+			}
+			mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(res, zero)) &
+				0xffff;
+			if (mask == 0)
+				continue;
+			_mm_storeu_si128((__m128i *)res_bytes, res);
+			while (mask != 0 && !ctx->stop) {
+				k = __builtin_ctz(mask);
+				mask &= mask - 1;
+				nb_cand = prefilter_verify(db, s, ctx, data,
+						len, pos + k, res_bytes[k],
+						nb_cand);
+			}
+		}
+	}
+#elif defined(RTE_ARCH_ARM64)
+	{
+		const uint8x16_t nibble = vdupq_n_u8(0xf);
+		uint8x16_t v, res;
+		uint8_t res_bytes[16];
+		unsigned int k;
+
+		for (; pos + 16 + pf->nb_masks - 1 <= len && !ctx->stop;
+				pos += 16) {
+			res = vdupq_n_u8(0xff);
+			for (k = 0; k < pf->nb_masks; k++) {
+				v = vld1q_u8(data + pos + k);
+				res = vandq_u8(res, vandq_u8(
+					vqtbl1q_u8(vld1q_u8(pf->lo[k]),
+						vandq_u8(v, nibble)),
+					vqtbl1q_u8(vld1q_u8(pf->hi[k]),
+						vshrq_n_u8(v, 4))));
+			}
+			if (vmaxvq_u8(res) == 0)
+				continue;
+			vst1q_u8(res_bytes, res);
+			for (k = 0; k < 16 && !ctx->stop; k++)
+				if (res_bytes[k] != 0)
+					nb_cand = prefilter_verify(db, s, ctx,
+						data, len, pos + k,
+						res_bytes[k], nb_cand);
+		}
+	}
+#endif
+
+	for (; pos + pf->min_len <= len && !ctx->stop; pos++) {
+		buckets = prefilter_buckets(pf, data + pos);
+		if (buckets != 0)
+			nb_cand = prefilter_verify(db, s, ctx, data, len, pos,
+					buckets, nb_cand);
+	}
+	return nb_cand;
+}
+
+void
+swregex_scan(const struct swregex_priv *priv, struct swregex_scratch *s,
+		struct rte_regex_ops *op)
+{
+	const struct swregex_db *db = priv->db;
+	const struct swregex_prog *prog;
+	struct swregex_match_ctx ctx;
+	const uint8_t *data;
+	uint32_t len, nb_cand, i;
+
+	op->rsp_flags = 0;
+	op->nb_actual_matches = 0;
+	op->nb_matches = 0;
+	if (db == NULL || db->nb_progs == 0)
+		return;
+
+	len = rte_pktmbuf_pkt_len(op->mbuf);
+	if (len > SWREGEX_MAX_PAYLOAD) {
+		op->rsp_flags |= RTE_REGEX_OPS_RSP_RESOURCE_LIMIT_REACHED_F;
+		return;
+	}
+	data = rte_pktmbuf_read(op->mbuf, 0, len, s->buf);
+	if (data == NULL)
+		return;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.op = op;
+	ctx.max_matches = priv->nb_max_matches;
+	ctx.match_as_end = priv->match_as_end;
+	ctx.stop_on_match = !!(op->req_flags &
+			RTE_REGEX_OPS_REQ_STOP_ON_MATCH_F);
+	ctx.high_priority = !!(op->req_flags &
+			RTE_REGEX_OPS_REQ_MATCH_HIGH_PRIORITY_F);
+	if (op->req_flags & RTE_REGEX_OPS_REQ_GROUP_ID0_VALID_F)
+		ctx.groups[ctx.nb_groups++] = op->group_id0;
+	if (op->req_flags & RTE_REGEX_OPS_REQ_GROUP_ID1_VALID_F)
+		ctx.groups[ctx.nb_groups++] = op->group_id1;
+	if (op->req_flags & RTE_REGEX_OPS_REQ_GROUP_ID2_VALID_F)
+		ctx.groups[ctx.nb_groups++] = op->group_id2;
+	if (op->req_flags & RTE_REGEX_OPS_REQ_GROUP_ID3_VALID_F)
+		ctx.groups[ctx.nb_groups++] = op->group_id3;
+
+	if (++s->gen == 0) {
+		memset(s->rules, 0, sizeof(*s->rules) * s->nb_rules);
+		s->gen = 1;
+	}
+
+	nb_cand = prefilter_scan(db, s, &ctx, data, len);
+	for (i = 0; i < nb_cand && !ctx.stop; i++)
+		prog_scan(&db->progs[s->cand[i]], s, &ctx, data, len);
+	for (i = 0; i < db->nb_nolit && !ctx.stop; i++) {
+		prog = &db->progs[db->nolit[i]];
+		if (group_match(&ctx, prog->group_id))
+			prog_scan(prog, s, &ctx, data, len);
+	}
+}
+
+void
+swregex_scratch_free(struct swregex_scratch *s)
+{
+	rte_free(s->buf);
+	rte_free(s->threads);
+	rte_free(s->stack);
+	rte_free(s->marks);
+	rte_free(s->rules);
+	rte_free(s->cand);
+	memset(s, 0, sizeof(*s));
+}
+
+/* Size the scratch for the scans of a rule database */
+int
+swregex_scratch_setup(struct swregex_scratch *s, const struct swregex_db *db,
+		int socket_id)
+{
+	uint32_t nb_rules = db != NULL ? db->nb_progs : 0;
+	uint16_t nb_states = db != NULL ? db->max_nfa_states : 0;
+
+	if (s->buf == NULL) {
+		s->buf = rte_malloc_socket("swregex scratch",
+				SWREGEX_MAX_PAYLOAD, 0, socket_id);
+		if (s->buf == NULL)
+			return -ENOMEM;
+	}
+
+	if (nb_states > s->nb_states) {
+		rte_free(s->threads);
+		rte_free(s->stack);
+		rte_free(s->marks);
+		s->threads = rte_malloc_socket("swregex scratch",
+				sizeof(*s->threads) * nb_states * 2, 0,
+				socket_id);
+		s->stack = rte_malloc_socket("swregex scratch",
+				sizeof(*s->stack) * (nb_states * 2 + 1), 0,
+				socket_id);
+		s->marks = rte_zmalloc_socket("swregex scratch",
+				sizeof(*s->marks) * nb_states, 0, socket_id);
+		s->mark_gen = 0;
+		s->nb_states = 0;
+		if (s->threads == NULL || s->stack == NULL || s->marks == NULL)
+			return -ENOMEM;
+		s->nb_states = nb_states;
+	}
+
+	if (nb_rules > s->nb_rules) {
+		rte_free(s->rules);
+		rte_free(s->cand);
+		s->rules = rte_zmalloc_socket("swregex scratch",
+				sizeof(*s->rules) * nb_rules, 0, socket_id);
+		s->cand = rte_malloc_socket("swregex scratch",
+				sizeof(*s->cand) * nb_rules, 0, socket_id);
+		s->gen = 0;
+		s->nb_rules = 0;
+		if (s->rules == NULL || s->cand == NULL)
+			return -ENOMEM;
+		s->nb_rules = nb_rules;
+	}
+
+	return 0;
+}
@@ -0,0 +1,866 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_kvargs.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_pause.h>
+
+#include <rte_regexdev_driver.h>
+
+#include "sw_regexdev.h"
+
+RTE_LOG_REGISTER_DEFAULT(swregex_logtype, INFO);
+
+static void
+swregex_rule_set_free(struct swregex_rule_set *set)
+{
+	uint32_t i;
+
+	for (i = 0; i < set->nb_rules; i++)
+		rte_free(set->rules[i].pcre);
+	rte_free(set->rules);
+	set->rules = NULL;
+	set->nb_rules = 0;
+}
+
+static int
+swregex_rule_set_find(const struct swregex_rule_set *set, uint32_t rule_id,
+		      uint16_t group_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < set->nb_rules; i++)
+		if (set->rules[i].rule_id == rule_id &&
+		    set->rules[i].group_id == group_id)
+			return i;
+
+	return -1;
+}
+
+/* Check that a rule compiles, before adding it to a rule set */
+static int
+swregex_rule_check(const struct swregex_rule *rule, int socket_id)
+{
+	struct swregex_literal lit;
+	struct swregex_prog prog;
+	int ret;
+
+	if (rule->rule_id > SWREGEX_MAX_RULE_ID ||
+	    rule->group_id >= SWREGEX_MAX_GROUPS || rule->pcre_len == 0)
+		return -EINVAL;
+	if (rule->flags & ~SWREGEX_RULE_FLAGS)
+		return -ENOTSUP;
+
+	ret = swregex_prog_compile(rule, &prog, &lit, socket_id);
+	if (ret < 0)
+		return ret;
+	swregex_prog_free(&prog);
+	rte_free(lit.str);
+
+	return 0;
+}
+
+/* Add a rule, or replace the rule of the same id in the same group */
+static int
+swregex_rule_set_add(struct swregex_rule_set *set, uint32_t rule_id,
+		     uint16_t group_id, uint64_t flags, const char *pcre,
+		     uint16_t pcre_len, int socket_id)
+{
+	struct swregex_rule rule = {
+		.rule_id = rule_id,
+		.group_id = group_id,
+		.flags = flags,
+		.pcre = (char *)(uintptr_t)pcre,
+		.pcre_len = pcre_len,
+	};
+	struct swregex_rule *rules;
+	int idx, ret;
+
+	ret = swregex_rule_check(&rule, socket_id);
+	if (ret < 0)
+		return ret;
+
+	rule.pcre = rte_malloc_socket("swregex rule", pcre_len, 0, socket_id);
+	if (rule.pcre == NULL)
+		return -ENOMEM;
+	memcpy(rule.pcre, pcre, pcre_len);
+
+	idx = swregex_rule_set_find(set, rule_id, group_id);
+	if (idx >= 0) {
+		rte_free(set->rules[idx].pcre);
+		set->rules[idx] = rule;
+		return 0;
+	}
+
+	if (set->nb_rules == SWREGEX_MAX_RULES) {
+		rte_free(rule.pcre);
+		return -ENOSPC;
+	}
+	if (rte_is_power_of_2(set->nb_rules) || set->nb_rules == 0) {
+		rules = rte_realloc_socket(set->rules, sizeof(*rules) *
+				RTE_MAX(set->nb_rules * 2, 16u), 0, socket_id);
+		if (rules == NULL) {
+			rte_free(rule.pcre);
+			return -ENOMEM;
+		}
+		set->rules = rules;
+	}
+	set->rules[set->nb_rules++] = rule;
+
+	return 0;
+}
+
+static int
+swregex_rule_set_remove(struct swregex_rule_set *set, uint32_t rule_id,
+			uint16_t group_id)
+{
+	int idx = swregex_rule_set_find(set, rule_id, group_id);
+
+	if (idx < 0)
+		return -EINVAL;
+
+	rte_free(set->rules[idx].pcre);
+	memmove(&set->rules[idx], &set->rules[idx + 1],
+		sizeof(*set->rules) * (set->nb_rules - idx - 1));
+	set->nb_rules--;
+
+	return 0;
+}
+
+/* Compile a rule set, and make it the rule database of the scans */
+static int
+swregex_db_activate(struct swregex_priv *priv,
+		    const struct swregex_rule_set *set)
+{
+	struct swregex_db *db;
+	uint16_t i;
+	int ret;
+
+	ret = swregex_db_compile(set, &db, priv->socket_id);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < priv->nb_qps; i++) {
+		if (priv->qps[i] == NULL)
+			continue;
+		ret = swregex_scratch_setup(&priv->qps[i]->scratch, db,
+					    priv->socket_id);
+		if (ret < 0) {
+			SWREGEX_LOG(ERR, "Cannot allocate qp %u scratch", i);
+			swregex_db_free(db);
+			return ret;
+		}
+	}
+
+	swregex_db_free(priv->db);
+	priv->db = db;
+
+	return 0;
+}
+
+/*
+ * Parse a line of a text rule database:
+ *	rule_id[,group_id]:/pattern/[flags]
+ * Flags are 'i' (caseless), 's' (dotall) and 'A' (anchored). Return 1 for a
+ * rule, 0 for an empty line or a comment.
+ */
+static int
+swregex_rule_parse(char *line, struct swregex_rule *rule)
+{
+	unsigned long id, group_id = 0;
+	char *p = line, *end, *last;
+
+	while (isspace(*p))
+		p++;
+	if (*p == '\0' || *p == '#')
+		return 0;
+
+	id = strtoul(p, &end, 0);
+	if (end == p || id > SWREGEX_MAX_RULE_ID)
+		return -EINVAL;
+	p = end;
+	if (*p == ',') {
+		group_id = strtoul(++p, &end, 0);
+		if (end == p || group_id >= SWREGEX_MAX_GROUPS)
+			return -EINVAL;
+		p = end;
+	}
+	if (p[0] != ':' || p[1] != '/')
+		return -EINVAL;
+	p += 2;
+	last = strrchr(p, '/');
+	if (last == NULL || last == p || last - p > UINT16_MAX)
+		return -EINVAL;
+
+	rule->rule_id = id;
+	rule->group_id = group_id;
+	rule->pcre = p;
+	rule->pcre_len = last - p;
+	rule->flags = 0;
+	for (p = last + 1; *p != '\0' && !isspace(*p); p++) {
+		switch (*p) {
+		case 'i':
+			rule->flags |= RTE_REGEX_PCRE_RULE_CASELESS_F;
+			break;
+		case 's':
+			rule->flags |= RTE_REGEX_PCRE_RULE_DOTALL_F;
+			break;
+		case 'A':
+			rule->flags |= RTE_REGEX_PCRE_RULE_ANCHORED_F;
+			break;
+		default:
+			return -ENOTSUP;
+		}
+	}
+
+	return 1;
+}
+
+static int
+swregex_info_get(struct rte_regexdev *dev, struct rte_regexdev_info *info)
+{
+	info->driver_name = dev->device->driver->name;
+	info->dev = dev->device;
+	info->max_matches = SWREGEX_MAX_MATCHES;
+	info->max_queue_pairs = SWREGEX_MAX_QPS;
+	info->max_payload_size = SWREGEX_MAX_PAYLOAD;
+	info->max_rules_per_group = SWREGEX_MAX_RULES;
+	info->max_groups = SWREGEX_MAX_GROUPS;
+	info->regexdev_capa = RTE_REGEXDEV_CAPA_RUNTIME_COMPILATION_F |
+			      RTE_REGEXDEV_CAPA_SUPP_PCRE_START_ANCHOR_F |
+			      RTE_REGEXDEV_SUPP_PCRE_GREEDY_F |
+			      RTE_REGEXDEV_SUPP_MATCH_AS_END_F;
+	info->rule_flags = SWREGEX_RULE_FLAGS;
+
+	return 0;
+}
+
+static int
+swregex_rule_db_import(struct rte_regexdev *dev, const char *rule_db,
+		       uint32_t rule_db_len)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	struct swregex_rule_set set = { 0 };
+	struct swregex_rule rule;
+	const char *p = rule_db, *end = rule_db + rule_db_len, *eol;
+	unsigned int line_nb = 0;
+	char *line;
+	int ret = 0;
+
+	if (priv->started) {
+		SWREGEX_LOG(ERR, "Device must be stopped to import rules");
+		return -EBUSY;
+	}
+
+	while (p < end && *p != '\0') {
+		eol = memchr(p, '\n', end - p);
+		if (eol == NULL)
+			eol = end;
+		line_nb++;
+
+		line = strndup(p, eol - p);
+		if (line == NULL) {
+			ret = -ENOMEM;
+			break;
+		}
+		ret = swregex_rule_parse(line, &rule);
+		if (ret > 0)
+			ret = swregex_rule_set_add(&set, rule.rule_id,
+					rule.group_id, rule.flags, rule.pcre,
+					rule.pcre_len, priv->socket_id);
+		free(line);
+		if (ret < 0) {
+			SWREGEX_LOG(ERR, "Invalid rule at line %u: %s",
+				    line_nb, strerror(-ret));
+			break;
+		}
+		p = eol + 1;
+	}
+
+	if (ret == 0)
+		ret = swregex_db_activate(priv, &set);
+	if (ret < 0) {
+		swregex_rule_set_free(&set);
+		return ret;
+	}
+
+	swregex_rule_set_free(&priv->rules);
+	priv->rules = set;
+
+	return 0;
+}
+
+static int
+swregex_rule_format(const struct swregex_rule *rule, char *buf, size_t size)
+{
+	return snprintf(buf, size, "%u,%u:/%.*s/%s%s%s\n", rule->rule_id,
+			rule->group_id, rule->pcre_len, rule->pcre,
+			(rule->flags & RTE_REGEX_PCRE_RULE_CASELESS_F) ?
+			"i" : "",
+			(rule->flags & RTE_REGEX_PCRE_RULE_DOTALL_F) ? "s" : "",
+			(rule->flags & RTE_REGEX_PCRE_RULE_ANCHORED_F) ?
+			"A" : "");
+}
+
+/* Export the rule set in the text format of import */
+static int
+swregex_rule_db_export(struct rte_regexdev *dev, char *rule_db)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	size_t size = 1, len = 0;
+	uint32_t i;
+
+	/* with the terminating null byte */
+	for (i = 0; i < priv->rules.nb_rules; i++)
+		size += swregex_rule_format(&priv->rules.rules[i], NULL, 0);
+	if (rule_db == NULL)
+		return size;
+
+	rule_db[0] = '\0';
+	for (i = 0; i < priv->rules.nb_rules; i++)
+		len += swregex_rule_format(&priv->rules.rules[i],
+					   rule_db + len, size - len);
+
+	return 0;
+}
+
+static int
+swregex_rule_db_update(struct rte_regexdev *dev,
+		       const struct rte_regexdev_rule *rules,
+		       uint16_t nb_rules)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	const struct rte_regexdev_rule *rule;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < nb_rules; i++) {
+		rule = &rules[i];
+		if (rule->op == RTE_REGEX_RULE_OP_ADD)
+			ret = swregex_rule_set_add(&priv->rules,
+					rule->rule_id, rule->group_id,
+					rule->rule_flags, rule->pcre_rule,
+					rule->pcre_rule_len, priv->socket_id);
+		else if (rule->op == RTE_REGEX_RULE_OP_REMOVE)
+			ret = swregex_rule_set_remove(&priv->rules,
+					rule->rule_id, rule->group_id);
+		else
+			ret = -EINVAL;
+		if (ret < 0) {
+			SWREGEX_LOG(ERR, "Cannot update rule %u: %s",
+				    rule->rule_id, strerror(-ret));
+			rte_errno = -ret;
+			break;
+		}
+	}
+
+	return i;
+}
+
+static int
+swregex_rule_db_compile_activate(struct rte_regexdev *dev)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+
+	if (priv->started) {
+		SWREGEX_LOG(ERR, "Device must be stopped to activate rules");
+		return -EBUSY;
+	}
+
+	return swregex_db_activate(priv, &priv->rules);
+}
+
+static void
+swregex_qp_release(struct swregex_priv *priv, uint16_t qp_id)
+{
+	struct swregex_qp *qp = priv->qps[qp_id];
+
+	if (qp == NULL)
+		return;
+
+	rte_ring_free(qp->req_ring);
+	rte_ring_free(qp->cpl_ring);
+	swregex_scratch_free(&qp->scratch);
+	rte_free(qp);
+	priv->qps[qp_id] = NULL;
+}
+
+static int
+swregex_configure(struct rte_regexdev *dev,
+		  const struct rte_regexdev_config *cfg)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	uint16_t i;
+
+	for (i = cfg->nb_queue_pairs; i < priv->nb_qps; i++)
+		swregex_qp_release(priv, i);
+
+	priv->nb_qps = cfg->nb_queue_pairs;
+	priv->nb_max_matches = cfg->nb_max_matches;
+	priv->match_as_end =
+		!!(cfg->dev_cfg_flags & RTE_REGEXDEV_CFG_MATCH_AS_END_F);
+
+	if (cfg->rule_db != NULL)
+		return swregex_rule_db_import(dev, cfg->rule_db,
+					      cfg->rule_db_len);
+
+	return 0;
+}
+
+static struct rte_ring *
+swregex_qp_create_ring(struct rte_regexdev *dev, uint16_t qp_id,
+		       const char *type, uint16_t size, int socket_id)
+{
+	char name[RTE_RING_NAMESIZE];
+
+	if (snprintf(name, sizeof(name), "swregex_%u_%u_%s",
+		     dev->data->dev_id, qp_id, type) >= (int)sizeof(name))
+		return NULL;
+
+	return rte_ring_create(name, size, socket_id,
+			       RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+}
+
+/*
+ * Setup a queue pair. Since at most nb_desc ops of the queue pair are in
+ * flight, its rings cannot overflow.
+ */
+static int
+swregex_qp_setup(struct rte_regexdev *dev, uint16_t qp_id,
+		 const struct rte_regexdev_qp_conf *qp_conf)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	struct swregex_qp *qp;
+
+	if (qp_conf->nb_desc == 0) {
+		SWREGEX_LOG(ERR, "Invalid number of descriptors");
+		return -EINVAL;
+	}
+
+	swregex_qp_release(priv, qp_id);
+
+	qp = rte_zmalloc_socket("swregex qp", sizeof(*qp),
+				RTE_CACHE_LINE_SIZE, priv->socket_id);
+	if (qp == NULL) {
+		SWREGEX_LOG(ERR, "Cannot allocate qp %u", qp_id);
+		return -ENOMEM;
+	}
+	qp->nb_desc = qp_conf->nb_desc;
+	qp->cb = qp_conf->cb;
+
+	qp->req_ring = swregex_qp_create_ring(dev, qp_id, "req",
+					      qp->nb_desc, priv->socket_id);
+	qp->cpl_ring = swregex_qp_create_ring(dev, qp_id, "cpl",
+					      qp->nb_desc, priv->socket_id);
+	if (qp->req_ring == NULL || qp->cpl_ring == NULL ||
+	    swregex_scratch_setup(&qp->scratch, priv->db,
+				  priv->socket_id) < 0) {
+		SWREGEX_LOG(ERR, "Cannot allocate qp %u", qp_id);
+		priv->qps[qp_id] = qp;
+		swregex_qp_release(priv, qp_id);
+		return -ENOMEM;
+	}
+
+	priv->qps[qp_id] = qp;
+
+	return 0;
+}
+
+/* Scan in the enqueue call, without worker lcore or before start */
+static uint16_t
+swregex_enqueue_inline(struct rte_regexdev *dev, uint16_t qp_id,
+		       struct rte_regex_ops **ops, uint16_t nb_ops)
+{
+	const struct swregex_priv *priv = dev->data->dev_private;
+	struct swregex_qp *qp = priv->qps[qp_id];
+	uint16_t n, i;
+
+	n = RTE_MIN(nb_ops, qp->nb_desc - (qp->enqueued - qp->dequeued));
+	for (i = 0; i < n; i++)
+		swregex_scan(priv, &qp->scratch, ops[i]);
+
+	n = rte_ring_enqueue_burst(qp->cpl_ring, (void **)ops, n, NULL);
+	qp->enqueued += n;
+
+	return n;
+}
+
+static uint16_t
+swregex_enqueue_worker(struct rte_regexdev *dev, uint16_t qp_id,
+		       struct rte_regex_ops **ops, uint16_t nb_ops)
+{
+	const struct swregex_priv *priv = dev->data->dev_private;
+	struct swregex_qp *qp = priv->qps[qp_id];
+	uint16_t n;
+
+	n = RTE_MIN(nb_ops, qp->nb_desc - (qp->enqueued - qp->dequeued));
+	n = rte_ring_enqueue_burst(qp->req_ring, (void **)ops, n, NULL);
+	qp->enqueued += n;
+
+	return n;
+}
+
+static uint16_t
+swregex_dequeue(struct rte_regexdev *dev, uint16_t qp_id,
+		struct rte_regex_ops **ops, uint16_t nb_ops)
+{
+	const struct swregex_priv *priv = dev->data->dev_private;
+	struct swregex_qp *qp = priv->qps[qp_id];
+	uint16_t n;
+
+	n = rte_ring_dequeue_burst(qp->cpl_ring, (void **)ops, nb_ops, NULL);
+	qp->dequeued += n;
+
+	return n;
+}
+
+/*
+ * A worker lcore serves the queue pairs of its index modulo the number of
+ * worker lcores, so that the ops of a queue pair complete in order.
+ */
+static int
+swregex_lcore_main(void *arg)
+{
+	const struct swregex_worker *worker = arg;
+	struct swregex_priv *priv = worker->priv;
+	struct rte_regex_ops *ops[SWREGEX_WORKER_BURST];
+	struct swregex_qp *qp;
+	uint16_t qp_id, n, i;
+	uint32_t done;
+
+	while (!__atomic_load_n(&priv->lcore_exit, __ATOMIC_RELAXED)) {
+		done = 0;
+		for (qp_id = worker->idx; qp_id < priv->nb_qps;
+		     qp_id += priv->nb_lcores) {
+			qp = priv->qps[qp_id];
+			n = rte_ring_dequeue_burst(qp->req_ring, (void **)ops,
+						   SWREGEX_WORKER_BURST, NULL);
+			for (i = 0; i < n; i++)
+				swregex_scan(priv, &qp->scratch, ops[i]);
+			rte_ring_enqueue_burst(qp->cpl_ring, (void **)ops, n,
+					       NULL);
+			done += n;
+		}
+		if (done == 0)
+			rte_pause();
+	}
+
+	return 0;
+}
+
+static void
+swregex_lcores_stop(struct swregex_priv *priv, uint16_t nb_lcores)
+{
+	uint16_t i;
+
+	__atomic_store_n(&priv->lcore_exit, true, __ATOMIC_RELAXED);
+	for (i = 0; i < nb_lcores; i++)
+		rte_eal_wait_lcore(priv->lcores[i]);
+}
+
+static int
+swregex_start(struct rte_regexdev *dev)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < priv->nb_qps; i++) {
+		if (priv->qps[i] == NULL) {
+			SWREGEX_LOG(ERR, "Queue pair %u was not setup", i);
+			return -EINVAL;
+		}
+	}
+
+	priv->lcore_exit = false;
+	for (i = 0; i < priv->nb_lcores; i++) {
+		ret = rte_eal_remote_launch(swregex_lcore_main,
+					    &priv->workers[i],
+					    priv->lcores[i]);
+		if (ret != 0) {
+			SWREGEX_LOG(ERR, "Cannot launch worker on lcore %u",
+				    priv->lcores[i]);
+			swregex_lcores_stop(priv, i);
+			return ret;
+		}
+	}
+
+	if (priv->nb_lcores != 0)
+		dev->enqueue = swregex_enqueue_worker;
+	priv->started = true;
+
+	return 0;
+}
+
+/* Stop the worker lcores, and flush the ops in flight */
+static int
+swregex_stop(struct rte_regexdev *dev)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	struct rte_regex_ops *op;
+	struct swregex_qp *qp;
+	uint16_t i;
+
+	if (!priv->started)
+		return 0;
+
+	swregex_lcores_stop(priv, priv->nb_lcores);
+	dev->enqueue = swregex_enqueue_inline;
+	priv->started = false;
+
+	for (i = 0; i < priv->nb_qps; i++) {
+		qp = priv->qps[i];
+		while (rte_ring_dequeue(qp->cpl_ring, (void **)&op) == 0 ||
+		       rte_ring_dequeue(qp->req_ring, (void **)&op) == 0)
+			if (qp->cb != NULL)
+				qp->cb(dev->data->dev_id, i, op);
+		qp->enqueued = 0;
+		qp->dequeued = 0;
+	}
+
+	return 0;
+}
+
+static int
+swregex_close(struct rte_regexdev *dev)
+{
+	struct swregex_priv *priv = dev->data->dev_private;
+	uint16_t i;
+
+	swregex_stop(dev);
+
+	for (i = 0; i < SWREGEX_MAX_QPS; i++)
+		swregex_qp_release(priv, i);
+	priv->nb_qps = 0;
+
+	swregex_db_free(priv->db);
+	priv->db = NULL;
+	swregex_rule_set_free(&priv->rules);
+
+	return 0;
+}
+
+static int
+swregex_dump(struct rte_regexdev *dev, FILE *f)
+{
+	const struct swregex_priv *priv = dev->data->dev_private;
+	const struct swregex_db *db = priv->db;
+	const struct swregex_qp *qp;
+	uint16_t i;
+
+	(void)fprintf(f,
+		"    socket_id: %d\n"
+		"    rules: %u\n",
+		priv->socket_id, priv->rules.nb_rules);
+	for (i = 0; i < priv->nb_lcores; i++)
+		(void)fprintf(f, "    worker_lcore: %u\n", priv->lcores[i]);
+
+	if (db != NULL)
+		(void)fprintf(f,
+			"    active rules: %u\n"
+			"      literals: %u\n"
+			"      literal only rules: %u\n"
+			"      rules without literal: %u\n"
+			"      rules with DFA: %u\n"
+			"      max NFA states: %u\n",
+			db->nb_progs, db->pf.nb_lits, db->nb_literal_only,
+			db->nb_nolit, db->nb_dfa, db->max_nfa_states);
+
+	for (i = 0; i < priv->nb_qps; i++) {
+		qp = priv->qps[i];
+		if (qp == NULL)
+			continue;
+		(void)fprintf(f,
+			"    qp %u:\n"
+			"      nb_desc: %u\n"
+			"      enqueued_count: %" PRIu64 "\n"
+			"      dequeued_count: %" PRIu64 "\n",
+			i, qp->nb_desc, qp->enqueued, qp->dequeued);
+	}
+
+	return 0;
+}
+
+static const struct rte_regexdev_ops swregex_ops = {
+	.dev_info_get = swregex_info_get,
+	.dev_configure = swregex_configure,
+	.dev_qp_setup = swregex_qp_setup,
+	.dev_start = swregex_start,
+	.dev_stop = swregex_stop,
+	.dev_close = swregex_close,
+	.dev_rule_db_update = swregex_rule_db_update,
+	.dev_rule_db_compile_activate = swregex_rule_db_compile_activate,
+	.dev_db_import = swregex_rule_db_import,
+	.dev_db_export = swregex_rule_db_export,
+	.dev_dump = swregex_dump,
+};
+
+static int
+swregex_create(const char *name, struct rte_vdev_device *vdev,
+	       const struct swregex_priv *args)
+{
+	struct rte_regexdev *dev;
+	struct swregex_priv *priv;
+	int socket_id;
+	uint16_t i;
+
+	socket_id = (args->nb_lcores == 0) ? rte_socket_id() :
+		rte_lcore_to_socket_id(args->lcores[0]);
+	priv = rte_zmalloc_socket("swregex priv", sizeof(*priv),
+				  RTE_CACHE_LINE_SIZE, socket_id);
+	if (priv == NULL) {
+		SWREGEX_LOG(ERR, "Cannot allocate %s private data", name);
+		return -ENOMEM;
+	}
+
+	dev = rte_regexdev_register(name);
+	if (dev == NULL) {
+		SWREGEX_LOG(ERR, "Unable to register regexdev: %s", name);
+		rte_free(priv);
+		return -EINVAL;
+	}
+
+	priv->dev = dev;
+	priv->socket_id = socket_id;
+	priv->nb_lcores = args->nb_lcores;
+	memcpy(priv->lcores, args->lcores, sizeof(priv->lcores));
+	for (i = 0; i < priv->nb_lcores; i++) {
+		priv->workers[i].priv = priv;
+		priv->workers[i].lcore_id = priv->lcores[i];
+		priv->workers[i].idx = i;
+	}
+
+	dev->device = &vdev->device;
+	dev->dev_ops = &swregex_ops;
+	dev->enqueue = swregex_enqueue_inline;
+	dev->dequeue = swregex_dequeue;
+	dev->data->dev_private = priv;
+	dev->state = RTE_REGEXDEV_READY;
+
+	return dev->data->dev_id;
+}
+
+static int
+swregex_parse_lcore(const char *key __rte_unused, const char *value,
+		    void *opaque)
+{
+	struct swregex_priv *args = opaque;
+	int lcore_id = atoi(value);
+	uint16_t i;
+
+	if (lcore_id < 0 || lcore_id >= RTE_MAX_LCORE ||
+	    !rte_lcore_is_enabled(lcore_id) ||
+	    (unsigned int)lcore_id == rte_get_main_lcore() ||
+	    args->nb_lcores == SWREGEX_MAX_LCORES)
+		return -EINVAL;
+
+	for (i = 0; i < args->nb_lcores; i++)
+		if (args->lcores[i] == (unsigned int)lcore_id)
+			return -EINVAL;
+
+	args->lcores[args->nb_lcores++] = lcore_id;
+
+	return 0;
+}
+
+static int
+swregex_parse_vdev_args(struct rte_vdev_device *vdev,
+			struct swregex_priv *args)
+{
+	static const char *const valid_args[] = {
+		SWREGEX_ARG_LCORE,
+		NULL
+	};
+
+	struct rte_kvargs *kvlist;
+	const char *params;
+	int ret;
+
+	params = rte_vdev_device_args(vdev);
+	if (params == NULL || params[0] == '\0')
+		return 0;
+
+	kvlist = rte_kvargs_parse(params, valid_args);
+	if (!kvlist)
+		return -EINVAL;
+
+	ret = rte_kvargs_process(kvlist, SWREGEX_ARG_LCORE,
+				 swregex_parse_lcore, args);
+	if (ret != 0)
+		SWREGEX_LOG(ERR, "Invalid %s", SWREGEX_ARG_LCORE);
+
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int
+swregex_probe(struct rte_vdev_device *vdev)
+{
+	struct swregex_priv args = { 0 };
+	const char *name;
+	int ret;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -EINVAL;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		SWREGEX_LOG(ERR, "Multiple process not supported for %s",
+			    name);
+		return -EINVAL;
+	}
+
+	ret = swregex_parse_vdev_args(vdev, &args);
+	if (ret != 0)
+		return ret;
+
+	ret = swregex_create(name, vdev, &args);
+	if (ret >= 0)
+		SWREGEX_LOG(INFO, "Create %s regexdev with %u worker lcore(s)",
+			    name, args.nb_lcores);
+
+	return ret < 0 ? ret : 0;
+}
+
+static int
+swregex_remove(struct rte_vdev_device *vdev)
+{
+	struct rte_regexdev *dev;
+	const char *name;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -EINVAL;
+
+	dev = rte_regexdev_get_device_by_name(name);
+	if (dev == NULL)
+		return -ENODEV;
+
+	swregex_close(dev);
+	rte_free(dev->data->dev_private);
+	dev->data->dev_private = NULL;
+	rte_regexdev_unregister(dev);
+	SWREGEX_LOG(INFO, "Remove %s regexdev", name);
+
+	return 0;
+}
+
+static struct rte_vdev_driver swregex_pmd_drv = {
+	.probe = swregex_probe,
+	.remove = swregex_remove,
+};
+
+RTE_PMD_REGISTER_VDEV(regex_sw, swregex_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(regex_sw,
+		SWREGEX_ARG_LCORE "=<uint16> ");
@@ -0,0 +1,239 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef SW_REGEXDEV_H
+#define SW_REGEXDEV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_regexdev.h>
+#include <rte_regexdev_core.h>
+#include <rte_ring.h>
+
+extern int swregex_logtype;
+#define SWREGEX_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, swregex_logtype, "%s(): " fmt "\n", \
+		__func__, ##args)
+
+#define SWREGEX_ARG_LCORE	"lcore"
+
+#define SWREGEX_MAX_LCORES	16
+#define SWREGEX_MAX_QPS		64
+#define SWREGEX_MAX_MATCHES	255
+#define SWREGEX_MAX_PAYLOAD	UINT16_MAX
+#define SWREGEX_MAX_RULES	65536
+/* Limits of the rule_id and group_id fields of a match */
+#define SWREGEX_MAX_RULE_ID	((1u << 20) - 1)
+#define SWREGEX_MAX_GROUPS	(1u << 12)
+
+/* Ops a worker lcore takes from a queue pair before moving to the next */
+#define SWREGEX_WORKER_BURST	32
+
+/* Budget of the automata of a rule. A rule whose DFA would need more
+ * states is matched with its NFA only.
+ */
+#define SWREGEX_MAX_NFA_STATES	4096
+#define SWREGEX_MAX_DFA_STATES	1024
+#define SWREGEX_MAX_REPEAT	1000
+
+/* The prefilter spreads the literals over 8 buckets, one bit each in
+ * the nibble masks, and looks up to 3 bytes of a literal per position.
+ */
+#define SWREGEX_PF_BUCKETS	8
+#define SWREGEX_PF_MASKS	3
+
+#define SWREGEX_RULE_FLAGS	(RTE_REGEX_PCRE_RULE_ANCHORED_F | \
+				 RTE_REGEX_PCRE_RULE_CASELESS_F | \
+				 RTE_REGEX_PCRE_RULE_DOTALL_F)
+
+/* Rule as given by the application, kept to recompile and export. */
+struct swregex_rule {
+	uint32_t rule_id;
+	uint16_t group_id;
+	uint64_t flags; /* RTE_REGEX_PCRE_RULE_* */
+	char *pcre;
+	uint16_t pcre_len;
+};
+
+struct swregex_rule_set {
+	struct swregex_rule *rules;
+	uint32_t nb_rules;
+};
+
+struct swregex_byte_set {
+	uint64_t bits[4];
+};
+
+enum swregex_nfa_op {
+	SWREGEX_NFA_BYTE,  /* consume a byte of set, go to out */
+	SWREGEX_NFA_SPLIT, /* go to out and out1 */
+	SWREGEX_NFA_JMP,   /* go to out */
+	SWREGEX_NFA_MATCH,
+};
+
+struct swregex_nfa_state {
+	uint16_t op;
+	uint16_t set;
+	uint16_t out;
+	uint16_t out1;
+};
+
+/* Compiled rule */
+struct swregex_prog {
+	uint32_t rule_id;
+	uint16_t group_id;
+	bool anchored;     /* matches start at offset 0 only */
+	bool end_anchored; /* matches end at the end of the buffer only */
+	/* The rule is its prefilter literal, matched without automaton. */
+	bool literal_only;
+	/* Literal every match contains, -1 if none */
+	int32_t literal;
+	/* Bytes a match can start with */
+	struct swregex_byte_set first;
+
+	/* Thompson NFA, to find the bounds of the matches */
+	uint16_t nb_states;
+	uint16_t start;
+	struct swregex_nfa_state *states;
+	struct swregex_byte_set *sets;
+
+	/* DFA over byte classes, to find whether there is a match.
+	 * State 0 is the dead state, state 1 the start state.
+	 * NULL if over the state budget.
+	 */
+	uint16_t *dfa;
+	uint8_t *dfa_accept;
+	uint16_t nb_dfa_states;
+	uint16_t nb_classes;
+	uint8_t class_map[256];
+};
+
+struct swregex_literal {
+	uint8_t *str; /* lower case if caseless */
+	uint16_t len;
+	bool caseless;
+	uint32_t prog;
+};
+
+/* Teddy-like multi-literal prefilter: a position is a candidate for the
+ * literals of a bucket if, for each of the first nb_masks bytes from the
+ * position, the bucket bit is set in the masks of both nibbles of the byte.
+ */
+struct swregex_prefilter {
+	uint8_t lo[SWREGEX_PF_MASKS][16] __rte_aligned(16);
+	uint8_t hi[SWREGEX_PF_MASKS][16] __rte_aligned(16);
+	uint8_t nb_masks;
+	uint16_t min_len;
+	uint32_t nb_lits;
+	struct swregex_literal *lits;
+	/* literal indexes of bucket b: bucket_lits[bucket_start[b]..[b + 1]] */
+	uint32_t bucket_start[SWREGEX_PF_BUCKETS + 1];
+	uint32_t *bucket_lits;
+};
+
+struct swregex_db {
+	uint32_t nb_progs;
+	struct swregex_prog *progs;
+	/* rules without a literal, run on every scan */
+	uint32_t nb_nolit;
+	uint32_t *nolit;
+	struct swregex_prefilter pf;
+	uint16_t max_nfa_states;
+	uint32_t nb_literal_only;
+	uint32_t nb_dfa;
+};
+
+struct swregex_thread {
+	uint16_t state;
+	uint32_t start;
+};
+
+/* Per rule state of a scan, valid when gen is the scan generation */
+struct swregex_rule_state {
+	uint32_t gen;
+	uint32_t last_end;
+};
+
+/* Working memory of the scans of a queue pair */
+struct swregex_scratch {
+	uint8_t *buf; /* linearized chained mbuf */
+	struct swregex_thread *threads; /* 2 lists of max_nfa_states */
+	uint16_t *stack;
+	uint32_t *marks;
+	uint32_t mark_gen;
+	struct swregex_rule_state *rules;
+	uint32_t *cand;
+	uint32_t gen;
+	uint32_t nb_rules; /* rules and cand are sized for */
+	uint16_t nb_states; /* threads, stack and marks are sized for */
+};
+
+struct swregex_qp {
+	/* requests to the worker lcore, if any, and completions */
+	struct rte_ring *req_ring;
+	struct rte_ring *cpl_ring;
+	uint16_t nb_desc;
+	regexdev_stop_flush_t cb;
+
+	/* Application side */
+	uint64_t enqueued __rte_cache_aligned;
+	uint64_t dequeued;
+
+	/* Scanning side */
+	struct swregex_scratch scratch __rte_cache_aligned;
+};
+
+struct swregex_priv;
+
+struct swregex_worker {
+	struct swregex_priv *priv;
+	unsigned int lcore_id;
+	uint16_t idx;
+};
+
+struct swregex_priv {
+	struct rte_regexdev *dev;
+	int socket_id;
+
+	/* Dedicated lcore workers, if any; otherwise the scans run in
+	 * the enqueue call.
+	 */
+	uint16_t nb_lcores;
+	unsigned int lcores[SWREGEX_MAX_LCORES];
+	struct swregex_worker workers[SWREGEX_MAX_LCORES];
+	bool lcore_exit;
+	bool started;
+
+	uint16_t nb_qps;
+	struct swregex_qp *qps[SWREGEX_MAX_QPS];
+	uint16_t nb_max_matches;
+	bool match_as_end;
+
+	struct swregex_rule_set rules; /* updated by the application */
+	struct swregex_db *db; /* active */
+};
+
+/* Compile a rule, and extract the literal its matches contain: lit->len is
+ * 0 if there is none, lit->str is to be freed by the caller otherwise.
+ */
+int swregex_prog_compile(const struct swregex_rule *rule,
+		struct swregex_prog *prog, struct swregex_literal *lit,
+		int socket_id);
+void swregex_prog_free(struct swregex_prog *prog);
+
+int swregex_db_compile(const struct swregex_rule_set *set,
+		struct swregex_db **db, int socket_id);
+void swregex_db_free(struct swregex_db *db);
+
+int swregex_scratch_setup(struct swregex_scratch *s,
+		const struct swregex_db *db, int socket_id);
+void swregex_scratch_free(struct swregex_scratch *s);
+
+void swregex_scan(const struct swregex_priv *priv, struct swregex_scratch *s,
+		struct rte_regex_ops *op);
+
+#endif /* SW_REGEXDEV_H */
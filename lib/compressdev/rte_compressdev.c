@@ -27,6 +27,21 @@ static struct rte_compressdev_global compressdev_globals = {
 		.max_devs		= RTE_COMPRESS_MAX_DEVS
 };
 
+static unsigned int
+rte_compressdev_is_valid_dev(uint8_t dev_id)
+{
+	struct rte_compressdev *dev = NULL;
+
+	if (dev_id >= RTE_COMPRESS_MAX_DEVS)
+		return 0;
+
+	dev = &rte_comp_devices[dev_id];
+	if (dev->attached != RTE_COMPRESSDEV_ATTACHED)
+		return 0;
+	else
+		return 1;
+}
+
 const struct rte_compressdev_capabilities *
 rte_compressdev_capability_get(uint8_t dev_id,
 			enum rte_comp_algorithm algo)
@@ -35,7 +50,7 @@ rte_compressdev_capability_get(uint8_t dev_id,
 	struct rte_compressdev_info dev_info;
 	int i = 0;
 
-	if (dev_id >= compressdev_globals.nb_devs) {
+	if (!rte_compressdev_is_valid_dev(dev_id)) {
 		COMPRESSDEV_LOG(ERR, "Invalid dev_id=%d", dev_id);
 		return NULL;
 	}
@@ -99,22 +114,6 @@ rte_compressdev_pmd_get_named_dev(const char *name)
 	return NULL;
 }
 
-static unsigned int
-rte_compressdev_is_valid_dev(uint8_t dev_id)
-{
-	struct rte_compressdev *dev = NULL;
-
-	if (dev_id >= compressdev_globals.nb_devs)
-		return 0;
-
-	dev = rte_compressdev_get_dev(dev_id);
-	if (dev->attached != RTE_COMPRESSDEV_ATTACHED)
-		return 0;
-	else
-		return 1;
-}
-
-
 int
 rte_compressdev_get_dev_id(const char *name)
 {
@@ -123,11 +122,11 @@ rte_compressdev_get_dev_id(const char *name)
 	if (name == NULL)
 		return -1;
 
-	for (i = 0; i < compressdev_globals.nb_devs; i++)
-		if ((strcmp(compressdev_globals.devs[i].data->name, name)
-				== 0) &&
-				(compressdev_globals.devs[i].attached ==
-						RTE_COMPRESSDEV_ATTACHED))
+	for (i = 0; i < RTE_COMPRESS_MAX_DEVS; i++)
+		if ((compressdev_globals.devs[i].attached ==
+				RTE_COMPRESSDEV_ATTACHED) &&
+				(strcmp(compressdev_globals.devs[i].data->name,
+						name) == 0))
 			return i;
 
 	return -1;
@@ -638,7 +637,7 @@ rte_compressdev_info_get(uint8_t dev_id, struct rte_compressdev_info *dev_info)
 {
 	struct rte_compressdev *dev;
 
-	if (dev_id >= compressdev_globals.nb_devs) {
+	if (!rte_compressdev_is_valid_dev(dev_id)) {
 		COMPRESSDEV_LOG(ERR, "Invalid dev_id=%d", dev_id);
 		return;
 	}
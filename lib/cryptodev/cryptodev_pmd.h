@@ -362,6 +362,25 @@ typedef uint32_t (*cryptodev_sym_cpu_crypto_process_t)
 	(struct rte_cryptodev *dev, struct rte_cryptodev_sym_session *sess,
 	union rte_crypto_sym_ofs ofs, struct rte_crypto_sym_vec *vec);
 
+/**
+ * Perform actual crypto processing (encrypt/digest or auth/decrypt)
+ * on user provided data, each operation with its own session.
+ * Optional, sym_cpu_process is called for each run of operations with the
+ * same session otherwise.
+ *
+ * @param	dev	Crypto device pointer
+ * @param	sess	Array of the cryptodev sessions of the operations
+ * @param	ofs	Array of the start and stop offsets of the operations
+ * @param	vec	Vectorized operation descriptor
+ *
+ * @return
+ *  - Returns number of successfully processed packets.
+ *
+ */
+typedef uint32_t (*cryptodev_sym_cpu_crypto_process_multi_t)
+	(struct rte_cryptodev *dev, struct rte_cryptodev_sym_session *sess[],
+	const union rte_crypto_sym_ofs ofs[], struct rte_crypto_sym_vec *vec);
+
 /**
  * Typedef that the driver provided to get service context private date size.
  *
@@ -442,6 +461,8 @@ struct rte_cryptodev_ops {
 			/**< Initialize raw data path context data. */
 		};
 	};
+	cryptodev_sym_cpu_crypto_process_multi_t sym_cpu_process_multi;
+	/**< process data of several sessions synchronously (cpu-crypto). */
 };
 
 
@@ -2213,6 +2213,60 @@ rte_cryptodev_sym_cpu_crypto_process(uint8_t dev_id,
 	return dev->dev_ops->sym_cpu_process(dev, sess, ofs, vec);
 }
 
+/* Process the runs of operations with the same session and offsets */
+static uint32_t
+sym_cpu_crypto_process_runs(struct rte_cryptodev *dev,
+	struct rte_cryptodev_sym_session *sess[],
+	const union rte_crypto_sym_ofs ofs[], struct rte_crypto_sym_vec *vec)
+{
+	struct rte_crypto_sym_vec run;
+	uint32_t i, j, n;
+
+	n = 0;
+	for (i = 0; i != vec->num; i = j) {
+		for (j = i + 1; j != vec->num && sess[j] == sess[i] &&
+				ofs[j].raw == ofs[i].raw; j++)
+			;
+
+		run.num = j - i;
+		run.src_sgl = vec->src_sgl + i;
+		run.dest_sgl = vec->dest_sgl == NULL ? NULL : vec->dest_sgl + i;
+		run.iv = vec->iv == NULL ? NULL : vec->iv + i;
+		run.digest = vec->digest == NULL ? NULL : vec->digest + i;
+		run.aad = vec->aad == NULL ? NULL : vec->aad + i;
+		run.status = vec->status + i;
+		n += dev->dev_ops->sym_cpu_process(dev, sess[i], ofs[i], &run);
+	}
+
+	return n;
+}
+
+uint32_t
+rte_cryptodev_sym_cpu_crypto_process_multi(uint8_t dev_id,
+	struct rte_cryptodev_sym_session *sess[],
+	const union rte_crypto_sym_ofs ofs[], struct rte_crypto_sym_vec *vec)
+{
+	struct rte_cryptodev *dev;
+
+	if (!rte_cryptodev_is_valid_dev(dev_id)) {
+		sym_crypto_fill_status(vec, EINVAL);
+		return 0;
+	}
+
+	dev = rte_cryptodev_pmd_get_dev(dev_id);
+
+	if (*dev->dev_ops->sym_cpu_process == NULL ||
+		!(dev->feature_flags & RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO)) {
+		sym_crypto_fill_status(vec, ENOTSUP);
+		return 0;
+	}
+
+	if (dev->dev_ops->sym_cpu_process_multi != NULL)
+		return dev->dev_ops->sym_cpu_process_multi(dev, sess, ofs, vec);
+
+	return sym_cpu_crypto_process_runs(dev, sess, ofs, vec);
+}
+
 int
 rte_cryptodev_get_raw_dp_ctx_size(uint8_t dev_id)
 {
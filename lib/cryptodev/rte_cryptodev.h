@@ -1256,6 +1256,29 @@ rte_cryptodev_sym_cpu_crypto_process(uint8_t dev_id,
 	struct rte_cryptodev_sym_session *sess, union rte_crypto_sym_ofs ofs,
 	struct rte_crypto_sym_vec *vec);
 
+/**
+ * Perform actual crypto processing (encrypt/digest or auth/decrypt)
+ * on user provided data, each operation with its own session and offsets.
+ * Unlike successive calls of *rte_cryptodev_sym_cpu_crypto_process* for
+ * each session, the device may process the operations of all the sessions
+ * together.
+ *
+ * @param	dev_id	The device identifier.
+ * @param	sess	Array of *vec->num* cryptodev sessions, one for each
+ *			operation.
+ * @param	ofs	Array of *vec->num* start and stop offsets for auth
+ *			and cipher operations, one for each operation.
+ * @param	vec	Vectorized operation descriptor
+ *
+ * @return
+ *  - Returns number of successfully processed packets.
+ */
+__rte_experimental
+uint32_t
+rte_cryptodev_sym_cpu_crypto_process_multi(uint8_t dev_id,
+	struct rte_cryptodev_sym_session *sess[],
+	const union rte_crypto_sym_ofs ofs[], struct rte_crypto_sym_vec *vec);
+
 /**
  * Get the size of the raw data-path context buffer.
  *
@@ -8,6 +8,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <rte_compat.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -298,6 +300,21 @@ rte_memcpy(void *dst, const void *src, size_t n)
 
 #endif /* RTE_ARCH_ARM_NEON_MEMCPY */
 
+/* Non-temporal copies are not implemented, use regular stores. */
+__rte_experimental
+static inline void *
+rte_memcpy_nt(void *dst, const void *src, size_t n)
+{
+	return rte_memcpy(dst, src, n);
+}
+
+__rte_experimental
+static inline void *
+rte_memcpy_nt_auto(void *dst, const void *src, size_t n)
+{
+	return rte_memcpy(dst, src, n);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,6 +12,9 @@ extern "C" {
 #include <stdint.h>
 #include <string.h>
 
+#include <rte_common.h>
+#include <rte_compat.h>
+
 #include "generic/rte_memcpy.h"
 
 #ifdef RTE_ARCH_ARM64_MEMCPY
@@ -365,6 +368,63 @@ rte_mov256(uint8_t *dst, const uint8_t *src)
 
 #endif /* RTE_ARCH_ARM64_MEMCPY */
 
+/* Copy 64 bytes with non-temporal store pairs. */
+static __rte_always_inline void
+rte_mov64_nt(uint8_t *dst, const uint8_t *src)
+{
+	asm volatile(
+		"ldp q0, q1, [%1]\n\t"
+		"ldp q2, q3, [%1, #32]\n\t"
+		"stnp q0, q1, [%0]\n\t"
+		"stnp q2, q3, [%0, #32]\n\t"
+		:
+		: "r" (dst), "r" (src)
+		: "v0", "v1", "v2", "v3", "memory");
+}
+
+/*
+ * Non-temporal stores follow the same ordering rules as regular stores,
+ * so no barrier is needed after the copy.
+ */
+__rte_experimental
+static __rte_always_inline void *
+rte_memcpy_nt(void *dst, const void *src, size_t n)
+{
+	void *ret = dst;
+	size_t head;
+
+	if (n < 128)
+		return rte_memcpy(dst, src, n);
+
+	/* write whole 64-byte blocks */
+	head = (size_t)-(uintptr_t)dst & 63;
+	if (head != 0) {
+		rte_memcpy(dst, src, head);
+		dst = (uint8_t *)dst + head;
+		src = (const uint8_t *)src + head;
+		n -= head;
+	}
+
+	for (; n >= 64; n -= 64) {
+		rte_mov64_nt((uint8_t *)dst, (const uint8_t *)src);
+		dst = (uint8_t *)dst + 64;
+		src = (const uint8_t *)src + 64;
+	}
+	if (n != 0)
+		rte_memcpy(dst, src, n);
+
+	return ret;
+}
+
+__rte_experimental
+static __rte_always_inline void *
+rte_memcpy_nt_auto(void *dst, const void *src, size_t n)
+{
+	if (n >= RTE_MEMCPY_NT_THRESHOLD)
+		return rte_memcpy_nt(dst, src, n);
+	return rte_memcpy(dst, src, n);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_telemetry.h>
+
+#include "eal_private.h"
+
+#define EAL_INIT_TIMINGS_REQ "/eal/init_timings"
+#define EAL_INIT_MAX_PHASES 16
+#define NSEC_PER_SEC UINT64_C(1000000000)
+#define NSEC_PER_MSEC UINT64_C(1000000)
+#define NSEC_PER_USEC UINT64_C(1000)
+
+static struct {
+	const char *name;
+	uint64_t ns;
+} init_phases[EAL_INIT_MAX_PHASES];
+static unsigned int nb_init_phases;
+static uint64_t init_start_ns;
+static uint64_t init_last_ns;
+
+static uint64_t
+init_timing_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void
+eal_init_timing_start(void)
+{
+	nb_init_phases = 0;
+	init_start_ns = init_timing_now();
+	init_last_ns = init_start_ns;
+}
+
+void
+eal_init_timing_mark(const char *phase)
+{
+	uint64_t now = init_timing_now();
+
+	if (nb_init_phases == EAL_INIT_MAX_PHASES)
+		return;
+	init_phases[nb_init_phases].name = phase;
+	init_phases[nb_init_phases].ns = now - init_last_ns;
+	nb_init_phases++;
+	init_last_ns = now;
+}
+
+void
+eal_init_timing_dump(void)
+{
+	char buf[256];
+	unsigned int i;
+	int len = 0;
+
+	for (i = 0; i < nb_init_phases && len < (int)sizeof(buf); i++)
+		len += snprintf(buf + len, sizeof(buf) - len, "%s%s %"PRIu64,
+				i == 0 ? "" : ", ", init_phases[i].name,
+				init_phases[i].ns / NSEC_PER_MSEC);
+
+	RTE_LOG(INFO, EAL, "Init completed in %"PRIu64" ms (%s)\n",
+		(init_last_ns - init_start_ns) / NSEC_PER_MSEC, buf);
+}
+
+static int
+handle_eal_init_timings_request(const char *cmd __rte_unused,
+		const char *params __rte_unused, struct rte_tel_data *d)
+{
+	unsigned int i;
+
+	/* durations in microseconds */
+	rte_tel_data_start_dict(d);
+	for (i = 0; i < nb_init_phases; i++)
+		rte_tel_data_add_dict_u64(d, init_phases[i].name,
+				init_phases[i].ns / NSEC_PER_USEC);
+	rte_tel_data_add_dict_u64(d, "total",
+			(init_last_ns - init_start_ns) / NSEC_PER_USEC);
+	return 0;
+}
+
+RTE_INIT(init_timing_telemetry)
+{
+	rte_telemetry_register_cmd(EAL_INIT_TIMINGS_REQ,
+			handle_eal_init_timings_request,
+			"Returns the duration of the EAL init phases in us. Takes no parameters");
+}
@@ -73,6 +73,7 @@ eal_long_options[] = {
 	{OPT_HELP,              0, NULL, OPT_HELP_NUM             },
 	{OPT_HUGE_DIR,          1, NULL, OPT_HUGE_DIR_NUM         },
 	{OPT_HUGE_UNLINK,       2, NULL, OPT_HUGE_UNLINK_NUM      },
+	{OPT_HUGE_ALLOC_THREADS, 1, NULL, OPT_HUGE_ALLOC_THREADS_NUM},
 	{OPT_IOVA_MODE,	        1, NULL, OPT_IOVA_MODE_NUM        },
 	{OPT_LCORES,            1, NULL, OPT_LCORES_NUM           },
 	{OPT_LOG_LEVEL,         1, NULL, OPT_LOG_LEVEL_NUM        },
@@ -80,6 +81,7 @@ eal_long_options[] = {
 	{OPT_TRACE_DIR,         1, NULL, OPT_TRACE_DIR_NUM        },
 	{OPT_TRACE_BUF_SIZE,    1, NULL, OPT_TRACE_BUF_SIZE_NUM   },
 	{OPT_TRACE_MODE,        1, NULL, OPT_TRACE_MODE_NUM       },
+	{OPT_TRACE_STREAM,      1, NULL, OPT_TRACE_STREAM_NUM     },
 	{OPT_MAIN_LCORE,        1, NULL, OPT_MAIN_LCORE_NUM       },
 	{OPT_MBUF_POOL_OPS_NAME, 1, NULL, OPT_MBUF_POOL_OPS_NAME_NUM},
 	{OPT_NO_HPET,           0, NULL, OPT_NO_HPET_NUM          },
@@ -100,6 +102,7 @@ eal_long_options[] = {
 	{OPT_LEGACY_MEM,        0, NULL, OPT_LEGACY_MEM_NUM       },
 	{OPT_SINGLE_FILE_SEGMENTS, 0, NULL, OPT_SINGLE_FILE_SEGMENTS_NUM},
 	{OPT_MATCH_ALLOCATIONS, 0, NULL, OPT_MATCH_ALLOCATIONS_NUM},
+	{OPT_MALLOC_CACHE,      0, NULL, OPT_MALLOC_CACHE_NUM     },
 	{OPT_TELEMETRY,         0, NULL, OPT_TELEMETRY_NUM        },
 	{OPT_NO_TELEMETRY,      0, NULL, OPT_NO_TELEMETRY_NUM     },
 	{OPT_FORCE_MAX_SIMD_BITWIDTH, 1, NULL, OPT_FORCE_MAX_SIMD_BITWIDTH_NUM},
@@ -326,6 +329,7 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 		internal_cfg->hugepage_info[i].lock_descriptor = -1;
 	}
 	internal_cfg->base_virtaddr = 0;
+	internal_cfg->huge_alloc_threads = 0;
 
 #ifdef LOG_DAEMON
 	internal_cfg->syslog_facility = LOG_DAEMON;
@@ -1869,6 +1873,15 @@ eal_parse_common_option(int opt, const char *optarg,
 		}
 		break;
 	}
+
+	case OPT_TRACE_STREAM_NUM: {
+		if (eal_trace_stream_args_save(optarg) < 0) {
+			RTE_LOG(ERR, EAL, "invalid parameters for --"
+				OPT_TRACE_STREAM "\n");
+			return -1;
+		}
+		break;
+	}
 #endif /* !RTE_EXEC_ENV_WINDOWS */
 
 	case OPT_LCORES_NUM:
@@ -1913,6 +1926,9 @@ eal_parse_common_option(int opt, const char *optarg,
 	case OPT_NO_TELEMETRY_NUM:
 		conf->no_telemetry = 1;
 		break;
+	case OPT_MALLOC_CACHE_NUM:
+		conf->malloc_cache = 1;
+		break;
 	case OPT_FORCE_MAX_SIMD_BITWIDTH_NUM:
 		if (eal_parse_simd_bitwidth(optarg) < 0) {
 			RTE_LOG(ERR, EAL, "invalid parameter for --"
@@ -2083,6 +2099,12 @@ eal_check_common_options(struct internal_config *internal_cfg)
 		RTE_LOG(ERR, EAL, "Option --"OPT_SOCKET_LIMIT
 			" is only supported in non-legacy memory mode\n");
 	}
+	if (internal_cfg->huge_alloc_threads > 1 &&
+			(internal_cfg->legacy_mem ||
+			internal_cfg->single_file_segments)) {
+		RTE_LOG(WARNING, EAL, "Option --"OPT_HUGE_ALLOC_THREADS
+			" is ignored in legacy memory and single-file segments modes\n");
+	}
 	if (internal_cfg->single_file_segments &&
 			internal_cfg->hugepage_file.unlink_before_mapping &&
 			!internal_cfg->in_memory) {
@@ -2218,6 +2240,14 @@ eal_common_usage(void)
 	       "                      reaches its maximum limit.\n"
 	       "                      Default mode is 'overwrite' and parameter\n"
 	       "                      must be specified once only.\n"
+	       "  --"OPT_TRACE_STREAM"=<file[:<size>] | unix:<socket path>>\n"
+	       "                      Stream the trace output while running,\n"
+	       "                      either to files of trace directory,\n"
+	       "                      switching file every 'size' bytes\n"
+	       "                      (default 16MB), or to a consumer\n"
+	       "                      connected on a unix socket.\n"
+	       "                      By default, the trace output is saved\n"
+	       "                      at exit only.\n"
 #endif /* !RTE_EXEC_ENV_WINDOWS */
 	       "  -v                  Display version information on startup\n"
 	       "  -h, --help          This help\n"
@@ -2227,6 +2257,7 @@ eal_common_usage(void)
 	       "  --"OPT_TELEMETRY"   Enable telemetry support (on by default)\n"
 	       "  --"OPT_NO_TELEMETRY"   Disable telemetry support\n"
 	       "  --"OPT_FORCE_MAX_SIMD_BITWIDTH" Force the max SIMD bitwidth\n"
+	       "  --"OPT_MALLOC_CACHE"      Cache small allocations per lcore\n"
 	       "\nEAL options for DEBUG use only:\n"
 	       "  --"OPT_HUGE_UNLINK"[=existing|always|never]\n"
 	       "                      When to unlink files in hugetlbfs\n"
@@ -2,6 +2,7 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
@@ -13,6 +14,8 @@
 #include <rte_lcore.h>
 #include <rte_log.h>
 #include <rte_memory.h>
+#include <rte_spinlock.h>
+#include <rte_thread.h>
 #include <rte_trace_point.h>
 
 #include "eal_internal_cfg.h"
@@ -257,6 +260,17 @@ rte_ctrl_thread_create(pthread_t *thread, const char *name,
 	return -ret;
 }
 
+/* Registered threads release their lcore when exiting. */
+static rte_thread_key register_key;
+static bool register_key_created;
+static rte_spinlock_t register_key_lock = RTE_SPINLOCK_INITIALIZER;
+
+static void
+thread_register_destroy(void *arg __rte_unused)
+{
+	rte_thread_unregister();
+}
+
 int
 rte_thread_register(void)
 {
@@ -285,6 +299,14 @@ rte_thread_register(void)
 		rte_errno = ENOMEM;
 		return -1;
 	}
+	rte_spinlock_lock(&register_key_lock);
+	if (!register_key_created && rte_thread_key_create(&register_key,
+			thread_register_destroy) == 0)
+		register_key_created = true;
+	rte_spinlock_unlock(&register_key_lock);
+	/* the exit destructor is only called if not NULL */
+	if (register_key_created)
+		rte_thread_value_set(register_key, &register_key);
 	RTE_LOG(DEBUG, EAL, "Registered non-EAL thread as lcore %u.\n",
 		lcore_id);
 	return 0;
@@ -295,6 +317,8 @@ rte_thread_unregister(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
 
+	if (lcore_id != LCORE_ID_ANY && register_key_created)
+		rte_thread_value_set(register_key, NULL);
 	if (lcore_id != LCORE_ID_ANY)
 		eal_lcore_non_eal_release(lcore_id);
 	__rte_thread_uninit();
@@ -3,6 +3,7 @@
  */
 
 #include <fnmatch.h>
+#include <inttypes.h>
 #include <sys/queue.h>
 #include <regex.h>
 
@@ -274,10 +275,30 @@ trace_lcore_mem_dump(FILE *f)
 		trace_area_to_string(trace->lcore_meta[count].area),
 		header->stream_header.lcore_id,
 		header->stream_header.thread_name);
+		if (header->dropped != 0)
+			fprintf(f, "\t\tdropped=%" PRIu64 "\n",
+				header->dropped);
 	}
 	rte_spinlock_unlock(&trace->lock);
 }
 
+uint64_t
+rte_trace_events_dropped(void)
+{
+	struct trace *trace = trace_obj_get();
+	struct __rte_trace_header *header;
+	uint64_t dropped = 0;
+	uint32_t count;
+
+	rte_spinlock_lock(&trace->lock);
+	for (count = 0; count < trace->nb_trace_mem_list; count++) {
+		header = trace->lcore_meta[count].mem;
+		dropped += __atomic_load_n(&header->dropped, __ATOMIC_RELAXED);
+	}
+	rte_spinlock_unlock(&trace->lock);
+	return dropped;
+}
+
 void
 rte_trace_dump(FILE *f)
 {
@@ -292,6 +313,7 @@ rte_trace_dump(FILE *f)
 		trace_mode_to_string(rte_trace_mode_get()));
 	fprintf(f, "dir = %s\n", trace->dir);
 	fprintf(f, "buffer len = %d\n", trace->buff_len);
+	fprintf(f, "stream = %s\n", trace_stream_to_string(trace->stream));
 	fprintf(f, "number of trace points = %d\n", trace->nb_trace_points);
 
 	trace_lcore_mem_dump(f);
@@ -351,6 +373,11 @@ __rte_trace_mem_per_thread_alloc(void)
 found:
 	header->offset = 0;
 	header->len = trace->buff_len;
+	header->stream = trace->stream != TRACE_STREAM_NONE;
+	header->commit = 0;
+	header->consumed = 0;
+	header->wrap = 0;
+	header->dropped = 0;
 	header->stream_header.magic = TRACE_CTF_MAGIC;
 	rte_uuid_copy(header->stream_header.uuid, trace->uuid);
 	header->stream_header.lcore_id = rte_lcore_id();
@@ -362,6 +389,11 @@ found:
 		__RTE_TRACE_EMIT_STRING_LEN_MAX);
 
 	trace->lcore_meta[count].mem = header;
+	trace->lcore_meta[count].channel = trace->nb_channels++;
+	trace->lcore_meta[count].file = NULL;
+	trace->lcore_meta[count].file_seq = 0;
+	trace->lcore_meta[count].file_size = 0;
+	trace->lcore_meta[count].announced = false;
 	trace->nb_trace_mem_list++;
 fail:
 	RTE_PER_LCORE(trace_mem) = header;
@@ -371,6 +403,11 @@ fail:
 static void
 trace_mem_per_thread_free_unlocked(struct thread_mem_meta *meta)
 {
+	/* save the last events of the thread */
+	if (trace_obj_get()->stream_running)
+		trace_stream_drain(meta);
+	trace_stream_close(meta);
+
 	if (meta->area == TRACE_AREA_HUGEPAGE)
 		eal_free_no_trace(meta->mem);
 	else if (meta->area == TRACE_AREA_HEAP)
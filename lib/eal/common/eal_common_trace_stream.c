@@ -0,0 +1,432 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_string_fns.h>
+
+#include "eal_trace.h"
+
+/* Period of the streaming thread */
+#define TRACE_STREAM_PERIOD_US 10000
+/* Default size of a stream file before switching to the next one */
+#define TRACE_STREAM_FILE_SIZE (16 * 1024 * 1024)
+/* Number of stream files kept per thread */
+#define TRACE_STREAM_FILES 8
+/* Maximum payload of a record sent to the socket consumer */
+#define TRACE_STREAM_RECORD_LEN (64 * 1024u)
+
+/* Records sent to the socket consumer */
+enum trace_stream_record_type {
+	TRACE_STREAM_RECORD_METADATA,
+	TRACE_STREAM_RECORD_HEADER,
+	TRACE_STREAM_RECORD_EVENTS,
+};
+
+struct trace_stream_record {
+	uint32_t type;
+	uint32_t channel;
+};
+
+int
+eal_trace_stream_args_save(const char *val)
+{
+	struct trace *trace = trace_obj_get();
+	struct sockaddr_un sun;
+
+	if (strncmp(val, "file", 4) == 0 &&
+			(val[4] == '\0' || val[4] == ':')) {
+		trace->stream_file_size = TRACE_STREAM_FILE_SIZE;
+		if (val[4] == ':') {
+			trace->stream_file_size = rte_str_to_size(val + 5);
+			if (trace->stream_file_size == 0) {
+				trace_err("stream file size cannot be zero");
+				return -EINVAL;
+			}
+		}
+		trace->stream = TRACE_STREAM_FILE;
+		return 0;
+	}
+
+	if (strncmp(val, "unix:", 5) == 0) {
+		if (val[5] == '\0' ||
+				strlen(val + 5) >= sizeof(sun.sun_path)) {
+			trace_err("invalid socket path");
+			return -EINVAL;
+		}
+		strlcpy(trace->stream_path, val + 5,
+			sizeof(trace->stream_path));
+		trace->stream = TRACE_STREAM_UNIX;
+		return 0;
+	}
+
+	trace_err("unknown stream %s", val);
+	return -EINVAL;
+}
+
+static int
+stream_file_open(struct trace *trace, struct thread_mem_meta *meta)
+{
+	struct __rte_trace_header *hdr = meta->mem;
+	char file_name[PATH_MAX];
+
+	/* Keep the most recent files only */
+	if (meta->file_seq >= TRACE_STREAM_FILES) {
+		snprintf(file_name, PATH_MAX, "%s/channel0_%u_%u", trace->dir,
+			meta->channel, meta->file_seq - TRACE_STREAM_FILES);
+		unlink(file_name);
+	}
+
+	snprintf(file_name, PATH_MAX, "%s/channel0_%u_%u", trace->dir,
+		meta->channel, meta->file_seq);
+	meta->file = fopen(file_name, "w");
+	if (meta->file == NULL)
+		return -errno;
+
+	/* Each file is a complete CTF stream */
+	if (fwrite(&hdr->stream_header, sizeof(hdr->stream_header), 1,
+			meta->file) != 1) {
+		fclose(meta->file);
+		meta->file = NULL;
+		return -EIO;
+	}
+	meta->file_size = sizeof(hdr->stream_header);
+	return 0;
+}
+
+/* Called between events only, so that a file never splits an event. */
+static int
+stream_file_write(struct trace *trace, struct thread_mem_meta *meta,
+	const void *data, uint32_t len)
+{
+	int rc;
+
+	if (meta->file != NULL && meta->file_size >= trace->stream_file_size) {
+		fclose(meta->file);
+		meta->file = NULL;
+		meta->file_seq++;
+	}
+
+	if (meta->file == NULL) {
+		rc = stream_file_open(trace, meta);
+		if (rc < 0)
+			return rc;
+	}
+
+	if (fwrite(data, len, 1, meta->file) != 1)
+		return -EIO;
+	meta->file_size += len;
+	return 0;
+}
+
+static void
+stream_client_close(struct trace *trace)
+{
+	close(trace->stream_client);
+	trace->stream_client = -1;
+}
+
+static int
+stream_send(struct trace *trace, uint32_t type, uint32_t channel,
+	const void *data, uint32_t len)
+{
+	struct trace_stream_record rec = { .type = type, .channel = channel };
+	struct iovec iov[2] = {
+		{ .iov_base = &rec, .iov_len = sizeof(rec) },
+		{ .iov_base = (void *)(uintptr_t)data, .iov_len = len },
+	};
+	struct msghdr msg = { .msg_iov = iov, .msg_iovlen = RTE_DIM(iov) };
+
+	if (sendmsg(trace->stream_client, &msg,
+			MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+		/* Try again on the next period */
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return -EAGAIN;
+		trace_err("stream consumer lost: %s", strerror(errno));
+		stream_client_close(trace);
+		return -EPIPE;
+	}
+	return 0;
+}
+
+/* Output the events of a thread in [from, to). */
+static int
+stream_output(struct trace *trace, struct thread_mem_meta *meta,
+	uint32_t from, uint32_t to)
+{
+	struct __rte_trace_header *hdr = meta->mem;
+	uint32_t len;
+	int rc;
+
+	while (from < to) {
+		if (trace->stream == TRACE_STREAM_FILE) {
+			len = to - from;
+			rc = stream_file_write(trace, meta, &hdr->mem[from],
+				len);
+			/* Events are lost rather than stalling the thread */
+			if (rc < 0 && !trace->stream_error) {
+				trace_err("cannot stream to %s: %s",
+					trace->dir, strerror(-rc));
+				trace->stream_error = true;
+			}
+		} else {
+			len = RTE_MIN(to - from, TRACE_STREAM_RECORD_LEN);
+			rc = stream_send(trace, TRACE_STREAM_RECORD_EVENTS,
+				meta->channel, &hdr->mem[from], len);
+			if (rc < 0)
+				return rc;
+		}
+		from += len;
+		/* Give the room back to the thread */
+		__atomic_store_n(&hdr->consumed, from, __ATOMIC_RELEASE);
+	}
+	return 0;
+}
+
+void
+trace_stream_drain(struct thread_mem_meta *meta)
+{
+	struct trace *trace = trace_obj_get();
+	struct __rte_trace_header *hdr = meta->mem;
+	uint32_t commit, consumed;
+
+	if (hdr == NULL)
+		return;
+
+	if (trace->stream == TRACE_STREAM_UNIX) {
+		/* Events wait in the thread buffer for a consumer */
+		if (trace->stream_client < 0)
+			return;
+		if (!meta->announced) {
+			if (stream_send(trace, TRACE_STREAM_RECORD_HEADER,
+					meta->channel, &hdr->stream_header,
+					sizeof(hdr->stream_header)) < 0)
+				return;
+			meta->announced = true;
+		}
+	}
+
+	/* Synchronize with the store-release of the event commit */
+	commit = __atomic_load_n(&hdr->commit, __ATOMIC_ACQUIRE);
+	consumed = hdr->consumed;
+
+	/* The thread wrapped, drain up to the wrap point first */
+	if (commit < consumed) {
+		if (stream_output(trace, meta, consumed, hdr->wrap) < 0)
+			return;
+		consumed = 0;
+	}
+	stream_output(trace, meta, consumed, commit);
+
+	if (meta->file != NULL)
+		fflush(meta->file);
+}
+
+void
+trace_stream_drain_all(void)
+{
+	struct trace *trace = trace_obj_get();
+	uint32_t count;
+
+	rte_spinlock_lock(&trace->lock);
+	for (count = 0; count < trace->nb_trace_mem_list; count++)
+		trace_stream_drain(&trace->lcore_meta[count]);
+	rte_spinlock_unlock(&trace->lock);
+}
+
+void
+trace_stream_close(struct thread_mem_meta *meta)
+{
+	if (meta->file != NULL) {
+		fclose(meta->file);
+		meta->file = NULL;
+	}
+}
+
+static int
+stream_metadata_send(struct trace *trace)
+{
+	size_t len, off;
+	char *buf;
+	FILE *f;
+	int rc;
+
+	f = open_memstream(&buf, &len);
+	if (f == NULL)
+		return -errno;
+	rc = rte_trace_metadata_dump(f);
+	if (fclose(f) != 0 && rc == 0)
+		rc = -errno;
+
+	for (off = 0; rc == 0 && off < len; off += TRACE_STREAM_RECORD_LEN)
+		rc = stream_send(trace, TRACE_STREAM_RECORD_METADATA, 0,
+			buf + off, RTE_MIN(len - off,
+				(size_t)TRACE_STREAM_RECORD_LEN));
+	free(buf);
+	return rc;
+}
+
+static void
+stream_client_poll(struct trace *trace)
+{
+	uint32_t count;
+	ssize_t rc;
+	char c;
+	int s;
+
+	/* Detect a consumer which went away while no event was sent */
+	if (trace->stream_client >= 0) {
+		rc = recv(trace->stream_client, &c, sizeof(c), MSG_DONTWAIT);
+		if (rc > 0 || (rc < 0 && (errno == EAGAIN ||
+				errno == EWOULDBLOCK || errno == EINTR)))
+			return;
+		if (rc < 0)
+			trace_err("stream consumer lost: %s", strerror(errno));
+		stream_client_close(trace);
+	}
+
+	s = accept(trace->stream_sock, NULL, NULL);
+	if (s < 0)
+		return;
+	trace->stream_client = s;
+
+	if (stream_metadata_send(trace) < 0) {
+		trace_err("cannot send metadata to the stream consumer");
+		if (trace->stream_client >= 0)
+			stream_client_close(trace);
+		return;
+	}
+
+	/* The new consumer needs the stream header of every thread */
+	rte_spinlock_lock(&trace->lock);
+	for (count = 0; count < trace->nb_trace_mem_list; count++)
+		trace->lcore_meta[count].announced = false;
+	rte_spinlock_unlock(&trace->lock);
+}
+
+static int
+stream_socket_create(struct trace *trace)
+{
+	struct sockaddr_un sun = { .sun_family = AF_UNIX };
+	int sock;
+
+	strlcpy(sun.sun_path, trace->stream_path, sizeof(sun.sun_path));
+
+	sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (sock < 0)
+		goto fail;
+
+	if (bind(sock, (struct sockaddr *)&sun, sizeof(sun)) < 0) {
+		/* Remove the socket left by a previous run, if unused */
+		if (errno != EADDRINUSE ||
+				connect(sock, (struct sockaddr *)&sun,
+					sizeof(sun)) == 0 ||
+				unlink(sun.sun_path) < 0 ||
+				bind(sock, (struct sockaddr *)&sun,
+					sizeof(sun)) < 0)
+			goto close_fail;
+	}
+
+	/* The streaming thread polls for a consumer */
+	if (fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK) < 0 ||
+			listen(sock, 1) < 0) {
+		unlink(sun.sun_path);
+		goto close_fail;
+	}
+
+	trace->stream_sock = sock;
+	return 0;
+
+close_fail:
+	close(sock);
+fail:
+	trace_err("cannot listen on %s: %s", sun.sun_path, strerror(errno));
+	return -errno;
+}
+
+static void *
+trace_stream_thread(void *arg)
+{
+	struct trace *trace = arg;
+
+	while (__atomic_load_n(&trace->stream_running, __ATOMIC_RELAXED)) {
+		if (trace->stream == TRACE_STREAM_UNIX)
+			stream_client_poll(trace);
+		trace_stream_drain_all();
+		rte_delay_us_sleep(TRACE_STREAM_PERIOD_US);
+	}
+	return NULL;
+}
+
+int
+eal_trace_stream_init(void)
+{
+	struct trace *trace = trace_obj_get();
+	int rc;
+
+	trace->stream_sock = -1;
+	trace->stream_client = -1;
+
+	if (!rte_trace_is_enabled() || trace->stream == TRACE_STREAM_NONE)
+		return 0;
+
+	if (trace->stream == TRACE_STREAM_FILE)
+		rc = trace_meta_save(trace);
+	else
+		rc = stream_socket_create(trace);
+	if (rc < 0)
+		return rc;
+
+	trace->stream_running = true;
+	rc = rte_ctrl_thread_create(&trace->stream_thread, "trace-stream",
+		NULL, trace_stream_thread, trace);
+	if (rc != 0) {
+		trace_err("cannot create the streaming thread");
+		trace->stream_running = false;
+		if (trace->stream == TRACE_STREAM_UNIX) {
+			close(trace->stream_sock);
+			unlink(trace->stream_path);
+		}
+		return -rc;
+	}
+
+	RTE_LOG(INFO, EAL, "Trace stream: %s\n",
+		trace->stream == TRACE_STREAM_FILE ? trace->dir :
+		trace->stream_path);
+	return 0;
+}
+
+void
+eal_trace_stream_fini(void)
+{
+	struct trace *trace = trace_obj_get();
+
+	if (!trace->stream_running)
+		return;
+
+	__atomic_store_n(&trace->stream_running, false, __ATOMIC_RELAXED);
+	pthread_join(trace->stream_thread, NULL);
+
+	/* Save what the threads traced since the last period */
+	trace_stream_drain_all();
+
+	if (trace->stream == TRACE_STREAM_UNIX) {
+		if (trace->stream_client >= 0)
+			stream_client_close(trace);
+		close(trace->stream_sock);
+		trace->stream_sock = -1;
+		unlink(trace->stream_path);
+	}
+}
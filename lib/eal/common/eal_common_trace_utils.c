@@ -34,6 +34,17 @@ trace_area_to_string(enum trace_area_e area)
 	}
 }
 
+const char *
+trace_stream_to_string(enum trace_stream_e stream)
+{
+	switch (stream) {
+	case TRACE_STREAM_NONE: return "none";
+	case TRACE_STREAM_FILE: return "file";
+	case TRACE_STREAM_UNIX: return "unix";
+	default: return "unknown";
+	}
+}
+
 static bool
 trace_entry_compare(const char *name)
 {
@@ -204,6 +215,11 @@ trace_bufsz_args_apply(void)
 
 	if (trace->buff_len == 0)
 		trace->buff_len = 1024 * 1024; /* 1MB */
+
+	/* Streamed events start on an event header boundary */
+	if (trace->stream != TRACE_STREAM_NONE)
+		trace->buff_len = RTE_ALIGN_FLOOR(trace->buff_len,
+			__RTE_TRACE_EVENT_HEADER_SZ);
 }
 
 int
@@ -366,7 +382,7 @@ trace_mkdir(void)
 	return 0;
 }
 
-static int
+int
 trace_meta_save(struct trace *trace)
 {
 	char file_name[PATH_MAX];
@@ -432,6 +448,13 @@ rte_trace_save(void)
 	if (trace->nb_trace_mem_list == 0)
 		return rc;
 
+	/* The streaming thread saves the events, flush what is pending */
+	if (trace->stream != TRACE_STREAM_NONE) {
+		if (trace->stream_running)
+			trace_stream_drain_all();
+		return rc;
+	}
+
 	rc = trace_meta_save(trace);
 	if (rc)
 		return rc;
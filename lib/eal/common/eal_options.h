@@ -31,6 +31,8 @@ enum {
 	OPT_HUGE_DIR_NUM,
 #define OPT_HUGE_UNLINK       "huge-unlink"
 	OPT_HUGE_UNLINK_NUM,
+#define OPT_HUGE_ALLOC_THREADS "huge-alloc-threads"
+	OPT_HUGE_ALLOC_THREADS_NUM,
 #define OPT_LCORES            "lcores"
 	OPT_LCORES_NUM,
 #define OPT_LOG_LEVEL         "log-level"
@@ -43,6 +45,8 @@ enum {
 	OPT_TRACE_BUF_SIZE_NUM,
 #define OPT_TRACE_MODE        "trace-mode"
 	OPT_TRACE_MODE_NUM,
+#define OPT_TRACE_STREAM      "trace-stream"
+	OPT_TRACE_STREAM_NUM,
 #define OPT_MAIN_LCORE        "main-lcore"
 	OPT_MAIN_LCORE_NUM,
 #define OPT_MBUF_POOL_OPS_NAME "mbuf-pool-ops-name"
@@ -81,6 +85,8 @@ enum {
 	OPT_IOVA_MODE_NUM,
 #define OPT_MATCH_ALLOCATIONS  "match-allocations"
 	OPT_MATCH_ALLOCATIONS_NUM,
+#define OPT_MALLOC_CACHE       "malloc-cache"
+	OPT_MALLOC_CACHE_NUM,
 #define OPT_TELEMETRY         "telemetry"
 	OPT_TELEMETRY_NUM,
 #define OPT_NO_TELEMETRY      "no-telemetry"
@@ -732,6 +732,25 @@ void __rte_thread_init(unsigned int lcore_id, rte_cpuset_t *cpuset);
  */
 void __rte_thread_uninit(void);
 
+/**
+ * Start measuring the duration of the EAL init phases.
+ */
+void eal_init_timing_start(void);
+
+/**
+ * Record the end of an EAL init phase, which started at the end of the
+ * previous one.
+ *
+ * @param phase
+ *   Name of the phase, must be a string literal.
+ */
+void eal_init_timing_mark(const char *phase);
+
+/**
+ * Log the duration of the EAL init phases.
+ */
+void eal_init_timing_dump(void);
+
 /**
  * asprintf(3) replacement for Windows.
  */
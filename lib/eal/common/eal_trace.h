@@ -43,6 +43,17 @@ enum trace_area_e {
 struct thread_mem_meta {
 	void *mem;
 	enum trace_area_e area;
+	uint32_t channel;  /* stream id, unique in the process */
+	FILE *file;        /* current file of a file stream */
+	uint32_t file_seq; /* index of the current file */
+	uint64_t file_size;
+	bool announced;    /* stream header sent to the socket consumer */
+};
+
+enum trace_stream_e {
+	TRACE_STREAM_NONE,
+	TRACE_STREAM_FILE,
+	TRACE_STREAM_UNIX,
 };
 
 struct trace_arg {
@@ -71,6 +82,15 @@ struct trace {
 	uint32_t ctf_meta_offset_freq_off;
 	uint16_t ctf_fixup_done;
 	rte_spinlock_t lock;
+	enum trace_stream_e stream;
+	char stream_path[PATH_MAX];
+	uint64_t stream_file_size;
+	uint32_t nb_channels;
+	pthread_t stream_thread;
+	bool stream_running;
+	int stream_sock;
+	int stream_client;
+	bool stream_error;
 };
 
 /* Helper functions */
@@ -97,6 +117,7 @@ struct trace_point_head *trace_list_head_get(void);
 /* Util functions */
 const char *trace_mode_to_string(enum rte_trace_mode mode);
 const char *trace_area_to_string(enum trace_area_e area);
+const char *trace_stream_to_string(enum trace_stream_e stream);
 int trace_args_apply(const char *arg);
 void trace_bufsz_args_apply(void);
 bool trace_has_duplicate_entry(void);
@@ -106,8 +127,12 @@ void trace_metadata_destroy(void);
 char *trace_metadata_fixup_field(const char *field);
 int trace_mkdir(void);
 int trace_epoch_time_save(void);
+int trace_meta_save(struct trace *trace);
 void trace_mem_free(void);
 void trace_mem_per_thread_free(void);
+void trace_stream_drain(struct thread_mem_meta *meta);
+void trace_stream_drain_all(void);
+void trace_stream_close(struct thread_mem_meta *meta);
 
 /* EAL interface */
 int eal_trace_init(void);
@@ -117,5 +142,8 @@ void eal_trace_args_free(void);
 int eal_trace_dir_args_save(const char *val);
 int eal_trace_mode_args_save(const char *val);
 int eal_trace_bufsz_args_save(const char *val);
+int eal_trace_stream_args_save(const char *val);
+int eal_trace_stream_init(void);
+void eal_trace_stream_fini(void);
 
 #endif /* __EAL_TRACE_H */
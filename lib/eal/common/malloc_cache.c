@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_lcore.h>
+
+#include "eal_memcfg.h"
+#include "eal_private.h"
+#include "malloc_cache.h"
+#include "malloc_elem.h"
+#include "malloc_heap.h"
+
+/*
+ * Each lcore keeps a small stack of free elements per size class, taken
+ * from the heap of its socket. Allocations and frees of small objects are
+ * then served without the heap lock, which is only taken once per batch
+ * of MALLOC_CACHE_BATCH elements to refill or flush a class.
+ *
+ * Cached elements stay allocated from the heap's point of view. They are
+ * tagged with their size class, so that rte_free() can recognize them.
+ */
+
+struct malloc_cache_class {
+	unsigned int len;
+	void *objs[MALLOC_CACHE_SIZE]; /* data pointers */
+};
+
+struct malloc_lcore_cache {
+	struct malloc_heap *heap; /* heap of the lcore's socket */
+	unsigned int nb_cached;
+	uint64_t alloc_hits;
+	uint64_t alloc_misses;
+	uint64_t free_hits;
+	uint64_t flushes;
+	struct malloc_cache_class classes[MALLOC_CACHE_NB_CLASSES];
+} __rte_cache_aligned;
+
+static struct malloc_lcore_cache lcore_caches[RTE_MAX_LCORE];
+static bool cache_enabled;
+
+static inline size_t
+class_size(unsigned int cls)
+{
+	return (size_t)1 << (MALLOC_CACHE_MIN_SIZE_LOG2 + cls);
+}
+
+static inline unsigned int
+size_to_class(size_t size)
+{
+	if (size <= class_size(0))
+		return 0;
+	return rte_log2_u64(size) - MALLOC_CACHE_MIN_SIZE_LOG2;
+}
+
+static struct malloc_lcore_cache *
+lcore_cache_get(void)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned int lcore_id = rte_lcore_id();
+	struct malloc_lcore_cache *cache;
+	int heap_id;
+
+	/* unregistered non-EAL threads have no cache */
+	if (lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	cache = &lcore_caches[lcore_id];
+	if (unlikely(cache->heap == NULL)) {
+		/* lcores spanning several sockets have no cache either */
+		heap_id = malloc_socket_to_heap_id(rte_socket_id());
+		if (heap_id < 0)
+			return NULL;
+		cache->heap = &mcfg->malloc_heaps[heap_id];
+	}
+	return cache;
+}
+
+/* Give back the n oldest elements of a class to the heap. */
+static void
+cache_flush_class(struct malloc_lcore_cache *cache,
+		struct malloc_cache_class *cls, unsigned int n)
+{
+	struct malloc_elem *elems[MALLOC_CACHE_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		elems[i] = malloc_elem_from_data(cls->objs[i]);
+	malloc_heap_free_bulk(cache->heap, elems, n);
+
+	memmove(cls->objs, &cls->objs[n], (cls->len - n) * sizeof(void *));
+	cls->len -= n;
+	cache->nb_cached -= n;
+	cache->flushes++;
+}
+
+static void
+cache_flush(struct malloc_lcore_cache *cache)
+{
+	unsigned int i;
+
+	for (i = 0; i < MALLOC_CACHE_NB_CLASSES; i++) {
+		struct malloc_cache_class *cls = &cache->classes[i];
+
+		if (cls->len != 0)
+			cache_flush_class(cache, cls, cls->len);
+	}
+}
+
+void *
+malloc_cache_alloc(size_t size, unsigned int align, int socket)
+{
+	struct malloc_lcore_cache *cache;
+	struct malloc_cache_class *cls;
+	struct malloc_elem *elem;
+	unsigned int c;
+	void *ptr;
+
+	if (size > MALLOC_CACHE_MAX_SIZE || align > RTE_CACHE_LINE_SIZE)
+		return NULL;
+
+	cache = lcore_cache_get();
+	if (cache == NULL)
+		return NULL;
+	if (unlikely(!cache_enabled)) {
+		/* give back what was cached before caches were disabled */
+		if (unlikely(cache->nb_cached != 0))
+			cache_flush(cache);
+		return NULL;
+	}
+	if (socket != SOCKET_ID_ANY &&
+			(unsigned int)socket != cache->heap->socket_id)
+		return NULL;
+
+	c = size_to_class(size);
+	cls = &cache->classes[c];
+	if (cls->len != 0) {
+		cache->alloc_hits++;
+		cache->nb_cached--;
+		ptr = cls->objs[--cls->len];
+	} else {
+		cache->alloc_misses++;
+		cls->len = malloc_heap_alloc_bulk(cache->heap, class_size(c),
+				cls->objs, MALLOC_CACHE_BATCH);
+		if (cls->len != 0) {
+			cache->nb_cached += cls->len - 1;
+			ptr = cls->objs[--cls->len];
+		} else {
+			/* the heap must grow, which the regular path does */
+			ptr = malloc_heap_alloc(NULL, class_size(c),
+					cache->heap->socket_id, 0, 1, 0, false);
+			if (ptr == NULL)
+				return NULL;
+		}
+	}
+
+	elem = malloc_elem_from_data(ptr);
+	elem->cache_class = c + 1;
+	return ptr;
+}
+
+int
+malloc_cache_free(void *ptr)
+{
+	struct malloc_elem *elem = malloc_elem_from_data(ptr);
+	struct malloc_lcore_cache *cache;
+	struct malloc_cache_class *cls;
+
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY ||
+			elem->cache_class == 0)
+		return -1;
+
+	cache = lcore_cache_get();
+	if (cache == NULL || !cache_enabled || elem->heap != cache->heap)
+		return -1;
+
+	cls = &cache->classes[elem->cache_class - 1];
+	if (cls->len == MALLOC_CACHE_SIZE)
+		cache_flush_class(cache, cls, MALLOC_CACHE_BATCH);
+
+	/* the next rte_zmalloc() of this element must clear it */
+	elem->dirty = 1;
+	cls->objs[cls->len++] = ptr;
+	cache->nb_cached++;
+	cache->free_hits++;
+	return 0;
+}
+
+int
+malloc_cache_set_enabled(bool enable)
+{
+#if defined(RTE_MALLOC_DEBUG) || defined(RTE_MALLOC_ASAN)
+	/* cached elements would escape poisoning and redzone checks */
+	if (enable)
+		return -ENOTSUP;
+#endif
+	cache_enabled = enable;
+	if (!enable)
+		malloc_cache_flush();
+	return 0;
+}
+
+void
+malloc_cache_flush(void)
+{
+	struct malloc_lcore_cache *cache = lcore_cache_get();
+
+	if (cache != NULL && cache->nb_cached != 0)
+		cache_flush(cache);
+}
+
+void
+malloc_cache_get_stats(const struct malloc_heap *heap,
+		struct rte_malloc_cache_stats *stats)
+{
+	const struct malloc_lcore_cache *cache;
+	unsigned int lcore_id, i;
+
+	memset(stats, 0, sizeof(*stats));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &lcore_caches[lcore_id];
+
+		if (cache->heap != heap)
+			continue;
+		stats->alloc_hits += cache->alloc_hits;
+		stats->alloc_misses += cache->alloc_misses;
+		stats->free_hits += cache->free_hits;
+		stats->flushes += cache->flushes;
+		stats->cached_count += cache->nb_cached;
+		for (i = 0; i < MALLOC_CACHE_NB_CLASSES; i++)
+			stats->cached_bytes +=
+				cache->classes[i].len * class_size(i);
+	}
+}
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef MALLOC_CACHE_H_
+#define MALLOC_CACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <rte_malloc.h>
+
+struct malloc_heap;
+
+/* Size classes of the per-lcore caches: 64, 128, ..., 2048 bytes. */
+#define MALLOC_CACHE_MIN_SIZE_LOG2 6
+#define MALLOC_CACHE_NB_CLASSES 6
+#define MALLOC_CACHE_MAX_SIZE \
+	(1 << (MALLOC_CACHE_MIN_SIZE_LOG2 + MALLOC_CACHE_NB_CLASSES - 1))
+
+/* Elements held per size class, and moved to or from the heap at once. */
+#define MALLOC_CACHE_SIZE 32
+#define MALLOC_CACHE_BATCH (MALLOC_CACHE_SIZE / 2)
+
+/*
+ * Allocate from the calling lcore's cache. Returns NULL if the request
+ * cannot be served by the cache, the caller then goes to the heap.
+ */
+void *
+malloc_cache_alloc(size_t size, unsigned int align, int socket);
+
+/*
+ * Put an element back into the calling lcore's cache. Returns 0 if the
+ * element was cached, -1 if the caller must free it to the heap.
+ */
+int
+malloc_cache_free(void *ptr);
+
+int
+malloc_cache_set_enabled(bool enable);
+
+/* Give back all elements cached by the calling lcore to the heap. */
+void
+malloc_cache_flush(void);
+
+void
+malloc_cache_get_stats(const struct malloc_heap *heap,
+		struct rte_malloc_cache_stats *stats);
+
+#endif /* MALLOC_CACHE_H_ */
@@ -23,6 +23,7 @@
 #include "eal_memalloc.h"
 #include "eal_memcfg.h"
 #include "eal_private.h"
+#include "malloc_cache.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 #include "malloc_mp.h"
@@ -868,6 +869,7 @@ malloc_heap_free(struct malloc_elem *elem)
 		return -1;
 
 	asan_clear_redzone(elem);
+	elem->cache_class = 0;
 
 	/* elem may be merged with previous element, so keep heap address */
 	heap = elem->heap;
@@ -1038,6 +1040,49 @@ free_unlock:
 	return ret;
 }
 
+/*
+ * Allocate up to n elements of the same size for the lcore caches, taking
+ * the heap lock once. The heap is not grown, so fewer elements may be
+ * returned.
+ */
+unsigned int
+malloc_heap_alloc_bulk(struct malloc_heap *heap, size_t size, void **objs,
+		unsigned int n)
+{
+	unsigned int i;
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i < n; i++) {
+		objs[i] = heap_alloc(heap, NULL, size, 0, 1, 0, false);
+		if (objs[i] == NULL)
+			break;
+	}
+	rte_spinlock_unlock(&heap->lock);
+
+	return i;
+}
+
+/*
+ * Free a batch of small elements from the lcore caches, taking the heap
+ * lock once. Unlike malloc_heap_free(), no page is given back to the
+ * system here: that is left to a later malloc_heap_free() merging with
+ * the freed space.
+ */
+void
+malloc_heap_free_bulk(struct malloc_heap *heap, struct malloc_elem **elems,
+		unsigned int n)
+{
+	unsigned int i;
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i < n; i++) {
+		elems[i]->cache_class = 0;
+		elems[i]->state = ELEM_FREE;
+		malloc_elem_free(elems[i]);
+	}
+	rte_spinlock_unlock(&heap->lock);
+}
+
 int
 malloc_heap_resize(struct malloc_elem *elem, size_t size)
 {
@@ -1397,6 +1442,11 @@ rte_eal_malloc_heap_init(void)
 	 */
 	rte_mcfg_mem_read_unlock();
 
+	/* lcore caches are private to each process */
+	if (internal_conf->malloc_cache &&
+			malloc_cache_set_enabled(true) < 0)
+		RTE_LOG(WARNING, EAL, "Malloc lcore caches are not supported in this build\n");
+
 	/* secondary process does not need to initialize anything */
 	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
 		return 0;
@@ -2,6 +2,7 @@
  * Copyright(c) 2010-2019 Intel Corporation
  */
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -19,6 +20,7 @@
 #include <rte_eal_trace.h>
 
 #include <rte_malloc.h>
+#include "malloc_cache.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 #include "eal_memalloc.h"
@@ -34,6 +36,8 @@ mem_free(void *addr, const bool trace_ena)
 		rte_eal_trace_mem_free(addr);
 
 	if (addr == NULL) return;
+	if (malloc_cache_free(addr) == 0)
+		return;
 	if (malloc_heap_free(malloc_elem_from_data(addr)) < 0)
 		RTE_LOG(ERR, EAL, "Error: Invalid memory\n");
 }
@@ -69,8 +73,10 @@ malloc_socket(const char *type, size_t size, unsigned int align,
 				!rte_eal_has_hugepages())
 		socket_arg = SOCKET_ID_ANY;
 
-	ptr = malloc_heap_alloc(type, size, socket_arg, 0,
-			align == 0 ? 1 : align, 0, false);
+	ptr = malloc_cache_alloc(size, align, socket_arg);
+	if (ptr == NULL)
+		ptr = malloc_heap_alloc(type, size, socket_arg, 0,
+				align == 0 ? 1 : align, 0, false);
 
 	if (trace_ena)
 		rte_eal_trace_mem_malloc(type, size, align, socket_arg, ptr);
@@ -177,6 +183,9 @@ rte_realloc_socket(void *ptr, size_t size, unsigned int align, int socket)
 
 	user_size = size;
 
+	/* a resized element no longer fits its cache size class */
+	elem->cache_class = 0;
+
 	size = RTE_CACHE_LINE_ROUNDUP(size), align = RTE_CACHE_LINE_ROUNDUP(align);
 
 	/* check requested socket id and alignment matches first, and if ok,
@@ -247,6 +256,32 @@ rte_malloc_get_socket_stats(int socket,
 			socket_stats);
 }
 
+int
+rte_malloc_cache_enable(bool enable)
+{
+	return malloc_cache_set_enabled(enable);
+}
+
+void
+rte_malloc_cache_flush(void)
+{
+	malloc_cache_flush();
+}
+
+int
+rte_malloc_get_cache_stats(int socket, struct rte_malloc_cache_stats *stats)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	int heap_idx;
+
+	heap_idx = malloc_socket_to_heap_id(socket);
+	if (heap_idx < 0)
+		return -1;
+
+	malloc_cache_get_stats(&mcfg->malloc_heaps[heap_idx], stats);
+	return 0;
+}
+
 /*
  * Function to dump contents of all heaps
  */
@@ -332,12 +367,14 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
 	unsigned int heap_id;
 	struct rte_malloc_socket_stats sock_stats;
+	struct rte_malloc_cache_stats cache_stats;
 
 	/* Iterate through all initialised heaps */
 	for (heap_id = 0; heap_id < RTE_MAX_HEAPS; heap_id++) {
 		struct malloc_heap *heap = &mcfg->malloc_heaps[heap_id];
 
 		malloc_heap_get_stats(heap, &sock_stats);
+		malloc_cache_get_stats(heap, &cache_stats);
 
 		fprintf(f, "Heap id:%u\n", heap_id);
 		fprintf(f, "\tHeap name:%s\n", heap->name);
@@ -348,6 +385,15 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 				sock_stats.greatest_free_size);
 		fprintf(f, "\tAlloc_count:%u,\n",sock_stats.alloc_count);
 		fprintf(f, "\tFree_count:%u,\n", sock_stats.free_count);
+		fprintf(f, "\tCache_count:%u,\n", cache_stats.cached_count);
+		fprintf(f, "\tCache_size:%zu,\n", cache_stats.cached_bytes);
+		fprintf(f, "\tCache_alloc_hits:%"PRIu64",\n",
+				cache_stats.alloc_hits);
+		fprintf(f, "\tCache_alloc_misses:%"PRIu64",\n",
+				cache_stats.alloc_misses);
+		fprintf(f, "\tCache_free_hits:%"PRIu64",\n",
+				cache_stats.free_hits);
+		fprintf(f, "\tCache_flushes:%"PRIu64",\n", cache_stats.flushes);
 	}
 	return;
 }
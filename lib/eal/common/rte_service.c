@@ -13,7 +13,9 @@
 #include <rte_common.h>
 #include <rte_cycles.h>
 #include <rte_atomic.h>
+#include <rte_cpuflags.h>
 #include <rte_malloc.h>
+#include <rte_power_intrinsics.h>
 #include <rte_spinlock.h>
 
 #include "eal_private.h"
@@ -28,6 +30,11 @@
 #define RUNSTATE_STOPPED 0
 #define RUNSTATE_RUNNING 1
 
+/* consecutive idle runner loops before an lcore may enter a power
+ * optimized state, see rte_service_lcore_idle_policy_set()
+ */
+#define SERVICE_IDLE_LOOPS_MAX 512
+
 /* internal representation of a service */
 struct rte_service_spec_impl {
 	/* public part of the struct */
@@ -52,6 +59,9 @@ struct rte_service_spec_impl {
 	uint32_t num_mapped_cores;
 	uint64_t calls;
 	uint64_t cycles_spent;
+
+	/* optional callback providing the address to monitor while idle */
+	rte_service_monitor_func monitor;
 } __rte_cache_aligned;
 
 /* the internal values of a service core */
@@ -64,12 +74,26 @@ struct core_state {
 	uint8_t service_active_on_lcore[RTE_SERVICE_NUM_MAX];
 	uint64_t loops;
 	uint64_t calls_per_service[RTE_SERVICE_NUM_MAX];
+
+	/* idle policy, one of RTE_SERVICE_LCORE_IDLE_* */
+	uint32_t idle_policy;
+	/* upper bound of a single power optimized sleep, in TSC cycles */
+	uint64_t idle_sleep_tsc;
+	/* consecutive loops in which no mapped service reported work */
+	uint64_t idle_loops;
+	/* idle statistics */
+	uint64_t idle_sleeps;
+	uint64_t idle_cycles;
+	uint64_t timed_wakeups;
+	uint64_t wakeup_latency;
+	uint64_t wakeup_latency_max;
 } __rte_cache_aligned;
 
 static uint32_t rte_service_count;
 static struct rte_service_spec_impl *rte_services;
 static struct core_state *lcore_states;
 static uint32_t rte_service_library_initialized;
+static struct rte_cpu_intrinsics service_intrinsics;
 
 int32_t
 rte_service_init(void)
@@ -96,6 +120,8 @@ rte_service_init(void)
 		goto fail_mem;
 	}
 
+	rte_cpu_get_intrinsics_support(&service_intrinsics);
+
 	int i;
 	int count = 0;
 	struct rte_config *cfg = rte_eal_get_configuration();
@@ -288,6 +314,18 @@ rte_service_component_unregister(uint32_t id)
 	return 0;
 }
 
+int32_t
+rte_service_component_monitor_set(uint32_t id,
+		rte_service_monitor_func monitor)
+{
+	struct rte_service_spec_impl *s;
+	SERVICE_VALID_GET_OR_ERR_RET(id, s, -EINVAL);
+
+	s->monitor = monitor;
+
+	return 0;
+}
+
 int32_t
 rte_service_component_runstate_set(uint32_t id, uint32_t runstate)
 {
@@ -353,25 +391,30 @@ rte_service_runstate_get(uint32_t id)
 
 }
 
-static inline void
+static inline int32_t
 service_runner_do_callback(struct rte_service_spec_impl *s,
 			   struct core_state *cs, uint32_t service_idx)
 {
 	void *userdata = s->spec.callback_userdata;
+	int32_t ret;
 
 	if (service_stats_enabled(s)) {
 		uint64_t start = rte_rdtsc();
-		s->spec.callback(userdata);
+		ret = s->spec.callback(userdata);
 		uint64_t end = rte_rdtsc();
 		s->cycles_spent += end - start;
 		cs->calls_per_service[service_idx]++;
 		s->calls++;
 	} else
-		s->spec.callback(userdata);
+		ret = s->spec.callback(userdata);
+
+	return ret;
 }
 
 
-/* Expects the service 's' is valid. */
+/* Expects the service 's' is valid. Returns -EAGAIN if the service callback
+ * reported that it had no work to do.
+ */
 static int32_t
 service_run(uint32_t i, struct core_state *cs, uint64_t service_mask,
 	    struct rte_service_spec_impl *s, uint32_t serialize_mt_unsafe)
@@ -394,16 +437,17 @@ service_run(uint32_t i, struct core_state *cs, uint64_t service_mask,
 
 	cs->service_active_on_lcore[i] = 1;
 
+	int32_t ret;
 	if ((service_mt_safe(s) == 0) && (serialize_mt_unsafe == 1)) {
 		if (!rte_spinlock_trylock(&s->execute_lock))
 			return -EBUSY;
 
-		service_runner_do_callback(s, cs, i);
+		ret = service_runner_do_callback(s, cs, i);
 		rte_spinlock_unlock(&s->execute_lock);
 	} else
-		service_runner_do_callback(s, cs, i);
+		ret = service_runner_do_callback(s, cs, i);
 
-	return 0;
+	return ret == -EAGAIN ? -EAGAIN : 0;
 }
 
 int32_t
@@ -441,7 +485,91 @@ rte_service_run_iter_on_app_lcore(uint32_t id, uint32_t serialize_mt_unsafe)
 
 	__atomic_sub_fetch(&s->num_mapped_cores, 1, __ATOMIC_RELAXED);
 
-	return ret;
+	/* an idle iteration is still a successful run for the caller */
+	return ret == -EAGAIN ? 0 : ret;
+}
+
+static int
+service_runstate_changed(const uint64_t val,
+		const uint64_t opaque[RTE_POWER_MONITOR_OPAQUE_SZ])
+{
+	/* abort the sleep as soon as the lcore is asked to stop */
+	return val != opaque[0] ? -1 : 0;
+}
+
+/* Gather the monitor conditions of all services mapped to this lcore.
+ * Returns the number of conditions, or -1 if a mapped service cannot provide
+ * one, in which case the lcore has to pause instead.
+ */
+static int
+service_get_monitor_conds(struct core_state *cs, uint64_t service_mask,
+		struct rte_power_monitor_cond *pmc)
+{
+	uint32_t i;
+	int n = 0;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		struct rte_service_spec_impl *s = service_get(i);
+
+		if (!service_valid(i) || !(service_mask & (UINT64_C(1) << i)) ||
+				!cs->service_active_on_lcore[i])
+			continue;
+		if (s->monitor == NULL ||
+				s->monitor(s->spec.callback_userdata,
+					&pmc[n]) != 0)
+			return -1;
+		n++;
+	}
+
+	return n;
+}
+
+static void
+service_lcore_sleep(struct core_state *cs, uint64_t service_mask)
+{
+	struct rte_power_monitor_cond pmc[RTE_SERVICE_NUM_MAX + 1];
+	const uint64_t start = rte_rdtsc();
+	const uint64_t deadline = start + cs->idle_sleep_tsc;
+	int n = -1;
+
+	if (cs->idle_policy == RTE_SERVICE_LCORE_IDLE_MONITOR &&
+			service_intrinsics.power_monitor)
+		n = service_get_monitor_conds(cs, service_mask, pmc);
+
+	if (n > 0 && service_intrinsics.power_monitor_multi) {
+		/* also wake up when rte_service_lcore_stop() is called */
+		pmc[n].addr = &cs->runstate;
+		pmc[n].size = sizeof(cs->runstate);
+		pmc[n].fn = service_runstate_changed;
+		pmc[n].opaque[0] = RUNSTATE_RUNNING;
+		rte_power_monitor_multi(pmc, n + 1, deadline);
+	} else if (n == 1) {
+		/* stop and remap wake us with rte_power_monitor_wakeup() */
+		rte_power_monitor(&pmc[0], deadline);
+	} else if (service_intrinsics.power_pause) {
+		rte_power_pause(deadline);
+	} else {
+		while (rte_rdtsc() < deadline &&
+				__atomic_load_n(&cs->runstate,
+					__ATOMIC_RELAXED) == RUNSTATE_RUNNING)
+			rte_pause();
+	}
+
+	const uint64_t end = rte_rdtsc();
+
+	cs->idle_sleeps++;
+	cs->idle_cycles += end - start;
+	/* a sleep that ran into its deadline tells us how long the lcore
+	 * took to leave the power optimized state
+	 */
+	if (end >= deadline) {
+		const uint64_t latency = end - deadline;
+
+		cs->timed_wakeups++;
+		cs->wakeup_latency += latency;
+		if (latency > cs->wakeup_latency_max)
+			cs->wakeup_latency_max = latency;
+	}
 }
 
 static int32_t
@@ -461,15 +589,28 @@ service_runner_func(void *arg)
 	while (__atomic_load_n(&cs->runstate, __ATOMIC_ACQUIRE) ==
 			RUNSTATE_RUNNING) {
 		const uint64_t service_mask = cs->service_mask;
+		uint32_t busy = 0;
 
 		for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
 			if (!service_valid(i))
 				continue;
-			/* return value ignored as no change to code flow */
-			service_run(i, cs, service_mask, service_get(i), 1);
+			/* only a callback that did work keeps the lcore busy */
+			busy |= (service_run(i, cs, service_mask,
+					service_get(i), 1) == 0);
 		}
 
 		cs->loops++;
+
+		if (cs->idle_policy == RTE_SERVICE_LCORE_IDLE_POLL)
+			continue;
+
+		if (busy) {
+			cs->idle_loops = 0;
+			continue;
+		}
+
+		if (++cs->idle_loops > SERVICE_IDLE_LOOPS_MAX)
+			service_lcore_sleep(cs, service_mask);
 	}
 
 	/* Use SEQ CST memory ordering to avoid any re-ordering around
@@ -604,6 +745,11 @@ service_update(uint32_t sid, uint32_t lcore, uint32_t *set, uint32_t *enabled)
 			__atomic_sub_fetch(&rte_services[sid].num_mapped_cores,
 				1, __ATOMIC_RELAXED);
 		}
+
+		/* make an idle lcore pick up the new mapping */
+		if (lcore_states[lcore].idle_policy ==
+				RTE_SERVICE_LCORE_IDLE_MONITOR)
+			rte_power_monitor_wakeup(lcore);
 	}
 
 	if (enabled)
@@ -679,6 +825,7 @@ rte_service_lcore_add(uint32_t lcore)
 
 	/* ensure that after adding a core the mask and state are defaults */
 	lcore_states[lcore].service_mask = 0;
+	lcore_states[lcore].idle_policy = RTE_SERVICE_LCORE_IDLE_POLL;
 	/* Use store-release memory order here to synchronize with
 	 * load-acquire in runstate read functions.
 	 */
@@ -780,6 +927,50 @@ rte_service_lcore_stop(uint32_t lcore)
 	__atomic_store_n(&lcore_states[lcore].runstate, RUNSTATE_STOPPED,
 		__ATOMIC_RELEASE);
 
+	if (lcore_states[lcore].idle_policy == RTE_SERVICE_LCORE_IDLE_MONITOR)
+		rte_power_monitor_wakeup(lcore);
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_idle_policy_set(uint32_t lcore, uint32_t policy,
+		uint64_t max_sleep_us)
+{
+	struct core_state *cs;
+
+	if (lcore >= RTE_MAX_LCORE || max_sleep_us == 0)
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	if (!cs->is_service_core)
+		return -ENOTSUP;
+
+	switch (policy) {
+	case RTE_SERVICE_LCORE_IDLE_POLL:
+		break;
+	case RTE_SERVICE_LCORE_IDLE_PAUSE:
+		break;
+	case RTE_SERVICE_LCORE_IDLE_MONITOR:
+		if (!service_intrinsics.power_monitor)
+			return -ENOTSUP;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* runstate act as the guard variable. Use load-acquire
+	 * memory order here to synchronize with store-release
+	 * in runstate update functions.
+	 */
+	if (__atomic_load_n(&cs->runstate, __ATOMIC_ACQUIRE) !=
+			RUNSTATE_STOPPED)
+		return -EBUSY;
+
+	cs->idle_sleep_tsc = max_sleep_us * rte_get_tsc_hz() / US_PER_S;
+	cs->idle_loops = 0;
+	cs->idle_policy = policy;
+
 	return 0;
 }
 
@@ -821,6 +1012,21 @@ rte_service_lcore_attr_get(uint32_t lcore, uint32_t attr_id,
 	case RTE_SERVICE_LCORE_ATTR_LOOPS:
 		*attr_value = cs->loops;
 		return 0;
+	case RTE_SERVICE_LCORE_ATTR_IDLE_SLEEPS:
+		*attr_value = cs->idle_sleeps;
+		return 0;
+	case RTE_SERVICE_LCORE_ATTR_IDLE_CYCLES:
+		*attr_value = cs->idle_cycles;
+		return 0;
+	case RTE_SERVICE_LCORE_ATTR_TIMED_WAKEUPS:
+		*attr_value = cs->timed_wakeups;
+		return 0;
+	case RTE_SERVICE_LCORE_ATTR_WAKEUP_LATENCY:
+		*attr_value = cs->wakeup_latency;
+		return 0;
+	case RTE_SERVICE_LCORE_ATTR_WAKEUP_LATENCY_MAX:
+		*attr_value = cs->wakeup_latency_max;
+		return 0;
 	default:
 		return -EINVAL;
 	}
@@ -850,6 +1056,11 @@ rte_service_lcore_attr_reset_all(uint32_t lcore)
 		return -ENOTSUP;
 
 	cs->loops = 0;
+	cs->idle_sleeps = 0;
+	cs->idle_cycles = 0;
+	cs->timed_wakeups = 0;
+	cs->wakeup_latency = 0;
+	cs->wakeup_latency_max = 0;
 
 	return 0;
 }
@@ -883,6 +1094,20 @@ service_dump_calls_per_lcore(FILE *f, uint32_t lcore)
 	fprintf(f, "\n");
 }
 
+static void
+service_dump_idle_per_lcore(FILE *f, uint32_t lcore)
+{
+	struct core_state *cs = &lcore_states[lcore];
+	/* avoid divide by zero */
+	uint64_t wakeups = cs->timed_wakeups ? cs->timed_wakeups : 1;
+
+	fprintf(f, "%02d\tpolicy %u\tsleeps %"PRIu64"\tcycles %"PRIu64
+			"\twakeup avg: %"PRIu64"\tmax: %"PRIu64"\n",
+			lcore, cs->idle_policy, cs->idle_sleeps,
+			cs->idle_cycles, cs->wakeup_latency / wakeups,
+			cs->wakeup_latency_max);
+}
+
 int32_t
 rte_service_dump(FILE *f, uint32_t id)
 {
@@ -914,5 +1139,15 @@ rte_service_dump(FILE *f, uint32_t id)
 		service_dump_calls_per_lcore(f, i);
 	}
 
+	fprintf(f, "Service Cores Idle Summary\n");
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (lcore_config[i].core_role != ROLE_SERVICE ||
+				lcore_states[i].idle_policy ==
+					RTE_SERVICE_LCORE_IDLE_POLL)
+			continue;
+
+		service_dump_idle_per_lcore(f, i);
+	}
+
 	return 0;
 }
@@ -604,6 +604,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_start();
+
 	thread_id = pthread_self();
 
 	eal_reset_internal_config(internal_conf);
@@ -716,6 +718,8 @@ rte_eal_init(int argc, char **argv)
 	RTE_LOG(INFO, EAL, "Selected IOVA mode '%s'\n",
 		rte_eal_iova_mode() == RTE_IOVA_PA ? "PA" : "VA");
 
+	eal_init_timing_mark("setup");
+
 	if (internal_conf->no_hugetlbfs == 0) {
 		/* rte_config isn't initialized yet */
 		ret = internal_conf->process_type == RTE_PROC_PRIMARY ?
@@ -729,6 +733,8 @@ rte_eal_init(int argc, char **argv)
 		}
 	}
 
+	eal_init_timing_mark("hugepage_info");
+
 	if (internal_conf->memory == 0 && internal_conf->force_sockets == 0) {
 		if (internal_conf->no_hugetlbfs)
 			internal_conf->memory = MEMSIZE_IF_NO_HUGE_PAGE;
@@ -763,12 +769,16 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_mark("memory");
+
 	if (rte_eal_malloc_heap_init() < 0) {
 		rte_eal_init_alert("Cannot init malloc heap");
 		rte_errno = ENODEV;
 		return -1;
 	}
 
+	eal_init_timing_mark("malloc_heap");
+
 	if (rte_eal_tailqs_init() < 0) {
 		rte_eal_init_alert("Cannot init tail queues for objects");
 		rte_errno = EFAULT;
@@ -835,6 +845,8 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MAIN);
 	rte_eal_mp_wait_lcore();
 
+	eal_init_timing_mark("lcores");
+
 	/* initialize services so vdevs register service during bus_probe. */
 	ret = rte_service_init();
 	if (ret) {
@@ -850,6 +862,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_mark("bus_probe");
+
 	/* initialize default service/lcore mappings and start running. Ignore
 	 * -ENOTSUP, as it indicates no service coremask passed to EAL.
 	 */
@@ -884,8 +898,17 @@ rte_eal_init(int argc, char **argv)
 			return -1;
 	}
 
+	if (eal_trace_stream_init() < 0) {
+		rte_eal_init_alert("Cannot init trace streaming");
+		rte_errno = EFAULT;
+		return -1;
+	}
+
 	eal_mcfg_complete();
 
+	eal_init_timing_mark("finish");
+	eal_init_timing_dump();
+
 	return fctret;
 }
 
@@ -894,13 +917,16 @@ rte_eal_cleanup(void)
 {
 	struct internal_config *internal_conf =
 		eal_get_internal_configuration();
+	/* stop streaming while the trace memory is still there */
+	eal_trace_stream_fini();
 	rte_service_finalize();
 	rte_mp_channel_cleanup();
+	/* the trace memory may be in the memory detached below */
+	rte_trace_save();
+	eal_trace_fini();
 	/* after this point, any DPDK pointers will become dangling */
 	rte_eal_memory_detach();
 	rte_eal_alarm_cleanup();
-	rte_trace_save();
-	eal_trace_fini();
 	eal_cleanup_config(internal_conf);
 	return 0;
 }
@@ -111,6 +111,59 @@ rte_mov256(uint8_t *dst, const uint8_t *src);
 static void *
 rte_memcpy(void *dst, const void *src, size_t n);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Copy bytes from one location to another using non-temporal stores,
+ * which do not bring the destination into the CPU caches. This avoids
+ * evicting other data when copying large buffers that are not read
+ * again soon by the same core. The locations must not overlap.
+ *
+ * There is no alignment requirement. The destination bytes before the
+ * first and after the last full cache line are copied with rte_memcpy(),
+ * as well as copies shorter than two cache lines.
+ *
+ * On x86, streaming stores are weakly ordered, so the function ends with
+ * a store fence: the copied data is visible before any later store, as
+ * after rte_memcpy(). On 64-bit Arm, non-temporal store pairs are used,
+ * which follow the regular memory ordering rules. Other architectures
+ * fall back to rte_memcpy().
+ *
+ * @param dst
+ *   Pointer to the destination of the data.
+ * @param src
+ *   Pointer to the source data.
+ * @param n
+ *   Number of bytes to copy.
+ * @return
+ *   Pointer to the destination data.
+ */
+__rte_experimental
+static void *
+rte_memcpy_nt(void *dst, const void *src, size_t n);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Copy bytes from one location to another, using rte_memcpy_nt() if at
+ * least RTE_MEMCPY_NT_THRESHOLD bytes are copied, rte_memcpy() otherwise.
+ * The locations must not overlap.
+ *
+ * @param dst
+ *   Pointer to the destination of the data.
+ * @param src
+ *   Pointer to the source data.
+ * @param n
+ *   Number of bytes to copy.
+ * @return
+ *   Pointer to the destination data.
+ */
+__rte_experimental
+static void *
+rte_memcpy_nt_auto(void *dst, const void *src, size_t n);
+
 #endif /* __DOXYGEN__ */
 
 #endif /* _RTE_MEMCPY_H_ */
@@ -384,6 +384,9 @@ int rte_thread_getname(pthread_t id, char *name, size_t len);
  *   non-EAL thread from either primary or secondary processes will always end
  *   up with the thread getting LCORE_ID_ANY as lcore.
  *
+ * The lcore is released when the thread exits, if rte_thread_unregister()
+ * was not called before.
+ *
  * @return
  *   On success, return 0; otherwise return -1 with rte_errno set.
  */
@@ -11,6 +11,7 @@
  * from hugepages.
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stddef.h>
 #include <rte_compat.h>
@@ -299,6 +300,78 @@ int
 rte_malloc_get_socket_stats(int socket,
 		struct rte_malloc_socket_stats *socket_stats);
 
+/**
+ * Structure to hold the statistics of the lcore caches of a heap, obtained
+ * from rte_malloc_get_cache_stats function.
+ */
+struct rte_malloc_cache_stats {
+	uint64_t alloc_hits;   /**< Allocations served by an lcore cache */
+	uint64_t alloc_misses; /**< Allocations that refilled an lcore cache */
+	uint64_t free_hits;    /**< Frees kept in an lcore cache */
+	uint64_t flushes;      /**< Batches given back to the heap */
+	unsigned int cached_count; /**< Free elements held in lcore caches */
+	size_t cached_bytes;   /**< Total size of these elements */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable or disable the per-lcore caches of small allocations.
+ *
+ * When enabled, allocations of up to 2 KB with an alignment of at most a
+ * cache line, made by an lcore on its own socket or on any socket, are
+ * served from a per-lcore cache of free elements. The cache is refilled
+ * from, and flushed to, the heap of the lcore's socket in batches, so the
+ * heap lock is taken once per batch rather than once per call.
+ *
+ * Elements held in the caches are counted as allocated in the heap
+ * statistics. They are reported by rte_malloc_get_cache_stats().
+ *
+ * Caches are disabled by default, or enabled with the ``--malloc-cache``
+ * EAL option. When caches are disabled, the calling lcore's cache is
+ * flushed right away, other lcores flush theirs on their next allocation.
+ *
+ * @param enable
+ *   true to enable the caches, false to disable them.
+ * @return
+ *   0 on success, -ENOTSUP if caches are not supported by this build
+ *   (malloc debug or ASan).
+ */
+__rte_experimental
+int
+rte_malloc_cache_enable(bool enable);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Give back all elements cached by the calling lcore to the heap.
+ *
+ * This can be called by an lcore that will stop allocating memory, so that
+ * its cached elements can be used by other lcores.
+ */
+__rte_experimental
+void
+rte_malloc_cache_flush(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of the lcore caches of the specified heap.
+ *
+ * @param socket
+ *   Socket of the heap to get cache statistics for.
+ * @param stats
+ *   A structure to store the statistics into.
+ * @return
+ *   0 on success, -1 if the socket is invalid.
+ */
+__rte_experimental
+int
+rte_malloc_get_cache_stats(int socket, struct rte_malloc_cache_stats *stats);
+
 /**
  * Add memory chunk to a heap with specified name.
  *
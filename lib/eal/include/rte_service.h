@@ -261,6 +261,49 @@ int32_t rte_service_lcore_start(uint32_t lcore_id);
  */
 int32_t rte_service_lcore_stop(uint32_t lcore_id);
 
+/** Service lcore keeps polling its services when they are idle (default). */
+#define RTE_SERVICE_LCORE_IDLE_POLL 0
+
+/**
+ * Service lcore enters a power optimized pause state when all services mapped
+ * to it are idle. Uses TPAUSE when available, else *rte_pause* in a loop.
+ */
+#define RTE_SERVICE_LCORE_IDLE_PAUSE 1
+
+/**
+ * Service lcore monitors the addresses exported by its services when all of
+ * them are idle, and wakes up as soon as one of them is written to. If any
+ * mapped service does not export a monitor address, the lcore pauses instead.
+ */
+#define RTE_SERVICE_LCORE_IDLE_MONITOR 2
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Set the policy a service core applies when its services are idle.
+ *
+ * A service reports that it is idle by returning -EAGAIN from its callback.
+ * Once every service mapped to *lcore* has been idle for a number of
+ * consecutive iterations, the service core enters a power optimized state
+ * for at most *max_sleep_us* microseconds, which bounds the latency of
+ * picking up work a service cannot signal through a monitor address.
+ *
+ * The service core must be stopped while its idle policy is changed.
+ *
+ * @param lcore Id of the service core.
+ * @param policy One of the RTE_SERVICE_LCORE_IDLE_* policies.
+ * @param max_sleep_us Upper bound of a single sleep, in microseconds.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid *lcore*, *policy* or *max_sleep_us* provided.
+ * @retval -ENOTSUP *lcore* is not a service core, or *policy* is not
+ *          supported by this CPU.
+ * @retval -EBUSY The service core is running, stop it first.
+ */
+__rte_experimental
+int32_t rte_service_lcore_idle_policy_set(uint32_t lcore, uint32_t policy,
+		uint64_t max_sleep_us);
+
 /**
  * Reports if a service lcore is currently running.
  *
@@ -407,6 +450,36 @@ int32_t rte_service_attr_reset_all(uint32_t id);
  */
 #define RTE_SERVICE_LCORE_ATTR_LOOPS 0
 
+/**
+ * Returns the number of times the service core entered a power optimized
+ * state because all of its services were idle.
+ */
+#define RTE_SERVICE_LCORE_ATTR_IDLE_SLEEPS 1
+
+/**
+ * Returns the number of cycles the service core spent in a power optimized
+ * state.
+ */
+#define RTE_SERVICE_LCORE_ATTR_IDLE_CYCLES 2
+
+/**
+ * Returns the number of sleeps that lasted until their deadline, rather
+ * than being cut short by a write to a monitored address.
+ */
+#define RTE_SERVICE_LCORE_ATTR_TIMED_WAKEUPS 3
+
+/**
+ * Returns the sum of the wake-up latencies, in cycles, of the sleeps counted
+ * by RTE_SERVICE_LCORE_ATTR_TIMED_WAKEUPS. The wake-up latency of a sleep is
+ * the time between its deadline and the service core resuming work.
+ */
+#define RTE_SERVICE_LCORE_ATTR_WAKEUP_LATENCY 4
+
+/**
+ * Returns the largest wake-up latency observed, in cycles.
+ */
+#define RTE_SERVICE_LCORE_ATTR_WAKEUP_LATENCY_MAX 5
+
 /**
  * Get an attribute from a service core.
  *
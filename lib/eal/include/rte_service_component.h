@@ -15,13 +15,31 @@ extern "C" {
 #endif
 
 #include <rte_compat.h>
+#include <rte_power_intrinsics.h>
 #include <rte_service.h>
 
 /**
  * Signature of callback function to run a service.
+ *
+ * The callback may return -EAGAIN to indicate that it found no work to do,
+ * which allows service cores to apply their idle policy, see
+ * *rte_service_lcore_idle_policy_set*.
  */
 typedef int32_t (*rte_service_func)(void *args);
 
+/**
+ * Signature of callback function to get the address a service core should
+ * monitor while the service is idle. A write to that address must indicate
+ * that the service has new work to do.
+ *
+ * @param args The userdata pointer provided to the service callback.
+ * @param[out] pmc The monitoring condition to fill in.
+ * @retval 0 The monitoring condition was filled in.
+ * @retval <0 The service cannot be monitored at this time.
+ */
+typedef int32_t (*rte_service_monitor_func)(void *args,
+		struct rte_power_monitor_cond *pmc);
+
 /**
  * The specification of a service.
  *
@@ -87,6 +105,25 @@ int32_t rte_service_component_register(const struct rte_service_spec *spec,
  */
 int32_t rte_service_component_unregister(uint32_t id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Set the callback that provides the monitor address of a service.
+ *
+ * Service cores using the RTE_SERVICE_LCORE_IDLE_MONITOR idle policy call
+ * *monitor* once all of their services are idle, and sleep until one of the
+ * returned addresses is written to.
+ *
+ * @param id The id of the service
+ * @param monitor The callback, or NULL to remove a previously set one.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid service id
+ */
+__rte_experimental
+int32_t rte_service_component_monitor_set(uint32_t id,
+		rte_service_monitor_func monitor);
+
 /**
  * Private function to allow EAL to initialized default mappings.
  *
@@ -106,6 +106,9 @@ int rte_trace_regexp(const char *regex, bool enable);
  * By default, trace directory will be created at $HOME directory and this can
  * be overridden by --trace-dir EAL parameter.
  *
+ * When the trace is streamed (--trace-stream EAL parameter), this only
+ * flushes the events which are not streamed yet.
+ *
  * @return
  *   - 0: Success.
  *   - <0 : Failure.
@@ -134,6 +137,21 @@ int rte_trace_metadata_dump(FILE *f);
 __rte_experimental
 void rte_trace_dump(FILE *f);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the number of trace events dropped by all threads.
+ *
+ * Events are dropped when the trace buffer of a thread is full, in discard
+ * mode, or when the events are streamed faster than they are drained.
+ *
+ * @return
+ *   The number of dropped events.
+ */
+__rte_experimental
+uint64_t rte_trace_events_dropped(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,7 @@ _tp _args \
 { \
 	__rte_trace_point_emit_header_##_mode(&__##_tp); \
 	__VA_ARGS__ \
+	__rte_trace_point_emit_commit(); \
 }
 
 /**
@@ -289,12 +290,66 @@ struct __rte_trace_stream_header {
 struct __rte_trace_header {
 	uint32_t offset;
 	uint32_t len;
+	uint32_t stream;   /* non-zero if drained by the streaming thread */
+	uint32_t commit;   /* streaming: end of the last complete event */
+	uint32_t consumed; /* streaming: start of the events not drained yet */
+	uint32_t wrap;     /* streaming: end of the events before the wrap */
+	uint64_t dropped;  /* events dropped for lack of room */
 	struct __rte_trace_stream_header stream_header;
 	uint8_t mem[];
 };
 
 RTE_DECLARE_PER_LCORE(void *, trace_mem);
 
+/*
+ * In streaming mode, the trace memory is a ring shared with the streaming
+ * thread: an event never overwrites events which are not drained yet, it
+ * is dropped instead. Events are published by __rte_trace_mem_commit().
+ */
+static __rte_always_inline void *
+__rte_trace_mem_stream_get(struct __rte_trace_header *trace, uint16_t sz)
+{
+	uint32_t consumed = __atomic_load_n(&trace->consumed, __ATOMIC_ACQUIRE);
+	uint32_t offset = RTE_ALIGN_CEIL(trace->offset,
+		__RTE_TRACE_EVENT_HEADER_SZ);
+	/* an event ending at consumed would make the ring look empty */
+	uint32_t asz = RTE_ALIGN_CEIL(sz, __RTE_TRACE_EVENT_HEADER_SZ);
+
+	/* offset == consumed means that there is nothing to drain */
+	if (offset >= consumed) {
+		if (unlikely(offset + asz >= trace->len)) {
+			if (unlikely(asz >= consumed))
+				goto drop;
+			/* the streaming thread drains up to here, then from 0 */
+			trace->wrap = offset;
+			offset = 0;
+		}
+	} else if (unlikely(offset + asz >= consumed)) {
+		goto drop;
+	}
+
+	trace->offset = offset + sz;
+	return RTE_PTR_ADD(&trace->mem[0], offset);
+
+drop:
+	trace->dropped++;
+	return NULL;
+}
+
+static __rte_always_inline void
+__rte_trace_mem_commit(void)
+{
+	struct __rte_trace_header *trace =
+		(struct __rte_trace_header *)(RTE_PER_LCORE(trace_mem));
+
+	/* publish the event to the streaming thread */
+	if (unlikely(trace->stream))
+		__atomic_store_n(&trace->commit,
+			RTE_ALIGN_CEIL(trace->offset,
+				__RTE_TRACE_EVENT_HEADER_SZ),
+			__ATOMIC_RELEASE);
+}
+
 static __rte_always_inline void *
 __rte_trace_mem_get(uint64_t in)
 {
@@ -309,12 +364,16 @@ __rte_trace_mem_get(uint64_t in)
 		if (unlikely(trace == NULL))
 			return NULL;
 	}
+	if (unlikely(trace->stream))
+		return __rte_trace_mem_stream_get(trace, sz);
 	/* Check the wrap around case */
 	uint32_t offset = trace->offset;
 	if (unlikely((offset + sz) >= trace->len)) {
 		/* Disable the trace event if it in DISCARD mode */
-		if (unlikely(in & __RTE_TRACE_FIELD_ENABLE_DISCARD))
+		if (unlikely(in & __RTE_TRACE_FIELD_ENABLE_DISCARD)) {
+			trace->dropped++;
 			return NULL;
+		}
 
 		offset = 0;
 	}
@@ -360,6 +419,8 @@ do { \
 		return; \
 	__rte_trace_point_emit_header_generic(t)
 
+#define __rte_trace_point_emit_commit() __rte_trace_mem_commit()
+
 #define __rte_trace_point_emit(in, type) \
 do { \
 	memcpy(mem, &(in), sizeof(in)); \
@@ -378,6 +439,7 @@ do { \
 
 #define __rte_trace_point_emit_header_generic(t) RTE_SET_USED(t)
 #define __rte_trace_point_emit_header_fp(t) RTE_SET_USED(t)
+#define __rte_trace_point_emit_commit()
 #define __rte_trace_point_emit(in, type) RTE_SET_USED(in)
 #define rte_trace_point_emit_string(in) RTE_SET_USED(in)
 
@@ -444,6 +444,7 @@ eal_usage(const char *prgname)
 	       "  --"OPT_SOCKET_MEM"        Memory to allocate on sockets (comma separated values)\n"
 	       "  --"OPT_SOCKET_LIMIT"      Limit memory allocation on sockets (comma separated values)\n"
 	       "  --"OPT_HUGE_DIR"          Directory where hugetlbfs is mounted\n"
+	       "  --"OPT_HUGE_ALLOC_THREADS" Threads per socket allocating hugepages\n"
 	       "  --"OPT_FILE_PREFIX"       Prefix for hugepage filenames\n"
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
@@ -502,6 +503,24 @@ eal_parse_socket_arg(char *strval, volatile uint64_t *socket_arg)
 	return 0;
 }
 
+static int
+eal_parse_huge_alloc_threads(const char *arg)
+{
+	struct internal_config *internal_conf =
+		eal_get_internal_configuration();
+	unsigned long val;
+	char *end;
+
+	errno = 0;
+	val = strtoul(arg, &end, 10);
+	if (errno != 0 || arg[0] == '\0' || *end != '\0' ||
+			val == 0 || val > RTE_MAX_LCORE)
+		return -1;
+
+	internal_conf->huge_alloc_threads = val;
+	return 0;
+}
+
 static int
 eal_parse_vfio_intr(const char *mode)
 {
@@ -674,6 +693,16 @@ eal_parse_args(int argc, char **argv)
 			internal_conf->force_socket_limits = 1;
 			break;
 
+		case OPT_HUGE_ALLOC_THREADS_NUM:
+			if (eal_parse_huge_alloc_threads(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameters for --"
+						OPT_HUGE_ALLOC_THREADS "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
 		case OPT_VFIO_INTR_NUM:
 			if (eal_parse_vfio_intr(optarg) < 0) {
 				RTE_LOG(ERR, EAL, "invalid parameters for --"
@@ -888,6 +917,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_start();
+
 	p = strrchr(argv[0], '/');
 	strlcpy(logid, p ? p + 1 : argv[0], sizeof(logid));
 	thread_id = pthread_self();
@@ -1035,6 +1066,8 @@ rte_eal_init(int argc, char **argv)
 	RTE_LOG(INFO, EAL, "Selected IOVA mode '%s'\n",
 		rte_eal_iova_mode() == RTE_IOVA_PA ? "PA" : "VA");
 
+	eal_init_timing_mark("setup");
+
 	if (internal_conf->no_hugetlbfs == 0) {
 		/* rte_config isn't initialized yet */
 		ret = internal_conf->process_type == RTE_PROC_PRIMARY ?
@@ -1048,6 +1081,8 @@ rte_eal_init(int argc, char **argv)
 		}
 	}
 
+	eal_init_timing_mark("hugepage_info");
+
 	if (internal_conf->memory == 0 && internal_conf->force_sockets == 0) {
 		if (internal_conf->no_hugetlbfs)
 			internal_conf->memory = MEMSIZE_IF_NO_HUGE_PAGE;
@@ -1079,6 +1114,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 #endif
+	eal_init_timing_mark("log_vfio");
+
 	/* in secondary processes, memory init may allocate additional fbarrays
 	 * not present in primary processes, so to avoid any potential issues,
 	 * initialize memzones first.
@@ -1095,6 +1132,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_mark("memory");
+
 	/* the directories are locked during eal_hugepage_info_init */
 	eal_hugedirs_unlock();
 
@@ -1104,6 +1143,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_mark("malloc_heap");
+
 	if (rte_eal_tailqs_init() < 0) {
 		rte_eal_init_alert("Cannot init tail queues for objects");
 		rte_errno = EFAULT;
@@ -1173,6 +1214,8 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MAIN);
 	rte_eal_mp_wait_lcore();
 
+	eal_init_timing_mark("lcores");
+
 	/* initialize services so vdevs register service during bus_probe. */
 	ret = rte_service_init();
 	if (ret) {
@@ -1188,6 +1231,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	eal_init_timing_mark("bus_probe");
+
 #ifdef VFIO_PRESENT
 	/* Register mp action after probe() so that we got enough info */
 	if (rte_vfio_is_enabled("vfio") && vfio_mp_sync_setup() < 0)
@@ -1228,8 +1273,17 @@ rte_eal_init(int argc, char **argv)
 			return -1;
 	}
 
+	if (eal_trace_stream_init() < 0) {
+		rte_eal_init_alert("Cannot init trace streaming");
+		rte_errno = EFAULT;
+		return -1;
+	}
+
 	eal_mcfg_complete();
 
+	eal_init_timing_mark("finish");
+	eal_init_timing_dump();
+
 	return fctret;
 }
 
@@ -1263,18 +1317,21 @@ rte_eal_cleanup(void)
 			internal_conf->hugepage_file.unlink_existing)
 		rte_memseg_walk(mark_freeable, NULL);
 
+	/* stop streaming while the trace memory is still there */
+	eal_trace_stream_fini();
 	rte_service_finalize();
 #ifdef VFIO_PRESENT
 	vfio_mp_sync_cleanup();
 #endif
 	rte_mp_channel_cleanup();
+	/* the trace memory may be in the memory detached below */
+	rte_trace_save();
+	eal_trace_fini();
 	/* after this point, any DPDK pointers will become dangling */
 	rte_eal_memory_detach();
 	eal_mp_dev_hotplug_cleanup();
 	rte_eal_malloc_heap_cleanup();
 	rte_eal_alarm_cleanup();
-	rte_trace_save();
-	eal_trace_fini();
 	eal_cleanup_config(internal_conf);
 	rte_eal_log_cleanup();
 	return 0;
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <limits.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <signal.h>
 #include <setjmp.h>
 #ifdef F_ADD_SEALS /* if file sealing is supported, so is memfd */
@@ -31,6 +32,7 @@
 #include <rte_log.h>
 #include <rte_eal.h>
 #include <rte_memory.h>
+#include <rte_per_lcore.h>
 
 #include "eal_filesystem.h"
 #include "eal_internal_cfg.h"
@@ -97,11 +99,12 @@ static struct {
 /** local copy of a memory map, used to synchronize memory hotplug in MP */
 static struct rte_memseg_list local_memsegs[RTE_MAX_MEMSEG_LISTS];
 
-static sigjmp_buf huge_jmpenv;
+/* per thread, as pages may be faulted in by several threads at once */
+static RTE_DEFINE_PER_LCORE(sigjmp_buf, huge_jmpenv);
 
 static void huge_sigbus_handler(int signo __rte_unused)
 {
-	siglongjmp(huge_jmpenv, 1);
+	siglongjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 /* Put setjmp into a wrap method to avoid compiling error. Any non-volatile,
@@ -110,11 +113,13 @@ static void huge_sigbus_handler(int signo __rte_unused)
  */
 static int huge_wrap_sigsetjmp(void)
 {
-	return sigsetjmp(huge_jmpenv, 1);
+	return sigsetjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 static struct sigaction huge_action_old;
 static int huge_need_recover;
+/* set while allocation threads run, the handler is then installed once */
+static bool huge_sigbus_shared;
 
 static void
 huge_register_sigbus(void)
@@ -122,6 +127,9 @@ huge_register_sigbus(void)
 	sigset_t mask;
 	struct sigaction action;
 
+	if (huge_sigbus_shared)
+		return;
+
 	sigemptyset(&mask);
 	sigaddset(&mask, SIGBUS);
 	action.sa_flags = 0;
@@ -134,6 +142,8 @@ huge_register_sigbus(void)
 static void
 huge_recover_sigbus(void)
 {
+	if (huge_sigbus_shared)
+		return;
 	if (huge_need_recover) {
 		sigaction(SIGBUS, &huge_action_old, NULL);
 		huge_need_recover = 0;
@@ -810,6 +820,128 @@ struct alloc_walk_param {
 	int socket;
 	bool exact;
 };
+
+/* do not start a thread for less than this number of pages */
+#define ALLOC_PAGES_PER_THREAD_MIN 8
+
+struct alloc_thread_param {
+	const struct alloc_walk_param *wa;
+	struct rte_memseg_list *msl;
+	unsigned int msl_idx;
+	int start_idx;
+	unsigned int need;
+	unsigned int thread_idx;
+	unsigned int nb_threads;
+	int *status; /* result of alloc_seg() for each page */
+};
+
+static void *
+alloc_seg_thread(void *arg)
+{
+	struct alloc_thread_param *p = arg;
+	struct rte_memseg *cur;
+	void *map_addr;
+	unsigned int i;
+	int cur_idx;
+
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	/* the memory policy is inherited, also zero the pages locally */
+	if (check_numa())
+		numa_run_on_node(p->wa->socket);
+#endif
+	/* pages are interleaved between threads, so that a shortage of
+	 * pages leaves holes at the end of the range only.
+	 */
+	for (i = p->thread_idx; i < p->need; i += p->nb_threads) {
+		cur_idx = p->start_idx + i;
+		cur = rte_fbarray_get(&p->msl->memseg_arr, cur_idx);
+		map_addr = RTE_PTR_ADD(p->msl->base_va,
+				(size_t)cur_idx * p->msl->page_sz);
+		p->status[i] = alloc_seg(cur, map_addr, p->wa->socket,
+				p->wa->hi, p->msl_idx, cur_idx);
+	}
+	return NULL;
+}
+
+/*
+ * Map and fault in pages [start_idx, start_idx + need) of a memseg list
+ * from several threads. The pages keep their index in the list, so the
+ * result is the same as when allocating them one after another. Returns
+ * the number of pages allocated from the start of the range, pages
+ * allocated after the first failure are freed.
+ */
+static unsigned int
+alloc_seg_parallel(const struct alloc_walk_param *wa,
+		struct rte_memseg_list *msl, unsigned int msl_idx,
+		int start_idx, unsigned int need, unsigned int nb_threads)
+{
+	struct alloc_thread_param *params;
+	pthread_t *threads;
+	unsigned int i, n_ok;
+	int *status;
+
+	params = calloc(nb_threads, sizeof(*params));
+	threads = calloc(nb_threads, sizeof(*threads));
+	status = calloc(need, sizeof(*status));
+	if (params == NULL || threads == NULL || status == NULL) {
+		RTE_LOG(DEBUG, EAL, "%s(): cannot allocate thread parameters\n",
+			__func__);
+		n_ok = 0;
+		goto out;
+	}
+
+	huge_register_sigbus();
+	huge_sigbus_shared = true;
+
+	for (i = 0; i < nb_threads; i++) {
+		params[i].wa = wa;
+		params[i].msl = msl;
+		params[i].msl_idx = msl_idx;
+		params[i].start_idx = start_idx;
+		params[i].need = need;
+		params[i].thread_idx = i;
+		params[i].nb_threads = nb_threads;
+		params[i].status = status;
+	}
+	/* the calling thread takes the first share */
+	for (i = 1; i < nb_threads; i++) {
+		if (pthread_create(&threads[i], NULL, alloc_seg_thread,
+				&params[i]) != 0) {
+			RTE_LOG(DEBUG, EAL, "%s(): cannot create thread, allocating in the calling thread\n",
+				__func__);
+			alloc_seg_thread(&params[i]);
+			threads[i] = pthread_self();
+		}
+	}
+	alloc_seg_thread(&params[0]);
+	for (i = 1; i < nb_threads; i++)
+		if (!pthread_equal(threads[i], pthread_self()))
+			pthread_join(threads[i], NULL);
+
+	huge_sigbus_shared = false;
+	huge_recover_sigbus();
+
+	for (n_ok = 0; n_ok < need; n_ok++)
+		if (status[n_ok] != 0)
+			break;
+
+	/* keep a contiguous range of pages */
+	for (i = n_ok; i < need; i++) {
+		struct rte_memseg *tmp;
+
+		if (status[i] != 0)
+			continue;
+		tmp = rte_fbarray_get(&msl->memseg_arr, start_idx + i);
+		if (free_seg(tmp, wa->hi, msl_idx, start_idx + i))
+			RTE_LOG(DEBUG, EAL, "Cannot free page\n");
+	}
+out:
+	free(status);
+	free(threads);
+	free(params);
+	return n_ok;
+}
+
 static int
 alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 {
@@ -818,7 +950,7 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 	struct rte_memseg_list *cur_msl;
 	size_t page_sz;
 	int cur_idx, start_idx, j, dir_fd = -1;
-	unsigned int msl_idx, need, i;
+	unsigned int msl_idx, need, i, nb_threads;
 	const struct internal_config *internal_conf =
 		eal_get_internal_configuration();
 
@@ -886,6 +1018,27 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 		}
 	}
 
+	/* pages of a single file cannot be added concurrently */
+	nb_threads = RTE_MIN(internal_conf->huge_alloc_threads,
+			need / ALLOC_PAGES_PER_THREAD_MIN);
+	if (nb_threads > 1 && !internal_conf->single_file_segments) {
+		i = alloc_seg_parallel(wa, cur_msl, msl_idx, start_idx, need,
+				nb_threads);
+		for (j = 0; j < (int)i; j++, cur_idx++) {
+			if (wa->ms)
+				wa->ms[j] = rte_fbarray_get(&cur_msl->memseg_arr,
+						cur_idx);
+			rte_fbarray_set_used(&cur_msl->memseg_arr, cur_idx);
+		}
+		if (i < need) {
+			RTE_LOG(DEBUG, EAL, "attempted to allocate %i segments, but only %i were allocated\n",
+				need, i);
+			if (wa->exact)
+				goto fail;
+		}
+		goto out;
+	}
+
 	for (i = 0; i < need; i++, cur_idx++) {
 		struct rte_memseg *cur;
 		void *map_addr;
@@ -902,29 +1055,7 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 			/* if exact number wasn't requested, stop */
 			if (!wa->exact)
 				goto out;
-
-			/* clean up */
-			for (j = start_idx; j < cur_idx; j++) {
-				struct rte_memseg *tmp;
-				struct rte_fbarray *arr =
-						&cur_msl->memseg_arr;
-
-				tmp = rte_fbarray_get(arr, j);
-				rte_fbarray_set_free(arr, j);
-
-				/* free_seg may attempt to create a file, which
-				 * may fail.
-				 */
-				if (free_seg(tmp, wa->hi, msl_idx, j))
-					RTE_LOG(DEBUG, EAL, "Cannot free page\n");
-			}
-			/* clear the list */
-			if (wa->ms)
-				memset(wa->ms, 0, sizeof(*wa->ms) * wa->n_segs);
-
-			if (dir_fd >= 0)
-				close(dir_fd);
-			return -1;
+			goto fail;
 		}
 		if (wa->ms)
 			wa->ms[i] = cur;
@@ -939,6 +1070,27 @@ out:
 		close(dir_fd);
 	/* if we didn't allocate any segments, move on to the next list */
 	return i > 0;
+
+fail:
+	/* clean up */
+	for (j = start_idx; j < cur_idx; j++) {
+		struct rte_memseg *tmp;
+		struct rte_fbarray *arr = &cur_msl->memseg_arr;
+
+		tmp = rte_fbarray_get(arr, j);
+		rte_fbarray_set_free(arr, j);
+
+		/* free_seg may attempt to create a file, which may fail. */
+		if (free_seg(tmp, wa->hi, msl_idx, j))
+			RTE_LOG(DEBUG, EAL, "Cannot free page\n");
+	}
+	/* clear the list */
+	if (wa->ms)
+		memset(wa->ms, 0, sizeof(*wa->ms) * wa->n_segs);
+
+	if (dir_fd >= 0)
+		close(dir_fd);
+	return -1;
 }
 
 struct free_walk_param {
@@ -11,6 +11,7 @@
 
 #include "rte_altivec.h"
 #include "rte_common.h"
+#include "rte_compat.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -203,6 +204,21 @@ rte_memcpy_func(void *dst, const void *src, size_t n)
 	return ret;
 }
 
+/* Non-temporal copies are not implemented, use regular stores. */
+__rte_experimental
+static inline void *
+rte_memcpy_nt(void *dst, const void *src, size_t n)
+{
+	return rte_memcpy(dst, src, n);
+}
+
+__rte_experimental
+static inline void *
+rte_memcpy_nt_auto(void *dst, const void *src, size_t n)
+{
+	return rte_memcpy(dst, src, n);
+}
+
 #if defined(RTE_TOOLCHAIN_GCC) && (GCC_VERSION >= 100000)
 #pragma GCC diagnostic pop
 #endif
@@ -16,6 +16,7 @@
 #include <string.h>
 #include <rte_vect.h>
 #include <rte_common.h>
+#include <rte_compat.h>
 #include <rte_config.h>
 
 #ifdef __cplusplus
@@ -882,6 +883,97 @@ rte_memcpy(void *dst, const void *src, size_t n)
 		return rte_memcpy_generic(dst, src, n);
 }
 
+/**
+ * Copy 64 bytes to a 64-byte aligned destination with non-temporal
+ * stores, the source may be unaligned.
+ */
+static __rte_always_inline void
+rte_mov64_nt(uint8_t *dst, const uint8_t *src)
+{
+#if defined __AVX512F__ && defined RTE_MEMCPY_AVX512
+	__m512i zmm0;
+
+	zmm0 = _mm512_loadu_si512((const void *)src);
+	_mm512_stream_si512((void *)dst, zmm0);
+#elif defined __AVX2__
+	__m256i ymm0, ymm1;
+
+	ymm0 = _mm256_loadu_si256((const __m256i *)(const void *)src);
+	ymm1 = _mm256_loadu_si256((const __m256i *)(const void *)(src + 32));
+	_mm256_stream_si256((__m256i *)(void *)dst, ymm0);
+	_mm256_stream_si256((__m256i *)(void *)(dst + 32), ymm1);
+#else
+	__m128i xmm0, xmm1, xmm2, xmm3;
+
+	xmm0 = _mm_loadu_si128((const __m128i *)(const void *)src);
+	xmm1 = _mm_loadu_si128((const __m128i *)(const void *)(src + 16));
+	xmm2 = _mm_loadu_si128((const __m128i *)(const void *)(src + 32));
+	xmm3 = _mm_loadu_si128((const __m128i *)(const void *)(src + 48));
+	_mm_stream_si128((__m128i *)(void *)dst, xmm0);
+	_mm_stream_si128((__m128i *)(void *)(dst + 16), xmm1);
+	_mm_stream_si128((__m128i *)(void *)(dst + 32), xmm2);
+	_mm_stream_si128((__m128i *)(void *)(dst + 48), xmm3);
+#endif
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Copy bytes from one location to another with non-temporal stores.
+ * Whole cache lines of the destination are written with streaming stores,
+ * the unaligned head and tail are copied with rte_memcpy().
+ * The copy ends with a store fence.
+ */
+__rte_experimental
+static __rte_always_inline void *
+rte_memcpy_nt(void *dst, const void *src, size_t n)
+{
+	void *ret = dst;
+	size_t head;
+
+	/* not worth it if less than one cache line can be streamed */
+	if (n < 2 * RTE_CACHE_LINE_SIZE)
+		return rte_memcpy(dst, src, n);
+
+	head = (size_t)-(uintptr_t)dst & (RTE_CACHE_LINE_SIZE - 1);
+	if (head != 0) {
+		rte_memcpy(dst, src, head);
+		dst = (uint8_t *)dst + head;
+		src = (const uint8_t *)src + head;
+		n -= head;
+	}
+
+	for (; n >= RTE_CACHE_LINE_SIZE; n -= RTE_CACHE_LINE_SIZE) {
+		rte_mov64_nt((uint8_t *)dst, (const uint8_t *)src);
+		dst = (uint8_t *)dst + RTE_CACHE_LINE_SIZE;
+		src = (const uint8_t *)src + RTE_CACHE_LINE_SIZE;
+	}
+	if (n != 0)
+		rte_memcpy(dst, src, n);
+
+	/* streaming stores are weakly ordered */
+	_mm_sfence();
+
+	return ret;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Copy bytes with rte_memcpy_nt() if n is at least
+ * RTE_MEMCPY_NT_THRESHOLD, with rte_memcpy() otherwise.
+ */
+__rte_experimental
+static __rte_always_inline void *
+rte_memcpy_nt_auto(void *dst, const void *src, size_t n)
+{
+	if (n >= RTE_MEMCPY_NT_THRESHOLD)
+		return rte_memcpy_nt(dst, src, n);
+	return rte_memcpy(dst, src, n);
+}
+
 #if defined(RTE_TOOLCHAIN_GCC) && (GCC_VERSION >= 100000)
 #pragma GCC diagnostic pop
 #endif
@@ -748,25 +748,26 @@ esp_inb_pkt_process(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
 }
 
 /*
- * Prepare (plus actual crypto/auth) routine for inbound CPU-CRYPTO
- * (synchronous mode).
+ * Prepare routine for inbound CPU-CRYPTO (synchronous mode), storing the
+ * crypto parameters of the packets in *prm* but without doing the actual
+ * crypto/auth processing.
  */
 uint16_t
-cpu_inb_pkt_prepare(const struct rte_ipsec_session *ss,
-	struct rte_mbuf *mb[], uint16_t num)
+cpu_inb_pkt_xprepare(const struct rte_ipsec_session *ss,
+	struct rte_mbuf *mb[], uint16_t num, const struct cpu_crypto_prm *prm)
 {
 	int32_t rc;
 	uint32_t i, k;
 	struct rte_ipsec_sa *sa;
 	struct replay_sqn *rsn;
 	union sym_op_data icv;
-	struct rte_crypto_va_iova_ptr iv[num];
-	struct rte_crypto_va_iova_ptr aad[num];
-	struct rte_crypto_va_iova_ptr dgst[num];
+	struct rte_crypto_va_iova_ptr *iv = prm->iv;
+	struct rte_crypto_va_iova_ptr *aad = prm->aad;
+	struct rte_crypto_va_iova_ptr *dgst = prm->dgst;
 	uint32_t dr[num];
-	uint32_t l4ofs[num];
-	uint32_t clen[num];
-	uint64_t ivbuf[num][IPSEC_MAX_IV_QWORD];
+	uint32_t *l4ofs = prm->l4ofs;
+	uint32_t *clen = prm->clen;
+	uint64_t (*ivbuf)[IPSEC_MAX_IV_QWORD] = prm->ivbuf;
 
 	sa = ss->sa;
 
@@ -803,9 +804,38 @@ cpu_inb_pkt_prepare(const struct rte_ipsec_session *ss,
 	if (k != num && k != 0)
 		move_bad_mbufs(mb, dr, num, num - k);
 
+	return k;
+}
+
+/*
+ * Prepare (plus actual crypto/auth) routine for inbound CPU-CRYPTO
+ * (synchronous mode).
+ */
+uint16_t
+cpu_inb_pkt_prepare(const struct rte_ipsec_session *ss,
+	struct rte_mbuf *mb[], uint16_t num)
+{
+	uint32_t k;
+	struct rte_crypto_va_iova_ptr iv[num];
+	struct rte_crypto_va_iova_ptr aad[num];
+	struct rte_crypto_va_iova_ptr dgst[num];
+	uint32_t l4ofs[num];
+	uint32_t clen[num];
+	uint64_t ivbuf[num][IPSEC_MAX_IV_QWORD];
+	const struct cpu_crypto_prm prm = {
+		.iv = iv,
+		.aad = aad,
+		.dgst = dgst,
+		.l4ofs = l4ofs,
+		.clen = clen,
+		.ivbuf = ivbuf,
+	};
+
+	k = cpu_inb_pkt_xprepare(ss, mb, num, &prm);
+
 	/* convert mbufs to iovecs and do actual crypto/auth processing */
 	if (k != 0)
-		cpu_crypto_bulk(ss, sa->cofs, mb, iv, aad, dgst,
+		cpu_crypto_bulk(ss, ss->sa->cofs, mb, iv, aad, dgst,
 			l4ofs, clen, k);
 	return k;
 }
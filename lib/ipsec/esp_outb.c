@@ -525,10 +525,15 @@ outb_cpu_crypto_prepare(const struct rte_ipsec_sa *sa, uint32_t *pofs,
 	return clen;
 }
 
+/*
+ * Prepare packets for outbound CPU-CRYPTO, storing their crypto parameters
+ * in *prm* but without doing the actual crypto/auth processing.
+ */
 static uint16_t
-cpu_outb_pkt_prepare(const struct rte_ipsec_session *ss,
+cpu_outb_pkt_xprepare(const struct rte_ipsec_session *ss,
 		struct rte_mbuf *mb[], uint16_t num,
-		esp_outb_prepare_t prepare, uint32_t cofs_mask)
+		esp_outb_prepare_t prepare, uint32_t cofs_mask,
+		const struct cpu_crypto_prm *prm)
 {
 	int32_t rc;
 	uint64_t sqn;
@@ -537,13 +542,13 @@ cpu_outb_pkt_prepare(const struct rte_ipsec_session *ss,
 	uint32_t i, k, n;
 	uint32_t l2, l3;
 	union sym_op_data icv;
-	struct rte_crypto_va_iova_ptr iv[num];
-	struct rte_crypto_va_iova_ptr aad[num];
-	struct rte_crypto_va_iova_ptr dgst[num];
+	struct rte_crypto_va_iova_ptr *iv = prm->iv;
+	struct rte_crypto_va_iova_ptr *aad = prm->aad;
+	struct rte_crypto_va_iova_ptr *dgst = prm->dgst;
 	uint32_t dr[num];
-	uint32_t l4ofs[num];
-	uint32_t clen[num];
-	uint64_t ivbuf[num][IPSEC_MAX_IV_QWORD];
+	uint32_t *l4ofs = prm->l4ofs;
+	uint32_t *clen = prm->clen;
+	uint64_t (*ivbuf)[IPSEC_MAX_IV_QWORD] = prm->ivbuf;
 
 	sa = ss->sa;
 
@@ -589,9 +594,35 @@ cpu_outb_pkt_prepare(const struct rte_ipsec_session *ss,
 	if (k != n && k != 0)
 		move_bad_mbufs(mb, dr, n, n - k);
 
+	return k;
+}
+
+static uint16_t
+cpu_outb_pkt_prepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		esp_outb_prepare_t prepare, uint32_t cofs_mask)
+{
+	uint32_t k;
+	struct rte_crypto_va_iova_ptr iv[num];
+	struct rte_crypto_va_iova_ptr aad[num];
+	struct rte_crypto_va_iova_ptr dgst[num];
+	uint32_t l4ofs[num];
+	uint32_t clen[num];
+	uint64_t ivbuf[num][IPSEC_MAX_IV_QWORD];
+	const struct cpu_crypto_prm prm = {
+		.iv = iv,
+		.aad = aad,
+		.dgst = dgst,
+		.l4ofs = l4ofs,
+		.clen = clen,
+		.ivbuf = ivbuf,
+	};
+
+	k = cpu_outb_pkt_xprepare(ss, mb, num, prepare, cofs_mask, &prm);
+
 	/* convert mbufs to iovecs and do actual crypto/auth processing */
 	if (k != 0)
-		cpu_crypto_bulk(ss, sa->cofs, mb, iv, aad, dgst,
+		cpu_crypto_bulk(ss, ss->sa->cofs, mb, iv, aad, dgst,
 			l4ofs, clen, k);
 	return k;
 }
@@ -611,6 +642,24 @@ cpu_outb_trs_pkt_prepare(const struct rte_ipsec_session *ss,
 		UINT32_MAX);
 }
 
+uint16_t
+cpu_outb_tun_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm)
+{
+	return cpu_outb_pkt_xprepare(ss, mb, num, outb_tun_pkt_prepare, 0,
+		prm);
+}
+
+uint16_t
+cpu_outb_trs_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm)
+{
+	return cpu_outb_pkt_xprepare(ss, mb, num, outb_trs_pkt_prepare,
+		UINT32_MAX, prm);
+}
+
 /*
  * process outbound packets for SA with ESN support,
  * for algorithms that require SQN.hibits to be implicitly included
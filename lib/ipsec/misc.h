@@ -105,6 +105,25 @@ mbuf_cut_seg_ofs(struct rte_mbuf *mb, struct rte_mbuf *ms, uint32_t ofs,
 	mb->pkt_len -= len;
 }
 
+/*
+ * mark the packets the sync crypto engine failed to process,
+ * *n* out of *num* being successfully processed.
+ */
+static inline void
+cpu_crypto_status_check(struct rte_mbuf *mb[], const int32_t st[],
+	uint32_t num, uint32_t n)
+{
+	uint32_t i, j;
+
+	j = num - n;
+	for (i = 0; j != 0 && i != num; i++) {
+		if (st[i] != 0) {
+			mb[i]->ol_flags |= RTE_MBUF_F_RX_SEC_OFFLOAD_FAILED;
+			j--;
+		}
+	}
+}
+
 /*
  * process packets using sync crypto engine.
  * expects *num* to be greater than zero.
@@ -170,13 +189,77 @@ cpu_crypto_bulk(const struct rte_ipsec_session *ss,
 	n += rte_cryptodev_sym_cpu_crypto_process(ss->crypto.dev_id,
 		ss->crypto.ses, ofs, &symvec);
 
-	j = num - n;
-	for (i = 0; j != 0 && i != num; i++) {
-		if (st[i] != 0) {
-			mb[i]->ol_flags |= RTE_MBUF_F_RX_SEC_OFFLOAD_FAILED;
-			j--;
+	cpu_crypto_status_check(mb, st, num, n);
+}
+
+/*
+ * process packets of different sessions of the same device using sync
+ * crypto engine, in one call of the engine.
+ * expects *num* to be greater than zero.
+ */
+static inline void
+cpu_crypto_bulk_multi(uint8_t dev_id, struct rte_cryptodev_sym_session *ses[],
+	const union rte_crypto_sym_ofs ofs[], struct rte_mbuf *mb[],
+	struct rte_crypto_va_iova_ptr iv[],
+	struct rte_crypto_va_iova_ptr aad[],
+	struct rte_crypto_va_iova_ptr dgst[], uint32_t l4ofs[],
+	uint32_t clen[], uint32_t num)
+{
+	uint32_t i, j, n;
+	int32_t vcnt, vofs;
+	int32_t st[num];
+	struct rte_crypto_sgl vecpkt[num];
+	struct rte_crypto_vec vec[UINT8_MAX];
+	struct rte_crypto_sym_vec symvec;
+
+	const uint32_t vnum = RTE_DIM(vec);
+
+	j = 0, n = 0;
+	vofs = 0;
+	for (i = 0; i != num; i++) {
+
+		vcnt = rte_crypto_mbuf_to_vec(mb[i], l4ofs[i], clen[i],
+			&vec[vofs], vnum - vofs);
+
+		/* not enough space in vec[] to hold all segments */
+		if (vcnt < 0) {
+			/* fill the request structure */
+			symvec.src_sgl = &vecpkt[j];
+			symvec.dest_sgl = NULL;
+			symvec.iv = &iv[j];
+			symvec.digest = &dgst[j];
+			symvec.aad = &aad[j];
+			symvec.status = &st[j];
+			symvec.num = i - j;
+
+			/* flush vec array and try again */
+			n += rte_cryptodev_sym_cpu_crypto_process_multi(dev_id,
+				&ses[j], &ofs[j], &symvec);
+			vofs = 0;
+			vcnt = rte_crypto_mbuf_to_vec(mb[i], l4ofs[i], clen[i],
+				vec, vnum);
+			RTE_ASSERT(vcnt > 0);
+			j = i;
 		}
+
+		vecpkt[i].vec = &vec[vofs];
+		vecpkt[i].num = vcnt;
+		vofs += vcnt;
 	}
+
+	/* fill the request structure */
+	symvec.src_sgl = &vecpkt[j];
+	symvec.dest_sgl = NULL;
+	symvec.iv = &iv[j];
+	symvec.aad = &aad[j];
+	symvec.digest = &dgst[j];
+	symvec.status = &st[j];
+	symvec.num = i - j;
+
+	n += rte_cryptodev_sym_cpu_crypto_process_multi(dev_id, &ses[j],
+		&ofs[j], &symvec);
+
+	cpu_crypto_status_check(mb, st, num, n);
 }
 
 #endif /* _MISC_H_ */
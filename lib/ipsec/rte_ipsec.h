@@ -158,6 +158,55 @@ rte_ipsec_pkt_process(const struct rte_ipsec_session *ss, struct rte_mbuf *mb[],
 	return ss->pkt_func.process(ss, mb, num);
 }
 
+/**
+ * Same as *rte_ipsec_pkt_cpu_prepare* for packets of different
+ * RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO sessions, all on the same crypto
+ * device: the crypto processing of all the packets is done with one call
+ * of the device, whatever the number of sessions.
+ * The packets of a session are expected to be contiguous in *mb*: each run
+ * of packets of the same session is prepared as one burst of that session.
+ * Note that erroneous mbufs are not freed by the function,
+ * but are placed, with their session, beyond last valid mbuf in the *mb*
+ * array. It is a user responsibility to handle them further.
+ * @param ss
+ *   The address of an array of *num* pointers to the *rte_ipsec_session*
+ *   objects the packets belong to, reordered as the packets.
+ * @param mb
+ *   The address of an array of *num* pointers to *rte_mbuf* structures
+ *   which contain the input packets.
+ * @param num
+ *   The maximum number of packets to process.
+ * @return
+ *   Number of successfully processed packets, with error code set in rte_errno.
+ */
+__rte_experimental
+uint16_t
+rte_ipsec_pkt_cpu_prepare_multi(const struct rte_ipsec_session *ss[],
+	struct rte_mbuf *mb[], uint16_t num);
+
+/**
+ * Same as *rte_ipsec_pkt_process* for packets of different sessions,
+ * typically after *rte_ipsec_pkt_cpu_prepare_multi*. Each run of packets
+ * of the same session in *mb* is processed as one burst of that session.
+ * Note that erroneous mbufs are not freed by the function,
+ * but are placed, with their session, beyond last valid mbuf in the *mb*
+ * array. It is a user responsibility to handle them further.
+ * @param ss
+ *   The address of an array of *num* pointers to the *rte_ipsec_session*
+ *   objects the packets belong to, reordered as the packets.
+ * @param mb
+ *   The address of an array of *num* pointers to *rte_mbuf* structures
+ *   which contain the input packets.
+ * @param num
+ *   The maximum number of packets to process.
+ * @return
+ *   Number of successfully processed packets, with error code set in rte_errno.
+ */
+__rte_experimental
+uint16_t
+rte_ipsec_pkt_process_multi(const struct rte_ipsec_session *ss[],
+	struct rte_mbuf *mb[], uint16_t num);
+
 
 /**
  * Enable per SA telemetry for a specific SA.
@@ -763,6 +763,34 @@ cpu_crypto_pkt_func_select(const struct rte_ipsec_sa *sa,
 	return rc;
 }
 
+/*
+ * Prepare packets of a CPU_CRYPTO session as its prepare function does,
+ * leaving the actual crypto/auth processing to the caller.
+ */
+uint16_t
+cpu_crypto_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm)
+{
+	static const uint64_t msk = RTE_IPSEC_SATP_DIR_MASK |
+			RTE_IPSEC_SATP_MODE_MASK;
+
+	switch (ss->sa->type & msk) {
+	case (RTE_IPSEC_SATP_DIR_IB | RTE_IPSEC_SATP_MODE_TUNLV4):
+	case (RTE_IPSEC_SATP_DIR_IB | RTE_IPSEC_SATP_MODE_TUNLV6):
+	case (RTE_IPSEC_SATP_DIR_IB | RTE_IPSEC_SATP_MODE_TRANS):
+		return cpu_inb_pkt_xprepare(ss, mb, num, prm);
+	case (RTE_IPSEC_SATP_DIR_OB | RTE_IPSEC_SATP_MODE_TUNLV4):
+	case (RTE_IPSEC_SATP_DIR_OB | RTE_IPSEC_SATP_MODE_TUNLV6):
+		return cpu_outb_tun_pkt_xprepare(ss, mb, num, prm);
+	case (RTE_IPSEC_SATP_DIR_OB | RTE_IPSEC_SATP_MODE_TRANS):
+		return cpu_outb_trs_pkt_xprepare(ss, mb, num, prm);
+	default:
+		rte_errno = ENOTSUP;
+		return 0;
+	}
+}
+
 /*
  * Select packet processing function for session on INLINE_CRYPTO
  * type of device.
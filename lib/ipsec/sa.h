@@ -53,6 +53,19 @@ union sym_op_data {
 	};
 };
 
+/*
+ * arrays where the CPU-CRYPTO prepare routines store the crypto parameters
+ * of the prepared packets, one entry per packet.
+ */
+struct cpu_crypto_prm {
+	struct rte_crypto_va_iova_ptr *iv;
+	struct rte_crypto_va_iova_ptr *aad;
+	struct rte_crypto_va_iova_ptr *dgst;
+	uint32_t *l4ofs;
+	uint32_t *clen;
+	uint64_t (*ivbuf)[IPSEC_MAX_IV_QWORD];
+};
+
 #define REPLAY_SQN_NUM		2
 #define REPLAY_SQN_NEXT(n)	((n) ^ 1)
 
@@ -173,6 +186,11 @@ uint16_t
 cpu_inb_pkt_prepare(const struct rte_ipsec_session *ss,
 		struct rte_mbuf *mb[], uint16_t num);
 
+uint16_t
+cpu_inb_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm);
+
 /* outbound processing */
 
 uint16_t
@@ -210,4 +228,18 @@ uint16_t
 cpu_outb_trs_pkt_prepare(const struct rte_ipsec_session *ss,
 		struct rte_mbuf *mb[], uint16_t num);
 
+uint16_t
+cpu_outb_tun_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm);
+uint16_t
+cpu_outb_trs_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm);
+
+uint16_t
+cpu_crypto_pkt_xprepare(const struct rte_ipsec_session *ss,
+		struct rte_mbuf *mb[], uint16_t num,
+		const struct cpu_crypto_prm *prm);
+
 #endif /* _SA_H_ */
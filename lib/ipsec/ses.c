@@ -2,8 +2,10 @@
  * Copyright(c) 2018-2020 Intel Corporation
  */
 
+#include <rte_errno.h>
 #include <rte_ipsec.h>
 #include "sa.h"
+#include "misc.h"
 
 static int
 session_check(struct rte_ipsec_session *ss)
@@ -44,10 +46,145 @@ rte_ipsec_session_prepare(struct rte_ipsec_session *ss)
 
 	ss->pkt_func = fp;
 
-	if (ss->type == RTE_SECURITY_ACTION_TYPE_NONE)
+	if (ss->type == RTE_SECURITY_ACTION_TYPE_NONE ||
+			ss->type == RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO)
 		ss->crypto.ses->opaque_data = (uintptr_t)ss;
 	else
 		ss->security.ses->opaque_data = (uintptr_t)ss;
 
 	return 0;
 }
+
+/*
+ * Move the *k* good mbufs at the head of the run [i, j) of packets of the
+ * same session right after the *n* good mbufs of the previous runs, and
+ * save its bad mbufs with their session.
+ */
+static inline void
+multi_run_sort(const struct rte_ipsec_session *ss[], struct rte_mbuf *mb[],
+	uint32_t i, uint32_t j, uint32_t k, uint32_t n,
+	const struct rte_ipsec_session *bss[], struct rte_mbuf *bmb[],
+	uint32_t *nb_bad)
+{
+	const struct rte_ipsec_session *rs = ss[i];
+	uint32_t l, b;
+
+	b = *nb_bad;
+	for (l = i + k; l != j; l++) {
+		bss[b] = rs;
+		bmb[b++] = mb[l];
+	}
+	*nb_bad = b;
+
+	for (l = 0; l != k; l++) {
+		ss[n + l] = rs;
+		mb[n + l] = mb[i + l];
+	}
+}
+
+/* Copy the bad mbufs, with their session, beyond the *n* good ones. */
+static inline void
+multi_bad_restore(const struct rte_ipsec_session *ss[], struct rte_mbuf *mb[],
+	uint32_t n, const struct rte_ipsec_session *bss[],
+	struct rte_mbuf *bmb[], uint32_t nb_bad)
+{
+	uint32_t l;
+
+	for (l = 0; l != nb_bad; l++) {
+		ss[n + l] = bss[l];
+		mb[n + l] = bmb[l];
+	}
+}
+
+uint16_t
+rte_ipsec_pkt_cpu_prepare_multi(const struct rte_ipsec_session *ss[],
+	struct rte_mbuf *mb[], uint16_t num)
+{
+	uint8_t dev_id;
+	uint32_t i, j, k, l, n, nb_bad;
+	const struct rte_ipsec_session *rs;
+	struct cpu_crypto_prm prm;
+	struct rte_crypto_va_iova_ptr iv[num];
+	struct rte_crypto_va_iova_ptr aad[num];
+	struct rte_crypto_va_iova_ptr dgst[num];
+	uint32_t l4ofs[num];
+	uint32_t clen[num];
+	uint64_t ivbuf[num][IPSEC_MAX_IV_QWORD];
+	struct rte_cryptodev_sym_session *cses[num];
+	union rte_crypto_sym_ofs cofs[num];
+	const struct rte_ipsec_session *bss[num];
+	struct rte_mbuf *bmb[num];
+
+	if (num == 0)
+		return 0;
+
+	dev_id = ss[0]->crypto.dev_id;
+
+	n = 0;
+	nb_bad = 0;
+	for (i = 0; i != num; i = j) {
+		rs = ss[i];
+		for (j = i + 1; j != num && ss[j] == rs; j++)
+			;
+
+		/* parameters of the run follow the ones of previous runs */
+		prm.iv = iv + n;
+		prm.aad = aad + n;
+		prm.dgst = dgst + n;
+		prm.l4ofs = l4ofs + n;
+		prm.clen = clen + n;
+		prm.ivbuf = ivbuf + n;
+
+		if (rs->type == RTE_SECURITY_ACTION_TYPE_CPU_CRYPTO &&
+				rs->crypto.dev_id == dev_id)
+			k = cpu_crypto_pkt_xprepare(rs, mb + i, j - i, &prm);
+		else {
+			k = 0;
+			rte_errno = EINVAL;
+		}
+
+		for (l = n; l != n + k; l++) {
+			cses[l] = rs->crypto.ses;
+			cofs[l] = rs->sa->cofs;
+		}
+
+		multi_run_sort(ss, mb, i, j, k, n, bss, bmb, &nb_bad);
+		n += k;
+	}
+
+	/* copy not prepared mbufs beyond good ones */
+	multi_bad_restore(ss, mb, n, bss, bmb, nb_bad);
+
+	/* convert mbufs to iovecs and do actual crypto/auth processing */
+	if (n != 0)
+		cpu_crypto_bulk_multi(dev_id, cses, cofs, mb, iv, aad, dgst,
+			l4ofs, clen, n);
+	return n;
+}
+
+uint16_t
+rte_ipsec_pkt_process_multi(const struct rte_ipsec_session *ss[],
+	struct rte_mbuf *mb[], uint16_t num)
+{
+	uint32_t i, j, k, n, nb_bad;
+	const struct rte_ipsec_session *rs;
+	const struct rte_ipsec_session *bss[num];
+	struct rte_mbuf *bmb[num];
+
+	n = 0;
+	nb_bad = 0;
+	for (i = 0; i != num; i = j) {
+		rs = ss[i];
+		for (j = i + 1; j != num && ss[j] == rs; j++)
+			;
+
+		k = rte_ipsec_pkt_process(rs, mb + i, j - i);
+		multi_run_sort(ss, mb, i, j, k, n, bss, bmb, &nb_bad);
+		n += k;
+	}
+
+	/* copy unprocessed mbufs beyond good ones */
+	multi_bad_restore(ss, mb, n, bss, bmb, nb_bad);
+
+	return n;
+}
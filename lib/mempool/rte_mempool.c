@@ -25,6 +25,7 @@
 #include <rte_tailq.h>
 #include <rte_eal_paging.h>
 #include <rte_telemetry.h>
+#include <rte_thread.h>
 
 #include "rte_mempool.h"
 #include "rte_mempool_trace.h"
@@ -48,6 +49,16 @@ static void
 mempool_event_callback_invoke(enum rte_mempool_event event,
 			      struct rte_mempool *mp);
 
+/* Detach the caches of unregistered threads from a freed mempool. */
+static void
+mempool_thread_caches_forget(const struct rte_mempool *mp);
+static unsigned int
+mempool_thread_caches_count(const struct rte_mempool *mp);
+static void
+mempool_lcore_callback_register(void);
+static void
+mempool_remote_queues_free(struct rte_mempool *mp);
+
 #define CACHE_FLUSHTHRESH_MULTIPLIER 1.5
 #define CALC_CACHE_FLUSHTHRESH(c)	\
 	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
@@ -736,10 +747,13 @@ rte_mempool_free(struct rte_mempool *mp)
 	}
 	rte_mcfg_tailq_write_unlock();
 
+	mempool_thread_caches_forget(mp);
 	mempool_event_callback_invoke(RTE_MEMPOOL_EVENT_DESTROY, mp);
 	rte_mempool_trace_free(mp);
 	rte_mempool_free_memchunks(mp);
 	rte_mempool_ops_free(mp);
+	if (mp->flags & RTE_MEMPOOL_F_REMOTE_FREE)
+		mempool_remote_queues_free(mp);
 	rte_memzone_free(mp->mz);
 }
 
@@ -792,6 +806,379 @@ rte_mempool_cache_free(struct rte_mempool_cache *cache)
 	rte_free(cache);
 }
 
+int
+rte_mempool_cache_adaptive_enable(struct rte_mempool *mp,
+		const struct rte_mempool_cache_adaptive_conf *conf)
+{
+	struct rte_mempool_cache_adaptive_conf c;
+	struct rte_mempool_cache_ext *ce;
+	struct rte_mempool_ext *ext;
+	unsigned int lcore_id;
+
+	if (mp->cache_size == 0)
+		return -EINVAL;
+
+	if (conf != NULL)
+		c = *conf;
+	else
+		memset(&c, 0, sizeof(c));
+	if (c.min_size == 0)
+		c.min_size = RTE_MAX(mp->cache_size / 4, 1U);
+	if (c.max_size == 0) {
+		c.max_size = RTE_MIN((uint32_t)RTE_MEMPOOL_CACHE_MAX_SIZE,
+				mp->size * 2 / 3);
+		c.max_size = RTE_MAX(c.max_size, mp->cache_size);
+	}
+	if (c.budget == 0)
+		c.budget = mp->cache_size * rte_lcore_count();
+	if (c.window == 0)
+		c.window = RTE_MEMPOOL_CACHE_ADAPT_WINDOW;
+
+	if (c.min_size > mp->cache_size || c.max_size < mp->cache_size ||
+			c.max_size > RTE_MEMPOOL_CACHE_MAX_SIZE ||
+			CALC_CACHE_FLUSHTHRESH(c.max_size) > mp->size)
+		return -EINVAL;
+
+	ext = rte_mempool_get_ext(mp);
+	ext->cache_adaptive = c;
+	ext->cache_budget_used = 0;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		ce = &ext->cache[lcore_id];
+		ce->win_ops = 0;
+		ce->win_ring = 0;
+		ce->win_objs = 0;
+		ce->win_balance = 0;
+		ce->win_min_len = UINT32_MAX;
+		ce->adapt_charged = 0;
+		ce->adapt_window = c.window;
+	}
+	mp->flags |= RTE_MEMPOOL_F_CACHE_ADAPTIVE;
+	return 0;
+}
+
+void
+rte_mempool_cache_adaptive_disable(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache *cache;
+	struct rte_mempool_ext *ext;
+	unsigned int lcore_id;
+
+	if (mp->cache_size == 0)
+		return;
+
+	mp->flags &= ~RTE_MEMPOOL_F_CACHE_ADAPTIVE;
+	ext = rte_mempool_get_ext(mp);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &mp->local_cache[lcore_id];
+		ext->cache[lcore_id].adapt_window = 0;
+		if (cache->len > mp->cache_size) {
+			rte_mempool_ops_enqueue_bulk(mp,
+				&cache->objs[mp->cache_size],
+				cache->len - mp->cache_size);
+			cache->len = mp->cache_size;
+		}
+		cache->size = mp->cache_size;
+		cache->flushthresh = CALC_CACHE_FLUSHTHRESH(mp->cache_size);
+		ext->cache[lcore_id].adapt_charged = 0;
+	}
+	memset(&ext->cache_adaptive, 0, sizeof(ext->cache_adaptive));
+	ext->cache_budget_used = 0;
+}
+
+int
+rte_mempool_cache_stats_get(struct rte_mempool *mp, unsigned int lcore_id,
+		struct rte_mempool_cache_stats *stats)
+{
+	const struct rte_mempool_cache_ext *ce;
+	const struct rte_mempool_cache *cache;
+
+	if (mp->cache_size == 0 || lcore_id >= RTE_MAX_LCORE || stats == NULL)
+		return -EINVAL;
+
+	cache = &mp->local_cache[lcore_id];
+	ce = &rte_mempool_get_ext(mp)->cache[lcore_id];
+	stats->size = cache->size;
+	stats->len = cache->len;
+	stats->ops = ce->adapt_ops;
+	stats->ring_ops = ce->adapt_ring_ops;
+	stats->grows = ce->adapt_grows;
+	stats->shrinks = ce->adapt_shrinks;
+	return 0;
+}
+
+static void
+mempool_remote_queues_free(struct rte_mempool *mp)
+{
+	struct rte_mempool_ext *ext = rte_mempool_get_ext(mp);
+	unsigned int lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		rte_free(ext->cache[lcore_id].remote);
+		ext->cache[lcore_id].remote = NULL;
+	}
+}
+
+int
+rte_mempool_remote_free_enable(struct rte_mempool *mp)
+{
+	struct rte_mempool_remote_queue *q;
+	unsigned int lcore_id, socket_id;
+	int home;
+
+	if (mp->cache_size == 0)
+		return -EINVAL;
+	if (mp->flags & RTE_MEMPOOL_F_REMOTE_FREE)
+		return 0;
+
+	home = mp->socket_id != SOCKET_ID_ANY ?
+		mp->socket_id : mp->mz->socket_id;
+	RTE_LCORE_FOREACH(lcore_id) {
+		socket_id = rte_lcore_to_socket_id(lcore_id);
+		/* lcores spanning several sockets keep using their cache */
+		if (socket_id == (unsigned int)home ||
+				socket_id == (unsigned int)SOCKET_ID_ANY)
+			continue;
+		q = rte_zmalloc_socket("MEMPOOL_REMOTE_QUEUE", sizeof(*q),
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (q == NULL) {
+			RTE_LOG(ERR, MEMPOOL,
+				"Cannot allocate return queue of lcore %u\n",
+				lcore_id);
+			mempool_remote_queues_free(mp);
+			return -ENOMEM;
+		}
+		rte_mempool_get_ext(mp)->cache[lcore_id].remote = q;
+	}
+	mp->flags |= RTE_MEMPOOL_F_REMOTE_FREE;
+	return 0;
+}
+
+/*
+ * Unregistered non-EAL threads have no lcore id, hence no default cache.
+ * Each of them gets its own user-owned caches instead, created when it
+ * first uses a mempool, and flushed when it exits or registers.
+ */
+#define MEMPOOL_THREAD_CACHE_MAX 8
+
+/*
+ * The entries are updated under thread_caches_lock. The owner thread
+ * looks its caches up without it, so the mempool pointers are written
+ * with release and read with acquire ordering.
+ */
+struct mempool_thread_caches {
+	TAILQ_ENTRY(mempool_thread_caches) next;
+	unsigned int nb;
+	struct {
+		struct rte_mempool *mp; /* NULL once the mempool is freed */
+		struct rte_mempool_cache *cache;
+	} ent[MEMPOOL_THREAD_CACHE_MAX];
+};
+
+static RTE_DEFINE_PER_LCORE(struct mempool_thread_caches, thread_caches);
+
+/* Caches of all threads, with at least one cache. */
+static TAILQ_HEAD(, mempool_thread_caches) thread_caches_list =
+	TAILQ_HEAD_INITIALIZER(thread_caches_list);
+static rte_spinlock_t thread_caches_lock = RTE_SPINLOCK_INITIALIZER;
+static rte_thread_key thread_caches_key;
+static bool thread_caches_key_created;
+
+/* Give back the objects of all caches of a thread. */
+static void
+mempool_thread_caches_flush(struct mempool_thread_caches *tc)
+{
+	unsigned int i;
+
+	rte_spinlock_lock(&thread_caches_lock);
+	for (i = 0; i < tc->nb; i++) {
+		if (tc->ent[i].mp != NULL)
+			rte_mempool_cache_flush(tc->ent[i].cache,
+						tc->ent[i].mp);
+	}
+	rte_spinlock_unlock(&thread_caches_lock);
+}
+
+/* Thread exit: give back the objects and free the caches. */
+static void
+mempool_thread_caches_destroy(void *arg)
+{
+	struct mempool_thread_caches *tc = arg;
+	unsigned int i;
+
+	struct rte_mempool *mp;
+
+	rte_spinlock_lock(&thread_caches_lock);
+	for (i = 0; i < tc->nb; i++) {
+		mp = tc->ent[i].mp;
+		if (mp != NULL) {
+			rte_mempool_cache_flush(tc->ent[i].cache, mp);
+			__atomic_fetch_sub(
+				&rte_mempool_get_ext(mp)->nb_thread_caches,
+				1, __ATOMIC_RELAXED);
+		}
+		rte_mempool_cache_free(tc->ent[i].cache);
+	}
+	if (tc->nb != 0)
+		TAILQ_REMOVE(&thread_caches_list, tc, next);
+	tc->nb = 0;
+	rte_spinlock_unlock(&thread_caches_lock);
+}
+
+static void
+mempool_thread_caches_forget(const struct rte_mempool *mp)
+{
+	struct mempool_thread_caches *tc;
+	unsigned int i;
+
+	rte_spinlock_lock(&thread_caches_lock);
+	TAILQ_FOREACH(tc, &thread_caches_list, next) {
+		for (i = 0; i < tc->nb; i++) {
+			if (tc->ent[i].mp == mp)
+				__atomic_store_n(&tc->ent[i].mp, NULL,
+						 __ATOMIC_RELEASE);
+		}
+	}
+	rte_spinlock_unlock(&thread_caches_lock);
+}
+
+static unsigned int
+mempool_thread_caches_count(const struct rte_mempool *mp)
+{
+	struct mempool_thread_caches *tc;
+	unsigned int count = 0;
+	unsigned int i;
+
+	/* most mempools are not used by unregistered threads */
+	if (__atomic_load_n(&rte_mempool_get_ext(mp)->nb_thread_caches,
+			__ATOMIC_RELAXED) == 0)
+		return 0;
+
+	rte_spinlock_lock(&thread_caches_lock);
+	TAILQ_FOREACH(tc, &thread_caches_list, next) {
+		for (i = 0; i < tc->nb; i++) {
+			if (tc->ent[i].mp == mp)
+				count += tc->ent[i].cache->len;
+		}
+	}
+	rte_spinlock_unlock(&thread_caches_lock);
+	return count;
+}
+
+static struct rte_mempool_cache *
+mempool_thread_cache_create(struct mempool_thread_caches *tc,
+		struct rte_mempool *mp)
+{
+	struct rte_mempool_cache *cache;
+	unsigned int i;
+
+	cache = rte_mempool_cache_create(mp->cache_size, mp->socket_id);
+	if (cache == NULL)
+		return NULL;
+
+	rte_spinlock_lock(&thread_caches_lock);
+	if (!thread_caches_key_created) {
+		if (rte_thread_key_create(&thread_caches_key,
+				mempool_thread_caches_destroy) < 0)
+			goto fail;
+		thread_caches_key_created = true;
+	}
+	/* reuse the slot of a freed mempool, if any */
+	for (i = 0; i < tc->nb; i++) {
+		if (tc->ent[i].mp == NULL)
+			break;
+	}
+	if (i == MEMPOOL_THREAD_CACHE_MAX)
+		goto fail;
+	if (i == tc->nb) {
+		if (tc->nb == 0) {
+			/* the exit destructor is only called if not NULL */
+			if (rte_thread_value_set(thread_caches_key, tc) < 0)
+				goto fail;
+			TAILQ_INSERT_TAIL(&thread_caches_list, tc, next);
+		}
+		tc->nb++;
+	} else {
+		rte_mempool_cache_free(tc->ent[i].cache);
+	}
+	tc->ent[i].cache = cache;
+	__atomic_store_n(&tc->ent[i].mp, mp, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&rte_mempool_get_ext(mp)->nb_thread_caches, 1,
+			   __ATOMIC_RELAXED);
+	rte_spinlock_unlock(&thread_caches_lock);
+	return cache;
+
+fail:
+	rte_spinlock_unlock(&thread_caches_lock);
+	rte_mempool_cache_free(cache);
+	return NULL;
+}
+
+struct rte_mempool_cache *
+rte_mempool_thread_cache(struct rte_mempool *mp)
+{
+	struct mempool_thread_caches *tc = &RTE_PER_LCORE(thread_caches);
+	unsigned int i;
+
+	if (rte_lcore_id() != LCORE_ID_ANY)
+		return NULL;
+
+	for (i = 0; i < tc->nb; i++) {
+		if (__atomic_load_n(&tc->ent[i].mp, __ATOMIC_ACQUIRE) == mp)
+			return tc->ent[i].cache;
+	}
+	if (mp->cache_size == 0)
+		return NULL;
+	return mempool_thread_cache_create(tc, mp);
+}
+
+void
+rte_mempool_thread_cache_flush(void)
+{
+	mempool_thread_caches_flush(&RTE_PER_LCORE(thread_caches));
+}
+
+/* A thread registering as lcore gives back what it cached before. */
+static int
+mempool_lcore_init(unsigned int lcore_id __rte_unused, void *arg __rte_unused)
+{
+	if (rte_lcore_id() == LCORE_ID_ANY)
+		mempool_thread_caches_flush(&RTE_PER_LCORE(thread_caches));
+	return 0;
+}
+
+static void
+mempool_lcore_flush(struct rte_mempool *mp, void *arg)
+{
+	unsigned int lcore_id = *(unsigned int *)arg;
+
+	if (mp->cache_size != 0)
+		rte_mempool_cache_flush(&mp->local_cache[lcore_id], mp);
+}
+
+/* An unregistered lcore gives back the objects of its default caches. */
+static void
+mempool_lcore_uninit(unsigned int lcore_id, void *arg __rte_unused)
+{
+	rte_mempool_walk(mempool_lcore_flush, &lcore_id);
+}
+
+/*
+ * Registered on the first mempool creation, out of the mempool lock,
+ * which the uninit callback takes with the EAL lcore lock held.
+ */
+static void
+mempool_lcore_callback_register(void)
+{
+	static bool registered;
+
+	if (__atomic_exchange_n(&registered, true, __ATOMIC_RELAXED))
+		return;
+	if (rte_lcore_callback_register("mempool", mempool_lcore_init,
+			mempool_lcore_uninit, NULL) == NULL)
+		RTE_LOG(WARNING, MEMPOOL,
+			"Cannot register lcore callback, registered threads will not flush their caches\n");
+}
+
 /* create an empty mempool */
 struct rte_mempool *
 rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
@@ -858,6 +1245,9 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 		return NULL;
 	}
 
+	if (cache_size != 0)
+		mempool_lcore_callback_register();
+
 	rte_mcfg_mempool_write_lock();
 
 	/*
@@ -877,6 +1267,9 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 
 	mempool_size = RTE_MEMPOOL_HEADER_SIZE(mp, cache_size);
 	mempool_size += private_data_size;
+	/* the extension follows the private data, see rte_mempool_get_ext() */
+	if (cache_size != 0)
+		mempool_size += sizeof(struct rte_mempool_ext);
 	mempool_size = RTE_ALIGN_CEIL(mempool_size, RTE_MEMPOOL_ALIGN);
 
 	ret = snprintf(mz_name, sizeof(mz_name), RTE_MEMPOOL_MZ_FORMAT, name);
@@ -922,6 +1315,8 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
 			mempool_cache_init(&mp->local_cache[lcore_id],
 					   cache_size);
+		memset(rte_mempool_get_ext(mp), 0,
+		       sizeof(struct rte_mempool_ext));
 	}
 
 	te->data = mp;
@@ -1009,6 +1404,14 @@ rte_mempool_avail_count(const struct rte_mempool *mp)
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
 		count += mp->local_cache[lcore_id].len;
+	if (mp->flags & RTE_MEMPOOL_F_REMOTE_FREE) {
+		const struct rte_mempool_ext *ext = rte_mempool_get_ext(mp);
+
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+			if (ext->cache[lcore_id].remote != NULL)
+				count += ext->cache[lcore_id].remote->len;
+	}
+	count += mempool_thread_caches_count(mp);
 
 	/*
 	 * due to race condition (access to len is not locked), the
@@ -1030,6 +1433,7 @@ rte_mempool_in_use_count(const struct rte_mempool *mp)
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
+	const struct rte_mempool_ext *ext;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
@@ -1046,7 +1450,44 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 			lcore_id, cache_count);
 		count += cache_count;
 	}
+	cache_count = mempool_thread_caches_count(mp);
+	fprintf(f, "    thread_cache_count=%u\n", cache_count);
+	count += cache_count;
+	ext = rte_mempool_get_ext(mp);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		const struct rte_mempool_remote_queue *q =
+			ext->cache[lcore_id].remote;
+
+		if (q == NULL)
+			continue;
+		fprintf(f, "    remote_queue[%u]: count=%"PRIu32" put_objs=%"PRIu64" flushes=%"PRIu64"\n",
+			lcore_id, q->len, q->put_objs, q->flushes);
+		count += q->len;
+	}
 	fprintf(f, "    total_cache_count=%u\n", count);
+
+	if (ext->cache_adaptive.window == 0)
+		return count;
+
+	fprintf(f, "  adaptive cache infos:\n");
+	fprintf(f, "    min_size=%"PRIu32" max_size=%"PRIu32" window=%"PRIu32"\n",
+		ext->cache_adaptive.min_size, ext->cache_adaptive.max_size,
+		ext->cache_adaptive.window);
+	fprintf(f, "    budget=%"PRIu32" budget_used=%"PRIu32"\n",
+		ext->cache_adaptive.budget, ext->cache_budget_used);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		const struct rte_mempool_cache_ext *ce =
+			&ext->cache[lcore_id];
+
+		/* only lcores which used the mempool */
+		if (ce->adapt_charged == 0)
+			continue;
+		fprintf(f, "    cache[%u]: size=%"PRIu32" ops=%"PRIu64
+			" ring_ops=%"PRIu64" grows=%"PRIu64" shrinks=%"PRIu64"\n",
+			lcore_id, mp->local_cache[lcore_id].size,
+			ce->adapt_ops, ce->adapt_ring_ops, ce->adapt_grows,
+			ce->adapt_shrinks);
+	}
 	return count;
 }
 
@@ -1523,6 +1964,16 @@ mempool_info_cb(struct rte_mempool *mp, void *arg)
 	rte_tel_data_add_dict_int(info->d, "ops_index", mp->ops_index);
 	rte_tel_data_add_dict_int(info->d, "populated_size",
 				  mp->populated_size);
+	rte_tel_data_add_dict_int(info->d, "cache_adaptive",
+				  !!(mp->flags & RTE_MEMPOOL_F_CACHE_ADAPTIVE));
+	if (mp->flags & RTE_MEMPOOL_F_CACHE_ADAPTIVE) {
+		const struct rte_mempool_ext *ext = rte_mempool_get_ext(mp);
+
+		rte_tel_data_add_dict_int(info->d, "cache_budget",
+					  ext->cache_adaptive.budget);
+		rte_tel_data_add_dict_int(info->d, "cache_budget_used",
+					  ext->cache_budget_used);
+	}
 
 	mz = mp->mz;
 	rte_tel_data_add_dict_string(info->d, "mz_name", mz->name);
@@ -1553,10 +2004,77 @@ mempool_handle_info(const char *cmd __rte_unused, const char *params,
 	return 0;
 }
 
+static void
+mempool_cache_stats_cb(struct rte_mempool *mp, void *arg)
+{
+	struct mempool_info_cb_arg *info = (struct mempool_info_cb_arg *)arg;
+	const struct rte_mempool_remote_queue *q;
+	struct rte_mempool_cache_stats stats;
+	struct rte_tel_data *c;
+	char name[32];
+	unsigned int lcore_id;
+
+	if (strncmp(mp->name, info->pool_name, RTE_MEMZONE_NAMESIZE) ||
+			mp->cache_size == 0)
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		q = rte_mempool_get_ext(mp)->cache[lcore_id].remote;
+		/* skip the caches which were never used */
+		if (rte_mempool_cache_stats_get(mp, lcore_id, &stats) < 0 ||
+				(stats.ops == 0 && stats.len == 0 &&
+				 (q == NULL || q->put_objs == 0)))
+			continue;
+
+		c = rte_tel_data_alloc();
+		if (c == NULL)
+			return;
+		rte_tel_data_start_dict(c);
+		rte_tel_data_add_dict_int(c, "size", stats.size);
+		rte_tel_data_add_dict_int(c, "len", stats.len);
+		rte_tel_data_add_dict_u64(c, "ops", stats.ops);
+		rte_tel_data_add_dict_u64(c, "ring_ops", stats.ring_ops);
+		rte_tel_data_add_dict_u64(c, "grows", stats.grows);
+		rte_tel_data_add_dict_u64(c, "shrinks", stats.shrinks);
+		if (q != NULL) {
+			rte_tel_data_add_dict_int(c, "remote_len", q->len);
+			rte_tel_data_add_dict_u64(c, "remote_put_objs",
+						  q->put_objs);
+			rte_tel_data_add_dict_u64(c, "remote_flushes",
+						  q->flushes);
+		}
+		snprintf(name, sizeof(name), "lcore_%u", lcore_id);
+		rte_tel_data_add_dict_container(info->d, name, c, 0);
+	}
+}
+
+static int
+mempool_handle_cache_stats(const char *cmd __rte_unused, const char *params,
+			   struct rte_tel_data *d)
+{
+	struct mempool_info_cb_arg mp_arg;
+	char name[RTE_MEMZONE_NAMESIZE];
+
+	if (!params || strlen(params) == 0)
+		return -EINVAL;
+
+	rte_strlcpy(name, params, RTE_MEMZONE_NAMESIZE);
+
+	rte_tel_data_start_dict(d);
+	mp_arg.pool_name = name;
+	mp_arg.d = d;
+	rte_mempool_walk(mempool_cache_stats_cb, &mp_arg);
+
+	return 0;
+}
+
 RTE_INIT(mempool_init_telemetry)
 {
 	rte_telemetry_register_cmd("/mempool/list", mempool_handle_list,
 		"Returns list of available mempool. Takes no parameters");
 	rte_telemetry_register_cmd("/mempool/info", mempool_handle_info,
 		"Returns mempool info. Parameters: pool_name");
+	rte_telemetry_register_cmd("/mempool/cache_stats",
+		mempool_handle_cache_stats,
+		"Returns per-lcore cache statistics. Parameters: pool_name");
 }
@@ -34,6 +34,7 @@
  */
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <inttypes.h>
 
@@ -79,6 +80,20 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/** Size of the return queues, see rte_mempool_remote_free_enable(). */
+#define RTE_MEMPOOL_REMOTE_QUEUE_SIZE RTE_MEMPOOL_CACHE_MAX_SIZE
+
+/**
+ * Return queue of an lcore for the objects it puts in a mempool of
+ * another socket. It is allocated in the memory of the lcore's socket.
+ */
+struct rte_mempool_remote_queue {
+	uint32_t len;      /**< Number of queued objects */
+	uint64_t put_objs; /**< Objects put in the queue */
+	uint64_t flushes;  /**< Bulk returns to the mempool */
+	void *objs[RTE_MEMPOOL_REMOTE_QUEUE_SIZE]; /**< Queued objects */
+} __rte_cache_aligned;
+
 /**
  * A structure that stores a per-core object cache.
  */
@@ -93,6 +108,91 @@ struct rte_mempool_cache {
 	void *objs[RTE_MEMPOOL_CACHE_MAX_SIZE * 3]; /**< Cache objects */
 } __rte_cache_aligned;
 
+/** Default number of get/put calls between two adaptive cache resizes. */
+#define RTE_MEMPOOL_CACHE_ADAPT_WINDOW 1024
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice.
+ *
+ * Configuration of the adaptive sizing of the per-lcore default caches,
+ * see rte_mempool_cache_adaptive_enable(). Zero fields take the default
+ * value.
+ */
+struct rte_mempool_cache_adaptive_conf {
+	/** Smallest cache size, default is a quarter of the cache size. */
+	uint32_t min_size;
+	/**
+	 * Largest cache size, default is RTE_MEMPOOL_CACHE_MAX_SIZE, or less
+	 * for small mempools.
+	 */
+	uint32_t max_size;
+	/**
+	 * Maximum sum of the sizes of the caches in use, in objects.
+	 * Default is the cache size multiplied by the number of lcores.
+	 */
+	uint32_t budget;
+	/**
+	 * Get/put calls on a cache between two resizes, default is
+	 * RTE_MEMPOOL_CACHE_ADAPT_WINDOW.
+	 */
+	uint32_t window;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice.
+ *
+ * Statistics of a per-lcore default cache, see rte_mempool_cache_stats_get().
+ */
+struct rte_mempool_cache_stats {
+	uint32_t size;      /**< Current cache size. */
+	uint32_t len;       /**< Current number of cached objects. */
+	uint64_t ops;       /**< Get/put calls seen in adaptive mode. */
+	uint64_t ring_ops;  /**< Cache refills and flushes among them. */
+	uint64_t grows;     /**< Number of times the cache grew. */
+	uint64_t shrinks;   /**< Number of times the cache shrank. */
+};
+
+/**
+ * @internal State of a per-lcore default cache which is not part of
+ * struct rte_mempool_cache, to keep the layout of the latter.
+ */
+struct rte_mempool_cache_ext {
+	/** Return queue if the lcore is on another socket, or NULL. */
+	struct rte_mempool_remote_queue *remote;
+	/** Get/put calls between two adaptive resizes, 0 if not adaptive. */
+	uint32_t adapt_window;
+	uint32_t win_ops;     /**< Get/put calls in the current window */
+	uint32_t win_ring;    /**< Ring accesses in the current window */
+	uint32_t win_objs;    /**< Objects got or put in the current window */
+	int32_t win_balance;  /**< Objects put minus objects got */
+	uint32_t win_min_len; /**< Lowest count after a get in the window */
+	uint32_t adapt_charged;  /**< Size charged to the mempool budget */
+	/*
+	 * Adaptive mode statistics, updated at the end of each window.
+	 * See rte_mempool_cache_adaptive_enable().
+	 */
+	uint64_t adapt_ops;      /**< Get/put calls in ended windows */
+	uint64_t adapt_ring_ops; /**< Ring accesses in ended windows */
+	uint64_t adapt_grows;    /**< Number of times the cache grew */
+	uint64_t adapt_shrinks;  /**< Number of times the cache shrank */
+} __rte_cache_aligned;
+
+/**
+ * @internal State of a mempool with default caches which is not part of
+ * struct rte_mempool, to keep the layout of the latter. It is stored
+ * after the private data, see rte_mempool_get_ext().
+ */
+struct rte_mempool_ext {
+	/** Adaptive sizing of the default caches, window is 0 if disabled. */
+	struct rte_mempool_cache_adaptive_conf cache_adaptive;
+	uint32_t cache_budget_used; /**< Sum of the adaptive cache sizes. */
+	/** Caches of unregistered threads, see rte_mempool_thread_cache(). */
+	uint32_t nb_thread_caches;
+	struct rte_mempool_cache_ext cache[RTE_MAX_LCORE]; /**< Per lcore */
+};
+
 /**
  * A structure that stores the size of mempool elements.
  */
@@ -286,6 +386,16 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_IOVA_CONTIG	RTE_MEMPOOL_F_NO_IOVA_CONTIG
 /** Internal: no object from the pool can be used for device IO (DMA). */
 #define RTE_MEMPOOL_F_NON_IO		0x0040
+/**
+ * Internal: objects put by lcores of other sockets go to return queues,
+ * see rte_mempool_remote_free_enable().
+ */
+#define RTE_MEMPOOL_F_REMOTE_FREE	0x0080
+/**
+ * Internal: the default caches are resized,
+ * see rte_mempool_cache_adaptive_enable().
+ */
+#define RTE_MEMPOOL_F_CACHE_ADAPTIVE	0x0100
 
 /**
  * This macro lists all the mempool flags an application may request.
@@ -1269,16 +1379,192 @@ rte_mempool_cache_create(uint32_t size, int socket_id);
 void
 rte_mempool_cache_free(struct rte_mempool_cache *cache);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable the adaptive sizing of the per-lcore default caches.
+ *
+ * Every window of get/put calls, each lcore resizes its own cache from
+ * what it observed. A cache which had to refill from or flush to the
+ * common pool too often doubles, within the maximum size and the global
+ * budget. Lcores mostly getting or mostly putting objects, such as Rx or
+ * Tx completion cores, always go to the common pool once per cache size
+ * worth of objects, so they need twice the ring access rate of lcores
+ * balancing gets and puts to grow. A cache which rarely accesses the
+ * common pool and always keeps at least half of its size halves down to
+ * the minimum size, giving back its excess objects. So do the caches while
+ * the budget is exceeded.
+ *
+ * Only the caches of lcores using the mempool are charged to the budget,
+ * from the end of their first window. User-owned caches are not resized.
+ *
+ * This function must not be called while the mempool is used.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param conf
+ *   The adaptive sizing configuration, NULL for the defaults.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The mempool has no cache or the configuration is invalid.
+ */
+__rte_experimental
+int
+rte_mempool_cache_adaptive_enable(struct rte_mempool *mp,
+		const struct rte_mempool_cache_adaptive_conf *conf);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Disable the adaptive sizing of the per-lcore default caches, and reset
+ * them to the mempool cache size. Statistics are kept.
+ *
+ * This function must not be called while the mempool is used.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+__rte_experimental
+void
+rte_mempool_cache_adaptive_disable(struct rte_mempool *mp);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of a per-lcore default cache. Call and ring access
+ * counters are updated at the end of each adaptive window.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The logical core id.
+ * @param stats
+ *   A pointer to the structure to fill.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The mempool has no cache or the lcore id is invalid.
+ */
+__rte_experimental
+int
+rte_mempool_cache_stats_get(struct rte_mempool *mp, unsigned int lcore_id,
+		struct rte_mempool_cache_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Batch the objects put by lcores of other sockets than the mempool's.
+ *
+ * Each EAL lcore of another socket gets a return queue, allocated in the
+ * memory of its socket. Objects it puts in the mempool are stored in this
+ * queue instead of its default cache, and given back to the mempool in
+ * bulk when the queue is full, or when the cache is flushed. This avoids
+ * keeping remote objects in caches, and writing to remote memory on each
+ * put. Gets are not changed.
+ *
+ * The socket of the mempool is the one given at creation or, for
+ * SOCKET_ID_ANY, the one of its memory zone.
+ *
+ * This function must be called before lcores of other sockets use the
+ * mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The mempool has no cache.
+ *   - -ENOMEM: A return queue cannot be allocated.
+ */
+__rte_experimental
+int
+rte_mempool_remote_free_enable(struct rte_mempool *mp);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the cache of the calling unregistered non-EAL thread for a mempool.
+ *
+ * The cache is created on first call, with the size of the default caches
+ * of the mempool. A thread can have caches for up to 8 mempools. The
+ * objects of the caches are given back to the mempools when the thread
+ * exits or is registered with rte_thread_register().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   A pointer to the mempool cache, or NULL if the mempool has no default
+ *   caches, the calling thread has an lcore id, or the cache cannot be
+ *   created.
+ */
+__rte_experimental
+struct rte_mempool_cache *
+rte_mempool_thread_cache(struct rte_mempool *mp);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Give back the objects of all caches of the calling unregistered non-EAL
+ * thread to their mempools.
+ */
+__rte_experimental
+void
+rte_mempool_thread_cache_flush(void);
+
+/**
+ * @internal Get the extension of a mempool with default caches.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   A pointer to the mempool extension.
+ */
+static __rte_always_inline struct rte_mempool_ext *
+rte_mempool_get_ext(const struct rte_mempool *mp)
+{
+	return RTE_PTR_ADD(mp, RTE_MEMPOOL_HEADER_SIZE(mp, mp->cache_size) +
+			mp->private_data_size);
+}
+
+/**
+ * @internal Get the extension of a default cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to a cache of the mempool.
+ * @return
+ *   A pointer to the cache extension, or NULL for a user-owned cache.
+ */
+static __rte_always_inline struct rte_mempool_cache_ext *
+rte_mempool_cache_get_ext(const struct rte_mempool *mp,
+			  const struct rte_mempool_cache *cache)
+{
+	uintptr_t idx = ((uintptr_t)cache - (uintptr_t)mp->local_cache) /
+		sizeof(*cache);
+
+	if (idx >= RTE_MAX_LCORE)
+		return NULL;
+	return &rte_mempool_get_ext(mp)->cache[idx];
+}
+
 /**
  * Get a pointer to the per-lcore default mempool cache.
  *
+ * For LCORE_ID_ANY, the cache of the calling unregistered non-EAL thread
+ * is returned, see rte_mempool_thread_cache(). Only applications allowing
+ * the experimental API get it, others get NULL.
+ *
  * @param mp
  *   A pointer to the mempool structure.
  * @param lcore_id
  *   The logical core id.
  * @return
- *   A pointer to the mempool cache or NULL if disabled or unregistered non-EAL
- *   thread.
+ *   A pointer to the mempool cache or NULL if disabled or not available.
  */
 static __rte_always_inline struct rte_mempool_cache *
 rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
@@ -1286,8 +1572,13 @@ rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
 	if (mp->cache_size == 0)
 		return NULL;
 
-	if (lcore_id >= RTE_MAX_LCORE)
+	if (lcore_id >= RTE_MAX_LCORE) {
+#ifdef ALLOW_EXPERIMENTAL_API
+		if (lcore_id == LCORE_ID_ANY)
+			return rte_mempool_thread_cache(mp);
+#endif
 		return NULL;
+	}
 
 	rte_mempool_trace_default_cache(mp, lcore_id,
 		&mp->local_cache[lcore_id]);
@@ -1308,13 +1599,170 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 {
 	if (cache == NULL)
 		cache = rte_mempool_default_cache(mp, rte_lcore_id());
-	if (cache == NULL || cache->len == 0)
+	if (cache == NULL)
+		return;
+	if (unlikely(mp->flags & RTE_MEMPOOL_F_REMOTE_FREE)) {
+		struct rte_mempool_cache_ext *ce =
+			rte_mempool_cache_get_ext(mp, cache);
+
+		if (ce != NULL && ce->remote != NULL && ce->remote->len != 0) {
+			rte_mempool_ops_enqueue_bulk(mp, ce->remote->objs,
+					ce->remote->len);
+			ce->remote->len = 0;
+			ce->remote->flushes++;
+		}
+	}
+	if (cache->len == 0)
 		return;
 	rte_mempool_trace_cache_flush(cache, mp);
 	rte_mempool_ops_enqueue_bulk(mp, cache->objs, cache->len);
 	cache->len = 0;
 }
 
+/**
+ * @internal Resize a default cache at the end of an adaptive window.
+ * See rte_mempool_cache_adaptive_enable().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the default cache of the calling lcore.
+ * @param ce
+ *   A pointer to the extension of the cache.
+ */
+static inline void
+rte_mempool_cache_adapt(struct rte_mempool *mp,
+			struct rte_mempool_cache *cache,
+			struct rte_mempool_cache_ext *ce)
+{
+	struct rte_mempool_ext *ext = rte_mempool_get_ext(mp);
+	const struct rte_mempool_cache_adaptive_conf *conf =
+		&ext->cache_adaptive;
+	uint32_t size = cache->size;
+	uint32_t new_size = size;
+	uint32_t ring = ce->win_ring;
+	uint32_t ops = ce->win_ops;
+	uint32_t used, grow_div;
+	bool balanced;
+
+	if (ce->adapt_charged == 0) {
+		ce->adapt_charged = size;
+		__atomic_fetch_add(&ext->cache_budget_used, size,
+				__ATOMIC_RELAXED);
+	}
+	used = __atomic_load_n(&ext->cache_budget_used, __ATOMIC_RELAXED);
+
+	/* one-way traffic goes to the ring once per cache size anyway */
+	balanced = (uint32_t)(ce->win_balance < 0 ?
+		-ce->win_balance : ce->win_balance) * 2 <=
+		ce->win_objs;
+	grow_div = balanced ? 8 : 4;
+
+	/* shrink if the common pool is rarely used and half the cache idles */
+	if (used > conf->budget ||
+			(ring * 64 < ops && ce->win_min_len >= size / 2)) {
+		new_size = RTE_MAX(size / 2, conf->min_size);
+	} else if (ring * grow_div > ops) {
+		new_size = RTE_MIN(size * 2, conf->max_size);
+		if (__atomic_add_fetch(&ext->cache_budget_used,
+				new_size - size, __ATOMIC_RELAXED) >
+				conf->budget) {
+			__atomic_fetch_sub(&ext->cache_budget_used,
+					new_size - size, __ATOMIC_RELAXED);
+			new_size = size;
+		}
+	}
+
+	if (new_size < size) {
+		if (cache->len > new_size) {
+			rte_mempool_ops_enqueue_bulk(mp,
+				&cache->objs[new_size],
+				cache->len - new_size);
+			cache->len = new_size;
+		}
+		__atomic_fetch_sub(&ext->cache_budget_used, size - new_size,
+				__ATOMIC_RELAXED);
+		ce->adapt_shrinks++;
+	} else if (new_size > size) {
+		ce->adapt_grows++;
+	}
+	cache->size = new_size;
+	cache->flushthresh = new_size + new_size / 2;
+	ce->adapt_charged = new_size;
+
+	ce->adapt_ops += ops;
+	ce->adapt_ring_ops += ring;
+	ce->win_ops = 0;
+	ce->win_ring = 0;
+	ce->win_objs = 0;
+	ce->win_balance = 0;
+	ce->win_min_len = UINT32_MAX;
+}
+
+/**
+ * @internal Account a get/put call in the adaptive window of a cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the mempool cache structure.
+ * @param n
+ *   The number of objects got or put.
+ * @param put
+ *   True for a put, false for a get.
+ * @param ring
+ *   True if the call accessed the common pool.
+ */
+static __rte_always_inline void
+rte_mempool_cache_adapt_count(struct rte_mempool *mp,
+			      struct rte_mempool_cache *cache, unsigned int n,
+			      bool put, bool ring)
+{
+	struct rte_mempool_cache_ext *ce;
+
+	if (likely(!(mp->flags & RTE_MEMPOOL_F_CACHE_ADAPTIVE)))
+		return;
+	ce = rte_mempool_cache_get_ext(mp, cache);
+	if (ce == NULL || ce->adapt_window == 0)
+		return;
+
+	ce->win_objs += n;
+	ce->win_balance += put ? (int32_t)n : -(int32_t)n;
+	ce->win_ring += ring;
+	if (!put && cache->len < ce->win_min_len)
+		ce->win_min_len = cache->len;
+	if (++ce->win_ops >= ce->adapt_window)
+		rte_mempool_cache_adapt(mp, cache, ce);
+}
+
+/**
+ * @internal Put objects in the return queue of a remote socket lcore,
+ * giving back the queued objects in bulk when it is full.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param q
+ *   A pointer to the return queue of the calling lcore.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects, at most RTE_MEMPOOL_REMOTE_QUEUE_SIZE.
+ */
+static __rte_always_inline void
+rte_mempool_remote_put(struct rte_mempool *mp,
+		       struct rte_mempool_remote_queue *q,
+		       void * const *obj_table, unsigned int n)
+{
+	if (q->len + n > RTE_MEMPOOL_REMOTE_QUEUE_SIZE) {
+		rte_mempool_ops_enqueue_bulk(mp, q->objs, q->len);
+		q->len = 0;
+		q->flushes++;
+	}
+	rte_memcpy(&q->objs[q->len], obj_table, sizeof(void *) * n);
+	q->len += n;
+	q->put_objs += n;
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1341,6 +1789,17 @@ rte_mempool_do_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
 		goto ring_enqueue;
 
+	/* Objects of a remote socket are given back in bulk */
+	if (unlikely(mp->flags & RTE_MEMPOOL_F_REMOTE_FREE)) {
+		struct rte_mempool_cache_ext *ce =
+			rte_mempool_cache_get_ext(mp, cache);
+
+		if (ce != NULL && ce->remote != NULL) {
+			rte_mempool_remote_put(mp, ce->remote, obj_table, n);
+			return;
+		}
+	}
+
 	cache_objs = &cache->objs[cache->len];
 
 	/*
@@ -1359,11 +1818,16 @@ rte_mempool_do_generic_put(struct rte_mempool *mp, void * const *obj_table,
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		rte_mempool_cache_adapt_count(mp, cache, n, true, true);
+	} else {
+		rte_mempool_cache_adapt_count(mp, cache, n, true, false);
 	}
 
 	return;
 
 ring_enqueue:
+	if (cache != NULL)
+		rte_mempool_cache_adapt_count(mp, cache, n, true, true);
 
 	/* push remaining objects in ring */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
@@ -1459,6 +1923,7 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 	int ret;
 	uint32_t index, len;
 	void **cache_objs;
+	bool refill = false;
 
 	/* No cache provided or cannot be satisfied from cache */
 	if (unlikely(cache == NULL || n >= cache->size))
@@ -1485,6 +1950,7 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+		refill = true;
 	}
 
 	/* Now fill in the response ... */
@@ -1492,6 +1958,7 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 		*obj_table = cache_objs[len];
 
 	cache->len -= n;
+	rte_mempool_cache_adapt_count(mp, cache, n, false, refill);
 
 	RTE_MEMPOOL_STAT_ADD(mp, get_success_bulk, 1);
 	RTE_MEMPOOL_STAT_ADD(mp, get_success_objs, n);
@@ -1499,6 +1966,8 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 	return 0;
 
 ring_dequeue:
+	if (cache != NULL)
+		rte_mempool_cache_adapt_count(mp, cache, n, false, true);
 
 	/* get remaining objects from ring */
 	ret = rte_mempool_ops_dequeue_bulk(mp, obj_table, n);
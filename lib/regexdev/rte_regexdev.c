@@ -163,7 +163,7 @@ rte_regexdev_get_dev_id(const char *name)
 		return -EINVAL;
 	for (i = 0; i < RTE_MAX_REGEXDEV_DEVS; i++) {
 		if (rte_regex_devices[i].state != RTE_REGEXDEV_UNUSED)
-			if (strcmp(name, rte_regex_devices[i].data->dev_name)) {
+			if (!strcmp(name, rte_regex_devices[i].data->dev_name)) {
 				id = rte_regex_devices[i].data->dev_id;
 				break;
 			}
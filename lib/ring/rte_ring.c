@@ -13,6 +13,11 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <sys/queue.h>
+#ifdef RTE_EXEC_ENV_LINUX
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -36,7 +41,8 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* mask of all valid flag values to ring_create() */
 #define RING_F_MASK (RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ | \
 		     RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ |	       \
-		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ)
+		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ |	       \
+		     RING_F_NOTIFY)
 
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
@@ -169,8 +175,28 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	return 0;
 }
 
-int
-rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
+static int
+ring_notify_init(struct rte_ring *r)
+{
+#ifdef RTE_EXEC_ENV_LINUX
+	r->notify.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (r->notify.fd < 0) {
+		int ret = -errno;
+
+		RTE_LOG(ERR, RING, "Cannot create eventfd: %s\n",
+			strerror(errno));
+		return ret;
+	}
+	return 0;
+#else
+	RTE_SET_USED(r);
+	RTE_LOG(ERR, RING, "RING_F_NOTIFY is only supported on Linux\n");
+	return -ENOTSUP;
+#endif
+}
+
+static int
+ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	unsigned int flags)
 {
 	int ret;
@@ -232,9 +258,25 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	if (flags & RING_F_MC_RTS_DEQ)
 		rte_ring_set_cons_htd_max(r, r->capacity / HTD_MAX_DEF);
 
+	r->notify.fd = -1;
+
 	return 0;
 }
 
+int
+rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
+	unsigned int flags)
+{
+	/* the eventfd would never be closed, no rte_ring_free() here */
+	if (flags & RING_F_NOTIFY) {
+		RTE_LOG(ERR, RING,
+			"RING_F_NOTIFY requires rte_ring_create()\n");
+		return -EINVAL;
+	}
+
+	return ring_init(r, name, count, flags);
+}
+
 /* create the ring for a given element size */
 struct rte_ring *
 rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
@@ -252,6 +294,15 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 
 	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
 
+	/* the eventfd of the consumer wakeup is private to the process */
+	if ((flags & RING_F_NOTIFY) &&
+			rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		RTE_LOG(ERR, RING,
+			"RING_F_NOTIFY is not supported in secondary processes\n");
+		rte_errno = E_RTE_SECONDARY;
+		return NULL;
+	}
+
 	/* for an exact size ring, round up from count to a power of two */
 	if (flags & RING_F_EXACT_SZ)
 		count = rte_align32pow2(count + 1);
@@ -285,14 +336,22 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 					 mz_flags, __alignof__(*r));
 	if (mz != NULL) {
 		r = mz->addr;
-		/* no need to check return value here, we already checked the
-		 * arguments above */
-		rte_ring_init(r, name, requested_count, flags);
-
-		te->data = (void *) r;
-		r->memzone = mz;
-
-		TAILQ_INSERT_TAIL(ring_list, te, next);
+		/* the size was checked above, but the flags were not, and
+		 * the consumer wakeup eventfd may fail to be created */
+		ret = ring_init(r, name, requested_count, flags);
+		if (ret == 0 && (flags & RING_F_NOTIFY))
+			ret = ring_notify_init(r);
+		if (ret == 0) {
+			te->data = (void *) r;
+			r->memzone = mz;
+
+			TAILQ_INSERT_TAIL(ring_list, te, next);
+		} else {
+			rte_errno = -ret;
+			r = NULL;
+			rte_memzone_free(mz);
+			rte_free(te);
+		}
 	} else {
 		r = NULL;
 		RTE_LOG(ERR, RING, "Cannot reserve memory\n");
@@ -318,6 +377,7 @@ rte_ring_free(struct rte_ring *r)
 {
 	struct rte_ring_list *ring_list = NULL;
 	struct rte_tailq_entry *te;
+	int notify_fd;
 
 	if (r == NULL)
 		return;
@@ -332,10 +392,15 @@ rte_ring_free(struct rte_ring *r)
 		return;
 	}
 
+	notify_fd = r->notify.fd;
 	if (rte_memzone_free(r->memzone) != 0) {
 		RTE_LOG(ERR, RING, "Cannot free memory\n");
 		return;
 	}
+#ifdef RTE_EXEC_ENV_LINUX
+	if (notify_fd >= 0)
+		close(notify_fd);
+#endif
 
 	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
 	rte_mcfg_tailq_write_lock();
@@ -372,6 +437,79 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
+	if (r->flags & RING_F_NOTIFY)
+		fprintf(f, "  notify: fd=%d armed=%"PRIu32"\n",
+			r->notify.fd, r->notify.armed);
+}
+
+int
+rte_ring_notify_fd(const struct rte_ring *r)
+{
+	if (!(r->flags & RING_F_NOTIFY))
+		return -ENOTSUP;
+	return r->notify.fd;
+}
+
+int
+rte_ring_notify_arm(struct rte_ring *r)
+{
+#ifdef RTE_EXEC_ENV_LINUX
+	uint64_t count;
+
+	if (!(r->flags & RING_F_NOTIFY))
+		return -ENOTSUP;
+
+	/* clear the signals of previous arms, the eventfd does not block */
+	if (read(r->notify.fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+		return -errno;
+
+	__atomic_store_n(&r->notify.armed, 1, __ATOMIC_RELAXED);
+
+	/*
+	 * Order the armed flag store before reading the producer tail,
+	 * producers do the opposite in __rte_ring_enqueue_notify().
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (rte_ring_count(r) != 0) {
+		__atomic_store_n(&r->notify.armed, 0, __ATOMIC_RELAXED);
+		return -EAGAIN;
+	}
+	return 0;
+#else
+	RTE_SET_USED(r);
+	return -ENOTSUP;
+#endif
+}
+
+int
+rte_ring_notify_wait(struct rte_ring *r, int timeout)
+{
+#ifdef RTE_EXEC_ENV_LINUX
+	struct pollfd pfd;
+	int ret;
+
+	ret = rte_ring_notify_arm(r);
+	if (ret != 0)
+		return ret == -EAGAIN ? 0 : ret;
+
+	pfd.fd = r->notify.fd;
+	pfd.events = POLLIN;
+	do {
+		ret = poll(&pfd, 1, timeout);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0)
+		return -errno;
+	if (ret > 0)
+		return 0;
+
+	/* timed out: do not let a later enqueue signal a stale wait */
+	__atomic_store_n(&r->notify.armed, 0, __ATOMIC_RELAXED);
+	return rte_ring_count(r) != 0 ? 0 : -ETIMEDOUT;
+#else
+	RTE_SET_USED(r);
+	RTE_SET_USED(timeout);
+	return -ENOTSUP;
+#endif
 }
 
 /* dump the status of all rings on the console */
@@ -417,5 +555,12 @@ rte_ring_lookup(const char *name)
 		return NULL;
 	}
 
+	/* its eventfd is not valid outside of the primary process */
+	if ((r->flags & RING_F_NOTIFY) &&
+			rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		rte_errno = ENOTSUP;
+		return NULL;
+	}
+
 	return r;
 }
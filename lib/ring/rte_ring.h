@@ -115,6 +115,8 @@ ssize_t rte_ring_get_memsize(unsigned int count);
  *     ring space will be wasted.
  *     Without this flag set, the ring size requested must be a power of 2,
  *     and the usable space will be that size - 1.
+ *   - RING_F_NOTIFY: Not supported, the file descriptor of the consumer
+ *     wakeup is only released by rte_ring_free(): use rte_ring_create().
  * @return
  *   0 on success, or a negative value on error.
  */
@@ -176,6 +178,10 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
  *     ring space will be wasted.
  *     Without this flag set, the ring size requested must be a power of 2,
  *     and the usable space will be that size - 1.
+ *   - RING_F_NOTIFY: If this flag is set, a consumer can wait for the
+ *     ring to become non-empty, with rte_ring_notify_wait() or through the
+ *     file descriptor returned by rte_ring_notify_fd(). Only supported in
+ *     the primary process.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
@@ -208,6 +214,68 @@ void rte_ring_free(struct rte_ring *r);
  */
 void rte_ring_dump(FILE *f, const struct rte_ring *r);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the file descriptor signalled when a waiting consumer of a
+ * RING_F_NOTIFY ring must wake up. It can be added to an epoll set, for
+ * instance with rte_epoll_ctl(), to wait for the ring along with other
+ * events. The consumer must call rte_ring_notify_arm() before each wait.
+ *
+ * The file descriptor belongs to the primary process which created the
+ * ring: secondary processes can neither create nor look up such a ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - The file descriptor (an eventfd) on success.
+ *   - -ENOTSUP if the ring was not created with RING_F_NOTIFY.
+ */
+__rte_experimental
+int rte_ring_notify_fd(const struct rte_ring *r);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Prepare the consumer of a RING_F_NOTIFY ring to wait for objects.
+ *
+ * If the ring is empty, producers signal the file descriptor returned by
+ * rte_ring_notify_fd() on the next enqueue, and the consumer can wait on
+ * it. Pending signals are cleared, so a wakeup always follows an arm.
+ * Only one consumer should wait at a time.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 0 if the ring is empty and the consumer can wait.
+ *   - -EAGAIN if the ring is not empty: the consumer must dequeue instead
+ *     of waiting.
+ *   - -ENOTSUP if the ring was not created with RING_F_NOTIFY.
+ */
+__rte_experimental
+int rte_ring_notify_arm(struct rte_ring *r);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Block the consumer of a RING_F_NOTIFY ring until the ring is not empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param timeout
+ *   Maximum time to wait in milliseconds, -1 to wait forever.
+ * @return
+ *   - 0 if the ring is not empty anymore.
+ *   - -ETIMEDOUT if the ring is still empty after *timeout*.
+ *   - -ENOTSUP if the ring was not created with RING_F_NOTIFY.
+ *   - Another negative errno value if waiting failed.
+ */
+__rte_experimental
+int rte_ring_notify_wait(struct rte_ring *r, int timeout);
+
 /**
  * Enqueue several objects on the ring (multi-producers safe).
  *
@@ -660,6 +728,8 @@ void rte_ring_list_dump(FILE *f);
  *   The pointer to the ring matching the name, or NULL if not found,
  *   with rte_errno set appropriately. Possible rte_errno values include:
  *    - ENOENT - required entry not available to return.
+ *    - ENOTSUP - the ring uses RING_F_NOTIFY and the caller is a secondary
+ *      process.
  */
 struct rte_ring *rte_ring_lookup(const char *name);
 
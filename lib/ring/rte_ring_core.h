@@ -28,6 +28,7 @@ extern "C" {
 #include <string.h>
 #include <errno.h>
 #include <rte_common.h>
+#include <rte_compat.h>
 #include <rte_config.h>
 #include <rte_memory.h>
 #include <rte_lcore.h>
@@ -107,6 +108,14 @@ struct rte_ring_hts_headtail {
 	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
 };
 
+/**
+ * Consumer wakeup state of a ring created with RING_F_NOTIFY.
+ */
+struct rte_ring_notify {
+	uint32_t armed; /**< non-zero while the consumer waits for objects */
+	int fd;         /**< eventfd signalled by producers to wake it up */
+};
+
 /**
  * An RTE ring structure.
  *
@@ -127,7 +136,11 @@ struct rte_ring {
 	uint32_t mask;           /**< Mask (size-1) of ring. */
 	uint32_t capacity;       /**< Usable size of ring */
 
-	char pad0 __rte_cache_aligned; /**< empty cache line */
+	/**
+	 * Consumer wakeup state. It is only written when a consumer of a
+	 * RING_F_NOTIFY ring waits, the cache line otherwise stays empty.
+	 */
+	struct rte_ring_notify notify __rte_cache_aligned;
 
 	/** Ring producer status. */
 	RTE_STD_C11
@@ -169,6 +182,14 @@ struct rte_ring {
 #define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
 #define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 
+/**
+ * Consumers can wait for the ring to become non-empty, see
+ * rte_ring_notify_arm(). Producers then check if a consumer waits after
+ * each enqueue. Only supported on Linux, for rings created with
+ * rte_ring_create() in the primary process.
+ */
+#define RING_F_NOTIFY 0x0080
+
 #ifdef __cplusplus
 }
 #endif
@@ -92,6 +92,10 @@ ssize_t rte_ring_get_memsize_elem(unsigned int esize, unsigned int count);
  *        is "multi-consumer HTS mode".
  *     If none of these flags is set, then default "multi-consumer"
  *     behavior is selected.
+ *   - RING_F_NOTIFY: If this flag is set, a consumer can wait for the
+ *     ring to become non-empty, with rte_ring_notify_wait() or through the
+ *     file descriptor returned by rte_ring_notify_fd(). Only supported in
+ *     the primary process.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
@@ -10,12 +10,16 @@
 #ifndef _RTE_RING_ELEM_PVT_H_
 #define _RTE_RING_ELEM_PVT_H_
 
+#ifdef RTE_EXEC_ENV_LINUX
+#include <unistd.h>
+#endif
+
 static __rte_always_inline void
-__rte_ring_enqueue_elems_32(struct rte_ring *r, const uint32_t size,
+__rte_ring_enqueue_elems_32(void *ring_table, const uint32_t size,
 		uint32_t idx, const void *obj_table, uint32_t n)
 {
 	unsigned int i;
-	uint32_t *ring = (uint32_t *)&r[1];
+	uint32_t *ring = (uint32_t *)ring_table;
 	const uint32_t *obj = (const uint32_t *)obj_table;
 	if (likely(idx + n <= size)) {
 		for (i = 0; i < (n & ~0x7); i += 8, idx += 8) {
@@ -54,13 +58,11 @@ __rte_ring_enqueue_elems_32(struct rte_ring *r, const uint32_t size,
 }
 
 static __rte_always_inline void
-__rte_ring_enqueue_elems_64(struct rte_ring *r, uint32_t prod_head,
-		const void *obj_table, uint32_t n)
+__rte_ring_enqueue_elems_64(void *ring_table, const uint32_t size,
+		uint32_t idx, const void *obj_table, uint32_t n)
 {
 	unsigned int i;
-	const uint32_t size = r->size;
-	uint32_t idx = prod_head & r->mask;
-	uint64_t *ring = (uint64_t *)&r[1];
+	uint64_t *ring = (uint64_t *)ring_table;
 	const unaligned_uint64_t *obj = (const unaligned_uint64_t *)obj_table;
 	if (likely(idx + n <= size)) {
 		for (i = 0; i < (n & ~0x3); i += 4, idx += 4) {
@@ -87,13 +89,11 @@ __rte_ring_enqueue_elems_64(struct rte_ring *r, uint32_t prod_head,
 }
 
 static __rte_always_inline void
-__rte_ring_enqueue_elems_128(struct rte_ring *r, uint32_t prod_head,
-		const void *obj_table, uint32_t n)
+__rte_ring_enqueue_elems_128(void *ring_table, const uint32_t size,
+		uint32_t idx, const void *obj_table, uint32_t n)
 {
 	unsigned int i;
-	const uint32_t size = r->size;
-	uint32_t idx = prod_head & r->mask;
-	rte_int128_t *ring = (rte_int128_t *)&r[1];
+	rte_int128_t *ring = (rte_int128_t *)ring_table;
 	const rte_int128_t *obj = (const rte_int128_t *)obj_table;
 	if (likely(idx + n <= size)) {
 		for (i = 0; i < (n & ~0x1); i += 2, idx += 2)
@@ -118,38 +118,49 @@ __rte_ring_enqueue_elems_128(struct rte_ring *r, uint32_t prod_head,
 /* the actual enqueue of elements on the ring.
  * Placed here since identical code needed in both
  * single and multi producer enqueue functions.
+ * It takes the table of elements rather than the ring itself, to be
+ * shared with the staged ordered ring.
  */
 static __rte_always_inline void
-__rte_ring_enqueue_elems(struct rte_ring *r, uint32_t prod_head,
-		const void *obj_table, uint32_t esize, uint32_t num)
+__rte_ring_do_enqueue_elems(void *ring_table, const void *obj_table,
+		uint32_t size, uint32_t idx, uint32_t esize, uint32_t num)
 {
 	/* 8B and 16B copies implemented individually to retain
 	 * the current performance.
 	 */
 	if (esize == 8)
-		__rte_ring_enqueue_elems_64(r, prod_head, obj_table, num);
+		__rte_ring_enqueue_elems_64(ring_table, size, idx,
+				obj_table, num);
 	else if (esize == 16)
-		__rte_ring_enqueue_elems_128(r, prod_head, obj_table, num);
+		__rte_ring_enqueue_elems_128(ring_table, size, idx,
+				obj_table, num);
 	else {
-		uint32_t idx, scale, nr_idx, nr_num, nr_size;
+		uint32_t scale, nr_idx, nr_num, nr_size;
 
 		/* Normalize to uint32_t */
 		scale = esize / sizeof(uint32_t);
 		nr_num = num * scale;
-		idx = prod_head & r->mask;
 		nr_idx = idx * scale;
-		nr_size = r->size * scale;
-		__rte_ring_enqueue_elems_32(r, nr_size, nr_idx,
+		nr_size = size * scale;
+		__rte_ring_enqueue_elems_32(ring_table, nr_size, nr_idx,
 				obj_table, nr_num);
 	}
 }
 
 static __rte_always_inline void
-__rte_ring_dequeue_elems_32(struct rte_ring *r, const uint32_t size,
+__rte_ring_enqueue_elems(struct rte_ring *r, uint32_t prod_head,
+		const void *obj_table, uint32_t esize, uint32_t num)
+{
+	__rte_ring_do_enqueue_elems(&r[1], obj_table, r->size,
+			prod_head & r->mask, esize, num);
+}
+
+static __rte_always_inline void
+__rte_ring_dequeue_elems_32(const void *ring_table, const uint32_t size,
 		uint32_t idx, void *obj_table, uint32_t n)
 {
 	unsigned int i;
-	uint32_t *ring = (uint32_t *)&r[1];
+	const uint32_t *ring = (const uint32_t *)ring_table;
 	uint32_t *obj = (uint32_t *)obj_table;
 	if (likely(idx + n <= size)) {
 		for (i = 0; i < (n & ~0x7); i += 8, idx += 8) {
@@ -188,13 +199,11 @@ __rte_ring_dequeue_elems_32(struct rte_ring *r, const uint32_t size,
 }
 
 static __rte_always_inline void
-__rte_ring_dequeue_elems_64(struct rte_ring *r, uint32_t prod_head,
-		void *obj_table, uint32_t n)
+__rte_ring_dequeue_elems_64(const void *ring_table, const uint32_t size,
+		uint32_t idx, void *obj_table, uint32_t n)
 {
 	unsigned int i;
-	const uint32_t size = r->size;
-	uint32_t idx = prod_head & r->mask;
-	uint64_t *ring = (uint64_t *)&r[1];
+	const uint64_t *ring = (const uint64_t *)ring_table;
 	unaligned_uint64_t *obj = (unaligned_uint64_t *)obj_table;
 	if (likely(idx + n <= size)) {
 		for (i = 0; i < (n & ~0x3); i += 4, idx += 4) {
@@ -221,59 +230,117 @@ __rte_ring_dequeue_elems_64(struct rte_ring *r, uint32_t prod_head,
 }
 
 static __rte_always_inline void
-__rte_ring_dequeue_elems_128(struct rte_ring *r, uint32_t prod_head,
-		void *obj_table, uint32_t n)
+__rte_ring_dequeue_elems_128(const void *ring_table, const uint32_t size,
+		uint32_t idx, void *obj_table, uint32_t n)
 {
 	unsigned int i;
-	const uint32_t size = r->size;
-	uint32_t idx = prod_head & r->mask;
-	rte_int128_t *ring = (rte_int128_t *)&r[1];
+	const rte_int128_t *ring = (const rte_int128_t *)ring_table;
 	rte_int128_t *obj = (rte_int128_t *)obj_table;
 	if (likely(idx + n <= size)) {
 		for (i = 0; i < (n & ~0x1); i += 2, idx += 2)
-			memcpy((void *)(obj + i), (void *)(ring + idx), 32);
+			memcpy((void *)(obj + i),
+				(const void *)(ring + idx), 32);
 		switch (n & 0x1) {
 		case 1:
-			memcpy((void *)(obj + i), (void *)(ring + idx), 16);
+			memcpy((void *)(obj + i),
+				(const void *)(ring + idx), 16);
 		}
 	} else {
 		for (i = 0; idx < size; i++, idx++)
-			memcpy((void *)(obj + i), (void *)(ring + idx), 16);
+			memcpy((void *)(obj + i),
+				(const void *)(ring + idx), 16);
 		/* Start at the beginning */
 		for (idx = 0; i < n; i++, idx++)
-			memcpy((void *)(obj + i), (void *)(ring + idx), 16);
+			memcpy((void *)(obj + i),
+				(const void *)(ring + idx), 16);
 	}
 }
 
 /* the actual dequeue of elements from the ring.
  * Placed here since identical code needed in both
  * single and multi producer enqueue functions.
+ * It takes the table of elements rather than the ring itself, to be
+ * shared with the staged ordered ring.
  */
 static __rte_always_inline void
-__rte_ring_dequeue_elems(struct rte_ring *r, uint32_t cons_head,
-		void *obj_table, uint32_t esize, uint32_t num)
+__rte_ring_do_dequeue_elems(void *obj_table, const void *ring_table,
+		uint32_t size, uint32_t idx, uint32_t esize, uint32_t num)
 {
 	/* 8B and 16B copies implemented individually to retain
 	 * the current performance.
 	 */
 	if (esize == 8)
-		__rte_ring_dequeue_elems_64(r, cons_head, obj_table, num);
+		__rte_ring_dequeue_elems_64(ring_table, size, idx,
+				obj_table, num);
 	else if (esize == 16)
-		__rte_ring_dequeue_elems_128(r, cons_head, obj_table, num);
+		__rte_ring_dequeue_elems_128(ring_table, size, idx,
+				obj_table, num);
 	else {
-		uint32_t idx, scale, nr_idx, nr_num, nr_size;
+		uint32_t scale, nr_idx, nr_num, nr_size;
 
 		/* Normalize to uint32_t */
 		scale = esize / sizeof(uint32_t);
 		nr_num = num * scale;
-		idx = cons_head & r->mask;
 		nr_idx = idx * scale;
-		nr_size = r->size * scale;
-		__rte_ring_dequeue_elems_32(r, nr_size, nr_idx,
+		nr_size = size * scale;
+		__rte_ring_dequeue_elems_32(ring_table, nr_size, nr_idx,
 				obj_table, nr_num);
 	}
 }
 
+static __rte_always_inline void
+__rte_ring_dequeue_elems(struct rte_ring *r, uint32_t cons_head,
+		void *obj_table, uint32_t esize, uint32_t num)
+{
+	__rte_ring_do_dequeue_elems(obj_table, &r[1], r->size,
+			cons_head & r->mask, esize, num);
+}
+
+/**
+ * @internal Wake up the consumer waiting on a RING_F_NOTIFY ring.
+ * The eventfd number is only valid in the primary process which created
+ * the ring, secondary processes cannot get such a ring.
+ */
+static inline void
+__rte_ring_notify_signal(struct rte_ring *r)
+{
+#ifdef RTE_EXEC_ENV_LINUX
+	uint64_t one = 1;
+	ssize_t ret;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return;
+	/* only the first producer after the arm wakes up the consumer */
+	if (__atomic_exchange_n(&r->notify.armed, 0, __ATOMIC_RELAXED) == 0)
+		return;
+	/* cannot fail, the counter is drained by each arm */
+	ret = write(r->notify.fd, &one, sizeof(one));
+	RTE_SET_USED(ret);
+#else
+	RTE_SET_USED(r);
+#endif
+}
+
+/**
+ * @internal Called by producers after the tail update: wakes up the
+ * consumer if it waits for a RING_F_NOTIFY ring to become non-empty.
+ */
+static __rte_always_inline void
+__rte_ring_enqueue_notify(struct rte_ring *r, uint32_t n)
+{
+	if (likely((r->flags & RING_F_NOTIFY) == 0) || n == 0)
+		return;
+
+	/*
+	 * Order the tail update before reading the armed flag, the consumer
+	 * does the opposite in rte_ring_notify_arm(): either it sees the
+	 * objects or the producer sees it waiting.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&r->notify.armed, __ATOMIC_RELAXED) != 0)
+		__rte_ring_notify_signal(r);
+}
+
 /* Between load and load. there might be cpu reorder in weak model
  * (powerpc/arm).
  * There are 2 choices for the users
@@ -328,6 +395,7 @@ __rte_ring_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
 	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
 
 	__rte_ring_update_tail(&r->prod, prod_head, prod_next, is_sp, 1);
+	__rte_ring_enqueue_notify(r, n);
 end:
 	if (free_space != NULL)
 		*free_space = free_entries - n;
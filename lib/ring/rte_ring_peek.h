@@ -188,6 +188,7 @@ rte_ring_enqueue_elem_finish(struct rte_ring *r, const void *obj_table,
 		/* unsupported mode, shouldn't be here */
 		RTE_ASSERT(0);
 	}
+	__rte_ring_enqueue_notify(r, n);
 }
 
 /**
@@ -305,6 +305,7 @@ rte_ring_enqueue_zc_elem_finish(struct rte_ring *r, unsigned int n)
 		/* unsupported mode, shouldn't be here */
 		RTE_ASSERT(0);
 	}
+	__rte_ring_enqueue_notify(r, n);
 }
 
 /**
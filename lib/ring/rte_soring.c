@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_string_fns.h>
+
+#include "soring.h"
+
+/* by default set head/tail distance as 1/8 of ring capacity */
+#define HTD_MAX_DEF	8
+
+static int
+soring_check_param(const struct rte_soring_param *prm, uint32_t *size)
+{
+	if (prm->elem_size == 0 || prm->elem_size % 4 != 0) {
+		RTE_LOG(ERR, RING, "element size is not a multiple of 4\n");
+		return -EINVAL;
+	}
+
+	if (prm->stages == 0) {
+		RTE_LOG(ERR, RING, "a staged ring needs at least one stage\n");
+		return -EINVAL;
+	}
+
+	/* the ring holds exactly the requested number of elements */
+	if (prm->elems == 0 || prm->elems >= RTE_RING_SZ_MASK) {
+		RTE_LOG(ERR, RING,
+			"Requested number of elements is invalid, must be between 1 and %u\n",
+			RTE_RING_SZ_MASK - 1);
+		return -EINVAL;
+	}
+	*size = rte_align32pow2(prm->elems + 1);
+
+	return 0;
+}
+
+static size_t
+soring_stages_offset(void)
+{
+	return RTE_ALIGN(sizeof(struct rte_soring), RTE_CACHE_LINE_SIZE);
+}
+
+static size_t
+soring_state_offset(uint32_t stages)
+{
+	return soring_stages_offset() +
+		(size_t)stages * sizeof(struct soring_stage);
+}
+
+static size_t
+soring_elems_offset(uint32_t stages, uint32_t size)
+{
+	return RTE_ALIGN(soring_state_offset(stages) +
+		(size_t)size * sizeof(union soring_state),
+		RTE_CACHE_LINE_SIZE);
+}
+
+ssize_t
+rte_soring_get_memsize(const struct rte_soring_param *prm)
+{
+	uint32_t size;
+	int ret;
+
+	ret = soring_check_param(prm, &size);
+	if (ret != 0)
+		return ret;
+
+	return RTE_ALIGN(soring_elems_offset(prm->stages, size) +
+		(size_t)size * prm->elem_size, RTE_CACHE_LINE_SIZE);
+}
+
+static int
+soring_init_headtail(void *p, enum rte_ring_sync_type st, uint32_t htd_max)
+{
+	struct rte_ring_headtail *ht = p;
+	struct rte_ring_rts_headtail *ht_rts = p;
+
+	switch (st) {
+	case RTE_RING_SYNC_MT:
+	case RTE_RING_SYNC_ST:
+	case RTE_RING_SYNC_MT_HTS:
+		break;
+	case RTE_RING_SYNC_MT_RTS:
+		ht_rts->htd_max = htd_max;
+		break;
+	default:
+		RTE_LOG(ERR, RING, "Unsupported sync type %d\n", st);
+		return -EINVAL;
+	}
+	ht->sync_type = st;
+	return 0;
+}
+
+int
+rte_soring_init(struct rte_soring *r, const struct rte_soring_param *prm)
+{
+	uint32_t i, size;
+	int ret;
+
+	RTE_BUILD_BUG_ON(offsetof(struct rte_soring, prod) &
+		RTE_CACHE_LINE_MASK);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_soring, cons) &
+		RTE_CACHE_LINE_MASK);
+
+	if (r == NULL || prm == NULL)
+		return -EINVAL;
+
+	ret = soring_check_param(prm, &size);
+	if (ret != 0)
+		return ret;
+
+	memset(r, 0, rte_soring_get_memsize(prm));
+
+	ret = strlcpy(r->name, prm->name, sizeof(r->name));
+	if (ret < 0 || ret >= (int)sizeof(r->name))
+		return -ENAMETOOLONG;
+
+	r->size = size;
+	r->mask = size - 1;
+	r->capacity = prm->elems;
+	r->esize = prm->elem_size;
+	r->nb_stage = prm->stages;
+
+	ret = soring_init_headtail(&r->prod, prm->prod_synt,
+		r->capacity / HTD_MAX_DEF);
+	if (ret == 0)
+		ret = soring_init_headtail(&r->cons, prm->cons_synt,
+			r->capacity / HTD_MAX_DEF);
+	if (ret != 0)
+		return ret;
+
+	r->stage = RTE_PTR_ADD(r, soring_stages_offset());
+	r->state = RTE_PTR_ADD(r, soring_state_offset(r->nb_stage));
+	r->elems = RTE_PTR_ADD(r, soring_elems_offset(r->nb_stage, size));
+
+	for (i = 0; i != r->nb_stage; i++)
+		r->stage[i].sht.sync_type = RTE_RING_SYNC_MT;
+
+	return 0;
+}
+
+uint32_t
+rte_soring_count(const struct rte_soring *r)
+{
+	uint32_t count = (r->prod.ht.tail - r->cons.ht.tail) & r->mask;
+
+	return (count > r->capacity) ? r->capacity : count;
+}
+
+uint32_t
+rte_soring_free_count(const struct rte_soring *r)
+{
+	return r->capacity - rte_soring_count(r);
+}
+
+void
+rte_soring_dump(FILE *f, const struct rte_soring *r)
+{
+	uint32_t i;
+
+	fprintf(f, "soring <%s>@%p\n", r->name, r);
+	fprintf(f, "  size=%"PRIu32"\n", r->size);
+	fprintf(f, "  capacity=%"PRIu32"\n", r->capacity);
+	fprintf(f, "  esize=%"PRIu32"\n", r->esize);
+	fprintf(f, "  stages=%"PRIu32"\n", r->nb_stage);
+	fprintf(f, "  ct=%"PRIu32"\n", r->cons.ht.tail);
+	fprintf(f, "  pt=%"PRIu32"\n", r->prod.ht.tail);
+	for (i = 0; i != r->nb_stage; i++) {
+		fprintf(f, "  stage[%"PRIu32"].h=%"PRIu32"\n",
+			i, r->stage[i].sht.head);
+		fprintf(f, "  stage[%"PRIu32"].t=%"PRIu32"\n",
+			i, r->stage[i].sht.tail);
+	}
+	fprintf(f, "  used=%u\n", rte_soring_count(r));
+	fprintf(f, "  avail=%u\n", rte_soring_free_count(r));
+}
@@ -0,0 +1,329 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef _RTE_SORING_H_
+#define _RTE_SORING_H_
+
+/**
+ * @file
+ * This file contains definition of RTE staged ordered ring (SORING) public
+ * API.
+ *
+ * A staged ordered ring is a ring of objects, where the objects stay in
+ * place while they go through several processing stages between the
+ * producer and the consumer:
+ *
+ *   producer -> stage 0 -> stage 1 -> ... -> stage N-1 -> consumer
+ *
+ * Each stage has its own head and tail. Threads of a stage acquire
+ * objects that were released by the previous stage (or enqueued by the
+ * producer, for stage 0), process them and release them to the next
+ * stage. Several threads can acquire from the same stage concurrently,
+ * and release in any order: the tail of a stage only moves over released
+ * objects, so the consumer gets the objects in the order of the producer.
+ *
+ * Compared to a pipeline of rings, an object is enqueued and dequeued
+ * only once. Every stage transition only updates the stage's own
+ * head/tail, without copying the object to another ring.
+ *
+ * Producer and consumer support the same synchronization modes as rte_ring
+ * (MT, ST, MT_RTS and MT_HTS), stages are always multi-thread safe.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_ring.h>
+
+/** Opaque staged ordered ring structure. */
+struct rte_soring;
+
+/** Parameters of a staged ordered ring. */
+struct rte_soring_param {
+	/** Name of the ring. */
+	const char *name;
+	/** Number of elements the ring can hold. */
+	uint32_t elems;
+	/** Size of an element in bytes, must be a multiple of 4. */
+	uint32_t elem_size;
+	/** Number of stages, at least 1. */
+	uint32_t stages;
+	/** Synchronization mode of the producer. */
+	enum rte_ring_sync_type prod_synt;
+	/** Synchronization mode of the consumer. */
+	enum rte_ring_sync_type cons_synt;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Calculate the memory size needed for a staged ordered ring.
+ *
+ * @param prm
+ *   Pointer to the ring parameters.
+ * @return
+ *   - The memory size needed for the ring on success.
+ *   - -EINVAL if a parameter is invalid.
+ */
+__rte_experimental
+ssize_t
+rte_soring_get_memsize(const struct rte_soring_param *prm);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Initialize a staged ordered ring in memory provided by the caller,
+ * of at least the size returned by rte_soring_get_memsize() and aligned
+ * on a cache line.
+ *
+ * @param r
+ *   Pointer to the ring memory.
+ * @param prm
+ *   Pointer to the ring parameters.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if a parameter is invalid.
+ *   - -ENAMETOOLONG if the name is too long.
+ */
+__rte_experimental
+int
+rte_soring_init(struct rte_soring *r, const struct rte_soring_param *prm);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Return the number of objects in the ring, whatever their stage.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @return
+ *   The number of objects between the producer and the consumer.
+ */
+__rte_experimental
+uint32_t
+rte_soring_count(const struct rte_soring *r);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Return the number of free entries in the ring.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @return
+ *   The number of objects that can be enqueued.
+ */
+__rte_experimental
+uint32_t
+rte_soring_free_count(const struct rte_soring *r);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dump the status of the ring and of its stages to a file.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ * @param r
+ *   Pointer to the ring.
+ */
+__rte_experimental
+void
+rte_soring_dump(FILE *f, const struct rte_soring *r);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue exactly *n* objects on the ring, or none of them.
+ * Enqueued objects become available to stage 0.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size.
+ * @param n
+ *   The number of objects to enqueue.
+ * @param free_space
+ *   If non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued, either 0 or n.
+ */
+__rte_experimental
+uint32_t
+rte_soring_enqueue_bulk(struct rte_soring *r, const void *objs, uint32_t n,
+	uint32_t *free_space);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue up to *n* objects on the ring.
+ * Enqueued objects become available to stage 0.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size.
+ * @param n
+ *   The number of objects to enqueue.
+ * @param free_space
+ *   If non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued.
+ */
+__rte_experimental
+uint32_t
+rte_soring_enqueue_burst(struct rte_soring *r, const void *objs, uint32_t n,
+	uint32_t *free_space);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue exactly *n* objects released by the last stage, or none of them.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size,
+ *   filled with the dequeued objects.
+ * @param n
+ *   The number of objects to dequeue.
+ * @param available
+ *   If non-NULL, returns the number of objects that remain available to
+ *   the consumer after the dequeue has finished.
+ * @return
+ *   The number of objects dequeued, either 0 or n.
+ */
+__rte_experimental
+uint32_t
+rte_soring_dequeue_bulk(struct rte_soring *r, void *objs, uint32_t n,
+	uint32_t *available);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue up to *n* objects released by the last stage.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size,
+ *   filled with the dequeued objects.
+ * @param n
+ *   The number of objects to dequeue.
+ * @param available
+ *   If non-NULL, returns the number of objects that remain available to
+ *   the consumer after the dequeue has finished.
+ * @return
+ *   The number of objects dequeued.
+ */
+__rte_experimental
+uint32_t
+rte_soring_dequeue_burst(struct rte_soring *r, void *objs, uint32_t n,
+	uint32_t *available);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Acquire exactly *n* objects for processing by a stage, or none of them.
+ * The objects must then be given to the next stage with
+ * rte_soring_release(), using the returned token.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size,
+ *   filled with the acquired objects. Can be NULL if the stage does
+ *   not need to read them.
+ * @param stage
+ *   The stage to acquire objects for.
+ * @param n
+ *   The number of objects to acquire.
+ * @param ftoken
+ *   Returns the token to pass to rte_soring_release().
+ * @param available
+ *   If non-NULL, returns the number of objects that remain available to
+ *   the stage after the acquire has finished.
+ * @return
+ *   The number of objects acquired, either 0 or n.
+ */
+__rte_experimental
+uint32_t
+rte_soring_acquire_bulk(struct rte_soring *r, void *objs, uint32_t stage,
+	uint32_t n, uint32_t *ftoken, uint32_t *available);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Acquire up to *n* objects for processing by a stage.
+ * The objects must then be given to the next stage with
+ * rte_soring_release(), using the returned token.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size,
+ *   filled with the acquired objects. Can be NULL if the stage does
+ *   not need to read them.
+ * @param stage
+ *   The stage to acquire objects for.
+ * @param n
+ *   The maximum number of objects to acquire.
+ * @param ftoken
+ *   Returns the token to pass to rte_soring_release().
+ * @param available
+ *   If non-NULL, returns the number of objects that remain available to
+ *   the stage after the acquire has finished.
+ * @return
+ *   The number of objects acquired.
+ */
+__rte_experimental
+uint32_t
+rte_soring_acquire_burst(struct rte_soring *r, void *objs, uint32_t stage,
+	uint32_t n, uint32_t *ftoken, uint32_t *available);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Release objects acquired by a stage, making them available to the next
+ * stage, or to the consumer after the last stage. All the objects of an
+ * acquire must be released at once, but acquires of a stage can be
+ * released in any order.
+ *
+ * @param r
+ *   Pointer to the ring.
+ * @param objs
+ *   Pointer to a table of *n* elements of the ring element size, replacing
+ *   the acquired objects in the ring. Can be NULL to keep them unchanged.
+ * @param stage
+ *   The stage the objects were acquired for.
+ * @param n
+ *   The number of objects returned by the acquire.
+ * @param ftoken
+ *   The token returned by the acquire.
+ */
+__rte_experimental
+void
+rte_soring_release(struct rte_soring *r, const void *objs, uint32_t stage,
+	uint32_t n, uint32_t ftoken);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SORING_H_ */
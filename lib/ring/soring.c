@@ -0,0 +1,286 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+/**
+ * @file
+ * Data path of the staged ordered ring.
+ *
+ * Producer, stages and consumer move their heads with the same helpers as
+ * rte_ring, each one limited by the tail of the previous one (the consumer
+ * tail, one lap behind, for the producer).
+ *
+ * The tail of a stage can only move over ranges released in order. A
+ * releasing thread marks its range as finished in the state table, then
+ * tries to become the single thread moving the stage tail, which walks
+ * over all the consecutive finished ranges. If another thread is already
+ * moving the tail, the range is left for it or for the next release. The
+ * next stage (or the consumer) also moves the tail when it runs short of
+ * objects, so that no released range is left behind.
+ */
+
+#include <rte_ring_elem.h>
+
+#include "soring.h"
+
+static __rte_always_inline bool
+soring_state_finished(const struct rte_soring *r, uint32_t pos,
+	union soring_state *st)
+{
+	st->raw = __atomic_load_n(&r->state[pos & r->mask].raw,
+		__ATOMIC_ACQUIRE);
+	return (st->stnum & SORING_ST_FINISH) != 0 && st->ftoken == pos;
+}
+
+/* Move the tail of a stage over its consecutive released ranges. */
+static void
+soring_stage_finalize(struct rte_soring *r, uint32_t stage)
+{
+	struct soring_stage *stg = &r->stage[stage];
+	union soring_state st;
+	uint32_t head, tail, zero;
+
+	tail = __atomic_load_n(&stg->sht.tail, __ATOMIC_RELAXED);
+	if (!soring_state_finished(r, tail, &st))
+		return;
+
+	/* another thread is moving the tail */
+	zero = 0;
+	if (__atomic_compare_exchange_n(&stg->finalize, &zero, 1, 0,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == 0)
+		return;
+
+	/* only the finalizing thread writes the tail */
+	tail = stg->sht.tail;
+	head = __atomic_load_n(&stg->sht.head, __ATOMIC_ACQUIRE);
+	while (tail != head && soring_state_finished(r, tail, &st)) {
+		__atomic_store_n(&r->state[tail & r->mask].raw, 0,
+			__ATOMIC_RELAXED);
+		tail += st.stnum & ~SORING_ST_FINISH;
+	}
+
+	/* synchronize with the load-acquire of the next stage head move */
+	__atomic_store_n(&stg->sht.tail, tail, __ATOMIC_RELEASE);
+	__atomic_store_n(&stg->finalize, 0, __ATOMIC_RELEASE);
+}
+
+static __rte_always_inline uint32_t
+soring_enqueue(struct rte_soring *r, const void *objs, uint32_t n,
+	enum rte_ring_queue_behavior behavior, uint32_t *free_space)
+{
+	uint32_t free, head, next;
+
+	switch (r->prod.ht.sync_type) {
+	case RTE_RING_SYNC_MT:
+	case RTE_RING_SYNC_ST:
+		n = __rte_ring_headtail_move_head(&r->prod.ht, &r->cons.ht,
+			r->capacity, r->prod.ht.sync_type == RTE_RING_SYNC_ST,
+			n, behavior, &head, &next, &free);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		n = __rte_ring_hts_move_head(&r->prod.hts, &r->cons.ht,
+			r->capacity, n, behavior, &head, &free);
+		break;
+	case RTE_RING_SYNC_MT_RTS:
+		n = __rte_ring_rts_move_head(&r->prod.rts, &r->cons.ht,
+			r->capacity, n, behavior, &head, &free);
+		break;
+	default:
+		/* unsupported mode, shouldn't be here */
+		RTE_ASSERT(0);
+		n = 0;
+		free = 0;
+	}
+
+	if (n != 0) {
+		__rte_ring_do_enqueue_elems(r->elems, objs, r->size,
+			head & r->mask, r->esize, n);
+
+		switch (r->prod.ht.sync_type) {
+		case RTE_RING_SYNC_MT:
+		case RTE_RING_SYNC_ST:
+			__rte_ring_update_tail(&r->prod.ht, head, head + n,
+				r->prod.ht.sync_type == RTE_RING_SYNC_ST, 1);
+			break;
+		case RTE_RING_SYNC_MT_HTS:
+			__rte_ring_hts_update_tail(&r->prod.hts, head, n, 1);
+			break;
+		case RTE_RING_SYNC_MT_RTS:
+			__rte_ring_rts_update_tail(&r->prod.rts);
+			break;
+		default:
+			RTE_ASSERT(0);
+		}
+	}
+
+	if (free_space != NULL)
+		*free_space = free - n;
+	return n;
+}
+
+static __rte_always_inline uint32_t
+soring_dequeue(struct rte_soring *r, void *objs, uint32_t num,
+	enum rte_ring_queue_behavior behavior, uint32_t *available)
+{
+	const struct rte_ring_headtail *s;
+	uint32_t entries, head, n, next;
+
+	s = &r->stage[r->nb_stage - 1].sht;
+
+	switch (r->cons.ht.sync_type) {
+	case RTE_RING_SYNC_MT:
+	case RTE_RING_SYNC_ST:
+		n = __rte_ring_headtail_move_head(&r->cons.ht, s, 0,
+			r->cons.ht.sync_type == RTE_RING_SYNC_ST,
+			num, behavior, &head, &next, &entries);
+
+#ifndef RTE_USE_C11_MEM_MODEL
+		/* as for rte_ring, order the object loads after the tail */
+		if (r->cons.ht.sync_type == RTE_RING_SYNC_ST && n != 0)
+			rte_smp_rmb();
+#endif
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		n = __rte_ring_hts_move_head(&r->cons.hts, s, 0,
+			num, behavior, &head, &entries);
+		break;
+	case RTE_RING_SYNC_MT_RTS:
+		n = __rte_ring_rts_move_head(&r->cons.rts, s, 0,
+			num, behavior, &head, &entries);
+		break;
+	default:
+		/* unsupported mode, shouldn't be here */
+		RTE_ASSERT(0);
+		n = 0;
+		entries = 0;
+	}
+
+	if (n != 0) {
+		__rte_ring_do_dequeue_elems(objs, r->elems, r->size,
+			head & r->mask, r->esize, n);
+
+		switch (r->cons.ht.sync_type) {
+		case RTE_RING_SYNC_MT:
+		case RTE_RING_SYNC_ST:
+			__rte_ring_update_tail(&r->cons.ht, head, head + n,
+				r->cons.ht.sync_type == RTE_RING_SYNC_ST, 0);
+			break;
+		case RTE_RING_SYNC_MT_HTS:
+			__rte_ring_hts_update_tail(&r->cons.hts, head, n, 0);
+			break;
+		case RTE_RING_SYNC_MT_RTS:
+			__rte_ring_rts_update_tail(&r->cons.rts);
+			break;
+		default:
+			RTE_ASSERT(0);
+		}
+	}
+
+	/* released ranges may be waiting for the last stage tail */
+	if (n < num)
+		soring_stage_finalize(r, r->nb_stage - 1);
+
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+static __rte_always_inline uint32_t
+soring_acquire(struct rte_soring *r, void *objs, uint32_t stage,
+	uint32_t num, enum rte_ring_queue_behavior behavior, uint32_t *ftoken,
+	uint32_t *available)
+{
+	const struct rte_ring_headtail *s;
+	uint32_t entries, head, n, next;
+
+	RTE_ASSERT(stage < r->nb_stage);
+
+	s = (stage == 0) ? &r->prod.ht : &r->stage[stage - 1].sht;
+
+	n = __rte_ring_headtail_move_head(&r->stage[stage].sht, s, 0, 0,
+		num, behavior, &head, &next, &entries);
+
+	if (n != 0) {
+		if (objs != NULL)
+			__rte_ring_do_dequeue_elems(objs, r->elems, r->size,
+				head & r->mask, r->esize, n);
+		*ftoken = head;
+	}
+
+	/* released ranges may be waiting for the previous stage tail */
+	if (n < num && stage != 0)
+		soring_stage_finalize(r, stage - 1);
+
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+uint32_t
+rte_soring_enqueue_bulk(struct rte_soring *r, const void *objs, uint32_t n,
+	uint32_t *free_space)
+{
+	return soring_enqueue(r, objs, n, RTE_RING_QUEUE_FIXED, free_space);
+}
+
+uint32_t
+rte_soring_enqueue_burst(struct rte_soring *r, const void *objs, uint32_t n,
+	uint32_t *free_space)
+{
+	return soring_enqueue(r, objs, n, RTE_RING_QUEUE_VARIABLE,
+		free_space);
+}
+
+uint32_t
+rte_soring_dequeue_bulk(struct rte_soring *r, void *objs, uint32_t n,
+	uint32_t *available)
+{
+	return soring_dequeue(r, objs, n, RTE_RING_QUEUE_FIXED, available);
+}
+
+uint32_t
+rte_soring_dequeue_burst(struct rte_soring *r, void *objs, uint32_t n,
+	uint32_t *available)
+{
+	return soring_dequeue(r, objs, n, RTE_RING_QUEUE_VARIABLE,
+		available);
+}
+
+uint32_t
+rte_soring_acquire_bulk(struct rte_soring *r, void *objs, uint32_t stage,
+	uint32_t n, uint32_t *ftoken, uint32_t *available)
+{
+	return soring_acquire(r, objs, stage, n, RTE_RING_QUEUE_FIXED,
+		ftoken, available);
+}
+
+uint32_t
+rte_soring_acquire_burst(struct rte_soring *r, void *objs, uint32_t stage,
+	uint32_t n, uint32_t *ftoken, uint32_t *available)
+{
+	return soring_acquire(r, objs, stage, n, RTE_RING_QUEUE_VARIABLE,
+		ftoken, available);
+}
+
+void
+rte_soring_release(struct rte_soring *r, const void *objs, uint32_t stage,
+	uint32_t n, uint32_t ftoken)
+{
+	union soring_state st;
+
+	RTE_ASSERT(stage < r->nb_stage);
+
+	if (n == 0)
+		return;
+
+	if (objs != NULL)
+		__rte_ring_do_enqueue_elems(r->elems, objs, r->size,
+			ftoken & r->mask, r->esize, n);
+
+	st.ftoken = ftoken;
+	st.stnum = SORING_ST_FINISH | n;
+	__atomic_store_n(&r->state[ftoken & r->mask].raw, st.raw,
+		__ATOMIC_RELEASE);
+
+	soring_stage_finalize(r, stage);
+}
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef _SORING_H_
+#define _SORING_H_
+
+/**
+ * @file
+ * Internal layout of the staged ordered ring.
+ *
+ * The ring memory holds, in that order: struct rte_soring, the stages,
+ * the state table and the elements table. The state table has one entry
+ * per element, set by rte_soring_release() at the position of the first
+ * element of the released range.
+ */
+
+#include <rte_bitops.h>
+#include <rte_soring.h>
+
+/* The range is released: set in *stnum* along with the range length. */
+#define SORING_ST_FINISH	RTE_BIT32(31)
+
+union soring_state {
+	/** raw 8B value to read/write *ftoken* and *stnum* as one atomic op */
+	uint64_t raw __rte_aligned(8);
+	RTE_STD_C11
+	struct {
+		uint32_t ftoken; /**< position of the range start */
+		uint32_t stnum;  /**< SORING_ST_FINISH | range length */
+	};
+};
+
+struct soring_stage {
+	/** head: end of acquired objects, tail: end of released objects */
+	struct rte_ring_headtail sht;
+	/** set while a thread moves the tail over released ranges */
+	uint32_t finalize;
+} __rte_cache_aligned;
+
+struct rte_soring {
+	uint32_t size;     /**< size of the ring, power of 2 */
+	uint32_t mask;     /**< size - 1 */
+	uint32_t capacity; /**< usable size of the ring */
+	uint32_t esize;    /**< size of an element, in bytes */
+	uint32_t nb_stage; /**< number of stages */
+
+	struct soring_stage *stage;
+	union soring_state *state;
+	void *elems;
+
+	/** Ring producer status. */
+	RTE_STD_C11
+	union {
+		struct rte_ring_headtail ht;
+		struct rte_ring_hts_headtail hts;
+		struct rte_ring_rts_headtail rts;
+	} prod __rte_cache_aligned;
+
+	/** Ring consumer status. */
+	RTE_STD_C11
+	union {
+		struct rte_ring_headtail ht;
+		struct rte_ring_hts_headtail hts;
+		struct rte_ring_rts_headtail rts;
+	} cons __rte_cache_aligned;
+
+	char name[RTE_RING_NAMESIZE] __rte_cache_aligned;
+};
+
+#endif /* _SORING_H_ */
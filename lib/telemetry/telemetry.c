@@ -4,7 +4,10 @@
 
 #ifndef RTE_EXEC_ENV_WINDOWS
 #include <unistd.h>
+#include <limits.h>
+#include <poll.h>
 #include <pthread.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
@@ -20,16 +23,14 @@
 #include "rte_telemetry.h"
 #include "telemetry_json.h"
 #include "telemetry_data.h"
+#include "telemetry_delta.h"
 #include "telemetry_internal.h"
 
 #define MAX_CMD_LEN 56
 #define MAX_OUTPUT_LEN (1024 * 16)
 #define MAX_CONNECTIONS 10
-
-#ifndef RTE_EXEC_ENV_WINDOWS
-static void *
-client_handler(void *socket);
-#endif /* !RTE_EXEC_ENV_WINDOWS */
+#define MAX_SUBSCRIPTIONS 256 /* per client */
+#define NUM_WORKERS 2
 
 struct cmd_callback {
 	char cmd[MAX_CMD_LEN];
@@ -46,6 +47,39 @@ struct socket {
 };
 static struct socket v2_socket; /* socket for v2 telemetry */
 static struct socket v1_socket; /* socket for v1 telemetry */
+
+/* a command periodically run and pushed to a client */
+struct subscription {
+	char key[MAX_CMD_LEN];    /* "command[,params]", key of the pushes */
+	char cmd[MAX_CMD_LEN];
+	char params[MAX_CMD_LEN];
+	int has_params;
+	telemetry_cb fn;
+	unsigned int id;
+	uint64_t interval;        /* in ms */
+	uint64_t deadline;        /* time of the next push, in ms */
+	int delta;                /* only push what changed */
+	struct rte_tel_data *last; /* last result, for delta subscriptions */
+};
+
+struct client {
+	int sock;                 /* -1 for a free slot */
+	unsigned int next_id;
+	unsigned int num_subs;
+	struct subscription *subs;
+};
+
+/*
+ * v2 clients are served by a fixed pool of workers, each one polling its
+ * clients and running their subscriptions, instead of a thread per client.
+ */
+struct worker {
+	pthread_t th;
+	int pipe[2];              /* the listener sends accepted sockets here */
+	uint16_t num_clients;
+	struct client clients[MAX_CONNECTIONS];
+};
+static struct worker workers[NUM_WORKERS];
 #endif /* !RTE_EXEC_ENV_WINDOWS */
 
 static const char *telemetry_version; /* save rte_version */
@@ -149,6 +183,14 @@ command_help(const char *cmd __rte_unused, const char *params,
 	return 0;
 }
 
+static int
+subscription_cmd(const char *cmd __rte_unused, const char *params __rte_unused,
+		struct rte_tel_data *d __rte_unused)
+{
+	/* handled by the workers, which know the client */
+	return -1;
+}
+
 static int
 container_to_json(const struct rte_tel_data *d, char *out_buf, size_t buf_len)
 {
@@ -215,7 +257,22 @@ container_to_json(const struct rte_tel_data *d, char *out_buf, size_t buf_len)
 	return used;
 }
 
-static void
+/*
+ * Clients share the worker threads, so a client which does not read its
+ * replies must not block the others: it is closed instead.
+ * Return -1 if the reply was not sent entirely.
+ */
+static int
+send_reply(int s, const char *buf, size_t len)
+{
+	ssize_t ret = send(s, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+	if (ret < 0 && errno != EAGAIN)
+		perror("Error writing to socket");
+	return ret == (ssize_t)len ? 0 : -1;
+}
+
+static int
 output_json(const char *cmd, const struct rte_tel_data *d, int s)
 {
 	char out_buf[MAX_OUTPUT_LEN];
@@ -320,25 +377,28 @@ output_json(const char *cmd, const struct rte_tel_data *d, int s)
 		used += strlcat(out_buf + used, "}", sizeof(out_buf) - used);
 		break;
 	}
-	if (write(s, out_buf, used) < 0)
-		perror("Error writing to socket");
+	return send_reply(s, out_buf, used);
 }
 
-static void
-perform_command(telemetry_cb fn, const char *cmd, const char *param, int s)
+static int
+output_result(const char *cmd, int ret, const struct rte_tel_data *d, int s)
 {
-	struct rte_tel_data data;
-
-	int ret = fn(cmd, param, &data);
 	if (ret < 0) {
 		char out_buf[MAX_CMD_LEN + 10];
 		int used = snprintf(out_buf, sizeof(out_buf), "{\"%.*s\":null}",
 				MAX_CMD_LEN, cmd ? cmd : "none");
-		if (write(s, out_buf, used) < 0)
-			perror("Error writing to socket");
-		return;
+		return send_reply(s, out_buf, used);
 	}
-	output_json(cmd, &data, s);
+	return output_json(cmd, d, s);
+}
+
+static int
+perform_command(telemetry_cb fn, const char *cmd, const char *param, int s)
+{
+	struct rte_tel_data data;
+
+	int ret = fn(cmd, param, &data);
+	return output_result(cmd, ret, &data, s);
 }
 
 static int
@@ -348,47 +408,327 @@ unknown_command(const char *cmd __rte_unused, const char *params __rte_unused,
 	return d->type = RTE_TEL_NULL;
 }
 
-static void *
-client_handler(void *sock_id)
+static uint64_t
+time_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static telemetry_cb
+lookup_command(const char *cmd)
+{
+	telemetry_cb fn = unknown_command;
+	int i;
+
+	if (cmd && strlen(cmd) < MAX_CMD_LEN) {
+		rte_spinlock_lock(&callback_sl);
+		for (i = 0; i < num_callbacks; i++)
+			if (strcmp(cmd, callbacks[i].cmd) == 0) {
+				fn = callbacks[i].fn;
+				break;
+			}
+		rte_spinlock_unlock(&callback_sl);
+	}
+	return fn;
+}
+
+/*
+ * Handle "/subscribe,<interval_ms>,<command>[,<params>]", and the same with
+ * "/subscribe_delta". The command result is then pushed every interval,
+ * under the "<command>[,<params>]" key.
+ */
+static int
+client_subscribe(struct client *c, const char *cmd, const char *param,
+		struct rte_tel_data *d)
+{
+	struct subscription *sub;
+	unsigned long interval;
+	const char *command;
+	char *end;
+	size_t len;
+
+	if (param == NULL)
+		return -EINVAL;
+	interval = strtoul(param, &end, 10);
+	if (end == param || *end != ',' || interval == 0 || interval > INT_MAX)
+		return -EINVAL;
+	command = end + 1;
+
+	/* the key is output as is, it must not need escaping */
+	if (strlen(command) >= MAX_CMD_LEN || strpbrk(command, "\"\\") != NULL)
+		return -EINVAL;
+	if (c->num_subs == MAX_SUBSCRIPTIONS)
+		return -ENOSPC;
+
+	sub = realloc(c->subs, sizeof(*sub) * (c->num_subs + 1));
+	if (sub == NULL)
+		return -ENOMEM;
+	c->subs = sub;
+	sub = &c->subs[c->num_subs];
+	memset(sub, 0, sizeof(*sub));
+
+	strlcpy(sub->key, command, sizeof(sub->key));
+	len = strcspn(command, ",");
+	strlcpy(sub->cmd, command, len + 1);
+	if (command[len] == ',') {
+		strlcpy(sub->params, command + len + 1, sizeof(sub->params));
+		sub->has_params = 1;
+	}
+	sub->fn = lookup_command(sub->cmd);
+	if (sub->fn == unknown_command || sub->fn == subscription_cmd)
+		return -EINVAL;
+
+	sub->id = c->next_id++;
+	sub->interval = interval;
+	sub->deadline = time_ms(); /* first push right after the reply */
+	sub->delta = strcmp(cmd, "/subscribe_delta") == 0;
+	c->num_subs++;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_int(d, "id", sub->id);
+	rte_tel_data_add_dict_string(d, "key", sub->key);
+	return 0;
+}
+
+/* Handle "/unsubscribe[,<id>]", removing all subscriptions without id. */
+static int
+client_unsubscribe(struct client *c, const char *param,
+		struct rte_tel_data *d)
+{
+	unsigned long id = 0;
+	unsigned int i, n;
+	char *end;
+
+	if (param != NULL) {
+		id = strtoul(param, &end, 10);
+		if (end == param || *end != '\0')
+			return -EINVAL;
+	}
+
+	for (i = 0, n = 0; i < c->num_subs; i++) {
+		if (param == NULL || c->subs[i].id == id) {
+			free(c->subs[i].last);
+			continue;
+		}
+		c->subs[n++] = c->subs[i];
+	}
+	if (param != NULL && n == c->num_subs)
+		return -ENOENT;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_int(d, "removed", c->num_subs - n);
+	c->num_subs = n;
+	return 0;
+}
+
+static void
+client_close(struct worker *w, struct client *c)
+{
+	unsigned int i;
+
+	for (i = 0; i < c->num_subs; i++)
+		free(c->subs[i].last);
+	c->num_subs = 0;
+	free(c->subs);
+	c->subs = NULL;
+	close(c->sock);
+	c->sock = -1;
+	__atomic_sub_fetch(&w->num_clients, 1, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&v2_clients, 1, __ATOMIC_RELAXED);
+}
+
+static void
+client_read(struct worker *w, struct client *c)
 {
-	int s = (int)(uintptr_t)sock_id;
 	char buffer[1024];
+	int bytes;
+
+	/* receive data is not null terminated */
+	bytes = read(c->sock, buffer, sizeof(buffer) - 1);
+	if (bytes <= 0) {
+		client_close(w, c);
+		return;
+	}
+	buffer[bytes] = 0;
+
+	const char *cmd = strtok(buffer, ",");
+	const char *param = strtok(NULL, "\0");
+	telemetry_cb fn = lookup_command(cmd);
+
+	if (fn == subscription_cmd) {
+		struct rte_tel_data data;
+		int ret;
+
+		if (strcmp(cmd, "/unsubscribe") == 0)
+			ret = client_unsubscribe(c, param, &data);
+		else
+			ret = client_subscribe(c, cmd, param, &data);
+		if (output_result(cmd, ret, &data, c->sock) < 0)
+			client_close(w, c);
+		return;
+	}
+	if (perform_command(fn, cmd, param, c->sock) < 0)
+		client_close(w, c);
+}
+
+/* Return -1 if the client must be closed. */
+static int
+subscription_push(struct client *c, struct subscription *sub)
+{
+	struct rte_tel_data data;
+	int ret;
+
+	ret = sub->fn(sub->cmd, sub->has_params ? sub->params : NULL, &data);
+	if (ret < 0 && sub->delta) {
+		/* after a null push, the next one is the full result again */
+		rte_tel_data_free(sub->last);
+		sub->last = NULL;
+	} else if (sub->delta) {
+		if (sub->last == NULL) {
+			/* the first push is the full result */
+			sub->last = rte_tel_data_alloc();
+			if (sub->last != NULL)
+				*sub->last = data;
+		} else {
+			switch (rte_tel_data_delta(sub->last, &data)) {
+			case TEL_DELTA_NONE:
+				return 0;
+			case TEL_DELTA_FULL:
+				/* a null push resets the result of the client */
+				if (output_result(sub->key, -1, NULL,
+						c->sock) < 0)
+					return -1;
+				break;
+			case TEL_DELTA_CHANGES:
+				break;
+			}
+		}
+	}
+	return output_result(sub->key, ret, &data, c->sock);
+}
+
+/* Push the due subscriptions, return the time to wait for the next one. */
+static int
+worker_push(struct worker *w)
+{
+	uint64_t now = time_ms(), next = UINT64_MAX;
+	struct subscription *sub;
+	unsigned int i, j;
+
+	for (i = 0; i < MAX_CONNECTIONS; i++) {
+		struct client *c = &w->clients[i];
+
+		for (j = 0; c->sock >= 0 && j < c->num_subs; j++) {
+			sub = &c->subs[j];
+			if (sub->deadline <= now) {
+				if (subscription_push(c, sub) < 0) {
+					client_close(w, c);
+					break;
+				}
+				sub->deadline += sub->interval;
+				/* skip the pushes missed by a late worker */
+				if (sub->deadline <= now)
+					sub->deadline = now + sub->interval;
+			}
+			next = RTE_MIN(next, sub->deadline);
+		}
+	}
+	if (next == UINT64_MAX)
+		return -1;
+	now = time_ms();
+	return next > now ? (int)RTE_MIN(next - now, (uint64_t)INT_MAX) : 0;
+}
+
+static void
+worker_add_clients(struct worker *w)
+{
 	char info_str[1024];
+	int socks[MAX_CONNECTIONS];
+	int bytes, i, j;
+
 	snprintf(info_str, sizeof(info_str),
 			"{\"version\":\"%s\",\"pid\":%d,\"max_output_len\":%d}",
 			telemetry_version, getpid(), MAX_OUTPUT_LEN);
-	if (write(s, info_str, strlen(info_str)) < 0) {
-		close(s);
-		return NULL;
+
+	bytes = read(w->pipe[0], socks, sizeof(socks));
+	for (i = 0; i < bytes / (int)sizeof(socks[0]); i++) {
+		for (j = 0; j < MAX_CONNECTIONS; j++)
+			if (w->clients[j].sock < 0)
+				break;
+		if (j == MAX_CONNECTIONS) {
+			/* cannot happen, the listener limits the clients */
+			close(socks[i]);
+			__atomic_sub_fetch(&w->num_clients, 1, __ATOMIC_RELAXED);
+			__atomic_sub_fetch(&v2_clients, 1, __ATOMIC_RELAXED);
+			continue;
+		}
+		w->clients[j].sock = socks[i];
+		if (send_reply(socks[i], info_str, strlen(info_str)) < 0)
+			client_close(w, &w->clients[j]);
 	}
+}
 
-	/* receive data is not null terminated */
-	int bytes = read(s, buffer, sizeof(buffer) - 1);
-	while (bytes > 0) {
-		buffer[bytes] = 0;
-		const char *cmd = strtok(buffer, ",");
-		const char *param = strtok(NULL, "\0");
-		telemetry_cb fn = unknown_command;
-		int i;
-
-		if (cmd && strlen(cmd) < MAX_CMD_LEN) {
-			rte_spinlock_lock(&callback_sl);
-			for (i = 0; i < num_callbacks; i++)
-				if (strcmp(cmd, callbacks[i].cmd) == 0) {
-					fn = callbacks[i].fn;
-					break;
-				}
-			rte_spinlock_unlock(&callback_sl);
+static void *
+worker_main(void *arg)
+{
+	struct pollfd pfd[MAX_CONNECTIONS + 1];
+	struct worker *w = arg;
+	int i, timeout = -1;
+
+	while (1) {
+		/* free slots have a negative fd, ignored by poll */
+		pfd[0].fd = w->pipe[0];
+		pfd[0].events = POLLIN;
+		for (i = 0; i < MAX_CONNECTIONS; i++) {
+			pfd[i + 1].fd = w->clients[i].sock;
+			pfd[i + 1].events = POLLIN;
+		}
+
+		if (poll(pfd, RTE_DIM(pfd), timeout) < 0 && errno != EINTR) {
+			TMTY_LOG(ERR, "Error with poll, telemetry worker quitting\n");
+			return NULL;
 		}
-		perform_command(fn, cmd, param, s);
 
-		bytes = read(s, buffer, sizeof(buffer) - 1);
+		if (pfd[0].revents != 0)
+			worker_add_clients(w);
+		for (i = 0; i < MAX_CONNECTIONS; i++)
+			if (pfd[i + 1].fd >= 0 && pfd[i + 1].revents != 0)
+				client_read(w, &w->clients[i]);
+
+		timeout = worker_push(w);
 	}
-	close(s);
-	__atomic_sub_fetch(&v2_clients, 1, __ATOMIC_RELAXED);
 	return NULL;
 }
 
+/* Give a v2 client to the worker with the fewest clients. */
+static void
+worker_dispatch(int sock)
+{
+	struct worker *w = &workers[0];
+	uint16_t n, min = UINT16_MAX;
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(workers); i++) {
+		n = __atomic_load_n(&workers[i].num_clients, __ATOMIC_RELAXED);
+		if (n < min) {
+			min = n;
+			w = &workers[i];
+		}
+	}
+
+	__atomic_add_fetch(&w->num_clients, 1, __ATOMIC_RELAXED);
+	if (write(w->pipe[1], &sock, sizeof(sock)) != sizeof(sock)) {
+		TMTY_LOG(ERR, "Error passing client to worker: %s\n",
+			 strerror(errno));
+		close(sock);
+		__atomic_sub_fetch(&w->num_clients, 1, __ATOMIC_RELAXED);
+		__atomic_sub_fetch(&v2_clients, 1, __ATOMIC_RELAXED);
+	}
+}
+
 static void *
 socket_listener(void *socket)
 {
@@ -411,6 +751,10 @@ socket_listener(void *socket)
 			__atomic_add_fetch(s->num_clients, 1,
 					__ATOMIC_RELAXED);
 		}
+		if (s->fn == NULL) {
+			worker_dispatch(s_accepted);
+			continue;
+		}
 		rc = pthread_create(&th, NULL, s->fn,
 				    (void *)(uintptr_t)s_accepted);
 		if (rc != 0) {
@@ -548,6 +892,48 @@ telemetry_legacy_init(void)
 	return 0;
 }
 
+static int
+telemetry_workers_init(void)
+{
+	char name[16]; /* max thread name length */
+	unsigned int i, j;
+	int rc;
+
+	for (i = 0; i < RTE_DIM(workers); i++) {
+		struct worker *w = &workers[i];
+
+		for (j = 0; j < MAX_CONNECTIONS; j++)
+			w->clients[j].sock = -1;
+		if (pipe(w->pipe) < 0) {
+			TMTY_LOG(ERR, "Error with worker pipe creation: %s\n",
+				 strerror(errno));
+			goto error;
+		}
+		rc = pthread_create(&w->th, NULL, worker_main, w);
+		if (rc != 0) {
+			TMTY_LOG(ERR, "Error with create worker thread: %s\n",
+				 strerror(rc));
+			close(w->pipe[0]);
+			close(w->pipe[1]);
+			goto error;
+		}
+		pthread_setaffinity_np(w->th, sizeof(*thread_cpuset),
+				thread_cpuset);
+		snprintf(name, sizeof(name), "telemetry-w%u", i);
+		set_thread_name(w->th, name);
+		pthread_detach(w->th);
+	}
+	return 0;
+
+error:
+	while (i-- > 0) {
+		pthread_cancel(workers[i].th);
+		close(workers[i].pipe[0]);
+		close(workers[i].pipe[1]);
+	}
+	return -1;
+}
+
 static int
 telemetry_v2_init(void)
 {
@@ -563,7 +949,14 @@ telemetry_v2_init(void)
 			"Returns DPDK Telemetry information. Takes no parameters");
 	rte_telemetry_register_cmd("/help", command_help,
 			"Returns help text for a command. Parameters: string command");
-	v2_socket.fn = client_handler;
+	rte_telemetry_register_cmd("/subscribe", subscription_cmd,
+			"Pushes a command result periodically. Parameters: int interval_ms, string command, command params");
+	rte_telemetry_register_cmd("/subscribe_delta", subscription_cmd,
+			"Pushes the changes of a command result. Parameters: int interval_ms, string command, command params");
+	rte_telemetry_register_cmd("/unsubscribe", subscription_cmd,
+			"Removes a subscription, or all of them. Parameters: int subscription id (optional)");
+	/* no handler thread per client, see worker_dispatch() */
+	v2_socket.fn = NULL;
 	if (strlcpy(spath, get_socket_path(socket_dir, 2), sizeof(spath)) >= sizeof(spath)) {
 		TMTY_LOG(ERR, "Error with socket binding, path too long\n");
 		return -1;
@@ -585,6 +978,13 @@ telemetry_v2_init(void)
 		}
 		v2_socket.sock = create_socket(v2_socket.path);
 	}
+	if (telemetry_workers_init() != 0) {
+		close(v2_socket.sock);
+		v2_socket.sock = -1;
+		unlink(v2_socket.path);
+		v2_socket.path[0] = '\0';
+		return -1;
+	}
 	rc = pthread_create(&t_new, NULL, socket_listener, &v2_socket);
 	if (rc != 0) {
 		TMTY_LOG(ERR, "Error with create socket thread: %s\n",
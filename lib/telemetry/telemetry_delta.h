@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#ifndef _RTE_TELEMETRY_DELTA_H_
+#define _RTE_TELEMETRY_DELTA_H_
+
+#include <stdbool.h>
+#include <string.h>
+#include <rte_common.h>
+#include <rte_string_fns.h>
+
+#include "telemetry_data.h"
+
+/**
+ * @file
+ * Internal Telemetry delta encoding
+ *
+ * This file contains small inline functions reducing the result of a
+ * telemetry command to what changed since its previous result, so that
+ * subscriptions do not push the same values over and over.
+ *
+ ***/
+
+/* Compares two values of the same non-container type. */
+static inline bool
+__tel_value_equal(enum rte_tel_value_type type, const union tel_value *a,
+		const union tel_value *b)
+{
+	switch (type) {
+	case RTE_TEL_STRING_VAL:
+		return strcmp(a->sval, b->sval) == 0;
+	case RTE_TEL_INT_VAL:
+		return a->ival == b->ival;
+	case RTE_TEL_U64_VAL:
+		return a->u64val == b->u64val;
+	default:
+		/* nested containers are not compared, always sent */
+		return false;
+	}
+}
+
+/* Returns true if the dict entry is unchanged in the previous data. */
+static inline bool
+__tel_dict_entry_unchanged(const struct rte_tel_data *prev, unsigned int i,
+		const struct tel_dict_entry *e)
+{
+	const struct tel_dict_entry *p;
+	unsigned int j;
+
+	/* entries usually come in the same order on every call */
+	if (i < prev->data_len && strcmp(prev->data.dict[i].name, e->name) == 0)
+		p = &prev->data.dict[i];
+	else {
+		for (j = 0; j < prev->data_len; j++)
+			if (strcmp(prev->data.dict[j].name, e->name) == 0)
+				break;
+		if (j == prev->data_len)
+			return false;
+		p = &prev->data.dict[j];
+	}
+	return p->type == e->type &&
+		__tel_value_equal(e->type, &p->value, &e->value);
+}
+
+/* Returns true if the dict entry of prev is in cur, in the same place or
+ * else anywhere.
+ */
+static inline bool
+__tel_dict_entry_kept(const struct rte_tel_data *cur, unsigned int i,
+		const struct tel_dict_entry *p)
+{
+	unsigned int j;
+
+	if (i < cur->data_len && strcmp(cur->data.dict[i].name, p->name) == 0)
+		return true;
+	for (j = 0; j < cur->data_len; j++)
+		if (strcmp(cur->data.dict[j].name, p->name) == 0)
+			return true;
+	return false;
+}
+
+/* Results of rte_tel_data_delta() */
+enum tel_delta_result {
+	TEL_DELTA_NONE,    /* nothing changed, nothing to send */
+	TEL_DELTA_CHANGES, /* cur holds what changed */
+	TEL_DELTA_FULL,    /* cur holds the whole result, too many changes */
+};
+
+/**
+ * @internal
+ * Reduce *cur* to what changed since *prev*, then save the full *cur* in
+ * *prev*, for the next call.
+ *
+ * A dictionary is reduced to its new and changed entries, nested
+ * containers always being kept, followed by the entries removed since
+ * *prev* with a null value. Other types are kept whole if they changed.
+ *
+ * @return
+ *  TEL_DELTA_NONE if nothing changed, TEL_DELTA_CHANGES if *cur* is the
+ *  delta, TEL_DELTA_FULL if the removed entries do not fit in *cur*, which
+ *  is then kept whole.
+ */
+static inline enum tel_delta_result
+rte_tel_data_delta(struct rte_tel_data *prev, struct rte_tel_data *cur)
+{
+	/* the value of the removed entries, never freed */
+	static struct rte_tel_data removed_value = { .type = RTE_TEL_NULL };
+	bool changed[RTE_TEL_MAX_DICT_ENTRIES];
+	enum rte_tel_value_type type;
+	unsigned int i, n, len;
+	bool diff;
+
+	diff = prev->type != cur->type || prev->data_len != cur->data_len;
+	len = cur->data_len;
+
+	switch (cur->type) {
+	case RTE_TEL_NULL:
+		break;
+	case RTE_TEL_STRING:
+		diff = diff || strcmp(prev->data.str, cur->data.str) != 0;
+		break;
+	case RTE_TEL_DICT:
+		diff = false;
+		for (i = 0; i < cur->data_len; i++) {
+			changed[i] = prev->type != RTE_TEL_DICT ||
+				!__tel_dict_entry_unchanged(prev, i,
+					&cur->data.dict[i]);
+			diff = diff || changed[i];
+		}
+		if (prev->type != RTE_TEL_DICT)
+			break;
+		/* removed entries are put after those of cur, before the
+		 * full cur is saved in prev
+		 */
+		for (i = 0; i < prev->data_len; i++) {
+			struct tel_dict_entry *e;
+
+			if (__tel_dict_entry_kept(cur, i, &prev->data.dict[i]))
+				continue;
+			if (len == RTE_TEL_MAX_DICT_ENTRIES) {
+				*prev = *cur;
+				return TEL_DELTA_FULL;
+			}
+			e = &cur->data.dict[len++];
+			strlcpy(e->name, prev->data.dict[i].name,
+				sizeof(e->name));
+			e->type = RTE_TEL_CONTAINER;
+			e->value.container.data = &removed_value;
+			e->value.container.keep = 1;
+			diff = true;
+		}
+		break;
+	case RTE_TEL_ARRAY_STRING:
+	case RTE_TEL_ARRAY_INT:
+	case RTE_TEL_ARRAY_U64:
+		type = cur->type == RTE_TEL_ARRAY_STRING ? RTE_TEL_STRING_VAL :
+			cur->type == RTE_TEL_ARRAY_INT ? RTE_TEL_INT_VAL :
+			RTE_TEL_U64_VAL;
+		for (i = 0; i < cur->data_len && !diff; i++)
+			diff = !__tel_value_equal(type, &prev->data.array[i],
+				&cur->data.array[i]);
+		break;
+	case RTE_TEL_ARRAY_CONTAINER:
+		diff = true;
+		break;
+	}
+
+	/* containers of cur are freed once sent, they are never read in prev */
+	*prev = *cur;
+
+	if (cur->type == RTE_TEL_DICT) {
+		for (i = 0, n = 0; i < len; i++)
+			if (i >= cur->data_len || changed[i]) {
+				if (n != i)
+					cur->data.dict[n] = cur->data.dict[i];
+				n++;
+			}
+		cur->data_len = n;
+	}
+	return diff ? TEL_DELTA_CHANGES : TEL_DELTA_NONE;
+}
+
+#endif
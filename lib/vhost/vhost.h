@@ -180,6 +180,7 @@ struct async_inflight_info {
 	struct rte_mbuf *mbuf;
 	uint16_t descs; /* num of descs inflight */
 	uint16_t nr_buffers; /* num of buffers inflight for packed ring */
+	struct virtio_net_hdr nethdr; /* dequeue offloads, applied on completion */
 };
 
 struct vhost_async {
@@ -453,6 +454,8 @@ struct virtio_net {
 
 	int			extbuf;
 	int			linearbuf;
+	/* packed ring batches are processed with SIMD instructions */
+	int			vectorized;
 	struct vhost_virtqueue	*virtqueue[VHOST_MAX_QUEUE_PAIRS * 2];
 	struct inflight_mem_info *inflight_info;
 #define IF_NAME_SZ (PATH_MAX > IFNAMSIZ ? PATH_MAX : IFNAMSIZ)
@@ -782,6 +785,7 @@ void vhost_set_ifname(int, const char *if_name, unsigned int if_len);
 void vhost_setup_virtio_net(int vid, bool enable, bool legacy_ol_flags);
 void vhost_enable_extbuf(int vid);
 void vhost_enable_linearbuf(int vid);
+void vhost_disable_vectorized(int vid);
 int vhost_enable_guest_notification(struct virtio_net *dev,
 		struct vhost_virtqueue *vq, int enable);
 
@@ -814,6 +818,18 @@ vhost_iova_to_vva(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return __vhost_iova_to_vva(dev, vq, iova, len, perm);
 }
 
+#ifdef CC_AVX512_SUPPORT
+int vhost_rx_batch_check_avx512(struct virtio_net *dev,
+		struct vhost_virtqueue *vq, struct rte_mbuf **pkts,
+		uint64_t *desc_addrs, uint64_t *lens);
+int vhost_tx_batch_reserve_avx512(struct virtio_net *dev,
+		struct vhost_virtqueue *vq, uint16_t avail_idx,
+		uintptr_t *desc_addrs, uint64_t *lens, uint16_t *ids);
+void vhost_batch_write_used_avx512(struct vring_packed_desc *descs,
+		const uint64_t *lens, const uint16_t *ids, uint16_t flags,
+		uint16_t begin);
+#endif
+
 #define vhost_avail_event(vr) \
 	(*(volatile uint16_t*)&(vr)->used->ring[(vr)->size])
 #define vhost_used_event(vr) \
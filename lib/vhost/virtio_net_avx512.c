@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 corec contributors
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <linux/virtio_net.h>
+
+#include <rte_mbuf.h>
+#include <rte_vect.h>
+#include <rte_vhost.h>
+
+#include "iotlb.h"
+#include "vhost.h"
+
+/*
+ * A batch is the cache line of four packed descriptors, loaded in one
+ * 512-bit register: the address in the even and the length, id and flags
+ * in the odd 64-bit lanes.
+ */
+#define DESC_ID_SHIFT 32
+#define DESC_FLAGS_SHIFT 48
+
+/* 16-bit words of the length and id, and of the flags, of the batch */
+#define DESC_LEN_ID_WORDS 0x70707070
+#define DESC_FLAGS_WORDS 0x80808080
+
+static __rte_always_inline __m512i
+desc_flags_lanes(uint16_t flags)
+{
+	uint64_t f = (uint64_t)flags << DESC_FLAGS_SHIFT;
+
+	return _mm512_set_epi64(f, 0, f, 0, f, 0, f, 0);
+}
+
+/*
+ * Check the flags of the batch descriptors, then load them with acquire
+ * ordering. The mask selects the flags to check, as avail and used bits
+ * for the avail wrap counter and other bits to be zero.
+ */
+static __rte_always_inline int
+batch_load_avail(struct vhost_virtqueue *vq, uint16_t avail_idx,
+		 uint16_t mask, __m512i *v_descs)
+{
+	void *descs = &vq->desc_packed[avail_idx];
+	uint16_t expected;
+	__m512i v_flags;
+
+	expected = vq->avail_wrap_counter ? VRING_DESC_F_AVAIL :
+		VRING_DESC_F_USED;
+
+	v_flags = _mm512_and_si512(_mm512_loadu_si512(descs),
+				   desc_flags_lanes(mask));
+	if (unlikely(_mm512_cmpneq_epu64_mask(v_flags,
+					desc_flags_lanes(expected))))
+		return -1;
+
+	/* read the fields the driver wrote before making them available */
+	rte_atomic_thread_fence(__ATOMIC_ACQUIRE);
+	*v_descs = _mm512_loadu_si512(descs);
+
+	return 0;
+}
+
+/*
+ * Translate the four buffers given by their guest physical address and
+ * length, all in one region of the guest memory.
+ */
+static __rte_always_inline int
+batch_gpa_to_vva(struct rte_vhost_memory *mem, __m256i v_addrs,
+		 __m256i v_lens, __m256i *v_vvas)
+{
+	struct rte_vhost_mem_region *reg;
+	__m256i v_last, v_vva;
+	__mmask8 in, done;
+	uint32_t i;
+
+	v_last = _mm256_add_epi64(v_addrs, v_lens);
+	/* a wrapping buffer end is never within a region */
+	done = ~_mm256_cmpge_epu64_mask(v_last, v_addrs) & 0xf;
+	if (unlikely(done))
+		return -1;
+
+	v_vva = _mm256_setzero_si256();
+	for (i = 0; i < mem->nregions && done != 0xf; i++) {
+		reg = &mem->regions[i];
+		in = _mm256_cmpge_epu64_mask(v_addrs,
+				_mm256_set1_epi64x(reg->guest_phys_addr)) &
+			_mm256_cmple_epu64_mask(v_last,
+				_mm256_set1_epi64x(reg->guest_phys_addr +
+						   reg->size)) & ~done;
+		v_vva = _mm256_mask_add_epi64(v_vva, in, v_addrs,
+				_mm256_set1_epi64x(reg->host_user_addr -
+						   reg->guest_phys_addr));
+		done |= in;
+	}
+	if (unlikely(done != 0xf))
+		return -1;
+
+	*v_vvas = v_vva;
+	return 0;
+}
+
+/*
+ * Translate the batch buffers to host addresses. Buffers must not cross
+ * guest memory regions nor IOTLB entries.
+ */
+static __rte_always_inline int
+batch_translate(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		struct vring_packed_desc *descs, __m256i v_addrs,
+		__m256i v_lens, uint64_t *desc_addrs)
+{
+	__m256i v_vvas;
+	uint64_t len;
+	uint16_t i;
+
+	if (likely(!(dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM)))) {
+		if (batch_gpa_to_vva(dev->mem, v_addrs, v_lens, &v_vvas))
+			return -1;
+		_mm256_storeu_si256((void *)desc_addrs, v_vvas);
+		return 0;
+	}
+
+	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+		len = descs[i].len;
+		desc_addrs[i] = __vhost_iova_to_vva(dev, vq, descs[i].addr,
+						    &len, VHOST_ACCESS_RW);
+		if (unlikely(!desc_addrs[i] || len != descs[i].len))
+			return -1;
+	}
+
+	return 0;
+}
+
+int
+vhost_rx_batch_check_avx512(struct virtio_net *dev,
+			    struct vhost_virtqueue *vq,
+			    struct rte_mbuf **pkts,
+			    uint64_t *desc_addrs,
+			    uint64_t *lens)
+{
+	uint16_t avail_idx = vq->last_avail_idx;
+	__m256i v_next, v_pkt_lens, v_addrs, v_lens;
+	__m512i v_descs, v_sorted;
+
+	RTE_BUILD_BUG_ON(PACKED_BATCH_SIZE != 4);
+
+	/* single segment packets */
+	v_next = _mm256_set_epi64x((uintptr_t)pkts[3]->next,
+				   (uintptr_t)pkts[2]->next,
+				   (uintptr_t)pkts[1]->next,
+				   (uintptr_t)pkts[0]->next);
+	if (unlikely(_mm256_test_epi64_mask(v_next, v_next)))
+		return -1;
+
+	if (batch_load_avail(vq, avail_idx,
+			VRING_DESC_F_AVAIL | VRING_DESC_F_USED, &v_descs))
+		return -1;
+
+	/* addresses in the low, other fields in the high 256 bits */
+	v_sorted = _mm512_permutexvar_epi64(
+			_mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), v_descs);
+	v_addrs = _mm512_castsi512_si256(v_sorted);
+	v_lens = _mm256_and_si256(_mm512_extracti64x4_epi64(v_sorted, 1),
+				  _mm256_set1_epi64x(UINT32_MAX));
+
+	/* packets fit in the buffers after the header */
+	v_pkt_lens = _mm256_set_epi64x(pkts[3]->pkt_len, pkts[2]->pkt_len,
+				       pkts[1]->pkt_len, pkts[0]->pkt_len);
+	v_pkt_lens = _mm256_add_epi64(v_pkt_lens,
+				      _mm256_set1_epi64x(dev->vhost_hlen));
+	if (unlikely(_mm256_cmpgt_epu64_mask(v_pkt_lens, v_lens)))
+		return -1;
+
+	if (batch_translate(dev, vq, &vq->desc_packed[avail_idx], v_addrs,
+			    v_lens, desc_addrs))
+		return -1;
+
+	_mm256_storeu_si256((void *)lens, v_lens);
+
+	return 0;
+}
+
+int
+vhost_tx_batch_reserve_avx512(struct virtio_net *dev,
+			      struct vhost_virtqueue *vq,
+			      uint16_t avail_idx,
+			      uintptr_t *desc_addrs,
+			      uint64_t *lens,
+			      uint16_t *ids)
+{
+	__m256i v_addrs, v_fields, v_lens;
+	__m512i v_descs, v_sorted;
+	uint64_t fields[PACKED_BATCH_SIZE];
+	uint16_t i;
+
+	RTE_BUILD_BUG_ON(sizeof(uintptr_t) != sizeof(uint64_t));
+
+	/* chained and indirect descriptors are dequeued one by one */
+	if (batch_load_avail(vq, avail_idx, VRING_DESC_F_AVAIL |
+			VRING_DESC_F_USED | PACKED_DESC_SINGLE_DEQUEUE_FLAG,
+			&v_descs))
+		return -1;
+
+	v_sorted = _mm512_permutexvar_epi64(
+			_mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), v_descs);
+	v_addrs = _mm512_castsi512_si256(v_sorted);
+	v_fields = _mm512_extracti64x4_epi64(v_sorted, 1);
+	v_lens = _mm256_and_si256(v_fields, _mm256_set1_epi64x(UINT32_MAX));
+
+	if (batch_translate(dev, vq, &vq->desc_packed[avail_idx], v_addrs,
+			    v_lens, (uint64_t *)desc_addrs))
+		return -1;
+
+	_mm256_storeu_si256((void *)lens, v_lens);
+	_mm256_storeu_si256((void *)fields, v_fields);
+	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE)
+		ids[i] = fields[i] >> DESC_ID_SHIFT;
+
+	return 0;
+}
+
+void
+vhost_batch_write_used_avx512(struct vring_packed_desc *descs,
+			      const uint64_t *lens,
+			      const uint16_t *ids,
+			      uint16_t flags,
+			      uint16_t begin)
+{
+	uint64_t f = (uint64_t)flags << DESC_FLAGS_SHIFT;
+	__mmask32 words = ~0U << (begin * 8);
+	uint64_t l[PACKED_BATCH_SIZE] = { 0 };
+	__m512i v_descs;
+	uint16_t i;
+
+	if (lens != NULL)
+		vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE)
+			l[i] = (uint32_t)lens[i];
+
+	v_descs = _mm512_set_epi64(
+		f | (uint64_t)ids[3] << DESC_ID_SHIFT | l[3], 0,
+		f | (uint64_t)ids[2] << DESC_ID_SHIFT | l[2], 0,
+		f | (uint64_t)ids[1] << DESC_ID_SHIFT | l[1], 0,
+		f | (uint64_t)ids[0] << DESC_ID_SHIFT | l[0], 0);
+
+	/* the driver must see the length and id before the flags */
+	_mm512_mask_storeu_epi16(descs, words & DESC_LEN_ID_WORDS, v_descs);
+	rte_atomic_thread_fence(__ATOMIC_RELEASE);
+	_mm512_mask_storeu_epi16(descs, words & DESC_FLAGS_WORDS, v_descs);
+}